@@ -0,0 +1,116 @@
+#! /bin/sh
+# A script to check that OSMAPOSL_dynamic gives the same images as OSMAPOSL for every frame.
+#
+#  Copyright (C) 2026, STIR contributors
+#  This file is part of STIR.
+#
+#  SPDX-License-Identifier: Apache-2.0
+#
+#  See STIR/LICENSE.txt for details
+#
+# Author STIR contributors
+#
+
+echo This script should work with STIR version 6.3. If you have
+echo a later version, you might have to update your test pack.
+echo Please check the web site.
+echo
+
+if [ $# -eq 1 ]; then
+  echo "Prepending $1 to your PATH for the duration of this script."
+  PATH=$1:$PATH
+fi
+
+command -v OSMAPOSL_dynamic >/dev/null 2>&1 || { echo "OSMAPOSL_dynamic not found or not executable. Aborting." >&2; exit 1; }
+echo "Using `command -v OSMAPOSL_dynamic`"
+echo "Using `command -v OSMAPOSL`"
+
+# first need to set this to the C locale, as this is what the STIR utilities use
+# otherwise, awk might interpret floating point numbers incorrectly
+LC_ALL=C
+export LC_ALL
+
+mkdir -p test_OSMAPOSL_dynamic_output
+cd test_OSMAPOSL_dynamic_output || exit 1
+
+echo "=== Creating 2 frames of data and a normalisation"
+# the second frame is twice the first one
+stir_math -s --including-first --times-scalar 1 frame1.hs ../Utahscat600k_ca_seg4.hs > frames.log 2>&1 &&
+stir_math -s --including-first --times-scalar 2 frame2.hs ../Utahscat600k_ca_seg4.hs >> frames.log 2>&1 &&
+create_multi_header dyn_frames.hs frame1.hs frame2.hs >> frames.log 2>&1 &&
+stir_math -s --including-first --times-scalar .1 --add-scalar 1 norm.hs ../Utahscat600k_ca_seg4.hs >> frames.log 2>&1
+if [ $? -ne 0 ]; then
+  echo "Error creating data. Check frames.log"
+  exit 1
+fi
+
+cat > OSMAPOSL_dynamic_test.par <<EOF
+OSMAPOSLParameters :=
+objective function type:= PoissonLogLikelihoodWithLinearModelForMeanAndProjData
+PoissonLogLikelihoodWithLinearModelForMeanAndProjData Parameters:=
+  input file := \${INPUT}
+  maximum absolute segment number to process := 1
+  projector pair type := Matrix
+    Projector Pair Using Matrix Parameters :=
+      Matrix type := Ray Tracing
+      Ray tracing matrix parameters :=
+      End Ray tracing matrix parameters :=
+    End Projector Pair Using Matrix Parameters :=
+  Bin Normalisation type := From ProjData
+    Bin Normalisation From ProjData :=
+      normalisation projdata filename:= norm.hs
+    End Bin Normalisation From ProjData:=
+end PoissonLogLikelihoodWithLinearModelForMeanAndProjData Parameters:=
+output filename prefix := \${OUTPUT}
+number of subsets:= 4
+number of subiterations:= 2
+save estimates at subiteration intervals:= 2
+END :=
+EOF
+
+echo "=== Reconstructing every frame with OSMAPOSL"
+for fr in 1 2; do
+  INPUT=frame${fr}.hs OUTPUT=OSMAPOSL_f${fr} OSMAPOSL OSMAPOSL_dynamic_test.par > OSMAPOSL_f${fr}.log 2>&1
+  if [ $? -ne 0 ]; then
+    echo "Error running OSMAPOSL. Check OSMAPOSL_f${fr}.log"
+    exit 1
+  fi
+done
+
+for same_sens in 0 1; do
+  echo "=== Reconstructing all frames with OSMAPOSL_dynamic (use same sensitivity for all frames: ${same_sens})"
+  cat > OSMAPOSL_dynamic_${same_sens}.par <<EOF
+OSMAPOSL_dynamic Parameters :=
+  input file := dyn_frames.hs
+  reconstruction parameter file := OSMAPOSL_dynamic_test.par
+  output filename prefix := OSMAPOSL_dynamic_${same_sens}
+  number of frames in parallel := 2
+  use same sensitivity for all frames := ${same_sens}
+END :=
+EOF
+  logfile=OSMAPOSL_dynamic_${same_sens}.log
+  INPUT=frame1.hs OUTPUT=unused OSMAPOSL_dynamic OSMAPOSL_dynamic_${same_sens}.par > ${logfile} 2>&1
+  if [ $? -ne 0 ]; then
+    echo "Error running OSMAPOSL_dynamic. Check ${logfile}"
+    exit 1
+  fi
+  for fr in 1 2; do
+    if compare_image OSMAPOSL_f${fr}_2.hv OSMAPOSL_dynamic_${same_sens}_f${fr}_2.hv > compare_${same_sens}_f${fr}.log 2>&1; then
+      : # ok
+    else
+      echo "Images for frame ${fr} differ. Check ${logfile} and compare_${same_sens}_f${fr}.log"
+      exit 1
+    fi
+  done
+  num_sensitivities=`grep -c "Computing sensitivity" ${logfile}`
+  if [ ${same_sens} -eq 1 ]; then expected=1; else expected=2; fi
+  if [ ${num_sensitivities} -ne ${expected} ]; then
+    echo "Sensitivity was computed ${num_sensitivities} times, but expected ${expected}. Check ${logfile}"
+    exit 1
+  fi
+done
+
+cd ..
+echo
+echo "The OSMAPOSL_dynamic tests are OK."
+echo "You can remove all output with \"rm -fr test_OSMAPOSL_dynamic_output\""
@@ -140,6 +140,35 @@ for TOForNOT in "nonTOF" "TOF"; do
             ErrorLogs="$ErrorLogs $logfile"
         fi
 
+        if $use_frame; then
+            echo "=== Unlist listmode data using a time index (should give identical results)"
+            time_index=my_lm_${TOForNOT}.time_index
+            rm -f "$time_index"
+            grep -v -i "^ *end *:=" lm_to_projdata.par > my_lm_to_projdata_time_index.par
+            echo "time index filename := $time_index" >> my_lm_to_projdata_time_index.par
+            echo "time index interval (in secs) := 0.01" >> my_lm_to_projdata_time_index.par
+            echo "End :=" >> my_lm_to_projdata_time_index.par
+            grep -v -i "^ *end *:=" my_lm_to_projdata_time_index.par > my_lm_to_projdata_time_chunks.par
+            echo "number of parallel time chunks := 4" >> my_lm_to_projdata_time_chunks.par
+            echo "End :=" >> my_lm_to_projdata_time_chunks.par
+            # first run creates the index, second run uses it, third run uses it to process time chunks in parallel
+            for run in create use chunks; do
+                logfile=lm_to_projdata_${suffix}_time_index_${run}.log
+                out=my_sinogram_${suffix}_time_index
+                parfile=my_lm_to_projdata_time_index.par
+                if [ $run = chunks ]; then parfile=my_lm_to_projdata_time_chunks.par; fi
+                if env OUT_PROJDATA_FILE="$out" lm_to_projdata $parfile > "$logfile" 2>&1 \
+                   && compare_projdata "${OUT_PROJDATA_FILE}_f1g1d0b0.hs" "${out}_f1g1d0b0.hs" >> "$logfile" 2>&1
+                then
+                    echo "---- Executable ran ok and results are identical"
+                else
+                    echo "---- There were problems here! Check $logfile"
+                    ThereWereErrors=1;
+                    ErrorLogs="$ErrorLogs $logfile"
+                fi
+            done
+        fi
+
         export ADD_SINO="my_additive_sinogram_${suffix}.hs"
         echo "=== Create additive sino ${ADD_SINO}"
         # Just create a constant sinogram with a value max_prompts/50
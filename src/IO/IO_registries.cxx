@@ -35,12 +35,17 @@
 #  include "stir/IO/MultiDynamicDiscretisedDensityOutputFileFormat.h"
 #  include "stir/IO/MultiParametricDiscretisedDensityInputFileFormat.h"
 #  include "stir/IO/MultiParametricDiscretisedDensityOutputFileFormat.h"
+#  include "stir/IO/InterfileVoxelMajorDynamicDensityInputFileFormat.h"
+#  include "stir/IO/InterfileVoxelMajorDynamicDensityOutputFileFormat.h"
+#  include "stir/IO/MultiVoxelMajorDynamicDensityInputFileFormat.h"
+#  include "stir/IO/MultiVoxelMajorDynamicDensityOutputFileFormat.h"
 #  ifdef HAVE_LLN_MATRIX
 #    include "stir/IO/ECAT6OutputFileFormat.h"
 #    include "stir/IO/ECAT7OutputFileFormat.h"
 #    include "stir/IO/ECAT7DynamicDiscretisedDensityOutputFileFormat.h"
 #    include "stir/IO/ECAT7ParametricDensityOutputFileFormat.h"
 #    include "stir/IO/ECAT7DynamicDiscretisedDensityInputFileFormat.h"
+#    include "stir/IO/VoxelMajorDynamicDensityInputFileFormatAdaptor.h"
 #  endif
 
 #  if 1
@@ -91,6 +96,8 @@ static InterfileDynamicDiscretisedDensityOutputFileFormat::RegisterIt dummydynIn
 static InterfileParametricDiscretisedDensityOutputFileFormat<ParametricVoxelsOnCartesianGridBaseType>::RegisterIt dummyparIntfOut;
 static MultiDynamicDiscretisedDensityOutputFileFormat::RegisterIt dummydynMultiOut;
 static MultiParametricDiscretisedDensityOutputFileFormat<ParametricVoxelsOnCartesianGridBaseType>::RegisterIt dummyparMultiOut;
+static InterfileVoxelMajorDynamicDensityOutputFileFormat::RegisterIt dummyvmdynIntfOut;
+static MultiVoxelMajorDynamicDensityOutputFileFormat::RegisterIt dummyvmdynMultiOut;
 
 //! Support for SAFIR listmode file format
 static RegisterInputFileFormat<SAFIRCListmodeInputFileFormat<CListEventDataSAFIR>> LMdummySAFIR(4);
@@ -126,6 +133,8 @@ static RegisterInputFileFormat<ecat::ecat7::ECAT7ImageInputFileFormat> idummy2(4
 static RegisterInputFileFormat<ecat::ecat6::ECAT6ImageInputFileFormat> idummy4(100000);
 
 static RegisterInputFileFormat<ecat::ecat7::ECAT7DynamicDiscretisedDensityInputFileFormat> dynidummy(0);
+static RegisterInputFileFormat<VoxelMajorDynamicDensityInputFileFormatAdaptor<ecat::ecat7::ECAT7DynamicDiscretisedDensityInputFileFormat>>
+    vmdynidummy(0);
 #  endif
 #  ifdef HAVE_ITK
 // we'll put it at low priority such that it is tried (almost) last, i.e. after STIR specific input routines
@@ -137,6 +146,8 @@ static RegisterInputFileFormat<InterfileDynamicDiscretisedDensityInputFileFormat
 static RegisterInputFileFormat<InterfileParametricDiscretisedDensityInputFileFormat> paradummy_intf(1);
 static RegisterInputFileFormat<MultiDynamicDiscretisedDensityInputFileFormat> dynim_dummy_multi(1);
 static RegisterInputFileFormat<MultiParametricDiscretisedDensityInputFileFormat> parim_dummy_multi(1);
+static RegisterInputFileFormat<InterfileVoxelMajorDynamicDensityInputFileFormat> vmdyndummy_intf(1);
+static RegisterInputFileFormat<MultiVoxelMajorDynamicDensityInputFileFormat> vmdynim_dummy_multi(1);
 
 /*************************** listmode data **********************/
 #  ifdef HAVE_LLN_MATRIX
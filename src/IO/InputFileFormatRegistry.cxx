@@ -21,6 +21,7 @@
 #include "stir/DiscretisedDensity.h"
 #include "stir/modelling/ParametricDiscretisedDensity.h"
 #include "stir/DynamicDiscretisedDensity.h"
+#include "stir/VoxelMajorDynamicDensity.h"
 #include "stir/listmode/ListModeData.h"
 
 START_NAMESPACE_STIR
@@ -29,6 +30,7 @@ START_NAMESPACE_STIR
 template class InputFileFormatRegistry<DiscretisedDensity<3, float>>;
 template class InputFileFormatRegistry<ParametricVoxelsOnCartesianGrid>;
 template class InputFileFormatRegistry<DynamicDiscretisedDensity>;
+template class InputFileFormatRegistry<VoxelMajorDynamicDensity>;
 template class InputFileFormatRegistry<ListModeData>;
 template class InputFileFormatRegistry<DiscretisedDensity<3, CartesianCoordinate3D<float>>>;
 
@@ -38,6 +38,10 @@ InputStreamFromROOTFile::InputStreamFromROOTFile()
   set_defaults();
   reset();
   least_significant_clock_bit = 1.0e+12; // TODO remove cst or rename
+#ifdef STIR_OPENMP
+  // the same file might be read by multiple threads (e.g. by LmToProjData), each with its own object
+  ROOT::EnableThreadSafety();
+#endif
 }
 
 #if 0 // disabled as unused and incorrect
@@ -80,6 +80,8 @@ MinimalInterfileHeader::MinimalInterfileHeader()
 
   // support for siemens interfile
   add_key("%sms-mi version number", &siemens_mi_version);
+  data_compression = "none";
+  add_key("data compression", &data_compression);
   add_stop_key("END OF INTERFILE");
 }
 
@@ -0,0 +1,112 @@
+//
+//
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+
+/*!\file
+  \ingroup MultiIO
+  \brief Implementation of class stir::MultiVoxelMajorDynamicDensityOutputFileFormat
+
+\author STIR contributors
+
+*/
+
+#include "stir/IO/MultiVoxelMajorDynamicDensityOutputFileFormat.h"
+#include "stir/VoxelMajorDynamicDensity.h"
+#include "stir/NumericType.h"
+#include "stir/Succeeded.h"
+#include "stir/FilePath.h"
+#include "stir/MultipleDataSetHeader.h"
+#include "stir/warning.h"
+#include "stir/error.h"
+
+START_NAMESPACE_STIR
+
+const char* const MultiVoxelMajorDynamicDensityOutputFileFormat::registered_name = "Multi";
+
+MultiVoxelMajorDynamicDensityOutputFileFormat::MultiVoxelMajorDynamicDensityOutputFileFormat(const NumericType& type,
+                                                                                             const ByteOrder& byte_order)
+{
+  this->set_defaults();
+  this->set_type_of_numbers(type);
+  this->set_byte_order(byte_order);
+}
+
+void
+MultiVoxelMajorDynamicDensityOutputFileFormat::set_defaults()
+{
+  base_type::set_defaults();
+  this->set_type_of_numbers(NumericType::FLOAT);
+  this->set_byte_order(ByteOrder::native);
+  this->individual_output_type_sptr = OutputFileFormat<DiscretisedDensity<3, float>>::default_sptr();
+}
+
+void
+MultiVoxelMajorDynamicDensityOutputFileFormat::initialise_keymap()
+{
+  this->parser.add_start_key("Multi Output File Format Parameters");
+  this->parser.add_stop_key("End Multi Output File Format Parameters");
+  this->parser.add_parsing_key("individual output file format type", &individual_output_type_sptr);
+  base_type::initialise_keymap();
+}
+
+bool
+MultiVoxelMajorDynamicDensityOutputFileFormat::post_processing()
+{
+  if (base_type::post_processing())
+    return true;
+  return false;
+}
+
+ByteOrder
+MultiVoxelMajorDynamicDensityOutputFileFormat::set_byte_order(const ByteOrder& new_byte_order, const bool warn)
+{
+  if (!new_byte_order.is_native_order())
+    {
+      if (warn)
+        warning("MultiVoxelMajorDynamicDensityOutputFileFormat: byte_order is currently fixed to the native format\n");
+      this->file_byte_order = ByteOrder::native;
+    }
+  else
+    this->file_byte_order = new_byte_order;
+  return this->file_byte_order;
+}
+
+Succeeded
+MultiVoxelMajorDynamicDensityOutputFileFormat::actual_write_to_file(std::string& filename,
+                                                                    const VoxelMajorDynamicDensity& density) const
+{
+  {
+    FilePath file_path(filename, false); // create object without checking if a file exists already
+    if (!file_path.get_extension().empty())
+      error("MultiVoxelMajorDynamicDensityOutputFileFormat: currently needs an output filename without extension. sorry");
+  }
+  // Create all the filenames
+  VectorWithOffset<std::string> individual_filenames(1, int(density.get_num_time_frames()));
+  for (int i = 1; i <= int(density.get_num_time_frames()); i++)
+    individual_filenames[i] = filename + "_" + std::to_string(i);
+
+  // Write each individual image
+  for (int i = 1; i <= int(density.get_num_time_frames()); i++)
+    {
+      Succeeded success
+          = individual_output_type_sptr->write_to_file(individual_filenames[i], density.construct_single_density(unsigned(i)));
+      if (success != Succeeded::yes)
+        warning("MultiVoxelMajorDynamicDensity error: Failed to write \"" + individual_filenames[i] + "\".\n");
+    }
+
+  // Write some multi header info
+  filename = filename + ".txt";
+  MultipleDataSetHeader::write_header(filename, individual_filenames);
+  return Succeeded::yes;
+}
+
+// class MultiVoxelMajorDynamicDensityOutputFileFormat;
+
+END_NAMESPACE_STIR
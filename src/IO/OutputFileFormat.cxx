@@ -18,6 +18,7 @@
 #include "stir/IO/OutputFileFormat.txx"
 #include "stir/DiscretisedDensity.h"
 #include "stir/DynamicDiscretisedDensity.h"
+#include "stir/VoxelMajorDynamicDensity.h"
 #include "stir/modelling/ParametricDiscretisedDensity.h"
 #include "stir/modelling/KineticParameters.h"
 
@@ -29,6 +30,7 @@ START_NAMESPACE_STIR
 
 template class OutputFileFormat<DiscretisedDensity<3, float>>;
 template class OutputFileFormat<DynamicDiscretisedDensity>;
+template class OutputFileFormat<VoxelMajorDynamicDensity>;
 template class OutputFileFormat<ParametricVoxelsOnCartesianGrid>;
 
 END_NAMESPACE_STIR
@@ -21,6 +21,8 @@
 
 #include "stir/DynamicDiscretisedDensity.h"
 #ifndef MINI_STIR
+#  include "stir/VoxelMajorDynamicDensity.h"
+#  include "stir/IO/InterfileVoxelMajorDynamicDensityOutputFileFormat.h"
 #  include "stir/modelling/ParametricDiscretisedDensity.h"
 #  ifdef HAVE_LLN_MATRIX
 #    include "stir/IO/ECAT7ParametricDensityOutputFileFormat.h"
@@ -65,6 +67,10 @@ shared_ptr<OutputFileFormat<DynamicDiscretisedDensity>> OutputFileFormat<Dynamic
 #    endif
 );
 #  endif
+// no ECAT7 support for VoxelMajorDynamicDensity, so always use Interfile
+template <>
+shared_ptr<OutputFileFormat<VoxelMajorDynamicDensity>>
+    OutputFileFormat<VoxelMajorDynamicDensity>::_default_sptr(new InterfileVoxelMajorDynamicDensityOutputFileFormat);
 #endif
 
 END_NAMESPACE_STIR
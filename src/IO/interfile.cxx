@@ -35,17 +35,22 @@
 #include "stir/CartesianCoordinate3D.h"
 #include "stir/VoxelsOnCartesianGrid.h"
 #include "stir/ProjDataFromStream.h"
+#include "stir/ProjDataInMemory.h"
 #include "stir/ProjDataInfoCylindricalArcCorr.h"
 #include "stir/Scanner.h"
 #include "stir/Succeeded.h"
 #include "stir/IO/write_data.h"
 #include "stir/IO/read_data.h"
+#include "stir/IO/memory_map.h"
+#include "stir/IO/FileSignature.h"
 #include "stir/is_null_ptr.h"
 #include "stir/Bin.h"
 #include "stir/stream.h"
 #include "stir/error.h"
 #include "stir/warning.h"
+#include "stir/info.h"
 #include "stir/DynamicDiscretisedDensity.h"
+#include "stir/VoxelMajorDynamicDensity.h"
 #ifndef MINI_STIR
 #  include "stir/IO/InterfileHeaderSiemens.h"
 #  include "stir/IO/InterfilePDFSHeaderSPECT.h"
@@ -122,6 +127,27 @@ create_image_and_header_from(InterfileImageHeader& hdr,
   return new VoxelsOnCartesianGrid<float>(hdr.get_exam_info_sptr(), IndexRange<3>(min_indices, max_indices), origin, voxel_size);
 }
 
+//! Map float data in memory if enabled and possible, returns a null pointer otherwise
+static shared_ptr<float[]>
+memory_map_float_data(const string& data_file_name,
+                      const NumericType type_of_numbers,
+                      const ByteOrder byte_order,
+                      const std::vector<double>& scaling_factors,
+                      const std::streamoff offset,
+                      const std::size_t num_elements)
+{
+  if (!get_memory_map_input_files() || !(type_of_numbers == NumericType::FLOAT) || !byte_order.is_native_order()
+      || offset % static_cast<std::streamoff>(sizeof(float)) != 0
+      || std::any_of(scaling_factors.begin(), scaling_factors.end(), [](const double f) { return f != 1; }))
+    return shared_ptr<float[]>();
+
+  const shared_ptr<char[]> data_sptr = memory_map_file(data_file_name, offset, num_elements * sizeof(float));
+  if (is_null_ptr(data_sptr))
+    return shared_ptr<float[]>();
+  info(format("Mapped data from '{}' in memory", data_file_name), 2);
+  return shared_ptr<float[]>(data_sptr, reinterpret_cast<float*>(data_sptr.get()));
+}
+
 VoxelsOnCartesianGrid<float>*
 read_interfile_image(istream& input, const string& directory_for_data)
 {
@@ -129,25 +155,40 @@ read_interfile_image(istream& input, const string& directory_for_data)
   char full_data_file_name[max_filename_length];
   VoxelsOnCartesianGrid<float>* image_ptr = create_image_and_header_from(hdr, full_data_file_name, input, directory_for_data);
 
-  ifstream data_in;
-  open_read_binary(data_in, full_data_file_name);
+  const shared_ptr<float[]> mapped_data_sptr = memory_map_float_data(full_data_file_name,
+                                                                     hdr.type_of_numbers,
+                                                                     hdr.file_byte_order,
+                                                                     hdr.image_scaling_factors[0],
+                                                                     hdr.data_offset_each_dataset[0],
+                                                                     image_ptr->size_all());
+  if (!is_null_ptr(mapped_data_sptr))
+    {
+      // use the mapped data as storage for the image
+      Array<3, float> mapped_data(image_ptr->get_index_range(), mapped_data_sptr);
+      swap(static_cast<Array<3, float>&>(*image_ptr), mapped_data);
+    }
+  else
+    {
+      ifstream data_in;
+      open_read_binary(data_in, full_data_file_name);
 
-  data_in.seekg(hdr.data_offset_each_dataset[0]);
+      data_in.seekg(hdr.data_offset_each_dataset[0]);
 
-  if (hdr.data_offset_each_dataset[0] > 0)
-    data_in.seekg(hdr.data_offset_each_dataset[0]);
+      if (hdr.data_offset_each_dataset[0] > 0)
+        data_in.seekg(hdr.data_offset_each_dataset[0]);
 
-  // read into image_sptr first
-  float scale = float(1);
-  if (read_data(data_in, *image_ptr, hdr.type_of_numbers, scale, hdr.file_byte_order) == Succeeded::no || scale != 1)
-    {
-      warning("read_interfile_image: error reading data or scale factor returned by read_data not equal to 1\n");
-      return 0;
-    }
+      // read into image_sptr first
+      float scale = float(1);
+      if (read_data(data_in, *image_ptr, hdr.type_of_numbers, scale, hdr.file_byte_order) == Succeeded::no || scale != 1)
+        {
+          warning("read_interfile_image: error reading data or scale factor returned by read_data not equal to 1\n");
+          return 0;
+        }
 
-  for (int i = 0; i < hdr.matrix_size[2][0]; i++)
-    if (hdr.image_scaling_factors[0][i] != 1)
-      (*image_ptr)[i] *= static_cast<float>(hdr.image_scaling_factors[0][i]);
+      for (int i = 0; i < hdr.matrix_size[2][0]; i++)
+        if (hdr.image_scaling_factors[0][i] != 1)
+          (*image_ptr)[i] *= static_cast<float>(hdr.image_scaling_factors[0][i]);
+    }
 
   // Check number of time frames
   if (image_ptr->get_exam_info().get_time_frame_definitions().get_num_frames() > 1)
@@ -213,6 +254,47 @@ read_interfile_dynamic_image(istream& input, const string& directory_for_data)
   return dynamic_dens_ptr;
 }
 
+VoxelMajorDynamicDensity*
+read_interfile_voxel_major_dynamic_image(istream& input, const string& directory_for_data)
+{
+  InterfileImageHeader hdr;
+  char full_data_file_name[max_filename_length];
+  shared_ptr<VoxelsOnCartesianGrid<float>> image_sptr(
+      create_image_and_header_from(hdr, full_data_file_name, input, directory_for_data));
+  if (is_null_ptr(image_sptr))
+    error("Error parsing dynamic image");
+
+  shared_ptr<Scanner> scanner_sptr(Scanner::get_scanner_from_name(hdr.get_exam_info().originating_system));
+
+  unique_ptr<VoxelMajorDynamicDensity> dynamic_dens_uptr(
+      new VoxelMajorDynamicDensity(hdr.get_exam_info_sptr(), *image_sptr, scanner_sptr));
+
+  ifstream data_in;
+  open_read_binary(data_in, full_data_file_name);
+
+  // read every time frame into image_sptr, and copy it into the voxel-major image
+  for (unsigned int frame_num = 1; frame_num <= dynamic_dens_uptr->get_num_time_frames(); ++frame_num)
+    {
+      data_in.seekg(hdr.data_offset_each_dataset[frame_num - 1]);
+
+      float scale = float(1);
+      if (read_data(data_in, *image_sptr, hdr.type_of_numbers, scale, hdr.file_byte_order) == Succeeded::no
+          || fabs(scale - float(1)) > float(1e-10))
+        {
+          warning("read_interfile_voxel_major_dynamic_image: error reading data or scale factor returned by read_data not equal "
+                  "to 1");
+          return 0;
+        }
+
+      for (int i = 0; i < hdr.matrix_size[2][0]; i++)
+        if (fabs(hdr.image_scaling_factors[frame_num - 1][i] - double(1)) > double(1e-10))
+          (*image_sptr)[i] *= static_cast<float>(hdr.image_scaling_factors[frame_num - 1][i]);
+
+      dynamic_dens_uptr->set_density(*image_sptr, frame_num);
+    }
+  return dynamic_dens_uptr.release();
+}
+
 #ifndef MINI_STIR
 
 ParametricVoxelsOnCartesianGrid*
@@ -313,6 +395,21 @@ read_interfile_dynamic_image(const string& filename)
   return read_interfile_dynamic_image(image_stream, directory_name);
 }
 
+VoxelMajorDynamicDensity*
+read_interfile_voxel_major_dynamic_image(const string& filename)
+{
+  ifstream image_stream(filename.c_str());
+  if (!image_stream)
+    {
+      error("read_interfile_voxel_major_dynamic_image: couldn't open file " + filename);
+    }
+
+  char directory_name[max_filename_length];
+  get_directory_name(directory_name, filename.c_str());
+
+  return read_interfile_voxel_major_dynamic_image(image_stream, directory_name);
+}
+
 #ifndef MINI_STIR
 
 ParametricVoxelsOnCartesianGrid*
@@ -921,6 +1018,45 @@ write_basic_interfile(const string& filename,
   return success;
 }
 
+Succeeded
+write_basic_interfile(const string& filename,
+                      const VoxelMajorDynamicDensity& image,
+                      const NumericType output_type,
+                      const float scale,
+                      const ByteOrder byte_order)
+{
+
+  std::string data_name, header_name;
+  interfile_create_filenames(filename, data_name, header_name);
+
+  ofstream output_data;
+  open_write_binary(output_data, data_name.c_str());
+
+  // buffer for a single time frame
+  VoxelsOnCartesianGrid<float> frame(image.get_index_range(), image.get_origin(), image.get_grid_spacing());
+  VectorWithOffset<unsigned long> file_offsets(image.get_num_time_frames());
+  VectorWithOffset<float> scaling_factors(image.get_num_time_frames());
+  for (int i = 1; i <= static_cast<int>(image.get_num_time_frames()); i++)
+    {
+      float scale_to_use = scale;
+      file_offsets[i - 1] = output_data.tellp();
+      image.get_density(frame, static_cast<unsigned int>(i));
+      write_data(output_data, frame, output_type, scale_to_use, byte_order);
+      scaling_factors[i - 1] = (scale_to_use);
+    }
+
+  return write_basic_interfile_image_header(header_name,
+                                            data_name,
+                                            image.get_exam_info(),
+                                            image.get_index_range(),
+                                            image.get_grid_spacing(),
+                                            image.get_origin(),
+                                            output_type,
+                                            byte_order,
+                                            scaling_factors,
+                                            file_offsets);
+}
+
 #ifndef MINI_STIR
 
 static ProjDataFromStream*
@@ -1033,6 +1169,12 @@ read_interfile_PDFS(istream& input, const string& directory_for_data, const ios:
       {
         return read_interfile_PDFS_Siemens(input, directory_for_data, open_mode);
       }
+    if (standardise_interfile_keyword(hdr.data_compression) != "none")
+      {
+        warning(format("read_interfile_PDFS: data are compressed ('{}'), use ProjData::read_from_file() instead",
+                       hdr.data_compression));
+        return 0;
+      }
   }
 #endif
 
@@ -1099,8 +1241,67 @@ read_interfile_PDFS(const string& filename, const ios::openmode open_mode)
   return read_interfile_PDFS(image_stream, directory_name, open_mode);
 }
 
+ProjDataInMemory*
+read_interfile_PDFS_memory_mapped(const string& filename)
+{
+  if (!is_interfile_signature(FileSignature(filename).get_signature()))
+    return 0;
+
+  ifstream input(filename.c_str());
+  if (!input)
+    return 0;
+#ifndef MINI_STIR
+  {
+    MinimalInterfileHeader hdr;
+    if (!hdr.parse(input, false))
+      return 0;
+    // SPECT and Siemens data are not supported (yet)
+    if (hdr.get_exam_info().imaging_modality.get_modality() == ImagingModality::NM || !hdr.siemens_mi_version.empty())
+      return 0;
+    input.clear();
+    input.seekg(0);
+  }
+#endif
+
+  InterfilePDFSHeader hdr;
+  if (!hdr.parse(input, false))
+    return 0;
+  assert(!is_null_ptr(hdr.data_info_sptr));
+  const ProjDataInfo& proj_data_info = *hdr.data_info_sptr;
+
+  // check that the data are stored as in ProjDataInMemory
+  if (hdr.storage_order != ProjDataFromStream::Segment_AxialPos_View_TangPos
+      && hdr.storage_order != ProjDataFromStream::Timing_Segment_AxialPos_View_TangPos)
+    return 0;
+  if (hdr.segment_sequence != ProjData::standard_segment_sequence(proj_data_info))
+    return 0;
+  if (hdr.timing_poss_sequence.size() > 1)
+    for (std::size_t i = 0; i < hdr.timing_poss_sequence.size(); ++i)
+      if (hdr.timing_poss_sequence[i] != proj_data_info.get_min_tof_pos_num() + static_cast<int>(i))
+        return 0;
+
+  char full_data_file_name[max_filename_length];
+  strcpy(full_data_file_name, hdr.data_file_name.c_str());
+  char directory_name[max_filename_length];
+  get_directory_name(directory_name, filename.c_str());
+  prepend_directory_name(full_data_file_name, directory_name);
+
+  const shared_ptr<float[]> data_sptr = memory_map_float_data(full_data_file_name,
+                                                              hdr.type_of_numbers,
+                                                              hdr.file_byte_order,
+                                                              hdr.image_scaling_factors[0],
+                                                              hdr.data_offset_each_dataset[0],
+                                                              proj_data_info.size_all());
+  if (is_null_ptr(data_sptr))
+    return 0;
+  return new ProjDataInMemory(hdr.get_exam_info_sptr(), proj_data_info.create_shared_clone(), data_sptr);
+}
+
 Succeeded
-write_basic_interfile_PDFS_header(const string& header_file_name, const string& data_file_name, const ProjDataFromStream& pdfs)
+write_basic_interfile_PDFS_header(const string& header_file_name,
+                                  const string& data_file_name,
+                                  const ProjDataFromStream& pdfs,
+                                  const string& data_compression)
 {
 
   string header_name = header_file_name;
@@ -1150,6 +1351,8 @@ write_basic_interfile_PDFS_header(const string& header_file_name, const string&
 
   output_header << "imagedata byte order := "
                 << (pdfs.get_byte_order_in_stream() == ByteOrder::little_endian ? "LITTLEENDIAN" : "BIGENDIAN") << endl;
+  if (standardise_interfile_keyword(data_compression) != "none")
+    output_header << "data compression := " << data_compression << endl;
 
   write_interfile_radionuclide_info(output_header, pdfs.get_exam_info());
 
@@ -1263,6 +1466,13 @@ write_basic_interfile_PDFS_header(const string& header_file_name, const string&
           order_of_z = 2;
           break;
         }
+        case ProjDataFromStream::Timing_Segment_AxialPos_View_TangPos: {
+          order_of_timing_poss = 5;
+          order_of_segment = 4;
+          order_of_view = 2;
+          order_of_z = 3;
+          break;
+        }
         default: {
           error("write_interfile_PSOV_header: unsupported storage order, "
                 "defaulting to Segment_View_AxialPos_TangPos.\n Please correct by hand !");
@@ -0,0 +1,92 @@
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup IO
+  \brief Implementation of functions for mapping files in memory
+
+  \author STIR contributors
+*/
+
+#include "stir/IO/memory_map.h"
+#include "stir/warning.h"
+#include "stir/format.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#ifdef __OS_UNIX__
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
+START_NAMESPACE_STIR
+
+static bool
+get_default_memory_map_input_files()
+{
+  const char* const var = std::getenv("STIR_MEMORY_MAP_INPUT");
+  return var != nullptr && std::strcmp(var, "1") == 0;
+}
+
+static bool memory_map_input_files = get_default_memory_map_input_files();
+
+bool
+get_memory_map_input_files()
+{
+  return memory_map_input_files;
+}
+
+void
+set_memory_map_input_files(const bool value)
+{
+  memory_map_input_files = value;
+}
+
+shared_ptr<char[]>
+memory_map_file(const std::string& filename, const std::streamoff offset, const std::size_t num_bytes)
+{
+#ifdef __OS_UNIX__
+  if (offset < 0 || num_bytes == 0)
+    return shared_ptr<char[]>();
+
+  const int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    return shared_ptr<char[]>();
+
+  struct stat file_stat;
+  if (::fstat(fd, &file_stat) != 0
+      || static_cast<std::streamoff>(file_stat.st_size) < offset + static_cast<std::streamoff>(num_bytes))
+    {
+      ::close(fd);
+      return shared_ptr<char[]>();
+    }
+
+  // the offset passed to mmap needs to be a multiple of the page size
+  const std::streamoff page_size = static_cast<std::streamoff>(::sysconf(_SC_PAGESIZE));
+  const std::streamoff map_offset = (offset / page_size) * page_size;
+  const std::size_t map_size = num_bytes + static_cast<std::size_t>(offset - map_offset);
+  void* const map_ptr = ::mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, static_cast<off_t>(map_offset));
+  // the mapping remains valid after closing the file
+  ::close(fd);
+  if (map_ptr == MAP_FAILED)
+    {
+      warning(format("memory_map_file: mapping '{}' failed: {}", filename, std::strerror(errno)));
+      return shared_ptr<char[]>();
+    }
+
+  char* const data_ptr = static_cast<char*>(map_ptr) + (offset - map_offset);
+  return shared_ptr<char[]>(data_ptr, [map_ptr, map_size](char*) { ::munmap(map_ptr, map_size); });
+#else
+  return shared_ptr<char[]>();
+#endif
+}
+
+END_NAMESPACE_STIR
@@ -17,20 +17,14 @@
 */
 
 #include "stir/GeneralisedPoissonNoiseGenerator.h"
-#include "stir/SegmentByView.h"
+#include "stir/SegmentBySinogram.h"
 #include "stir/Succeeded.h"
 #include "stir/round.h"
 #include "stir/error.h"
-
-#include <boost/random/uniform_01.hpp>
-#include <boost/random/normal_distribution.hpp>
-#include <boost/random/mersenne_twister.hpp>
-#include <boost/random/variate_generator.hpp>
+#include <cmath>
 
 START_NAMESPACE_STIR
 
-GeneralisedPoissonNoiseGenerator::base_generator_type GeneralisedPoissonNoiseGenerator::generator;
-
 GeneralisedPoissonNoiseGenerator::GeneralisedPoissonNoiseGenerator(const float scaling_factor, const bool preserve_mean)
     : scaling_factor(scaling_factor),
       preserve_mean(preserve_mean)
@@ -43,18 +37,15 @@ GeneralisedPoissonNoiseGenerator::seed(unsigned int value)
 {
   if (value == unsigned(0))
     error("Seed value has to be non-zero");
-  this->generator.seed(static_cast<poisson_result_type>(value));
+  this->seed_value = value;
+  this->num_generated = 0;
 }
 
 // function that generates a Poisson noise realisation, i.e. without
 // using the scaling_factor
 unsigned int
-GeneralisedPoissonNoiseGenerator::generate_poisson_random(const float mu)
+GeneralisedPoissonNoiseGenerator::generate_poisson_random(const float mu, CounterBasedRandomNumbers& random_numbers)
 {
-  static boost::uniform_01<base_generator_type> random01(generator);
-  // normal distribution with mean=0 and sigma=1
-  static boost::normal_distribution<double> normal_distrib01(0., 1.);
-
   // check if mu is large. If so, use the normal distribution
   // note: the threshold must be such that exp(threshold) is still a floating point number
   if (mu > 60.F)
@@ -62,24 +53,20 @@ GeneralisedPoissonNoiseGenerator::generate_poisson_random(const float mu)
       // get random number of normal distribution of mean=mu and sigma=sqrt(mu)
 
       // get random with mean=0, sigma=1 and use scaling with sqrt(mu) and addition of mu
-      // this has the advantage that we don't have to construct a normal_distrib
-      // object every time. This will speed things up, especially because the
-      // normal_distribution is implemented using with a polar method that calls
-      // generator::operator() twice only on 'odd'- number of invocations
-      const double random = normal_distrib01(random01) * sqrt(mu) + mu;
+      const double random = random_numbers.normal() * std::sqrt(mu) + mu;
 
       return static_cast<unsigned>(random <= 0 ? 0 : round(random));
     }
   else
     {
-      double u = random01();
+      double u = random_numbers.uniform01();
 
       // prevent problems of n growing too large (or even to infinity)
       // when u is very close to 1
       if (u > 1 - 1.E-6)
         u = 1 - 1.E-6;
 
-      const double upper = exp(mu) * u;
+      const double upper = std::exp(mu) * u;
       double accum = 1.;
       double term = 1.;
       unsigned int n = 1;
@@ -95,31 +82,49 @@ GeneralisedPoissonNoiseGenerator::generate_poisson_random(const float mu)
 }
 
 float
-GeneralisedPoissonNoiseGenerator::generate_scaled_poisson_random(const float mu,
-                                                                 const float scaling_factor,
-                                                                 const bool preserve_mean)
+GeneralisedPoissonNoiseGenerator::generate_scaled_poisson_random(const float mu, const std::uint64_t bin_index) const
 {
-  const unsigned int random_poisson = generate_poisson_random(mu * scaling_factor);
+  CounterBasedRandomNumbers random_numbers(this->seed_value, bin_index);
+  const unsigned int random_poisson = generate_poisson_random(mu * scaling_factor, random_numbers);
   return preserve_mean ? random_poisson / scaling_factor : static_cast<float>(random_poisson);
 }
 
 float
 GeneralisedPoissonNoiseGenerator::generate_random(const float mu)
 {
-  return generate_scaled_poisson_random(mu, scaling_factor, preserve_mean);
+  return generate_scaled_poisson_random(mu, this->num_generated++);
 }
 
 void
 GeneralisedPoissonNoiseGenerator::generate_random(ProjData& output_projdata, const ProjData& input_projdata)
 {
-  for (int seg = input_projdata.get_min_segment_num(); seg <= input_projdata.get_max_segment_num(); seg++)
+  for (int timing_pos_num = input_projdata.get_min_tof_pos_num(); timing_pos_num <= input_projdata.get_max_tof_pos_num();
+       ++timing_pos_num)
     {
-      for (int timing_pos_num = input_projdata.get_min_tof_pos_num(); timing_pos_num <= input_projdata.get_max_tof_pos_num();
-           ++timing_pos_num)
+      for (int seg = input_projdata.get_min_segment_num(); seg <= input_projdata.get_max_segment_num(); seg++)
         {
-          SegmentByView<float> seg_output = output_projdata.get_empty_segment_by_view(seg, false, timing_pos_num);
+          const SegmentBySinogram<float> seg_input = input_projdata.get_segment_by_sinogram(seg, timing_pos_num);
+          SegmentBySinogram<float> seg_output = output_projdata.get_empty_segment_by_sinogram(seg, false, timing_pos_num);
+          const int min_ax_pos_num = seg_input.get_min_axial_pos_num();
+          const int max_ax_pos_num = seg_input.get_max_axial_pos_num();
+          const std::uint64_t num_bins_in_sinogram
+              = static_cast<std::uint64_t>(seg_input.get_num_views()) * seg_input.get_num_tangential_poss();
+          const std::uint64_t first_bin_index = this->num_generated;
+
+          // every bin gets its own random numbers, so the result does not depend on the order
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
+          for (int ax_pos_num = min_ax_pos_num; ax_pos_num <= max_ax_pos_num; ++ax_pos_num)
+            {
+              std::uint64_t bin_index = first_bin_index + (ax_pos_num - min_ax_pos_num) * num_bins_in_sinogram;
+              auto out_iter = seg_output[ax_pos_num].begin_all();
+              for (auto in_iter = seg_input[ax_pos_num].begin_all(); in_iter != seg_input[ax_pos_num].end_all();
+                   ++in_iter, ++out_iter)
+                *out_iter = generate_scaled_poisson_random(*in_iter, bin_index++);
+            }
+          this->num_generated += static_cast<std::uint64_t>(seg_input.get_num_axial_poss()) * num_bins_in_sinogram;
 
-          this->generate_random(seg_output, input_projdata.get_segment_by_view(seg, timing_pos_num));
           if (output_projdata.set_segment(seg_output) == Succeeded::no)
             error("Problem writing to projection data");
         }
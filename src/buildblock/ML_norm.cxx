@@ -35,6 +35,8 @@
 #endif
 
 #include <algorithm>
+#include <functional>
+#include <vector>
 using std::min;
 using std::max;
 
@@ -720,16 +722,9 @@ FanProjData::FanProjData(const IndexRange<4>& range)
 }
 #endif
 
-FanProjData::FanProjData(const int num_rings, const int num_detectors_per_ring, const int max_ring_diff, const int fan_size)
-    : num_rings(num_rings),
-      num_detectors_per_ring(num_detectors_per_ring),
-      max_ring_diff(max_ring_diff),
-      half_fan_size(fan_size / 2)
+static IndexRange<4>
+make_fan_indices(const int num_rings, const int num_detectors_per_ring, const int max_ring_diff, const int half_fan_size)
 {
-  assert(num_detectors_per_ring % 2 == 0);
-  assert(max_ring_diff < num_rings);
-  assert(fan_size < num_detectors_per_ring);
-
   IndexRange<4> fan_indices;
   fan_indices.grow(0, num_rings - 1);
   for (int ra = 0; ra < num_rings; ++ra)
@@ -746,8 +741,20 @@ FanProjData::FanProjData(const int num_rings, const int num_detectors_per_ring,
                 = IndexRange<1>(a + num_detectors_per_ring / 2 - half_fan_size, a + num_detectors_per_ring / 2 + half_fan_size);
         }
     }
-  grow(fan_indices);
-  fill(0);
+  return fan_indices;
+}
+
+// note: use the Array constructor with an IndexRange, such that all data is allocated in a single block (initialised to 0)
+FanProjData::FanProjData(const int num_rings, const int num_detectors_per_ring, const int max_ring_diff, const int fan_size)
+    : base_type(make_fan_indices(num_rings, num_detectors_per_ring, max_ring_diff, fan_size / 2)),
+      num_rings(num_rings),
+      num_detectors_per_ring(num_detectors_per_ring),
+      max_ring_diff(max_ring_diff),
+      half_fan_size(fan_size / 2)
+{
+  assert(num_detectors_per_ring % 2 == 0);
+  assert(max_ring_diff < num_rings);
+  assert(fan_size < num_detectors_per_ring);
 }
 
 FanProjData&
@@ -761,6 +768,17 @@ FanProjData::operator=(const FanProjData& other)
   return *this;
 }
 
+FanProjData&
+FanProjData::operator+=(const FanProjData& other)
+{
+  assert(num_rings == other.num_rings);
+  assert(num_detectors_per_ring == other.num_detectors_per_ring);
+  assert(max_ring_diff == other.max_ring_diff);
+  assert(half_fan_size == other.half_fan_size);
+  std::transform(this->begin_all(), this->end_all(), other.begin_all(), this->begin_all(), std::plus<float>());
+  return *this;
+}
+
 float&
 FanProjData::operator()(const int ra, const int a, const int rb, const int b)
 {
@@ -847,22 +865,25 @@ FanProjData::get_min_rb(const int ra) const
   // return (*this)[ra][(*this)[ra].get_min_index()].get_min_index();
 }
 
+// Note: the following functions compute the index ranges directly (as opposed to using the Array index ranges),
+// as they are used in the inner loops of many functions below.
+
 int
 FanProjData::get_max_rb(const int ra) const
 {
-  return (*this)[ra][(*this)[ra].get_min_index()].get_max_index();
+  return min(ra + max_ring_diff, num_rings - 1);
 }
 
 int
 FanProjData::get_min_b(const int a) const
 {
-  return (*this)[get_min_index()][a][(*this)[get_min_index()][a].get_min_index()].get_min_index();
+  return a + num_detectors_per_ring / 2 - half_fan_size;
 }
 
 int
 FanProjData::get_max_b(const int a) const
 {
-  return (*this)[get_min_index()][a][(*this)[get_min_index()][a].get_min_index()].get_max_index();
+  return a + num_detectors_per_ring / 2 + half_fan_size;
 }
 
 float
@@ -1089,12 +1110,19 @@ make_fan_data_remove_gaps_help(FanProjData& fan_data,
   const int num_physical_rings = num_rings - (num_axial_blocks - 1) * num_virtual_axial_crystals_per_block;
   fan_data = FanProjData(num_physical_rings, num_physical_detectors_per_ring, new_max_delta, 2 * new_half_fan_size + 1);
 
-  shared_ptr<SegmentBySinogram<float>> segment_ptr;
-  Bin bin;
-
-  for (bin.segment_num() = proj_data.get_min_segment_num(); bin.segment_num() <= proj_data.get_max_segment_num();
-       ++bin.segment_num())
+  // every bin corresponds to a different element of fan_data, so we can process segments in parallel
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
+  for (int segment_num = proj_data.get_min_segment_num(); segment_num <= proj_data.get_max_segment_num(); ++segment_num)
     {
+      Bin bin;
+      bin.segment_num() = segment_num;
+      shared_ptr<SegmentBySinogram<float>> segment_ptr;
+#ifdef STIR_OPENMP
+      // reading from streams is not safe in multi-threaded code
+#  pragma omp critical(ML_NORM_READ_SEGMENT)
+#endif
       segment_ptr.reset(new SegmentBySinogram<float>(proj_data.get_segment_by_sinogram(bin.segment_num())));
 
       for (bin.axial_pos_num() = proj_data.get_min_axial_pos_num(bin.segment_num());
@@ -1239,6 +1267,10 @@ set_fan_data_add_gaps_help(ProjData& proj_data,
               (*segment_ptr)[bin.axial_pos_num()][bin.view_num()][bin.tangential_pos_num()]
                   = fan_data(new_ra, new_a, new_rb, new_b);
             }
+#ifdef STIR_OPENMP
+      // writing to streams is not safe in multi-threaded code
+#  pragma omp critical(ML_NORM_WRITE_SEGMENT)
+#endif
       proj_data.set_segment(*segment_ptr);
     }
 }
@@ -1282,6 +1314,10 @@ apply_block_norm(FanProjData& fan_data, const BlockData3D& block_data, const boo
   const int num_tangential_crystals_per_block = num_tangential_detectors / num_tangential_blocks;
   assert(num_tangential_blocks * num_tangential_crystals_per_block == num_tangential_detectors);
 
+  // Note: loops below only modify elements stored for ring ra, so we can parallelise over ra
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
   for (int ra = fan_data.get_min_ra(); ra <= fan_data.get_max_ra(); ++ra)
     for (int a = fan_data.get_min_a(); a <= fan_data.get_max_a(); ++a)
       // loop rb from ra to avoid double counting
@@ -1394,6 +1430,10 @@ apply_geo_norm(FanProjData& fan_data, const GeoData3D& geo_data, const bool appl
               }
           }
 
+  // Note: the above loop is kept serial, as different (ra,a,rb,b) can be rotated/mirrored to the same element.
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
   for (int ra = fan_data.get_min_ra(); ra <= fan_data.get_max_ra(); ++ra)
     for (int a = fan_data.get_min_a(); a <= fan_data.get_max_a(); ++a)
       //    for (int rb = fan_data.get_min_ra(); rb <= fan_data.get_max_ra(); ++rb)
@@ -1414,6 +1454,9 @@ void
 apply_efficiencies(FanProjData& fan_data, const DetectorEfficiencies& efficiencies, const bool apply)
 {
   const int num_detectors_per_ring = fan_data.get_num_detectors_per_ring();
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
   for (int ra = fan_data.get_min_ra(); ra <= fan_data.get_max_ra(); ++ra)
     for (int a = fan_data.get_min_a(); a <= fan_data.get_max_a(); ++a)
       // loop rb from ra to avoid double counting
@@ -1432,6 +1475,9 @@ apply_efficiencies(FanProjData& fan_data, const DetectorEfficiencies& efficienci
 void
 make_fan_sum_data(Array<2, float>& data_fan_sums, const FanProjData& fan_data)
 {
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
   for (int ra = fan_data.get_min_ra(); ra <= fan_data.get_max_ra(); ++ra)
     for (int a = fan_data.get_min_a(); a <= fan_data.get_max_a(); ++a)
       data_fan_sums[ra][a] = fan_data.sum(ra, a);
@@ -1453,17 +1499,25 @@ make_fan_sum_data_help(Array<2, float>& data_fan_sums,
   const int half_fan_size = fan_size / 2;
   data_fan_sums.fill(0);
 
-  shared_ptr<SegmentBySinogram<float>> segment_ptr;
-  Bin bin;
-
-  for (bin.segment_num() = proj_data.get_min_segment_num(); bin.segment_num() <= proj_data.get_max_segment_num();
-       ++bin.segment_num())
-    {
-      // for (bin.timing_pos_num() = proj_data.get_min_tof_pos_num(); bin.timing_pos_num() <= proj_data.get_max_tof_pos_num(); ++
-      // bin.timing_pos_num())
+#ifdef STIR_OPENMP
+#  pragma omp parallel
+#endif
+  {
+    // every thread accumulates in its own array, which are added at the end
+    Array<2, float> local_data_fan_sums(data_fan_sums.get_index_range());
+#ifdef STIR_OPENMP
+#  pragma omp for schedule(dynamic)
+#endif
+    for (int segment_num = proj_data.get_min_segment_num(); segment_num <= proj_data.get_max_segment_num(); ++segment_num)
       {
-        segment_ptr.reset(
-            new SegmentBySinogram<float>(proj_data.get_segment_by_sinogram(bin.segment_num() /*,bin.timing_pos_num()*/)));
+        Bin bin;
+        bin.segment_num() = segment_num;
+        shared_ptr<SegmentBySinogram<float>> segment_ptr;
+#ifdef STIR_OPENMP
+        // reading from streams is not safe in multi-threaded code
+#  pragma omp critical(ML_NORM_READ_SEGMENT)
+#endif
+        segment_ptr.reset(new SegmentBySinogram<float>(proj_data.get_segment_by_sinogram(bin.segment_num())));
 
         for (bin.axial_pos_num() = proj_data.get_min_axial_pos_num(bin.segment_num());
              bin.axial_pos_num() <= proj_data.get_max_axial_pos_num(bin.segment_num());
@@ -1477,11 +1531,15 @@ make_fan_sum_data_help(Array<2, float>& data_fan_sums,
                 proj_data_info.get_det_pair_for_bin(a, ra, b, rb, bin);
 
                 const float value = (*segment_ptr)[bin.axial_pos_num()][bin.view_num()][bin.tangential_pos_num()];
-                data_fan_sums[ra][a] += value;
-                data_fan_sums[rb][b] += value;
+                local_data_fan_sums[ra][a] += value;
+                local_data_fan_sums[rb][b] += value;
               }
       }
-    }
+#ifdef STIR_OPENMP
+#  pragma omp critical(ML_NORM_ADD_FAN_SUMS)
+#endif
+    data_fan_sums += local_data_fan_sums;
+  }
 }
 
 void
@@ -1520,6 +1578,9 @@ make_fan_sum_data(Array<2, float>& data_fan_sums,
   assert(data_fan_sums.get_min_index() == 0);
   const int num_detectors_per_ring = data_fan_sums[0].get_length();
 
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
   for (int ra = data_fan_sums.get_min_index(); ra <= data_fan_sums.get_max_index(); ++ra)
     for (int a = data_fan_sums[ra].get_min_index(); a <= data_fan_sums[ra].get_max_index(); ++a)
       {
@@ -1547,6 +1608,10 @@ make_geo_data(GeoData3D& geo_data, const FanProjData& fan_data)
   FanProjData work = fan_data;
   work.fill(0);
 
+  // Note: loops below only modify elements stored for ring ra, so we can parallelise over ra
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
   for (int ra = fan_data.get_min_ra(); ra <= fan_data.get_max_ra(); ++ra)
     for (int a = fan_data.get_min_a(); a <= fan_data.get_max_a(); ++a)
       // 1// for (int rb = fan_data.get_min_ra(); rb <= fan_data.get_max_ra(); ++rb)
@@ -1568,6 +1633,9 @@ make_geo_data(GeoData3D& geo_data, const FanProjData& fan_data)
 
   geo_data.fill(0);
 
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
   for (int ra = 0; ra < num_axial_crystals_per_block; ++ra)
     //  for (int a = 0; a <= num_transaxial_detectors/2; ++a)
     for (int a = 0; a < num_transaxial_crystals_per_block / 2; ++a)
@@ -1612,18 +1680,90 @@ make_block_data(BlockData3D& block_data, const FanProjData& fan_data)
   assert(num_transaxial_blocks * num_transaxial_crystals_per_block == num_transaxial_detectors);
 
   block_data.fill(0);
-  for (int ra = fan_data.get_min_ra(); ra <= fan_data.get_max_ra(); ++ra)
-    for (int a = fan_data.get_min_a(); a <= fan_data.get_max_a(); ++a)
-      // loop rb from ra to avoid double counting
-      for (int rb = max(ra, fan_data.get_min_rb(ra)); rb <= fan_data.get_max_rb(ra); ++rb)
-        for (int b = fan_data.get_min_b(a); b <= fan_data.get_max_b(a); ++b)
-          {
-            block_data(ra / num_axial_crystals_per_block,
-                       a / num_transaxial_crystals_per_block,
-                       rb / num_axial_crystals_per_block,
-                       b / num_transaxial_crystals_per_block)
-                += fan_data(ra, a, rb, b);
-          }
+#ifdef STIR_OPENMP
+#  pragma omp parallel
+#endif
+  {
+    // every thread accumulates in its own (small) block data, which are added at the end
+    BlockData3D local_block_data = block_data;
+#ifdef STIR_OPENMP
+#  pragma omp for schedule(dynamic)
+#endif
+    for (int ra = fan_data.get_min_ra(); ra <= fan_data.get_max_ra(); ++ra)
+      for (int a = fan_data.get_min_a(); a <= fan_data.get_max_a(); ++a)
+        // loop rb from ra to avoid double counting
+        for (int rb = max(ra, fan_data.get_min_rb(ra)); rb <= fan_data.get_max_rb(ra); ++rb)
+          for (int b = fan_data.get_min_b(a); b <= fan_data.get_max_b(a); ++b)
+            {
+              local_block_data(ra / num_axial_crystals_per_block,
+                               a / num_transaxial_crystals_per_block,
+                               rb / num_axial_crystals_per_block,
+                               b / num_transaxial_crystals_per_block)
+                  += fan_data(ra, a, rb, b);
+            }
+#ifdef STIR_OPENMP
+#  pragma omp critical(ML_NORM_ADD_BLOCK_DATA)
+#endif
+    block_data += local_block_data;
+  }
+}
+
+/* Sequential (Gauss-Seidel) update of the efficiencies: the new efficiency of a detector is used to
+   compute the next ones. We therefore cannot process detectors in parallel. Instead, the threads
+   compute the sum in the denominator together, one ring (rb) per iteration.
+
+   To avoid a second barrier per detector (to update the shared efficiencies), every thread keeps its
+   own copy of the efficiencies and computes the new value itself. The sum over the rings is done in
+   the same order by every thread, so all copies stay identical, and the result does not depend on the
+   number of threads. The sums per ring alternate between 2 arrays, such that a thread can only
+   overwrite them after all threads have passed the barrier of the next detector.
+
+   \a get_ring_range(ra, min_rb, max_rb) sets the range of rings in the fan of ring \a ra.
+   \a ring_sum(efficiencies, ra, a, rb) returns the contribution of ring \a rb to the denominator.
+*/
+template <class RingRangeT, class RingSumT>
+static void
+sequential_update_of_efficiencies(DetectorEfficiencies& efficiencies,
+                                  const Array<2, float>& data_fan_sums,
+                                  RingRangeT get_ring_range,
+                                  RingSumT ring_sum)
+{
+  std::vector<float> sums_per_ring[2];
+  for (auto& sums : sums_per_ring)
+    sums.resize(efficiencies.get_max_index() + 1);
+#ifdef STIR_OPENMP
+#  pragma omp parallel
+#endif
+  {
+    DetectorEfficiencies local_efficiencies(efficiencies);
+    int current_sums = 0;
+    for (int ra = data_fan_sums.get_min_index(); ra <= data_fan_sums.get_max_index(); ++ra)
+      for (int a = data_fan_sums[ra].get_min_index(); a <= data_fan_sums[ra].get_max_index(); ++a)
+        {
+          if (data_fan_sums[ra][a] == 0)
+            {
+              local_efficiencies[ra][a] = 0;
+              continue;
+            }
+          int min_rb, max_rb;
+          get_ring_range(ra, min_rb, max_rb);
+          std::vector<float>& sums = sums_per_ring[current_sums];
+          current_sums = 1 - current_sums;
+#ifdef STIR_OPENMP
+#  pragma omp for schedule(static)
+#endif
+          for (int rb = min_rb; rb <= max_rb; ++rb)
+            sums[rb] = ring_sum(local_efficiencies, ra, a, rb);
+          float denominator = 0;
+          for (int rb = min_rb; rb <= max_rb; ++rb)
+            denominator += sums[rb];
+          local_efficiencies[ra][a] = data_fan_sums[ra][a] / denominator;
+        }
+#ifdef STIR_OPENMP
+#  pragma omp single
+#endif
+    efficiencies = local_efficiencies;
+  }
 }
 
 void
@@ -1634,20 +1774,19 @@ iterate_efficiencies(DetectorEfficiencies& efficiencies, const Array<2, float>&
   assert(model.get_max_ra() == data_fan_sums.get_max_index());
   assert(model.get_min_a() == data_fan_sums[data_fan_sums.get_min_index()].get_min_index());
   assert(model.get_max_a() == data_fan_sums[data_fan_sums.get_min_index()].get_max_index());
-  for (int ra = model.get_min_ra(); ra <= model.get_max_ra(); ++ra)
-    for (int a = model.get_min_a(); a <= model.get_max_a(); ++a)
-      {
-        if (data_fan_sums[ra][a] == 0)
-          efficiencies[ra][a] = 0;
-        else
-          {
-            float denominator = 0;
-            for (int rb = model.get_min_rb(ra); rb <= model.get_max_rb(ra); ++rb)
-              for (int b = model.get_min_b(a); b <= model.get_max_b(a); ++b)
-                denominator += efficiencies[rb][b % num_detectors_per_ring] * model(ra, a, rb, b);
-            efficiencies[ra][a] = data_fan_sums[ra][a] / denominator;
-          }
-      }
+  sequential_update_of_efficiencies(
+      efficiencies,
+      data_fan_sums,
+      [&model](const int ra, int& min_rb, int& max_rb) {
+        min_rb = model.get_min_rb(ra);
+        max_rb = model.get_max_rb(ra);
+      },
+      [&model, num_detectors_per_ring](const DetectorEfficiencies& eff, const int ra, const int a, const int rb) {
+        float sum = 0;
+        for (int b = model.get_min_b(a); b <= model.get_max_b(a); ++b)
+          sum += eff[rb][b % num_detectors_per_ring] * model(ra, a, rb, b);
+        return sum;
+      });
 }
 
 // version without model
@@ -1659,42 +1798,38 @@ iterate_efficiencies(DetectorEfficiencies& efficiencies,
 {
   const int num_rings = data_fan_sums.get_length();
   const int num_detectors_per_ring = data_fan_sums[data_fan_sums.get_min_index()].get_length();
+  sequential_update_of_efficiencies(
+      efficiencies,
+      data_fan_sums,
+      [max_ring_diff, num_rings](const int ra, int& min_rb, int& max_rb) {
+        min_rb = max(ra - max_ring_diff, 0);
+        max_rb = min(ra + max_ring_diff, num_rings - 1);
+      },
+      [num_detectors_per_ring, half_fan_size](const DetectorEfficiencies& eff, const int ra, const int a, const int rb) {
+        float sum = 0;
+        for (int b = a + num_detectors_per_ring / 2 - half_fan_size; b <= a + num_detectors_per_ring / 2 + half_fan_size; ++b)
+          sum += eff[rb][b % num_detectors_per_ring];
+        return sum;
+      });
 #ifdef WRITE_ALL
-  static int sub_iter_num = 0;
-#endif
-  for (int ra = data_fan_sums.get_min_index(); ra <= data_fan_sums.get_max_index(); ++ra)
-    for (int a = data_fan_sums[ra].get_min_index(); a <= data_fan_sums[ra].get_max_index(); ++a)
+  {
+    static int iter_num = 0;
+    char out_filename[100];
+    sprintf(out_filename, "MLresult_iter_eff_1_%d.out", iter_num++);
+    ofstream out(out_filename);
+    if (!out)
       {
-        if (data_fan_sums[ra][a] == 0)
-          efficiencies[ra][a] = 0;
-        else
-          {
-            float denominator = 0;
-            for (int rb = max(ra - max_ring_diff, 0); rb <= min(ra + max_ring_diff, num_rings - 1); ++rb)
-              for (int b = a + num_detectors_per_ring / 2 - half_fan_size; b <= a + num_detectors_per_ring / 2 + half_fan_size;
-                   ++b)
-                denominator += efficiencies[rb][b % num_detectors_per_ring];
-            efficiencies[ra][a] = data_fan_sums[ra][a] / denominator;
-          }
-#ifdef WRITE_ALL
-        {
-          char out_filename[100];
-          sprintf(out_filename, "MLresult_subiter_eff_1_%d.out", sub_iter_num++);
-          ofstream out(out_filename);
-          if (!out)
-            {
-              warning("Error opening output file %s\n", out_filename);
-              exit(EXIT_FAILURE);
-            }
-          out << efficiencies;
-          if (!out)
-            {
-              warning("Error writing data to output file %s\n", out_filename);
-              exit(EXIT_FAILURE);
-            }
-        }
-#endif
+        warning("Error opening output file %s\n", out_filename);
+        exit(EXIT_FAILURE);
+      }
+    out << efficiencies;
+    if (!out)
+      {
+        warning("Error writing data to output file %s\n", out_filename);
+        exit(EXIT_FAILURE);
       }
+  }
+#endif
 }
 
 void
@@ -1746,6 +1881,9 @@ double
 KL(const FanProjData& d1, const FanProjData& d2, const double threshold)
 {
   double sum = 0;
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic) reduction(+ : sum)
+#endif
   for (int ra = d1.get_min_ra(); ra <= d1.get_max_ra(); ++ra)
     {
       double asum = 0;
@@ -0,0 +1,448 @@
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+
+  \file
+  \ingroup buildblock
+
+  \brief Implementation of class stir::ProfilingRegistry
+
+  \author STIR contributors
+*/
+
+#include "stir/ProfilingRegistry.h"
+#include "stir/info.h"
+#include "stir/warning.h"
+#include "stir/format.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <ostream>
+
+START_NAMESPACE_STIR
+
+namespace detail
+{
+
+typedef std::chrono::steady_clock profiling_clock;
+
+//! All profiling data of a single thread
+class ThreadProfile
+{
+public:
+  //! a node in the tree of scopes, node 0 is the (unnamed) root
+  struct Node
+  {
+    int name_id;
+    int parent;
+    std::vector<int> children;
+    std::size_t count = 0;
+    double total_time = 0.;
+    double max_time = 0.;
+  };
+  struct StackEntry
+  {
+    int node;
+    int name_id;
+    profiling_clock::time_point start_time;
+  };
+  struct TraceEvent
+  {
+    int name_id;
+    profiling_clock::time_point start_time;
+    double duration;
+  };
+
+  explicit ThreadProfile(const int thread_num)
+      : thread_num(thread_num)
+  {
+    this->reset();
+  }
+
+  void reset()
+  {
+    nodes.assign(1, Node());
+    nodes[0].name_id = -1;
+    nodes[0].parent = -1;
+    stack.clear();
+    counters.clear();
+    trace_events.clear();
+    num_dropped_trace_events = 0;
+  }
+
+  int find_or_create_child(const int parent, const int name_id)
+  {
+    for (const int child : nodes[parent].children)
+      if (nodes[child].name_id == name_id)
+        return child;
+    const int child = static_cast<int>(nodes.size());
+    Node node;
+    node.name_id = name_id;
+    node.parent = parent;
+    nodes.push_back(node);
+    nodes[parent].children.push_back(child);
+    return child;
+  }
+
+  std::string get_path(int node, const std::vector<std::string>& scope_names) const
+  {
+    std::string path = scope_names[nodes[node].name_id];
+    while ((node = nodes[node].parent) > 0)
+      path = scope_names[nodes[node].name_id] + '/' + path;
+    return path;
+  }
+
+  const int thread_num;
+  std::vector<Node> nodes;
+  std::vector<StackEntry> stack;
+  std::vector<long long> counters;
+  std::vector<TraceEvent> trace_events;
+  std::size_t num_dropped_trace_events;
+};
+
+} // namespace detail
+
+namespace
+{
+thread_local detail::ThreadProfile* current_thread_profile_ptr = nullptr;
+// time-point used as origin for the trace events
+detail::profiling_clock::time_point profiling_origin = detail::profiling_clock::now();
+
+//! write a string as a JSON string, including quotes
+void
+write_json_string(std::ostream& s, const std::string& str)
+{
+  s << '"';
+  for (const char c : str)
+    {
+      if (c == '"' || c == '\\')
+        s << '\\' << c;
+      else if (static_cast<unsigned char>(c) < 0x20)
+        s << ' ';
+      else
+        s << c;
+    }
+  s << '"';
+}
+
+bool
+is_chrome_trace_filename(const std::string& filename)
+{
+  const std::string suffix = ".trace.json";
+  return filename.size() >= suffix.size() && filename.compare(filename.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+int
+find_or_add_name(std::vector<std::string>& names, const std::string& name)
+{
+  const auto iter = std::find(names.begin(), names.end(), name);
+  if (iter != names.end())
+    return static_cast<int>(iter - names.begin());
+  names.push_back(name);
+  return static_cast<int>(names.size()) - 1;
+}
+} // namespace
+
+ProfilingRegistry&
+ProfilingRegistry::instance()
+{
+  static ProfilingRegistry registry;
+  return registry;
+}
+
+ProfilingRegistry::ProfilingRegistry()
+    : _enabled(false),
+      _record_trace_events(false),
+      _max_num_trace_events_per_thread(1000000)
+{}
+
+ProfilingRegistry::~ProfilingRegistry() = default;
+
+void
+ProfilingRegistry::set_enabled(const bool enabled)
+{
+  _enabled = enabled;
+}
+
+void
+ProfilingRegistry::set_record_trace_events(const bool record)
+{
+  _record_trace_events = record;
+}
+
+bool
+ProfilingRegistry::get_record_trace_events() const
+{
+  return _record_trace_events;
+}
+
+void
+ProfilingRegistry::set_max_num_trace_events_per_thread(const std::size_t max_num)
+{
+  _max_num_trace_events_per_thread = max_num;
+}
+
+void
+ProfilingRegistry::reset()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (auto& profile_uptr : _thread_profiles)
+    profile_uptr->reset();
+  profiling_origin = detail::profiling_clock::now();
+}
+
+int
+ProfilingRegistry::register_scope_name(const std::string& name)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return find_or_add_name(_scope_names, name);
+}
+
+int
+ProfilingRegistry::register_counter_name(const std::string& name)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return find_or_add_name(_counter_names, name);
+}
+
+detail::ThreadProfile&
+ProfilingRegistry::get_thread_profile()
+{
+  if (current_thread_profile_ptr == nullptr)
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      // note: the registry keeps the profile, such that results are still available after the thread exits
+      _thread_profiles.emplace_back(new detail::ThreadProfile(static_cast<int>(_thread_profiles.size())));
+      current_thread_profile_ptr = _thread_profiles.back().get();
+    }
+  return *current_thread_profile_ptr;
+}
+
+void
+ProfilingRegistry::enter_scope(const int name_id)
+{
+  detail::ThreadProfile& profile = this->get_thread_profile();
+  const int parent = profile.stack.empty() ? 0 : profile.stack.back().node;
+  const int node = profile.find_or_create_child(parent, name_id);
+  profile.stack.push_back({ node, name_id, detail::profiling_clock::now() });
+}
+
+void
+ProfilingRegistry::leave_scope(const int name_id)
+{
+  const auto end_time = detail::profiling_clock::now();
+  detail::ThreadProfile& profile = this->get_thread_profile();
+  // this happens if profiling was enabled while inside the scope
+  if (profile.stack.empty() || profile.stack.back().name_id != name_id)
+    return;
+  const auto entry = profile.stack.back();
+  profile.stack.pop_back();
+  const double duration = std::chrono::duration<double>(end_time - entry.start_time).count();
+  auto& node = profile.nodes[entry.node];
+  ++node.count;
+  node.total_time += duration;
+  node.max_time = std::max(node.max_time, duration);
+  if (_record_trace_events.load(std::memory_order_relaxed))
+    {
+      if (profile.trace_events.size() < _max_num_trace_events_per_thread.load(std::memory_order_relaxed))
+        profile.trace_events.push_back({ name_id, entry.start_time, duration });
+      else
+        ++profile.num_dropped_trace_events;
+    }
+}
+
+void
+ProfilingRegistry::add_to_counter(const int counter_id, const long long value)
+{
+  detail::ThreadProfile& profile = this->get_thread_profile();
+  if (profile.counters.size() <= static_cast<std::size_t>(counter_id))
+    profile.counters.resize(counter_id + 1, 0LL);
+  profile.counters[counter_id] += value;
+}
+
+std::vector<ProfilingRegistry::ScopeStatistics>
+ProfilingRegistry::get_scope_statistics() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  std::map<std::string, ScopeStatistics> stats_map;
+  for (const auto& profile_uptr : _thread_profiles)
+    {
+      const auto& profile = *profile_uptr;
+      for (int node_num = 1; node_num < static_cast<int>(profile.nodes.size()); ++node_num)
+        {
+          const auto& node = profile.nodes[node_num];
+          if (node.count == 0)
+            continue;
+          const std::string path = profile.get_path(node_num, _scope_names);
+          ScopeStatistics& stats = stats_map[path];
+          stats.path = path;
+          stats.count += node.count;
+          stats.total_time += node.total_time;
+          stats.max_time = std::max(stats.max_time, node.max_time);
+          ++stats.num_threads;
+        }
+    }
+  std::vector<ScopeStatistics> result;
+  result.reserve(stats_map.size());
+  for (const auto& path_and_stats : stats_map)
+    result.push_back(path_and_stats.second);
+  return result;
+}
+
+std::vector<ProfilingRegistry::CounterValue>
+ProfilingRegistry::get_counter_totals() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  std::vector<long long> totals(_counter_names.size(), 0LL);
+  for (const auto& profile_uptr : _thread_profiles)
+    for (std::size_t i = 0; i < profile_uptr->counters.size(); ++i)
+      totals[i] += profile_uptr->counters[i];
+  std::vector<CounterValue> result;
+  for (std::size_t i = 0; i < totals.size(); ++i)
+    result.push_back({ _counter_names[i], totals[i] });
+  return result;
+}
+
+void
+ProfilingRegistry::write_json(std::ostream& s) const
+{
+  const auto scope_stats = this->get_scope_statistics();
+  const auto counter_totals = this->get_counter_totals();
+
+  s << std::setprecision(9);
+  s << "{\n  \"scopes\": [";
+  for (std::size_t i = 0; i < scope_stats.size(); ++i)
+    {
+      const auto& stats = scope_stats[i];
+      s << (i == 0 ? "\n" : ",\n") << "    {\"path\": ";
+      write_json_string(s, stats.path);
+      s << ", \"count\": " << stats.count << ", \"total_time\": " << stats.total_time << ", \"max_time\": " << stats.max_time
+        << ", \"num_threads\": " << stats.num_threads << "}";
+    }
+  s << "\n  ],\n  \"counters\": {";
+  for (std::size_t i = 0; i < counter_totals.size(); ++i)
+    {
+      s << (i == 0 ? "\n    " : ",\n    ");
+      write_json_string(s, counter_totals[i].name);
+      s << ": " << counter_totals[i].value;
+    }
+  s << "\n  },\n  \"threads\": [";
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (std::size_t t = 0; t < _thread_profiles.size(); ++t)
+      {
+        const auto& profile = *_thread_profiles[t];
+        s << (t == 0 ? "\n" : ",\n") << "    {\"thread\": " << profile.thread_num << ", \"counters\": {";
+        bool first = true;
+        for (std::size_t i = 0; i < profile.counters.size(); ++i)
+          {
+            if (profile.counters[i] == 0)
+              continue;
+            s << (first ? "" : ", ");
+            first = false;
+            write_json_string(s, _counter_names[i]);
+            s << ": " << profile.counters[i];
+          }
+        s << "}}";
+      }
+  }
+  s << "\n  ]\n}\n";
+}
+
+void
+ProfilingRegistry::write_chrome_trace(std::ostream& s) const
+{
+  const auto counter_totals = this->get_counter_totals();
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  s << std::setprecision(15);
+  s << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+  bool first = true;
+  auto start_event = [&s, &first]() {
+    s << (first ? "\n" : ",\n");
+    first = false;
+  };
+  double end_of_trace = 0.;
+  for (const auto& profile_uptr : _thread_profiles)
+    {
+      const auto& profile = *profile_uptr;
+      start_event();
+      s << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << profile.thread_num
+        << ", \"args\": {\"name\": \"thread " << profile.thread_num << "\"}}";
+      for (const auto& event : profile.trace_events)
+        {
+          // times in micro-seconds
+          const double start = std::chrono::duration<double, std::micro>(event.start_time - profiling_origin).count();
+          const double duration = event.duration * 1.E6;
+          end_of_trace = std::max(end_of_trace, start + duration);
+          start_event();
+          s << "{\"name\": ";
+          write_json_string(s, _scope_names[event.name_id]);
+          s << ", \"cat\": \"stir\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << profile.thread_num << ", \"ts\": " << start
+            << ", \"dur\": " << duration << "}";
+        }
+      if (profile.num_dropped_trace_events > 0)
+        warning(format("ProfilingRegistry: {} trace events of thread {} were not recorded",
+                       profile.num_dropped_trace_events,
+                       profile.thread_num));
+    }
+  // write counter totals at the end of the trace
+  for (const auto& counter : counter_totals)
+    {
+      start_event();
+      s << "{\"name\": ";
+      write_json_string(s, counter.name);
+      s << ", \"ph\": \"C\", \"pid\": 1, \"ts\": " << end_of_trace << ", \"args\": {\"value\": " << counter.value << "}}";
+    }
+  s << "\n]}\n";
+}
+
+Succeeded
+ProfilingRegistry::write_report(const std::string& filename) const
+{
+  std::ofstream s(filename.c_str());
+  if (!s)
+    {
+      warning(format("ProfilingRegistry: error opening file {} for writing", filename));
+      return Succeeded::no;
+    }
+  if (is_chrome_trace_filename(filename))
+    this->write_chrome_trace(s);
+  else
+    this->write_json(s);
+  return s ? Succeeded::yes : Succeeded::no;
+}
+
+bool
+ProfilingRegistry::set_up_from_environment()
+{
+  const char* const filename = std::getenv("STIR_PROFILING_REPORT");
+  if (filename == nullptr || *filename == '\0')
+    return false;
+  _report_filename = filename;
+  this->set_record_trace_events(is_chrome_trace_filename(_report_filename));
+  this->reset();
+  this->set_enabled(true);
+  info(format("Profiling enabled. Report will be written to {}", _report_filename), 2);
+  return true;
+}
+
+void
+ProfilingRegistry::write_report_if_requested() const
+{
+  if (_report_filename.empty())
+    return;
+  if (this->write_report(_report_filename) == Succeeded::yes)
+    info(format("Profiling report written to {}", _report_filename));
+}
+
+END_NAMESPACE_STIR
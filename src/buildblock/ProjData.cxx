@@ -41,6 +41,9 @@
 #include "stir/ProjDataInfoSubsetByView.h"
 #include "stir/Viewgram.h"
 
+#ifdef HAVE_ZLIB
+#  include "stir/ProjDataCompressed.h"
+#endif
 #ifdef HAVE_HDF5
 #  include "stir/ProjDataGEHDF5.h"
 #  include "stir/IO/GEHDF5Wrapper.h"
@@ -78,6 +81,7 @@ START_NAMESPACE_STIR
    Currently supported:
    <ul>
    <li> Interfile (using  read_interfile_PDFS())
+   <li> Interfile with compressed data (see ProjDataCompressed, only if STIR was built with zlib)
    <li> ECAT 7 3D sinograms and attenuation files
    >li> GE RDF9 (in HDF5)
    </ul>
@@ -130,6 +134,10 @@ ProjData::read_from_file(const string& filename, const std::ios::openmode openmo
     {
 #ifndef NDEBUG
       info("ProjData::read_from_file trying to read " + filename + " as Interfile", 3);
+#endif
+#ifdef HAVE_ZLIB
+      if (ProjDataCompressed::is_compressed_interfile_header(actual_filename))
+        return std::make_shared<ProjDataCompressed>(actual_filename, openmode);
 #endif
       shared_ptr<ProjData> ptr(read_interfile_PDFS(filename, openmode));
       if (!is_null_ptr(ptr))
@@ -0,0 +1,761 @@
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup projdata
+  \brief Implementation of class stir::ProjDataCompressed
+
+  \author STIR contributors
+*/
+
+#include "stir/ProjDataCompressed.h"
+#include "stir/ProjDataFromStream.h"
+#include "stir/ProjDataInfo.h"
+#include "stir/SegmentByView.h"
+#include "stir/Viewgram.h"
+#include "stir/Sinogram.h"
+#include "stir/ExamInfo.h"
+#include "stir/IO/interfile.h"
+#include "stir/IO/InterfileHeader.h"
+#include "stir/interfile_keyword_functions.h"
+#include "stir/utilities.h"
+#include "stir/Succeeded.h"
+#include "stir/is_null_ptr.h"
+#include "stir/IndexRange2D.h"
+#include "stir/error.h"
+#include "stir/warning.h"
+#include "stir/format.h"
+#include <zlib.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+START_NAMESPACE_STIR
+
+static const char index_signature[] = "STIRzidx";
+static const std::size_t index_signature_size = 8;
+
+bool
+ProjDataCompressed::is_compressed_interfile_header(const std::string& filename)
+{
+  std::ifstream input(filename.c_str());
+  if (!input)
+    return false;
+  MinimalInterfileHeader hdr;
+  if (!hdr.parse(input, false))
+    return false;
+  return standardise_interfile_keyword(hdr.data_compression) != "none";
+}
+
+ProjDataCompressed::ProjDataCompressed(const std::string& filename, const std::ios::openmode open_mode)
+    : is_writable((open_mode & std::ios::out) != 0),
+      index_modified(false),
+      compression_level(Z_DEFAULT_COMPRESSION),
+      end_of_chunks(0)
+{
+  std::ifstream header_stream(filename.c_str());
+  if (!header_stream)
+    error(format("ProjDataCompressed: couldn't open header '{}'", filename));
+  InterfilePDFSHeader hdr;
+  if (!hdr.parse(header_stream))
+    error(format("ProjDataCompressed: Interfile parsing of '{}' failed", filename));
+
+  if (standardise_interfile_keyword(hdr.data_compression) != "zlib")
+    error(format("ProjDataCompressed: '{}' has unsupported data compression '{}'", filename, hdr.data_compression));
+  if (hdr.type_of_numbers != NumericType::FLOAT)
+    error(format("ProjDataCompressed: '{}' has to contain float data", filename));
+  if (hdr.image_scaling_factors[0][0] != 1)
+    error(format("ProjDataCompressed: '{}' has a scale factor, which is not supported", filename));
+  if (hdr.storage_order != ProjDataFromStream::Segment_AxialPos_View_TangPos
+      && hdr.storage_order != ProjDataFromStream::Timing_Segment_AxialPos_View_TangPos)
+    error(format("ProjDataCompressed: '{}' has to use storage order by sinogram", filename));
+  if (hdr.segment_sequence != standard_segment_sequence(*hdr.data_info_sptr))
+    error(format("ProjDataCompressed: '{}' has to use the standard segment sequence", filename));
+  if (hdr.timing_poss_sequence.size() > 1)
+    for (std::size_t i = 0; i < hdr.timing_poss_sequence.size(); ++i)
+      if (hdr.timing_poss_sequence[i] != hdr.data_info_sptr->get_min_tof_pos_num() + static_cast<int>(i))
+        error(format("ProjDataCompressed: '{}' has to use TOF bins in increasing order", filename));
+
+  this->exam_info_sptr = hdr.get_exam_info_sptr();
+  this->proj_data_info_sptr = hdr.data_info_sptr->create_shared_clone();
+  this->byte_order = hdr.file_byte_order;
+  this->set_up_chunks();
+
+  char full_data_file_name[max_filename_length];
+  strcpy(full_data_file_name, hdr.data_file_name.c_str());
+  char directory_name[max_filename_length];
+  get_directory_name(directory_name, filename.c_str());
+  prepend_directory_name(full_data_file_name, directory_name);
+
+  this->data_filename = full_data_file_name;
+  this->open_data_file(this->data_filename, this->is_writable ? std::ios::in | std::ios::out : std::ios::in);
+  this->read_index();
+}
+
+ProjDataCompressed::ProjDataCompressed(shared_ptr<const ExamInfo> const& exam_info_sptr,
+                                       shared_ptr<const ProjDataInfo> const& proj_data_info_sptr,
+                                       const std::string& filename,
+                                       const int compression_level,
+                                       const ByteOrder byte_order)
+    : ProjData(exam_info_sptr, proj_data_info_sptr),
+      is_writable(true),
+      index_modified(true),
+      compression_level(compression_level),
+      byte_order(byte_order),
+      end_of_chunks(0)
+{
+  this->set_up_chunks();
+
+  std::string header_filename = filename;
+  replace_extension(header_filename, ".hs");
+  this->data_filename = filename;
+  replace_extension(this->data_filename, ".sz");
+  // use a ProjDataFromStream object to describe the layout for the header
+  const ProjDataFromStream layout(exam_info_sptr,
+                                  proj_data_info_sptr,
+                                  shared_ptr<std::iostream>(),
+                                  0,
+                                  standard_segment_sequence(*proj_data_info_sptr),
+                                  ProjDataFromStream::Segment_AxialPos_View_TangPos,
+                                  NumericType::FLOAT,
+                                  this->byte_order);
+  if (write_basic_interfile_PDFS_header(header_filename, this->data_filename, layout, "zlib") == Succeeded::no)
+    error(format("ProjDataCompressed: error writing header '{}'", header_filename));
+
+  this->open_data_file(this->data_filename, std::ios::in | std::ios::out | std::ios::trunc);
+}
+
+ProjDataCompressed::~ProjDataCompressed()
+{
+  this->close();
+}
+
+void
+ProjDataCompressed::set_up_chunks()
+{
+  const ProjDataInfo& pdi = *this->proj_data_info_sptr;
+  this->first_chunk_nums.resize(pdi.get_min_tof_pos_num(), pdi.get_max_tof_pos_num());
+  std::size_t chunk_num = 0;
+  for (int timing_pos = pdi.get_min_tof_pos_num(); timing_pos <= pdi.get_max_tof_pos_num(); ++timing_pos)
+    {
+      this->first_chunk_nums[timing_pos].resize(pdi.get_min_segment_num(), pdi.get_max_segment_num());
+      for (const int segment_num : standard_segment_sequence(pdi))
+        {
+          this->first_chunk_nums[timing_pos][segment_num] = chunk_num;
+          chunk_num += pdi.get_num_axial_poss(segment_num);
+        }
+    }
+  this->chunks.assign(chunk_num, ChunkInfo{ 0, 0 });
+}
+
+void
+ProjDataCompressed::open_data_file(const std::string& data_filename, const std::ios::openmode open_mode)
+{
+  this->data_stream.open(data_filename.c_str(), open_mode | std::ios::binary);
+  if (!this->data_stream)
+    error(format("ProjDataCompressed: error opening data file '{}'", data_filename));
+}
+
+static const std::uint64_t trailer_size = sizeof(std::uint64_t) + index_signature_size;
+
+bool
+ProjDataCompressed::read_index_ending_at(const std::uint64_t end_of_index)
+{
+  const std::size_t index_size = 2 * this->chunks.size();
+  if (end_of_index < index_size * sizeof(std::uint64_t) + trailer_size)
+    return false;
+
+  std::uint64_t index_offset;
+  char signature[index_signature_size];
+  this->data_stream.clear();
+  this->data_stream.seekg(static_cast<std::streamoff>(end_of_index - trailer_size));
+  this->data_stream.read(reinterpret_cast<char*>(&index_offset), sizeof(index_offset));
+  this->data_stream.read(signature, index_signature_size);
+  if (!this->data_stream || std::strncmp(signature, index_signature, index_signature_size) != 0)
+    return false;
+  if (!this->byte_order.is_native_order())
+    ByteOrder::swap_order(index_offset);
+  if (index_offset + index_size * sizeof(std::uint64_t) + trailer_size != end_of_index)
+    return false;
+
+  std::vector<std::uint64_t> index(index_size);
+  this->data_stream.seekg(static_cast<std::streamoff>(index_offset));
+  this->data_stream.read(reinterpret_cast<char*>(index.data()), index_size * sizeof(std::uint64_t));
+  if (!this->data_stream)
+    return false;
+  if (!this->byte_order.is_native_order())
+    for (auto& value : index)
+      ByteOrder::swap_order(value);
+  for (std::size_t chunk_num = 0; chunk_num < this->chunks.size(); ++chunk_num)
+    if (index[2 * chunk_num] + index[2 * chunk_num + 1] > index_offset)
+      return false;
+  for (std::size_t chunk_num = 0; chunk_num < this->chunks.size(); ++chunk_num)
+    {
+      this->chunks[chunk_num].offset = index[2 * chunk_num];
+      this->chunks[chunk_num].size = index[2 * chunk_num + 1];
+    }
+  return true;
+}
+
+void
+ProjDataCompressed::read_index()
+{
+  this->data_stream.seekg(0, std::ios::end);
+  const std::uint64_t file_size = static_cast<std::uint64_t>(this->data_stream.tellg());
+  // new chunks will be written after the current index, such that the file stays valid until close()
+  this->end_of_chunks = file_size;
+  if (this->read_index_ending_at(file_size))
+    return;
+
+  // the file was probably modified without calling close(), use the last complete index
+  warning(format("ProjDataCompressed: data file '{}' does not end with an index. Was it closed properly? "
+                 "Using the last complete index in the file.",
+                 this->data_filename));
+  std::vector<char> buffer(1 << 20);
+  std::uint64_t block_end = file_size;
+  while (block_end >= index_signature_size)
+    {
+      const std::uint64_t block_start = block_end > buffer.size() ? block_end - buffer.size() : 0;
+      this->data_stream.clear();
+      this->data_stream.seekg(static_cast<std::streamoff>(block_start));
+      this->data_stream.read(buffer.data(), static_cast<std::streamsize>(block_end - block_start));
+      if (!this->data_stream)
+        break;
+      for (std::uint64_t pos = block_end - index_signature_size + 1; pos-- > block_start;)
+        if (std::strncmp(buffer.data() + (pos - block_start), index_signature, index_signature_size) == 0
+            && this->read_index_ending_at(pos + index_signature_size))
+          {
+            // make sure that close() writes a new index
+            this->index_modified = this->is_writable;
+            return;
+          }
+      if (block_start == 0)
+        break;
+      // blocks overlap, such that a signature on the boundary is found
+      block_end = block_start + index_signature_size - 1;
+    }
+  error(format("ProjDataCompressed: data file '{}' does not contain a valid index", this->data_filename));
+}
+
+Succeeded
+ProjDataCompressed::write_index(std::ostream& stream,
+                                const std::vector<ChunkInfo>& chunks_to_write,
+                                const std::uint64_t index_offset) const
+{
+  std::vector<std::uint64_t> index;
+  index.reserve(2 * chunks_to_write.size() + 1);
+  for (const auto& chunk : chunks_to_write)
+    {
+      index.push_back(chunk.offset);
+      index.push_back(chunk.size);
+    }
+  index.push_back(index_offset);
+  if (!this->byte_order.is_native_order())
+    for (auto& value : index)
+      ByteOrder::swap_order(value);
+  stream.seekp(static_cast<std::streamoff>(index_offset));
+  stream.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(std::uint64_t));
+  stream.write(index_signature, index_signature_size);
+  stream.flush();
+  return stream ? Succeeded::yes : Succeeded::no;
+}
+
+Succeeded
+ProjDataCompressed::remove_unused_space()
+{
+  const std::string new_data_filename = this->data_filename + ".tmp";
+  std::ofstream new_data_stream(new_data_filename.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+  if (!new_data_stream)
+    {
+      warning(format("ProjDataCompressed: error opening '{}'. Unused space is not removed from the data file.",
+                     new_data_filename));
+      return Succeeded::no;
+    }
+  // copy the chunks in the order of the index
+  std::vector<ChunkInfo> new_chunks(this->chunks.size(), ChunkInfo{ 0, 0 });
+  std::uint64_t new_end_of_chunks = 0;
+  bool new_file_is_ok = true;
+  try
+    {
+      for (std::size_t chunk_num = 0; chunk_num < this->chunks.size() && new_data_stream; ++chunk_num)
+        {
+          const std::vector<char> compressed = this->read_compressed_chunk(chunk_num);
+          if (compressed.empty())
+            continue;
+          new_data_stream.write(compressed.data(), static_cast<std::streamsize>(compressed.size()));
+          new_chunks[chunk_num] = ChunkInfo{ new_end_of_chunks, compressed.size() };
+          new_end_of_chunks += compressed.size();
+        }
+    }
+  catch (const std::exception&)
+    {
+      // close() is called by the destructor, so we cannot throw
+      new_file_is_ok = false;
+    }
+  new_file_is_ok = new_file_is_ok && new_data_stream
+                   && this->write_index(new_data_stream, new_chunks, new_end_of_chunks) == Succeeded::yes;
+  new_data_stream.close();
+  if (!new_file_is_ok || !new_data_stream)
+    {
+      warning(format("ProjDataCompressed: error writing '{}'. Unused space is not removed from the data file.",
+                     new_data_filename));
+      std::remove(new_data_filename.c_str());
+      return Succeeded::no;
+    }
+
+  this->data_stream.close();
+  // std::rename does not replace existing files on all systems
+  if (std::rename(new_data_filename.c_str(), this->data_filename.c_str()) != 0
+      && (std::remove(this->data_filename.c_str()) != 0
+          || std::rename(new_data_filename.c_str(), this->data_filename.c_str()) != 0))
+    {
+      warning(format("ProjDataCompressed: error renaming '{}' to '{}'", new_data_filename, this->data_filename));
+      return Succeeded::no;
+    }
+  this->chunks = new_chunks;
+  this->end_of_chunks = new_end_of_chunks;
+  return Succeeded::yes;
+}
+
+Succeeded
+ProjDataCompressed::close()
+{
+  std::lock_guard<std::mutex> lock(this->data_mutex);
+  if (!this->data_stream.is_open())
+    return Succeeded::yes;
+
+  Succeeded success = Succeeded::yes;
+  for (auto& cached_segment : this->cached_segments)
+    if (this->write_cached_segment(cached_segment) == Succeeded::no)
+      success = Succeeded::no;
+  if (this->index_modified)
+    {
+      // first make the data file valid, such that it can be used if removing unused space fails
+      if (this->write_index(this->data_stream, this->chunks, this->end_of_chunks) == Succeeded::no)
+        {
+          warning("ProjDataCompressed: error writing index");
+          success = Succeeded::no;
+        }
+      else
+        {
+          std::uint64_t used_size = 0;
+          for (const auto& chunk : this->chunks)
+            used_size += chunk.size;
+          if (used_size < this->end_of_chunks && this->remove_unused_space() == Succeeded::no)
+            success = Succeeded::no;
+        }
+      this->index_modified = false;
+    }
+  if (this->data_stream.is_open())
+    this->data_stream.close();
+  this->cached_segments.clear();
+  return success;
+}
+
+std::size_t
+ProjDataCompressed::get_chunk_num(const int ax_pos_num, const int segment_num, const int timing_pos) const
+{
+  return this->first_chunk_nums[timing_pos][segment_num] + (ax_pos_num - this->get_min_axial_pos_num(segment_num));
+}
+
+void
+ProjDataCompressed::check_writable(const char* const function_name) const
+{
+  if (!this->is_writable)
+    error(format("ProjDataCompressed::{}: data are opened read-only", function_name));
+}
+
+std::vector<char>
+ProjDataCompressed::read_compressed_chunk(const std::size_t chunk_num) const
+{
+  if (!this->data_stream.is_open())
+    error("ProjDataCompressed: data file is already closed");
+  const ChunkInfo& chunk = this->chunks[chunk_num];
+  std::vector<char> compressed(static_cast<std::size_t>(chunk.size));
+  if (chunk.size == 0)
+    return compressed;
+  this->data_stream.seekg(static_cast<std::streamoff>(chunk.offset));
+  this->data_stream.read(compressed.data(), static_cast<std::streamsize>(chunk.size));
+  if (!this->data_stream)
+    error(format("ProjDataCompressed: error reading sinogram {} from file", chunk_num));
+  return compressed;
+}
+
+std::vector<std::vector<char>>
+ProjDataCompressed::read_compressed_chunks(const int segment_num, const int timing_pos) const
+{
+  std::vector<std::vector<char>> compressed;
+  compressed.reserve(this->get_num_axial_poss(segment_num));
+  for (int ax_pos_num = this->get_min_axial_pos_num(segment_num); ax_pos_num <= this->get_max_axial_pos_num(segment_num);
+       ++ax_pos_num)
+    compressed.push_back(this->read_compressed_chunk(this->get_chunk_num(ax_pos_num, segment_num, timing_pos)));
+  return compressed;
+}
+
+bool
+ProjDataCompressed::decompress_sinogram(Array<2, float>& sinogram, const std::vector<char>& compressed) const
+{
+  if (compressed.empty())
+    {
+      sinogram.fill(0.F);
+      return true;
+    }
+  std::vector<float> buffer(sinogram.size_all());
+  uLongf buffer_size = static_cast<uLongf>(buffer.size() * sizeof(float));
+  if (uncompress(reinterpret_cast<Bytef*>(buffer.data()),
+                 &buffer_size,
+                 reinterpret_cast<const Bytef*>(compressed.data()),
+                 static_cast<uLong>(compressed.size()))
+          != Z_OK
+      || buffer_size != buffer.size() * sizeof(float))
+    return false;
+  if (!this->byte_order.is_native_order())
+    for (auto& value : buffer)
+      ByteOrder::swap_order(value);
+  std::copy(buffer.begin(), buffer.end(), sinogram.begin_all());
+  return true;
+}
+
+std::vector<char>
+ProjDataCompressed::compress_sinogram(const Array<2, float>& sinogram) const
+{
+  // zero sinograms are not stored
+  if (std::all_of(sinogram.begin_all(), sinogram.end_all(), [](const float value) { return value == 0.F; }))
+    return std::vector<char>();
+
+  std::vector<float> buffer(sinogram.begin_all(), sinogram.end_all());
+  if (!this->byte_order.is_native_order())
+    for (auto& value : buffer)
+      ByteOrder::swap_order(value);
+  const uLong buffer_size = static_cast<uLong>(buffer.size() * sizeof(float));
+  uLongf compressed_size = compressBound(buffer_size);
+  std::vector<char> compressed(compressed_size);
+  if (compress2(reinterpret_cast<Bytef*>(compressed.data()),
+                &compressed_size,
+                reinterpret_cast<const Bytef*>(buffer.data()),
+                buffer_size,
+                this->compression_level)
+      != Z_OK)
+    error("ProjDataCompressed: error compressing sinogram");
+  compressed.resize(compressed_size);
+  return compressed;
+}
+
+void
+ProjDataCompressed::decompress_segment(SegmentBySinogram<float>& segment, const std::vector<std::vector<char>>& compressed) const
+{
+  const int min_ax_pos_num = segment.get_min_axial_pos_num();
+  const int max_ax_pos_num = segment.get_max_axial_pos_num();
+  std::vector<char> succeeded(compressed.size(), 1);
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
+  for (int ax_pos_num = min_ax_pos_num; ax_pos_num <= max_ax_pos_num; ++ax_pos_num)
+    {
+      if (!this->decompress_sinogram(segment[ax_pos_num], compressed[ax_pos_num - min_ax_pos_num]))
+        succeeded[ax_pos_num - min_ax_pos_num] = 0;
+    }
+  if (std::find(succeeded.begin(), succeeded.end(), 0) != succeeded.end())
+    error(format("ProjDataCompressed: error decompressing segment {} (TOF bin {})",
+                 segment.get_segment_num(),
+                 segment.get_timing_pos_num()));
+}
+
+std::vector<std::vector<char>>
+ProjDataCompressed::compress_segment(const SegmentBySinogram<float>& segment) const
+{
+  const int min_ax_pos_num = segment.get_min_axial_pos_num();
+  const int max_ax_pos_num = segment.get_max_axial_pos_num();
+  std::vector<std::vector<char>> compressed(segment.get_num_axial_poss());
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
+  for (int ax_pos_num = min_ax_pos_num; ax_pos_num <= max_ax_pos_num; ++ax_pos_num)
+    compressed[ax_pos_num - min_ax_pos_num] = this->compress_sinogram(segment[ax_pos_num]);
+  return compressed;
+}
+
+Succeeded
+ProjDataCompressed::write_compressed_chunk(const std::size_t chunk_num, const std::vector<char>& compressed)
+{
+  if (!this->data_stream.is_open())
+    error("ProjDataCompressed: data file is already closed");
+  ChunkInfo& chunk = this->chunks[chunk_num];
+  this->index_modified = true;
+  if (compressed.empty())
+    {
+      chunk = ChunkInfo{ 0, 0 };
+      return Succeeded::yes;
+    }
+  this->data_stream.seekp(static_cast<std::streamoff>(this->end_of_chunks));
+  this->data_stream.write(compressed.data(), static_cast<std::streamsize>(compressed.size()));
+  if (!this->data_stream)
+    {
+      warning(format("ProjDataCompressed: error writing sinogram {} to file", chunk_num));
+      return Succeeded::no;
+    }
+  chunk.offset = this->end_of_chunks;
+  chunk.size = compressed.size();
+  this->end_of_chunks += compressed.size();
+  return Succeeded::yes;
+}
+
+Succeeded
+ProjDataCompressed::write_compressed_chunks(const SegmentBySinogram<float>& segment,
+                                            const std::vector<std::vector<char>>& compressed)
+{
+  const int segment_num = segment.get_segment_num();
+  const int timing_pos = segment.get_timing_pos_num();
+  for (int ax_pos_num = segment.get_min_axial_pos_num(); ax_pos_num <= segment.get_max_axial_pos_num(); ++ax_pos_num)
+    if (this->write_compressed_chunk(this->get_chunk_num(ax_pos_num, segment_num, timing_pos),
+                                     compressed[ax_pos_num - segment.get_min_axial_pos_num()])
+        == Succeeded::no)
+      return Succeeded::no;
+  return Succeeded::yes;
+}
+
+std::list<ProjDataCompressed::CachedSegment>::iterator
+ProjDataCompressed::find_cached_segment(const int segment_num, const int timing_pos) const
+{
+  return std::find_if(this->cached_segments.begin(), this->cached_segments.end(), [&](const CachedSegment& cached_segment) {
+    return cached_segment.segment_sptr->get_segment_num() == segment_num
+           && cached_segment.segment_sptr->get_timing_pos_num() == timing_pos;
+  });
+}
+
+Succeeded
+ProjDataCompressed::write_cached_segment(CachedSegment& cached_segment)
+{
+  if (!cached_segment.is_modified)
+    return Succeeded::yes;
+  const SegmentBySinogram<float>& segment = *cached_segment.segment_sptr;
+  if (this->write_compressed_chunks(segment, this->compress_segment(segment)) == Succeeded::no)
+    return Succeeded::no;
+  cached_segment.is_modified = false;
+  return Succeeded::yes;
+}
+
+void
+ProjDataCompressed::mark_segment_as_stale(const int segment_num, const int timing_pos)
+{
+  for (auto& segment_being_read : this->segments_being_read)
+    if (segment_being_read.segment_num == segment_num && segment_being_read.timing_pos == timing_pos)
+      segment_being_read.is_stale = true;
+}
+
+SegmentBySinogram<float>&
+ProjDataCompressed::get_cached_segment(std::unique_lock<std::mutex>& lock, const int segment_num, const int timing_pos) const
+{
+  while (true)
+    {
+      const auto cached_iter = this->find_cached_segment(segment_num, timing_pos);
+      if (cached_iter != this->cached_segments.end())
+        {
+          // move it to the front
+          this->cached_segments.splice(this->cached_segments.begin(), this->cached_segments, cached_iter);
+          return *this->cached_segments.front().segment_sptr;
+        }
+      // wait if another thread is reading it already
+      if (std::any_of(this->segments_being_read.begin(),
+                      this->segments_being_read.end(),
+                      [&](const SegmentBeingRead& segment_being_read) {
+                        return segment_being_read.segment_num == segment_num && segment_being_read.timing_pos == timing_pos;
+                      }))
+        {
+          this->segment_read_condition.wait(lock);
+          continue;
+        }
+
+      const std::vector<std::vector<char>> compressed = this->read_compressed_chunks(segment_num, timing_pos);
+      const auto being_read_iter = this->segments_being_read.insert(this->segments_being_read.end(),
+                                                                    SegmentBeingRead{ segment_num, timing_pos, false });
+      shared_ptr<SegmentBySinogram<float>> segment_sptr(
+          new SegmentBySinogram<float>(this->get_empty_segment_by_sinogram(segment_num, false, timing_pos)));
+      lock.unlock();
+      try
+        {
+          this->decompress_segment(*segment_sptr, compressed);
+        }
+      catch (...)
+        {
+          lock.lock();
+          this->segments_being_read.erase(being_read_iter);
+          this->segment_read_condition.notify_all();
+          throw;
+        }
+      lock.lock();
+      const bool is_stale = being_read_iter->is_stale;
+      this->segments_being_read.erase(being_read_iter);
+      this->segment_read_condition.notify_all();
+      if (is_stale)
+        continue;
+
+      this->cached_segments.push_front(CachedSegment{ segment_sptr, false });
+      while (this->cached_segments.size() > max_num_cached_segments)
+        {
+          if (const_cast<ProjDataCompressed&>(*this).write_cached_segment(this->cached_segments.back()) == Succeeded::no)
+            error("ProjDataCompressed: error writing cached segment");
+          this->cached_segments.pop_back();
+        }
+      return *segment_sptr;
+    }
+}
+
+Viewgram<float>
+ProjDataCompressed::get_viewgram(const int view_num,
+                                 const int segment_num,
+                                 const bool make_num_tangential_poss_odd,
+                                 const int timing_pos) const
+{
+  Viewgram<float> viewgram = this->get_empty_viewgram(view_num, segment_num, false, timing_pos);
+  {
+    std::unique_lock<std::mutex> lock(this->data_mutex);
+    const SegmentBySinogram<float>& segment = this->get_cached_segment(lock, segment_num, timing_pos);
+    for (int ax_pos_num = viewgram.get_min_axial_pos_num(); ax_pos_num <= viewgram.get_max_axial_pos_num(); ++ax_pos_num)
+      viewgram[ax_pos_num] = segment[ax_pos_num][view_num];
+  }
+  if (make_num_tangential_poss_odd && (this->get_num_tangential_poss() % 2 == 0))
+    {
+      viewgram.grow(IndexRange2D(viewgram.get_min_axial_pos_num(),
+                                 viewgram.get_max_axial_pos_num(),
+                                 this->get_min_tangential_pos_num(),
+                                 this->get_max_tangential_pos_num() + 1));
+    }
+  return viewgram;
+}
+
+Succeeded
+ProjDataCompressed::set_viewgram(const Viewgram<float>& viewgram)
+{
+  this->check_writable("set_viewgram");
+  if (*this->get_proj_data_info_sptr() != *viewgram.get_proj_data_info_sptr())
+    {
+      warning("ProjDataCompressed::set_viewgram: viewgram has incompatible ProjDataInfo, data not written");
+      return Succeeded::no;
+    }
+  std::unique_lock<std::mutex> lock(this->data_mutex);
+  SegmentBySinogram<float>& segment
+      = this->get_cached_segment(lock, viewgram.get_segment_num(), viewgram.get_timing_pos_num());
+  segment.set_viewgram(viewgram);
+  // get_cached_segment() moved the segment to the front
+  this->cached_segments.front().is_modified = true;
+  return Succeeded::yes;
+}
+
+Sinogram<float>
+ProjDataCompressed::get_sinogram(const int ax_pos_num,
+                                 const int segment_num,
+                                 const bool make_num_tangential_poss_odd,
+                                 const int timing_pos) const
+{
+  Sinogram<float> sinogram = this->get_empty_sinogram(ax_pos_num, segment_num, false, timing_pos);
+  std::vector<char> compressed;
+  {
+    std::lock_guard<std::mutex> lock(this->data_mutex);
+    const auto cached_iter = this->find_cached_segment(segment_num, timing_pos);
+    if (cached_iter != this->cached_segments.end())
+      {
+        const Array<2, float>& cached_sinogram = (*cached_iter->segment_sptr)[ax_pos_num];
+        std::copy(cached_sinogram.begin_all(), cached_sinogram.end_all(), sinogram.begin_all());
+      }
+    else
+      compressed = this->read_compressed_chunk(this->get_chunk_num(ax_pos_num, segment_num, timing_pos));
+  }
+  if (!compressed.empty() && !this->decompress_sinogram(sinogram, compressed))
+    error(format("ProjDataCompressed: error decompressing sinogram {} of segment {} (TOF bin {})",
+                 ax_pos_num,
+                 segment_num,
+                 timing_pos));
+  if (make_num_tangential_poss_odd && (this->get_num_tangential_poss() % 2 == 0))
+    {
+      sinogram.grow(IndexRange2D(this->get_min_view_num(),
+                                 this->get_max_view_num(),
+                                 this->get_min_tangential_pos_num(),
+                                 this->get_max_tangential_pos_num() + 1));
+    }
+  return sinogram;
+}
+
+Succeeded
+ProjDataCompressed::set_sinogram(const Sinogram<float>& sinogram)
+{
+  this->check_writable("set_sinogram");
+  if (*this->get_proj_data_info_sptr() != *sinogram.get_proj_data_info_sptr())
+    {
+      warning("ProjDataCompressed::set_sinogram: sinogram has incompatible ProjDataInfo, data not written");
+      return Succeeded::no;
+    }
+  const std::vector<char> compressed = this->compress_sinogram(sinogram);
+  std::lock_guard<std::mutex> lock(this->data_mutex);
+  const int segment_num = sinogram.get_segment_num();
+  const int timing_pos = sinogram.get_timing_pos_num();
+  const auto cached_iter = this->find_cached_segment(segment_num, timing_pos);
+  if (cached_iter != this->cached_segments.end())
+    (*cached_iter->segment_sptr)[sinogram.get_axial_pos_num()] = sinogram;
+  this->mark_segment_as_stale(segment_num, timing_pos);
+  return this->write_compressed_chunk(this->get_chunk_num(sinogram.get_axial_pos_num(), segment_num, timing_pos), compressed);
+}
+
+SegmentBySinogram<float>
+ProjDataCompressed::get_segment_by_sinogram(const int segment_num, const int timing_pos) const
+{
+  SegmentBySinogram<float> segment = this->get_empty_segment_by_sinogram(segment_num, false, timing_pos);
+  std::vector<std::vector<char>> compressed;
+  {
+    std::lock_guard<std::mutex> lock(this->data_mutex);
+    const auto cached_iter = this->find_cached_segment(segment_num, timing_pos);
+    if (cached_iter != this->cached_segments.end())
+      return *cached_iter->segment_sptr;
+    compressed = this->read_compressed_chunks(segment_num, timing_pos);
+  }
+  this->decompress_segment(segment, compressed);
+  return segment;
+}
+
+SegmentByView<float>
+ProjDataCompressed::get_segment_by_view(const int segment_num, const int timing_pos) const
+{
+  return SegmentByView<float>(this->get_segment_by_sinogram(segment_num, timing_pos));
+}
+
+Succeeded
+ProjDataCompressed::set_segment(const SegmentBySinogram<float>& segment)
+{
+  this->check_writable("set_segment");
+  if (*this->get_proj_data_info_sptr() != *segment.get_proj_data_info_sptr())
+    {
+      warning("ProjDataCompressed::set_segment: segment has incompatible ProjDataInfo, data not written");
+      return Succeeded::no;
+    }
+  const std::vector<std::vector<char>> compressed = this->compress_segment(segment);
+  std::lock_guard<std::mutex> lock(this->data_mutex);
+  const auto cached_iter = this->find_cached_segment(segment.get_segment_num(), segment.get_timing_pos_num());
+  if (cached_iter != this->cached_segments.end())
+    this->cached_segments.erase(cached_iter);
+  this->mark_segment_as_stale(segment.get_segment_num(), segment.get_timing_pos_num());
+  return this->write_compressed_chunks(segment, compressed);
+}
+
+Succeeded
+ProjDataCompressed::set_segment(const SegmentByView<float>& segment)
+{
+  return this->set_segment(SegmentBySinogram<float>(segment));
+}
+
+std::uint64_t
+ProjDataCompressed::get_compressed_size() const
+{
+  std::lock_guard<std::mutex> lock(this->data_mutex);
+  std::uint64_t size = 0;
+  for (const auto& chunk : this->chunks)
+    size += chunk.size;
+  return size;
+}
+
+END_NAMESPACE_STIR
@@ -37,6 +37,7 @@
 #include "stir/IO/write_data.h"
 #include "stir/IO/read_data.h"
 #include "stir/is_null_ptr.h"
+#include "stir/ProfilingRegistry.h"
 #include <numeric>
 #include <iostream>
 #include <fstream>
@@ -74,7 +75,8 @@ ProjDataFromStream::ProjDataFromStream(shared_ptr<const ExamInfo> const& exam_in
       storage_order(o),
       on_disk_data_type(data_type),
       on_disk_byte_order(byte_order),
-      scale_factor(scale_factor)
+      scale_factor(scale_factor),
+      warn_about_scale_factor(true)
 {
   assert(storage_order != Unsupported);
   assert(!(data_type == NumericType::UNKNOWN_TYPE));
@@ -97,7 +99,8 @@ ProjDataFromStream::ProjDataFromStream(shared_ptr<const ExamInfo> const& exam_in
       storage_order(o),
       on_disk_data_type(data_type),
       on_disk_byte_order(byte_order),
-      scale_factor(scale_factor)
+      scale_factor(scale_factor),
+      warn_about_scale_factor(true)
 {
   assert(storage_order != Unsupported);
   assert(!(data_type == NumericType::UNKNOWN_TYPE));
@@ -156,7 +159,14 @@ ProjDataFromStream::set_timing_poss_sequence_in_stream(const std::vector<int>& s
 
 namespace detail
 {
-// 2 local functions to avoid cluttering code below
+// 3 local functions to avoid cluttering code below
+
+static void
+count_bytes_read(const std::size_t num_elements, const NumericType& type)
+{
+  static ProfilingCounter bytes_read_counter("bytes read");
+  bytes_read_counter.add(static_cast<long long>(num_elements * type.size_in_bytes()));
+}
 
 static void
 checked_seekg(const std::string& fname, std::istream& s, const std::streamoff offset)
@@ -237,6 +247,7 @@ ProjDataFromStream::get_viewgram(const int view_num,
     error("ProjDataFromStream: error reading data: scale factor returned by read_data should be 1");
   if (succeeded == Succeeded::no)
     error("ProjDataFromStream: error reading data (file truncated?)");
+  detail::count_bytes_read(viewgram.size_all(), on_disk_data_type);
 
   viewgram *= scale_factor;
 
@@ -320,7 +331,7 @@ ProjDataFromStream::set_viewgram(const Viewgram<float>& v)
     }
 
   // KT 03/07/2001 modified handling of scale_factor etc.
-  if (on_disk_data_type.id != NumericType::FLOAT)
+  if (on_disk_data_type.id != NumericType::FLOAT && warn_about_scale_factor)
     {
       warning("ProjDataFromStream::set_viewgram: non-float output uses original "
               "scale factor %g which might not be appropriate for the current data\n",
@@ -555,6 +566,7 @@ ProjDataFromStream::get_sinogram(const int ax_pos_num,
     error("ProjDataFromStream: error reading data: scale factor returned by read_data should be 1");
   if (succeeded == Succeeded::no)
     error("ProjDataFromStream: error reading data");
+  detail::count_bytes_read(sinogram.size_all(), on_disk_data_type);
 
   sinogram *= scale_factor;
 
@@ -582,7 +594,7 @@ ProjDataFromStream::set_sinogram(const Sinogram<float>& s)
       return Succeeded::no;
     }
   // KT 03/07/2001 modified handling of scale_factor etc.
-  if (on_disk_data_type.id != NumericType::FLOAT)
+  if (on_disk_data_type.id != NumericType::FLOAT && warn_about_scale_factor)
     {
       warning("ProjDataFromStream::set_sinogram: non-float output uses original "
               "scale factor %g which might not be appropriate for the current data\n",
@@ -696,6 +708,7 @@ ProjDataFromStream::get_segment_by_sinogram(const int segment_num, const int tim
         error("ProjDataFromStream: error reading data\n");
       if (scale != 1)
         error("ProjDataFromStream: error reading data: scale factor returned by read_data should be 1\n");
+      detail::count_bytes_read(segment.size_all(), on_disk_data_type);
 
       segment *= scale_factor;
       return segment;
@@ -746,6 +759,7 @@ ProjDataFromStream::get_segment_by_view(const int segment_num, const int timing_
         error("ProjDataFromStream: error reading data");
       if (scale != 1)
         error("ProjDataFromStream: error reading data: scale factor returned by read_data should be 1\n");
+      detail::count_bytes_read(segment.size_all(), on_disk_data_type);
 
       segment *= scale_factor;
       return segment;
@@ -788,7 +802,7 @@ ProjDataFromStream::set_segment(const SegmentBySinogram<float>& segmentbysinogra
   if (get_storage_order() == Segment_AxialPos_View_TangPos || get_storage_order() == Timing_Segment_AxialPos_View_TangPos)
     {
       // KT 03/07/2001 handle scale_factor appropriately
-      if (on_disk_data_type.id != NumericType::FLOAT)
+      if (on_disk_data_type.id != NumericType::FLOAT && warn_about_scale_factor)
         {
           warning("ProjDataFromStream::set_segment: non-float output uses original "
                   "scale factor %g which might not be appropriate for the current data\n",
@@ -863,7 +877,7 @@ ProjDataFromStream::set_segment(const SegmentByView<float>& segmentbyview_v)
   if (get_storage_order() == Segment_View_AxialPos_TangPos || get_storage_order() == Timing_Segment_View_AxialPos_TangPos)
     {
       // KT 03/07/2001 handle scale_factor appropriately
-      if (on_disk_data_type.id != NumericType::FLOAT)
+      if (on_disk_data_type.id != NumericType::FLOAT && warn_about_scale_factor)
         {
           warning("ProjDataFromStream::set_segment: non-float output uses original "
                   "scale factor %g which might not be appropriate for the current data\n",
@@ -1064,4 +1078,10 @@ ProjDataFromStream::get_scale_factor() const
   return scale_factor;
 }
 
+void
+ProjDataFromStream::set_warn_about_scale_factor(const bool warn)
+{
+  warn_about_scale_factor = warn;
+}
+
 END_NAMESPACE_STIR
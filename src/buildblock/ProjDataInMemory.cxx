@@ -29,8 +29,11 @@
 #include "stir/Succeeded.h"
 #include "stir/SegmentByView.h"
 #include "stir/Bin.h"
+#include "stir/Coordinate3D.h"
 #include "stir/is_null_ptr.h"
 #include "stir/numerics/norm.h"
+#include "stir/IO/interfile.h"
+#include "stir/IO/memory_map.h"
 #include <iostream>
 #include <cstring>
 #include <algorithm>
@@ -50,7 +53,24 @@ ProjDataInMemory::ProjDataInMemory(shared_ptr<const ExamInfo> const& exam_info_s
       segment_sequence(ProjData::standard_segment_sequence(*proj_data_info_ptr))
 {
   this->create_buffer(initialise_with_0);
+  this->set_up_offsets();
+}
+
+ProjDataInMemory::ProjDataInMemory(shared_ptr<const ExamInfo> const& exam_info_sptr,
+                                   shared_ptr<const ProjDataInfo> const& proj_data_info_ptr,
+                                   shared_ptr<float[]> data_sptr)
+    : ProjData(exam_info_sptr, proj_data_info_ptr),
+      segment_sequence(ProjData::standard_segment_sequence(*proj_data_info_ptr))
+{
+  // note: assignment would copy the data, so swap instead
+  Array<1, float> shared_buffer(IndexRange<1>(0, static_cast<int>(this->size_all()) - 1), data_sptr);
+  swap(this->buffer, shared_buffer);
+  this->set_up_offsets();
+}
 
+void
+ProjDataInMemory::set_up_offsets()
+{
   int sum = 0;
   for (int segment_num = proj_data_info_sptr->get_min_segment_num(); segment_num <= proj_data_info_sptr->get_max_segment_num();
        ++segment_num)
@@ -310,6 +330,44 @@ ProjDataInMemory::set_segment(const SegmentByView<float>& segmentbyview_v)
   return set_segment(segmentbysinogram);
 }
 
+/////////////////  views
+StridedArrayView<3, const float>
+ProjDataInMemory::get_segment_view_by_sinogram(const int segment_num, const int timing_pos) const
+{
+  const Bin bin(segment_num,
+                this->get_min_view_num(),
+                this->get_min_axial_pos_num(segment_num),
+                this->get_min_tangential_pos_num(),
+                timing_pos);
+  return StridedArrayView<3, const float>(
+      this->buffer.begin() + this->get_index(bin),
+      Coordinate3D<int>(bin.axial_pos_num(), bin.view_num(), bin.tangential_pos_num()),
+      Coordinate3D<int>(this->get_num_axial_poss(segment_num), this->get_num_views(), this->get_num_tangential_poss()));
+}
+
+StridedArrayView<3, float>
+ProjDataInMemory::get_segment_view_by_sinogram(const int segment_num, const int timing_pos)
+{
+  const auto const_view = static_cast<const ProjDataInMemory&>(*this).get_segment_view_by_sinogram(segment_num, timing_pos);
+  // we have non-const access to the buffer, so this const_cast is safe
+  return StridedArrayView<3, float>(const_cast<float*>(const_view.get_full_data_ptr()),
+                                    const_view.get_min_indices(),
+                                    const_view.get_lengths(),
+                                    const_view.get_strides());
+}
+
+StridedArrayView<3, const float>
+ProjDataInMemory::get_segment_view_by_view(const int segment_num, const int timing_pos) const
+{
+  return this->get_segment_view_by_sinogram(segment_num, timing_pos).swap_dimensions(1, 2);
+}
+
+StridedArrayView<3, float>
+ProjDataInMemory::get_segment_view_by_view(const int segment_num, const int timing_pos)
+{
+  return this->get_segment_view_by_sinogram(segment_num, timing_pos).swap_dimensions(1, 2);
+}
+
 /////////////////  other functions
 void
 ProjDataInMemory::fill(const float value)
@@ -346,6 +404,12 @@ ProjDataInMemory::ProjDataInMemory(const ProjDataInMemory& proj_data)
 shared_ptr<ProjDataInMemory>
 ProjDataInMemory::read_from_file(const std::string& filename)
 {
+  if (get_memory_map_input_files())
+    {
+      shared_ptr<ProjDataInMemory> mapped_sptr(read_interfile_PDFS_memory_mapped(filename));
+      if (!is_null_ptr(mapped_sptr))
+        return mapped_sptr;
+    }
   return std::make_shared<ProjDataInMemory>(*ProjData::read_from_file(filename));
 }
 
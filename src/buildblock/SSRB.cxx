@@ -23,12 +23,19 @@
 #include "stir/ProjDataInfoCylindrical.h"
 #include "stir/SSRB.h"
 #include "stir/Sinogram.h"
+#include "stir/SegmentBySinogram.h"
+#include "stir/VectorWithOffset.h"
 #include "stir/Bin.h"
 #include "stir/round.h"
 #include <fstream>
 #include <algorithm>
+#include <vector>
+#include <memory>
 #include "stir/warning.h"
 #include "stir/error.h"
+#ifdef STIR_OPENMP
+#  include <omp.h>
+#endif
 
 using std::fstream;
 using std::min;
@@ -187,6 +194,9 @@ SSRB(ProjData& out_proj_data, const ProjData& in_proj_data, const bool do_norm)
   if (in_proj_data.get_num_views() % out_proj_data.get_num_views())
     error("SSRB can only mash views when out_num_views divides in_num_views\n");
 
+  const int min_tangential_pos_num = max(in_proj_data.get_min_tangential_pos_num(), out_proj_data.get_min_tangential_pos_num());
+  const int max_tangential_pos_num = min(in_proj_data.get_max_tangential_pos_num(), out_proj_data.get_max_tangential_pos_num());
+
   for (int out_segment_num = out_proj_data.get_min_segment_num(); out_segment_num <= out_proj_data.get_max_segment_num();
        ++out_segment_num)
     {
@@ -228,84 +238,154 @@ SSRB(ProjData& out_proj_data, const ProjData& in_proj_data, const bool do_norm)
                       out_max_ring_diff);
               }
           }
+      }
 
-        // keep sinograms out of the loop to avoid reallocations
-        // initialise to something because there's no default constructor
-        Sinogram<float> out_sino
-            = out_proj_data.get_empty_sinogram(out_proj_data.get_min_axial_pos_num(out_segment_num), out_segment_num);
-        Sinogram<float> in_sino
-            = in_proj_data.get_empty_sinogram(in_proj_data.get_min_axial_pos_num(out_segment_num), out_segment_num);
-        for (int out_timing_pos_num = out_proj_data.get_min_tof_pos_num();
-             out_timing_pos_num <= out_proj_data.get_max_tof_pos_num();
-             ++out_timing_pos_num)
-          {
-            for (int out_ax_pos_num = out_proj_data.get_min_axial_pos_num(out_segment_num);
-                 out_ax_pos_num <= out_proj_data.get_max_axial_pos_num(out_segment_num);
-                 ++out_ax_pos_num)
-              {
-                Bin out_bin(out_segment_num, 0, out_ax_pos_num, 0, out_timing_pos_num);
-                out_sino = out_proj_data.get_empty_sinogram(out_bin);
-                const float out_m = out_proj_data_info_sptr->get_m(out_bin);
-
-                unsigned int num_in_ax_pos = 0;
+      // find for every input sinogram the output axial position it contributes to, and count the number of
+      // input sinograms (ignoring TOF) contributing to every output sinogram
+      const int out_min_ax_pos_num = out_proj_data.get_min_axial_pos_num(out_segment_num);
+      const int out_max_ax_pos_num = out_proj_data.get_max_axial_pos_num(out_segment_num);
+      VectorWithOffset<float> out_m(out_min_ax_pos_num, out_max_ax_pos_num);
+      for (int out_ax_pos_num = out_min_ax_pos_num; out_ax_pos_num <= out_max_ax_pos_num; ++out_ax_pos_num)
+        out_m[out_ax_pos_num] = out_proj_data_info_sptr->get_m(Bin(out_segment_num, 0, out_ax_pos_num, 0));
+      VectorWithOffset<unsigned int> num_in_ax_poss(out_min_ax_pos_num, out_max_ax_pos_num);
+      num_in_ax_poss.fill(0U);
+      // in_to_out_ax_pos_num[in_segment_num][in_ax_pos_num] is out_min_ax_pos_num-1 if there is no output sinogram
+      VectorWithOffset<VectorWithOffset<int>> in_to_out_ax_pos_num(std::min(in_min_segment_num, in_max_segment_num),
+                                                                   in_max_segment_num);
+      for (int in_segment_num = in_min_segment_num; in_segment_num <= in_max_segment_num; ++in_segment_num)
+        {
+          VectorWithOffset<int>& in_to_out = in_to_out_ax_pos_num[in_segment_num];
+          in_to_out.grow(in_proj_data.get_min_axial_pos_num(in_segment_num), in_proj_data.get_max_axial_pos_num(in_segment_num));
+          in_to_out.fill(out_min_ax_pos_num - 1);
+          for (int in_ax_pos_num = in_to_out.get_min_index(); in_ax_pos_num <= in_to_out.get_max_index(); ++in_ax_pos_num)
+            {
+              const float in_m = in_proj_data_info_sptr->get_m(Bin(in_segment_num, 0, in_ax_pos_num, 0));
+              for (int out_ax_pos_num = out_min_ax_pos_num; out_ax_pos_num <= out_max_ax_pos_num; ++out_ax_pos_num)
+                if (fabs(out_m[out_ax_pos_num] - in_m) < 1E-4)
+                  {
+                    in_to_out[in_ax_pos_num] = out_ax_pos_num;
+                    ++num_in_ax_poss[out_ax_pos_num];
+                    break;
+                  }
+            }
+        }
 
-                // get edges of TOF bin, currently only exposed via sampling
-                // for non-TOF data, the sampling in k is 0, which is incorrect and would lead to the TOF condition below never
-                // being met. Therefore: for non-TOF set out_lower_k to -1E20F and out_higher_k to 1E20F
-                const float out_lower_k
-                    = out_proj_data_info_sptr->is_tof_data()
-                          ? (out_proj_data_info_sptr->get_k(out_bin) - out_proj_data_info_sptr->get_sampling_in_k(out_bin) / 2)
-                          : -1E20F;
-                const float out_higher_k
-                    = out_proj_data_info_sptr->is_tof_data()
-                          ? (out_proj_data_info_sptr->get_k(out_bin) + out_proj_data_info_sptr->get_sampling_in_k(out_bin) / 2)
-                          : 1E20F;
+      // find for every input TOF bin the output TOF bin it contributes to
+      const int out_min_timing_pos_num = out_proj_data.get_min_tof_pos_num();
+      VectorWithOffset<int> in_to_out_timing_pos_num(in_proj_data.get_min_tof_pos_num(), in_proj_data.get_max_tof_pos_num());
+      in_to_out_timing_pos_num.fill(out_min_timing_pos_num - 1);
+      if (!out_proj_data_info_sptr->is_tof_data())
+        {
+          // for non-TOF data, the sampling in k is 0, so all input TOF bins contribute to the single output bin
+          in_to_out_timing_pos_num.fill(out_min_timing_pos_num);
+        }
+      else if (in_min_segment_num <= in_max_segment_num)
+        {
+          for (int out_timing_pos_num = out_min_timing_pos_num; out_timing_pos_num <= out_proj_data.get_max_tof_pos_num();
+               ++out_timing_pos_num)
+            {
+              // get edges of TOF bin, currently only exposed via sampling
+              const Bin out_bin(out_segment_num, 0, out_min_ax_pos_num, 0, out_timing_pos_num);
+              const float out_lower_k
+                  = out_proj_data_info_sptr->get_k(out_bin) - out_proj_data_info_sptr->get_sampling_in_k(out_bin) / 2;
+              const float out_higher_k
+                  = out_proj_data_info_sptr->get_k(out_bin) + out_proj_data_info_sptr->get_sampling_in_k(out_bin) / 2;
+              for (int in_timing_pos_num = in_proj_data.get_min_tof_pos_num();
+                   in_timing_pos_num <= in_proj_data.get_max_tof_pos_num();
+                   ++in_timing_pos_num)
+                {
+                  const Bin in_bin(
+                      in_min_segment_num, 0, in_proj_data.get_min_axial_pos_num(in_min_segment_num), 0, in_timing_pos_num);
+                  const float in_k = in_proj_data_info_sptr->get_k(in_bin);
+                  // check if in_timing_pos_num is in the range for the out bin or not
+                  if (in_k >= out_lower_k && in_k < out_higher_k)
+                    in_to_out_timing_pos_num[in_timing_pos_num] = out_timing_pos_num;
+                }
+            }
+        }
 
-                for (int in_timing_pos_num = in_proj_data.get_min_tof_pos_num();
-                     in_timing_pos_num <= in_proj_data.get_max_tof_pos_num();
-                     ++in_timing_pos_num)
-                  for (int in_segment_num = in_min_segment_num; in_segment_num <= in_max_segment_num; ++in_segment_num)
-                    for (int in_ax_pos_num = in_proj_data.get_min_axial_pos_num(in_segment_num);
-                         in_ax_pos_num <= in_proj_data.get_max_axial_pos_num(in_segment_num);
-                         ++in_ax_pos_num)
-                      {
-                        Bin in_bin(in_segment_num, 0, in_ax_pos_num, 0, in_timing_pos_num);
-                        const float in_m = in_proj_data_info_sptr->get_m(in_bin);
-                        if (fabs(out_m - in_m) < 1E-4)
-                          {
-                            if (in_timing_pos_num == in_proj_data.get_min_tof_pos_num())
-                              ++num_in_ax_pos; // count number of in_sinograms contributing (ignoring TOF)
+      // all work items, i.e. input segments (for every TOF bin) that contribute
+      std::vector<SegmentIndices> in_segment_indices;
+      for (int in_timing_pos_num = in_proj_data.get_min_tof_pos_num(); in_timing_pos_num <= in_proj_data.get_max_tof_pos_num();
+           ++in_timing_pos_num)
+        if (in_to_out_timing_pos_num[in_timing_pos_num] >= out_min_timing_pos_num)
+          for (int in_segment_num = in_min_segment_num; in_segment_num <= in_max_segment_num; ++in_segment_num)
+            in_segment_indices.push_back(SegmentIndices(in_segment_num, in_timing_pos_num));
 
-                            const float in_k = in_proj_data_info_sptr->get_k(in_bin);
-                            // check if in_timing_pos_num is in the range for the out bin or not
-                            if (in_k < out_lower_k || in_k >= out_higher_k)
-                              continue;
-                            in_sino = in_proj_data.get_sinogram(in_bin);
+      // output segments, one per TOF bin
+      std::vector<SegmentBySinogram<float>> out_segments;
+      for (int out_timing_pos_num = out_min_timing_pos_num; out_timing_pos_num <= out_proj_data.get_max_tof_pos_num();
+           ++out_timing_pos_num)
+        out_segments.push_back(out_proj_data.get_empty_segment_by_sinogram(out_segment_num, false, out_timing_pos_num));
 
-                            for (int in_view_num = in_proj_data.get_min_view_num();
-                                 in_view_num <= in_proj_data.get_max_view_num();
-                                 ++in_view_num)
-                              for (int tangential_pos_num
-                                   = max(in_proj_data.get_min_tangential_pos_num(), out_proj_data.get_min_tangential_pos_num());
-                                   tangential_pos_num
-                                   <= min(in_proj_data.get_max_tangential_pos_num(), out_proj_data.get_max_tangential_pos_num());
-                                   ++tangential_pos_num)
-                                out_sino[in_view_num / num_views_to_combine][tangential_pos_num]
-                                    += in_sino[in_view_num][tangential_pos_num];
+      // Every input segment is read only once, and added to all output sinograms it contributes to.
+      // Threads add directly into the output segments. Every output sinogram has its own lock,
+      // such that no copies of the output are needed (which would be large for TOF data).
+#ifdef STIR_OPENMP
+      const int num_out_ax_poss = out_max_ax_pos_num - out_min_ax_pos_num + 1;
+      std::vector<omp_lock_t> out_sinogram_locks(out_segments.size() * num_out_ax_poss);
+      for (auto& lock : out_sinogram_locks)
+        omp_init_lock(&lock);
+#  pragma omp parallel for schedule(dynamic)
+#endif
+      for (int i = 0; i < static_cast<int>(in_segment_indices.size()); ++i)
+        {
+          const int in_segment_num = in_segment_indices[i].segment_num();
+          shared_ptr<SegmentBySinogram<float>> in_segment_sptr;
+#ifdef STIR_OPENMP
+          // reading from streams is not safe in multi-threaded code
+#  pragma omp critical(SSRB_READ_SEGMENT)
+#endif
+          in_segment_sptr
+              = std::make_shared<SegmentBySinogram<float>>(in_proj_data.get_segment_by_sinogram(in_segment_indices[i]));
 
-                            break; // out of loop over ax_pos as we found where to put it
-                          }
-                      }
-                if (do_norm && num_in_ax_pos != 0)
-                  out_sino /= static_cast<float>(num_in_ax_pos * num_views_to_combine);
-                if (num_in_ax_pos == 0)
-                  warning("SSRB: no sinograms contributing to output segment " + std::to_string(out_segment_num) + ", ax_pos "
-                          + std::to_string(out_ax_pos_num) + ", tof_pos_num " + std::to_string(out_timing_pos_num));
+          const int out_segment_index = in_to_out_timing_pos_num[in_segment_indices[i].timing_pos_num()] - out_min_timing_pos_num;
+          SegmentBySinogram<float>& out_segment = out_segments[out_segment_index];
+          const VectorWithOffset<int>& in_to_out = in_to_out_ax_pos_num[in_segment_num];
+          for (int in_ax_pos_num = in_to_out.get_min_index(); in_ax_pos_num <= in_to_out.get_max_index(); ++in_ax_pos_num)
+            {
+              const int out_ax_pos_num = in_to_out[in_ax_pos_num];
+              if (out_ax_pos_num < out_min_ax_pos_num)
+                continue;
+              const Array<2, float>& in_sino = (*in_segment_sptr)[in_ax_pos_num];
+              Array<2, float>& out_sino = out_segment[out_ax_pos_num];
+#ifdef STIR_OPENMP
+              omp_lock_t& out_sinogram_lock
+                  = out_sinogram_locks[out_segment_index * num_out_ax_poss + out_ax_pos_num - out_min_ax_pos_num];
+              omp_set_lock(&out_sinogram_lock);
+#endif
+              for (int in_view_num = in_proj_data.get_min_view_num(); in_view_num <= in_proj_data.get_max_view_num();
+                   ++in_view_num)
+                {
+                  const Array<1, float>& in_row = in_sino[in_view_num];
+                  Array<1, float>& out_row = out_sino[in_view_num / num_views_to_combine];
+                  for (int tangential_pos_num = min_tangential_pos_num; tangential_pos_num <= max_tangential_pos_num;
+                       ++tangential_pos_num)
+                    out_row[tangential_pos_num] += in_row[tangential_pos_num];
+                }
+#ifdef STIR_OPENMP
+              omp_unset_lock(&out_sinogram_lock);
+#endif
+            }
+        }
+#ifdef STIR_OPENMP
+      for (auto& lock : out_sinogram_locks)
+        omp_destroy_lock(&lock);
+#endif
 
-                out_proj_data.set_sinogram(out_sino);
-              }
-          }
-      }
+      for (auto& out_segment : out_segments)
+        {
+          for (int out_ax_pos_num = out_min_ax_pos_num; out_ax_pos_num <= out_max_ax_pos_num; ++out_ax_pos_num)
+            {
+              const unsigned int num_in_ax_pos = num_in_ax_poss[out_ax_pos_num];
+              if (do_norm && num_in_ax_pos != 0)
+                out_segment[out_ax_pos_num] /= static_cast<float>(num_in_ax_pos * num_views_to_combine);
+              if (num_in_ax_pos == 0)
+                warning("SSRB: no sinograms contributing to output segment " + std::to_string(out_segment_num) + ", ax_pos "
+                        + std::to_string(out_ax_pos_num) + ", tof_pos_num " + std::to_string(out_segment.get_timing_pos_num()));
+            }
+          out_proj_data.set_segment(out_segment);
+        }
     }
 }
 END_NAMESPACE_STIR
@@ -0,0 +1,235 @@
+//
+//
+/*!
+  \file
+  \ingroup densitydata
+  \brief Implementation of class stir::VoxelMajorDynamicDensity
+  \author STIR contributors
+
+*/
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+
+#include "stir/VoxelMajorDynamicDensity.h"
+#include "stir/DynamicDiscretisedDensity.h"
+#include "stir/IO/read_from_file.h"
+#include "stir/format.h"
+#include "stir/error.h"
+
+START_NAMESPACE_STIR
+
+VoxelMajorDynamicDensity::VoxelMajorDynamicDensity(const shared_ptr<const ExamInfo>& exam_info_sptr,
+                                                   const SingleDiscretisedDensityType& frame_template,
+                                                   const shared_ptr<Scanner>& scanner_sptr)
+    : ExamData(exam_info_sptr),
+      _index_range(frame_template.get_index_range()),
+      _origin(frame_template.get_origin()),
+      _grid_spacing(frame_template.get_grid_spacing()),
+      _scanner_sptr(scanner_sptr)
+{
+  this->allocate();
+}
+
+VoxelMajorDynamicDensity::VoxelMajorDynamicDensity(const DynamicDiscretisedDensity& dyn_image)
+    : ExamData(dyn_image.get_exam_info_sptr())
+{
+  if (dyn_image.get_num_time_frames() == 0)
+    error("VoxelMajorDynamicDensity: dynamic image has no time frames");
+  const SingleDiscretisedDensityType* frame_ptr = dynamic_cast<const SingleDiscretisedDensityType*>(&dyn_image.get_density(1));
+  if (frame_ptr == 0)
+    error("VoxelMajorDynamicDensity: only VoxelsOnCartesianGrid time frames are supported");
+  this->_index_range = frame_ptr->get_index_range();
+  this->_origin = frame_ptr->get_origin();
+  this->_grid_spacing = frame_ptr->get_grid_spacing();
+  if (!this->get_exam_info().originating_system.empty())
+    this->_scanner_sptr.reset(Scanner::get_scanner_from_name(this->get_exam_info().originating_system));
+  this->allocate();
+
+  BasicCoordinate<3, int> min_indices, max_indices;
+  this->_index_range.get_regular_range(min_indices, max_indices);
+  const unsigned int num_frames = this->get_num_time_frames();
+  for (unsigned int frame_num = 1; frame_num <= num_frames; ++frame_num)
+    this->check_index_range(dyn_image[frame_num], "VoxelMajorDynamicDensity");
+  this->check_contiguous("VoxelMajorDynamicDensity");
+
+  // transpose one row of voxels at a time, such that all frames of the row are read consecutively
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
+  for (int z = min_indices[1]; z <= max_indices[1]; ++z)
+    for (int y = min_indices[2]; y <= max_indices[2]; ++y)
+      {
+        float* const row_ptr = &this->_data[z][y][min_indices[3]][1];
+        const int num_voxels = max_indices[3] - min_indices[3] + 1;
+        for (unsigned int frame_num = 1; frame_num <= num_frames; ++frame_num)
+          {
+            const float* const frame_row_ptr = &dyn_image[frame_num][z][y][min_indices[3]];
+            float* const tac_ptr = row_ptr + (frame_num - 1);
+            for (int x = 0; x < num_voxels; ++x)
+              tac_ptr[x * num_frames] = frame_row_ptr[x];
+          }
+      }
+}
+
+void
+VoxelMajorDynamicDensity::allocate()
+{
+  BasicCoordinate<3, int> min_indices, max_indices;
+  if (!this->_index_range.get_regular_range(min_indices, max_indices))
+    error("VoxelMajorDynamicDensity: time frames need to have a regular index range");
+  const unsigned int num_frames = this->get_num_time_frames();
+  if (num_frames == 0)
+    error("VoxelMajorDynamicDensity: need at least 1 time frame");
+  // the Array constructor allocates a single block and sets all values to 0
+  this->_data = Array<4, float>(IndexRange<4>(join(min_indices, 1), join(max_indices, static_cast<int>(num_frames))));
+}
+
+void
+VoxelMajorDynamicDensity::check_contiguous(const char* const caller) const
+{
+  // the frame-strided pointer arithmetic below assumes that all TACs of an (x) row are stored in a single block
+  if (!this->_data.is_contiguous())
+    error(format("{}: data is not stored contiguously (was it resized or were its rows replaced?)", caller));
+}
+
+void
+VoxelMajorDynamicDensity::check_index_range(const DiscretisedDensity<3, float>& density, const char* const caller) const
+{
+  if (density.get_index_range() != this->_index_range)
+    error(format("{}: time frame has a different index range", caller));
+}
+
+VoxelMajorDynamicDensity*
+VoxelMajorDynamicDensity::read_from_file(const std::string& filename)
+{
+  unique_ptr<VoxelMajorDynamicDensity> image_uptr(stir::read_from_file<VoxelMajorDynamicDensity>(filename));
+  return image_uptr.release();
+}
+
+unique_ptr<DynamicDiscretisedDensity>
+VoxelMajorDynamicDensity::construct_dynamic_discretised_density() const
+{
+  const shared_ptr<SingleDiscretisedDensityType> frame_template_sptr(
+      new SingleDiscretisedDensityType(this->get_exam_info_sptr(), this->_index_range, this->_origin, this->_grid_spacing));
+  unique_ptr<DynamicDiscretisedDensity> dyn_image_uptr(
+      new DynamicDiscretisedDensity(this->get_time_frame_definitions(),
+                                    this->get_exam_info().start_time_in_secs_since_1970,
+                                    this->_scanner_sptr,
+                                    frame_template_sptr));
+  DynamicDiscretisedDensity& dyn_image = *dyn_image_uptr;
+
+  this->check_contiguous("VoxelMajorDynamicDensity::construct_dynamic_discretised_density");
+
+  BasicCoordinate<3, int> min_indices, max_indices;
+  this->_index_range.get_regular_range(min_indices, max_indices);
+  const unsigned int num_frames = this->get_num_time_frames();
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
+  for (int z = min_indices[1]; z <= max_indices[1]; ++z)
+    for (int y = min_indices[2]; y <= max_indices[2]; ++y)
+      {
+        const float* const row_ptr = &this->_data[z][y][min_indices[3]][1];
+        const int num_voxels = max_indices[3] - min_indices[3] + 1;
+        for (unsigned int frame_num = 1; frame_num <= num_frames; ++frame_num)
+          {
+            float* const frame_row_ptr = &dyn_image[frame_num][z][y][min_indices[3]];
+            const float* const tac_ptr = row_ptr + (frame_num - 1);
+            for (int x = 0; x < num_voxels; ++x)
+              frame_row_ptr[x] = tac_ptr[x * num_frames];
+          }
+      }
+  return dyn_image_uptr;
+}
+
+void
+VoxelMajorDynamicDensity::set_density(const DiscretisedDensity<3, float>& density, const unsigned int frame_num)
+{
+  if (frame_num < 1 || frame_num > this->get_num_time_frames())
+    error(format("VoxelMajorDynamicDensity::set_density: frame number {} out of range", frame_num));
+  this->check_index_range(density, "VoxelMajorDynamicDensity::set_density");
+  this->check_contiguous("VoxelMajorDynamicDensity::set_density");
+
+  BasicCoordinate<3, int> min_indices, max_indices;
+  this->_index_range.get_regular_range(min_indices, max_indices);
+  const unsigned int num_frames = this->get_num_time_frames();
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(static)
+#endif
+  for (int z = min_indices[1]; z <= max_indices[1]; ++z)
+    for (int y = min_indices[2]; y <= max_indices[2]; ++y)
+      {
+        const float* const frame_row_ptr = &density[z][y][min_indices[3]];
+        float* const tac_ptr = &this->_data[z][y][min_indices[3]][frame_num];
+        const int num_voxels = max_indices[3] - min_indices[3] + 1;
+        for (int x = 0; x < num_voxels; ++x)
+          tac_ptr[x * num_frames] = frame_row_ptr[x];
+      }
+}
+
+void
+VoxelMajorDynamicDensity::get_density(DiscretisedDensity<3, float>& density, const unsigned int frame_num) const
+{
+  if (frame_num < 1 || frame_num > this->get_num_time_frames())
+    error(format("VoxelMajorDynamicDensity::get_density: frame number {} out of range", frame_num));
+  this->check_index_range(density, "VoxelMajorDynamicDensity::get_density");
+  this->check_contiguous("VoxelMajorDynamicDensity::get_density");
+
+  BasicCoordinate<3, int> min_indices, max_indices;
+  this->_index_range.get_regular_range(min_indices, max_indices);
+  const unsigned int num_frames = this->get_num_time_frames();
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(static)
+#endif
+  for (int z = min_indices[1]; z <= max_indices[1]; ++z)
+    for (int y = min_indices[2]; y <= max_indices[2]; ++y)
+      {
+        float* const frame_row_ptr = &density[z][y][min_indices[3]];
+        const float* const tac_ptr = &this->_data[z][y][min_indices[3]][frame_num];
+        const int num_voxels = max_indices[3] - min_indices[3] + 1;
+        for (int x = 0; x < num_voxels; ++x)
+          frame_row_ptr[x] = tac_ptr[x * num_frames];
+      }
+}
+
+VoxelMajorDynamicDensity::SingleDiscretisedDensityType
+VoxelMajorDynamicDensity::construct_single_density(const unsigned int frame_num) const
+{
+  shared_ptr<ExamInfo> frame_exam_info_sptr(this->get_exam_info().create_shared_clone());
+  frame_exam_info_sptr->set_time_frame_definitions(TimeFrameDefinitions(this->get_time_frame_definitions(), frame_num));
+  SingleDiscretisedDensityType density(frame_exam_info_sptr, this->_index_range, this->_origin, this->_grid_spacing);
+  this->get_density(density, frame_num);
+  return density;
+}
+
+const TimeFrameDefinitions&
+VoxelMajorDynamicDensity::get_time_frame_definitions() const
+{
+  return this->get_exam_info().get_time_frame_definitions();
+}
+
+void
+VoxelMajorDynamicDensity::set_time_frame_definitions(const TimeFrameDefinitions& time_frame_definitions)
+{
+  if (time_frame_definitions.get_num_time_frames() != this->get_num_time_frames())
+    error("VoxelMajorDynamicDensity::set_time_frame_definitions: cannot change the number of time frames");
+  shared_ptr<ExamInfo> sptr = this->exam_info_sptr->create_shared_clone();
+  sptr->set_time_frame_definitions(time_frame_definitions);
+  this->exam_info_sptr = sptr;
+}
+
+float
+VoxelMajorDynamicDensity::get_scanner_default_bin_size() const
+{
+  if (!this->_scanner_sptr)
+    error("VoxelMajorDynamicDensity::get_scanner_default_bin_size(): scanner not set");
+  return this->_scanner_sptr->get_default_bin_size();
+}
+
+END_NAMESPACE_STIR
@@ -167,6 +167,18 @@ VoxelsOnCartesianGrid<elemT>::VoxelsOnCartesianGrid(const shared_ptr<const ExamI
     : DiscretisedDensityOnCartesianGrid<3, elemT>(exam_info_sptr, range, origin, grid_spacing)
 {}
 
+template <class elemT>
+VoxelsOnCartesianGrid<elemT>::VoxelsOnCartesianGrid(const shared_ptr<const ExamInfo>& exam_info_sptr,
+                                                    const IndexRange<3>& range,
+                                                    shared_ptr<elemT[]> data_sptr,
+                                                    const CartesianCoordinate3D<float>& origin,
+                                                    const BasicCoordinate<3, float>& grid_spacing)
+    : DiscretisedDensityOnCartesianGrid<3, elemT>(exam_info_sptr, IndexRange<3>(), origin, grid_spacing)
+{
+  // the assignment operator swaps with the (temporary) argument, so this does not copy
+  Array<3, elemT>::operator=(Array<3, elemT>(range, data_sptr));
+}
+
 // KT 10/12/2001 use new format of args for the constructor, and remove the make_xy_size_odd constructor
 template <class elemT>
 VoxelsOnCartesianGrid<elemT>::VoxelsOnCartesianGrid(const ProjDataInfo& proj_data_info,
@@ -0,0 +1,373 @@
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+
+  \file
+  \ingroup buildblock
+
+  \brief Implementation of the thread-local buffer pool
+
+  \author STIR contributors
+*/
+
+#include "stir/buffer_pool.h"
+#include "stir/info.h"
+#include "stir/Verbosity.h"
+#include "stir/format.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#  include <sys/resource.h>
+#endif
+
+START_NAMESPACE_STIR
+
+namespace
+{
+// Blocks are rounded up to a size-class. Every power of 2 is split in 4 classes,
+// such that at most 25% of memory is wasted.
+constexpr int num_classes_per_power_of_2 = 4;
+constexpr int max_num_size_classes = 64 * num_classes_per_power_of_2;
+constexpr std::size_t min_block_size = 64;
+
+// small enough such that idle threads (e.g. of OpenMP) do not keep much memory
+std::atomic<std::size_t> max_cached_bytes_per_thread(16UL * 1024 * 1024);
+
+// incremented by reset_buffer_pool_statistics(). Threads compare it with the value they have seen
+// to find out if they need to reset their peak. It is only read in the allocation functions.
+std::atomic<unsigned> statistics_generation(0);
+
+//! Statistics counters of one thread
+/*! They are only modified by the owning thread (without read-modify-write operations), such that
+    the allocation functions do not need to write to memory shared between threads.
+    get_buffer_pool_statistics() reads them from another thread, which is why they are atomic.
+
+    \c bytes_in_use is the number of bytes allocated by this thread minus the number of bytes freed
+    by this thread, so it can be negative when blocks are freed by another thread.
+*/
+struct ThreadStatistics
+{
+  std::atomic<std::size_t> num_requests{ 0 };
+  std::atomic<std::size_t> num_reuses{ 0 };
+  std::atomic<std::size_t> num_system_allocations{ 0 };
+  std::atomic<long long> bytes_in_use{ 0 };
+  std::atomic<long long> peak_bytes_in_use{ 0 };
+  std::atomic<unsigned> generation{ 0 };
+
+  static void increment(std::atomic<std::size_t>& counter)
+  {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  void add_bytes_in_use(const long long num_bytes)
+  {
+    const long long current = this->bytes_in_use.load(std::memory_order_relaxed) + num_bytes;
+    this->bytes_in_use.store(current, std::memory_order_relaxed);
+    const unsigned current_generation = statistics_generation.load(std::memory_order_relaxed);
+    if (this->generation.load(std::memory_order_relaxed) != current_generation)
+      {
+        this->generation.store(current_generation, std::memory_order_relaxed);
+        this->peak_bytes_in_use.store(current, std::memory_order_relaxed);
+      }
+    else if (current > this->peak_bytes_in_use.load(std::memory_order_relaxed))
+      this->peak_bytes_in_use.store(current, std::memory_order_relaxed);
+  }
+};
+
+//! Statistics summed over all threads, as well as the list of pools of running threads
+/*! This is only accessed when a thread starts or ends, and by the functions for the statistics. */
+struct StatisticsRegistry
+{
+  std::mutex mutex;
+  std::vector<const ThreadStatistics*> running_threads;
+  //! counts of threads that have finished
+  BufferPoolStatistics finished_threads{};
+  //! counts (of all threads) at the time of the last reset_buffer_pool_statistics()
+  BufferPoolStatistics at_reset{};
+};
+
+StatisticsRegistry&
+get_statistics_registry()
+{
+  static StatisticsRegistry registry;
+  return registry;
+}
+
+// used for the few allocations that happen after the pool of the thread has been destroyed
+std::atomic<long long> bytes_in_use_without_pool(0);
+
+//! find the size-class and its block size for a request
+inline int
+find_size_class(const std::size_t num_bytes, std::size_t& block_size)
+{
+  const std::size_t n = std::max(num_bytes, min_block_size);
+  // find b such that 2^(b-1) < n <= 2^b
+  int b = 0;
+  while ((std::size_t(1) << b) < n)
+    ++b;
+  const std::size_t base = std::size_t(1) << (b - 1);
+  const std::size_t step = base / num_classes_per_power_of_2;
+  int k = 1;
+  while (base + k * step < n)
+    ++k;
+  block_size = base + k * step;
+  return b * num_classes_per_power_of_2 + k - 1;
+}
+
+// set to true when the pool of the current thread has been destroyed (i.e. at thread exit),
+// such that static objects that are destroyed later free their memory directly
+thread_local bool thread_pool_destroyed = false;
+
+class ThreadLocalPool
+{
+public:
+  ThreadLocalPool()
+  {
+    auto& registry = get_statistics_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.running_threads.push_back(&this->statistics);
+  }
+
+  ~ThreadLocalPool()
+  {
+    this->release();
+    thread_pool_destroyed = true;
+    auto& registry = get_statistics_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto& running_threads = registry.running_threads;
+    running_threads.erase(std::find(running_threads.begin(), running_threads.end(), &this->statistics));
+    auto& finished = registry.finished_threads;
+    finished.num_requests += this->statistics.num_requests;
+    finished.num_reuses += this->statistics.num_reuses;
+    finished.num_system_allocations += this->statistics.num_system_allocations;
+    // blocks allocated by this thread might still be in use, so we keep track of them
+    bytes_in_use_without_pool += this->statistics.bytes_in_use;
+  }
+
+  ThreadStatistics statistics;
+
+  void* get_block(const int size_class)
+  {
+    auto& free_list = this->free_lists[size_class];
+    if (free_list.empty())
+      return nullptr;
+    void* ptr = free_list.back();
+    free_list.pop_back();
+    return ptr;
+  }
+
+  //! returns false if the block is not kept
+  bool keep_block(void* ptr, const int size_class, const std::size_t block_size)
+  {
+    if (this->cached_bytes + block_size > max_cached_bytes_per_thread.load(std::memory_order_relaxed))
+      return false;
+    this->free_lists[size_class].push_back(ptr);
+    this->cached_bytes += block_size;
+    return true;
+  }
+
+  void forget_block(const std::size_t block_size)
+  {
+    this->cached_bytes -= block_size;
+  }
+
+  void release()
+  {
+    for (auto& free_list : this->free_lists)
+      {
+        for (void* ptr : free_list)
+          ::operator delete(ptr);
+        free_list.clear();
+      }
+    this->cached_bytes = 0;
+  }
+
+private:
+  std::array<std::vector<void*>, max_num_size_classes> free_lists;
+  std::size_t cached_bytes = 0;
+};
+
+ThreadLocalPool&
+get_thread_local_pool()
+{
+  thread_local ThreadLocalPool pool;
+  return pool;
+}
+
+} // namespace
+
+void*
+allocate_from_buffer_pool(const std::size_t num_bytes)
+{
+  std::size_t block_size;
+  const int size_class = find_size_class(num_bytes, block_size);
+
+  if (thread_pool_destroyed)
+    {
+      bytes_in_use_without_pool += static_cast<long long>(block_size);
+      return ::operator new(block_size);
+    }
+
+  auto& pool = get_thread_local_pool();
+  auto& statistics = pool.statistics;
+  ThreadStatistics::increment(statistics.num_requests);
+  void* ptr = pool.get_block(size_class);
+  if (ptr != nullptr)
+    {
+      pool.forget_block(block_size);
+      ThreadStatistics::increment(statistics.num_reuses);
+    }
+  else
+    {
+      ptr = ::operator new(block_size);
+      ThreadStatistics::increment(statistics.num_system_allocations);
+    }
+  statistics.add_bytes_in_use(static_cast<long long>(block_size));
+  return ptr;
+}
+
+void
+deallocate_to_buffer_pool(void* ptr, const std::size_t num_bytes) noexcept
+{
+  if (ptr == nullptr)
+    return;
+  std::size_t block_size;
+  const int size_class = find_size_class(num_bytes, block_size);
+  if (thread_pool_destroyed)
+    {
+      bytes_in_use_without_pool -= static_cast<long long>(block_size);
+      ::operator delete(ptr);
+      return;
+    }
+  auto& pool = get_thread_local_pool();
+  pool.statistics.add_bytes_in_use(-static_cast<long long>(block_size));
+  try
+    {
+      // Note: if the block was allocated by another thread, it ends up in the pool of this thread
+      if (pool.keep_block(ptr, size_class, block_size))
+        return;
+    }
+  catch (...)
+    {
+      // growing the free-list failed, just free the block
+    }
+  ::operator delete(ptr);
+}
+
+void
+release_buffer_pool_memory()
+{
+  if (!thread_pool_destroyed)
+    get_thread_local_pool().release();
+}
+
+void
+set_buffer_pool_max_cached_bytes(const std::size_t max_cached_bytes)
+{
+  max_cached_bytes_per_thread = max_cached_bytes;
+}
+
+std::size_t
+get_buffer_pool_max_cached_bytes()
+{
+  return max_cached_bytes_per_thread;
+}
+
+namespace
+{
+//! sum the counters of all threads. Needs to be called with a lock on the registry mutex.
+BufferPoolStatistics
+get_total_statistics(const StatisticsRegistry& registry)
+{
+  BufferPoolStatistics total = registry.finished_threads;
+  long long bytes_in_use = bytes_in_use_without_pool.load();
+  long long peak_bytes_in_use = 0;
+  const unsigned current_generation = statistics_generation.load();
+  for (const ThreadStatistics* statistics_ptr : registry.running_threads)
+    {
+      total.num_requests += statistics_ptr->num_requests.load(std::memory_order_relaxed);
+      total.num_reuses += statistics_ptr->num_reuses.load(std::memory_order_relaxed);
+      total.num_system_allocations += statistics_ptr->num_system_allocations.load(std::memory_order_relaxed);
+      const long long thread_bytes_in_use = statistics_ptr->bytes_in_use.load(std::memory_order_relaxed);
+      bytes_in_use += thread_bytes_in_use;
+      // threads that did not allocate since the last reset still have their old peak
+      const long long thread_peak = statistics_ptr->generation.load(std::memory_order_relaxed) == current_generation
+                                        ? statistics_ptr->peak_bytes_in_use.load(std::memory_order_relaxed)
+                                        : thread_bytes_in_use;
+      peak_bytes_in_use += std::max(thread_peak, 0LL);
+    }
+  total.bytes_in_use = static_cast<std::size_t>(std::max(bytes_in_use, 0LL));
+  total.peak_bytes_in_use = std::max(static_cast<std::size_t>(peak_bytes_in_use), total.bytes_in_use);
+  return total;
+}
+} // namespace
+
+BufferPoolStatistics
+get_buffer_pool_statistics()
+{
+  auto& registry = get_statistics_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  BufferPoolStatistics stats = get_total_statistics(registry);
+  stats.num_requests -= registry.at_reset.num_requests;
+  stats.num_reuses -= registry.at_reset.num_reuses;
+  stats.num_system_allocations -= registry.at_reset.num_system_allocations;
+  return stats;
+}
+
+void
+reset_buffer_pool_statistics()
+{
+  auto& registry = get_statistics_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  ++statistics_generation;
+  registry.at_reset = get_total_statistics(registry);
+}
+
+std::size_t
+get_peak_resident_set_size()
+{
+#if defined(__unix__) || defined(__APPLE__)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#  if defined(__APPLE__)
+  // in bytes
+  return static_cast<std::size_t>(usage.ru_maxrss);
+#  else
+  // in kilobytes
+  return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#  endif
+#else
+  return 0;
+#endif
+}
+
+void
+report_memory_statistics(const std::string& context, const int verbosity_level)
+{
+  if (Verbosity::get() < verbosity_level)
+    return;
+  const auto stats = get_buffer_pool_statistics();
+  info(format("Memory statistics for {}: {} buffer requests ({} reused from pool, {} system allocations), "
+              "peak pool usage {} MB, peak RSS {} MB",
+              context,
+              stats.num_requests,
+              stats.num_reuses,
+              stats.num_system_allocations,
+              stats.peak_bytes_in_use / (1024. * 1024.),
+              get_peak_resident_set_size() / (1024. * 1024.)),
+       verbosity_level);
+}
+
+END_NAMESPACE_STIR
@@ -22,9 +22,11 @@
 #include "stir/ProjDataInfo.h"
 #include "stir/inverse_SSRB.h"
 #include "stir/Sinogram.h"
+#include "stir/SegmentBySinogram.h"
 #include "stir/Bin.h"
 #include "stir/Succeeded.h"
 #include <limits>
+#include <vector>
 #include "stir/warning.h"
 #include "stir/error.h"
 
@@ -50,12 +52,6 @@ inverse_SSRB(ProjData& proj_data_4D, const ProjData& proj_data_3D)
       return Succeeded::no;
     }
 
-  // keep sinograms out of the loop to avoid reallocations
-  // initialise to something because there's no default constructor
-  Sinogram<float> sino_4D = proj_data_4D.get_empty_sinogram(proj_data_4D.get_min_axial_pos_num(0), 0);
-  Sinogram<float> sino_3D_1 = proj_data_3D.get_empty_sinogram(proj_data_3D.get_min_axial_pos_num(0), 0);
-  Sinogram<float> sino_3D_2 = proj_data_3D.get_empty_sinogram(proj_data_3D.get_min_axial_pos_num(0), 0);
-
   // prefill a vector with the axial positions of the direct sinograms
   VectorWithOffset<float> in_m(proj_data_3D.get_min_axial_pos_num(0), proj_data_3D.get_max_axial_pos_num(0));
   for (int in_ax_pos_num = proj_data_3D.get_min_axial_pos_num(0); in_ax_pos_num <= proj_data_3D.get_max_axial_pos_num(0);
@@ -64,6 +60,18 @@ inverse_SSRB(ProjData& proj_data_4D, const ProjData& proj_data_3D)
       in_m.at(in_ax_pos_num) = proj_data_3D_info_sptr->get_m(Bin(0, 0, in_ax_pos_num, 0));
     }
 
+  // For every output sinogram, find which direct sinograms are used, and their weights.
+  // This does not depend on TOF.
+  struct InverseSSRBItem
+  {
+    int out_segment_num;
+    int out_ax_pos_num;
+    int in_ax_pos_num1;
+    int in_ax_pos_num2;
+    float weight1;
+    float weight2;
+  };
+  std::vector<InverseSSRBItem> items;
   for (int out_segment_num = proj_data_4D.get_min_segment_num(); out_segment_num <= proj_data_4D.get_max_segment_num();
        ++out_segment_num)
     {
@@ -71,65 +79,93 @@ inverse_SSRB(ProjData& proj_data_4D, const ProjData& proj_data_3D)
            out_ax_pos_num <= proj_data_4D.get_max_axial_pos_num(out_segment_num);
            ++out_ax_pos_num)
         {
-          for (int k = proj_data_4D.get_proj_data_info_sptr()->get_min_tof_pos_num();
-               k <= proj_data_4D.get_proj_data_info_sptr()->get_max_tof_pos_num();
-               ++k)
-            {
-              sino_4D = proj_data_4D.get_empty_sinogram(out_ax_pos_num, out_segment_num, false, k);
-              const float out_m = proj_data_4D_info_sptr->get_m(Bin(out_segment_num, 0, out_ax_pos_num, 0));
+          const float out_m = proj_data_4D_info_sptr->get_m(Bin(out_segment_num, 0, out_ax_pos_num, 0));
 
-              // Go through all direct sinograms to check which pair are closest.
-              bool sinogram_set = false;
-              for (int in_ax_pos_num = proj_data_3D.get_min_axial_pos_num(0);
-                   in_ax_pos_num <= proj_data_3D.get_max_axial_pos_num(0);
-                   ++in_ax_pos_num)
-                {
-                  // for the first slice there is no previous
-                  const auto distance_to_previous = in_ax_pos_num == proj_data_3D.get_min_axial_pos_num(0)
-                                                        ? std::numeric_limits<float>::max()
-                                                        : std::abs(out_m - in_m.at(in_ax_pos_num - 1));
-                  const auto distance_to_current = std::abs(out_m - in_m.at(in_ax_pos_num));
-                  // for the last slice there is no next
-                  const auto distance_to_next = in_ax_pos_num == proj_data_3D.get_max_axial_pos_num(0)
+          // Go through all direct sinograms to check which pair are closest.
+          bool sinogram_found = false;
+          for (int in_ax_pos_num = proj_data_3D.get_min_axial_pos_num(0); in_ax_pos_num <= proj_data_3D.get_max_axial_pos_num(0);
+               ++in_ax_pos_num)
+            {
+              // for the first slice there is no previous
+              const auto distance_to_previous = in_ax_pos_num == proj_data_3D.get_min_axial_pos_num(0)
                                                     ? std::numeric_limits<float>::max()
-                                                    : std::abs(out_m - in_m.at(in_ax_pos_num + 1));
-                  if (distance_to_current <= distance_to_previous && distance_to_current <= distance_to_next)
+                                                    : std::abs(out_m - in_m.at(in_ax_pos_num - 1));
+              const auto distance_to_current = std::abs(out_m - in_m.at(in_ax_pos_num));
+              // for the last slice there is no next
+              const auto distance_to_next = in_ax_pos_num == proj_data_3D.get_max_axial_pos_num(0)
+                                                ? std::numeric_limits<float>::max()
+                                                : std::abs(out_m - in_m.at(in_ax_pos_num + 1));
+              if (distance_to_current <= distance_to_previous && distance_to_current <= distance_to_next)
+                {
+                  if (distance_to_current <= 1E-4)
                     {
-                      if (distance_to_current <= 1E-4)
-                        {
-                          sino_3D_1 = proj_data_3D.get_sinogram(in_ax_pos_num, 0, false, k);
-                          sino_4D += sino_3D_1;
-                        }
-                      else if (distance_to_previous < distance_to_next)
-                        { // interpolate between the previous axial slice and this one
-                          const auto distance_sum = distance_to_previous + distance_to_current;
-                          sino_3D_1 = proj_data_3D.get_sinogram(in_ax_pos_num - 1, 0, false, k);
-                          sino_3D_2 = proj_data_3D.get_sinogram(in_ax_pos_num, 0, false, k);
-                          sino_3D_1.sapyb(distance_to_current / distance_sum, sino_3D_2, distance_to_previous / distance_sum);
-                          sino_4D += sino_3D_1;
-                        }
-                      else
-                        { // interpolate between the next axial slice and this one
-                          const auto distance_sum = distance_to_next + distance_to_current;
-                          sino_3D_1 = proj_data_3D.get_sinogram(in_ax_pos_num + 1, 0, false, k);
-                          sino_3D_2 = proj_data_3D.get_sinogram(in_ax_pos_num, 0, false, k);
-                          sino_3D_1.sapyb(distance_to_current / distance_sum, sino_3D_2, distance_to_next / distance_sum);
-                          sino_4D += sino_3D_1;
-                        }
-
-                      if (proj_data_4D.set_sinogram(sino_4D) == Succeeded::no)
-                        return Succeeded::no;
-                      sinogram_set = true;
-                      break;
+                      items.push_back({ out_segment_num, out_ax_pos_num, in_ax_pos_num, in_ax_pos_num, 1.F, 0.F });
                     }
-                }
-              if (!sinogram_set)
-                { // it is logically not possible to get here
-                  error("no matching sinogram found for segment %d and axial pos %d", out_segment_num, out_ax_pos_num);
+                  else if (distance_to_previous < distance_to_next)
+                    { // interpolate between the previous axial slice and this one
+                      const auto distance_sum = distance_to_previous + distance_to_current;
+                      items.push_back({ out_segment_num,
+                                        out_ax_pos_num,
+                                        in_ax_pos_num - 1,
+                                        in_ax_pos_num,
+                                        distance_to_current / distance_sum,
+                                        distance_to_previous / distance_sum });
+                    }
+                  else
+                    { // interpolate between the next axial slice and this one
+                      const auto distance_sum = distance_to_next + distance_to_current;
+                      items.push_back({ out_segment_num,
+                                        out_ax_pos_num,
+                                        in_ax_pos_num + 1,
+                                        in_ax_pos_num,
+                                        distance_to_current / distance_sum,
+                                        distance_to_next / distance_sum });
+                    }
+                  sinogram_found = true;
+                  break;
                 }
             }
+          if (!sinogram_found)
+            { // it is logically not possible to get here
+              error("no matching sinogram found for segment %d and axial pos %d", out_segment_num, out_ax_pos_num);
+            }
+        }
+    }
+
+  // read the direct sinograms once for every TOF bin
+  const int min_timing_pos_num = proj_data_4D.get_proj_data_info_sptr()->get_min_tof_pos_num();
+  const int max_timing_pos_num = proj_data_4D.get_proj_data_info_sptr()->get_max_tof_pos_num();
+  std::vector<SegmentBySinogram<float>> segments_3D;
+  for (int k = min_timing_pos_num; k <= max_timing_pos_num; ++k)
+    segments_3D.push_back(proj_data_3D.get_segment_by_sinogram(0, k));
+
+  bool all_succeeded = true;
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
+  for (int i = 0; i < static_cast<int>(items.size() * segments_3D.size()); ++i)
+    {
+      const InverseSSRBItem& item = items[i / segments_3D.size()];
+      const int k = min_timing_pos_num + static_cast<int>(i % segments_3D.size());
+      const SegmentBySinogram<float>& segment_3D = segments_3D[k - min_timing_pos_num];
+      Sinogram<float> sino_4D = proj_data_4D.get_empty_sinogram(item.out_ax_pos_num, item.out_segment_num, false, k);
+      sino_4D += segment_3D[item.in_ax_pos_num1];
+      if (item.weight2 != 0.F)
+        sino_4D.sapyb(item.weight1, segment_3D[item.in_ax_pos_num2], item.weight2);
+
+      Succeeded success;
+#ifdef STIR_OPENMP
+#  pragma omp critical(INVERSE_SSRB_WRITE_SINOGRAM)
+#endif
+      success = proj_data_4D.set_sinogram(sino_4D);
+      if (success == Succeeded::no)
+        {
+#ifdef STIR_OPENMP
+#  pragma omp atomic write
+#endif
+          all_succeeded = false;
         }
     }
-  return Succeeded::yes;
+  return all_succeeded ? Succeeded::yes : Succeeded::no;
 }
 END_NAMESPACE_STIR
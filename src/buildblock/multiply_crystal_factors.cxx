@@ -23,131 +23,188 @@
 #include "stir/ProjDataInfoBlocksOnCylindricalNoArcCorr.h"
 #include "stir/Bin.h"
 #include "stir/Sinogram.h"
+#include "stir/DetectionPositionPair.h"
+#include "stir/Array.h"
 #include "stir/error.h"
 #include <memory>
+#include <vector>
 
 START_NAMESPACE_STIR
 
-// declaration of local function that does the work
+// local function that does the work
 template <class TProjDataInfo>
-void
-multiply_crystal_factors_help(ProjData& proj_data,
+static void
+multiply_crystal_factors_help(const std::vector<ProjData*>& proj_data_ptrs,
                               const TProjDataInfo& proj_data_info,
-                              const Array<2, float>& efficiencies,
-                              float global_factor)
+                              const std::vector<const Array<2, float>*>& efficiencies_ptrs,
+                              const std::vector<float>& global_factors)
 {
+  const int num_outputs = static_cast<int>(proj_data_ptrs.size());
   // we will duplicate TOF sinograms, so need to divide with their number such that
   // total remains preserved
-  global_factor /= proj_data.get_num_tof_poss();
+  const int num_tof_poss = proj_data_info.get_num_tof_poss();
 
   const auto non_tof_proj_data_info_sptr = std::dynamic_pointer_cast<TProjDataInfo>(proj_data_info.create_non_tof_clone());
-  Bin bin;
-
-  for (bin.segment_num() = proj_data.get_min_segment_num(); bin.segment_num() <= proj_data.get_max_segment_num();
-       ++bin.segment_num())
-    {
 
-      for (bin.axial_pos_num() = proj_data.get_min_axial_pos_num(bin.segment_num());
-           bin.axial_pos_num() <= proj_data.get_max_axial_pos_num(bin.segment_num());
-           ++bin.axial_pos_num())
-        {
-          Sinogram<float> sinogram = non_tof_proj_data_info_sptr->get_empty_sinogram(SinogramIndices(bin));
+  const int min_view_num = proj_data_info.get_min_view_num();
+  const int num_views = proj_data_info.get_num_views();
+  const int min_tangential_pos_num = proj_data_info.get_min_tangential_pos_num();
+  const int num_tangential_poss = proj_data_info.get_num_tangential_poss();
+  const int view_mashing_factor = proj_data_info.get_view_mashing_factor();
+
+  // Find the detector numbers for all uncompressed views that contribute to a view and tangential position.
+  // These do not depend on the segment and axial position, so we find them once, using the first sinogram.
+  // Index is ((view_num - min_view_num) * view_mashing_factor + uncompressed_view) * num_tangential_poss + tang_pos
+  std::vector<int> det1_nums(num_views * view_mashing_factor * num_tangential_poss);
+  std::vector<int> det2_nums(det1_nums.size());
+  {
+    Bin bin(proj_data_info.get_min_segment_num(), min_view_num, 0, min_tangential_pos_num);
+    bin.axial_pos_num() = proj_data_info.get_min_axial_pos_num(bin.segment_num());
+    const int num_ring_pairs = static_cast<int>(
+        non_tof_proj_data_info_sptr->get_num_ring_pairs_for_segment_axial_pos_num(bin.segment_num(), bin.axial_pos_num()));
+    std::vector<DetectionPositionPair<>> det_pos_pairs;
+    std::size_t idx = 0;
+    for (bin.view_num() = min_view_num; bin.view_num() <= proj_data_info.get_max_view_num(); ++bin.view_num())
+      for (int uncompressed_view = 0; uncompressed_view < view_mashing_factor; ++uncompressed_view)
+        for (bin.tangential_pos_num() = min_tangential_pos_num;
+             bin.tangential_pos_num() <= proj_data_info.get_max_tangential_pos_num();
+             ++bin.tangential_pos_num(), ++idx)
+          {
+            non_tof_proj_data_info_sptr->get_all_det_pos_pairs_for_bin(det_pos_pairs, bin);
+            // det_pos_pairs is ordered by uncompressed view, then by ring pair
+            if (static_cast<int>(det_pos_pairs.size()) != num_ring_pairs * view_mashing_factor)
+              error("multiply_crystal_factors: unexpected number of detector pairs for a bin");
+            const auto& det_pos_pair = det_pos_pairs[uncompressed_view * num_ring_pairs];
+            det1_nums[idx] = det_pos_pair.pos1().tangential_coord();
+            det2_nums[idx] = det_pos_pair.pos2().tangential_coord();
+          }
+  }
+
+  // list all sinograms such that we can distribute them over threads
+  std::vector<SinogramIndices> all_sinogram_indices;
+  for (int segment_num = proj_data_info.get_min_segment_num(); segment_num <= proj_data_info.get_max_segment_num();
+       ++segment_num)
+    for (int axial_pos_num = proj_data_info.get_min_axial_pos_num(segment_num);
+         axial_pos_num <= proj_data_info.get_max_axial_pos_num(segment_num);
+         ++axial_pos_num)
+      all_sinogram_indices.push_back(SinogramIndices(axial_pos_num, segment_num, 0));
 
 #ifdef STIR_OPENMP
-#  if _OPENMP >= 200711
-#    pragma omp parallel for collapse(2) // OpenMP 3.1
-#  else
-#    pragma omp parallel for // older versions
-#  endif
+#  pragma omp parallel for schedule(dynamic)
 #endif
-          for (int view_num = proj_data.get_min_view_num(); view_num <= proj_data.get_max_view_num(); ++view_num)
+  for (int sinogram_idx = 0; sinogram_idx < static_cast<int>(all_sinogram_indices.size()); ++sinogram_idx)
+    {
+      const SinogramIndices& sinogram_indices = all_sinogram_indices[sinogram_idx];
+      const auto& ring_pairs = non_tof_proj_data_info_sptr->get_all_ring_pairs_for_segment_axial_pos_num(
+          sinogram_indices.segment_num(), sinogram_indices.axial_pos_num());
+
+      for (int output_num = 0; output_num < num_outputs; ++output_num)
+        {
+          const Array<2, float>& efficiencies = *efficiencies_ptrs[output_num];
+          Sinogram<float> sinogram = non_tof_proj_data_info_sptr->get_empty_sinogram(sinogram_indices);
+          // sum over ring pairs of the products of the efficiencies of both rings
+          for (const auto& ring_pair : ring_pairs)
             {
-              for (int tangential_pos_num = proj_data.get_min_tangential_pos_num();
-                   tangential_pos_num <= proj_data.get_max_tangential_pos_num();
-                   ++tangential_pos_num)
+              const Array<1, float>& efficiencies1 = efficiencies[ring_pair.first];
+              const Array<1, float>& efficiencies2 = efficiencies[ring_pair.second];
+              std::size_t idx = 0;
+              for (int view_num = min_view_num; view_num < min_view_num + num_views; ++view_num)
                 {
-                  // Construct bin with appropriate values
-                  // Sadly cannot be done in the loops above for OpenMP 2.0 compatibility
-                  Bin parallel_bin(bin);
-                  parallel_bin.view_num() = view_num;
-                  parallel_bin.tangential_pos_num() = tangential_pos_num;
-
-                  std::vector<DetectionPositionPair<>> det_pos_pairs;
-                  non_tof_proj_data_info_sptr->get_all_det_pos_pairs_for_bin(
-                      det_pos_pairs, parallel_bin); // using the default argument to ignore TOF here
-                  float result = 0.F;
-                  for (unsigned int i = 0; i < det_pos_pairs.size(); ++i)
-                    {
-                      const auto& p1 = det_pos_pairs[i].pos1();
-                      const auto& p2 = det_pos_pairs[i].pos2();
-                      result += efficiencies[p1.axial_coord()][p1.tangential_coord()]
-                                * efficiencies[p2.axial_coord()][p2.tangential_coord()];
-                    }
-#if defined(STIR_OPENMP)
-#  if _OPENMP >= 201012
-#    pragma omp atomic update
-#  else
-#    pragma omp critical(STIRMULTIPLYCRYSTALFACTORS)
-                  {
-#  endif
-#endif
-                  // Use += such that the "atomic update" pragma compiles (OpenMP 3.0).
-                  // Presumably with OpenMP 3.1 we could use "atomic write"
-                  sinogram[parallel_bin.view_num()][parallel_bin.tangential_pos_num()] += result * global_factor;
-#if defined(STIR_OPENMP) && _OPENMP < 201012
+                  Array<1, float>& sinogram_row = sinogram[view_num];
+                  for (int uncompressed_view = 0; uncompressed_view < view_mashing_factor; ++uncompressed_view)
+                    for (int tang_pos_num = min_tangential_pos_num; tang_pos_num < min_tangential_pos_num + num_tangential_poss;
+                         ++tang_pos_num, ++idx)
+                      sinogram_row[tang_pos_num] += efficiencies1[det1_nums[idx]] * efficiencies2[det2_nums[idx]];
                 }
-#endif
-            }
-        }
-      // now set sinogram, a bit complicated for TOF as we replicate
-      if (proj_data.get_num_tof_poss() == 1)
-        {
-          proj_data.set_sinogram(sinogram);
-        }
-      else
-        {
-          for (bin.timing_pos_num() = proj_data.get_min_tof_pos_num(); bin.timing_pos_num() <= proj_data.get_max_tof_pos_num();
-               ++bin.timing_pos_num())
-            {
-              // construct TOF sinogram with same values as the non-TOF sinogram,
-              // but appropriate meta-data.
-              const Sinogram<float> tof_sinogram(sinogram, proj_data.get_proj_data_info_sptr(), SinogramIndices(bin));
-              proj_data.set_sinogram(tof_sinogram);
             }
+          sinogram *= global_factors[output_num] / num_tof_poss;
+
+          ProjData& proj_data = *proj_data_ptrs[output_num];
+          // now set sinogram, a bit complicated for TOF as we replicate
+#ifdef STIR_OPENMP
+#  pragma omp critical(STIRMULTIPLYCRYSTALFACTORS)
+#endif
+          {
+            if (num_tof_poss == 1)
+              {
+                proj_data.set_sinogram(sinogram);
+              }
+            else
+              {
+                for (int timing_pos_num = proj_data.get_min_tof_pos_num(); timing_pos_num <= proj_data.get_max_tof_pos_num();
+                     ++timing_pos_num)
+                  {
+                    // construct TOF sinogram with same values as the non-TOF sinogram,
+                    // but appropriate meta-data.
+                    const Sinogram<float> tof_sinogram(
+                        sinogram,
+                        proj_data.get_proj_data_info_sptr(),
+                        SinogramIndices(sinogram_indices.axial_pos_num(), sinogram_indices.segment_num(), timing_pos_num));
+                    proj_data.set_sinogram(tof_sinogram);
+                  }
+              }
+          }
         }
     }
 }
-}
 
-void
-multiply_crystal_factors(ProjData& proj_data, const Array<2, float>& efficiencies, const float global_factor)
+// find the ProjDataInfo type and call multiply_crystal_factors_help
+static void
+multiply_crystal_factors_find_type(const std::vector<ProjData*>& proj_data_ptrs,
+                                   const std::vector<const Array<2, float>*>& efficiencies_ptrs,
+                                   const std::vector<float>& global_factors)
 {
-  if (proj_data.get_proj_data_info_sptr()->get_scanner_ptr()->get_scanner_geometry() == "Cylindrical")
+  if (proj_data_ptrs.size() != efficiencies_ptrs.size() || proj_data_ptrs.size() != global_factors.size())
+    error("multiply_crystal_factors: need as many efficiencies and global factors as projection data");
+  if (proj_data_ptrs.empty())
+    return;
+  const ProjDataInfo& proj_data_info = *proj_data_ptrs[0]->get_proj_data_info_sptr();
+  for (const auto proj_data_ptr : proj_data_ptrs)
+    if (*proj_data_ptr->get_proj_data_info_sptr() != proj_data_info)
+      error("multiply_crystal_factors: all projection data need to have the same geometry");
+
+  if (proj_data_info.get_scanner_ptr()->get_scanner_geometry() == "Cylindrical")
     {
-      auto proj_data_info_ptr
-          = dynamic_cast<const ProjDataInfoCylindricalNoArcCorr* const>(proj_data.get_proj_data_info_sptr().get());
+      auto proj_data_info_ptr = dynamic_cast<const ProjDataInfoCylindricalNoArcCorr* const>(&proj_data_info);
 
       if (proj_data_info_ptr == 0)
         {
           error("Can only process not arc-corrected data\n");
         }
-      multiply_crystal_factors_help(proj_data, *proj_data_info_ptr, efficiencies, global_factor);
+      multiply_crystal_factors_help(proj_data_ptrs, *proj_data_info_ptr, efficiencies_ptrs, global_factors);
     }
   else
     {
-      auto proj_data_info_ptr
-          = dynamic_cast<const ProjDataInfoBlocksOnCylindricalNoArcCorr* const>(proj_data.get_proj_data_info_sptr().get());
+      auto proj_data_info_ptr = dynamic_cast<const ProjDataInfoBlocksOnCylindricalNoArcCorr* const>(&proj_data_info);
 
       if (proj_data_info_ptr == 0)
         {
           error("Can only process not arc-corrected data\n");
         }
-      multiply_crystal_factors_help(proj_data, *proj_data_info_ptr, efficiencies, global_factor);
+      multiply_crystal_factors_help(proj_data_ptrs, *proj_data_info_ptr, efficiencies_ptrs, global_factors);
     }
 }
 
-template void
-multiply_crystal_factors_help(ProjData&, const ProjDataInfoCylindricalNoArcCorr&, const Array<2, float>&, const float);
-template void
-multiply_crystal_factors_help(ProjData&, const ProjDataInfoBlocksOnCylindricalNoArcCorr&, const Array<2, float>&, const float);
+void
+multiply_crystal_factors(ProjData& proj_data, const Array<2, float>& efficiencies, const float global_factor)
+{
+  multiply_crystal_factors_find_type(std::vector<ProjData*>(1, &proj_data),
+                                     std::vector<const Array<2, float>*>(1, &efficiencies),
+                                     std::vector<float>(1, global_factor));
+}
+
+void
+multiply_crystal_factors(const std::vector<shared_ptr<ProjData>>& proj_data_sptrs,
+                         const std::vector<Array<2, float>>& efficiencies,
+                         const std::vector<float>& global_factors)
+{
+  std::vector<ProjData*> proj_data_ptrs;
+  for (const auto& proj_data_sptr : proj_data_sptrs)
+    proj_data_ptrs.push_back(proj_data_sptr.get());
+  std::vector<const Array<2, float>*> efficiencies_ptrs;
+  for (const auto& e : efficiencies)
+    efficiencies_ptrs.push_back(&e);
+  multiply_crystal_factors_find_type(proj_data_ptrs, efficiencies_ptrs, global_factors);
+}
+
 END_NAMESPACE_STIR
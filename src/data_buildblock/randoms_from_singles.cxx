@@ -19,6 +19,7 @@
 
 #include "stir/multiply_crystal_factors.h"
 #include "stir/ProjData.h"
+#include "stir/DynamicProjData.h"
 #include "stir/data/SinglesRates.h"
 #include "stir/Scanner.h"
 #include "stir/DetectionPosition.h"
@@ -27,9 +28,72 @@
 #include "stir/IndexRange2D.h"
 #include "stir/info.h"
 #include "stir/format.h"
+#include "stir/error.h"
+#include <vector>
 
 START_NAMESPACE_STIR
 
+/* Find total singles for a time frame, and the factor to convert the product of singles to randoms.
+
+   Randoms from singles formula is
+
+     randoms-rate[t,i,j] = coinc_window * singles-rate[t,i] * singles-rate[t,j]
+
+   However, we actually have total counts in the singles for sinograms.
+   and need total counts in the randoms.
+   Assuming there is just decay going on, then we have
+
+     randoms-rate[t,i,j] = coinc_window * singles-rate[0,i] * singles-rate[0,j] exp (-2lambda t)
+
+     randoms-counts[i,j] = int_t1^t2 randoms-rate[t,i,j]
+               = coinc_window * singles-rate[0,i] * singles-rate[0,j] * int_t1^t2 exp (-2lambda t)
+               = coinc_window * singles-counts[i] * singles-counts[j] *
+                 int_t1^t2 exp (-2lambda t) / (int_t1^t2 exp (-lambda t))^2
+   where int indicates an integral.
+
+   Now we can use that decay_correction_factor(lambda,t1,t2) computes
+        duration/(int_t1^t2 exp (-lambda t))
+
+   That leads to the formula below (as it turns out that the above ratio only depends t2-t1)
+*/
+static float
+get_total_singles_and_factor_for_frame(Array<2, float>& total_singles,
+                                       const SinglesRates& singles,
+                                       const Scanner& scanner,
+                                       const double start_time,
+                                       const double end_time,
+                                       const float coincidence_time_window,
+                                       const float isotope_halflife)
+{
+  const int num_rings = scanner.get_num_rings();
+  const int num_detectors_per_ring = scanner.get_num_detectors_per_ring();
+
+  total_singles.resize(IndexRange2D(num_rings, num_detectors_per_ring));
+  for (int r = 0; r < num_rings; ++r)
+    for (int c = 0; c < num_detectors_per_ring; ++c)
+      {
+        const DetectionPosition<> pos(c, r, 0);
+        total_singles[r][c] = singles.get_singles(pos, start_time, end_time);
+      }
+
+  const double duration = end_time - start_time;
+  const double decay_corr_factor = decay_correction_factor(isotope_halflife, 0., duration);
+  const double double_decay_corr_factor = decay_correction_factor(0.5 * isotope_halflife, 0., duration);
+  const double corr_factor = square(decay_corr_factor) / double_decay_corr_factor / duration;
+
+  info(format("Isotope half-life: {}\n"
+              "RFS: decay correction factor: {},\n"
+              "time frame duration: {}.\n"
+              "total correction factor from 2tau*(singles_totals)^2 to randoms_totals: {}.\n",
+              isotope_halflife,
+              decay_corr_factor,
+              duration,
+              (1 / corr_factor)),
+       2);
+
+  return static_cast<float>(coincidence_time_window * corr_factor);
+}
+
 void
 randoms_from_singles(ProjData& proj_data, const SinglesRates& singles, float coincidence_time_window, float isotope_halflife)
 {
@@ -39,59 +103,52 @@ randoms_from_singles(ProjData& proj_data, const SinglesRates& singles, float coi
   if (isotope_halflife <= 0.F)
     isotope_halflife = proj_data.get_exam_info().get_radionuclide().get_half_life();
 
-  const int num_rings = scanner.get_num_rings();
-  const int num_detectors_per_ring = scanner.get_num_detectors_per_ring();
-
   const TimeFrameDefinitions frame_defs = proj_data.get_exam_info_sptr()->get_time_frame_definitions();
 
   // get total singles for this frame
-  Array<2, float> total_singles(IndexRange2D(num_rings, num_detectors_per_ring));
-  for (int r = 0; r < num_rings; ++r)
-    for (int c = 0; c < num_detectors_per_ring; ++c)
-      {
-        const DetectionPosition<> pos(c, r, 0);
-        total_singles[r][c] = singles.get_singles(pos, frame_defs.get_start_time(1), frame_defs.get_end_time(1));
-      }
+  Array<2, float> total_singles;
+  const float global_factor = get_total_singles_and_factor_for_frame(total_singles,
+                                                                     singles,
+                                                                     scanner,
+                                                                     frame_defs.get_start_time(1),
+                                                                     frame_defs.get_end_time(1),
+                                                                     coincidence_time_window,
+                                                                     isotope_halflife);
+  multiply_crystal_factors(proj_data, total_singles, global_factor);
+}
+
+void
+randoms_from_singles(DynamicProjData& proj_data,
+                     const SinglesRates& singles,
+                     float coincidence_time_window,
+                     float isotope_halflife)
+{
+  const TimeFrameDefinitions& frame_defs = proj_data.get_time_frame_definitions();
+  const unsigned int num_frames = frame_defs.get_num_frames();
+  if (num_frames == 0 || proj_data.get_num_frames() != num_frames)
+    error("randoms_from_singles: number of time frames and projection data do not match");
+
+  const auto& scanner = *proj_data.get_proj_data_info_sptr()->get_scanner_ptr();
+  if (coincidence_time_window <= 0.F)
+    coincidence_time_window = scanner.get_coincidence_window_width_in_ps() / 1e12F;
+  if (isotope_halflife <= 0.F)
+    isotope_halflife = proj_data.get_exam_info().get_radionuclide().get_half_life();
 
-  {
-    /* Randoms from singles formula is
-
-       randoms-rate[t,i,j] = coinc_window * singles-rate[t,i] * singles-rate[t,j]
-
-       However, we actually have total counts in the singles for sinograms.
-       and need total counts in the randoms.
-       Assuming there is just decay going on, then we have
-
-       randoms-rate[t,i,j] = coinc_window * singles-rate[0,i] * singles-rate[0,j] exp (-2lambda t)
-
-       randoms-counts[i,j] = int_t1^t2 randoms-rate[t,i,j]
-                 = coinc_window * singles-rate[0,i] * singles-rate[0,j] * int_t1^t2 exp (-2lambda t)
-                 = coinc_window * singles-counts[i] * singles-counts[j] *
-                   int_t1^t2 exp (-2lambda t) / (int_t1^t2 exp (-lambda t))^2
-       where int indicates an integral.
-
-       Now we can use that decay_correction_factor(lambda,t1,t2) computes
-          duration/(int_t1^t2 exp (-lambda t))
-
-       That leads to the formula below (as it turns out that the above ratio only depends t2-t1)
-    */
-    const double duration = frame_defs.get_duration(1);
-    const double decay_corr_factor = decay_correction_factor(isotope_halflife, 0., duration);
-    const double double_decay_corr_factor = decay_correction_factor(0.5 * isotope_halflife, 0., duration);
-    const double corr_factor = square(decay_corr_factor) / double_decay_corr_factor / duration;
-
-    info(format("Isotope half-life: {}\n"
-                "RFS: decay correction factor: {},\n"
-                "time frame duration: {}.\n"
-                "total correction factor from 2tau*(singles_totals)^2 to randoms_totals: {}.\n",
-                isotope_halflife,
-                decay_corr_factor,
-                duration,
-                (1 / corr_factor)),
-         2);
-
-    multiply_crystal_factors(proj_data, total_singles, static_cast<float>(coincidence_time_window * corr_factor));
-  }
+  std::vector<shared_ptr<ProjData>> proj_data_sptrs(num_frames);
+  std::vector<Array<2, float>> total_singles(num_frames);
+  std::vector<float> global_factors(num_frames);
+  for (unsigned int frame_num = 1; frame_num <= num_frames; ++frame_num)
+    {
+      proj_data_sptrs[frame_num - 1] = proj_data.get_proj_data_sptr(frame_num);
+      global_factors[frame_num - 1] = get_total_singles_and_factor_for_frame(total_singles[frame_num - 1],
+                                                                             singles,
+                                                                             scanner,
+                                                                             frame_defs.get_start_time(frame_num),
+                                                                             frame_defs.get_end_time(frame_num),
+                                                                             coincidence_time_window,
+                                                                             isotope_halflife);
+    }
+  multiply_crystal_factors(proj_data_sptrs, total_singles, global_factors);
 }
 
 END_NAMESPACE_STIR
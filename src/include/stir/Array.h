@@ -158,6 +158,9 @@ public:
 #endif
 
   //! Copy constructor
+  /*! The copy will be allocated as a single block, i.e. is_contiguous() will return \c true,
+      even if \a t is not contiguous.
+  */
   // implementation needed as the above doesn't disable the auto-generated copy-constructor
   inline Array(const self& t);
 
@@ -113,10 +113,15 @@ Array<num_dimensions, elemT>::Array(const IndexRange<num_dimensions>& range, sha
 
 template <int num_dimensions, typename elemT>
 Array<num_dimensions, elemT>::Array(const self& t)
-    : base_type(t),
+    : base_type(),
       _allocated_full_data_ptr(nullptr)
 {
   // info("constructor " + std::to_string(num_dimensions) + "copy of size " + std::to_string(this->size_all()));
+  // allocate a single block (such that the copy is contiguous), but avoid initialising the elements
+  const IndexRange<num_dimensions> range = t.get_index_range();
+  this->_allocated_full_data_ptr = shared_ptr<elemT[]>(new elemT[range.size_all()]);
+  this->init(range, this->_allocated_full_data_ptr.get(), false);
+  std::copy(t.begin_all_const(), t.end_all_const(), this->begin_all());
 }
 
 #ifndef SWIG
@@ -15,15 +15,9 @@
 */
 
 #include "stir/ProjData.h"
-
-#include <boost/random/mersenne_twister.hpp>
-#include <boost/random/variate_generator.hpp>
-#include <algorithm>
-#include <functional>
-// boost::serialization::make_array was moved in boost 1.64
-#if BOOST_VERSION == 106400
-#  include <boost/serialization/array_wrapper.hpp>
-#endif
+#include "stir/Array.h"
+#include "stir/numerics/Philox4x32.h"
+#include <cstdint>
 
 START_NAMESPACE_STIR
 
@@ -39,15 +33,18 @@ START_NAMESPACE_STIR
   be equal to <tt>scaling_factor*mean_of_input</tt>, otherwise it
   will be equal to mean_of_input, but then the output is no longer Poisson
   distributed.
+
+  The random numbers are generated with a counter-based generator (see CounterBasedRandomNumbers).
+  Every generated number is counted, and its value is a pure function of the seed and its
+  number. The projection data version processes sinograms in parallel (if OpenMP is enabled),
+  but its result does not depend on the number of threads. Each call to
+  generate_random() continues counting, such that subsequent calls give independent
+  noise realisations. Calling seed() starts counting from 0 again.
 */
 class GeneralisedPoissonNoiseGenerator
 {
-  // try boost::mt19937 or boost::ecuyer1988 instead of boost::minstd_rand
-  typedef boost::mt19937 base_generator_type;
-  typedef base_generator_type::result_type poisson_result_type;
-
 public:
-  //! Constructor intialises the andom number generator with a fixed seed
+  //! Constructor intialises the random number generator with a fixed seed
   GeneralisedPoissonNoiseGenerator(const float scaling_factor = 1.0F, const bool preserve_mean = false);
 
   //! The seed value for the random number generator
@@ -59,21 +56,26 @@ public:
   template <int num_dimensions, class elemTout, class elemTin>
   void generate_random(Array<num_dimensions, elemTout>& array_out, const Array<num_dimensions, elemTin>& array_in)
   {
-    std::transform(array_in.begin_all(),
-                   array_in.end_all(),
-                   array_out.begin_all(),
-                   std::bind(generate_scaled_poisson_random, std::placeholders::_1, this->scaling_factor, this->preserve_mean));
+    auto out_iter = array_out.begin_all();
+    for (auto in_iter = array_in.begin_all(); in_iter != array_in.end_all(); ++in_iter, ++out_iter)
+      *out_iter = static_cast<elemTout>(generate_scaled_poisson_random(static_cast<float>(*in_iter), this->num_generated++));
   }
 
+  //! generate a noise realisation for all projection data
+  /*! The numbering of the bins follows the order of the TOF bins, segments and
+      SegmentBySinogram.
+  */
   void generate_random(ProjData& output_projdata, const ProjData& input_projdata);
 
 private:
-  static base_generator_type generator;
+  std::uint64_t seed_value;
+  //! number of random numbers generated since the last call to seed()
+  std::uint64_t num_generated;
   const float scaling_factor;
   const bool preserve_mean;
 
-  static unsigned int generate_poisson_random(const float mu);
-  static float generate_scaled_poisson_random(const float mu, const float scaling_factor, const bool preserve_mean);
+  static unsigned int generate_poisson_random(const float mu, CounterBasedRandomNumbers& random_numbers);
+  float generate_scaled_poisson_random(const float mu, const std::uint64_t bin_index) const;
 };
 
 END_NAMESPACE_STIR
@@ -27,6 +27,7 @@
 #include "stir/listmode/CListRecordROOT.h"
 #include "stir/RegisteredObject.h"
 #include "stir/error.h"
+#include <cstdint>
 
 // forward declaration of ROOT's TChain
 class TChain;
@@ -99,6 +100,12 @@ public:
   inline std::vector<unsigned long int> get_saved_get_positions() const;
   //! Set a vector with saved positions
   inline void set_saved_get_positions(const std::vector<unsigned long int>&);
+  //! Get the number of the next entry that will be read
+  /*! In contrast to save_get_position(), the result can be written to file and
+      used when reopening the same data. Returns Succeeded::no at the end of the data. */
+  inline Succeeded get_current_offset(std::uint64_t& entry_num) const;
+  //! Set the number of the next entry that will be read
+  inline Succeeded set_current_offset(const std::uint64_t entry_num);
   //! Returns the total number of events
   inline unsigned long int get_total_number_of_events() const;
 
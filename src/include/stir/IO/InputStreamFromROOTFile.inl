@@ -66,6 +66,24 @@ InputStreamFromROOTFile::set_saved_get_positions(const std::vector<unsigned long
   saved_get_positions = poss;
 }
 
+Succeeded
+InputStreamFromROOTFile::get_current_offset(std::uint64_t& entry_num) const
+{
+  if (current_position >= nentries)
+    return Succeeded::no;
+  entry_num = current_position;
+  return Succeeded::yes;
+}
+
+Succeeded
+InputStreamFromROOTFile::set_current_offset(const std::uint64_t entry_num)
+{
+  if (entry_num > nentries)
+    return Succeeded::no;
+  current_position = static_cast<unsigned long int>(entry_num);
+  return Succeeded::yes;
+}
+
 float
 InputStreamFromROOTFile::get_low_energy_thres() const
 {
@@ -26,6 +26,7 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <cstdint>
 
 START_NAMESPACE_STIR
 
@@ -108,6 +109,16 @@ public:
   */
   inline void set_saved_get_positions(const std::vector<std::streampos>&);
 
+  //! get the current "get" position as an offset (in bytes) w.r.t. the start of the data
+  /*! In contrast to save_get_position(), the result does not depend on any internal state
+      and can therefore be written to file and used when reopening the same data.
+      \return Succeeded::no at the end of the data, or if the position could not be determined.
+      \see set_current_offset
+  */
+  inline Succeeded get_current_offset(std::uint64_t& offset);
+  //! set current "get" position to an offset found by get_current_offset()
+  inline Succeeded set_current_offset(const std::uint64_t offset);
+
   inline std::istream& get_stream() { return *this->stream_ptr; }
 
 private:
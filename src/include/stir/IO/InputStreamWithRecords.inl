@@ -181,4 +181,32 @@ InputStreamWithRecords<RecordT, OptionsT>::set_saved_get_positions(const std::ve
   saved_get_positions = poss;
 }
 
+template <class RecordT, class OptionsT>
+Succeeded
+InputStreamWithRecords<RecordT, OptionsT>::get_current_offset(std::uint64_t& offset)
+{
+  if (is_null_ptr(stream_ptr) || stream_ptr->eof())
+    return Succeeded::no;
+  const std::streampos pos = stream_ptr->tellg();
+  if (!stream_ptr->good() || pos < starting_stream_position)
+    return Succeeded::no;
+  offset = static_cast<std::uint64_t>(pos - starting_stream_position);
+  return Succeeded::yes;
+}
+
+template <class RecordT, class OptionsT>
+Succeeded
+InputStreamWithRecords<RecordT, OptionsT>::set_current_offset(const std::uint64_t offset)
+{
+  if (is_null_ptr(stream_ptr))
+    return Succeeded::no;
+
+  stream_ptr->clear();
+  stream_ptr->seekg(starting_stream_position + static_cast<std::streamoff>(offset));
+  if (!stream_ptr->good())
+    return Succeeded::no;
+  else
+    return Succeeded::yes;
+}
+
 END_NAMESPACE_STIR
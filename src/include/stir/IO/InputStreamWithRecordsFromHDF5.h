@@ -34,6 +34,11 @@
 #include <string>
 #include <iostream>
 #include <vector>
+#include <deque>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 START_NAMESPACE_STIR
 
@@ -68,6 +73,14 @@ namespace RDF_HDF5
                          const OptionsT options);
     \endcode
 
+    \par Buffering
+    Data are read from the HDF5 file in blocks of \c buffer_size bytes. When
+    more than 1 buffer is used (the default), a background thread reads the
+    next blocks while records in the current block are decoded, such that
+    decoding normally does not have to wait for the file. After a change of
+    position (e.g. set_get_position()), reading starts immediately at the new
+    position.
+
     \todo Allow choosing between allocation with \c new or on the stack.
 */
 template <class RecordT>
@@ -83,11 +96,20 @@ public:
   //                           const std::size_t size_of_record_signature,
   //                           const std::size_t max_size_of_record);
 
+  //! Constructor taking a filename
+  /*! \a buffer_size is the size (in bytes) of every buffer. If \a num_buffers is 1,
+      all reading is done in get_next_record(). Otherwise, the data are read ahead by
+      a background thread.
+  */
   explicit InputStreamWithRecordsFromHDF5(const std::string& filename,
                                           const std::size_t size_of_record_signature,
-                                          const std::size_t max_size_of_record);
+                                          const std::size_t max_size_of_record,
+                                          const std::size_t buffer_size = 10000000,
+                                          const int num_buffers = 2);
 
-  virtual ~InputStreamWithRecordsFromHDF5() {}
+  //! Destructor
+  /*! Closes the file in the \c LISTMODEIO OpenMP critical section, so it cannot be called from within that section. */
+  virtual ~InputStreamWithRecordsFromHDF5();
 
   inline virtual Succeeded get_next_record(RecordT& record);
 
@@ -119,6 +141,15 @@ public:
   */
   inline void set_saved_get_positions(const std::vector<std::streampos>&);
 
+  //! get the current "get" position as an offset (in bytes) in the list data
+  /*! In contrast to save_get_position(), the result can be written to file and
+      used when reopening the same data.
+      \return Succeeded::no at the end of the data.
+  */
+  inline Succeeded get_current_offset(std::uint64_t& offset);
+  //! set current "get" position to an offset found by get_current_offset()
+  inline Succeeded set_current_offset(const std::uint64_t offset);
+
 private:
   shared_ptr<GEHDF5Wrapper> input_sptr;
 
@@ -138,12 +169,63 @@ private:
   void read_data(char* output, const std::streampos offset, const hsize_t size) const;
   // members for buffering
 
-  boost::shared_array<char> buffer;
   std::size_t max_buffer_size;
+  //! if larger than 1, a background thread is used to read ahead
+  int num_buffers;
+
+  // members used when num_buffers==1
+  boost::shared_array<char> buffer;
   //! currently filled size
   mutable std::size_t buffer_size;
   mutable std::streampos start_of_buffer_offset;
   void fill_buffer(const std::streampos offset) const;
+
+  // members used when num_buffers>1
+  enum class BufferState
+  {
+    unused,
+    requested,
+    reading,
+    filled,
+    failed
+  };
+  struct AsyncBuffer
+  {
+    boost::shared_array<char> data;
+    std::streampos start;
+    std::size_t size;
+    BufferState state;
+  };
+  //! All buffers
+  /*! The background thread only modifies a buffer when it is in the \c requested or \c reading state.
+      All other changes are made by the thread calling get_next_record() etc.
+      Access to \c state and to the request queue is protected by \c buffers_mutex.
+  */
+  mutable std::vector<AsyncBuffer> async_buffers;
+  //! indices in async_buffers of buffers that need to be read (in order)
+  mutable std::deque<int> request_queue;
+  //! index in async_buffers of the buffer last used by read_data() (or -1)
+  mutable int current_buffer_num;
+  mutable std::mutex buffers_mutex;
+  mutable std::condition_variable buffers_cond;
+  bool stop_reading;
+  std::thread reader_thread;
+
+  void start_reader_thread();
+  void stop_reader_thread();
+  //! function executed by the background thread
+  void read_requested_buffers();
+  //! read data using async_buffers
+  void read_data_from_async_buffers(char* output, const std::streampos offset, const hsize_t size) const;
+  //! find the buffer containing \a offset (or -1). Needs to be called with a lock on buffers_mutex.
+  int find_async_buffer(const std::streampos offset) const;
+  //! make sure that the data at \a offset will be read. Needs to be called with a lock on buffers_mutex.
+  /*! \return the index of the buffer that will contain the data */
+  int request_async_buffer(const std::streampos offset) const;
+  //! request the blocks following the current buffer. Needs to be called with a lock on buffers_mutex.
+  void request_read_ahead() const;
+  //! start reading at \a offset, used when the position is changed
+  void prefetch(const std::streampos offset);
 };
 
 } // namespace RDF_HDF5
@@ -26,7 +26,9 @@
 #include "stir/Succeeded.h"
 #include "stir/is_null_ptr.h"
 #include "stir/shared_ptr.h"
+#include "stir/error.h"
 
+#include <algorithm>
 #include <fstream>
 #include <string.h>
 START_NAMESPACE_STIR
@@ -57,23 +59,50 @@ namespace RDF_HDF5
 template <class RecordT>
 InputStreamWithRecordsFromHDF5<RecordT>::InputStreamWithRecordsFromHDF5(const std::string& filename,
                                                                         const std::size_t size_of_record_signature,
-                                                                        const std::size_t max_size_of_record)
+                                                                        const std::size_t max_size_of_record,
+                                                                        const std::size_t buffer_size,
+                                                                        const int num_buffers)
     : m_filename(filename),
       size_of_record_signature(size_of_record_signature),
-      max_size_of_record(max_size_of_record)
+      max_size_of_record(max_size_of_record),
+      max_buffer_size(buffer_size),
+      num_buffers(num_buffers),
+      current_buffer_num(-1),
+      stop_reading(false)
 {
   assert(size_of_record_signature <= max_size_of_record);
+  if (this->max_buffer_size < this->max_size_of_record)
+    error("InputStreamWithRecordsFromHDF5: buffer size needs to be at least the maximum size of a record");
 
-  this->max_buffer_size = 10000000;
-  this->buffer.reset(new char[this->max_buffer_size]);
+  if (this->num_buffers <= 1)
+    this->buffer.reset(new char[this->max_buffer_size]);
+  else
+    {
+      this->async_buffers.resize(this->num_buffers);
+      for (auto& b : this->async_buffers)
+        b.data.reset(new char[this->max_buffer_size]);
+    }
 
   set_up();
 }
 
+template <class RecordT>
+InputStreamWithRecordsFromHDF5<RecordT>::~InputStreamWithRecordsFromHDF5()
+{
+  stop_reader_thread();
+  // closing the file calls HDF5 as well, see read_requested_buffers()
+#ifdef STIR_OPENMP
+#  pragma omp critical(LISTMODEIO)
+#endif
+  input_sptr.reset();
+}
+
 template <class RecordT>
 Succeeded
 InputStreamWithRecordsFromHDF5<RecordT>::set_up()
 {
+  stop_reader_thread();
+
   input_sptr.reset(new GEHDF5Wrapper(m_filename));
   data_sptr.reset(new char[this->max_size_of_record]);
   starting_stream_position = 0;
@@ -83,14 +112,235 @@ InputStreamWithRecordsFromHDF5<RecordT>::set_up()
   m_list_size = input_sptr->get_dataset_size() - this->size_of_record_signature;
 
   this->buffer_size = 0;
+
+  start_reader_thread();
   return Succeeded::yes;
 }
 
+template <class RecordT>
+void
+InputStreamWithRecordsFromHDF5<RecordT>::start_reader_thread()
+{
+  if (this->num_buffers <= 1)
+    return;
+  for (auto& b : this->async_buffers)
+    b.state = BufferState::unused;
+  this->request_queue.clear();
+  this->current_buffer_num = -1;
+  this->stop_reading = false;
+  this->reader_thread = std::thread(&InputStreamWithRecordsFromHDF5<RecordT>::read_requested_buffers, this);
+  // start reading the beginning of the data
+  this->prefetch(this->current_offset);
+}
+
+template <class RecordT>
+void
+InputStreamWithRecordsFromHDF5<RecordT>::stop_reader_thread()
+{
+  if (!this->reader_thread.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(this->buffers_mutex);
+    this->stop_reading = true;
+  }
+  this->buffers_cond.notify_all();
+  this->reader_thread.join();
+}
+
+template <class RecordT>
+void
+InputStreamWithRecordsFromHDF5<RecordT>::read_requested_buffers()
+{
+  std::unique_lock<std::mutex> lock(this->buffers_mutex);
+  while (true)
+    {
+      this->buffers_cond.wait(lock, [this]() { return this->stop_reading || !this->request_queue.empty(); });
+      if (this->stop_reading)
+        return;
+      AsyncBuffer& b = this->async_buffers[this->request_queue.front()];
+      this->request_queue.pop_front();
+      // a buffer can be in the queue more than once
+      if (b.state != BufferState::requested)
+        continue;
+      b.state = BufferState::reading;
+      lock.unlock();
+
+      bool read_ok = true;
+      // HDF5 is not necessarily thread-safe, while multiple objects might read from the same file
+#ifdef STIR_OPENMP
+#  pragma omp critical(LISTMODEIO)
+#endif
+      {
+        try
+          {
+            input_sptr->read_list_data(b.data.get(), b.start, hsize_t(b.size));
+          }
+        catch (...)
+          {
+            read_ok = false;
+          }
+      }
+
+      lock.lock();
+      b.state = read_ok ? BufferState::filled : BufferState::failed;
+      this->buffers_cond.notify_all();
+    }
+}
+
+template <class RecordT>
+int
+InputStreamWithRecordsFromHDF5<RecordT>::find_async_buffer(const std::streampos offset) const
+{
+  for (int buffer_num = 0; buffer_num < this->num_buffers; ++buffer_num)
+    {
+      const AsyncBuffer& b = this->async_buffers[buffer_num];
+      if (b.state != BufferState::unused && offset >= b.start && offset < b.start + static_cast<std::streamoff>(b.size))
+        return buffer_num;
+    }
+  return -1;
+}
+
+template <class RecordT>
+int
+InputStreamWithRecordsFromHDF5<RecordT>::request_async_buffer(const std::streampos offset) const
+{
+  const int found_buffer_num = this->find_async_buffer(offset);
+  if (found_buffer_num >= 0 && this->async_buffers[found_buffer_num].state != BufferState::failed)
+    return found_buffer_num;
+
+  // find a buffer that we can reuse, preferably not the current one.
+  // Note that at most one buffer is being read by the background thread.
+  int buffer_num = -1;
+  for (int i = 0; i < this->num_buffers; ++i)
+    {
+      if (this->async_buffers[i].state == BufferState::reading)
+        continue;
+      buffer_num = i;
+      if (i != this->current_buffer_num)
+        break;
+    }
+  assert(buffer_num >= 0);
+  if (buffer_num == this->current_buffer_num)
+    this->current_buffer_num = -1;
+  AsyncBuffer& b = this->async_buffers[buffer_num];
+  b.start = offset;
+  b.size = static_cast<std::size_t>(std::min(static_cast<uint64_t>(this->max_buffer_size), m_list_size - offset));
+  b.state = BufferState::requested;
+  // this data is needed first
+  this->request_queue.push_front(buffer_num);
+  this->buffers_cond.notify_all();
+  return buffer_num;
+}
+
+template <class RecordT>
+void
+InputStreamWithRecordsFromHDF5<RecordT>::request_read_ahead() const
+{
+  assert(this->current_buffer_num >= 0);
+  const AsyncBuffer& current_buffer = this->async_buffers[this->current_buffer_num];
+  std::vector<bool> keep(this->num_buffers, false);
+  keep[this->current_buffer_num] = true;
+
+  // find start of the blocks following the current one
+  std::vector<std::streampos> starts;
+  std::streampos start = current_buffer.start + static_cast<std::streamoff>(current_buffer.size);
+  for (int i = 1; i < this->num_buffers && start < static_cast<std::streampos>(m_list_size); ++i)
+    {
+      starts.push_back(start);
+      start += static_cast<std::streamoff>(this->max_buffer_size);
+    }
+  // first keep the buffers that already have (or will have) these blocks
+  std::vector<bool> block_is_present(starts.size(), false);
+  for (int buffer_num = 0; buffer_num < this->num_buffers; ++buffer_num)
+    {
+      const AsyncBuffer& b = this->async_buffers[buffer_num];
+      if (buffer_num == this->current_buffer_num || b.state == BufferState::unused || b.state == BufferState::failed)
+        continue;
+      for (std::size_t block_num = 0; block_num < starts.size(); ++block_num)
+        if (b.start == starts[block_num])
+          {
+            block_is_present[block_num] = true;
+            keep[buffer_num] = true;
+          }
+    }
+  // now request the other blocks using buffers that are not needed anymore
+  for (std::size_t block_num = 0; block_num < starts.size(); ++block_num)
+    {
+      if (block_is_present[block_num])
+        continue;
+      int buffer_num = 0;
+      while (buffer_num < this->num_buffers
+             && (keep[buffer_num] || this->async_buffers[buffer_num].state == BufferState::reading))
+        ++buffer_num;
+      if (buffer_num == this->num_buffers)
+        break;
+      keep[buffer_num] = true;
+      AsyncBuffer& b = this->async_buffers[buffer_num];
+      b.start = starts[block_num];
+      b.size = static_cast<std::size_t>(
+          std::min(static_cast<uint64_t>(this->max_buffer_size), m_list_size - static_cast<uint64_t>(b.start)));
+      b.state = BufferState::requested;
+      this->request_queue.push_back(buffer_num);
+    }
+  this->buffers_cond.notify_all();
+}
+
+template <class RecordT>
+void
+InputStreamWithRecordsFromHDF5<RecordT>::prefetch(const std::streampos offset)
+{
+  if (this->num_buffers <= 1 || offset >= static_cast<std::streampos>(m_list_size))
+    return;
+  std::lock_guard<std::mutex> lock(this->buffers_mutex);
+  this->request_async_buffer(offset);
+}
+
+template <class RecordT>
+void
+InputStreamWithRecordsFromHDF5<RecordT>::read_data_from_async_buffers(char* output,
+                                                                      const std::streampos offset,
+                                                                      const hsize_t size) const
+{
+  // The current buffer is only modified by this thread, so we do not need to lock if the data are in there.
+  if (this->current_buffer_num < 0 || offset < this->async_buffers[this->current_buffer_num].start
+      || offset >= this->async_buffers[this->current_buffer_num].start
+                       + static_cast<std::streamoff>(this->async_buffers[this->current_buffer_num].size))
+    {
+      std::unique_lock<std::mutex> lock(this->buffers_mutex);
+      const int buffer_num = this->request_async_buffer(offset);
+      AsyncBuffer& b = this->async_buffers[buffer_num];
+      this->buffers_cond.wait(lock, [&b]() { return b.state == BufferState::filled || b.state == BufferState::failed; });
+      if (b.state == BufferState::failed)
+        {
+          b.state = BufferState::unused;
+          error("InputStreamWithRecordsFromHDF5: error reading list mode data");
+        }
+      this->current_buffer_num = buffer_num;
+      this->request_read_ahead();
+    }
+
+  // copy data from buffer to output
+  const AsyncBuffer& b = this->async_buffers[this->current_buffer_num];
+  const std::size_t offset_in_buffer = offset - b.start;
+  const hsize_t size_in_buffer = std::min(size, static_cast<hsize_t>(b.size - offset_in_buffer));
+
+  memcpy(output, b.data.get() + offset_in_buffer, static_cast<std::size_t>(size_in_buffer));
+
+  // check if there is anything else to read after the end of the buffer
+  if (size_in_buffer < size)
+    read_data_from_async_buffers(
+        output + size_in_buffer, offset + static_cast<std::streampos>(size_in_buffer), size - size_in_buffer);
+}
+
 template <class RecordT>
 void
 InputStreamWithRecordsFromHDF5<RecordT>::fill_buffer(const std::streampos offset) const
 {
   this->buffer_size = static_cast<std::size_t>(std::min(static_cast<uint64_t>(this->max_buffer_size), m_list_size - offset));
+  // HDF5 is not necessarily thread-safe, while multiple objects might read from the same file
+#ifdef STIR_OPENMP
+#  pragma omp critical(LISTMODEIO)
+#endif
   input_sptr->read_list_data(buffer.get(), offset, hsize_t(this->buffer_size));
   this->start_of_buffer_offset = offset;
 }
@@ -99,6 +349,12 @@ template <class RecordT>
 void
 InputStreamWithRecordsFromHDF5<RecordT>::read_data(char* output, const std::streampos offset, const hsize_t size) const
 {
+  if (this->num_buffers > 1)
+    {
+      read_data_from_async_buffers(output, offset, size);
+      return;
+    }
+
   if (this->buffer_size == 0 || offset < this->start_of_buffer_offset
       || offset >= (this->start_of_buffer_offset + static_cast<std::streampos>(this->buffer_size)))
     this->fill_buffer(offset);
@@ -150,6 +406,7 @@ InputStreamWithRecordsFromHDF5<RecordT>::reset()
     return Succeeded::no;
 
   current_offset = 0;
+  prefetch(current_offset);
   return Succeeded::yes;
 }
 
@@ -174,6 +431,7 @@ InputStreamWithRecordsFromHDF5<RecordT>::set_get_position(
 
   assert(pos < saved_get_positions.size());
   current_offset = saved_get_positions[pos];
+  prefetch(current_offset);
 
   return Succeeded::yes;
 }
@@ -192,6 +450,27 @@ InputStreamWithRecordsFromHDF5<RecordT>::set_saved_get_positions(const std::vect
   saved_get_positions = poss;
 }
 
+template <class RecordT>
+Succeeded
+InputStreamWithRecordsFromHDF5<RecordT>::get_current_offset(std::uint64_t& offset)
+{
+  if (is_null_ptr(input_sptr) || current_offset >= static_cast<std::streampos>(m_list_size))
+    return Succeeded::no;
+  offset = static_cast<std::uint64_t>(current_offset);
+  return Succeeded::yes;
+}
+
+template <class RecordT>
+Succeeded
+InputStreamWithRecordsFromHDF5<RecordT>::set_current_offset(const std::uint64_t offset)
+{
+  if (is_null_ptr(input_sptr) || offset > m_list_size)
+    return Succeeded::no;
+  current_offset = static_cast<std::streamoff>(offset);
+  prefetch(current_offset);
+  return Succeeded::yes;
+}
+
 } // namespace RDF_HDF5
 } // namespace GE
 END_NAMESPACE_STIR
@@ -72,6 +72,10 @@ public:
 
   std::string siemens_mi_version;
 
+  //! value of the \c data \c compression keyword (defaults to \c none)
+  /*! Currently only used for projection data, see ProjDataCompressed. */
+  std::string data_compression;
+
 protected:
   //! will be called when the version keyword is found
   /*! This callback function provides an opportunity to change the keymap depending on the version
@@ -0,0 +1,62 @@
+//
+//
+#ifndef __stir_IO_InterfileVoxelMajorDynamicDensityInputFileFormat_h__
+#define __stir_IO_InterfileVoxelMajorDynamicDensityInputFileFormat_h__
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup IO
+  \brief Declaration of class stir::InterfileVoxelMajorDynamicDensityInputFileFormat
+
+  \author STIR contributors
+
+*/
+#include "stir/IO/InputFileFormat.h"
+#include "stir/IO/interfile.h"
+#include "stir/VoxelMajorDynamicDensity.h"
+#include "stir/error.h"
+#include "stir/is_null_ptr.h"
+
+START_NAMESPACE_STIR
+
+//! Class for reading dynamic images in Interfile file-format into a VoxelMajorDynamicDensity
+/*! \ingroup IO
+  Uses the same file format as InterfileDynamicDiscretisedDensityInputFileFormat.
+*/
+class InterfileVoxelMajorDynamicDensityInputFileFormat : public InputFileFormat<VoxelMajorDynamicDensity>
+{
+public:
+  const std::string get_name() const override { return "Interfile"; }
+
+protected:
+  bool actual_can_read(const FileSignature& signature, std::istream&) const override
+  {
+    //. todo should check if it's an image
+    return is_interfile_signature(signature.get_signature());
+  }
+
+  unique_ptr<data_type> read_from_file(std::istream&) const override
+  {
+    // needs more arguments, so we just give up (TODO?)
+    error("failed to read an Interfile image from stream");
+    return unique_ptr<data_type>();
+  }
+  unique_ptr<data_type> read_from_file(const std::string& filename) const override
+  {
+    unique_ptr<data_type> ret(read_interfile_voxel_major_dynamic_image(filename));
+    if (is_null_ptr(ret))
+      {
+        error("failed to read an Interfile image from file \"" + filename + "\"");
+      }
+    return ret;
+  }
+};
+END_NAMESPACE_STIR
+
+#endif
@@ -0,0 +1,70 @@
+//
+//
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+
+  \file
+  \ingroup InterfileIO
+  \brief Declaration of class stir::InterfileVoxelMajorDynamicDensityOutputFileFormat
+
+  \author STIR contributors
+
+*/
+
+#ifndef __stir_IO_InterfileVoxelMajorDynamicDensityOutputFileFormat_H__
+#define __stir_IO_InterfileVoxelMajorDynamicDensityOutputFileFormat_H__
+
+#include "stir/IO/OutputFileFormat.h"
+#include "stir/RegisteredParsingObject.h"
+
+START_NAMESPACE_STIR
+
+class VoxelMajorDynamicDensity;
+
+/*!
+  \ingroup InterfileIO
+  \brief
+  Implementation of OutputFileFormat paradigm for the Interfile format.
+
+  The file format is the same as for InterfileDynamicDiscretisedDensityOutputFileFormat.
+  Time frames are written one at a time.
+ */
+
+class InterfileVoxelMajorDynamicDensityOutputFileFormat
+    : public RegisteredParsingObject<InterfileVoxelMajorDynamicDensityOutputFileFormat,
+                                     OutputFileFormat<VoxelMajorDynamicDensity>,
+                                     OutputFileFormat<VoxelMajorDynamicDensity>>
+{
+private:
+  typedef RegisteredParsingObject<InterfileVoxelMajorDynamicDensityOutputFileFormat,
+                                  OutputFileFormat<VoxelMajorDynamicDensity>,
+                                  OutputFileFormat<VoxelMajorDynamicDensity>>
+      base_type;
+
+public:
+  //! Name which will be used when parsing an OutputFileFormat object
+  static const char* const registered_name;
+
+  InterfileVoxelMajorDynamicDensityOutputFileFormat(const NumericType& = NumericType::FLOAT,
+                                                    const ByteOrder& = ByteOrder::native);
+
+  ByteOrder set_byte_order(const ByteOrder&, const bool warn = false) override;
+
+protected:
+  Succeeded actual_write_to_file(std::string& output_filename, const VoxelMajorDynamicDensity& density) const override;
+
+  void set_defaults() override;
+  void initialise_keymap() override;
+  bool post_processing() override;
+};
+
+END_NAMESPACE_STIR
+
+#endif
@@ -0,0 +1,95 @@
+//
+//
+#ifndef __stir_IO_MultiVoxelMajorDynamicDensityInputFileFormat_h__
+#define __stir_IO_MultiVoxelMajorDynamicDensityInputFileFormat_h__
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup IO
+  \brief Declaration of class stir::MultiVoxelMajorDynamicDensityInputFileFormat
+
+  \author STIR contributors
+
+*/
+#include "stir/IO/InputFileFormat.h"
+#include "stir/IO/read_from_file.h"
+#include "stir/interfile_keyword_functions.h"
+#include "stir/VoxelMajorDynamicDensity.h"
+#include "stir/MultipleDataSetHeader.h"
+#include "stir/DiscretisedDensity.h"
+#include "stir/error.h"
+#include "stir/format.h"
+
+START_NAMESPACE_STIR
+
+//! Class for reading dynamic images in Multi file-format into a VoxelMajorDynamicDensity
+/*! \ingroup IO
+  Uses the same file format as MultiDynamicDiscretisedDensityInputFileFormat. The individual time frames
+  are read one at a time.
+*/
+class MultiVoxelMajorDynamicDensityInputFileFormat : public InputFileFormat<VoxelMajorDynamicDensity>
+{
+public:
+  const std::string get_name() const override { return "Multi"; }
+
+protected:
+  bool actual_can_read(const FileSignature& signature, std::istream&) const override
+  {
+    // checking for "multi :"
+    const char* pos_of_colon = strchr(signature.get_signature(), ':');
+    if (pos_of_colon == NULL)
+      return false;
+    std::string keyword(signature.get_signature(), pos_of_colon - signature.get_signature());
+    return (standardise_interfile_keyword(keyword) == standardise_interfile_keyword("multi"));
+  }
+
+  unique_ptr<data_type> read_from_file(std::istream&) const override
+  {
+    error("failed to read a Multi image from stream");
+    return unique_ptr<data_type>();
+  }
+  unique_ptr<data_type> read_from_file(const std::string& filename) const override
+  {
+    MultipleDataSetHeader header;
+    if (header.parse(filename.c_str()) == false)
+      error("MultiVoxelMajorDynamicDensity:::read_from_file: Error parsing \"" + filename + '\"');
+    const unsigned int num_frames = static_cast<unsigned int>(header.get_num_data_sets());
+    if (num_frames == 0)
+      error("MultiVoxelMajorDynamicDensity:::read_from_file: no images found in \"" + filename + '\"');
+    unique_ptr<data_type> dyn_image_uptr;
+    TimeFrameDefinitions time_frame_definitions;
+    time_frame_definitions.set_num_time_frames(num_frames);
+    for (unsigned int frame_num = 1; frame_num <= num_frames; ++frame_num)
+      {
+        auto t = stir::read_from_file<DiscretisedDensity<3, float>>(header.get_filename(frame_num - 1));
+        const TimeFrameDefinitions& frame_defs = t->get_exam_info().get_time_frame_definitions();
+        if (frame_defs.get_num_frames() != 1)
+          error(format("The individual components of a dynamic image should contain 1 time frame, but image {} contains {}.",
+                       frame_num,
+                       frame_defs.get_num_frames()));
+        time_frame_definitions.set_time_frame(frame_num, frame_defs.get_start_time(1), frame_defs.get_end_time(1));
+        if (frame_num == 1)
+          {
+            const VoxelsOnCartesianGrid<float>* frame_ptr = dynamic_cast<const VoxelsOnCartesianGrid<float>*>(t.get());
+            if (frame_ptr == 0)
+              error("MultiVoxelMajorDynamicDensity:::read_from_file: only VoxelsOnCartesianGrid images are supported");
+            shared_ptr<ExamInfo> exam_info_sptr(t->get_exam_info().create_shared_clone());
+            exam_info_sptr->set_time_frame_definitions(time_frame_definitions);
+            shared_ptr<Scanner> scanner_sptr(Scanner::get_scanner_from_name(exam_info_sptr->originating_system));
+            dyn_image_uptr.reset(new VoxelMajorDynamicDensity(exam_info_sptr, *frame_ptr, scanner_sptr));
+          }
+        dyn_image_uptr->set_density(*t, frame_num);
+      }
+    dyn_image_uptr->set_time_frame_definitions(time_frame_definitions);
+    return dyn_image_uptr;
+  }
+};
+END_NAMESPACE_STIR
+
+#endif
@@ -0,0 +1,73 @@
+//
+//
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+
+  \file
+  \ingroup MultiIO
+  \brief Declaration of class stir::MultiVoxelMajorDynamicDensityOutputFileFormat
+
+  \author STIR contributors
+
+*/
+
+#ifndef __stir_IO_MultiVoxelMajorDynamicDensityOutputFileFormat_H__
+#define __stir_IO_MultiVoxelMajorDynamicDensityOutputFileFormat_H__
+
+#include "stir/IO/OutputFileFormat.h"
+#include "stir/RegisteredParsingObject.h"
+#include "stir/DiscretisedDensity.h"
+
+START_NAMESPACE_STIR
+
+class VoxelMajorDynamicDensity;
+
+/*!
+  \ingroup MultiIO
+  \brief
+  Implementation of OutputFileFormat paradigm for the Multi format.
+
+  The file format is the same as for MultiDynamicDiscretisedDensityOutputFileFormat.
+  Time frames are written one at a time.
+ */
+
+class MultiVoxelMajorDynamicDensityOutputFileFormat
+    : public RegisteredParsingObject<MultiVoxelMajorDynamicDensityOutputFileFormat,
+                                     OutputFileFormat<VoxelMajorDynamicDensity>,
+                                     OutputFileFormat<VoxelMajorDynamicDensity>>
+{
+private:
+  typedef RegisteredParsingObject<MultiVoxelMajorDynamicDensityOutputFileFormat,
+                                  OutputFileFormat<VoxelMajorDynamicDensity>,
+                                  OutputFileFormat<VoxelMajorDynamicDensity>>
+      base_type;
+
+public:
+  //! Name which will be used when parsing an OutputFileFormat object
+  static const char* const registered_name;
+
+  MultiVoxelMajorDynamicDensityOutputFileFormat(const NumericType& = NumericType::FLOAT, const ByteOrder& = ByteOrder::native);
+
+  ByteOrder set_byte_order(const ByteOrder&, const bool warn = false) override;
+
+protected:
+  Succeeded actual_write_to_file(std::string& output_filename, const VoxelMajorDynamicDensity& density) const override;
+
+  void set_defaults() override;
+  void initialise_keymap() override;
+  bool post_processing() override;
+
+  /// Output type for the individual images
+  shared_ptr<OutputFileFormat<DiscretisedDensity<3, float>>> individual_output_type_sptr;
+};
+
+END_NAMESPACE_STIR
+
+#endif
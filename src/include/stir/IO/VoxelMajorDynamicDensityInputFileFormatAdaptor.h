@@ -0,0 +1,67 @@
+//
+//
+#ifndef __stir_IO_VoxelMajorDynamicDensityInputFileFormatAdaptor_h__
+#define __stir_IO_VoxelMajorDynamicDensityInputFileFormatAdaptor_h__
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup IO
+  \brief Declaration of class stir::VoxelMajorDynamicDensityInputFileFormatAdaptor
+
+  \author STIR contributors
+
+*/
+#include "stir/IO/InputFileFormat.h"
+#include "stir/VoxelMajorDynamicDensity.h"
+#include "stir/DynamicDiscretisedDensity.h"
+
+START_NAMESPACE_STIR
+
+//! Class for reading a VoxelMajorDynamicDensity with an InputFileFormat for DynamicDiscretisedDensity
+/*! \ingroup IO
+  This can be used for file formats that do not have a specific implementation for VoxelMajorDynamicDensity.
+  The file is read as a DynamicDiscretisedDensity, which is then converted. Therefore, this needs more memory
+  than a dedicated implementation.
+
+  \tparam DynamicFormatT an InputFileFormat<DynamicDiscretisedDensity>
+*/
+template <class DynamicFormatT>
+class VoxelMajorDynamicDensityInputFileFormatAdaptor : public InputFileFormat<VoxelMajorDynamicDensity>
+{
+public:
+  const std::string get_name() const override { return dynamic_format().get_name(); }
+
+protected:
+  bool actual_can_read(const FileSignature& signature, std::istream& input) const override
+  {
+    return dynamic_format().can_read(signature, input);
+  }
+
+  unique_ptr<data_type> read_from_file(std::istream& input) const override
+  {
+    return convert(dynamic_format().read_from_file(input));
+  }
+  unique_ptr<data_type> read_from_file(const std::string& filename) const override
+  {
+    return convert(dynamic_format().read_from_file(filename));
+  }
+
+private:
+  DynamicFormatT _dynamic_format;
+
+  const InputFileFormat<DynamicDiscretisedDensity>& dynamic_format() const { return _dynamic_format; }
+
+  static unique_ptr<data_type> convert(const unique_ptr<DynamicDiscretisedDensity>& dyn_image_uptr)
+  {
+    return unique_ptr<data_type>(new VoxelMajorDynamicDensity(*dyn_image_uptr));
+  }
+};
+END_NAMESPACE_STIR
+
+#endif
@@ -50,7 +50,9 @@ class Coordinate3D;
 template <typename elemT>
 class VoxelsOnCartesianGrid;
 class ProjDataFromStream;
+class ProjDataInMemory;
 class DynamicDiscretisedDensity;
+class VoxelMajorDynamicDensity;
 template <typename elemT>
 class ParametricDiscretisedDensity;
 template <typename elemT>
@@ -84,6 +86,9 @@ bool is_interfile_signature(const char* const signature);
  If the name for the data file is not an absolute pathname,
  \a directory_for_data is prepended (if not NULL).
 
+  If get_memory_map_input_files() returns \c true and the data are stored as floats in native
+  byte order (and without scale factors), the data file is mapped in memory instead of read.
+
   \warning it is up to the caller to deallocate the image
 
   This should normally never be used. Use read_from_file<DiscretisedDensity<3,float> >() instead.
@@ -108,6 +113,12 @@ DynamicDiscretisedDensity* read_interfile_dynamic_image(std::istream& input, con
 /// Read dynamic image
 DynamicDiscretisedDensity* read_interfile_dynamic_image(const std::string& filename);
 
+/// Read dynamic image into a VoxelMajorDynamicDensity, one time frame at a time
+VoxelMajorDynamicDensity* read_interfile_voxel_major_dynamic_image(std::istream& input, const std::string& directory_for_data);
+
+/// Read dynamic image into a VoxelMajorDynamicDensity, one time frame at a time
+VoxelMajorDynamicDensity* read_interfile_voxel_major_dynamic_image(const std::string& filename);
+
 /// Read parametric image
 ParametricDiscretisedDensity<VoxelsOnCartesianGrid<KineticParameters<2, float>>>*
 read_interfile_parametric_image(std::istream& input, const std::string& directory_for_data);
@@ -246,6 +257,13 @@ Succeeded write_basic_interfile(const std::string& filename,
                                 const float scale = 0,
                                 const ByteOrder byte_order = ByteOrder::native);
 
+//! Writes a VoxelMajorDynamicDensity in the same format as a DynamicDiscretisedDensity, one time frame at a time
+Succeeded write_basic_interfile(const std::string& filename,
+                                const VoxelMajorDynamicDensity& image,
+                                const NumericType output_type = NumericType::FLOAT,
+                                const float scale = 0,
+                                const ByteOrder byte_order = ByteOrder::native);
+
 //! This reads the first 3D sinogram from an Interfile header, given as a stream
 /*!
   \ingroup InterfileIO
@@ -277,15 +295,33 @@ ProjDataFromStream* read_interfile_PDFS(std::istream& input,
 */
 ProjDataFromStream* read_interfile_PDFS(const std::string& filename, const std::ios::openmode open_mode);
 
+//! This reads PET projection data from an Interfile header by mapping the data file in memory
+/*!
+  \ingroup InterfileIO
+  This only works if the data are stored in the same way as in ProjDataInMemory, i.e.
+  as floats in native byte order, without scale factor, in the standard segment sequence and
+  with storage order Segment_AxialPos_View_TangPos. A null pointer is returned otherwise (or if
+  memory mapping is not supported, see memory_map_file()).
+
+  Normally, ProjDataInMemory::read_from_file() should be used instead.
+
+  \warning it is up to the caller to deallocate the object
+*/
+ProjDataInMemory* read_interfile_PDFS_memory_mapped(const std::string& filename);
+
 //! This writes an Interfile header appropriate for the ProjDataFromStream object.
 /*!
   \ingroup InterfileIO
   A .hs extension will be added to the header_file_name if none is present.
+
+  If \a data_compression is not \c none, it is written as value of the \c data \c compression
+  keyword. This is used by ProjDataCompressed.
  \return Succeeded::yes when succesful, Succeeded::no otherwise.
 */
 Succeeded write_basic_interfile_PDFS_header(const std::string& header_filename,
                                             const std::string& data_filename,
-                                            const ProjDataFromStream& pdfs);
+                                            const ProjDataFromStream& pdfs,
+                                            const std::string& data_compression = "none");
 
 //! This function writes an Interfile header for the pdfs object.
 /*!
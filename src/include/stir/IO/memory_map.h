@@ -0,0 +1,59 @@
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup IO
+  \brief Declaration of functions for mapping files in memory
+
+  \author STIR contributors
+*/
+
+#ifndef __stir_IO_memory_map_H__
+#define __stir_IO_memory_map_H__
+
+#include "stir/shared_ptr.h"
+#include <string>
+#include <ios>
+#include <cstddef>
+
+START_NAMESPACE_STIR
+
+//! Check if input files should be mapped in memory (where supported)
+/*! \ingroup IO
+  If this returns \c true, some functions reading data into memory map the data file
+  instead (see read_interfile_image() and ProjDataInMemory::read_from_file()).
+  This makes reading almost instantaneous, and memory is only used for the parts of the
+  data that are actually accessed.
+
+  The default is \c false, unless the environment variable \c STIR_MEMORY_MAP_INPUT is set to 1.
+
+  \warning Input files should then not be modified or overwritten while the data are in use.
+  In particular, do not write output to a file that was read in this way.
+*/
+bool get_memory_map_input_files();
+
+//! Set if input files should be mapped in memory, see get_memory_map_input_files()
+/*! \ingroup IO */
+void set_memory_map_input_files(const bool);
+
+//! Map part of a file in memory
+/*! \ingroup IO
+  The data are read from disk when they are first accessed. The mapping is "copy-on-write",
+  i.e. the data can be modified, but this will not change the file.
+
+  The memory is unmapped when the last copy of the returned pointer is destroyed.
+
+  \return a pointer to the data at \a offset, or a null pointer if the file cannot be
+  opened, is too short, or if memory mapping is not supported on this system.
+*/
+shared_ptr<char[]> memory_map_file(const std::string& filename, const std::streamoff offset, const std::size_t num_bytes);
+
+END_NAMESPACE_STIR
+
+#endif
@@ -160,6 +160,13 @@ private:
   int num_detectors_per_ring;
 };
 
+/*!
+  \ingroup buildblock
+  \brief Projection data organised as "fans", i.e. indexed by 2 detectors \c (ra,a) and \c (rb,b)
+
+  Only half of the data is stored, as \c (ra,a,rb,b) is the same as \c (rb,b,ra,a).
+  The constructor allocates all data as a single contiguous block.
+*/
 class FanProjData : private Array<4, float>
 {
 public:
@@ -167,6 +174,8 @@ public:
   FanProjData(const int num_rings, const int num_detectors_per_ring, const int max_ring_diff, const int fan_size);
   ~FanProjData() override;
   FanProjData& operator=(const FanProjData&);
+  //! add other data, which has to have the same sizes
+  FanProjData& operator+=(const FanProjData&);
 
   float& operator()(const int ra, const int a, const int rb, const int b);
 
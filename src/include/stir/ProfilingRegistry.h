@@ -0,0 +1,211 @@
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+
+  \file
+  \ingroup buildblock
+
+  \brief Declaration of classes stir::ProfilingRegistry, stir::ProfilingScope and stir::ProfilingCounter
+
+  \author STIR contributors
+*/
+
+#ifndef __stir_ProfilingRegistry_h__
+#define __stir_ProfilingRegistry_h__
+
+#include "stir/Succeeded.h"
+#include <atomic>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+START_NAMESPACE_STIR
+
+namespace detail
+{
+class ThreadProfile;
+}
+
+/*!
+  \ingroup buildblock
+  \brief A central registry for (nested) timings and counters
+
+  Code is instrumented by using a ProfilingScope with TimedBlock, and a ProfilingCounter
+  for counting things like bins processed or bytes read. The registry keeps the results per thread,
+  such that recording does not need any locking. Timings are organised in a tree, where the "path"
+  of a scope is formed by joining the names of all enclosing scopes (in the same thread) with a \c '/'.
+  Note that scopes entered in threads of an OpenMP parallel region therefore do not have the
+  scopes of the master thread as parent.
+
+  Profiling is disabled by default, in which case the overhead of a scope or counter is
+  a check of an atomic flag.
+
+  At the end of a run, the results can be written as JSON (with aggregated statistics per scope-path,
+  and counters summed over all threads and per thread) or in the Chrome trace event format, which can be
+  viewed in <tt>chrome://tracing</tt> or https://ui.perfetto.dev. The utilities \c OSMAPOSL, \c OSSPS
+  and \c lm_to_projdata do this when the environment variable \c STIR_PROFILING_REPORT is set
+  to the name of the output file. If the filename ends in <tt>.trace.json</tt>, a Chrome trace is written,
+  otherwise the JSON summary.
+
+  \warning Results should only be read (or reset) when no instrumented code is running.
+*/
+class ProfilingRegistry
+{
+public:
+  //! Statistics for a scope-path, summed over all threads
+  struct ScopeStatistics
+  {
+    std::string path;
+    //! number of times the scope was entered
+    std::size_t count = 0;
+    //! total wall-clock time (in seconds) spent in the scope
+    double total_time = 0.;
+    //! maximum wall-clock time (in seconds) of a single entry
+    double max_time = 0.;
+    //! number of threads in which the scope was entered
+    int num_threads = 0;
+  };
+  //! Name and value of a counter
+  struct CounterValue
+  {
+    std::string name;
+    long long value;
+  };
+
+  //! Get the single registry
+  static ProfilingRegistry& instance();
+
+  ~ProfilingRegistry();
+
+  inline bool is_enabled() const
+  {
+    return _enabled.load(std::memory_order_relaxed);
+  }
+  void set_enabled(const bool enabled);
+
+  //! If set, every scope entry is stored as well, as needed for write_chrome_trace()
+  void set_record_trace_events(const bool record);
+  bool get_record_trace_events() const;
+  //! Limit the number of recorded trace events per thread (default 1000000)
+  void set_max_num_trace_events_per_thread(const std::size_t max_num);
+
+  //! Remove all recorded timings, counters and trace events
+  void reset();
+
+  //! \name Functions used by ProfilingScope and ProfilingCounter
+  //@{
+  int register_scope_name(const std::string& name);
+  int register_counter_name(const std::string& name);
+  void enter_scope(const int name_id);
+  //! Ignored if \a name_id does not correspond to the last entered scope of this thread
+  void leave_scope(const int name_id);
+  void add_to_counter(const int counter_id, const long long value);
+  //@}
+
+  //! Get statistics for every scope-path, sorted by path
+  std::vector<ScopeStatistics> get_scope_statistics() const;
+  //! Get counter values, summed over all threads
+  std::vector<CounterValue> get_counter_totals() const;
+
+  void write_json(std::ostream& s) const;
+  void write_chrome_trace(std::ostream& s) const;
+  //! Write Chrome trace if \a filename ends in <tt>.trace.json</tt>, JSON otherwise
+  Succeeded write_report(const std::string& filename) const;
+
+  //! Enable profiling if the \c STIR_PROFILING_REPORT environment variable is set
+  /*! \return \c true if profiling was enabled */
+  bool set_up_from_environment();
+  //! Write the report to the file set by set_up_from_environment(), if any
+  void write_report_if_requested() const;
+
+private:
+  ProfilingRegistry();
+
+  detail::ThreadProfile& get_thread_profile();
+
+  std::atomic<bool> _enabled;
+  std::atomic<bool> _record_trace_events;
+  std::atomic<std::size_t> _max_num_trace_events_per_thread;
+  std::string _report_filename;
+
+  mutable std::mutex _mutex;
+  std::vector<std::string> _scope_names;
+  std::vector<std::string> _counter_names;
+  std::vector<std::unique_ptr<detail::ThreadProfile>> _thread_profiles;
+};
+
+/*!
+  \ingroup buildblock
+  \brief A named scope to be used with TimedBlock for recording timings in the ProfilingRegistry
+
+  The name is registered on construction, so it is best to use a function-local static object.
+  \code
+  static ProfilingScope forward_projection_scope("forward projection");
+  TimedBlock<ProfilingScope> timed_block(forward_projection_scope);
+  \endcode
+  The object can be shared between threads.
+*/
+class ProfilingScope
+{
+public:
+  explicit ProfilingScope(const std::string& name)
+      : _name_id(ProfilingRegistry::instance().register_scope_name(name))
+  {}
+
+  inline void start() const
+  {
+    ProfilingRegistry& registry = ProfilingRegistry::instance();
+    if (registry.is_enabled())
+      registry.enter_scope(_name_id);
+  }
+  inline void stop() const
+  {
+    ProfilingRegistry& registry = ProfilingRegistry::instance();
+    if (registry.is_enabled())
+      registry.leave_scope(_name_id);
+  }
+
+private:
+  const int _name_id;
+};
+
+/*!
+  \ingroup buildblock
+  \brief A named counter in the ProfilingRegistry
+
+  As for ProfilingScope, use a function-local static object. Values are accumulated
+  per thread and summed when the report is written.
+  \code
+  static ProfilingCounter bins_counter("bins processed");
+  bins_counter.add(num_bins);
+  \endcode
+*/
+class ProfilingCounter
+{
+public:
+  explicit ProfilingCounter(const std::string& name)
+      : _counter_id(ProfilingRegistry::instance().register_counter_name(name))
+  {}
+
+  inline void add(const long long value) const
+  {
+    ProfilingRegistry& registry = ProfilingRegistry::instance();
+    if (registry.is_enabled())
+      registry.add_to_counter(_counter_id, value);
+  }
+
+private:
+  const int _counter_id;
+};
+
+END_NAMESPACE_STIR
+
+#endif
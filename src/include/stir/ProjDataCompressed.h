@@ -0,0 +1,225 @@
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup projdata
+  \brief Declaration of class stir::ProjDataCompressed
+
+  \author STIR contributors
+*/
+
+#ifndef __stir_ProjDataCompressed_H__
+#define __stir_ProjDataCompressed_H__
+
+#include "stir/ProjData.h"
+#include "stir/ByteOrder.h"
+#include "stir/SegmentBySinogram.h"
+#include "stir/VectorWithOffset.h"
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <string>
+#include <vector>
+
+START_NAMESPACE_STIR
+
+/*!
+  \ingroup projdata
+  \brief Projection data stored on disk as independently compressed sinograms
+
+  Every sinogram (i.e. for a given TOF bin, segment and axial position) is compressed
+  separately (currently using zlib). This allows random access to the data, while the
+  file size can be far smaller than for ProjDataInterfile, in particular for sparse data.
+  Sinograms that are zero everywhere are not stored at all.
+
+  \par File format
+  The header is an Interfile header as written for ProjDataInterfile, with float data, the
+  standard segment sequence (see ProjData::standard_segment_sequence()) and storage order
+  Segment_AxialPos_View_TangPos (or Timing_Segment_AxialPos_View_TangPos for TOF data), and
+  the additional keyword
+  \verbatim
+  data compression := zlib
+  \endverbatim
+  The data file contains the compressed sinograms (in no particular order), followed by
+  - the index: for every sinogram (in the order specified by the header) its offset in the
+    file and its compressed size in bytes. A size of 0 means that all values are zero.
+  - the offset of the index in the file
+  - the 8 characters \c STIRzidx
+
+  All numbers are 8-byte unsigned integers, using the byte order specified in the header.
+
+  Files in this format are recognised by ProjData::read_from_file().
+
+  \par Performance
+  get_segment_by_sinogram() and set_segment() (de)compress the sinograms of a segment
+  in parallel if OpenMP is enabled. Viewgrams need all sinograms of a segment. This class
+  therefore caches the last 2 segments used for get_viewgram() or set_viewgram(), such that
+  the projectors can use the viewgrams of segments \c s and \c -s together. Still,
+  accessing the data by segment or sinogram is faster.
+
+  (De)compression is done without locking the file, such that other threads can read
+  or write other data in the meantime. However, writing a modified segment to file when it is
+  removed from the cache does lock the file.
+
+  When a sinogram is written, it is appended to the data file, after the index that was
+  present when the file was opened. The space used by its previous version (and the old index)
+  is therefore not reused while the file is open. close() writes the new index at the end of
+  the file, and then removes the unused space by copying the data to a new file, which replaces
+  the original one.
+
+  \warning The index is written to file by close(), which is called by the destructor.
+  If the program exits before this, the modifications are lost. When reading such a file, the last
+  complete index is used (with a warning).
+*/
+class ProjDataCompressed : public ProjData
+{
+public:
+  //! Check if the Interfile header \a filename is for compressed projection data
+  static bool is_compressed_interfile_header(const std::string& filename);
+
+  //! Open existing data
+  /*! \a filename is the name of the header. Use \c std::ios::in|std::ios::out to modify the data. */
+  explicit ProjDataCompressed(const std::string& filename, const std::ios::openmode open_mode = std::ios::in);
+
+  //! Create new data (filled with zeroes)
+  /*! \a filename is the name of the header. Its extension is replaced by \c .hs, while the
+      data file gets the extension \c .sz.
+
+      \a compression_level is passed to zlib (from 1 for fastest to 9 for best compression).
+  */
+  ProjDataCompressed(shared_ptr<const ExamInfo> const& exam_info_sptr,
+                     shared_ptr<const ProjDataInfo> const& proj_data_info_sptr,
+                     const std::string& filename,
+                     const int compression_level = 1,
+                     const ByteOrder byte_order = ByteOrder::native);
+
+  //! Destructor, calls close()
+  ~ProjDataCompressed() override;
+
+  //! Write the index to file, remove unused space from the file and close it
+  /*! After this call, no data can be read or written anymore. */
+  Succeeded close();
+
+  Viewgram<float> get_viewgram(const int view_num,
+                               const int segment_num,
+                               const bool make_num_tangential_poss_odd = false,
+                               const int timing_pos = 0) const override;
+  Succeeded set_viewgram(const Viewgram<float>& v) override;
+
+  Sinogram<float> get_sinogram(const int ax_pos_num,
+                               const int segment_num,
+                               const bool make_num_tangential_poss_odd = false,
+                               const int timing_pos = 0) const override;
+  Succeeded set_sinogram(const Sinogram<float>& s) override;
+
+  SegmentBySinogram<float> get_segment_by_sinogram(const int segment_num, const int timing_pos = 0) const override;
+  SegmentByView<float> get_segment_by_view(const int segment_num, const int timing_pos = 0) const override;
+
+  Succeeded set_segment(const SegmentBySinogram<float>&) override;
+  Succeeded set_segment(const SegmentByView<float>&) override;
+
+  //! Total size of the compressed sinograms in bytes
+  std::uint64_t get_compressed_size() const;
+
+private:
+  struct ChunkInfo
+  {
+    std::uint64_t offset;
+    std::uint64_t size;
+  };
+
+  std::string data_filename;
+  mutable std::fstream data_stream;
+  //! used for all file access, the index and the cache
+  mutable std::mutex data_mutex;
+  bool is_writable;
+  bool index_modified;
+  int compression_level;
+  ByteOrder byte_order;
+  //! where the next chunk will be written
+  std::uint64_t end_of_chunks;
+  std::vector<ChunkInfo> chunks;
+  //! number of the chunk for the first axial position, indexed as [timing_pos][segment_num]
+  VectorWithOffset<VectorWithOffset<std::size_t>> first_chunk_nums;
+
+  struct CachedSegment
+  {
+    shared_ptr<SegmentBySinogram<float>> segment_sptr;
+    //! if \c true, the segment has not been written to file yet
+    bool is_modified;
+  };
+  //! a segment that is being decompressed for the cache
+  struct SegmentBeingRead
+  {
+    int segment_num;
+    int timing_pos;
+    //! set when the segment is written meanwhile, such that it has to be read again
+    bool is_stale;
+  };
+  //! maximum number of segments in the cache (large enough for segments \c s and \c -s)
+  static constexpr std::size_t max_num_cached_segments = 2;
+  //! segments used by get_viewgram() and set_viewgram(), the most recently used first
+  mutable std::list<CachedSegment> cached_segments;
+  mutable std::list<SegmentBeingRead> segments_being_read;
+  //! notified when a thread stops reading a segment for the cache
+  mutable std::condition_variable segment_read_condition;
+
+  void set_up_chunks();
+  void open_data_file(const std::string& data_filename, const std::ios::openmode open_mode);
+  //! Read the index, or the last complete one if the file was not closed properly
+  void read_index();
+  //! Read the index, if there is a valid one that ends at \a end_of_index
+  bool read_index_ending_at(const std::uint64_t end_of_index);
+  //! Write the index for \a chunks_to_write and the trailer at \a index_offset
+  Succeeded
+  write_index(std::ostream& stream, const std::vector<ChunkInfo>& chunks_to_write, const std::uint64_t index_offset) const;
+  //! Copy the chunks in use to a new file, which then replaces the data file
+  /*! The index has to be written to the data file first. */
+  Succeeded remove_unused_space();
+  std::size_t get_chunk_num(const int ax_pos_num, const int segment_num, const int timing_pos) const;
+  void check_writable(const char* const function_name) const;
+
+  //! \name functions for compression (these do not use the file)
+  //@{
+  std::vector<char> compress_sinogram(const Array<2, float>& sinogram) const;
+  //! returns \c false if decompression failed
+  bool decompress_sinogram(Array<2, float>& sinogram, const std::vector<char>& compressed) const;
+  std::vector<std::vector<char>> compress_segment(const SegmentBySinogram<float>& segment) const;
+  void decompress_segment(SegmentBySinogram<float>& segment, const std::vector<std::vector<char>>& compressed) const;
+  //@}
+
+  //! \name functions accessing the file, the index or the cache
+  /*! \a data_mutex has to be locked by the caller */
+  //@{
+  std::vector<char> read_compressed_chunk(const std::size_t chunk_num) const;
+  std::vector<std::vector<char>> read_compressed_chunks(const int segment_num, const int timing_pos) const;
+  Succeeded write_compressed_chunk(const std::size_t chunk_num, const std::vector<char>& compressed);
+  Succeeded write_compressed_chunks(const SegmentBySinogram<float>& segment, const std::vector<std::vector<char>>& compressed);
+  //! Return the cached segment, or \c cached_segments.end() if it is not cached
+  std::list<CachedSegment>::iterator find_cached_segment(const int segment_num, const int timing_pos) const;
+  //! Write the segment to file if it is modified
+  Succeeded write_cached_segment(CachedSegment& cached_segment);
+  //! Let threads that are reading this segment for the cache know that they have to read it again
+  void mark_segment_as_stale(const int segment_num, const int timing_pos);
+  //! Return the cached segment, reading it first if necessary
+  /*! \a lock has to own \a data_mutex. It is released while decompressing, such that other
+      threads can access the file in the meantime.
+
+      If this removes a modified segment from the cache, that one is written to file first.
+  */
+  SegmentBySinogram<float>&
+  get_cached_segment(std::unique_lock<std::mutex>& lock, const int segment_num, const int timing_pos) const;
+  //@}
+};
+
+END_NAMESPACE_STIR
+
+#endif
@@ -151,6 +151,13 @@ public:
   //! Get scale factor
   float get_scale_factor() const;
 
+  //! Set if writing non-float data should warn that the original scale factor is used
+  /*! Non-float data are always written with the scale factor passed to the constructor, and
+      writing fails if the values do not fit. By default, every \c set_* call then writes a warning.
+      Call this with \c false if the values are known to fit, e.g. because they have been clipped.
+  */
+  void set_warn_about_scale_factor(const bool warn);
+
   //! Get the value of bin.
   virtual float get_bin_value(const Bin& this_bin) const;
 
@@ -189,6 +196,8 @@ private:
   // memory as float, with the scale factor multiplied out
   float scale_factor;
 
+  bool warn_about_scale_factor;
+
 private:
 #if __cplusplus > 199711L
   ProjDataFromStream& operator=(ProjDataFromStream&&) = delete;
@@ -22,6 +22,7 @@
 
 #include "stir/ProjData.h"
 #include "stir/Array.h"
+#include "stir/StridedArrayView.h"
 #include <string>
 
 START_NAMESPACE_STIR
@@ -56,6 +57,14 @@ public:
                    shared_ptr<const ProjDataInfo> const& proj_data_info_ptr,
                    const bool initialise_with_0 = true);
 
+  //! constructor that uses existing memory for the data
+  /*! \a data_sptr has to point to at least size_all() elements, stored in the same order
+      as used by this class. The data are not copied, but shared with \a data_sptr.
+  */
+  ProjDataInMemory(shared_ptr<const ExamInfo> const& exam_info_sptr,
+                   shared_ptr<const ProjDataInfo> const& proj_data_info_ptr,
+                   shared_ptr<float[]> data_sptr);
+
   //! constructor that copies data from another ProjData
   ProjDataInMemory(const ProjData& proj_data);
 
@@ -63,6 +72,9 @@ public:
   ProjDataInMemory(const ProjDataInMemory& proj_data);
 
   //! A static member to get the projection data in memory from a file
+  /*! If get_memory_map_input_files() returns \c true, the data file is mapped in memory
+      if possible (see read_interfile_PDFS_memory_mapped()). Otherwise, all data are read.
+  */
   static shared_ptr<ProjDataInMemory> read_from_file(const std::string& filename);
 
   Viewgram<float> get_viewgram(const int view_num,
@@ -276,11 +288,27 @@ public:
   }
   //@}
 
+  //! \name zero-copy access to the data of a segment
+  /*! These return a view on the internal buffer, such that no data is copied. The view is only
+      valid as long as the current object exists.
+  */
+  //@{
+  //! view on a segment, indexed as [axial_pos_num][view_num][tangential_pos_num]
+  /*! This corresponds to the memory layout, i.e. the view is contiguous. */
+  StridedArrayView<3, float> get_segment_view_by_sinogram(const int segment_num, const int timing_pos = 0);
+  StridedArrayView<3, const float> get_segment_view_by_sinogram(const int segment_num, const int timing_pos = 0) const;
+  //! view on a segment, indexed as [view_num][axial_pos_num][tangential_pos_num]
+  StridedArrayView<3, float> get_segment_view_by_view(const int segment_num, const int timing_pos = 0);
+  StridedArrayView<3, const float> get_segment_view_by_view(const int segment_num, const int timing_pos = 0) const;
+  //@}
+
 private:
   Array<1, float> buffer;
 
   //! allocates buffer for storing the data. Has to be called by constructors
   void create_buffer(const bool initialise_with_0 = false);
+  //! sets offset_3d_data and timing_poss_sequence. Has to be called by constructors
+  void set_up_offsets();
   //! offset of the whole 3d sinogram in the stream
   std::streamoff offset;
   //! offset of a complete non-tof sinogram
@@ -25,6 +25,7 @@
 */
 
 #include "stir/IndexRange2D.h"
+#include "stir/buffer_pool.h"
 
 START_NAMESPACE_STIR
 
@@ -131,10 +132,10 @@ Sinogram<elemT>::Sinogram(const Array<2, elemT>& p, const shared_ptr<const ProjD
 
 template <typename elemT>
 Sinogram<elemT>::Sinogram(const shared_ptr<const ProjDataInfo>& pdi_ptr, const SinogramIndices& ind)
-    : Array<2, elemT>(IndexRange2D(pdi_ptr->get_min_view_num(),
-                                   pdi_ptr->get_max_view_num(),
-                                   pdi_ptr->get_min_tangential_pos_num(),
-                                   pdi_ptr->get_max_tangential_pos_num())),
+    : Array<2, elemT>(make_array_using_buffer_pool<2, elemT>(IndexRange2D(pdi_ptr->get_min_view_num(),
+                                                                          pdi_ptr->get_max_view_num(),
+                                                                          pdi_ptr->get_min_tangential_pos_num(),
+                                                                          pdi_ptr->get_max_tangential_pos_num()))),
       proj_data_info_ptr(pdi_ptr),
       _indices(ind)
 {
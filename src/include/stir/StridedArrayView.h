@@ -0,0 +1,164 @@
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+
+#ifndef __stir_StridedArrayView_H__
+#define __stir_StridedArrayView_H__
+
+/*!
+  \file
+  \ingroup Array
+  \brief defines the stir::StridedArrayView class
+
+  \author STIR contributors
+*/
+#include "stir/BasicCoordinate.h"
+#include "stir/IndexRange.h"
+#include "stir/ArrayFwd.h"
+#include <cstddef>
+#include <type_traits>
+
+START_NAMESPACE_STIR
+
+/*!
+  \ingroup Array
+  \brief A non-owning view on a flat block of memory, interpreted as a regular multi-dimensional array
+
+  An Array is a vector of (pointers to) sub-arrays, such that every \c image[z][y][x] access has to
+  follow num_dimensions pointers. This class provides an alternative for hot loops: it stores a
+  single pointer, the minimum index and length of every dimension, and the stride (in elements)
+  for every dimension. Element access is therefore a single inner product of the indices with the strides.
+
+  The view does not own the memory. It is up to the caller to make sure that the object that
+  owns the memory (e.g. an Array, a VoxelsOnCartesianGrid or a ProjDataInMemory) outlives the view,
+  and is not resized while the view is in use.
+
+  Strides do not need to be row-major. This allows for instance a by-view ordering on data that is
+  stored by sinogram (see ProjDataInMemory::get_segment_view_by_view()), or a subview() of a
+  larger block. Use is_contiguous() to find out if the view corresponds to a row-major block
+  without holes.
+
+  Use \c StridedArrayView<num_dimensions, const elemT> for read-only access.
+
+  Example:
+  \code
+  VoxelsOnCartesianGrid<float> image(...);
+  StridedArrayView<3, float> image_view(image); // calls error() if image is not contiguous
+  const auto strides = image_view.get_strides();
+  float* ptr = image_view.get_full_data_ptr();
+  for (std::size_t i = 0; i < image_view.size_all(); ++i)
+    ptr[i] *= 2;
+  \endcode
+*/
+template <int num_dimensions, typename elemT>
+class StridedArrayView
+{
+public:
+  //! \name typedefs for compatibility with STL containers
+  //@{
+  typedef elemT value_type;
+  typedef elemT& reference;
+  typedef elemT* pointer;
+  typedef std::ptrdiff_t difference_type;
+  typedef std::size_t size_type;
+  //@}
+  //! type of the elements without \c const, as used by Array
+  typedef typename std::remove_const<elemT>::type non_const_value_type;
+  typedef BasicCoordinate<num_dimensions, int> index_type;
+  typedef BasicCoordinate<num_dimensions, difference_type> strides_type;
+
+  //! Construct an empty view
+  inline StridedArrayView();
+
+  //! Construct a view on a row-major contiguous block of memory
+  /*! \c data_ptr should point to the element corresponding to \c min_indices. */
+  inline StridedArrayView(elemT* data_ptr, const index_type& min_indices, const index_type& lengths);
+
+  //! Construct a view with arbitrary strides
+  /*! \c data_ptr should point to the element corresponding to \c min_indices. */
+  inline StridedArrayView(elemT* data_ptr, const index_type& min_indices, const index_type& lengths, const strides_type& strides);
+
+  //! Construct a view on the data of an Array
+  /*! Calls error() if the array is not regular or not contiguous. Note that Arrays constructed
+      from an IndexRange or by copying are contiguous, but resizing can break this.
+  */
+  inline explicit StridedArrayView(Array<num_dimensions, non_const_value_type>& array);
+
+  //! Construct a view on the data of a const Array (only valid for \c const \c elemT)
+  inline explicit StridedArrayView(const Array<num_dimensions, non_const_value_type>& array);
+
+  //! Allow conversion from a non-const view to a const view
+  template <typename elemT2, typename = typename std::enable_if<std::is_same<const elemT2, elemT>::value>::type>
+  inline StridedArrayView(const StridedArrayView<num_dimensions, elemT2>& other)
+      : _data_ptr(other.get_full_data_ptr()),
+        _min_indices(other.get_min_indices()),
+        _lengths(other.get_lengths()),
+        _strides(other.get_strides())
+  {}
+
+  //! \name information on the indices
+  //@{
+  inline const index_type& get_min_indices() const;
+  inline index_type get_max_indices() const;
+  inline const index_type& get_lengths() const;
+  //! strides in number of elements for every dimension
+  inline const strides_type& get_strides() const;
+  //! the IndexRange corresponding to this view (always regular)
+  inline IndexRange<num_dimensions> get_index_range() const;
+  //! the total number of elements in the view
+  inline size_type size_all() const;
+  //@}
+
+  //! checks if the strides are row-major without any gaps
+  /*! If this returns \c true, the elements of the view occupy the memory locations
+      [get_full_data_ptr(), get_full_data_ptr()+size_all()).
+  */
+  inline bool is_contiguous() const;
+
+  //! pointer to the element corresponding to get_min_indices() (this is O(1))
+  inline elemT* get_full_data_ptr() const;
+
+  //! offset (in number of elements) w.r.t. get_full_data_ptr() of the element at the given indices
+  inline difference_type offset(const index_type& indices) const;
+
+  //! element access without range checking
+  inline elemT& operator[](const index_type& indices) const;
+
+  //! element access with range checking (throws std::out_of_range)
+  inline elemT& at(const index_type& indices) const;
+
+  //! return a view on a rectangular sub-block, using the same memory and strides
+  /*! Calls error() if the sub-block does not fit in the current view. */
+  inline StridedArrayView subview(const index_type& min_indices, const index_type& lengths) const;
+
+  //! return a view with dimensions \c d1 and \c d2 interchanged (1-based as for BasicCoordinate)
+  inline StridedArrayView swap_dimensions(const int d1, const int d2) const;
+
+  //! Copy the data from the view into an Array of the same index range
+  /*! The \a array will be resized if necessary. */
+  inline void copy_to(Array<num_dimensions, non_const_value_type>& array) const;
+
+  //! Copy the data from an Array into the view. The array needs to have the same (regular) index range.
+  inline void copy_from(const Array<num_dimensions, non_const_value_type>& array) const;
+
+private:
+  elemT* _data_ptr;
+  index_type _min_indices;
+  index_type _lengths;
+  strides_type _strides;
+
+  inline void set_row_major_strides();
+  template <class ArrayT>
+  inline void init_from_array(ArrayT& array);
+};
+
+END_NAMESPACE_STIR
+
+#include "stir/StridedArrayView.inl"
+
+#endif
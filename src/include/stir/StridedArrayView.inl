@@ -0,0 +1,282 @@
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup Array
+  \brief inline implementations for the stir::StridedArrayView class
+
+  \author STIR contributors
+*/
+#include "stir/Array.h"
+#include "stir/error.h"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+START_NAMESPACE_STIR
+
+namespace detail
+{
+//! advance \a indices in row-major order, returns \c false when past the end
+template <int num_dimensions>
+inline bool
+increment_row_major_indices(BasicCoordinate<num_dimensions, int>& indices,
+                            const BasicCoordinate<num_dimensions, int>& min_indices,
+                            const BasicCoordinate<num_dimensions, int>& lengths)
+{
+  for (int d = num_dimensions; d >= 1; --d)
+    {
+      if (++indices[d] < min_indices[d] + lengths[d])
+        return true;
+      indices[d] = min_indices[d];
+    }
+  return false;
+}
+} // namespace detail
+
+template <int num_dimensions, typename elemT>
+void
+StridedArrayView<num_dimensions, elemT>::set_row_major_strides()
+{
+  difference_type stride = 1;
+  for (int d = num_dimensions; d >= 1; --d)
+    {
+      _strides[d] = stride;
+      stride *= _lengths[d];
+    }
+}
+
+template <int num_dimensions, typename elemT>
+StridedArrayView<num_dimensions, elemT>::StridedArrayView()
+    : _data_ptr(nullptr)
+{
+  _min_indices.fill(0);
+  _lengths.fill(0);
+  set_row_major_strides();
+}
+
+template <int num_dimensions, typename elemT>
+StridedArrayView<num_dimensions, elemT>::StridedArrayView(elemT* data_ptr,
+                                                          const index_type& min_indices,
+                                                          const index_type& lengths)
+    : _data_ptr(data_ptr),
+      _min_indices(min_indices),
+      _lengths(lengths)
+{
+  set_row_major_strides();
+}
+
+template <int num_dimensions, typename elemT>
+StridedArrayView<num_dimensions, elemT>::StridedArrayView(elemT* data_ptr,
+                                                          const index_type& min_indices,
+                                                          const index_type& lengths,
+                                                          const strides_type& strides)
+    : _data_ptr(data_ptr),
+      _min_indices(min_indices),
+      _lengths(lengths),
+      _strides(strides)
+{}
+
+template <int num_dimensions, typename elemT>
+template <class ArrayT>
+void
+StridedArrayView<num_dimensions, elemT>::init_from_array(ArrayT& array)
+{
+  if (array.size_all() == 0)
+    {
+      *this = StridedArrayView();
+      return;
+    }
+  index_type max_indices;
+  if (!array.get_regular_range(_min_indices, max_indices))
+    error("StridedArrayView: can only be constructed from an Array with a regular range");
+  if (!array.is_contiguous())
+    error("StridedArrayView: can only be constructed from a contiguous Array");
+  _lengths = max_indices - _min_indices + 1;
+  _data_ptr = &(*array.begin_all());
+  set_row_major_strides();
+}
+
+template <int num_dimensions, typename elemT>
+StridedArrayView<num_dimensions, elemT>::StridedArrayView(Array<num_dimensions, non_const_value_type>& array)
+{
+  this->init_from_array(array);
+}
+
+template <int num_dimensions, typename elemT>
+StridedArrayView<num_dimensions, elemT>::StridedArrayView(const Array<num_dimensions, non_const_value_type>& array)
+{
+  static_assert(std::is_const<elemT>::value, "StridedArrayView: use a view on const elements for a const Array");
+  this->init_from_array(array);
+}
+
+template <int num_dimensions, typename elemT>
+const typename StridedArrayView<num_dimensions, elemT>::index_type&
+StridedArrayView<num_dimensions, elemT>::get_min_indices() const
+{
+  return _min_indices;
+}
+
+template <int num_dimensions, typename elemT>
+typename StridedArrayView<num_dimensions, elemT>::index_type
+StridedArrayView<num_dimensions, elemT>::get_max_indices() const
+{
+  return _min_indices + _lengths - 1;
+}
+
+template <int num_dimensions, typename elemT>
+const typename StridedArrayView<num_dimensions, elemT>::index_type&
+StridedArrayView<num_dimensions, elemT>::get_lengths() const
+{
+  return _lengths;
+}
+
+template <int num_dimensions, typename elemT>
+const typename StridedArrayView<num_dimensions, elemT>::strides_type&
+StridedArrayView<num_dimensions, elemT>::get_strides() const
+{
+  return _strides;
+}
+
+template <int num_dimensions, typename elemT>
+IndexRange<num_dimensions>
+StridedArrayView<num_dimensions, elemT>::get_index_range() const
+{
+  if (this->size_all() == 0)
+    return IndexRange<num_dimensions>();
+  return IndexRange<num_dimensions>(this->get_min_indices(), this->get_max_indices());
+}
+
+template <int num_dimensions, typename elemT>
+typename StridedArrayView<num_dimensions, elemT>::size_type
+StridedArrayView<num_dimensions, elemT>::size_all() const
+{
+  size_type size = 1;
+  for (int d = 1; d <= num_dimensions; ++d)
+    size *= static_cast<size_type>(std::max(_lengths[d], 0));
+  return size;
+}
+
+template <int num_dimensions, typename elemT>
+bool
+StridedArrayView<num_dimensions, elemT>::is_contiguous() const
+{
+  difference_type stride = 1;
+  for (int d = num_dimensions; d >= 1; --d)
+    {
+      // strides of dimensions of length 1 are irrelevant
+      if (_lengths[d] > 1 && _strides[d] != stride)
+        return false;
+      stride *= _lengths[d];
+    }
+  return true;
+}
+
+template <int num_dimensions, typename elemT>
+elemT*
+StridedArrayView<num_dimensions, elemT>::get_full_data_ptr() const
+{
+  return _data_ptr;
+}
+
+template <int num_dimensions, typename elemT>
+typename StridedArrayView<num_dimensions, elemT>::difference_type
+StridedArrayView<num_dimensions, elemT>::offset(const index_type& indices) const
+{
+  difference_type result = 0;
+  for (int d = 1; d <= num_dimensions; ++d)
+    result += (indices[d] - _min_indices[d]) * _strides[d];
+  return result;
+}
+
+template <int num_dimensions, typename elemT>
+elemT&
+StridedArrayView<num_dimensions, elemT>::operator[](const index_type& indices) const
+{
+  return _data_ptr[this->offset(indices)];
+}
+
+template <int num_dimensions, typename elemT>
+elemT&
+StridedArrayView<num_dimensions, elemT>::at(const index_type& indices) const
+{
+  for (int d = 1; d <= num_dimensions; ++d)
+    if (indices[d] < _min_indices[d] || indices[d] >= _min_indices[d] + _lengths[d])
+      throw std::out_of_range("StridedArrayView::at index out of range");
+  return (*this)[indices];
+}
+
+template <int num_dimensions, typename elemT>
+StridedArrayView<num_dimensions, elemT>
+StridedArrayView<num_dimensions, elemT>::subview(const index_type& min_indices, const index_type& lengths) const
+{
+  for (int d = 1; d <= num_dimensions; ++d)
+    if (lengths[d] < 0 || min_indices[d] < _min_indices[d] || min_indices[d] + lengths[d] > _min_indices[d] + _lengths[d])
+      error("StridedArrayView::subview: sub-block out of range");
+  return StridedArrayView(_data_ptr + this->offset(min_indices), min_indices, lengths, _strides);
+}
+
+template <int num_dimensions, typename elemT>
+StridedArrayView<num_dimensions, elemT>
+StridedArrayView<num_dimensions, elemT>::swap_dimensions(const int d1, const int d2) const
+{
+  if (d1 < 1 || d1 > num_dimensions || d2 < 1 || d2 > num_dimensions)
+    error("StridedArrayView::swap_dimensions: invalid dimension");
+  StridedArrayView result(*this);
+  std::swap(result._min_indices[d1], result._min_indices[d2]);
+  std::swap(result._lengths[d1], result._lengths[d2]);
+  std::swap(result._strides[d1], result._strides[d2]);
+  return result;
+}
+
+template <int num_dimensions, typename elemT>
+void
+StridedArrayView<num_dimensions, elemT>::copy_to(Array<num_dimensions, non_const_value_type>& array) const
+{
+  const IndexRange<num_dimensions> range = this->get_index_range();
+  if (array.get_index_range() != range)
+    array.resize(range);
+  if (this->size_all() == 0)
+    return;
+  if (this->is_contiguous())
+    {
+      std::copy(_data_ptr, _data_ptr + this->size_all(), array.begin_all());
+      return;
+    }
+  index_type indices = _min_indices;
+  auto array_iter = array.begin_all();
+  do
+    {
+      *array_iter++ = (*this)[indices];
+  } while (detail::increment_row_major_indices(indices, _min_indices, _lengths));
+}
+
+template <int num_dimensions, typename elemT>
+void
+StridedArrayView<num_dimensions, elemT>::copy_from(const Array<num_dimensions, non_const_value_type>& array) const
+{
+  static_assert(!std::is_const<elemT>::value, "StridedArrayView::copy_from cannot be used on a view on const elements");
+  if (array.get_index_range() != this->get_index_range())
+    error("StridedArrayView::copy_from: index range of the Array does not match the view");
+  if (this->size_all() == 0)
+    return;
+  if (this->is_contiguous())
+    {
+      std::copy(array.begin_all_const(), array.end_all_const(), _data_ptr);
+      return;
+    }
+  index_type indices = _min_indices;
+  auto array_iter = array.begin_all_const();
+  do
+    {
+      (*this)[indices] = *array_iter++;
+  } while (detail::increment_row_major_indices(indices, _min_indices, _lengths));
+}
+
+END_NAMESPACE_STIR
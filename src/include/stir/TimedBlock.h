@@ -57,10 +57,10 @@ cout << "It took " << t.GetTime() << "sec to execute do_something_1..3()" << end
 \par Template argument requirements
 
 \c TimerT has to have a start() and stop() member function. This is the case for
-stir::Timer (and derived functions) and stir::HighResWallClockTimer.
+stir::Timer (and derived functions), stir::HighResWallClockTimer and stir::ProfilingScope.
 */
-template <class TimerT>
-class TimedBlock<TimerT = Timer>
+template <class TimerT = Timer>
+class TimedBlock
 {
 public:
   //! Create a timed block
@@ -25,6 +25,7 @@
 */
 
 #include "stir/IndexRange2D.h"
+#include "stir/buffer_pool.h"
 
 START_NAMESPACE_STIR
 
@@ -131,10 +132,10 @@ Viewgram<elemT>::Viewgram(const Array<2, elemT>& p, const shared_ptr<const ProjD
 
 template <typename elemT>
 Viewgram<elemT>::Viewgram(const shared_ptr<const ProjDataInfo>& pdi_sptr, const ViewgramIndices& ind)
-    : Array<2, elemT>(IndexRange2D(pdi_sptr->get_min_axial_pos_num(ind.segment_num()),
-                                   pdi_sptr->get_max_axial_pos_num(ind.segment_num()),
-                                   pdi_sptr->get_min_tangential_pos_num(),
-                                   pdi_sptr->get_max_tangential_pos_num())),
+    : Array<2, elemT>(make_array_using_buffer_pool<2, elemT>(IndexRange2D(pdi_sptr->get_min_axial_pos_num(ind.segment_num()),
+                                                                          pdi_sptr->get_max_axial_pos_num(ind.segment_num()),
+                                                                          pdi_sptr->get_min_tangential_pos_num(),
+                                                                          pdi_sptr->get_max_tangential_pos_num()))),
       proj_data_info_sptr(pdi_sptr),
       _indices(ind)
 {
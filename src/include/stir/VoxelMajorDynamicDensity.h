@@ -0,0 +1,151 @@
+//
+//
+/*!
+  \file
+  \ingroup densitydata
+  \brief Declaration of class stir::VoxelMajorDynamicDensity
+  \author STIR contributors
+
+*/
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+
+#ifndef __stir_VoxelMajorDynamicDensity_H__
+#define __stir_VoxelMajorDynamicDensity_H__
+
+#include "stir/ExamData.h"
+#include "stir/Array.h"
+#include "stir/IndexRange.h"
+#include "stir/CartesianCoordinate3D.h"
+#include "stir/DiscretisedDensity.h"
+#include "stir/VoxelsOnCartesianGrid.h"
+#include "stir/TimeFrameDefinitions.h"
+#include "stir/Scanner.h"
+#include "stir/shared_ptr.h"
+#include "stir/unique_ptr.h"
+#include <string>
+
+START_NAMESPACE_STIR
+
+class DynamicDiscretisedDensity;
+
+/*! \ingroup densitydata
+  \brief Dynamic image on a Cartesian grid, stored with the time frames of every voxel contiguous in memory
+
+  DynamicDiscretisedDensity stores every time frame as a separate image. Operations on time-activity
+  curves (TACs), such as kinetic modelling, then need to access a different allocation for every frame of a
+  voxel. This class stores all data in a single (contiguous) Array<4,float>, indexed as
+  <tt>image[z][y][x][frame_num]</tt>, such that the TAC of a voxel is a contiguous Array<1,float>.
+
+  Conversion from and to a DynamicDiscretisedDensity is done with a transposition of the data, which is
+  parallelised with OpenMP (if enabled). The (Interfile and Multi) file formats read and write one time frame
+  at a time, such that no DynamicDiscretisedDensity needs to be created.
+
+  \warning Frame numbers start from 1, as for DynamicDiscretisedDensity.
+  \warning All time frames need to be a VoxelsOnCartesianGrid with a regular index range.
+*/
+class VoxelMajorDynamicDensity : public ExamData
+{
+public:
+  //! A typedef that can be used what the base of the hierarchy is
+  /*! This typedef is used in write_to_file().
+   */
+  typedef VoxelMajorDynamicDensity hierarchy_base_type;
+  //! type of a single time frame
+  typedef VoxelsOnCartesianGrid<float> SingleDiscretisedDensityType;
+  //! type of the time-activity curve of a single voxel (indexed by frame number)
+  typedef Array<1, float> TACType;
+
+  //! read from file, using the registered file formats for VoxelMajorDynamicDensity
+  static VoxelMajorDynamicDensity* read_from_file(const std::string& filename);
+
+  //! Construct an image with all values 0
+  /*! The geometry is taken from \a frame_template (its data is not used), and the time frames from \a exam_info_sptr.
+   */
+  VoxelMajorDynamicDensity(const shared_ptr<const ExamInfo>& exam_info_sptr,
+                           const SingleDiscretisedDensityType& frame_template,
+                           const shared_ptr<Scanner>& scanner_sptr = shared_ptr<Scanner>());
+
+  //! Convert from a DynamicDiscretisedDensity (with VoxelsOnCartesianGrid time frames)
+  explicit VoxelMajorDynamicDensity(const DynamicDiscretisedDensity& dyn_image);
+
+  //! Convert to a DynamicDiscretisedDensity
+  unique_ptr<DynamicDiscretisedDensity> construct_dynamic_discretised_density() const;
+
+  /*! \name access to the data
+    The 4D array is indexed as <tt>[z][y][x][frame_num]</tt>.
+  */
+  //@{
+  Array<3, float>& operator[](const int z) { return this->_data[z]; }
+  const Array<3, float>& operator[](const int z) const { return this->_data[z]; }
+  //! access to the time-activity curve of a voxel
+  TACType& get_TAC(const BasicCoordinate<3, int>& c) { return this->_data[c[1]][c[2]][c[3]]; }
+  const TACType& get_TAC(const BasicCoordinate<3, int>& c) const { return this->_data[c[1]][c[2]][c[3]]; }
+  //! the data as a 4D array
+  /*! \warning The member functions of this class call error() if the data is no longer stored contiguously,
+      so do not resize it or replace its rows.
+  */
+  Array<4, float>& get_data() { return this->_data; }
+  const Array<4, float>& get_data() const { return this->_data; }
+  //@}
+
+  //! iterators over all elements, see Array::begin_all()
+  Array<4, float>::full_iterator begin_all() { return this->_data.begin_all(); }
+  Array<4, float>::const_full_iterator begin_all() const { return this->_data.begin_all(); }
+  Array<4, float>::full_iterator end_all() { return this->_data.end_all(); }
+  Array<4, float>::const_full_iterator end_all() const { return this->_data.end_all(); }
+
+  /*! \name conversion of single time frames
+    \warning The frame_num starts from 1
+  */
+  //@{
+  //! Copy the data of a time frame into the image
+  /*! \a density has to have the same geometry as the time frames of this object. Its time information is not checked.
+   */
+  void set_density(const DiscretisedDensity<3, float>& density, const unsigned int frame_num);
+  //! Copy the data of a time frame into \a density
+  /*! \a density has to have the same index range as the time frames of this object. */
+  void get_density(DiscretisedDensity<3, float>& density, const unsigned int frame_num) const;
+  //! Construct a new image for a single time frame, including its time frame information
+  SingleDiscretisedDensityType construct_single_density(const unsigned int frame_num) const;
+  //@}
+
+  /*! \name geometry of the time frames */
+  //@{
+  const IndexRange<3>& get_index_range() const { return this->_index_range; }
+  const CartesianCoordinate3D<float>& get_origin() const { return this->_origin; }
+  const CartesianCoordinate3D<float>& get_grid_spacing() const { return this->_grid_spacing; }
+  //@}
+
+  const TimeFrameDefinitions& get_time_frame_definitions() const;
+  unsigned get_num_time_frames() const { return this->get_time_frame_definitions().get_num_time_frames(); }
+
+  //! Sets the time frame definitions
+  /*! \warning The number of time frames cannot be changed. */
+  void set_time_frame_definitions(const TimeFrameDefinitions& time_frame_definitions);
+
+  void set_scanner(const Scanner& scanner) { this->_scanner_sptr.reset(new Scanner(scanner)); }
+  float get_scanner_default_bin_size() const;
+
+private:
+  Array<4, float> _data;
+  IndexRange<3> _index_range;
+  CartesianCoordinate3D<float> _origin;
+  CartesianCoordinate3D<float> _grid_spacing;
+  shared_ptr<Scanner> _scanner_sptr;
+
+  void allocate();
+  void check_index_range(const DiscretisedDensity<3, float>& density, const char* const caller) const;
+  //! calls error() if the data is not stored in a single block
+  void check_contiguous(const char* const caller) const;
+};
+
+END_NAMESPACE_STIR
+
+#endif //__stir_VoxelMajorDynamicDensity_H__
@@ -78,6 +78,16 @@ static VoxelsOnCartesianGrid ask_parameters();
                         const CartesianCoordinate3D<float>& origin,
                         const BasicCoordinate<3, float>& grid_spacing);
 
+  //! Construct a VoxelsOnCartesianGrid pointing to existing contiguous data
+  /*! No data is copied. \a data_sptr should point to a block of size <code>range.size_all()</code>,
+      and is accessed in "row-major" order. See the corresponding Array constructor.
+  */
+  VoxelsOnCartesianGrid(const shared_ptr<const ExamInfo>& exam_info_sptr,
+                        const IndexRange<3>& range,
+                        shared_ptr<elemT[]> data_sptr,
+                        const CartesianCoordinate3D<float>& origin,
+                        const BasicCoordinate<3, float>& grid_spacing);
+
   // KT 10/12/2001 replace 2 constructors with the more general one below
   //! use ProjDataInfo to obtain the size information
   /*!
@@ -0,0 +1,188 @@
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+#ifndef __stir_apply_elementwise__H__
+#define __stir_apply_elementwise__H__
+
+/*!
+  \file
+  \ingroup buildblock
+  \brief Declaration and implementation of stir::apply_elementwise templates
+  \author STIR contributors
+*/
+
+#include "stir/Array.h"
+#include "stir/ProjDataInMemory.h"
+#include "stir/ProjDataInfo.h"
+#include "stir/RelatedViewgrams.h"
+#include "stir/SegmentBySinogram.h"
+#include "stir/Succeeded.h"
+#include "stir/error.h"
+#include "stir/format.h"
+
+START_NAMESPACE_STIR
+
+/*!
+ \defgroup apply_elementwise Fused element-wise operations
+ \ingroup buildblock
+
+ These functions compute <tt>output[i] = f(input1[i], input2[i], ...)</tt> for every element
+ in a single pass over the data. They can be used instead of a chain of operations such as
+ \c xapyb, \c sapyb, <tt>operator*=</tt> etc, which would each need a pass over the data,
+ and often a temporary copy. For example,
+ \code
+ // out = a*x + b*y - z
+ apply_elementwise(out, [a, b](float x, float y, float z) { return a * x + b * y - z; }, x, y, z);
+ \endcode
+ The output can be one of the inputs as well. The function object is called from multiple
+ threads (if OpenMP is enabled), and should therefore not modify any state.
+
+ All arrays need to have the same index ranges, otherwise error() is called.
+ @{
+*/
+
+namespace detail
+{
+template <class elemT, class FunctionT, class... InputElemT>
+inline void
+apply_elementwise_serial(Array<1, elemT>& output, const FunctionT& f, const Array<1, InputElemT>&... inputs)
+{
+  for (int i = output.get_min_index(); i <= output.get_max_index(); ++i)
+    output[i] = f(inputs[i]...);
+}
+
+template <int num_dimensions, class elemT, class FunctionT, class... InputElemT>
+inline void
+apply_elementwise_serial(Array<num_dimensions, elemT>& output,
+                         const FunctionT& f,
+                         const Array<num_dimensions, InputElemT>&... inputs)
+{
+  for (int i = output.get_min_index(); i <= output.get_max_index(); ++i)
+    apply_elementwise_serial(output[i], f, inputs[i]...);
+}
+
+template <int num_dimensions, class elemT, class... InputElemT>
+inline void
+check_index_ranges(const Array<num_dimensions, elemT>& output, const Array<num_dimensions, InputElemT>&... inputs)
+{
+  if (!((output.get_index_range() == inputs.get_index_range()) && ...))
+    error("apply_elementwise: index ranges of the arrays do not match");
+}
+
+//! Returns \a ptr as a ProjDataInMemory, or 0 if it is of another type
+/*! Takes a pointer to avoid -Waddress warnings when the argument is a ProjDataInMemory already. */
+inline const ProjDataInMemory*
+as_proj_data_in_memory(const ProjData* ptr)
+{
+  return dynamic_cast<const ProjDataInMemory*>(ptr);
+}
+} // namespace detail
+
+//! Compute <tt>output[i] = f(inputs[i]...)</tt> for 1D arrays, in parallel (if OpenMP is enabled)
+template <class elemT, class FunctionT, class... InputElemT>
+inline void
+apply_elementwise(Array<1, elemT>& output, const FunctionT& f, const Array<1, InputElemT>&... inputs)
+{
+  detail::check_index_ranges(output, inputs...);
+  const int min_index = output.get_min_index();
+  const int max_index = output.get_max_index();
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(static)
+#endif
+  for (int i = min_index; i <= max_index; ++i)
+    output[i] = f(inputs[i]...);
+}
+
+//! Compute <tt>output[i] = f(inputs[i]...)</tt> for multi-dimensional arrays, in parallel over the first index
+/*! This can also be used for images, e.g. DiscretisedDensity<3,float>. */
+template <int num_dimensions, class elemT, class FunctionT, class... InputElemT>
+inline void
+apply_elementwise(Array<num_dimensions, elemT>& output, const FunctionT& f, const Array<num_dimensions, InputElemT>&... inputs)
+{
+  detail::check_index_ranges(output, inputs...);
+  const int min_index = output.get_min_index();
+  const int max_index = output.get_max_index();
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
+  for (int i = min_index; i <= max_index; ++i)
+    detail::apply_elementwise_serial(output[i], f, inputs[i]...);
+}
+
+//! Compute <tt>output[bin] = f(inputs[bin]...)</tt> for related viewgrams
+/*! This is normally called from within a parallel loop over view/segments, and therefore
+    does not use threads itself.
+    All arguments need to have the same number of viewgrams.
+*/
+template <class FunctionT, class... InputT>
+inline void
+apply_elementwise(RelatedViewgrams<float>& output, const FunctionT& f, const RelatedViewgrams<InputT>&... inputs)
+{
+  if (!((inputs.get_num_viewgrams() == output.get_num_viewgrams()) && ...))
+    error("apply_elementwise: numbers of related viewgrams do not match");
+  for (int i = 0; i < output.get_num_viewgrams(); ++i)
+    {
+      detail::check_index_ranges(*(output.begin() + i), *(inputs.begin() + i)...);
+      detail::apply_elementwise_serial(*(output.begin() + i), f, *(inputs.begin() + i)...);
+    }
+}
+
+//! Compute <tt>output[bin] = f(inputs[bin]...)</tt> for projection data, by reading/writing segments
+/*! This works for any type of ProjData, and needs memory for (the number of inputs + 1) segments.
+    The segments (and TOF bins) of all arguments need to have the same sizes.
+    Usually you would call apply_elementwise() instead.
+*/
+template <class FunctionT, class... InputT>
+inline void
+apply_elementwise_by_segment(ProjData& output, const FunctionT& f, const InputT&... inputs)
+{
+  for (int timing_pos_num = output.get_min_tof_pos_num(); timing_pos_num <= output.get_max_tof_pos_num(); ++timing_pos_num)
+    for (int segment_num = output.get_min_segment_num(); segment_num <= output.get_max_segment_num(); ++segment_num)
+      {
+        SegmentBySinogram<float> segment = output.get_empty_segment_by_sinogram(segment_num, false, timing_pos_num);
+        apply_elementwise(
+            segment, f, static_cast<const ProjData&>(inputs).get_segment_by_sinogram(segment_num, timing_pos_num)...);
+        if (output.set_segment(segment) == Succeeded::no)
+          error(format("apply_elementwise: error writing segment {} (TOF bin {})", segment_num, timing_pos_num));
+      }
+}
+
+//! Compute <tt>output[bin] = f(inputs[bin]...)</tt> for projection data
+/*! If all arguments are ProjDataInMemory with the same ProjDataInfo, this is done in a single
+    parallel loop over the data in memory. Otherwise, apply_elementwise_by_segment() is used.
+*/
+template <class FunctionT, class... InputT>
+inline void
+apply_elementwise(ProjData& output, const FunctionT& f, const InputT&... inputs)
+{
+  auto output_in_memory_ptr = dynamic_cast<ProjDataInMemory*>(&output);
+  if (output_in_memory_ptr == nullptr || !((detail::as_proj_data_in_memory(&inputs) != nullptr) && ...)
+      || !((*output.get_proj_data_info_sptr() == *static_cast<const ProjData&>(inputs).get_proj_data_info_sptr()) && ...))
+    {
+      apply_elementwise_by_segment(output, f, inputs...);
+      return;
+    }
+
+  // note: ProjDataInMemory iterators are pointers
+  float* const output_ptr = output_in_memory_ptr->begin();
+  const long long num_elements = static_cast<long long>(output.size_all());
+  const auto run = [&](const auto*... input_ptrs) {
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(static)
+#endif
+    for (long long i = 0; i < num_elements; ++i)
+      output_ptr[i] = f(input_ptrs[i]...);
+  };
+  run(detail::as_proj_data_in_memory(&inputs)->begin()...);
+}
+
+//@}
+
+END_NAMESPACE_STIR
+
+#endif
@@ -0,0 +1,187 @@
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+
+  \file
+  \ingroup buildblock
+
+  \brief Declaration of functions for a thread-local pool of memory blocks, and stir::BufferPoolAllocator
+
+  Temporaries such as Viewgram, Sinogram and the vectors in ProjMatrixElemsForOneBin are allocated
+  and freed millions of times during an iterative reconstruction. Instead of returning their memory
+  to the system, it is kept in a per-thread cache organised in size-classes, such that the next
+  temporary of the same size can reuse it without calling \c malloc, and without any locking.
+
+  \author STIR contributors
+*/
+
+#ifndef __stir_buffer_pool_h__
+#define __stir_buffer_pool_h__
+
+#include "stir/Array.h"
+#include "stir/shared_ptr.h"
+#include <cstddef>
+#include <string>
+#include <type_traits>
+
+START_NAMESPACE_STIR
+
+//! Statistics of the buffer pool, summed over all threads
+/*! \ingroup buildblock
+  Every thread keeps its own counters, which are only summed when the statistics are requested.
+*/
+struct BufferPoolStatistics
+{
+  //! number of blocks requested from the pool
+  std::size_t num_requests;
+  //! number of requests that were satisfied from the cache
+  std::size_t num_reuses;
+  //! number of blocks allocated from the system (i.e. cache misses, or blocks that are too large to cache)
+  std::size_t num_system_allocations;
+  //! number of bytes in blocks currently handed out by the pool
+  std::size_t bytes_in_use;
+  //! maximum of \c bytes_in_use since the last reset_buffer_pool_statistics()
+  /*! This is the sum of the peaks of every thread, and therefore an upper bound of the real peak.
+      It is only accurate when blocks are freed by the thread that allocated them.
+  */
+  std::size_t peak_bytes_in_use;
+};
+
+//! Get a block of (uninitialised) memory of at least \a num_bytes from the pool of the current thread
+/*! \ingroup buildblock
+  The block is aligned as for <code>::operator new</code>. It has to be returned via
+  deallocate_to_buffer_pool() with the same \a num_bytes (but possibly from a different thread).
+*/
+void* allocate_from_buffer_pool(std::size_t num_bytes);
+
+//! Return a block obtained via allocate_from_buffer_pool() to the pool of the current thread
+/*! \ingroup buildblock
+  If keeping the block would exceed get_buffer_pool_max_cached_bytes(), it is freed instead.
+
+  A block freed by another thread than the one that allocated it is kept by the pool of the
+  freeing thread, not returned to the pool of the allocating thread. This avoids any locking.
+  However, if one thread allocates blocks and another one frees them (as in a producer/consumer
+  pattern), the first thread will not reuse them.
+*/
+void deallocate_to_buffer_pool(void* ptr, std::size_t num_bytes) noexcept;
+
+//! Free all blocks that are cached by the pool of the current thread
+/*! \ingroup buildblock */
+void release_buffer_pool_memory();
+
+//! Set the maximum number of bytes that every thread will keep in its cache (default 16 MB)
+/*! \ingroup buildblock
+  Setting this to 0 effectively disables the pool.
+*/
+void set_buffer_pool_max_cached_bytes(std::size_t max_cached_bytes);
+
+//! Get the maximum number of bytes that every thread will keep in its cache
+/*! \ingroup buildblock */
+std::size_t get_buffer_pool_max_cached_bytes();
+
+//! Get the allocation statistics of the pool, summed over all threads
+/*! \ingroup buildblock */
+BufferPoolStatistics get_buffer_pool_statistics();
+
+//! Reset the counters of the statistics (aside from \c bytes_in_use)
+/*! \ingroup buildblock */
+void reset_buffer_pool_statistics();
+
+//! Get the peak resident set size of the current process in bytes
+/*! \ingroup buildblock
+  Returns 0 if this is not supported on the current system.
+*/
+std::size_t get_peak_resident_set_size();
+
+//! Write allocation counts and peak memory use via info()
+/*! \ingroup buildblock
+  This is the hook used by distributable_computation() etc to report on memory usage.
+  Nothing is written if the current verbosity is lower than \a verbosity_level.
+*/
+void report_memory_statistics(const std::string& context, const int verbosity_level = 2);
+
+//! An allocator using the thread-local buffer pool, suitable for standard containers
+/*! \ingroup buildblock */
+template <typename T>
+class BufferPoolAllocator
+{
+public:
+  typedef T value_type;
+
+  BufferPoolAllocator() noexcept = default;
+  template <typename U>
+  BufferPoolAllocator(const BufferPoolAllocator<U>&) noexcept
+  {}
+
+  T* allocate(const std::size_t n)
+  {
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "BufferPoolAllocator does not support over-aligned types");
+    return static_cast<T*>(allocate_from_buffer_pool(n * sizeof(T)));
+  }
+  void deallocate(T* const p, const std::size_t n) noexcept
+  {
+    deallocate_to_buffer_pool(p, n * sizeof(T));
+  }
+};
+
+template <typename T, typename U>
+inline bool
+operator==(const BufferPoolAllocator<T>&, const BufferPoolAllocator<U>&)
+{
+  return true;
+}
+
+template <typename T, typename U>
+inline bool
+operator!=(const BufferPoolAllocator<T>&, const BufferPoolAllocator<U>&)
+{
+  return false;
+}
+
+//! Allocate a block of \a num_elements from the buffer pool, which is returned to the pool when no longer used
+/*! \ingroup buildblock
+  The elements are not initialised. Only types that do not need construction/destruction are supported.
+*/
+template <typename elemT>
+inline shared_ptr<elemT[]>
+make_shared_buffer_from_pool(const std::size_t num_elements)
+{
+  static_assert(std::is_trivially_default_constructible<elemT>::value && std::is_trivially_destructible<elemT>::value,
+                "make_shared_buffer_from_pool only works for trivial types");
+  const std::size_t num_bytes = num_elements * sizeof(elemT);
+  elemT* const ptr = static_cast<elemT*>(allocate_from_buffer_pool(num_bytes));
+  return shared_ptr<elemT[]>(
+      ptr, [num_bytes](elemT* p) { deallocate_to_buffer_pool(p, num_bytes); }, BufferPoolAllocator<char>());
+}
+
+//! Construct an Array with all elements set to 0, using memory from the buffer pool if possible
+/*! \ingroup buildblock
+  For element types that cannot use make_shared_buffer_from_pool(), this is equivalent to
+  <code>Array<num_dimensions, elemT>(range)</code>.
+*/
+template <int num_dimensions, typename elemT>
+inline Array<num_dimensions, elemT>
+make_array_using_buffer_pool(const IndexRange<num_dimensions>& range)
+{
+  if constexpr (std::is_arithmetic<elemT>::value)
+    {
+      const std::size_t size = range.size_all();
+      Array<num_dimensions, elemT> array(range, make_shared_buffer_from_pool<elemT>(size));
+      array.fill(elemT(0));
+      return array;
+    }
+  else
+    {
+      return Array<num_dimensions, elemT>(range);
+    }
+}
+
+END_NAMESPACE_STIR
+
+#endif
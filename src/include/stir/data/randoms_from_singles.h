@@ -22,6 +22,7 @@
 START_NAMESPACE_STIR
 
 class ProjData;
+class DynamicProjData;
 class SinglesRates;
 
 /*!
@@ -72,4 +73,21 @@ void randoms_from_singles(ProjData& proj_data,
                           float coincidence_time_window = -1.F,
                           float radionuclide_halflife = -1.F);
 
+/*!
+  \ingroup singles_buildblock
+  \brief Estimate randoms from singles (RFS) for all time frames
+
+  \param[in,out] proj_data
+     Projection data to store output, one per time frame, as given by its time frame definitions.
+     All frames need to have the same ProjDataInfo.
+
+  This is the same as calling randoms_from_singles(ProjData&, const SinglesRates&, float, float) for every frame,
+  but the detector pairs of every sinogram are only found once, and all frames are computed together
+  (in parallel if OpenMP is enabled).
+*/
+void randoms_from_singles(DynamicProjData& proj_data,
+                          const SinglesRates& singles,
+                          float coincidence_time_window = -1.F,
+                          float radionuclide_halflife = -1.F);
+
 END_NAMESPACE_STIR
@@ -0,0 +1,64 @@
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup buildblock
+  \brief Declaration of stir::fnv1a_hash functions
+
+  \author STIR contributors
+*/
+
+#ifndef __stir_hash_H__
+#define __stir_hash_H__
+
+#include "stir/common.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+START_NAMESPACE_STIR
+
+/*!
+  \ingroup buildblock
+  \name Functions for computing a 64-bit FNV-1a hash
+
+  The hash is stable across platforms and runs (unlike \c std::hash), such that it can be
+  used for the names of files in a cache. Pass the result of a previous call as \a hash to
+  continue hashing more data.
+*/
+//@{
+
+//! initial value of the 64-bit FNV-1a hash
+constexpr std::uint64_t fnv1a_hash_init = 14695981039346656037ULL;
+
+//! 64-bit FNV-1a hash of \a num_bytes bytes starting at \a data
+inline std::uint64_t
+fnv1a_hash(const void* const data, const std::size_t num_bytes, std::uint64_t hash = fnv1a_hash_init)
+{
+  const unsigned char* const bytes = static_cast<const unsigned char*>(data);
+  for (std::size_t i = 0; i < num_bytes; ++i)
+    {
+      hash ^= bytes[i];
+      hash *= 1099511628211ULL;
+    }
+  return hash;
+}
+
+//! 64-bit FNV-1a hash of a string
+inline std::uint64_t
+fnv1a_hash(const std::string& str, const std::uint64_t hash = fnv1a_hash_init)
+{
+  return fnv1a_hash(str.data(), str.size(), hash);
+}
+
+//@}
+
+END_NAMESPACE_STIR
+
+#endif
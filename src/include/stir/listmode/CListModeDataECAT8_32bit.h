@@ -57,6 +57,10 @@ public:
 
   Succeeded set_get_position(const SavedPosition&) override;
 
+  Succeeded get_persistent_position(PersistentPosition&) override;
+
+  Succeeded set_persistent_position(const PersistentPosition&) override;
+
   //! returns \c true, as ECAT listmode data stores delayed events (and prompts)
   /*! \todo this might depend on the acquisition parameters */
   bool has_delayeds() const override { return true; }
@@ -56,10 +56,28 @@ public:
 
   Succeeded set_get_position(const SavedPosition&) override;
 
+  Succeeded get_persistent_position(PersistentPosition&) override;
+
+  Succeeded set_persistent_position(const PersistentPosition&) override;
+
   //! returns \c false, as GEHDF5 listmode data does not store delayed events (and prompts)
   /*! \todo this depends on the acquisition parameters */
   bool has_delayeds() const override { return false; }
 
+  //! \name Buffering of the list mode data (see InputStreamWithRecordsFromHDF5)
+  /*! Changing these reopens the list mode data. Saved positions are kept, but reading restarts
+      at the beginning of the data.
+  */
+  //@{
+  //! Set the size (in bytes) of every buffer (defaults to 10000000)
+  void set_read_buffer_size(const std::size_t);
+  std::size_t get_read_buffer_size() const;
+  //! Set the number of buffers (defaults to 2)
+  /*! If larger than 1, the data are read ahead in a background thread. Use 1 to read all data in get_next_record(). */
+  void set_num_read_buffers(const int);
+  int get_num_read_buffers() const;
+  //@}
+
 private:
   //  shared_ptr<GEHDF5Wrapper> input_sptr;
 
@@ -68,8 +86,12 @@ private:
   shared_ptr<InputStreamWithRecordsFromHDF5<CListRecordT>> current_lm_data_ptr;
   unsigned long first_time_stamp;
   unsigned long lm_duration_in_millisecs;
+  std::size_t read_buffer_size;
+  int num_read_buffers;
 
   Succeeded open_lm_file();
+  //! (re)creates current_lm_data_ptr
+  void open_input_stream();
 };
 
 } // namespace RDF_HDF5
@@ -124,6 +124,10 @@ public:
 
   Succeeded set_get_position(const SavedPosition&) override;
 
+  Succeeded get_persistent_position(PersistentPosition&) override;
+
+  Succeeded set_persistent_position(const PersistentPosition&) override;
+
   bool has_delayeds() const override { return true; }
 
   inline unsigned long int get_total_number_of_events() const override;
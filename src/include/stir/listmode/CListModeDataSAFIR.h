@@ -84,6 +84,12 @@ public:
   SavedPosition save_get_position() override { return static_cast<SavedPosition>(current_lm_data_ptr->save_get_position()); }
   Succeeded set_get_position(const SavedPosition& pos) override { return current_lm_data_ptr->set_get_position(pos); }
 
+  Succeeded get_persistent_position(PersistentPosition& pos) override { return current_lm_data_ptr->get_current_offset(pos); }
+  Succeeded set_persistent_position(const PersistentPosition& pos) override
+  {
+    return current_lm_data_ptr->set_current_offset(pos);
+  }
+
   /*!
   Returns just false in the moment.
   \todo Implement this properly to check for delayed events in LM files.
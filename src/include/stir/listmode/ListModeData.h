@@ -27,7 +27,9 @@
 #include "stir/ExamData.h"
 #include "stir/RegisteredParsingObject.h"
 #include "stir/listmode/ListRecord.h"
+#include "stir/Succeeded.h"
 #include "stir/error.h"
+#include <cstdint>
 #ifdef BOOST_NO_STDC_NAMESPACE
 namespace std
 {
@@ -39,6 +41,7 @@ START_NAMESPACE_STIR
 class ListRecord;
 class Succeeded;
 class ExamInfo;
+class ListModeTimeIndex;
 
 /*!
   \brief The base class for reading list mode data.
@@ -110,6 +113,16 @@ class ExamInfo;
     error("Help!");
   \endcode
 
+  Finally, if a time index has been set (see ListModeTimeIndex), you can skip
+  to (just before) a given time without reading all records before it.
+
+  \code
+  lm_data_sptr->set_time_index_sptr(time_index_sptr);
+  if (lm_data_sptr->seek_to_time(current_time, start_time) == Succeeded::no)
+    { lm_data_sptr->reset(); current_time = 0; }
+  // now skip remaining records until start_time as usual
+  \endcode
+
   Currently, this class (and ListRecord) is generic for emission modalities
   such as PET and  SPECT.
 
@@ -129,6 +142,9 @@ public:
   //! Use this typedef for save/set_get_position
   typedef unsigned int SavedPosition;
 
+  //! Use this typedef for get/set_persistent_position
+  typedef std::uint64_t PersistentPosition;
+
   //! Default constructor
   ListModeData();
 
@@ -210,6 +226,44 @@ public:
 
   virtual Succeeded set_get_position(const SavedPosition&) = 0;
 
+  //! Get the current reading position in a form that can be stored in a file
+  /*!
+      In contrast to save_get_position(), the result remains valid when the same
+      data is read again (e.g. it is a byte offset in the file), and can therefore
+      be used for a ListModeTimeIndex.
+
+      The default implementation returns Succeeded::no, indicating that the
+      derived class does not support this. Succeeded::no is also returned at the
+      end of the data.
+  */
+  virtual Succeeded get_persistent_position(PersistentPosition&) { return Succeeded::no; }
+
+  //! Set the reading position to a value found by get_persistent_position()
+  /*! The default implementation returns Succeeded::no. */
+  virtual Succeeded set_persistent_position(const PersistentPosition&) { return Succeeded::no; }
+
+  //! Set the time index used by seek_to_time()
+  /*! \warning There is no check that the index was constructed for this data. */
+  void set_time_index_sptr(const shared_ptr<const ListModeTimeIndex>&);
+
+  //! Get the time index (could be a null pointer)
+  shared_ptr<const ListModeTimeIndex> get_time_index_sptr() const;
+
+  //! Skip to the last indexed time tag before \a time_in_secs
+  /*!
+      Uses the time index to set the reading position just after the last indexed
+      time tag with a time strictly smaller than \a time_in_secs.
+      \a time_of_new_position is then set to the time of that time tag. Records
+      read afterwards have a time that is at least equal to this value. The caller
+      still needs to skip records until \a time_in_secs is reached, but this
+      normally involves only a small number of records.
+
+      Returns Succeeded::no if there is no time index or if it has no suitable entry.
+      The reading position is then unchanged. Succeeded::no is also returned if the
+      position could not be set, in which case the reading position is undefined.
+  */
+  Succeeded seek_to_time(double& time_of_new_position, const double time_in_secs);
+
   //! Get reference to scanner
   /*! Returns a reference to a scanner object that is appropriate for the
       list mode data that is being read.
@@ -237,6 +291,9 @@ protected:
   //  shared_ptr<ExamInfo> exam_info_sptr;
   //! Has to be initialised by the derived class
   shared_ptr<const ProjDataInfo> proj_data_info_sptr;
+
+private:
+  shared_ptr<const ListModeTimeIndex> time_index_sptr;
 };
 
 END_NAMESPACE_STIR
@@ -0,0 +1,111 @@
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup listmode
+  \brief Declaration of class stir::ListModeTimeIndex
+
+  \author STIR contributors
+*/
+
+#ifndef __stir_listmode_ListModeTimeIndex_H__
+#define __stir_listmode_ListModeTimeIndex_H__
+
+#include "stir/listmode/ListModeData.h"
+#include "stir/Succeeded.h"
+#include <string>
+#include <vector>
+
+START_NAMESPACE_STIR
+
+/*!
+  \brief A list of (time, position) pairs allowing to skip through list mode data
+  \ingroup listmode
+
+  Going to a particular time in list mode data normally means reading all records
+  from the start of the file. This class stores the persistent reading position
+  (see ListModeData::get_persistent_position()) just after a time tag, roughly
+  every \c interval secs. It can be set on a ListModeData object such that
+  ListModeData::seek_to_time() can skip most of the data.
+
+  The index is normally stored in a "sidecar" file next to the list mode data
+  (see get_default_filename()). It is constructed by going through the whole
+  list mode data once, either via the \c build_lm_time_index utility, or when
+  LmToProjData is asked to use an index that does not exist yet.
+
+  \par File format
+  A text file with a first line identifying the file, followed by the interval,
+  the number of entries and one line per entry with the time (in secs) and the
+  position.
+  \verbatim
+  STIR list mode time index version 1.0
+  interval (s) := 1
+  number of entries := 5400
+  0.001 1024
+  ...
+  \endverbatim
+
+  \warning There is no check that the index corresponds to the list mode data
+  on which it is used. Rebuild the index if the list mode file is changed.
+*/
+class ListModeTimeIndex
+{
+public:
+  typedef ListModeData::PersistentPosition PersistentPosition;
+
+  //! An entry in the index
+  struct Entry
+  {
+    //! time of the time tag (as returned by ListTime::get_time_in_secs())
+    double time_in_secs;
+    //! persistent position just after the time tag
+    PersistentPosition position;
+  };
+
+  //! Name of the "sidecar" file used by default for the list mode data in \a lm_filename
+  static std::string get_default_filename(const std::string& lm_filename);
+
+  //! Construct an empty index
+  ListModeTimeIndex();
+
+  //! Construct by reading the index from file (calls error() if this fails)
+  explicit ListModeTimeIndex(const std::string& filename);
+
+  //! Fill the index by going through all records in \a lm_data
+  /*! An entry is added for the first time tag, and subsequently for every time tag
+      which is at least \a interval_in_secs later than the previous entry.
+      \a lm_data is reset at the end.
+
+      Returns Succeeded::no if \a lm_data does not support persistent positions.
+  */
+  Succeeded build(ListModeData& lm_data, const double interval_in_secs);
+
+  //! Read from file, returns Succeeded::no if the file cannot be opened or is not a valid index
+  Succeeded read_from_file(const std::string& filename);
+
+  //! Write to file
+  Succeeded write_to_file(const std::string& filename) const;
+
+  //! Find the last entry with a time strictly smaller than \a time_in_secs
+  /*! Returns Succeeded::no if there is no such entry. */
+  Succeeded find_entry_before(Entry& entry, const double time_in_secs) const;
+
+  double get_interval_in_secs() const { return interval_in_secs; }
+
+  const std::vector<Entry>& get_entries() const { return entries; }
+
+private:
+  double interval_in_secs;
+  //! entries, sorted in increasing time
+  std::vector<Entry> entries;
+};
+
+END_NAMESPACE_STIR
+
+#endif
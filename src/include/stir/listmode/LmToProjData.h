@@ -33,11 +33,17 @@
 #include "stir/TimeFrameDefinitions.h"
 
 #include "stir/recon_buildblock/BinNormalisation.h"
+#include "stir/VectorWithOffset.h"
+#include <functional>
+#include <vector>
 
 START_NAMESPACE_STIR
 
 class ListEvent;
 class ListTime;
+class ListRecord;
+template <typename elemT>
+class SegmentByView;
 
 /*!
   \ingroup listmode
@@ -112,6 +118,21 @@ class ListTime;
     num_segments_in_memory := -1
     ; same for TOF bins
     num_TOF_bins_in_memory := 1
+
+    ; optional file with a time index for the list mode data (see ListModeTimeIndex).
+    ; If it exists, it is used to skip directly to the start of every time frame.
+    ; If not, it will be created first (which needs a pass through all list mode data).
+    time index filename :=
+    ; interval between entries when creating the time index
+    time index interval (in secs) := 1
+    ; number of parts in which every time frame is split (at entries of the time index).
+    ; These are histogrammed in parallel (if OpenMP is enabled), see below.
+    number of parallel time chunks := 1
+
+    ; compress the output projection data (see ProjDataCompressed) with the given zlib
+    ; compression level (1 is fastest, 9 gives the smallest files).
+    ; 0 (the default) writes uncompressed Interfile data.
+    output compression level := 0
   End :=
   \endverbatim
 
@@ -146,6 +167,22 @@ class ListTime;
   </li>
   </ul>
 
+  \par Processing time chunks in parallel
+
+  If a time index is used and <tt>number of parallel time chunks</tt> is larger than 1,
+  every time frame is split into that many chunks at entries of the index. Each chunk
+  is read by a separate ListModeData object (opened from the same file) and
+  histogrammed by its own thread into a partial projection data, which are summed at the
+  end. Time tags are handled such that every event is assigned to the same time frame
+  as when reading the data sequentially. The result is therefore identical (up to
+  floating point rounding when normalisation is used), but needs more memory (one
+  extra projection data, or segment range, per thread). If <tt>num_segments_in_memory</tt>
+  is set (i.e. not -1), it is taken as the limit for all these copies together, i.e. the
+  segments are processed in smaller batches (with at least 1 segment per thread).
+
+  This is currently only possible when using time frames (i.e. not with
+  <tt>num_events_to_store</tt>), and when not listing event coordinates.
+
   \par Notes for developers
 
   The class provides several
@@ -231,6 +268,18 @@ public:
   long int get_num_events_to_store() const;
   void set_time_frame_definitions(const TimeFrameDefinitions&);
   const TimeFrameDefinitions& get_time_frame_definitions() const;
+  //! Set the name of the time index file (empty means no time index)
+  /*! \see the \c time index filename keyword */
+  void set_time_index_filename(const std::string&);
+  std::string get_time_index_filename() const;
+  //! Set the number of time chunks in which every time frame is split
+  /*! \see the \c number of parallel time chunks keyword */
+  void set_num_parallel_time_chunks(const int);
+  int get_num_parallel_time_chunks() const;
+  //! Set the compression level for the output (0 means no compression)
+  /*! \see the \c output compression level keyword */
+  void set_output_compression_level(const int);
+  int get_output_compression_level() const;
   //@}
 
   //! Perform various checks
@@ -255,6 +304,9 @@ protected:
   virtual void start_new_time_frame(const unsigned int new_frame_num);
 
   //! will be called after a new timing event is found in the file
+  /*! \warning When processing time chunks in parallel, this function is called by multiple
+      threads, and not necessarily in chronological order.
+  */
   virtual void process_new_time_event(const ListTime&);
 
   //! will be called to get the bin for a coincidence event
@@ -265,6 +317,56 @@ protected:
     normalisation or angle info for a rotating scanner.*/
   virtual void get_bin_from_event(Bin& bin, const ListEvent&) const;
 
+  //! will be called to get the bin for an event when processing time chunks in parallel
+  /*! \a event_num_in_chunk counts the events (i.e. ListRecord::is_event()) in the chunk, starting
+      from 0. The default implementation calls get_bin_from_event(Bin&, const ListEvent&).
+      \warning This function is called by multiple threads.
+  */
+  virtual void get_bin_from_event_in_time_chunk(Bin& bin,
+                                                const ListEvent&,
+                                                const unsigned int chunk_num,
+                                                const unsigned long event_num_in_chunk) const;
+
+  //! Returns \c true if the time chunks of a frame can be processed in parallel
+  /*! This requires that get_bin_from_event_in_time_chunk() and process_new_time_event() can be
+      called from multiple threads, and do not depend on the order in which events are
+      processed. The default implementation returns \c true only for LmToProjData itself, as derived
+      classes might change their state while processing events. Derived classes need to override
+      this to enable processing time chunks in parallel.
+  */
+  virtual bool can_process_time_chunks_in_parallel() const;
+
+  //! Information on a part of a time frame, see find_time_chunks()
+  struct TimeChunk
+  {
+    //! If \c true, reading starts at \c start_position, otherwise at the start of the frame
+    bool has_start_position;
+    //! Position just after the time tag that starts the chunk
+    ListModeData::PersistentPosition start_position;
+    //! Time of the time tag at \c start_position (or start of the frame)
+    double start_time;
+    //! Reading stops at the first time tag with a time larger than or equal to \c end_time
+    /*! If \c is_last_chunk_in_frame is \c false, this time tag is still part of this chunk.
+        Otherwise, it ends the frame and is not processed. A negative value means reading until
+        the end of the data. */
+    double end_time;
+    bool is_last_chunk_in_frame;
+  };
+
+  //! Divide a time frame in (at most) \a num_chunks chunks using entries of the time index
+  /*! Returns a single chunk if there is no time index, or if the frame is too short. */
+  std::vector<TimeChunk> find_time_chunks(const double start_time, const double end_time, const int num_chunks) const;
+
+  //! Go through all records of a time chunk
+  /*! A new ListModeData object is read from file for this, such that this function
+      can be called from multiple threads.
+      \a process_record is called for every record, together with the time of the last
+      time tag (or of the record itself if it is a time tag).
+      Returns Succeeded::no if the data could not be read or positioned.
+  */
+  Succeeded for_each_record_in_time_chunk(const TimeChunk& chunk,
+                                          const std::function<void(const ListRecord&, const double)>& process_record) const;
+
   //! A function that should return the number of uncompressed bins in the current bin
   /*! \todo it is not compatiable with e.g. HiDAC doesn't belong here anyway
       (more ProjDataInfo?)
@@ -305,6 +407,15 @@ protected:
   /*! corresponds to key "list event coordinates" */
   bool interactive;
 
+  //! file with the time index, see ListModeTimeIndex
+  std::string time_index_filename;
+  //! interval used when creating the time index
+  double time_index_interval_in_secs;
+  //! number of chunks that every time frame is split into
+  int num_parallel_time_chunks;
+  //! zlib compression level for the output, 0 means no compression
+  int output_compression_level;
+
   shared_ptr<ProjDataInfo> template_proj_data_info_ptr;
   //! This will be used for pre-normalisation
   shared_ptr<BinNormalisation> normalisation_ptr;
@@ -340,6 +451,22 @@ protected:
 
   //! an internal bool variable to check if the object has been set-up or not
   bool _already_setup;
+
+  //! time chunks for the current time frame (only set if they are processed in parallel)
+  std::vector<TimeChunk> time_chunks;
+
+private:
+  //! Histogram the current time frame into \a segments by processing time_chunks in parallel
+  void process_time_chunks(VectorWithOffset<VectorWithOffset<SegmentByView<float>*>>& segments,
+                           const int start_timing_pos_index,
+                           const int end_timing_pos_index,
+                           const int start_segment_index,
+                           const int end_segment_index,
+                           const shared_ptr<const ProjDataInfo>& output_proj_data_info_sptr,
+                           long& num_prompts_in_frame,
+                           long& num_delayeds_in_frame,
+                           long& num_stored_events,
+                           double& time_of_last_stored_event);
 };
 
 END_NAMESPACE_STIR
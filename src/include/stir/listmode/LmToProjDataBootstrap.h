@@ -46,9 +46,10 @@ START_NAMESPACE_STIR
   There are various papers on the bootstrap method. For PET data, it was
   for example applied by I. Buvat. (TODO add references)
 
-  The pseudo-random number generator used is boost::mt19937 which should be
-  good enough for most purposes. However, it can be easily replaced by any
-  generator that follows the boost conventions.
+  The pseudo-random numbers are generated with the counter-based generator
+  Philox4x32 (see CounterBasedRandomNumbers), such that every draw is a pure function of
+  the seed and the draw number. The draws are therefore done in parallel (if OpenMP
+  is enabled), while the result does not depend on the number of threads.
 
   \par Parsing
   This class implements just one keyword in addition to those made
@@ -57,6 +58,12 @@ START_NAMESPACE_STIR
   ; an unsigned int (but not 0) to seed the pseudo-random number generator
   seed := 42 ; default value
   \endverbatim
+
+  When LmToProjData processes a frame in parallel time chunks (see its
+  \c number of parallel time chunks keyword), the events are counted per chunk.
+  The random replication is still generated for the whole frame, so the result
+  is the same as when processing the frame sequentially, and does not depend on the number of threads.
+
   \par Notes for developers
 
   This class is templated in terms of a LmToProjDataT to allow
@@ -84,6 +91,15 @@ protected:
 
   void get_bin_from_event(Bin& bin, const ListEvent&) const override;
 
+  void get_bin_from_event_in_time_chunk(Bin& bin,
+                                        const ListEvent&,
+                                        const unsigned int chunk_num,
+                                        const unsigned long event_num_in_chunk) const override;
+
+  //! Returns \c true when used with LmToProjData itself
+  /*! get_bin_from_event_in_time_chunk() only depends on the number of the event in the chunk */
+  bool can_process_time_chunks_in_parallel() const override;
+
   // \name parsing variables
   //@{
   //! used to seed the pseudo-random number generator
@@ -97,6 +113,13 @@ private:
 
   replication_type num_times_to_replicate;
   mutable replication_type::const_iterator num_times_to_replicate_iter;
+  //! index in num_times_to_replicate of the first event in every time chunk
+  std::vector<unsigned long> first_event_num_in_chunk;
+
+  //! count events in the frame by reading from the current position of the list mode data
+  unsigned int count_events_in_frame(const unsigned int frame_num);
+  //! count events in the frame by reading the time chunks in parallel
+  unsigned int count_events_in_time_chunks();
   void set_defaults() override;
   void initialise_keymap() override;
   bool post_processing() override;
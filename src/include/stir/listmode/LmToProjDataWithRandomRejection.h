@@ -25,8 +25,6 @@
 #define __stir_listmode_LmToProjDataWithRandomRejection_H__
 
 #include "stir/listmode/LmToProjData.h"
-#include <boost/random/uniform_01.hpp>
-#include <boost/random/mersenne_twister.hpp>
 
 START_NAMESPACE_STIR
 
@@ -47,9 +45,13 @@ START_NAMESPACE_STIR
   There are various papers on the bootstrap method. For PET data, it was
   for example applied by I. Buvat. (TODO add references)
 
-  The pseudo-random number generator used is boost::mt19937 which should be
-  good enough for most purposes. However, it can be easily replaced by any
-  generator that follows the boost conventions.
+  The pseudo-random numbers are generated with the counter-based generator
+  Philox4x32 (see CounterBasedRandomNumbers), such that the decision for every event is a
+  pure function of the seed and the number of the event in the frame. When LmToProjData
+  processes a frame in parallel time chunks (see its \c number of parallel time chunks keyword),
+  the number of the time chunk and the number of the event in the chunk are used instead.
+  The result therefore does not depend on the number of threads, but does depend on
+  the number of time chunks.
 
   \par Parsing
   This class implements just one keyword in addition to those made
@@ -88,6 +90,15 @@ protected:
 
   void get_bin_from_event(Bin& bin, const ListEvent&) const override;
 
+  void get_bin_from_event_in_time_chunk(Bin& bin,
+                                        const ListEvent&,
+                                        const unsigned int chunk_num,
+                                        const unsigned long event_num_in_chunk) const override;
+
+  //! Returns \c true when used with LmToProjData itself
+  /*! get_bin_from_event_in_time_chunk() only depends on the number of the event in the chunk */
+  bool can_process_time_chunks_in_parallel() const override;
+
   // \name parsing variables
   //@{
   //! used to seed the pseudo-random number generator
@@ -98,8 +109,11 @@ protected:
 
 private:
   typedef LmToProjDataT base_type;
-  typedef boost::mt19937 random_generator_type;
-  random_generator_type random_generator;
+  //! number of events in the current frame seen by get_bin_from_event()
+  mutable unsigned long event_num_in_frame;
+
+  //! Set \a bin to the event, or set its value to -1 if the event is rejected
+  void reject_or_get_bin(Bin& bin, const ListEvent&, const unsigned int chunk_num, const unsigned long event_num) const;
 
   void set_defaults() override;
   void initialise_keymap() override;
@@ -23,6 +23,7 @@
 #include "stir/BasicCoordinate.h"
 #include "stir/VectorWithOffset.h"
 #include "stir/DynamicDiscretisedDensity.h"
+#include "stir/VoxelMajorDynamicDensity.h"
 #include "stir/modelling/ParametricDiscretisedDensity.h"
 #include "stir/Succeeded.h"
 #include <fstream>
@@ -105,6 +106,17 @@ public:
   inline void multiply_parametric_image_with_model(DynamicDiscretisedDensity& dynamic_image,
                                                    const ParametricVoxelsOnCartesianGrid& parametric_image) const;
 
+  //! multiply (transpose) model-matrix with voxel-major dynamic image and add result to original \c parametric_image
+  inline void multiply_dynamic_image_with_model_and_add_to_input(ParametricVoxelsOnCartesianGrid& parametric_image,
+                                                                 const VoxelMajorDynamicDensity& dynamic_image) const;
+  //! multiply (transpose) model-matrix with voxel-major dynamic image (overwriting original content of \c parametric_image)
+  inline void multiply_dynamic_image_with_model(ParametricVoxelsOnCartesianGrid& parametric_image,
+                                                const VoxelMajorDynamicDensity& dynamic_image) const;
+  //! multiply model-matrix with parametric image (overwriting original content of \c dynamic_image)
+  /*! Frames that are not in the model are set to 0. */
+  inline void multiply_parametric_image_with_model(VoxelMajorDynamicDensity& dynamic_image,
+                                                   const ParametricVoxelsOnCartesianGrid& parametric_image) const;
+
   inline void normalise_parametric_image_with_model_sum(ParametricVoxelsOnCartesianGrid& parametric_image_out,
                                                         const ParametricVoxelsOnCartesianGrid& parametric_image) const;
   //@}
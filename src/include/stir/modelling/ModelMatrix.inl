@@ -18,6 +18,7 @@
 */
 
 #include <algorithm>
+#include <vector>
 #include "stir/warning.h"
 #include "stir/error.h"
 START_NAMESPACE_STIR
@@ -255,24 +256,43 @@ ModelMatrix<num_param>::multiply_dynamic_image_with_model_and_add_to_input(Param
   assert(dynamic_image.get_time_frame_definitions().get_num_frames() == static_cast<unsigned int>(model_array_max[2]));
   assert(model_array_max[1] - model_array_min[1] + 1 == num_param);
 
+  const int min_param_num = model_array_min[1];
+  const int max_param_num = model_array_max[1];
+  const int min_frame_num = model_array_min[2];
+  const int max_frame_num = model_array_max[2];
   const int min_k_index = dynamic_image[1].get_min_index();
   const int max_k_index = dynamic_image[1].get_max_index();
+  // Work per row of voxels (fixed k,j). Each frame contributes a contiguous row of voxels, which is accumulated
+  // into a parameter-major buffer such that the inner loop runs over consecutive voxels (and can be vectorised).
+  // The order of the summation over frames is the same as for a voxel-by-voxel loop.
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
   for (int k = min_k_index; k <= max_k_index; ++k)
     {
+      std::vector<float> sums;
       const int min_j_index = dynamic_image[1][k].get_min_index();
       const int max_j_index = dynamic_image[1][k].get_max_index();
       for (int j = min_j_index; j <= max_j_index; ++j)
         {
           const int min_i_index = dynamic_image[1][k][j].get_min_index();
           const int max_i_index = dynamic_image[1][k][j].get_max_index();
+          const int num_voxels = max_i_index - min_i_index + 1;
+          sums.assign(static_cast<std::size_t>(num_param * num_voxels), 0.F);
+          for (int frame_num = min_frame_num; frame_num <= max_frame_num; ++frame_num)
+            {
+              const float* const frame_row = &dynamic_image[frame_num][k][j][min_i_index];
+              for (int param_num = min_param_num; param_num <= max_param_num; ++param_num)
+                {
+                  const float model_value = this->_model_array[param_num][frame_num];
+                  float* const param_sums = &sums[(param_num - min_param_num) * num_voxels];
+                  for (int i = 0; i < num_voxels; ++i)
+                    param_sums[i] += model_value * frame_row[i];
+                }
+            }
           for (int i = min_i_index; i <= max_i_index; ++i)
-            for (int param_num = model_array_min[1]; param_num <= model_array_max[1]; ++param_num)
-              {
-                float sum_over_frames = 0.F;
-                for (int frame_num = model_array_min[2]; frame_num <= model_array_max[2]; ++frame_num)
-                  sum_over_frames += this->_model_array[param_num][frame_num] * dynamic_image[frame_num][k][j][i];
-                parametric_image[k][j][i][param_num] += sum_over_frames;
-              }
+            for (int param_num = min_param_num; param_num <= max_param_num; ++param_num)
+              parametric_image[k][j][i][param_num] += sums[(param_num - min_param_num) * num_voxels + (i - min_i_index)];
         }
     }
 }
@@ -302,24 +322,43 @@ ModelMatrix<num_param>::multiply_parametric_image_with_model_and_add_to_input(
   assert(dynamic_image.get_time_frame_definitions().get_num_frames() == static_cast<unsigned int>(model_array_max[2]));
   assert(model_array_max[1] - model_array_min[1] + 1 == num_param);
 
+  const int min_param_num = model_array_min[1];
+  const int max_param_num = model_array_max[1];
+  const int min_frame_num = model_array_min[2];
+  const int max_frame_num = model_array_max[2];
   const int min_k_index = dynamic_image[1].get_min_index();
   const int max_k_index = dynamic_image[1].get_max_index();
+  // As above, work per row of voxels. The kinetic parameters of the row are first copied into a
+  // parameter-major buffer, such that every frame-row can be computed with loops over consecutive voxels.
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
   for (int k = min_k_index; k <= max_k_index; ++k)
     {
+      std::vector<float> params;
       const int min_j_index = dynamic_image[1][k].get_min_index();
       const int max_j_index = dynamic_image[1][k].get_max_index();
       for (int j = min_j_index; j <= max_j_index; ++j)
         {
           const int min_i_index = dynamic_image[1][k][j].get_min_index();
           const int max_i_index = dynamic_image[1][k][j].get_max_index();
+          const int num_voxels = max_i_index - min_i_index + 1;
+          params.resize(static_cast<std::size_t>(num_param * num_voxels));
           for (int i = min_i_index; i <= max_i_index; ++i)
-            for (int frame_num = model_array_min[2]; frame_num <= model_array_max[2]; ++frame_num)
-              {
-                float sum_over_param = 0.F;
-                for (int param_num = model_array_min[1]; param_num <= model_array_max[1]; ++param_num)
-                  sum_over_param += parametric_image[k][j][i][param_num] * this->_model_array[param_num][frame_num];
-                dynamic_image[frame_num][k][j][i] = sum_over_param;
-              }
+            for (int param_num = min_param_num; param_num <= max_param_num; ++param_num)
+              params[(param_num - min_param_num) * num_voxels + (i - min_i_index)] = parametric_image[k][j][i][param_num];
+          for (int frame_num = min_frame_num; frame_num <= max_frame_num; ++frame_num)
+            {
+              float* const frame_row = &dynamic_image[frame_num][k][j][min_i_index];
+              std::fill(frame_row, frame_row + num_voxels, 0.F);
+              for (int param_num = min_param_num; param_num <= max_param_num; ++param_num)
+                {
+                  const float model_value = this->_model_array[param_num][frame_num];
+                  const float* const param_row = &params[(param_num - min_param_num) * num_voxels];
+                  for (int i = 0; i < num_voxels; ++i)
+                    frame_row[i] += param_row[i] * model_value;
+                }
+            }
         }
     }
 }
@@ -333,6 +372,105 @@ ModelMatrix<num_param>::multiply_parametric_image_with_model(DynamicDiscretisedD
   this->multiply_parametric_image_with_model_and_add_to_input(dynamic_image, parametric_image);
 }
 
+template <int num_param>
+void
+ModelMatrix<num_param>::multiply_dynamic_image_with_model_and_add_to_input(ParametricVoxelsOnCartesianGrid& parametric_image,
+                                                                           const VoxelMajorDynamicDensity& dynamic_image) const
+{
+  BasicCoordinate<2, int> model_array_min, model_array_max;
+  if (!this->_model_array.get_regular_range(model_array_min, model_array_max))
+    error("Model array has not regular range");
+
+  assert(dynamic_image.get_index_range() == parametric_image.get_index_range());
+  assert(dynamic_image.get_num_time_frames() == static_cast<unsigned int>(model_array_max[2]));
+  assert(model_array_max[1] - model_array_min[1] + 1 == num_param);
+
+  const int min_frame_num = model_array_min[2];
+  const int max_frame_num = model_array_max[2];
+  const int min_k_index = dynamic_image.get_index_range().get_min_index();
+  const int max_k_index = dynamic_image.get_index_range().get_max_index();
+  // The time-activity curve of every voxel is contiguous, so we can directly compute the inner products.
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
+  for (int k = min_k_index; k <= max_k_index; ++k)
+    {
+      const int min_j_index = dynamic_image[k].get_min_index();
+      const int max_j_index = dynamic_image[k].get_max_index();
+      for (int j = min_j_index; j <= max_j_index; ++j)
+        {
+          const int min_i_index = dynamic_image[k][j].get_min_index();
+          const int max_i_index = dynamic_image[k][j].get_max_index();
+          for (int i = min_i_index; i <= max_i_index; ++i)
+            {
+              const float* const tac_ptr = &dynamic_image[k][j][i][min_frame_num];
+              for (int param_num = model_array_min[1]; param_num <= model_array_max[1]; ++param_num)
+                {
+                  const float* const model_ptr = &this->_model_array[param_num][min_frame_num];
+                  float sum_over_frames = 0.F;
+                  for (int f = 0; f <= max_frame_num - min_frame_num; ++f)
+                    sum_over_frames += model_ptr[f] * tac_ptr[f];
+                  parametric_image[k][j][i][param_num] += sum_over_frames;
+                }
+            }
+        }
+    }
+}
+
+template <int num_param>
+void
+ModelMatrix<num_param>::multiply_dynamic_image_with_model(ParametricVoxelsOnCartesianGrid& parametric_image,
+                                                          const VoxelMajorDynamicDensity& dynamic_image) const
+{
+  std::fill(parametric_image.begin_all(), parametric_image.end_all(), 0.F);
+  this->multiply_dynamic_image_with_model_and_add_to_input(parametric_image, dynamic_image);
+}
+
+template <int num_param>
+void
+ModelMatrix<num_param>::multiply_parametric_image_with_model(VoxelMajorDynamicDensity& dynamic_image,
+                                                             const ParametricVoxelsOnCartesianGrid& parametric_image) const
+{
+  BasicCoordinate<2, int> model_array_min, model_array_max;
+  if (!(this->_model_array).get_regular_range(model_array_min, model_array_max))
+    error("Model array does not have a regular range");
+
+  assert(dynamic_image.get_index_range() == parametric_image.get_index_range());
+  assert(dynamic_image.get_num_time_frames() == static_cast<unsigned int>(model_array_max[2]));
+  assert(model_array_max[1] - model_array_min[1] + 1 == num_param);
+
+  const int min_frame_num = model_array_min[2];
+  const int max_frame_num = model_array_max[2];
+  const int min_k_index = dynamic_image.get_index_range().get_min_index();
+  const int max_k_index = dynamic_image.get_index_range().get_max_index();
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
+  for (int k = min_k_index; k <= max_k_index; ++k)
+    {
+      const int min_j_index = dynamic_image[k].get_min_index();
+      const int max_j_index = dynamic_image[k].get_max_index();
+      for (int j = min_j_index; j <= max_j_index; ++j)
+        {
+          const int min_i_index = dynamic_image[k][j].get_min_index();
+          const int max_i_index = dynamic_image[k][j].get_max_index();
+          for (int i = min_i_index; i <= max_i_index; ++i)
+            {
+              VoxelMajorDynamicDensity::TACType& tac = dynamic_image[k][j][i];
+              tac.fill(0.F);
+              float* const tac_ptr = &tac[min_frame_num];
+              for (int param_num = model_array_min[1]; param_num <= model_array_max[1]; ++param_num)
+                {
+                  const float param_value = parametric_image[k][j][i][param_num];
+                  const float* const model_ptr = &this->_model_array[param_num][min_frame_num];
+                  for (int f = 0; f <= max_frame_num - min_frame_num; ++f)
+                    tac_ptr[f] += param_value * model_ptr[f];
+                }
+            }
+        }
+    }
+}
+
 template <int num_param>
 void
 ModelMatrix<num_param>::normalise_parametric_image_with_model_sum(ParametricVoxelsOnCartesianGrid& parametric_image_out,
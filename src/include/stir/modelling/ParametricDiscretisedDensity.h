@@ -31,6 +31,7 @@ class ParametricDiscretisedDensity;
 
 /// Forward declaration of dynamic image
 class DynamicDiscretisedDensity;
+class VoxelMajorDynamicDensity;
 
 //! A helper class to find the type of a 'single' image for a corresponding parametric image.
 template <typename DiscDensT>
@@ -97,6 +98,10 @@ public:
   /*! Uses only its geometric/exam info and timing */
   ParametricDiscretisedDensity(const DynamicDiscretisedDensity& dyn_im);
 
+  /// Create blank parametric image from a voxel-major dynamic image
+  /*! Uses only its geometric/exam info and timing */
+  ParametricDiscretisedDensity(const VoxelMajorDynamicDensity& dyn_im);
+
   /// Create blank parametric image from a single VoxelsOnCartesianGrid
   /*! Uses only its geometric/exam info and timing */
   ParametricDiscretisedDensity(const SingleDiscretisedDensityType& im);
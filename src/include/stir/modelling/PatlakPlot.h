@@ -122,6 +122,20 @@ public:
   */
   void apply_linear_regression(ParametricVoxelsOnCartesianGrid& par_image, const DynamicDiscretisedDensity& dyn_image) const;
 
+  /*! \name Versions for a VoxelMajorDynamicDensity
+    These give the same results as the versions for a DynamicDiscretisedDensity, but as the
+    time-activity curve of every voxel is contiguous, no copying or gathering of the data is needed.
+  */
+  //@{
+  void multiply_dynamic_image_with_model_gradient(ParametricVoxelsOnCartesianGrid& parametric_image,
+                                                  const VoxelMajorDynamicDensity& dyn_image) const;
+  void multiply_dynamic_image_with_model_gradient_and_add_to_input(ParametricVoxelsOnCartesianGrid& parametric_image,
+                                                                   const VoxelMajorDynamicDensity& dyn_image) const;
+  void get_dynamic_image_from_parametric_image(VoxelMajorDynamicDensity& dyn_image,
+                                               const ParametricVoxelsOnCartesianGrid& par_image) const;
+  void apply_linear_regression(ParametricVoxelsOnCartesianGrid& par_image, const VoxelMajorDynamicDensity& dyn_image) const;
+  //@}
+
   void set_defaults() override;
 
   Succeeded set_up() override;
@@ -140,6 +154,8 @@ public:
 
 private:
   void create_model_matrix(); //!< Creates model matrix from private members
+  //! Scales the model matrix according to the grid spacing of the image (if not done yet)
+  void scale_model_matrix_for_image(const VoxelMajorDynamicDensity& dyn_image) const;
   void initialise_keymap() override;
   bool post_processing() override;
   mutable ModelMatrix<2> _model_matrix;
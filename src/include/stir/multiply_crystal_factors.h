@@ -18,6 +18,8 @@
 */
 
 #include "stir/ArrayFwd.h"
+#include "stir/shared_ptr.h"
+#include <vector>
 
 START_NAMESPACE_STIR
 
@@ -41,10 +43,31 @@ class ProjData;
   \warning If TOF data is used, each TOF bin will be set to 1/num_tof_bins the non-TOF value.
   This is appropriate for RFS, but would be confusing when using for normalisation.
 
+  The sum over the crystal pairs is computed per sinogram as a sum over its ring pairs of the
+  products of the efficiencies of both rings. The detector pairs for every view and tangential position
+  are only found once. Sinograms are computed in parallel when OpenMP is enabled.
+
   \warning, the name is a bit misleading. This function does currently <strong>not</strong> multiply
   the existing data with the efficiencies, but overwrites it.
 
 */
 void multiply_crystal_factors(ProjData& proj_data, const ArrayType<2, float>& efficiencies, const float global_factor);
 
+/*!
+  \ingroup projdata
+
+  \brief Construct several proj-data (e.g. for different time frames) as a multiple of crystal efficiencies
+
+  \param[in,out] proj_data_sptrs projection data to write output, one per set of efficiencies.
+     All need to have the same ProjDataInfo.
+  \param[in] efficiencies arrays of factors, one per crystal
+  \param[in] global_factors global additional factor to use for every output
+
+  This gives the same result as calling multiply_crystal_factors(ProjData&, const ArrayType<2, float>&, const float)
+  for every output, but the geometric information is only computed once.
+*/
+void multiply_crystal_factors(const std::vector<shared_ptr<ProjData>>& proj_data_sptrs,
+                              const std::vector<ArrayType<2, float>>& efficiencies,
+                              const std::vector<float>& global_factors);
+
 END_NAMESPACE_STIR
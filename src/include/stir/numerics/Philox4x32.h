@@ -0,0 +1,151 @@
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup numerics
+  \brief Declaration and implementation of the counter-based random number generator stir::Philox4x32
+  and the helper class stir::CounterBasedRandomNumbers
+
+  \author STIR contributors
+*/
+
+#ifndef __stir_numerics_Philox4x32_H__
+#define __stir_numerics_Philox4x32_H__
+
+#include "stir/common.h"
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+START_NAMESPACE_STIR
+
+/*!
+  \ingroup numerics
+  \brief The Philox4x32-10 counter-based pseudo-random number generator
+
+  A counter-based generator computes its output as a (bijective) function of a counter
+  and a key, and has no other state. This means that random numbers can be generated
+  in any order, e.g. in parallel, and still give reproducible results. Typically, the key
+  is derived from the seed and the counter from the index of the element that needs a
+  random number.
+
+  See J. K. Salmon, M. A. Moraes, R. O. Dror and D. E. Shaw,
+  <i>Parallel random numbers: as easy as 1, 2, 3</i>,
+  Proc. Int. Conf. High Performance Computing, Networking, Storage and Analysis (SC11), 2011.
+  The output is identical to the \c philox4x32 generator of the Random123 library.
+*/
+class Philox4x32
+{
+public:
+  typedef std::array<std::uint32_t, 4> counter_type;
+  typedef std::array<std::uint32_t, 2> key_type;
+
+  //! Return 4 random 32-bit integers for the given counter and key
+  static inline counter_type generate(counter_type counter, key_type key)
+  {
+    for (int round = 0; round < 10; ++round)
+      {
+        if (round > 0)
+          {
+            key[0] += 0x9E3779B9U;
+            key[1] += 0xBB67AE85U;
+          }
+        const std::uint64_t product0 = std::uint64_t(0xD2511F53U) * counter[0];
+        const std::uint64_t product1 = std::uint64_t(0xCD9E8D57U) * counter[2];
+        counter = { static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^ key[0],
+                    static_cast<std::uint32_t>(product1),
+                    static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^ key[1],
+                    static_cast<std::uint32_t>(product0) };
+      }
+    return counter;
+  }
+};
+
+/*!
+  \ingroup numerics
+  \brief A stream of random numbers that is a pure function of a seed and an index
+
+  This uses Philox4x32 with the \a seed as key and the \a index (and \a stream_num)
+  as counter. Every object therefore gives its own sequence of (up to 2<sup>32</sup>
+  blocks of 4) random numbers, independent of other objects. This is intended to be used as
+  \code
+  // in a (parallel) loop over i
+  CounterBasedRandomNumbers random_numbers(seed, i);
+  const double u = random_numbers.uniform01();
+  \endcode
+  Construction is cheap, as no random numbers are generated until they are needed.
+*/
+class CounterBasedRandomNumbers
+{
+public:
+  //! Constructor
+  /*! \a stream_num can be used to get different sequences for the same \a index. */
+  CounterBasedRandomNumbers(const std::uint64_t seed, const std::uint64_t index, const std::uint32_t stream_num = 0)
+      : key{ { static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32) } },
+        counter{ { static_cast<std::uint32_t>(index), static_cast<std::uint32_t>(index >> 32), stream_num, 0U } },
+        num_used(4),
+        has_cached_normal(false)
+  {}
+
+  //! Next random 32-bit integer
+  std::uint32_t next_uint32()
+  {
+    if (num_used == 4)
+      {
+        block = Philox4x32::generate(counter, key);
+        ++counter[3];
+        num_used = 0;
+      }
+    return block[num_used++];
+  }
+
+  //! Uniformly distributed number in the open interval (0,1)
+  /*! Uses 53 random bits */
+  double uniform01()
+  {
+    const std::uint64_t high = next_uint32() >> 5;
+    const std::uint64_t low = next_uint32() >> 6;
+    return ((high << 26 | low) + 0.5) / 9007199254740992.; // 2^53
+  }
+
+  //! Uniformly distributed integer between 0 and \a n-1
+  /*! Uses Lemire's multiply-and-shift method, whose bias is negligible for \a n much smaller than 2<sup>32</sup>. */
+  std::uint32_t uniform_int(const std::uint32_t n)
+  {
+    return static_cast<std::uint32_t>((std::uint64_t(next_uint32()) * n) >> 32);
+  }
+
+  //! Normally distributed number with mean 0 and standard deviation 1
+  /*! Uses the Box-Muller transform. */
+  double normal()
+  {
+    if (has_cached_normal)
+      {
+        has_cached_normal = false;
+        return cached_normal;
+      }
+    const double radius = std::sqrt(-2 * std::log(uniform01()));
+    const double angle = 2 * _PI * uniform01();
+    cached_normal = radius * std::sin(angle);
+    has_cached_normal = true;
+    return radius * std::cos(angle);
+  }
+
+private:
+  const Philox4x32::key_type key;
+  Philox4x32::counter_type counter;
+  Philox4x32::counter_type block;
+  int num_used;
+  bool has_cached_normal;
+  double cached_normal;
+};
+
+END_NAMESPACE_STIR
+
+#endif
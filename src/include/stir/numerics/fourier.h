@@ -91,6 +91,9 @@ inverse_fourier(T& c, const int sign = 1)
   <tt>operator+=(T::reference, T::value_type)</tt> and
   <tt>operator*=(T::reference, int)</tt>,
    have to be defined as well.
+
+  The complex exponentials ("twiddle factors") are computed once for every length and cached
+  (per thread), such that repeated FFTs of the same size do not recompute them.
 */
 template <typename T>
 void fourier_1d(T& c, const int sign);
@@ -25,11 +25,14 @@
 #include "stir/Bin.h"
 #include "stir/shared_ptr.h"
 #include "stir/deprecated.h"
+#include <string>
 
 START_NAMESPACE_STIR
 
 template <typename elemT>
 class RelatedViewgrams;
+template <typename elemT>
+class Viewgram;
 class Succeeded;
 class ProjDataInfo;
 class ProjData;
@@ -85,13 +88,39 @@ public:
   */
   virtual float get_bin_efficiency(const Bin& bin) const = 0;
 
+  //! Return the 'efficiency' factors for all bins in a viewgram
+  /*! On input, \a efficiencies determines the segment, view and timing position numbers
+    and the index ranges. On output, it contains \f$\mathrm{norm}_b \f$ for every bin.
+
+    The default implementation calls get_bin_efficiency() for every bin. Derived classes
+    should override this if they can evaluate a whole viewgram more efficiently, e.g. by
+    computing factors that are common to many bins only once.
+  */
+  virtual void get_efficiencies_for_viewgram(Viewgram<float>& efficiencies) const;
+
+  //! Return a string that identifies the normalisation factors
+  /*! This is used as key for caches of quantities that depend on the values of the factors,
+    such as the sensitivity image of the Poisson log-likelihood. Two objects returning the same
+    string are expected to have the same factors for the projection data given to set_up().
+
+    The default implementation returns a hash of the factors of all bins (found via
+    get_efficiencies_for_viewgram()), such that the key changes when the data used by the
+    normalisation (e.g. a norm file or a time frame) change, even if the file names do not.
+    The hash is computed only once, and kept until set_up() is called with different
+    ExamInfo or ProjDataInfo, or clear_efficiencies_key_info() is called.
+    Derived classes can override this with something cheaper.
+
+    \warning set_up() has to be called first.
+  */
+  virtual std::string get_efficiencies_key_info() const;
+
   //! normalise some data
   /*!
     This would be used for instance to precorrect unnormalised data. With the
     notation of the class documentation, this would \c divide by the factors
     \f$\mathrm{norm}_b \f$.
 
-    Default implementation divides with the factors returned by get_bin_efficiency()
+    Default implementation divides with the factors returned by get_efficiencies_for_viewgram()
     (after applying a threshold to avoid division by 0).
   */
   virtual void apply(RelatedViewgrams<float>&) const;
@@ -103,7 +132,7 @@ public:
     notation of the class documentation, this would \c multiply by the factors
     \f$\mathrm{norm}_b \f$.
 
-    Default implementation multiplies with the factors returned by get_bin_efficiency().
+    Default implementation multiplies with the factors returned by get_efficiencies_for_viewgram().
   */
   virtual void undo(RelatedViewgrams<float>&) const;
 
@@ -146,11 +175,20 @@ protected:
   virtual void check(const ProjDataInfo& proj_data_info) const;
 
   virtual void check(const ExamInfo& exam_info) const;
+
+  //! forget the stored result of get_efficiencies_key_info()
+  /*! Derived classes need to call this when their factors change other than via set_defaults()
+      or set_up() with different arguments.
+   */
+  void clear_efficiencies_key_info() const;
+
   bool _already_set_up;
   shared_ptr<const ProjDataInfo> proj_data_info_sptr;
 
 private:
   shared_ptr<const ExamInfo> exam_info_sptr;
+  //! result of the default get_efficiencies_key_info(), empty if not computed yet
+  mutable std::string efficiencies_key_info;
 };
 
 END_NAMESPACE_STIR
@@ -41,15 +41,38 @@ START_NAMESPACE_STIR
 
   \warning Attenuation image data are supposed to be in units cm^-1.
     (Reference: water has mu .096 cm^-1.)
-  \todo Add mechanism for caching the attenuation correction factors, such that they will
-  be calculated only once. However, caching should by default be disabled, as most
-  applications need them only once anyway.
+
+  \par Precomputing the attenuation correction factors
+  By default, the attenuation image is forward projected every time apply() or undo() is called,
+  which is fine when every viewgram is needed only once (as in \c correct_projdata). In iterative
+  reconstruction, the same viewgrams are needed in every sub-iteration. It is then much faster to
+  enable precomputation: set_up() then forward projects the attenuation image once (in parallel if
+  OpenMP is enabled), and apply() and undo() only read the stored line integrals.
+  Calling set_up() again with the same projection data geometry reuses the stored values.
+
+  The line integrals are stored in memory, unless a cache directory is set. In that case, they are
+  written to a file in that directory whose name is a hash of the content and geometry of the
+  attenuation image, the forward projector settings and the projection data geometry. When the
+  file exists already (e.g. from a previous run), it is read instead of forward projecting again.
+  The settings are stored as well (in a \c .txt file) to protect against hash collisions.
+
+  With reduced precision, the line integrals are stored as 16-bit integers with a step of 1/4096,
+  halving the storage. Line integrals are then clipped to the range [0,16), and the relative error
+  in the attenuation correction factors is at most 1.3e-4.
+
+  When precomputing, the attenuation correction factors are computed for non-TOF data, such that
+  TOF data can be handled as well.
 
   \par Parsing details
   \verbatim
   Bin Normalisation From Attenuation Image:=
   attenuation_image_filename := <ASCII>
   forward projector type := <ASCII>
+  ; optional keywords, see above
+  ; precompute attenuation correction factors := 0
+  ; store attenuation correction factors with reduced precision := 0
+  ; setting this implies precomputation
+  ; attenuation correction factors cache directory :=
   End Bin Normalisation From Attenuation Image :=
   \endverbatim
 */
@@ -108,12 +131,51 @@ public:
 
   void undo(RelatedViewgrams<float>& viewgrams) const override;
 
+  //! Return 1/ACF for all bins in a viewgram
+  /*! This is only implemented when the attenuation correction factors are precomputed. */
+  void get_efficiencies_for_viewgram(Viewgram<float>& efficiencies) const override;
+
   float get_bin_efficiency(const Bin& bin) const override;
 
+  //! Returns a description of the settings, including a hash of the attenuation image
+  /*! This avoids computing all attenuation correction factors. */
+  std::string get_efficiencies_key_info() const override;
+
+  //! \name Functions to set parameters
+  /*! These have to be called before set_up() */
+  //@{
+  //! Enable or disable precomputation of the attenuation correction factors in set_up()
+  void set_precompute_attenuation_correction_factors(const bool);
+  //! Store the precomputed attenuation line integrals as 16-bit integers
+  void set_use_reduced_precision(const bool);
+  //! Set the directory where precomputed attenuation line integrals are stored (enables precomputation)
+  /*! An empty string means that the values are kept in memory. */
+  void set_attenuation_correction_factors_cache_directory(const std::string&);
+  //@}
+
+  bool get_precompute_attenuation_correction_factors() const;
+
 private:
   shared_ptr<const DiscretisedDensity<3, float>> attenuation_image_ptr;
   shared_ptr<ForwardProjectorByBin> forward_projector_ptr;
 
+  bool precompute_attenuation_correction_factors;
+  bool use_reduced_precision;
+  std::string cache_directory;
+
+  //! precomputed line integrals of the attenuation image (non-TOF), or null
+  shared_ptr<const ProjData> line_integrals_sptr;
+  //! description of everything that determined \c line_integrals_sptr
+  std::string line_integrals_key_info;
+
+  //! Compute a description of the settings, including a hash of the attenuation image
+  std::string get_line_integrals_key_info(const ProjDataInfo& proj_data_info) const;
+  //! Precompute the line integrals, or read them from the cache
+  void set_up_line_integrals(const shared_ptr<const ExamInfo>& exam_info_sptr,
+                             const shared_ptr<const ProjDataInfo>& proj_data_info_sptr);
+  //! Get the attenuation correction factors for the same bins as \a viewgrams
+  RelatedViewgrams<float> get_attenuation_correction_factors(const RelatedViewgrams<float>& viewgrams) const;
+
   // parsing stuff
   void set_defaults() override;
   void initialise_keymap() override;
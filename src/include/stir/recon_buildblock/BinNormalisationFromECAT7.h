@@ -70,7 +70,6 @@ START_NAMESPACE_ECAT7
 
   \par Warning
   dead-time code might currently give wrong results due to uncertainty in units for singles rates
-
 */
 class BinNormalisationFromECAT7
     : public RegisteredParsingObject<BinNormalisationFromECAT7, BinNormalisation, BinNormalisationWithCalibration>
@@ -95,6 +94,12 @@ public:
 
   virtual Succeeded set_up(const shared_ptr<const ExamInfo>& exam_info_sptr, const shared_ptr<const ProjDataInfo>&) override;
   float get_uncalibrated_bin_efficiency(const Bin& bin) const override;
+  //! Compute uncalibrated efficiencies for a whole viewgram
+  /*! Gives the same result as get_uncalibrated_bin_efficiency() for every bin, but the detector numbers
+    are computed only once for all axial positions, and the inner loop is over the tangential positions.
+    When dead-time is used, the per-bin code is called.
+  */
+  void get_uncalibrated_efficiencies_for_viewgram(Viewgram<float>& efficiencies) const override;
 
   bool use_detector_efficiencies() const;
   bool use_dead_time() const;
@@ -107,6 +107,12 @@ public:
 
   Succeeded set_up(const shared_ptr<const ExamInfo>& exam_info_sptr, const shared_ptr<const ProjDataInfo>&) override;
   float get_uncalibrated_bin_efficiency(const Bin& bin) const override;
+  //! Compute uncalibrated efficiencies for a whole viewgram
+  /*! Gives the same result as get_uncalibrated_bin_efficiency() for every bin, but the detector numbers
+    and axial effects are computed only once for all tangential positions, and the inner loop is over the
+    tangential positions (such that the compiler can vectorise it).
+  */
+  void get_uncalibrated_efficiencies_for_viewgram(Viewgram<float>& efficiencies) const override;
 
   bool use_detector_efficiencies() const;
   bool use_dead_time() const;
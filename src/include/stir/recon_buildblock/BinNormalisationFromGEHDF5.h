@@ -69,7 +69,6 @@ class GEHDF5Wrapper;
 
   \todo dead-time is not yet implemented
 
-
 */
 class BinNormalisationFromGEHDF5
     : public RegisteredParsingObject<BinNormalisationFromGEHDF5, BinNormalisation, BinNormalisationWithCalibration>
@@ -94,6 +93,11 @@ public:
 
   Succeeded set_up(const shared_ptr<const ExamInfo>& exam_info_sptr, const shared_ptr<const ProjDataInfo>&) override;
   float get_uncalibrated_bin_efficiency(const Bin& bin) const override;
+  //! Compute uncalibrated efficiencies for a whole viewgram
+  /*! Gives the same result as get_uncalibrated_bin_efficiency() for every bin, but the tangential detector
+    coordinates are computed only once for all axial positions.
+  */
+  void get_uncalibrated_efficiencies_for_viewgram(Viewgram<float>& efficiencies) const override;
 
   bool use_detector_efficiencies() const;
   bool use_dead_time() const;
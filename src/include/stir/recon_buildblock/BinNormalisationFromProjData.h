@@ -107,6 +107,12 @@ public:
   void undo(RelatedViewgrams<float>& viewgrams) const override;
   float get_bin_efficiency(const Bin& bin) const override;
 
+  //! Return the efficiencies for a viewgram
+  /*! This reads the viewgram from the projdata object and returns its inverse.
+    Bins where the projdata contains 0 get an efficiency 0.
+  */
+  void get_efficiencies_for_viewgram(Viewgram<float>& efficiencies) const override;
+
   //! Get a shared_ptr to the normalisation proj_data.
   virtual shared_ptr<ProjData> get_norm_proj_data_sptr() const;
 
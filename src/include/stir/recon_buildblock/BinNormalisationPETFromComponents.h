@@ -116,6 +116,9 @@ public:
 
   float get_bin_efficiency(const Bin& bin) const override;
 
+  //! Return the efficiencies for a viewgram (read from the internal projection data)
+  void get_efficiencies_for_viewgram(Viewgram<float>& efficiencies) const override;
+
 #if 0
   //! Get a shared_ptr to the normalisation proj_data.
   virtual shared_ptr<ProjData> get_norm_proj_data_sptr() const;
@@ -45,9 +45,17 @@ public:
 
   void read_norm_data(const std::string& filename);
   Succeeded set_up(const shared_ptr<const ExamInfo>& exam_info_sptr, const shared_ptr<const ProjDataInfo>&) override;
-  void set_num_views(int num_views) const { this->num_views = num_views; }
-
-  void set_uniformity(Array<3, float>& uniformity) { this->down_sampled_uniformity = uniformity; }
+  void set_num_views(int num_views) const
+  {
+    this->num_views = num_views;
+    this->clear_efficiencies_key_info();
+  }
+
+  void set_uniformity(Array<3, float>& uniformity)
+  {
+    this->down_sampled_uniformity = uniformity;
+    this->clear_efficiencies_key_info();
+  }
 
   bool use_dead_time() const;
   bool use_detector_efficiencies() const;
@@ -68,6 +68,17 @@ public:
     return this->get_uncalibrated_bin_efficiency(bin) / this->_calib_decay_branching_ratio;
   }
 
+  //! Return uncalibrated efficiencies for all bins in a viewgram
+  /*! Default implementation calls get_uncalibrated_bin_efficiency() for every bin.
+    \see BinNormalisation::get_efficiencies_for_viewgram()
+  */
+  virtual void get_uncalibrated_efficiencies_for_viewgram(Viewgram<float>& efficiencies) const;
+
+  //! return efficiencies for a viewgram
+  /*! uses get_uncalibrated_efficiencies_for_viewgram() and divides by the calibration factor etc
+   */
+  void get_efficiencies_for_viewgram(Viewgram<float>& efficiencies) const final;
+
 protected:
   // parsing stuff
   void set_defaults() override;
@@ -130,6 +130,9 @@ public:
 
   float get_bin_efficiency(const Bin& bin) const override;
 
+  //! Combines the keys of the 2 BinNormalisation members
+  std::string get_efficiencies_key_info() const override;
+
   //! Returns the is_trivial() status of the first normalisation object.
   //! \warning Currently, if the object has not been set the function throws an error.
   virtual bool is_first_trivial() const;
@@ -38,6 +38,9 @@ template <typename elemT>
 class SegmentBySinogram;
 // template <typename elemT> class Sinogram;
 class Succeeded;
+class ProjData;
+class ProjDataInfo;
+class DynamicProjData;
 
 /*
   \class PETCount_rebinned
@@ -58,6 +61,7 @@ public:
 #ifdef PARALLEL
   friend PMessage& operator<<(PMessage&, PETCount_rebinned&);
   friend PMessage& operator>>(PMessage&, PETCount_rebinned&);
+#endif
 
   PETCount_rebinned& operator+=(const PETCount_rebinned& rebin)
   {
@@ -66,7 +70,6 @@ public:
     ssrb += rebin.ssrb;
     return *this;
   }
-#endif
   // Default constructor by initialising all the elements conter to null
   explicit PETCount_rebinned(int total_v = 0, int miss_v = 0, int ssrb_v = 0)
       : total(total_v),
@@ -108,6 +111,14 @@ public:
   Therefore the rebinned data are estimated using only the oblique sinograms with
   a small value of d : dlim. Owing to the small value of d, the axial shift can be
   neglected as in the SSRB approximation.
+
+  \par Parallelisation
+  When STIR is compiled with OpenMP, the FFTs of all sinograms in a segment are computed in parallel
+  (with a buffer per thread). The accumulation into the rebinned data in Fourier space is then
+  parallelised over the angular frequency index, such that the result does not depend on the
+  number of threads. Finally, the inverse FFTs of the rebinned sinograms are computed in parallel.
+  Note that the FFT twiddle factors are cached (see fourier_1d()) and are therefore reused
+  for all sinograms.
 */
 
 class FourierRebinning : public RegisteredParsingObject<FourierRebinning, ProjDataRebinning, ProjDataRebinning>
@@ -142,6 +153,17 @@ public:
   //! This method creates a stack of 2D rebinned sinograms from the whole 3D data set (i.e. the ProjData data) and saves it.
   Succeeded rebin() override;
 
+  //! Rebin all frames of dynamic projection data in one call
+  /*!
+    \a rebinned_dyn_proj_data will be resized to the number of frames and filled with
+    (in memory) 2D rebinned data. All frames have to have the same geometry, such that
+    the set-up (and FFT twiddle factors) can be shared between frames.
+    \c output_filename_prefix and the input data set via parsing or set_input_proj_data_sptr() are not used.
+    As for set_up(), a \c max_segment_num_to_process of -1 is replaced by the maximum segment number
+    of the first frame.
+  */
+  Succeeded rebin(DynamicProjData& rebinned_dyn_proj_data, const DynamicProjData& dyn_proj_data);
+
   //! A set of get and set utility functions to access the rebinning parameters
   inline void set_kmin(int km) { kmin = km; }
   inline void set_wmin(int wm) { wmin = wm; }
@@ -164,6 +186,8 @@ private:
     and returns the updated stack of 2D rebinned sinograms still in Fourier space,
     the updated weigthing factors as well as  the new rebinned elements counter.
 
+    Only angular frequency indices \c i between \a min_i and \a max_i are processed.
+    This allows parallelisation without race conditions.
 
   */
   void rebinning(ArrayType<3, std::complex<float>>& FT_rebinned_data,
@@ -178,7 +202,9 @@ private:
                  const float sampling_distance_in_s,
                  const float radial_sampling_freq_w,
                  const float R_field_of_view_mm,
-                 const float ratio_ring_spacing_to_ring_radius);
+                 const float ratio_ring_spacing_to_ring_radius,
+                 const int min_i,
+                 const int max_i);
 
   /*!
     \brief This method takes as input the real 3D data set
@@ -222,7 +248,14 @@ private:
   void do_adjust_nb_views_to_pow2(SegmentBySinogram<float>& segment);
 
   //! This function checks if the steering and input paramters for FORE are inside the possible range of parameters
-  Succeeded fore_check_parameters(int num_tang_poss_pow2, int num_views_pow2, int max_segment_num_to_process);
+  Succeeded
+  fore_check_parameters(int num_tang_poss_pow2, int num_views_pow2, int max_segment_num_to_process, const ProjData& proj_data);
+
+  //! Construct the projection data info for the rebinned data
+  shared_ptr<ProjDataInfo> create_rebinned_proj_data_info(const ProjDataInfo& proj_data_info) const;
+
+  //! Rebin \a proj_data into \a rebinned_proj_data, which has to be constructed with create_rebinned_proj_data_info()
+  Succeeded rebin_proj_data(ProjData& rebinned_proj_data, const ProjData& proj_data);
 
 protected:
   bool post_processing() override;
@@ -101,8 +101,24 @@ START_NAMESPACE_STIR
   ; e.g. subsens_%d.hv
   ; fmt::format is used with the pattern
   subset sensitivity filenames:=
+  ; directory where computed sensitivities are cached (see below)
+  ; defaults to the value of the environment variable STIR_SENSITIVITY_CACHE_DIRECTORY
+  sensitivity cache directory:=
   \endverbatim
 
+  \par Sensitivity cache
+  If the sensitivity needs to be computed because no filenames were set, and a sensitivity cache
+  directory is set, the (subset) sensitivities are read from the cache if they were computed before
+  with the same settings. Otherwise, they are written to the cache after computation. The settings
+  are found from get_sensitivity_cache_key_info() (i.e. the projection data geometry, projectors,
+  normalisation etc) and the geometry of the target, which are hashed to create the filenames.
+  The settings are also stored in the cache to protect against hash collisions.
+  The normalisation is described by the values of its factors (see
+  BinNormalisation::get_efficiencies_key_info()), such that changing the normalisation data (or
+  the time frame) results in a different key, even if the filenames are the same. The measured
+  data do not influence the sensitivity, so only their geometry is used.
+  The cache is not used when \c recompute_sensitivity is set by the user.
+
   \par Terminology
   We currently use \c sub_gradient for the gradient of the likelihood of the subset (not
   the mathematical subgradient).
@@ -165,6 +181,8 @@ public:
   const TargetT& get_sensitivity() const;
   //! Get a const reference to the sensitivity for a subset
   const TargetT& get_subset_sensitivity(const int subset_num) const;
+  //! Get the subset sensitivity sptr
+  shared_ptr<TargetT> get_subset_sensitivity_sptr(const int subset_num) const;
 
   //! Add subset sensitivity to existing data
   virtual void add_subset_sensitivity(TargetT& sensitivity, const int subset_num) const = 0;
@@ -188,6 +206,9 @@ public:
   fmt::format is used with the pattern
  */
   std::string get_subsensitivity_filenames() const;
+  //! get directory used for caching sensitivities
+  /*! will be a zero string if caching is disabled */
+  std::string get_sensitivity_cache_directory() const;
 
   /*! \name Functions to set parameters
     This can be used as alternative to the parsing mechanism.
@@ -197,6 +218,12 @@ public:
   */
   //@{
   void set_recompute_sensitivity(const bool);
+  //! Set a subset sensitivity
+  /*! When the sensitivity is not recomputed and no (subset) sensitivity filename(s) are set,
+      set_up() will use the sensitivities that were set with this function (or computed by an
+      earlier call to set_up()). If subset sensitivities are not used, only the one for
+      subset 0 is used.
+  */
   void set_subset_sensitivity_sptr(const shared_ptr<TargetT>&, const int subset_num);
 
   //! See get_use_subset_sensitivities()
@@ -213,6 +240,9 @@ public:
   Calls error() if the pattern is invalid.
  */
   void set_subsensitivity_filenames(const std::string&);
+  //! set directory used for caching sensitivities
+  /*! set to a zero-length string to disable the cache */
+  void set_sensitivity_cache_directory(const std::string&);
   //@}
 
   /*! The implementation checks if the sensitivity of a voxel is zero. If so,
@@ -223,14 +253,16 @@ public:
 private:
   std::string sensitivity_filename;
   std::string subsensitivity_filenames;
+  std::string sensitivity_cache_directory;
   bool recompute_sensitivity;
+  //! \c true if \c recompute_sensitivity was set by set_up() because no filenames were given
+  /*! In this case, the cache can be used, also when calling set_up() again. */
+  bool recompute_sensitivity_is_implicit;
   bool use_subset_sensitivities;
 
   VectorWithOffset<shared_ptr<TargetT>> subsensitivity_sptrs;
   shared_ptr<TargetT> sensitivity_sptr;
 
-  //! Get the subset sensitivity sptr
-  shared_ptr<TargetT> get_subset_sensitivity_sptr(const int subset_num) const;
   //! compute total from subsensitivity or vice versa
   /*! This function will be called by set_up() after reading new images, and/or
       by compute_sensitivities().
@@ -241,6 +273,14 @@ private:
   */
   void set_total_or_subset_sensitivities();
 
+  //! find the prefix of the filenames in the sensitivity cache, and the text stored with it
+  /*! returns an empty string if the cache cannot be used */
+  std::string get_sensitivity_cache_filename_prefix(const TargetT& target, std::string& key_info) const;
+  //! try to read the sensitivities from the cache
+  bool read_sensitivities_from_cache(const TargetT& target);
+  //! write the sensitivities to the cache (if possible)
+  void write_sensitivities_to_cache(const TargetT& target) const;
+
 protected:
   //! set-up specifics for the derived class
   virtual Succeeded set_up_before_sensitivity(shared_ptr<const TargetT> const& target_sptr) = 0;
@@ -252,6 +292,12 @@ protected:
   */
   void compute_sensitivities();
 
+  //! Return a description of all settings (other than the target geometry) that determine the sensitivity
+  /*! This is used to find the sensitivity in the cache. It is called after set_up_before_sensitivity().
+      The default returns an empty string, which disables the cache.
+  */
+  virtual std::string get_sensitivity_cache_key_info() const;
+
   //! computes the subset gradient of the objective function without the penalty (optional: add subset sensitivity)
   /*!
     If \c add_sensitivity is \c true, this computes
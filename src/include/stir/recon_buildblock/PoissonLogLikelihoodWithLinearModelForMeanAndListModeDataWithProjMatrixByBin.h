@@ -115,6 +115,7 @@ public:
 
 protected:
   Succeeded set_up_before_sensitivity(shared_ptr<const TargetT> const& target_sptr) override;
+  std::string get_sensitivity_cache_key_info() const override;
 
   void add_subset_sensitivity(TargetT& sensitivity, const int subset_num) const override;
 
@@ -201,6 +201,15 @@ public:
   // N.E. Changed to ExamData
   void set_additive_proj_data_sptr(const shared_ptr<ExamData>&) override;
   void set_projector_pair_sptr(const shared_ptr<ProjectorByBinPair>&);
+  //! Only call ProjectorByBinPair::set_up() in set_up() when the projectors or the geometry have changed
+  /*! By default, set_up() always sets up the projectors again. When this is set to \c true,
+   this is only done when the projector pair, the geometry of the projection data or the
+   characteristics of the target have changed since the last call. This avoids for instance
+   clearing the cache of a projection matrix when only the data change (e.g. for a new time frame).
+   If you modify the projectors themselves after set_up(), call set_projector_pair_sptr()
+   to make sure they are set-up again.
+  */
+  void set_skip_projector_set_up_if_unchanged(const bool);
   void set_frame_num(const int);
   void set_frame_definitions(const TimeFrameDefinitions&);
   void set_normalisation_sptr(const shared_ptr<BinNormalisation>&) override;
@@ -223,6 +232,7 @@ public:
 
 protected:
   Succeeded set_up_before_sensitivity(shared_ptr<const TargetT> const& target_sptr) override;
+  std::string get_sensitivity_cache_key_info() const override;
 
   double actual_compute_objective_function_without_penalty(const TargetT& current_estimate, const int subset_num) override;
 
@@ -307,6 +317,14 @@ protected:
   //! Stores the projectors that are used for the computations
   shared_ptr<ProjectorByBinPair> projector_pair_ptr;
 
+  //! see set_skip_projector_set_up_if_unchanged()
+  bool skip_projector_set_up_if_unchanged;
+  //! projector pair and geometry used in the last call to ProjectorByBinPair::set_up()
+  /*! Used by set_up_before_sensitivity() to avoid setting up the projectors again */
+  shared_ptr<ProjectorByBinPair> projector_pair_set_up_sptr;
+  shared_ptr<const ProjDataInfo> projector_pair_set_up_proj_data_info_sptr;
+  shared_ptr<const TargetT> projector_pair_set_up_target_sptr;
+
   //! signals whether to zero the data in the end planes of the projection data
   bool zero_seg0_end_planes;
 
@@ -138,6 +138,8 @@ public:
   // void reserve_num_elements_in_cache(const std::size_t);
   //! Remove all elements from the cache
   void clear_cache() const;
+  //! Remove all elements for one view from the cache
+  void clear_cache_for_view(const int view_num) const;
 
 protected:
   shared_ptr<DataSymmetriesForBins> symmetries_sptr;
@@ -29,6 +29,7 @@
 #include "stir/recon_buildblock/SymmetryOperation.h"
 #include "stir/geometry/line_distances.h"
 #include "stir/numerics/erf.h"
+#include "stir/ProfilingRegistry.h"
 
 START_NAMESPACE_STIR
 
@@ -48,6 +49,8 @@ inline void
 ProjMatrixByBin::get_proj_matrix_elems_for_one_bin(ProjMatrixElemsForOneBin& probabilities, const Bin& bin) const
 {
   // start_timers(); TODO, can't do this in a const member
+  static ProfilingCounter cache_hits_counter("ProjMatrixByBin cache hits");
+  static ProfilingCounter cache_misses_counter("ProjMatrixByBin cache misses");
 
   // set to empty
   probabilities.erase();
@@ -62,6 +65,7 @@ ProjMatrixByBin::get_proj_matrix_elems_for_one_bin(ProjMatrixElemsForOneBin& pro
       // check if basic bin is in cache
       if (get_cached_proj_matrix_elems_for_one_bin(probabilities) == Succeeded::no)
         {
+          cache_misses_counter.add(1);
           // basic bin is not in cache, compute lor probabilities for the basic bin
           calculate_proj_matrix_elems_for_one_bin(probabilities);
 #ifndef NDEBUG
@@ -73,6 +77,8 @@ ProjMatrixByBin::get_proj_matrix_elems_for_one_bin(ProjMatrixElemsForOneBin& pro
             }
           cache_proj_matrix_elems_for_one_bin(probabilities);
         }
+      else
+        cache_hits_counter.add(1);
 
       // now transform to original bin (inc. TOF)
       symm_ptr->transform_proj_matrix_elems_for_one_bin(probabilities);
@@ -92,6 +98,7 @@ ProjMatrixByBin::get_proj_matrix_elems_for_one_bin(ProjMatrixElemsForOneBin& pro
           // check if basic bin is in cache
           if (get_cached_proj_matrix_elems_for_one_bin(probabilities) == Succeeded::no)
             {
+              cache_misses_counter.add(1);
               // basic bin is not in cache, compute lor probabilities for the basic bin
               calculate_proj_matrix_elems_for_one_bin(probabilities);
 #ifndef NDEBUG
@@ -102,11 +109,15 @@ ProjMatrixByBin::get_proj_matrix_elems_for_one_bin(ProjMatrixElemsForOneBin& pro
                   apply_tof_kernel(probabilities);
                 }
             }
+          else
+            cache_hits_counter.add(1);
           // now transform basic bin probabilities into original bin probabilities
           symm_ptr->transform_proj_matrix_elems_for_one_bin(probabilities);
           // cache the probabilities for bin
           cache_proj_matrix_elems_for_one_bin(probabilities);
         }
+      else
+        cache_hits_counter.add(1);
     }
   // stop_timers(); TODO, can't do this in a const member
 }
@@ -26,6 +26,8 @@
 #include "stir/IndexRange.h"
 #include "stir/shared_ptr.h"
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include "stir/recon_buildblock/SPECTUB_Tools.h"
 
@@ -72,8 +74,34 @@ http://dx.doi.org/10.1118/1.4816676
     ; if next variable is set to 0, only a single view is kept in memory
    keep all views in cache:=1
 
+    ; optional directory where the computed matrix is stored (one file per view), see below
+    matrix cache directory :=
+    ; store weights as 16-bit integers (relative to the maximum weight of every bin) in these files
+    quantise matrix cache := 0
+
 End Projection Matrix By Bin SPECT UB Parameters:=
 \endverbatim
+
+  \par Computation of the matrix
+
+  The matrix is computed one view at a time. If all views are kept in the cache (and the cache is enabled),
+  all views are computed in set_up(), in parallel if OpenMP is enabled. Otherwise, views are computed
+  when they are needed (single-threaded).
+
+  \par Persistent matrix cache
+
+  If a matrix cache directory is set (it has to exist already), every computed view is written to a file
+  in that directory, and read from there when it is needed again, for instance when restarting
+  a reconstruction. The file names contain a hash of all parameters that determine the matrix
+  (geometry, PSF model, attenuation and mask type, the values of the attenuation map and mask, and
+  whether weights are quantised).
+  This key is also stored in the file and checked when reading. The files use the native byte order.
+
+  With <tt>quantise matrix cache := 1</tt>, weights are stored as 16-bit integers, relative to
+  the largest weight of every bin. This reduces the size of the files by 20%, at the cost of an error of
+  at most 1/131070 of this maximum. Only the files are affected: the computed weights are kept in memory
+  at full precision. Results can therefore differ slightly between a run that computes the matrix and one
+  that reads it.
 */
 // using namespace SPECTUB;
 class ProjMatrixByBinSPECTUB : public RegisteredParsingObject<ProjMatrixByBinSPECTUB, ProjMatrixByBin, ProjMatrixByBin>
@@ -140,6 +168,17 @@ public:
 
   void set_resolution_model(const float collimator_sigma_0_in_mm, const float collimator_slope_in_mm, const bool full_3D = true);
 
+  std::string get_matrix_cache_directory() const;
+  //! Set directory for the persistent matrix cache
+  /*! An empty string disables the persistent cache. The directory has to exist.
+
+    You have to call set_up() after this.
+  */
+  void set_matrix_cache_directory(const std::string& value);
+  bool get_quantise_matrix_cache() const;
+  //! Store weights in the persistent matrix cache as 16-bit integers
+  void set_quantise_matrix_cache(const bool value = true);
+
   // Alex
   // Fix to compile, missing function definition in header
   ProjMatrixByBinSPECTUB* clone() const override;
@@ -158,6 +197,8 @@ private:
   std::string mask_type;
   std::string mask_file;
   bool keep_all_views_in_cache; //!< if set to false, only a single view is kept in memory
+  std::string matrix_cache_directory;
+  bool quantise_matrix_cache;
 
   // explicitly list necessary members for image details (should use an Info object instead)
   CartesianCoordinate3D<float> voxel_size;
@@ -202,9 +243,18 @@ private:
 
   int maxszb;
 
+  //! Computes the matrix elements for one view (or reads them from the persistent cache) and stores them in the cache
+  /*! This function is thread-safe for different \a kOS. */
   void compute_one_subset(const int kOS, const float* Rrad) const;
   void delete_UB_SPECT_arrays();
   mutable std::vector<bool> subset_already_processed;
+
+  //! description of all parameters that determine the matrix, set by set_up()
+  std::string matrix_cache_key;
+  std::string get_matrix_cache_filename(const int view_num) const;
+  bool read_view_from_matrix_cache(const int view_num) const;
+  //! Writes the elements to file (quantising the weights if requested)
+  void write_view_to_matrix_cache(const int view_num, const std::vector<ProjMatrixElemsForOneBin>& lors) const;
 };
 
 END_NAMESPACE_STIR
@@ -30,6 +30,7 @@
 
 #include "stir/recon_buildblock/ProjMatrixElemsForOneBinValue.h"
 #include "stir/Bin.h"
+#include "stir/buffer_pool.h"
 #include <vector>
 
 START_NAMESPACE_STIR
@@ -79,7 +80,9 @@ public:
 
 private:
   //! shorthand to keep typedefs below concise
-  typedef std::vector<value_type> Element_vector;
+  /*! We use the BufferPoolAllocator as these objects are constructed and destructed
+      for every bin during projection. */
+  typedef std::vector<value_type, BufferPoolAllocator<value_type>> Element_vector;
 
 public:
   //! typedefs for iterator support
@@ -189,7 +192,7 @@ public:
   void forward_project(RelatedBins&, const DiscretisedDensity<3, float>&) const;
 
 private:
-  std::vector<value_type> elements;
+  Element_vector elements;
   Bin bin;
 };
 
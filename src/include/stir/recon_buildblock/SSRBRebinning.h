@@ -0,0 +1,79 @@
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup recon_buildblock
+  \brief Declaration of class stir::SSRBRebinning
+
+  \author STIR contributors
+*/
+
+#ifndef __stir_recon_buildblock_SSRBRebinning_H__
+#define __stir_recon_buildblock_SSRBRebinning_H__
+
+#include "stir/recon_buildblock/ProjDataRebinning.h"
+#include "stir/RegisteredParsingObject.h"
+
+START_NAMESPACE_STIR
+
+/*!
+  \brief Single Slice Rebinning as a ProjDataRebinning object
+  \ingroup recon_buildblock
+
+  This allows using SSRB() from rebin_projdata. Here's a sample .par file
+\verbatim
+rebin_projdata Parameters :=
+  rebinning type := SSRB
+    SSRB Parameters :=
+      input file := some_3D_data.hs
+      output filename prefix := rebinned
+      ; next defaults to -1, i.e. all segments
+      maximum absolute segment number to process := -1
+      ; next defaults to all segments (up to the maximum above), i.e. 2D output
+      number of segments to combine := -1
+      number of views to combine := 1
+      number of tangential positions to trim := 0
+      number of TOF bins to combine := 1
+      do normalisation := 1
+    End SSRB Parameters:=
+END:=
+\endverbatim
+  \see SSRB(const ProjDataInfo&, const int, const int, const int, const int, const int) for the meaning of the parameters
+*/
+class SSRBRebinning : public RegisteredParsingObject<SSRBRebinning, ProjDataRebinning, ProjDataRebinning>
+{
+private:
+  typedef ProjDataRebinning base_type;
+
+public:
+  //! Name which will be used when parsing a ProjDataRebinning object
+  static const char* const registered_name;
+
+  //! default constructor calls set_defaults();
+  SSRBRebinning();
+
+  std::string method_info() const override { return ("SSRB"); }
+
+  Succeeded rebin() override;
+
+protected:
+  //! number of segments to combine (odd). If -1, all segments are combined
+  int num_segments_to_combine;
+  int num_views_to_combine;
+  int num_tang_poss_to_trim;
+  int num_tof_bins_to_combine;
+  bool do_normalisation;
+
+  void set_defaults() override;
+  void initialise_keymap() override;
+  bool post_processing() override;
+};
+
+END_NAMESPACE_STIR
+#endif
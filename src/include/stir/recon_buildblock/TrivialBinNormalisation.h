@@ -44,6 +44,8 @@ public:
 
   inline bool is_trivial() const override { return true; }
 
+  inline std::string get_efficiencies_key_info() const override { return registered_name; }
+
 private:
   inline void set_defaults() override {}
   inline void initialise_keymap() override {}
@@ -50,6 +50,9 @@ protected:
 
   void start_new_time_frame(const unsigned int new_frame_num) override;
 
+  //! Returns \c false as the motion is updated in process_new_time_event()
+  bool can_process_time_chunks_in_parallel() const override { return false; }
+
   void set_defaults() override;
   void initialise_keymap() override;
   bool post_processing() override;
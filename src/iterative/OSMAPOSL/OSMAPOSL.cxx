@@ -24,6 +24,8 @@
 #include "stir/Succeeded.h"
 #include "stir/CPUTimer.h"
 #include "stir/HighResWallClockTimer.h"
+#include "stir/ProfilingRegistry.h"
+#include "stir/TimedBlock.h"
 #include "stir/recon_buildblock/distributable_main.h"
 #include <iostream>
 using std::cerr;
@@ -45,11 +47,21 @@ main(int argc, char** argv)
   t.reset();
   t.start();
 
+  ProfilingRegistry::instance().set_up_from_environment();
+
   OSMAPOSLReconstruction<DiscretisedDensity<3, float>> reconstruction_object(argc > 1 ? argv[1] : "");
 
   // return reconstruction_object.reconstruct() == Succeeded::yes ?
   //     EXIT_SUCCESS : EXIT_FAILURE;
-  if (reconstruction_object.reconstruct() == Succeeded::yes)
+  Succeeded success = Succeeded::no;
+  {
+    ProfilingScope reconstruction_scope("OSMAPOSL");
+    TimedBlock<ProfilingScope> timed_block(reconstruction_scope);
+    success = reconstruction_object.reconstruct();
+  }
+  ProfilingRegistry::instance().write_report_if_requested();
+
+  if (success == Succeeded::yes)
     {
       t.stop();
       cout << "Total Wall clock time: " << t.value() << " seconds" << endl;
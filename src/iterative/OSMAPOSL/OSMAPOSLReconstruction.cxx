@@ -45,6 +45,8 @@
 #include "stir/info.h"
 #include "stir/error.h"
 #include "stir/format.h"
+#include "stir/ProfilingRegistry.h"
+#include "stir/TimedBlock.h"
 
 #include "stir/modelling/ParametricDiscretisedDensity.h"
 #include "stir/modelling/KineticParameters.h"
@@ -377,6 +379,9 @@ OSMAPOSLReconstruction<TargetT>::update_estimate(TargetT& current_image_estimate
   // type instead of hard-wiring float
   static const float small_num = 0.000001F;
 
+  static ProfilingScope subset_update_scope("subset update");
+  TimedBlock<ProfilingScope> timed_block(subset_update_scope);
+
 #ifndef PARALLEL
   // CPUTimer subset_timer;
   // subset_timer.start();
@@ -410,7 +415,11 @@ OSMAPOSLReconstruction<TargetT>::update_estimate(TargetT& current_image_estimate
       {
         unique_ptr<TargetT> denominator_ptr(current_image_estimate.get_empty_copy());
 
-        this->objective_function_sptr->get_prior_ptr()->compute_gradient(*denominator_ptr, current_image_estimate);
+        {
+          static ProfilingScope prior_scope("prior");
+          TimedBlock<ProfilingScope> prior_timed_block(prior_scope);
+          this->objective_function_sptr->get_prior_ptr()->compute_gradient(*denominator_ptr, current_image_estimate);
+        }
 
         typename TargetT::full_iterator denominator_iter = denominator_ptr->begin_all();
         const typename TargetT::full_iterator denominator_end = denominator_ptr->end_all();
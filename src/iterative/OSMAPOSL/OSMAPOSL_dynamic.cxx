@@ -0,0 +1,394 @@
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+
+  \file
+  \ingroup main_programs
+  \brief Reconstruct all frames of dynamic projection data with OSMAPOSL
+
+  \par Usage
+  \verbatim
+  OSMAPOSL_dynamic parameter_file
+  \endverbatim
+
+  Here's a sample .par file
+  \verbatim
+  OSMAPOSL_dynamic Parameters :=
+    ; dynamic projection data, e.g. a multi-header created with create_multi_header
+    input file := dyn_sinos.txt
+    ; optional dynamic additive projection data (one per frame)
+    ; additive dynamic projection data := dyn_additive.txt
+    ; OSMAPOSL parameter file used for every frame.
+    ; Its "input file" keyword is ignored (and can be omitted), as is "additive sinogram"
+    ; if the above is set. The "output filename prefix" is replaced.
+    reconstruction parameter file := OSMAPOSL.par
+    output filename prefix := dyn_recon
+    ; number of frames that are reconstructed concurrently (default 1).
+    ; The available threads are divided over these frames.
+    number of frames in parallel := 4
+    ; if set, the sensitivity is computed only once for all frames with the same
+    ; normalisation factors (default 0)
+    use same sensitivity for all frames := 1
+  END :=
+  \endverbatim
+
+  The reconstructed images of every frame are written as for \c OSMAPOSL (with prefix
+  <tt>output_filename_prefix_f\<frame_num\></tt>), and the final images are written as a
+  stir::DynamicDiscretisedDensity with the default output file format.
+
+  Every frame that is reconstructed concurrently uses its own stir::OSMAPOSLReconstruction
+  object, constructed from the parameter file. These objects (including projectors,
+  normalisation and prior) are reused for all frames processed by the same thread,
+  such that the parameter file is parsed, and the normalisation is read, only once per thread.
+  (Projectors keep state such as the current input image, so they cannot be shared between
+  frames that are reconstructed at the same time.)
+
+  The normalisation factors can depend on the time frame (e.g. via dead-time or decay correction).
+  By default, the sensitivity is therefore computed for every frame. If <tt>use same sensitivity for
+  all frames</tt> is set, the normalisation is set-up for every frame and its factors are compared
+  (via BinNormalisation::get_efficiencies_key_info()). The sensitivity is then only computed for the
+  first frame of every group of frames with the same factors, and kept in memory for the other frames.
+  If the reconstruction parameter file specifies a sensitivity file that is not recomputed,
+  it is read only once and used for all frames.
+
+  Every reconstruction object is set-up again for every frame, but the projectors are only set-up
+  once (see PoissonLogLikelihoodWithLinearModelForMeanAndProjData::set_skip_projector_set_up_if_unchanged()).
+
+  \author STIR contributors
+*/
+
+#include "stir/OSMAPOSL/OSMAPOSLReconstruction.h"
+#include "stir/recon_buildblock/PoissonLogLikelihoodWithLinearModelForMeanAndProjData.h"
+#include "stir/recon_buildblock/BinNormalisation.h"
+#include "stir/DynamicProjData.h"
+#include "stir/DynamicDiscretisedDensity.h"
+#include "stir/IO/OutputFileFormat.h"
+#include "stir/ParsingObject.h"
+#include "stir/HighResWallClockTimer.h"
+#include "stir/ProfilingRegistry.h"
+#include "stir/num_threads.h"
+#include "stir/is_null_ptr.h"
+#include "stir/Succeeded.h"
+#include "stir/info.h"
+#include "stir/warning.h"
+#include "stir/error.h"
+#include "stir/format.h"
+#ifdef STIR_OPENMP
+#  include <omp.h>
+#endif
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+START_NAMESPACE_STIR
+
+typedef DiscretisedDensity<3, float> TargetT;
+typedef PoissonLogLikelihoodWithLinearModelForMeanAndProjData<TargetT> ObjectiveFunctionT;
+
+static shared_ptr<ObjectiveFunctionT>
+get_objective_function_sptr(const OSMAPOSLReconstruction<TargetT>& reconstruction)
+{
+  auto objective_function_sptr = dynamic_pointer_cast<ObjectiveFunctionT>(reconstruction.get_objective_function_sptr());
+  if (is_null_ptr(objective_function_sptr))
+    error("OSMAPOSL_dynamic: the objective function needs to be of type PoissonLogLikelihoodWithLinearModelForMeanAndProjData");
+  return objective_function_sptr;
+}
+
+class OSMAPOSLDynamicParameters : public ParsingObject
+{
+public:
+  explicit OSMAPOSLDynamicParameters(const char* const par_filename);
+
+  Succeeded reconstruct_all_frames();
+
+private:
+  std::string input_filename;
+  std::string additive_filename;
+  std::string reconstruction_parameter_filename;
+  std::string output_filename_prefix;
+  int num_frames_in_parallel;
+  bool use_same_sensitivity_for_all_frames;
+
+  shared_ptr<DynamicProjData> dyn_proj_data_sptr;
+  shared_ptr<DynamicProjData> additive_dyn_proj_data_sptr;
+
+  void set_defaults() override;
+  void initialise_keymap() override;
+  bool post_processing() override;
+
+  //! set input data, additive data and output prefix for one frame
+  void set_frame(OSMAPOSLReconstruction<TargetT>& reconstruction, const unsigned int frame_num) const;
+  //! set-up the normalisation of the objective function for one frame and return its key
+  std::string get_normalisation_key(ObjectiveFunctionT& objective_function, const int frame_num) const;
+};
+
+void
+OSMAPOSLDynamicParameters::set_defaults()
+{
+  input_filename = "";
+  additive_filename = "";
+  reconstruction_parameter_filename = "";
+  output_filename_prefix = "";
+  num_frames_in_parallel = 1;
+  use_same_sensitivity_for_all_frames = false;
+}
+
+void
+OSMAPOSLDynamicParameters::initialise_keymap()
+{
+  parser.add_start_key("OSMAPOSL_dynamic Parameters");
+  parser.add_key("input file", &input_filename);
+  parser.add_key("additive dynamic projection data", &additive_filename);
+  parser.add_key("reconstruction parameter file", &reconstruction_parameter_filename);
+  parser.add_key("output filename prefix", &output_filename_prefix);
+  parser.add_key("number of frames in parallel", &num_frames_in_parallel);
+  parser.add_key("use same sensitivity for all frames", &use_same_sensitivity_for_all_frames);
+  parser.add_stop_key("END");
+}
+
+bool
+OSMAPOSLDynamicParameters::post_processing()
+{
+  if (input_filename.empty() || reconstruction_parameter_filename.empty() || output_filename_prefix.empty())
+    {
+      warning("OSMAPOSL_dynamic: you need to set 'input file', 'reconstruction parameter file' and 'output filename prefix'");
+      return true;
+    }
+  if (num_frames_in_parallel < 1)
+    {
+      warning("OSMAPOSL_dynamic: 'number of frames in parallel' has to be at least 1");
+      return true;
+    }
+  dyn_proj_data_sptr = DynamicProjData::read_from_file(input_filename);
+  if (is_null_ptr(dyn_proj_data_sptr) || dyn_proj_data_sptr->get_num_frames() == 0)
+    {
+      warning(format("OSMAPOSL_dynamic: error reading dynamic projection data from '{}'", input_filename));
+      return true;
+    }
+  if (!additive_filename.empty())
+    {
+      additive_dyn_proj_data_sptr = DynamicProjData::read_from_file(additive_filename);
+      if (is_null_ptr(additive_dyn_proj_data_sptr)
+          || additive_dyn_proj_data_sptr->get_num_frames() != dyn_proj_data_sptr->get_num_frames())
+        {
+          warning(format("OSMAPOSL_dynamic: error reading additive dynamic projection data from '{}', "
+                         "or its number of frames does not match the input",
+                         additive_filename));
+          return true;
+        }
+    }
+  return false;
+}
+
+OSMAPOSLDynamicParameters::OSMAPOSLDynamicParameters(const char* const par_filename)
+{
+  set_defaults();
+  if (par_filename != 0)
+    {
+      if (parse(par_filename) == false)
+        error("OSMAPOSL_dynamic: error parsing parameter file");
+    }
+  else
+    ask_parameters();
+}
+
+void
+OSMAPOSLDynamicParameters::set_frame(OSMAPOSLReconstruction<TargetT>& reconstruction, const unsigned int frame_num) const
+{
+  reconstruction.set_input_data(dyn_proj_data_sptr->get_proj_data_sptr(frame_num));
+  if (!is_null_ptr(additive_dyn_proj_data_sptr))
+    reconstruction.get_objective_function_sptr()->set_additive_proj_data_sptr(
+        additive_dyn_proj_data_sptr->get_proj_data_sptr(frame_num));
+  reconstruction.set_output_filename_prefix(format("{}_f{}", output_filename_prefix, frame_num));
+}
+
+std::string
+OSMAPOSLDynamicParameters::get_normalisation_key(ObjectiveFunctionT& objective_function, const int frame_num) const
+{
+  const shared_ptr<BinNormalisation>& norm_sptr = objective_function.get_normalisation_sptr();
+  if (is_null_ptr(norm_sptr))
+    return "";
+  const shared_ptr<ProjData> proj_data_sptr = dyn_proj_data_sptr->get_proj_data_sptr(static_cast<unsigned int>(frame_num));
+  if (norm_sptr->set_up(proj_data_sptr->get_exam_info_sptr(), proj_data_sptr->get_proj_data_info_sptr()) != Succeeded::yes)
+    error(format("OSMAPOSL_dynamic: set-up of the normalisation for frame {} failed", frame_num));
+  return norm_sptr->get_efficiencies_key_info();
+}
+
+Succeeded
+OSMAPOSLDynamicParameters::reconstruct_all_frames()
+{
+  const int num_frames = static_cast<int>(dyn_proj_data_sptr->get_num_frames());
+  // make sure the default number of threads is set before we start any parallel region
+  set_num_threads();
+  const int num_workers = std::min(num_frames_in_parallel, num_frames);
+  const int num_threads_per_frame = std::max(get_max_num_threads() / num_workers, 1);
+  info(format("OSMAPOSL_dynamic: reconstructing {} frames, {} at a time with {} threads each",
+              num_frames,
+              num_workers,
+              num_threads_per_frame));
+
+  // one reconstruction object per concurrent frame
+  std::vector<shared_ptr<OSMAPOSLReconstruction<TargetT>>> reconstructions(num_workers);
+  for (auto& reconstruction_sptr : reconstructions)
+    {
+      reconstruction_sptr = std::make_shared<OSMAPOSLReconstruction<TargetT>>(reconstruction_parameter_filename);
+      // the geometry is the same for all frames, so the projectors only need to be set-up once
+      get_objective_function_sptr(*reconstruction_sptr)->set_skip_projector_set_up_if_unchanged(true);
+    }
+
+  // handle the sensitivity
+  // sensitivities for every frame (frames can share the same images)
+  std::vector<std::vector<shared_ptr<TargetT>>> sensitivities(num_frames);
+  {
+    auto objective_function_sptr = get_objective_function_sptr(*reconstructions[0]);
+    const bool use_subsets = objective_function_sptr->get_use_subset_sensitivities();
+    const bool read_sensitivity = !objective_function_sptr->get_recompute_sensitivity()
+                                  && !(use_subsets ? objective_function_sptr->get_subsensitivity_filenames()
+                                                   : objective_function_sptr->get_sensitivity_filename())
+                                          .empty();
+    // avoid all frames writing to the same file
+    if (!read_sensitivity)
+      for (auto& reconstruction_sptr : reconstructions)
+        {
+          auto frame_objective_function_sptr = get_objective_function_sptr(*reconstruction_sptr);
+          frame_objective_function_sptr->set_sensitivity_filename("");
+          frame_objective_function_sptr->set_subsensitivity_filenames("");
+        }
+
+    if (read_sensitivity || use_same_sensitivity_for_all_frames)
+      {
+        // find the frames that have the same normalisation factors
+        std::vector<int> first_frame_with_same_norm(num_frames);
+        if (read_sensitivity)
+          std::fill(first_frame_with_same_norm.begin(), first_frame_with_same_norm.end(), 1);
+        else
+          {
+            std::map<std::string, int> first_frame_for_key;
+            for (int frame_num = 1; frame_num <= num_frames; ++frame_num)
+              {
+                const std::string key = get_normalisation_key(*objective_function_sptr, frame_num);
+                first_frame_with_same_norm[frame_num - 1] = first_frame_for_key.emplace(key, frame_num).first->second;
+              }
+            info(format("OSMAPOSL_dynamic: computing {} sensitivities for {} frames", first_frame_for_key.size(), num_frames));
+          }
+
+        // set-up for the first frame of every group, which computes (or reads) the sensitivity
+        for (int frame_num = 1; frame_num <= num_frames; ++frame_num)
+          {
+            const int first_frame_num = first_frame_with_same_norm[frame_num - 1];
+            if (first_frame_num == frame_num)
+              {
+                set_frame(*reconstructions[0], static_cast<unsigned int>(frame_num));
+                shared_ptr<TargetT> target_sptr(reconstructions[0]->get_initial_data_ptr());
+                if (reconstructions[0]->set_up(target_sptr) != Succeeded::yes)
+                  return Succeeded::no;
+                for (int subset_num = 0; subset_num < objective_function_sptr->get_num_subsets(); ++subset_num)
+                  sensitivities[frame_num - 1].push_back(objective_function_sptr->get_subset_sensitivity_sptr(subset_num));
+              }
+            else
+              sensitivities[frame_num - 1] = sensitivities[first_frame_num - 1];
+          }
+
+        // all frames will now use the sensitivities in memory
+        for (auto& reconstruction_sptr : reconstructions)
+          {
+            auto frame_objective_function_sptr = get_objective_function_sptr(*reconstruction_sptr);
+            frame_objective_function_sptr->set_sensitivity_filename("");
+            frame_objective_function_sptr->set_subsensitivity_filenames("");
+            frame_objective_function_sptr->set_recompute_sensitivity(false);
+          }
+      }
+  }
+
+  // Reconstruct frames using one std::thread per reconstruction object. (An OpenMP parallel region
+  // cannot be used here, as projectors check that they are not called from within a parallel region.)
+  // Every thread takes the next frame that is not yet done.
+  std::vector<shared_ptr<TargetT>> images(num_frames);
+  std::atomic<int> next_frame_num(1);
+  std::atomic<bool> all_succeeded(true);
+  auto worker = [&](const int worker_num) {
+#ifdef STIR_OPENMP
+    omp_set_num_threads(num_threads_per_frame);
+#endif
+    OSMAPOSLReconstruction<TargetT>& reconstruction = *reconstructions[worker_num];
+    for (int frame_num = next_frame_num++; frame_num <= num_frames; frame_num = next_frame_num++)
+      {
+        try
+          {
+            info(format("OSMAPOSL_dynamic: starting frame {}", frame_num));
+            set_frame(reconstruction, static_cast<unsigned int>(frame_num));
+            if (!sensitivities[frame_num - 1].empty())
+              {
+                auto objective_function_sptr = get_objective_function_sptr(reconstruction);
+                for (int subset_num = 0; subset_num < static_cast<int>(sensitivities[frame_num - 1].size()); ++subset_num)
+                  objective_function_sptr->set_subset_sensitivity_sptr(sensitivities[frame_num - 1][subset_num], subset_num);
+              }
+            if (reconstruction.reconstruct() == Succeeded::yes)
+              images[frame_num - 1] = reconstruction.get_target_image();
+          }
+        catch (std::exception& e)
+          {
+            warning(format("OSMAPOSL_dynamic: reconstruction of frame {} failed:\n{}", frame_num, e.what()));
+          }
+        if (is_null_ptr(images[frame_num - 1]))
+          all_succeeded = false;
+      }
+  };
+  std::vector<std::thread> threads;
+  for (int worker_num = 1; worker_num < num_workers; ++worker_num)
+    threads.emplace_back(worker, worker_num);
+  worker(0);
+  for (auto& thread : threads)
+    thread.join();
+  if (!all_succeeded)
+    return Succeeded::no;
+
+  DynamicDiscretisedDensity dyn_image(dyn_proj_data_sptr->get_time_frame_definitions(),
+                                      dyn_proj_data_sptr->get_start_time_in_secs_since_1970(),
+                                      dyn_proj_data_sptr->get_proj_data_sptr(1)->get_proj_data_info_sptr()->get_scanner_sptr(),
+                                      images[0]);
+  for (int frame_num = 1; frame_num <= num_frames; ++frame_num)
+    dyn_image.set_density(*images[frame_num - 1], static_cast<unsigned int>(frame_num));
+
+  info(format("OSMAPOSL_dynamic: writing dynamic image to '{}'", output_filename_prefix));
+  return OutputFileFormat<DynamicDiscretisedDensity>::default_sptr()->write_to_file(output_filename_prefix, dyn_image);
+}
+
+END_NAMESPACE_STIR
+
+int
+main(int argc, char** argv)
+{
+  USING_NAMESPACE_STIR
+
+  if (argc > 2)
+    {
+      std::cerr << "Usage: " << argv[0] << " [par_file]\n";
+      return EXIT_FAILURE;
+    }
+
+  HighResWallClockTimer t;
+  t.reset();
+  t.start();
+
+  ProfilingRegistry::instance().set_up_from_environment();
+
+  OSMAPOSLDynamicParameters parameters(argc == 2 ? argv[1] : 0);
+  const Succeeded success = parameters.reconstruct_all_frames();
+
+  ProfilingRegistry::instance().write_report_if_requested();
+  t.stop();
+  std::cout << "Total Wall clock time: " << t.value() << " seconds" << std::endl;
+  return success == Succeeded::yes ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -20,6 +20,8 @@
 #include "stir/OSSPS/OSSPSReconstruction.h"
 #include "stir/DiscretisedDensity.h"
 #include "stir/Succeeded.h"
+#include "stir/ProfilingRegistry.h"
+#include "stir/TimedBlock.h"
 #include "stir/recon_buildblock/distributable_main.h"
 
 USING_NAMESPACE_STIR
@@ -32,8 +34,17 @@ int
 main(int argc, char** argv)
 #endif
 {
+  ProfilingRegistry::instance().set_up_from_environment();
 
   OSSPSReconstruction<DiscretisedDensity<3, float>> reconstruction_object(argc > 1 ? argv[1] : "");
 
-  return reconstruction_object.reconstruct() == Succeeded::yes ? EXIT_SUCCESS : EXIT_FAILURE;
+  Succeeded success = Succeeded::no;
+  {
+    ProfilingScope reconstruction_scope("OSSPS");
+    TimedBlock<ProfilingScope> timed_block(reconstruction_scope);
+    success = reconstruction_object.reconstruct();
+  }
+  ProfilingRegistry::instance().write_report_if_requested();
+
+  return success == Succeeded::yes ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -34,6 +34,8 @@
 #include "stir/warning.h"
 #include "stir/error.h"
 #include "stir/format.h"
+#include "stir/ProfilingRegistry.h"
+#include "stir/TimedBlock.h"
 
 #include <iostream>
 #include <memory>
@@ -283,6 +285,10 @@ void
 OSSPSReconstruction<TargetT>::update_estimate(TargetT& current_image_estimate)
 {
   this->check(current_image_estimate);
+
+  static ProfilingScope subset_update_scope("subset update");
+  TimedBlock<ProfilingScope> timed_block(subset_update_scope);
+
   if (this->get_subiteration_num() == this->get_start_subiteration_num())
     {
       // set all voxels to 0 that cannot be estimated.
@@ -328,6 +334,8 @@ OSSPSReconstruction<TargetT>::update_estimate(TargetT& current_image_estimate)
       // avoid work (or crash) when penalty is 0
       if (!this->objective_function_sptr->prior_is_zero())
         {
+          static ProfilingScope prior_scope("prior");
+          TimedBlock<ProfilingScope> prior_timed_block(prior_scope);
           static_cast<PriorWithParabolicSurrogate<TargetT>&>(*get_prior_ptr())
               .parabolic_surrogate_curvature(*work_image_ptr, current_image_estimate);
           //*work_image_ptr *= 2;
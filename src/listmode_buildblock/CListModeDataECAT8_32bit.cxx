@@ -109,5 +109,17 @@ CListModeDataECAT8_32bit::set_get_position(const CListModeDataECAT8_32bit::Saved
   return current_lm_data_ptr->set_get_position(pos);
 }
 
+Succeeded
+CListModeDataECAT8_32bit::get_persistent_position(PersistentPosition& pos)
+{
+  return current_lm_data_ptr->get_current_offset(pos);
+}
+
+Succeeded
+CListModeDataECAT8_32bit::set_persistent_position(const PersistentPosition& pos)
+{
+  return current_lm_data_ptr->set_current_offset(pos);
+}
+
 } // namespace ecat
 END_NAMESPACE_STIR
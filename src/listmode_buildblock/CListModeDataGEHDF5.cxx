@@ -28,6 +28,7 @@
 #include "stir/format.h"
 #include <iostream>
 #include <fstream>
+#include <vector>
 
 START_NAMESPACE_STIR
 
@@ -37,7 +38,9 @@ namespace RDF_HDF5
 {
 
 CListModeDataGEHDF5::CListModeDataGEHDF5(const std::string& listmode_filename)
-    : listmode_filename(listmode_filename)
+    : listmode_filename(listmode_filename),
+      read_buffer_size(10000000),
+      num_read_buffers(2)
 {
   if (open_lm_file() == Succeeded::no)
     error(format("CListModeDataGEHDF5: error opening the listmode file for filename {}", listmode_filename));
@@ -90,11 +93,56 @@ CListModeDataGEHDF5::open_lm_file()
               this->lm_duration_in_millisecs),
        2);
 
+  open_input_stream();
+
+  return Succeeded::yes;
+}
+
+void
+CListModeDataGEHDF5::open_input_stream()
+{
+  std::vector<std::streampos> saved_get_positions;
+  if (!is_null_ptr(current_lm_data_ptr))
+    {
+      saved_get_positions = current_lm_data_ptr->get_saved_get_positions();
+      // close the file first (and stop its reader thread)
+      current_lm_data_ptr.reset();
+    }
+
   //! \todo N.E: Remove hard-coded sizes; (they're stored in GEHDF5Wrapper)
+  current_lm_data_ptr.reset(new InputStreamWithRecordsFromHDF5<CListRecordT>(
+      listmode_filename, 6, 16, this->read_buffer_size, this->num_read_buffers));
+  current_lm_data_ptr->set_saved_get_positions(saved_get_positions);
+}
 
-  current_lm_data_ptr.reset(new InputStreamWithRecordsFromHDF5<CListRecordT>(listmode_filename, 6, 16));
+void
+CListModeDataGEHDF5::set_read_buffer_size(const std::size_t buffer_size)
+{
+  if (buffer_size == this->read_buffer_size)
+    return;
+  this->read_buffer_size = buffer_size;
+  open_input_stream();
+}
 
-  return Succeeded::yes;
+std::size_t
+CListModeDataGEHDF5::get_read_buffer_size() const
+{
+  return this->read_buffer_size;
+}
+
+void
+CListModeDataGEHDF5::set_num_read_buffers(const int num_buffers)
+{
+  if (num_buffers == this->num_read_buffers)
+    return;
+  this->num_read_buffers = num_buffers;
+  open_input_stream();
+}
+
+int
+CListModeDataGEHDF5::get_num_read_buffers() const
+{
+  return this->num_read_buffers;
 }
 
 Succeeded
@@ -122,6 +170,18 @@ CListModeDataGEHDF5::set_get_position(const CListModeDataGEHDF5::SavedPosition&
   return current_lm_data_ptr->set_get_position(pos);
 }
 
+Succeeded
+CListModeDataGEHDF5::get_persistent_position(PersistentPosition& pos)
+{
+  return current_lm_data_ptr->get_current_offset(pos);
+}
+
+Succeeded
+CListModeDataGEHDF5::set_persistent_position(const PersistentPosition& pos)
+{
+  return current_lm_data_ptr->set_current_offset(pos);
+}
+
 } // namespace RDF_HDF5
 } // namespace GE
 END_NAMESPACE_STIR
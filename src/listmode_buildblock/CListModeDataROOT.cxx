@@ -258,6 +258,18 @@ CListModeDataROOT::set_get_position(const CListModeDataROOT::SavedPosition& pos)
   return root_file_sptr->set_get_position(pos);
 }
 
+Succeeded
+CListModeDataROOT::get_persistent_position(PersistentPosition& pos)
+{
+  return root_file_sptr->get_current_offset(pos);
+}
+
+Succeeded
+CListModeDataROOT::set_persistent_position(const PersistentPosition& pos)
+{
+  return root_file_sptr->set_current_offset(pos);
+}
+
 void
 CListModeDataROOT::set_defaults()
 {
@@ -18,6 +18,7 @@
 */
 
 #include "stir/listmode/ListModeData.h"
+#include "stir/listmode/ListModeTimeIndex.h"
 #include "stir/ExamInfo.h"
 #include "stir/is_null_ptr.h"
 #include "stir/error.h"
@@ -53,6 +54,32 @@ ListModeData::get_proj_data_info_sptr() const
   return proj_data_info_sptr;
 }
 
+void
+ListModeData::set_time_index_sptr(const shared_ptr<const ListModeTimeIndex>& arg)
+{
+  time_index_sptr = arg;
+}
+
+shared_ptr<const ListModeTimeIndex>
+ListModeData::get_time_index_sptr() const
+{
+  return time_index_sptr;
+}
+
+Succeeded
+ListModeData::seek_to_time(double& time_of_new_position, const double time_in_secs)
+{
+  if (is_null_ptr(time_index_sptr))
+    return Succeeded::no;
+  ListModeTimeIndex::Entry entry;
+  if (time_index_sptr->find_entry_before(entry, time_in_secs) == Succeeded::no)
+    return Succeeded::no;
+  if (this->set_persistent_position(entry.position) == Succeeded::no)
+    return Succeeded::no;
+  time_of_new_position = entry.time_in_secs;
+  return Succeeded::yes;
+}
+
 #if 0
 std::time_t
 ListModeData::
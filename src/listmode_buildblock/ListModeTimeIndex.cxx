@@ -0,0 +1,148 @@
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup listmode
+  \brief Implementation of class stir::ListModeTimeIndex
+
+  \author STIR contributors
+*/
+
+#include "stir/listmode/ListModeTimeIndex.h"
+#include "stir/listmode/ListRecord.h"
+#include "stir/error.h"
+#include "stir/warning.h"
+#include "stir/format.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+
+START_NAMESPACE_STIR
+
+static const char* const time_index_signature = "STIR list mode time index version 1.0";
+
+std::string
+ListModeTimeIndex::get_default_filename(const std::string& lm_filename)
+{
+  return lm_filename + ".time_index";
+}
+
+ListModeTimeIndex::ListModeTimeIndex()
+    : interval_in_secs(0)
+{}
+
+ListModeTimeIndex::ListModeTimeIndex(const std::string& filename)
+    : interval_in_secs(0)
+{
+  if (read_from_file(filename) == Succeeded::no)
+    error(format("ListModeTimeIndex: error reading time index from '{}'", filename));
+}
+
+Succeeded
+ListModeTimeIndex::build(ListModeData& lm_data, const double interval_in_secs_v)
+{
+  this->interval_in_secs = interval_in_secs_v;
+  this->entries.clear();
+
+  if (lm_data.reset() == Succeeded::no)
+    return Succeeded::no;
+
+  shared_ptr<ListRecord> record_sptr = lm_data.get_empty_record_sptr();
+  ListRecord& record = *record_sptr;
+
+  while (lm_data.get_next_record(record) == Succeeded::yes)
+    {
+      if (!record.is_time())
+        continue;
+      const double current_time = record.time().get_time_in_secs();
+      if (!entries.empty() && current_time < entries.back().time_in_secs + interval_in_secs)
+        continue;
+      Entry entry;
+      entry.time_in_secs = current_time;
+      if (lm_data.get_persistent_position(entry.position) == Succeeded::yes)
+        entries.push_back(entry);
+      else if (entries.empty())
+        {
+          // either not supported, or a single time tag at the very end of the data
+          break;
+        }
+    }
+
+  lm_data.reset();
+  return entries.empty() ? Succeeded::no : Succeeded::yes;
+}
+
+Succeeded
+ListModeTimeIndex::read_from_file(const std::string& filename)
+{
+  std::ifstream s(filename.c_str());
+  if (!s)
+    return Succeeded::no;
+
+  std::string line;
+  if (!std::getline(s, line) || line != time_index_signature)
+    {
+      warning(format("ListModeTimeIndex: '{}' is not a list mode time index", filename));
+      return Succeeded::no;
+    }
+  std::string dummy;
+  std::size_t num_entries = 0;
+  // read "interval (s) := <value>" and "number of entries := <value>"
+  if (!(s >> dummy >> dummy >> dummy >> this->interval_in_secs) || !(s >> dummy >> dummy >> dummy >> dummy >> num_entries))
+    {
+      warning(format("ListModeTimeIndex: error reading header of '{}'", filename));
+      return Succeeded::no;
+    }
+  this->entries.resize(num_entries);
+  for (auto& entry : this->entries)
+    {
+      if (!(s >> entry.time_in_secs >> entry.position))
+        {
+          warning(format("ListModeTimeIndex: '{}' is too short", filename));
+          this->entries.clear();
+          return Succeeded::no;
+        }
+    }
+  return Succeeded::yes;
+}
+
+Succeeded
+ListModeTimeIndex::write_to_file(const std::string& filename) const
+{
+  std::ofstream s(filename.c_str());
+  if (!s)
+    {
+      warning(format("ListModeTimeIndex: cannot open '{}' for writing", filename));
+      return Succeeded::no;
+    }
+  s << time_index_signature << '\n'
+    << "interval (s) := " << this->interval_in_secs << '\n'
+    << "number of entries := " << this->entries.size() << '\n';
+  s << std::setprecision(std::numeric_limits<double>::max_digits10);
+  for (const auto& entry : this->entries)
+    s << entry.time_in_secs << ' ' << entry.position << '\n';
+  return s ? Succeeded::yes : Succeeded::no;
+}
+
+Succeeded
+ListModeTimeIndex::find_entry_before(Entry& entry, const double time_in_secs) const
+{
+  // find first entry with time >= time_in_secs
+  const auto iter = std::lower_bound(this->entries.begin(),
+                                     this->entries.end(),
+                                     time_in_secs,
+                                     [](const Entry& e, const double t) { return e.time_in_secs < t; });
+  if (iter == this->entries.begin())
+    return Succeeded::no;
+  entry = *(iter - 1);
+  return Succeeded::yes;
+}
+
+END_NAMESPACE_STIR
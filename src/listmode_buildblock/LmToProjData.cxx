@@ -57,12 +57,16 @@ typedef short elem_type;
 #include "stir/listmode/LmToProjData.h"
 #include "stir/listmode/ListRecord.h"
 #include "stir/listmode/ListModeData.h"
+#include "stir/listmode/ListModeTimeIndex.h"
 #include "stir/ExamInfo.h"
 #include "stir/ProjDataInfoCylindricalNoArcCorr.h"
 
 #include "stir/Scanner.h"
 #ifdef USE_SegmentByView
 #  include "stir/ProjDataInterfile.h"
+#  ifdef HAVE_ZLIB
+#    include "stir/ProjDataCompressed.h"
+#  endif
 #  include "stir/SegmentByView.h"
 #else
 #  include "stir/ProjDataFromStream.h"
@@ -74,12 +78,22 @@ typedef short elem_type;
 #include "stir/ParsingObject.h"
 #include "stir/TimeFrameDefinitions.h"
 #include "stir/CPUTimer.h"
+#include "stir/ProfilingRegistry.h"
+#include "stir/TimedBlock.h"
 #include "stir/recon_buildblock/TrivialBinNormalisation.h"
 #include "stir/is_null_ptr.h"
 #include "stir/warning.h"
 #include "stir/error.h"
+#include "stir/info.h"
+#include "stir/format.h"
+#include "stir/num_threads.h"
+#ifdef STIR_OPENMP
+#  include <omp.h>
+#endif
+#include <atomic>
 
 #include <fstream>
+#include <typeinfo>
 #include <iostream>
 #include <vector>
 
@@ -130,7 +144,8 @@ static void save_and_delete_segments(shared_ptr<iostream>& output,
 static shared_ptr<ProjData> construct_proj_data(shared_ptr<iostream>& output,
                                                 const string& output_filename,
                                                 const ExamInfo& exam_info,
-                                                const shared_ptr<const ProjDataInfo>& proj_data_info_ptr);
+                                                const shared_ptr<const ProjDataInfo>& proj_data_info_ptr,
+                                                const int compression_level);
 
 /**************************************************************
  set/get
@@ -192,6 +207,43 @@ LmToProjData::get_output_filename_prefix() const
   return output_filename_prefix;
 }
 
+void
+LmToProjData::set_time_index_filename(const std::string& v)
+{
+  this->time_index_filename = v;
+}
+
+std::string
+LmToProjData::get_time_index_filename() const
+{
+  return this->time_index_filename;
+}
+
+void
+LmToProjData::set_num_parallel_time_chunks(const int v)
+{
+  this->_already_setup = false;
+  this->num_parallel_time_chunks = v;
+}
+
+int
+LmToProjData::get_num_parallel_time_chunks() const
+{
+  return this->num_parallel_time_chunks;
+}
+
+void
+LmToProjData::set_output_compression_level(const int v)
+{
+  this->output_compression_level = v;
+}
+
+int
+LmToProjData::get_output_compression_level() const
+{
+  return this->output_compression_level;
+}
+
 double
 LmToProjData::get_last_processed_lm_rel_time() const
 {
@@ -282,6 +334,10 @@ LmToProjData::set_defaults()
   do_pre_normalisation = 0;
   num_events_to_store = 0L;
   do_time_frame = false;
+  time_index_filename = "";
+  time_index_interval_in_secs = 1.;
+  num_parallel_time_chunks = 1;
+  output_compression_level = 0;
 }
 
 void
@@ -309,6 +365,10 @@ LmToProjData::initialise_keymap()
     // parser.add_key("increment to use for 'delayeds'",&delayed_increment);
   }
   parser.add_key("List event coordinates", &interactive);
+  parser.add_key("time index filename", &time_index_filename);
+  parser.add_key("time index interval (in secs)", &time_index_interval_in_secs);
+  parser.add_key("number of parallel time chunks", &num_parallel_time_chunks);
+  parser.add_key("output compression level", &output_compression_level);
   parser.add_stop_key("END");
 }
 
@@ -355,6 +415,13 @@ LmToProjData::set_up()
       error("You have to specify an output_filename_prefix");
     }
 
+  if (output_compression_level < 0 || output_compression_level > 9)
+    error(format("LmToProjData: output compression level should be between 0 and 9, but is {}", output_compression_level));
+#ifndef HAVE_ZLIB
+  if (output_compression_level > 0)
+    error("LmToProjData: output compression needs STIR to be built with zlib");
+#endif
+
   if (is_null_ptr(template_proj_data_info_ptr))
     {
       info("LmToProjData: template not specified. Will use the proj_data_info from the input list-mode (which might be quite "
@@ -384,6 +451,8 @@ LmToProjData::set_up()
     }
 
   const int num_segments = template_proj_data_info_ptr->get_num_segments();
+  // used below for parallel time chunks
+  const bool limit_segments_in_memory = num_segments_in_memory != -1 && !interactive;
   if (num_segments_in_memory == -1 || interactive)
     num_segments_in_memory = num_segments;
   else
@@ -469,6 +538,57 @@ LmToProjData::set_up()
             "LmToProjData: num_events_to_store has been selected. The frame duration in the Interfile header will be incorrect!");
     }
 
+  if (time_index_filename.size() != 0)
+    {
+      auto time_index_sptr = std::make_shared<ListModeTimeIndex>();
+      if (time_index_sptr->read_from_file(time_index_filename) == Succeeded::no)
+        {
+          info(format("LmToProjData: creating time index '{}'. This needs a pass through all list mode data.",
+                      time_index_filename));
+          if (time_index_interval_in_secs <= 0)
+            error("LmToProjData: time index interval has to be positive");
+          if (time_index_sptr->build(*lm_data_ptr, time_index_interval_in_secs) == Succeeded::yes)
+            time_index_sptr->write_to_file(time_index_filename);
+          else
+            {
+              warning("LmToProjData: the list mode data does not support a time index. It will be ignored.");
+              time_index_sptr.reset();
+            }
+        }
+      lm_data_ptr->set_time_index_sptr(time_index_sptr);
+    }
+
+  if (num_parallel_time_chunks > 1)
+    {
+      if (is_null_ptr(lm_data_ptr->get_time_index_sptr()))
+        {
+          warning("LmToProjData: processing time chunks in parallel needs a time index. Frames will be processed sequentially.");
+          num_parallel_time_chunks = 1;
+        }
+      else if (!do_time_frame || interactive)
+        {
+          warning("LmToProjData: processing time chunks in parallel is only possible with time frames and without listing "
+                  "event coordinates. Frames will be processed sequentially.");
+          num_parallel_time_chunks = 1;
+        }
+      else if (!can_process_time_chunks_in_parallel())
+        {
+          warning("LmToProjData: this type of processing does not support parallel time chunks. "
+                  "Frames will be processed sequentially.");
+          num_parallel_time_chunks = 1;
+        }
+    }
+  if (num_parallel_time_chunks > 1 && limit_segments_in_memory)
+    {
+      // Every thread adds events to its own copy of the segments in memory (see process_time_chunks()).
+      // Reduce the number of segments in every batch such that all copies together stay within the limit.
+      const int num_copies = 1 + min(get_max_num_threads(), num_parallel_time_chunks);
+      num_segments_in_memory = max(1, num_segments_in_memory / num_copies);
+      info(format("LmToProjData: using {} segments in memory for every thread when processing time chunks in parallel",
+                  num_segments_in_memory),
+           2);
+    }
+
   _already_setup = true;
   return Succeeded::yes;
 }
@@ -611,6 +731,254 @@ void
 LmToProjData::process_new_time_event(const ListTime&)
 {}
 
+void
+LmToProjData::get_bin_from_event_in_time_chunk(Bin& bin,
+                                               const ListEvent& event,
+                                               const unsigned int,
+                                               const unsigned long) const
+{
+  get_bin_from_event(bin, event);
+}
+
+bool
+LmToProjData::can_process_time_chunks_in_parallel() const
+{
+  // derived classes have to opt in explicitly
+  return typeid(*this) == typeid(LmToProjData);
+}
+
+std::vector<LmToProjData::TimeChunk>
+LmToProjData::find_time_chunks(const double start_time, const double end_time, const int num_chunks) const
+{
+  TimeChunk chunk;
+  chunk.has_start_position = false;
+  chunk.start_position = 0;
+  chunk.start_time = start_time;
+  // see process_data(): an end time of (almost) 0 means reading until the end of the data
+  chunk.end_time = end_time > 0.01 ? end_time : -1.;
+  chunk.is_last_chunk_in_frame = true;
+  std::vector<TimeChunk> chunks(1, chunk);
+
+  const auto time_index_sptr = lm_data_ptr->get_time_index_sptr();
+  if (num_chunks <= 1 || is_null_ptr(time_index_sptr))
+    return chunks;
+
+  // entries strictly inside the frame
+  std::vector<ListModeTimeIndex::Entry> candidates;
+  for (const auto& entry : time_index_sptr->get_entries())
+    if (entry.time_in_secs > start_time && (chunk.end_time < 0 || entry.time_in_secs < chunk.end_time))
+      candidates.push_back(entry);
+
+  const std::size_t num_boundaries = std::min(candidates.size(), static_cast<std::size_t>(num_chunks - 1));
+  for (std::size_t boundary_num = 1; boundary_num <= num_boundaries; ++boundary_num)
+    {
+      const auto& entry = candidates[(boundary_num * candidates.size()) / (num_boundaries + 1)];
+      if (entry.time_in_secs <= chunks.back().start_time)
+        continue;
+      // The time tag of this entry is the first one with a time >= entry.time_in_secs (see ListModeTimeIndex::build()).
+      // So, the previous chunk stops after it, and the new chunk starts at its position.
+      chunks.back().end_time = entry.time_in_secs;
+      chunks.back().is_last_chunk_in_frame = false;
+      chunk.has_start_position = true;
+      chunk.start_position = entry.position;
+      chunk.start_time = entry.time_in_secs;
+      chunks.push_back(chunk);
+    }
+  return chunks;
+}
+
+Succeeded
+LmToProjData::for_each_record_in_time_chunk(const TimeChunk& chunk,
+                                            const std::function<void(const ListRecord&, const double)>& process_record) const
+{
+  const std::string filename = input_filename.size() != 0 ? input_filename : lm_data_ptr->get_name();
+  shared_ptr<ListModeData> chunk_lm_data_sptr;
+  // Note: when chunk_lm_data_sptr is destroyed, classes reading data with HDF5 close their files in the same critical section
+#ifdef STIR_OPENMP
+#  pragma omp critical(LISTMODEIO)
+#endif
+  chunk_lm_data_sptr = read_from_file<ListModeData>(filename);
+  if (is_null_ptr(chunk_lm_data_sptr))
+    return Succeeded::no;
+  chunk_lm_data_sptr->set_time_index_sptr(lm_data_ptr->get_time_index_sptr());
+
+  shared_ptr<ListRecord> record_sptr = chunk_lm_data_sptr->get_empty_record_sptr();
+  ListRecord& record = *record_sptr;
+
+  double current_time = 0;
+  if (chunk.has_start_position)
+    {
+      if (chunk_lm_data_sptr->set_persistent_position(chunk.start_position) == Succeeded::no)
+        return Succeeded::no;
+      current_time = chunk.start_time;
+    }
+  else
+    {
+      // go to the start of the frame in the same way as process_data() does
+      if (chunk_lm_data_sptr->seek_to_time(current_time, chunk.start_time) == Succeeded::no)
+        {
+          if (chunk_lm_data_sptr->reset() == Succeeded::no)
+            return Succeeded::no;
+          current_time = 0;
+        }
+      while (current_time < chunk.start_time && chunk_lm_data_sptr->get_next_record(record) == Succeeded::yes)
+        {
+          if (record.is_time())
+            current_time = record.time().get_time_in_secs();
+        }
+      // If the first time tag in the frame is already the start of the next chunk, this one is empty.
+      if (!chunk.is_last_chunk_in_frame && current_time >= chunk.end_time)
+        return Succeeded::yes;
+    }
+
+  while (chunk_lm_data_sptr->get_next_record(record) == Succeeded::yes)
+    {
+      if (record.is_time())
+        {
+          current_time = record.time().get_time_in_secs();
+          if (chunk.end_time >= 0 && current_time >= chunk.end_time)
+            {
+              // This time tag ends the frame, or starts the next chunk. In the latter case,
+              // the next chunk starts just after it, so we need to process it here.
+              if (!chunk.is_last_chunk_in_frame)
+                process_record(record, current_time);
+              break;
+            }
+        }
+      process_record(record, current_time);
+    }
+  return Succeeded::yes;
+}
+
+void
+LmToProjData::process_time_chunks(VectorWithOffset<VectorWithOffset<segment_type*>>& segments,
+                                  const int start_timing_pos_index,
+                                  const int end_timing_pos_index,
+                                  const int start_segment_index,
+                                  const int end_segment_index,
+                                  const shared_ptr<const ProjDataInfo>& output_proj_data_info_sptr,
+                                  long& num_prompts_in_frame,
+                                  long& num_delayeds_in_frame,
+                                  long& num_stored_events,
+                                  double& time_of_last_stored_event)
+{
+  static ProfilingCounter events_counter("events processed");
+
+  const ProjDataInfo& output_proj_data_info = *output_proj_data_info_sptr;
+  const int num_chunks = static_cast<int>(time_chunks.size());
+  // every thread adds events to its own partial histogram. These are summed at the end.
+  std::vector<VectorWithOffset<VectorWithOffset<segment_type*>>> local_segments(get_max_num_threads());
+  std::vector<long> num_prompts_in_chunk(num_chunks, 0L);
+  std::vector<long> num_delayeds_in_chunk(num_chunks, 0L);
+  std::vector<long> num_stored_events_in_chunk(num_chunks, 0L);
+  std::vector<double> last_time_in_chunk(num_chunks, 0.);
+  std::atomic<bool> read_error(false);
+  std::atomic<bool> geometry_error(false);
+
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
+  for (int chunk_num = 0; chunk_num < num_chunks; ++chunk_num)
+    {
+#ifdef STIR_OPENMP
+      const int thread_num = omp_get_thread_num();
+#else
+      const int thread_num = 0;
+#endif
+      VectorWithOffset<VectorWithOffset<segment_type*>>& my_segments = local_segments[thread_num];
+      if (my_segments.size() == 0)
+        {
+          my_segments.resize(segments.get_min_index(), segments.get_max_index());
+          for (int timing_pos_num = my_segments.get_min_index(); timing_pos_num <= my_segments.get_max_index(); ++timing_pos_num)
+            my_segments[timing_pos_num].resize(segments[timing_pos_num].get_min_index(),
+                                               segments[timing_pos_num].get_max_index());
+          allocate_segments(my_segments,
+                            start_timing_pos_index,
+                            end_timing_pos_index,
+                            start_segment_index,
+                            end_segment_index,
+                            output_proj_data_info_sptr);
+        }
+
+      unsigned long event_num_in_chunk = 0;
+      const auto process_record = [&](const ListRecord& record, const double current_time) {
+        last_time_in_chunk[chunk_num] = current_time;
+        if (record.is_time())
+          process_new_time_event(record.time());
+        if (!record.is_event())
+          return;
+
+        Bin bin;
+        // set value in case the event decoder doesn't touch it
+        // otherwise it would be 0 and all events will be ignored
+        bin.set_bin_value(1.f);
+        bin.time_frame_num() = current_frame_num;
+        try
+          {
+            get_bin_from_event_in_time_chunk(bin, record.event(), static_cast<unsigned>(chunk_num), event_num_in_chunk++);
+          }
+        catch (...)
+          {
+            geometry_error = true;
+            return;
+          }
+
+        // check if it's inside the range we want to store (see process_data())
+        if (bin.get_bin_value() <= 0 || bin.tangential_pos_num() < output_proj_data_info.get_min_tangential_pos_num()
+            || bin.tangential_pos_num() > output_proj_data_info.get_max_tangential_pos_num()
+            || bin.axial_pos_num() < output_proj_data_info.get_min_axial_pos_num(bin.segment_num())
+            || bin.axial_pos_num() > output_proj_data_info.get_max_axial_pos_num(bin.segment_num())
+            || bin.timing_pos_num() < start_timing_pos_index || bin.timing_pos_num() > end_timing_pos_index
+            || bin.segment_num() < start_segment_index || bin.segment_num() > end_segment_index)
+          return;
+
+        const int event_increment = record.event().is_prompt() ? (store_prompts ? 1 : 0) : delayed_increment;
+        if (event_increment == 0)
+          return;
+
+        do_post_normalisation(bin);
+        num_stored_events_in_chunk[chunk_num] += event_increment;
+        if (record.event().is_prompt())
+          ++num_prompts_in_chunk[chunk_num];
+        else
+          ++num_delayeds_in_chunk[chunk_num];
+        (*my_segments[bin.timing_pos_num()][bin.segment_num()])[bin.view_num()][bin.axial_pos_num()][bin.tangential_pos_num()]
+            += bin.get_bin_value() * event_increment;
+      };
+
+      if (for_each_record_in_time_chunk(time_chunks[chunk_num], process_record) == Succeeded::no)
+        read_error = true;
+      events_counter.add(event_num_in_chunk);
+    }
+
+  // add partial histograms to the output
+  for (auto& my_segments : local_segments)
+    {
+      if (my_segments.size() == 0)
+        continue;
+      for (int timing_pos_num = start_timing_pos_index; timing_pos_num <= end_timing_pos_index; timing_pos_num++)
+        for (int seg = start_segment_index; seg <= end_segment_index; seg++)
+          {
+            *segments[timing_pos_num][seg] += *my_segments[timing_pos_num][seg];
+            delete my_segments[timing_pos_num][seg];
+          }
+    }
+
+  if (read_error)
+    error(format("LmToProjData: error reading time chunks of frame {}", current_frame_num));
+  if (geometry_error)
+    error("Something wrong with geometry.");
+
+  for (int chunk_num = 0; chunk_num < num_chunks; ++chunk_num)
+    {
+      num_prompts_in_frame += num_prompts_in_chunk[chunk_num];
+      num_delayeds_in_frame += num_delayeds_in_chunk[chunk_num];
+      num_stored_events += num_stored_events_in_chunk[chunk_num];
+      time_of_last_stored_event = max(time_of_last_stored_event, last_time_in_chunk[chunk_num]);
+    }
+  current_time = max(current_time, last_time_in_chunk[num_chunks - 1]);
+}
+
 void
 LmToProjData::start_new_time_frame(const unsigned int)
 {}
@@ -630,6 +998,10 @@ LmToProjData::process_data()
   CPUTimer timer;
   timer.start();
 
+  static ProfilingScope list_mode_processing_scope("list mode processing");
+  static ProfilingScope io_scope("I/O");
+  static ProfilingCounter events_counter("events processed");
+
   bool writing_to_file = false;
 
   // propagate relevant metadata
@@ -666,6 +1038,8 @@ LmToProjData::process_data()
 
   double time_of_last_stored_event = 0;
   long num_stored_events = 0;
+  // will be set when a frame was processed in time chunks (without using lm_data_ptr)
+  bool reposition_lm_data = false;
   VectorWithOffset<segment_type*> segments(template_proj_data_info_ptr->get_min_segment_num(),
                                            template_proj_data_info_ptr->get_max_segment_num());
 
@@ -679,6 +1053,15 @@ LmToProjData::process_data()
   /* Here starts the main loop which will store the listmode data. */
   for (current_frame_num = 1; current_frame_num <= frame_defs.get_num_frames(); ++current_frame_num)
     {
+      // find time chunks before calling start_new_time_frame(), as derived classes might need them
+      time_chunks.clear();
+      if (num_parallel_time_chunks > 1)
+        {
+          time_chunks = find_time_chunks(
+              frame_defs.get_start_time(current_frame_num), frame_defs.get_end_time(current_frame_num), num_parallel_time_chunks);
+          if (time_chunks.size() == 1)
+            time_chunks.clear();
+        }
       start_new_time_frame(current_frame_num);
 
       // construct ExamInfo appropriate for a single projdata with this time frame
@@ -697,7 +1080,8 @@ LmToProjData::process_data()
           sprintf(rest, "_f%dg1d0b0", current_frame_num);
           const string output_filename = output_filename_prefix + rest;
 
-          output_proj_data_sptr = construct_proj_data(output, output_filename, this_frame_exam_info, template_proj_data_info_ptr);
+          output_proj_data_sptr = construct_proj_data(
+              output, output_filename, this_frame_exam_info, template_proj_data_info_ptr, output_compression_level);
         }
 
       long num_prompts_in_frame = 0;
@@ -748,8 +1132,31 @@ LmToProjData::process_data()
               // just set more_events to 1, and never change it
               unsigned long int more_events = do_time_frame ? 1 : num_events_to_store;
 
-              if (start_segment_index != output_proj_data_sptr->get_min_segment_num()
-                  || start_timing_pos_index > output_proj_data_sptr->get_min_tof_pos_num())
+              if (!time_chunks.empty())
+                {
+                  if (start_segment_index == output_proj_data_sptr->get_min_segment_num()
+                      && start_timing_pos_index == output_proj_data_sptr->get_min_tof_pos_num())
+                    cerr << "\nProcessing time frame " << current_frame_num << " in " << time_chunks.size() << " time chunks\n";
+                  else
+                    cerr << "\nProcessing next batch of segments for start TOF bin " << start_timing_pos_index << "\n";
+                  TimedBlock<ProfilingScope> timed_block(list_mode_processing_scope);
+                  process_time_chunks(segments,
+                                      start_timing_pos_index,
+                                      end_timing_pos_index,
+                                      start_segment_index,
+                                      end_segment_index,
+                                      output_proj_data_sptr->get_proj_data_info_sptr(),
+                                      num_prompts_in_frame,
+                                      num_delayeds_in_frame,
+                                      num_stored_events,
+                                      time_of_last_stored_event);
+                  // skip the serial loop below
+                  more_events = 0;
+                  // the main list mode object will need to be positioned for the next frame
+                  reposition_lm_data = true;
+                }
+              else if (start_segment_index != output_proj_data_sptr->get_min_segment_num()
+                       || start_timing_pos_index > output_proj_data_sptr->get_min_tof_pos_num())
                 {
                   // we're going once more through the data (for the next batch of segments)
                   cerr << "\nProcessing next batch of segments for start TOF bin " << start_timing_pos_index << "\n";
@@ -765,6 +1172,25 @@ LmToProjData::process_data()
                   // need to set it. In fact, setting it to start_time would be wrong
                   // as we first might have to skip some events before we get to start_time.
                   // So, let's do that now.
+                  // If we have a time index, we use it to skip most of the records.
+                  // This is only useful if its entry is after the current position (or if we have to reposition anyway).
+                  ListModeTimeIndex::Entry entry;
+                  const auto time_index_sptr = lm_data_ptr->get_time_index_sptr();
+                  const bool time_index_skips_records
+                      = !is_null_ptr(time_index_sptr) && time_index_sptr->find_entry_before(entry, start_time) == Succeeded::yes
+                        && entry.time_in_secs > current_time;
+                  if (time_index_skips_records || reposition_lm_data)
+                    {
+                      double time_of_new_position;
+                      if (lm_data_ptr->seek_to_time(time_of_new_position, start_time) == Succeeded::yes)
+                        current_time = time_of_new_position;
+                      else if (reposition_lm_data)
+                        {
+                          lm_data_ptr->reset();
+                          current_time = 0;
+                        }
+                      reposition_lm_data = false;
+                    }
                   while (current_time < start_time && lm_data_ptr->get_next_record(record) == Succeeded::yes)
                     {
                       if (record.is_time())
@@ -774,6 +1200,8 @@ LmToProjData::process_data()
                   frame_start_positions[current_frame_num] = lm_data_ptr->save_get_position();
                 }
               {
+                TimedBlock<ProfilingScope> timed_block(list_mode_processing_scope);
+                long num_events_processed = 0;
                 // loop over all events in the listmode file
                 while (more_events)
                   {
@@ -795,6 +1223,7 @@ LmToProjData::process_data()
                     // and there might be a scanner around that has them both combined.
                     if (record.is_event())
                       {
+                        ++num_events_processed;
                         assert(start_time <= current_time);
                         Bin bin;
                         // set value in case the event decoder doesn't touch it
@@ -887,16 +1316,20 @@ LmToProjData::process_data()
                   }     // end of while loop over all events
 
                 time_of_last_stored_event = max(time_of_last_stored_event, current_time);
+                events_counter.add(num_events_processed);
               }
 
               if (!interactive)
-                save_and_delete_segments(output,
-                                         segments,
-                                         start_timing_pos_index,
-                                         end_timing_pos_index,
-                                         start_segment_index,
-                                         end_segment_index,
-                                         *output_proj_data_sptr);
+                {
+                  TimedBlock<ProfilingScope> timed_block(io_scope);
+                  save_and_delete_segments(output,
+                                           segments,
+                                           start_timing_pos_index,
+                                           end_timing_pos_index,
+                                           start_segment_index,
+                                           end_segment_index,
+                                           *output_proj_data_sptr);
+                }
             } // end of for loop for segment range
 
         } // end of for loop for timing positions
@@ -954,8 +1387,8 @@ LmToProjData::run_tof_test_function()
         sprintf(rest, "_f%dg1d0b0", current_frame_num);
         const string output_filename = output_filename_prefix + rest;
 
-        proj_data_sptr =
-                construct_proj_data(output, output_filename, this_frame_exam_info, template_proj_data_info_ptr);
+        proj_data_sptr = construct_proj_data(
+            output, output_filename, this_frame_exam_info, template_proj_data_info_ptr, output_compression_level);
     }
 
     for (int current_timing_pos_index = proj_data_sptr->get_min_tof_pos_num();
@@ -1061,12 +1494,20 @@ static shared_ptr<ProjData>
 construct_proj_data(shared_ptr<iostream>& output,
                     const string& output_filename,
                     const ExamInfo& exam_info,
-                    const shared_ptr<const ProjDataInfo>& proj_data_info_ptr)
+                    const shared_ptr<const ProjDataInfo>& proj_data_info_ptr,
+                    const int compression_level)
 {
   shared_ptr<ExamInfo> exam_info_sptr(new ExamInfo(exam_info));
 #ifdef USE_SegmentByView
   shared_ptr<ProjData> proj_data_sptr;
   // don't need output stream in this case
+#  ifdef HAVE_ZLIB
+  if (compression_level > 0)
+    {
+      proj_data_sptr.reset(new ProjDataCompressed(exam_info_sptr, proj_data_info_ptr, output_filename, compression_level));
+      return proj_data_sptr;
+    }
+#  endif
   if (!proj_data_info_ptr->is_tof_data())
     proj_data_sptr.reset(new ProjDataInterfile(exam_info_sptr,
                                                proj_data_info_ptr,
@@ -28,16 +28,18 @@
 #include "stir/error.h"
 #include "stir/warning.h"
 #include "stir/format.h"
+#include "stir/is_null_ptr.h"
+#include "stir/numerics/Philox4x32.h"
 #include <iostream>
 #include <algorithm>
+#include <type_traits>
+#include <typeinfo>
+#include <atomic>
+#include <numeric>
 
 using std::cerr;
 using std::endl;
 
-#include <boost/random/uniform_int.hpp>
-#include <boost/random/mersenne_twister.hpp>
-#include <boost/random/variate_generator.hpp>
-
 START_NAMESPACE_STIR
 
 template <typename LmToProjDataT>
@@ -113,17 +115,11 @@ LmToProjDataBootstrap<LmToProjDataT>::set_up()
 }
 
 template <typename LmToProjDataT>
-void
-LmToProjDataBootstrap<LmToProjDataT>::start_new_time_frame(const unsigned int new_frame_num)
+unsigned int
+LmToProjDataBootstrap<LmToProjDataT>::count_events_in_frame(const unsigned int frame_num)
 {
-
-  base_type::start_new_time_frame(new_frame_num);
-  ListModeData::SavedPosition start_of_this_frame = this->lm_data_ptr->save_get_position();
-
-  warning("LmToProjDataBootstrap: the number of events printed at the end is not correct! check that via manip_projdata");
-
-  const double start_time = this->frame_defs.get_start_time(new_frame_num);
-  const double end_time = this->frame_defs.get_end_time(new_frame_num);
+  const double start_time = this->frame_defs.get_start_time(frame_num);
+  const double end_time = this->frame_defs.get_end_time(frame_num);
   // When do_time_frame=true, the number of events is irrelevant, so we
   // just set more_events to 1, and never change it
   long more_events = this->do_time_frame ? 1 : this->num_events_to_store;
@@ -134,8 +130,24 @@ LmToProjDataBootstrap<LmToProjDataT>::start_new_time_frame(const unsigned int ne
   shared_ptr<ListRecord> record_sptr = this->lm_data_ptr->get_empty_record_sptr();
   ListRecord& record = *record_sptr;
 
+  ListModeData::SavedPosition start_of_this_frame = this->lm_data_ptr->save_get_position();
   info("Going through listmode file to find number of events in this frame");
-  double current_time = start_time;
+  // Go to the start of the frame in the same way as LmToProjData::process_data(), such that we
+  // count the same events as it will process. Without a time index, we start from the current
+  // position (which can be before the start of the frame), where the time is this->current_time.
+  double current_time = this->current_time;
+  if (!is_null_ptr(this->lm_data_ptr->get_time_index_sptr()))
+    {
+      // Note that the current position is not necessarily valid when time chunks were used for the previous frame
+      double time_of_new_position;
+      if (this->lm_data_ptr->seek_to_time(time_of_new_position, start_time) == Succeeded::yes)
+        current_time = time_of_new_position;
+      else
+        {
+          this->lm_data_ptr->reset();
+          current_time = 0;
+        }
+    }
   while (more_events)
     {
       if (this->lm_data_ptr->get_next_record(record) == Succeeded::no)
@@ -193,23 +205,77 @@ LmToProjDataBootstrap<LmToProjDataT>::start_new_time_frame(const unsigned int ne
         }     // if (record.is_event())
     }         // while (more_events)
 
-  // now initialise num_times_to_replicate
+  this->lm_data_ptr->set_get_position(start_of_this_frame);
+  return total_num_events_in_this_frame;
+}
+
+template <typename LmToProjDataT>
+unsigned int
+LmToProjDataBootstrap<LmToProjDataT>::count_events_in_time_chunks()
+{
+  const int num_chunks = static_cast<int>(this->time_chunks.size());
+  std::vector<unsigned long> num_events_in_chunk(num_chunks, 0UL);
+  std::atomic<bool> read_error(false);
+
+  info(format("Going through listmode file to find number of events in this frame using {} time chunks", num_chunks));
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
+  for (int chunk_num = 0; chunk_num < num_chunks; ++chunk_num)
+    {
+      unsigned long& num_events = num_events_in_chunk[chunk_num];
+      const auto count_event = [&num_events](const ListRecord& record, const double) {
+        if (record.is_event())
+          ++num_events;
+      };
+      if (this->for_each_record_in_time_chunk(this->time_chunks[chunk_num], count_event) == Succeeded::no)
+        read_error = true;
+    }
+  if (read_error)
+    error("LmToProjDataBootstrap: error reading time chunks");
+
+  first_event_num_in_chunk.resize(num_chunks);
+  unsigned long total_num_events_in_this_frame = 0;
+  for (int chunk_num = 0; chunk_num < num_chunks; ++chunk_num)
+    {
+      first_event_num_in_chunk[chunk_num] = total_num_events_in_this_frame;
+      total_num_events_in_this_frame += num_events_in_chunk[chunk_num];
+    }
+  return static_cast<unsigned int>(total_num_events_in_this_frame);
+}
+
+template <typename LmToProjDataT>
+void
+LmToProjDataBootstrap<LmToProjDataT>::start_new_time_frame(const unsigned int new_frame_num)
+{
+
+  base_type::start_new_time_frame(new_frame_num);
+
+  warning("LmToProjDataBootstrap: the number of events printed at the end is not correct! check that via manip_projdata");
 
-  typedef boost::mt19937 base_generator_type;
-  base_generator_type generator;
-  generator.seed(static_cast<boost::uint32_t>(seed));
+  // time chunks are only used when do_time_frame is true, see LmToProjData::set_up()
+  const unsigned int total_num_events_in_this_frame
+      = this->time_chunks.empty() ? count_events_in_frame(new_frame_num) : count_events_in_time_chunks();
 
-  boost::uniform_int<unsigned> uniform_int_distribution(0U, total_num_events_in_this_frame - 1);
-  boost::variate_generator<base_generator_type, boost::uniform_int<unsigned>> random_int(generator, uniform_int_distribution);
+  // now initialise num_times_to_replicate
 
   num_times_to_replicate.resize(total_num_events_in_this_frame);
 
   std::fill(num_times_to_replicate.begin(), num_times_to_replicate.end(), static_cast<unsigned char>(0));
-  for (unsigned int i = total_num_events_in_this_frame; i != 0; --i)
+  // every draw uses its own random numbers, so the result does not depend on the number of threads
+  const long long num_draws = static_cast<long long>(total_num_events_in_this_frame);
+#ifdef STIR_OPENMP
+#  pragma omp parallel for
+#endif
+  for (long long draw_num = 0; draw_num < num_draws; ++draw_num)
     {
-      const unsigned int event_num = random_int();
-      num_times_to_replicate[event_num] += 1;
+      CounterBasedRandomNumbers random_numbers(seed, static_cast<std::uint64_t>(draw_num));
+      const unsigned int event_num = random_numbers.uniform_int(total_num_events_in_this_frame);
       // warning this did not check for overflow
+#ifdef STIR_OPENMP
+#  pragma omp atomic
+#endif
+      num_times_to_replicate[event_num] += 1;
     }
 
   assert(std::accumulate(num_times_to_replicate.begin(), num_times_to_replicate.end(), 0U) == total_num_events_in_this_frame);
@@ -217,7 +283,6 @@ LmToProjDataBootstrap<LmToProjDataT>::start_new_time_frame(const unsigned int ne
   num_times_to_replicate_iter = num_times_to_replicate.begin();
 
   info(format("Filled in replication vector for {} events.", total_num_events_in_this_frame));
-  this->lm_data_ptr->set_get_position(start_of_this_frame);
 }
 
 template <typename LmToProjDataT>
@@ -235,6 +300,33 @@ LmToProjDataBootstrap<LmToProjDataT>::get_bin_from_event(Bin& bin, const ListEve
   ++num_times_to_replicate_iter;
 }
 
+template <typename LmToProjDataT>
+void
+LmToProjDataBootstrap<LmToProjDataT>::get_bin_from_event_in_time_chunk(Bin& bin,
+                                                                       const ListEvent& event,
+                                                                       const unsigned int chunk_num,
+                                                                       const unsigned long event_num_in_chunk) const
+{
+  const unsigned long event_num = first_event_num_in_chunk[chunk_num] + event_num_in_chunk;
+  assert(event_num < num_times_to_replicate.size());
+  const unsigned char num_times = num_times_to_replicate[event_num];
+  if (num_times > 0)
+    {
+      base_type::get_bin_from_event(bin, event);
+      bin.set_bin_value(bin.get_bin_value() * num_times);
+    }
+  else
+    bin.set_bin_value(-1);
+}
+
+template <typename LmToProjDataT>
+bool
+LmToProjDataBootstrap<LmToProjDataT>::can_process_time_chunks_in_parallel() const
+{
+  // the event hooks of LmToProjDataT are called as well, so only opt in for LmToProjData itself
+  return std::is_same<LmToProjDataT, LmToProjData>::value && typeid(*this) == typeid(LmToProjDataBootstrap<LmToProjDataT>);
+}
+
 // instantiation
 template class LmToProjDataBootstrap<LmToProjData>;
 
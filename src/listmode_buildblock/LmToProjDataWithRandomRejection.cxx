@@ -26,8 +26,11 @@
 #include "stir/Succeeded.h"
 #include "stir/warning.h"
 #include "stir/error.h"
+#include "stir/numerics/Philox4x32.h"
 #include <iostream>
 #include <algorithm>
+#include <type_traits>
+#include <typeinfo>
 
 START_NAMESPACE_STIR
 
@@ -38,6 +41,7 @@ LmToProjDataWithRandomRejection<LmToProjDataT>::set_defaults()
   LmToProjData::set_defaults();
   this->seed = 42;
   this->reject_if_above = .5F;
+  this->event_num_in_frame = 0;
 }
 
 template <typename LmToProjDataT>
@@ -129,18 +133,18 @@ LmToProjDataWithRandomRejection<LmToProjDataT>::start_new_time_frame(const unsig
 {
 
   base_type::start_new_time_frame(new_frame_num);
-  this->random_generator.seed(static_cast<boost::uint32_t>(seed));
+  this->event_num_in_frame = 0;
 }
 
 template <typename LmToProjDataT>
 void
-LmToProjDataWithRandomRejection<LmToProjDataT>::get_bin_from_event(Bin& bin, const ListEvent& event) const
+LmToProjDataWithRandomRejection<LmToProjDataT>::reject_or_get_bin(Bin& bin,
+                                                                  const ListEvent& event,
+                                                                  const unsigned int chunk_num,
+                                                                  const unsigned long event_num) const
 {
-
-  static boost::uniform_01<random_generator_type> random01(random_generator);
-
-  const double randnum = random01();
-  // std::cout << randnum << '\n';
+  CounterBasedRandomNumbers random_numbers(this->seed, event_num, chunk_num);
+  const double randnum = random_numbers.uniform01();
   if (randnum <= this->reject_if_above)
     {
       base_type::get_bin_from_event(bin, event);
@@ -149,6 +153,32 @@ LmToProjDataWithRandomRejection<LmToProjDataT>::get_bin_from_event(Bin& bin, con
     bin.set_bin_value(-1);
 }
 
+template <typename LmToProjDataT>
+void
+LmToProjDataWithRandomRejection<LmToProjDataT>::get_bin_from_event(Bin& bin, const ListEvent& event) const
+{
+  // use the same numbers as when processing the frame as a single time chunk
+  reject_or_get_bin(bin, event, 0U, this->event_num_in_frame++);
+}
+
+template <typename LmToProjDataT>
+void
+LmToProjDataWithRandomRejection<LmToProjDataT>::get_bin_from_event_in_time_chunk(Bin& bin,
+                                                                                 const ListEvent& event,
+                                                                                 const unsigned int chunk_num,
+                                                                                 const unsigned long event_num_in_chunk) const
+{
+  reject_or_get_bin(bin, event, chunk_num, event_num_in_chunk);
+}
+
+template <typename LmToProjDataT>
+bool
+LmToProjDataWithRandomRejection<LmToProjDataT>::can_process_time_chunks_in_parallel() const
+{
+  // the event hooks of LmToProjDataT are called as well, so only opt in for LmToProjData itself
+  return std::is_same<LmToProjDataT, LmToProjData>::value && typeid(*this) == typeid(LmToProjDataWithRandomRejection<LmToProjDataT>);
+}
+
 // instantiation
 template class LmToProjDataWithRandomRejection<LmToProjData>;
 
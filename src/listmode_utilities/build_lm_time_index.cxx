@@ -0,0 +1,107 @@
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup listmode_utilities
+
+  \brief A utility that writes a time index for list mode data.
+
+  \par Usage
+
+  <pre>
+  build_lm_time_index [--interval secs] [--output index_filename] listmode_filename
+  </pre>
+  The interval between entries defaults to 1 second. If no output filename is given,
+  ListModeTimeIndex::get_default_filename() is used.
+
+  The index can then be used by LmToProjData (see its \c time index filename keyword).
+
+  \author STIR contributors
+*/
+#include "stir/listmode/ListModeData.h"
+#include "stir/listmode/ListModeTimeIndex.h"
+#include "stir/is_null_ptr.h"
+#include "stir/IO/read_from_file.h"
+#include "stir/Succeeded.h"
+#include "stir/warning.h"
+#include "stir/info.h"
+#include "stir/format.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+USING_NAMESPACE_STIR
+
+void
+print_usage_and_exit(const std::string& program_name)
+{
+  std::cerr << "Usage: " << program_name << " [--interval secs] [--output index_filename] listmode_file\n"
+            << "\nThe interval between entries in the index defaults to 1 second.\n"
+            << "The output filename defaults to the list mode filename with '.time_index' appended.\n";
+  exit(EXIT_FAILURE);
+}
+
+int
+main(int argc, char* argv[])
+{
+  const char* const program_name = argv[0];
+  // skip program name
+  --argc;
+  ++argv;
+
+  double interval_in_secs = 1.;
+  std::string output_filename;
+
+  // first process command line options
+  while (argc > 0 && argv[0][0] == '-' && argc >= 3)
+    {
+      if (strcmp(argv[0], "--interval") == 0)
+        {
+          interval_in_secs = std::atof(argv[1]);
+          argc -= 2;
+          argv += 2;
+        }
+      else if (strcmp(argv[0], "--output") == 0)
+        {
+          output_filename = argv[1];
+          argc -= 2;
+          argv += 2;
+        }
+      else
+        print_usage_and_exit(program_name);
+    }
+
+  if (argc != 1 || interval_in_secs <= 0)
+    {
+      print_usage_and_exit(program_name);
+    }
+
+  // set filename to last remaining argument
+  const std::string filename(argv[0]);
+  if (output_filename.empty())
+    output_filename = ListModeTimeIndex::get_default_filename(filename);
+
+  shared_ptr<ListModeData> lm_data_sptr(read_from_file<ListModeData>(filename));
+
+  if (is_null_ptr(lm_data_sptr))
+    {
+      warning("Could not read %s", filename.c_str());
+      return EXIT_FAILURE;
+    }
+
+  ListModeTimeIndex time_index;
+  if (time_index.build(*lm_data_sptr, interval_in_secs) == Succeeded::no)
+    {
+      warning(format("{}: could not construct a time index for '{}'. This format might not support it.", program_name, filename));
+      return EXIT_FAILURE;
+    }
+  info(format("{}: writing time index with {} entries to '{}'", program_name, time_index.get_entries().size(), output_filename));
+  return time_index.write_to_file(output_filename) == Succeeded::yes ? EXIT_SUCCESS : EXIT_FAILURE;
+}
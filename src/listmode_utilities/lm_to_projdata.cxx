@@ -23,6 +23,8 @@
 
 #include "stir/listmode/LmToProjData.h"
 #include "stir/IO/InputFileFormatRegistry.h"
+#include "stir/ProfilingRegistry.h"
+#include "stir/TimedBlock.h"
 
 using std::cerr;
 using std::endl;
@@ -62,9 +64,16 @@ main(int argc, char* argv[])
       }
 #endif
     }
+  ProfilingRegistry::instance().set_up_from_environment();
+
   LmToProjData application(argc == 2 ? argv[1] : 0);
   std::cerr << application.parameter_info();
-  application.process_data();
+  {
+    ProfilingScope processing_scope("lm_to_projdata");
+    TimedBlock<ProfilingScope> timed_block(processing_scope);
+    application.process_data();
+  }
+  ProfilingRegistry::instance().write_report_if_requested();
 
   return EXIT_SUCCESS;
 }
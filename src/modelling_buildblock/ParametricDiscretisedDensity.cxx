@@ -24,6 +24,7 @@
 #include "stir/modelling/KineticParameters.h"
 #include "boost/lambda/lambda.hpp"
 #include "stir/DynamicDiscretisedDensity.h"
+#include "stir/VoxelMajorDynamicDensity.h"
 #include "stir/IO/read_from_file.h"
 #include "stir/error.h"
 #include <iostream>
@@ -55,6 +56,13 @@ ParamDiscDensity::ParametricDiscretisedDensity(const DynamicDiscretisedDensity&
   this->set_exam_info(dyn_im.get_exam_info());
 }
 
+TEMPLATE
+ParamDiscDensity::ParametricDiscretisedDensity(const VoxelMajorDynamicDensity& dyn_im)
+    : base_type(dyn_im.get_index_range(), dyn_im.get_origin(), dyn_im.get_grid_spacing())
+{
+  this->set_exam_info(dyn_im.get_exam_info());
+}
+
 TEMPLATE
 ParamDiscDensity::ParametricDiscretisedDensity(const SingleDiscretisedDensityType& im)
     : base_type(im.get_index_range(), im.get_origin(), dynamic_cast<const VoxelsOnCartesianGrid<float>&>(im).get_grid_spacing())
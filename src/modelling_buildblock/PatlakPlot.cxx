@@ -21,6 +21,7 @@
 #include "stir/linear_regression.h"
 #include "stir/warning.h"
 #include "stir/error.h"
+#include <vector>
 
 START_NAMESPACE_STIR
 
@@ -180,12 +181,11 @@ PatlakPlot::apply_linear_regression(ParametricVoxelsOnCartesianGrid& par_image,
   //  const DynamicDiscretisedDensity & dyn_image=this->_dyn_image;
   // TODO check consistency of time-frame definitions
   const unsigned int num_frames = (this->_frame_defs).get_num_frames();
-  unsigned int frame_num;
-  unsigned int starting_frame = this->_starting_frame;
+  const unsigned int starting_frame = this->_starting_frame;
+  const int num_fitted_frames = static_cast<int>(num_frames - starting_frame + 1);
   Array<2, float> patlak_model_array = this->_model_matrix.get_model_array();
-  VectorWithOffset<float> patlak_x(starting_frame - 1, num_frames - 1);
-  VectorWithOffset<float> patlak_y(starting_frame - 1, num_frames - 1);
-  VectorWithOffset<float> weights(starting_frame - 1, num_frames - 1);
+  std::vector<float> patlak_x(num_fitted_frames);
+  const std::vector<float> weights(num_fitted_frames, 1.F);
 
   // Patlak Linear regression is applied to the data in the format:
   // C(t)/Cp(t)=Ki*\int{Cp(t)}/Cp(t)+Vb
@@ -196,52 +196,64 @@ PatlakPlot::apply_linear_regression(ParametricVoxelsOnCartesianGrid& par_image,
   //       it is the integral of Cp on that time frame , \int_{t_start}^{t_end} Cp(t) dt, for each time frame. The same happens
   //       with \int{Cp(t)} All this is handled in the PlasmaData class, and it's not visible here.
   for (unsigned int frame_num = starting_frame; frame_num <= num_frames; ++frame_num)
+    patlak_x[frame_num - starting_frame] = patlak_model_array[1][frame_num] / patlak_model_array[2][frame_num];
+
+  // Do linear_regression for each voxel.
+  // We work per row of voxels (fixed k,j), first copying the time-activity curves of the row into a buffer
+  // where the frames of every voxel are contiguous. This reads every frame-row only once, and
+  // makes the rows independent such that they can be processed in parallel.
+  const int min_k_index = dyn_image[1].get_min_index();
+  const int max_k_index = dyn_image[1].get_max_index();
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
+  for (int k = min_k_index; k <= max_k_index; ++k)
     {
-      patlak_x[frame_num - 1] = patlak_model_array[1][frame_num] / patlak_model_array[2][frame_num];
-      weights[frame_num - 1] = 1;
+      std::vector<float> patlak_y;
+      float slope = 0.F;
+      float y_intersection = 0.F;
+      float variance_of_slope = 0.F;
+      float variance_of_y_intersection = 0.F;
+      float covariance_of_y_intersection_with_slope = 0.F;
+      float chi_square = 0.F;
+
+      const int min_j_index = dyn_image[1][k].get_min_index();
+      const int max_j_index = dyn_image[1][k].get_max_index();
+      for (int j = min_j_index; j <= max_j_index; ++j)
+        {
+          const int min_i_index = dyn_image[1][k][j].get_min_index();
+          const int max_i_index = dyn_image[1][k][j].get_max_index();
+          const int num_voxels = max_i_index - min_i_index + 1;
+          patlak_y.resize(static_cast<std::size_t>(num_voxels * num_fitted_frames));
+          // Our "y" value for the regression is C(t)/Cp(t). C(t) is the dynamic image value.
+          // (remember, these are integrals over the time frame, not single values at discrete t)
+          for (unsigned int frame_num = starting_frame; frame_num <= num_frames; ++frame_num)
+            {
+              const float* const frame_row = &dyn_image[frame_num][k][j][min_i_index];
+              const float plasma_value = patlak_model_array[2][frame_num];
+              float* const y_ptr = &patlak_y[frame_num - starting_frame];
+              for (int i = 0; i < num_voxels; ++i)
+                y_ptr[i * num_fitted_frames] = frame_row[i] / plasma_value;
+            }
+          for (int i = min_i_index; i <= max_i_index; ++i)
+            {
+              const float* const tac_ptr = &patlak_y[(i - min_i_index) * num_fitted_frames];
+              // Apply the regression to this pixel
+              linear_regression(y_intersection,
+                                slope,
+                                chi_square,
+                                variance_of_y_intersection,
+                                variance_of_slope,
+                                covariance_of_y_intersection_with_slope,
+                                tac_ptr,
+                                tac_ptr + num_fitted_frames,
+                                patlak_x.begin(),
+                                weights.begin());
+              par_image[k][j][i][2] = y_intersection;
+              par_image[k][j][i][1] = slope;
+            }
+        }
     }
-  { // Do linear_regression for each voxel // for k j i
-    float slope = 0.F;
-    float y_intersection = 0.F;
-    float variance_of_slope = 0.F;
-    float variance_of_y_intersection = 0.F;
-    float covariance_of_y_intersection_with_slope = 0.F;
-    float chi_square = 0.F;
-
-    const int min_k_index = dyn_image[1].get_min_index();
-    const int max_k_index = dyn_image[1].get_max_index();
-    for (int k = min_k_index; k <= max_k_index; ++k)
-      {
-        const int min_j_index = dyn_image[1][k].get_min_index();
-        const int max_j_index = dyn_image[1][k].get_max_index();
-        for (int j = min_j_index; j <= max_j_index; ++j)
-          {
-            const int min_i_index = dyn_image[1][k][j].get_min_index();
-            const int max_i_index = dyn_image[1][k][j].get_max_index();
-            for (int i = min_i_index; i <= max_i_index; ++i)
-              {
-                // Patlak Linear regression is applied to the data in the format:
-                // C(t)/Cp(t)=Ki*\int{Cp(t)}/Cp(t)+Vb
-                // therefore our "y" value for the regression is C(t)/Cp(t). C(t) is the dynamic image value.
-                // (remember, these are integrals over the time frame, not single values at discrete t)
-                for (frame_num = starting_frame; frame_num <= num_frames; ++frame_num)
-                  patlak_y[frame_num - 1] = dyn_image[frame_num][k][j][i] / patlak_model_array[2][frame_num];
-                // Apply the regression to this pixel
-                linear_regression(y_intersection,
-                                  slope,
-                                  chi_square,
-                                  variance_of_y_intersection,
-                                  variance_of_slope,
-                                  covariance_of_y_intersection_with_slope,
-                                  patlak_y,
-                                  patlak_x,
-                                  weights);
-                par_image[k][j][i][2] = y_intersection;
-                par_image[k][j][i][1] = slope;
-              }
-          }
-      }
-  }
 }
 
 void
@@ -314,6 +326,100 @@ PatlakPlot::get_dynamic_image_from_parametric_image(DynamicDiscretisedDensity& d
   this->_model_matrix.multiply_parametric_image_with_model(dyn_image, par_image);
 }
 
+void
+PatlakPlot::scale_model_matrix_for_image(const VoxelMajorDynamicDensity& dyn_image) const
+{
+  if (this->_in_correct_scale)
+    return;
+#ifndef NDEBUG
+  this->_model_matrix.write_to_file("patlak_matrix_not_in_correct_scale.txt");
+#endif // NDEBUG
+  if (dyn_image.get_scanner_default_bin_size() <= 0)
+    error("PatlakPlot: The dynamic image currently needs to know the Scanner's default_bin_size. Did you set the "
+          "'originating system'?");
+  this->_model_matrix.scale_model_matrix(dyn_image.get_grid_spacing()[2] / dyn_image.get_scanner_default_bin_size());
+#ifndef NDEBUG
+  this->_model_matrix.write_to_file("patlak_matrix_in_correct_scale.txt");
+#endif // NDEBUG
+}
+
+void
+PatlakPlot::apply_linear_regression(ParametricVoxelsOnCartesianGrid& par_image, const VoxelMajorDynamicDensity& dyn_image) const
+{
+  this->scale_model_matrix_for_image(dyn_image);
+  // TODO check consistency of time-frame definitions
+  const unsigned int num_frames = (this->_frame_defs).get_num_frames();
+  const unsigned int starting_frame = this->_starting_frame;
+  const int num_fitted_frames = static_cast<int>(num_frames - starting_frame + 1);
+  Array<2, float> patlak_model_array = this->_model_matrix.get_model_array();
+  std::vector<float> patlak_x(num_fitted_frames);
+  const std::vector<float> weights(num_fitted_frames, 1.F);
+  // see the DynamicDiscretisedDensity version for the definition of "x" and "y"
+  for (unsigned int frame_num = starting_frame; frame_num <= num_frames; ++frame_num)
+    patlak_x[frame_num - starting_frame] = patlak_model_array[1][frame_num] / patlak_model_array[2][frame_num];
+
+  const int min_k_index = dyn_image.get_index_range().get_min_index();
+  const int max_k_index = dyn_image.get_index_range().get_max_index();
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
+  for (int k = min_k_index; k <= max_k_index; ++k)
+    {
+      std::vector<float> patlak_y(num_fitted_frames);
+      float slope = 0.F;
+      float y_intersection = 0.F;
+      float variance_of_slope = 0.F;
+      float variance_of_y_intersection = 0.F;
+      float covariance_of_y_intersection_with_slope = 0.F;
+      float chi_square = 0.F;
+
+      for (int j = dyn_image[k].get_min_index(); j <= dyn_image[k].get_max_index(); ++j)
+        for (int i = dyn_image[k][j].get_min_index(); i <= dyn_image[k][j].get_max_index(); ++i)
+          {
+            // the time-activity curve is contiguous, so only the division by the plasma value remains
+            const float* const tac_ptr = &dyn_image[k][j][i][starting_frame];
+            for (int f = 0; f < num_fitted_frames; ++f)
+              patlak_y[f] = tac_ptr[f] / patlak_model_array[2][starting_frame + f];
+            linear_regression(y_intersection,
+                              slope,
+                              chi_square,
+                              variance_of_y_intersection,
+                              variance_of_slope,
+                              covariance_of_y_intersection_with_slope,
+                              patlak_y.begin(),
+                              patlak_y.end(),
+                              patlak_x.begin(),
+                              weights.begin());
+            par_image[k][j][i][2] = y_intersection;
+            par_image[k][j][i][1] = slope;
+          }
+    }
+}
+
+void
+PatlakPlot::multiply_dynamic_image_with_model_gradient(ParametricVoxelsOnCartesianGrid& par_image,
+                                                       const VoxelMajorDynamicDensity& dyn_image) const
+{
+  this->scale_model_matrix_for_image(dyn_image);
+  this->_model_matrix.multiply_dynamic_image_with_model(par_image, dyn_image);
+}
+
+void
+PatlakPlot::multiply_dynamic_image_with_model_gradient_and_add_to_input(ParametricVoxelsOnCartesianGrid& par_image,
+                                                                        const VoxelMajorDynamicDensity& dyn_image) const
+{
+  this->scale_model_matrix_for_image(dyn_image);
+  this->_model_matrix.multiply_dynamic_image_with_model_and_add_to_input(par_image, dyn_image);
+}
+
+void
+PatlakPlot::get_dynamic_image_from_parametric_image(VoxelMajorDynamicDensity& dyn_image,
+                                                    const ParametricVoxelsOnCartesianGrid& par_image) const
+{
+  this->scale_model_matrix_for_image(dyn_image);
+  this->_model_matrix.multiply_parametric_image_with_model(dyn_image, par_image);
+}
+
 unsigned int
 PatlakPlot::get_starting_frame() const
 {
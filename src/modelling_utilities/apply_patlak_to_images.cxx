@@ -74,8 +74,9 @@ main(int argc, char* argv[])
   else
     {
       // Create dynamic images object from input file
-      shared_ptr<DynamicDiscretisedDensity> dyn_image_sptr(read_from_file<DynamicDiscretisedDensity>(argv[2]));
-      const DynamicDiscretisedDensity& dyn_image = *dyn_image_sptr;
+      // Read in voxel-major order, such that the time-activity curve of every voxel is contiguous
+      shared_ptr<VoxelMajorDynamicDensity> dyn_image_sptr(read_from_file<VoxelMajorDynamicDensity>(argv[2]));
+      const VoxelMajorDynamicDensity& dyn_image = *dyn_image_sptr;
       // Create parametric images from input file
       shared_ptr<ParametricVoxelsOnCartesianGrid> par_image_sptr;
       par_image_sptr = MAKE_SHARED<ParametricVoxelsOnCartesianGrid>(dyn_image);
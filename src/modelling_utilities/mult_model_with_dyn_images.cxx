@@ -69,8 +69,9 @@ main(int argc, char* argv[])
       shared_ptr<ParametricVoxelsOnCartesianGrid> par_image_sptr(ParametricVoxelsOnCartesianGrid::read_from_file(argv[1]));
       ParametricVoxelsOnCartesianGrid par_image = *par_image_sptr;
 
-      shared_ptr<DynamicDiscretisedDensity> dyn_image_sptr(read_from_file<DynamicDiscretisedDensity>(argv[2]));
-      const DynamicDiscretisedDensity& dyn_image = *dyn_image_sptr;
+      // Read in voxel-major order, such that the time-activity curve of every voxel is contiguous
+      shared_ptr<VoxelMajorDynamicDensity> dyn_image_sptr(read_from_file<VoxelMajorDynamicDensity>(argv[2]));
+      const VoxelMajorDynamicDensity& dyn_image = *dyn_image_sptr;
 
       // NotToDo: Assertion for the dyn-par images, sizes should not be ncessary ONLY WHEN I will create from dyn_image the
       // par_image...
@@ -19,6 +19,7 @@
 #include "stir/modulo.h"
 #include "stir/array_index_functions.h"
 #include "stir/error.h"
+#include <map>
 START_NAMESPACE_STIR
 
 template <typename T>
@@ -43,13 +44,20 @@ bitreversal(VectorWithOffset<T>& data)
     }
 }
 
-// internal function to create vector of size pow2k with exparray[i] = exp(sign*i*_PI/pow2k)
-static VectorWithOffset<std::complex<float>>
+// internal function to get a vector of size pow2k with exparray[i] = exp(sign*i*_PI/pow2k)
+// These "twiddle factors" are cached (per thread, such that no locking is needed), as they
+// are the same for every FFT of the same size.
+static const VectorWithOffset<std::complex<float>>&
 get_exparray(const int pow2k, const int sign)
 {
-  VectorWithOffset<std::complex<float>> a(pow2k);
-  for (int i = 0; i < pow2k; ++i)
-    a[i] = std::exp(std::complex<float>(0, static_cast<float>((sign * i * _PI) / pow2k)));
+  thread_local std::map<int, VectorWithOffset<std::complex<float>>> cache;
+  VectorWithOffset<std::complex<float>>& a = cache[sign * pow2k];
+  if (a.get_length() != pow2k)
+    {
+      a.grow(0, pow2k - 1);
+      for (int i = 0; i < pow2k; ++i)
+        a[i] = std::exp(std::complex<float>(0, static_cast<float>((sign * i * _PI) / pow2k)));
+    }
   return a;
 }
 
@@ -79,7 +87,7 @@ fourier_1d(T& c, const int sign)
   const int pow2nn = c.get_length(); // ==round(pow(2,nn));
   for (; k < nn; ++k, pow2k *= 2)
     {
-      const auto cur_exparray = get_exparray(pow2k, sign);
+      const auto& cur_exparray = get_exparray(pow2k, sign);
       for (int j = 0; j < pow2nn; j += pow2k * 2)
         for (int i = 0; i < pow2k; ++i)
           {
@@ -182,13 +190,12 @@ fourier_1d_for_real_data(const Array<1, T>& v, const int sign)
 
   // cout << "C: " << c;
   c.resize(n + 1);
+  // exparray[i] * (-i) == exp(i*(sign*i*_PI/n - _PI/2))
+  const auto& exparray = get_exparray(static_cast<int>(n), sign);
   for (unsigned int i = 1; i <= n / 2; ++i)
     {
       const complex_t t1 = (c[i] + std::conj(c[n - i]));
-      // TODO could get exp() from static exparray
-      // the nice thing about this code that it works even when the length is not a power of 2
-      // (but of course, the call to fourier_1d would currently abort in that case)
-      const complex_t t2 = std::exp(complex_t(0, static_cast<T>(sign * (i * _PI) / n - _PI / 2))) * (c[i] - std::conj(c[n - i]));
+      const complex_t t2 = complex_t(0, -1) * complex_t(exparray[i]) * (c[i] - std::conj(c[n - i]));
 
       c[i] = (t1 + t2);
       c[n - i] = std::conj(t1 - t2);
@@ -225,11 +232,12 @@ inverse_fourier_1d_for_real_data_corrupting_input(Array<1, std::complex<T>>& c,
   */
   // assert(fabs(c[0].imag())<=.001*norm(c.begin_all(),c.end_all())/sqrt(n+1.)); // note divide by n+1 to avoid division by 0
   // assert(fabs(c[n].imag())<=.001*norm(c.begin_all(),c.end_all())/sqrt(n+1.));
+  // exparray[i] * i == exp(i*(-sign*i*_PI/n + _PI/2))
+  const auto& exparray = get_exparray(n, -sign);
   for (int i = 1; i <= n / 2; ++i)
     {
       const complex_t t1 = (c[i] + std::conj(c[n - i]));
-      // TODO could get exp() from static exparray
-      const complex_t t2 = std::exp(complex_t(0, static_cast<T>(-sign * (i * _PI) / n + _PI / 2))) * (c[i] - std::conj(c[n - i]));
+      const complex_t t2 = complex_t(0, 1) * complex_t(exparray[i]) * (c[i] - std::conj(c[n - i]));
 
       c[i] = (t1 + t2);
       c[n - i] = std::conj(t1 - t2);
@@ -32,6 +32,8 @@
 #include "stir/format.h"
 #include "stir/is_null_ptr.h"
 #include "stir/DataProcessor.h"
+#include "stir/ProfilingRegistry.h"
+#include "stir/TimedBlock.h"
 #include <vector>
 #ifdef STIR_OPENMP
 #  include "stir/is_null_ptr.h"
@@ -263,6 +265,9 @@ BackProjectorByBin::back_project(const RelatedViewgrams<float>& viewgrams,
   if (!_density_sptr)
     error("You need to call start_accumulating_in_new_target() before back_project()");
 
+  static ProfilingScope back_projection_scope("back projection");
+  TimedBlock<ProfilingScope> timed_block(back_projection_scope);
+
   check(*viewgrams.get_proj_data_info_sptr());
 
 #ifdef STIR_OPENMP
@@ -22,12 +22,18 @@
 #include "stir/recon_buildblock/TrivialDataSymmetriesForBins.h"
 #include "stir/recon_buildblock/find_basic_vs_nums_in_subsets.h"
 #include "stir/RelatedViewgrams.h"
+#include "stir/Viewgram.h"
 #include "stir/Bin.h"
 #include "stir/ProjData.h"
+#include "stir/ProjDataInfo.h"
+#include "stir/ViewgramIndices.h"
 #include "stir/is_null_ptr.h"
 #include "stir/Succeeded.h"
 #include "stir/error.h"
 #include "stir/format.h"
+#include "stir/hash.h"
+#include <algorithm>
+#include <cstdint>
 
 START_NAMESPACE_STIR
 
@@ -39,6 +45,7 @@ void
 BinNormalisation::set_defaults()
 {
   this->_already_set_up = false;
+  this->clear_efficiencies_key_info();
 }
 
 BinNormalisation::~BinNormalisation()
@@ -48,6 +55,7 @@ void
 BinNormalisation::set_exam_info_sptr(const shared_ptr<const ExamInfo> _exam_info_sptr)
 {
   this->exam_info_sptr = _exam_info_sptr;
+  this->clear_efficiencies_key_info();
 }
 
 shared_ptr<const ExamInfo>
@@ -60,6 +68,11 @@ Succeeded
 BinNormalisation::set_up(const shared_ptr<const ExamInfo>& exam_info_sptr_v,
                          const shared_ptr<const ProjDataInfo>& proj_data_info_sptr_v)
 {
+  // the factors might depend on the geometry and the time frame
+  if (is_null_ptr(this->proj_data_info_sptr) || is_null_ptr(this->exam_info_sptr) || is_null_ptr(proj_data_info_sptr_v)
+      || is_null_ptr(exam_info_sptr_v) || *this->proj_data_info_sptr != *proj_data_info_sptr_v
+      || !(*this->exam_info_sptr == *exam_info_sptr_v))
+    this->clear_efficiencies_key_info();
   _already_set_up = true;
   this->proj_data_info_sptr = proj_data_info_sptr_v;
   this->exam_info_sptr = exam_info_sptr_v;
@@ -86,38 +99,88 @@ BinNormalisation::check(const ExamInfo& exam_info) const
                  exam_info.parameter_info()));
 }
 
-// TODO remove duplication between apply and undo by just having 1 functino that does the loops
+void
+BinNormalisation::get_efficiencies_for_viewgram(Viewgram<float>& efficiencies) const
+{
+  Bin bin(efficiencies.get_segment_num(), efficiencies.get_view_num(), 0, 0, efficiencies.get_timing_pos_num());
+  for (bin.axial_pos_num() = efficiencies.get_min_axial_pos_num(); bin.axial_pos_num() <= efficiencies.get_max_axial_pos_num();
+       ++bin.axial_pos_num())
+    for (bin.tangential_pos_num() = efficiencies.get_min_tangential_pos_num();
+         bin.tangential_pos_num() <= efficiencies.get_max_tangential_pos_num();
+         ++bin.tangential_pos_num())
+      efficiencies[bin.axial_pos_num()][bin.tangential_pos_num()] = this->get_bin_efficiency(bin);
+}
+
+std::string
+BinNormalisation::get_efficiencies_key_info() const
+{
+  if (!this->_already_set_up)
+    error("BinNormalisation::get_efficiencies_key_info called without calling set_up first.");
+  if (!this->efficiencies_key_info.empty())
+    return this->efficiencies_key_info;
+  // hash of all efficiencies
+  std::uint64_t hash = fnv1a_hash_init;
+  const ProjDataInfo& proj_data_info = *this->proj_data_info_sptr;
+  for (int segment_num = proj_data_info.get_min_segment_num(); segment_num <= proj_data_info.get_max_segment_num();
+       ++segment_num)
+    for (int timing_pos_num = proj_data_info.get_min_tof_pos_num(); timing_pos_num <= proj_data_info.get_max_tof_pos_num();
+         ++timing_pos_num)
+      for (int view_num = proj_data_info.get_min_view_num(); view_num <= proj_data_info.get_max_view_num(); ++view_num)
+        {
+          Viewgram<float> efficiencies
+              = proj_data_info.get_empty_viewgram(ViewgramIndices(view_num, segment_num, timing_pos_num));
+          this->get_efficiencies_for_viewgram(efficiencies);
+          for (auto iter = efficiencies.begin_all_const(); iter != efficiencies.end_all_const(); ++iter)
+            {
+              const float value = *iter;
+              hash = fnv1a_hash(&value, sizeof(value), hash);
+            }
+        }
+  this->efficiencies_key_info = format("{} efficiencies hash: {:016x}", this->get_registered_name(), hash);
+  return this->efficiencies_key_info;
+}
 
 void
-BinNormalisation::apply(RelatedViewgrams<float>& viewgrams) const
+BinNormalisation::clear_efficiencies_key_info() const
+{
+  this->efficiencies_key_info.clear();
+}
+
+//! divide (\a do_apply) or multiply the viewgrams with the efficiencies
+static void
+apply_or_undo_efficiencies(const BinNormalisation& norm, RelatedViewgrams<float>& viewgrams, const bool do_apply)
 {
-  this->check(*viewgrams.get_proj_data_info_sptr());
   for (RelatedViewgrams<float>::iterator iter = viewgrams.begin(); iter != viewgrams.end(); ++iter)
     {
-      Bin bin(iter->get_segment_num(), iter->get_view_num(), 0, 0, iter->get_timing_pos_num());
-      for (bin.axial_pos_num() = iter->get_min_axial_pos_num(); bin.axial_pos_num() <= iter->get_max_axial_pos_num();
-           ++bin.axial_pos_num())
-        for (bin.tangential_pos_num() = iter->get_min_tangential_pos_num();
-             bin.tangential_pos_num() <= iter->get_max_tangential_pos_num();
-             ++bin.tangential_pos_num())
-          (*iter)[bin.axial_pos_num()][bin.tangential_pos_num()] /= std::max(1.E-20F, get_bin_efficiency(bin));
+      Viewgram<float> efficiencies = iter->get_empty_copy();
+      norm.get_efficiencies_for_viewgram(efficiencies);
+      Viewgram<float>::const_full_iterator eff_iter = efficiencies.begin_all_const();
+      Viewgram<float>::full_iterator data_iter = iter->begin_all();
+      if (do_apply)
+        {
+          for (; data_iter != iter->end_all(); ++data_iter, ++eff_iter)
+            *data_iter /= std::max(1.E-20F, *eff_iter);
+        }
+      else
+        {
+          for (; data_iter != iter->end_all(); ++data_iter, ++eff_iter)
+            *data_iter *= *eff_iter;
+        }
     }
 }
 
+void
+BinNormalisation::apply(RelatedViewgrams<float>& viewgrams) const
+{
+  this->check(*viewgrams.get_proj_data_info_sptr());
+  apply_or_undo_efficiencies(*this, viewgrams, /* do_apply = */ true);
+}
+
 void
 BinNormalisation::undo(RelatedViewgrams<float>& viewgrams) const
 {
   this->check(*viewgrams.get_proj_data_info_sptr());
-  for (RelatedViewgrams<float>::iterator iter = viewgrams.begin(); iter != viewgrams.end(); ++iter)
-    {
-      Bin bin(iter->get_segment_num(), iter->get_view_num(), 0, 0, iter->get_timing_pos_num());
-      for (bin.axial_pos_num() = iter->get_min_axial_pos_num(); bin.axial_pos_num() <= iter->get_max_axial_pos_num();
-           ++bin.axial_pos_num())
-        for (bin.tangential_pos_num() = iter->get_min_tangential_pos_num();
-             bin.tangential_pos_num() <= iter->get_max_tangential_pos_num();
-             ++bin.tangential_pos_num())
-          (*iter)[bin.axial_pos_num()][bin.tangential_pos_num()] *= this->get_bin_efficiency(bin);
-    }
+  apply_or_undo_efficiencies(*this, viewgrams, /* do_apply = */ false);
 }
 
 void
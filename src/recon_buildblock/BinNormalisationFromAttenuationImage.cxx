@@ -21,16 +21,36 @@
 #include "stir/recon_buildblock/ForwardProjectorByBinUsingRayTracing.h"
 #include "stir/DiscretisedDensityOnCartesianGrid.h" // used for rescaling attenuation image
 #include "stir/RelatedViewgrams.h"
+#include "stir/ProjDataInMemory.h"
+#include "stir/ProjDataInterfile.h"
+#include "stir/ProjDataFromStream.h"
 #include "stir/ArrayFunction.h"
 #include "stir/Succeeded.h"
 #include "stir/is_null_ptr.h"
 #include "stir/IO/read_from_file.h"
+#include "stir/FilePath.h"
+#include "stir/stream.h"
+#include "stir/info.h"
 #include "stir/warning.h"
 #include "stir/error.h"
 #include "stir/format.h"
+#include "stir/hash.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <sstream>
 
 START_NAMESPACE_STIR
 
+namespace detail
+{
+//! step used to store line integrals as 16-bit integers
+static const float reduced_precision_scale_factor = 1.F / 4096;
+} // namespace detail
+
 const char* const BinNormalisationFromAttenuationImage::registered_name = "From Attenuation Image";
 
 void
@@ -40,6 +60,11 @@ BinNormalisationFromAttenuationImage::set_defaults()
   attenuation_image_ptr.reset();
   forward_projector_ptr.reset();
   attenuation_image_filename = "";
+  precompute_attenuation_correction_factors = false;
+  use_reduced_precision = false;
+  cache_directory = "";
+  line_integrals_sptr.reset();
+  line_integrals_key_info = "";
 }
 
 void
@@ -49,6 +74,9 @@ BinNormalisationFromAttenuationImage::initialise_keymap()
   parser.add_start_key("Bin Normalisation From Attenuation Image");
   parser.add_key("attenuation_image_filename", &attenuation_image_filename);
   parser.add_parsing_key("forward projector type", &forward_projector_ptr);
+  parser.add_key("precompute attenuation correction factors", &precompute_attenuation_correction_factors);
+  parser.add_key("store attenuation correction factors with reduced precision", &use_reduced_precision);
+  parser.add_key("attenuation correction factors cache directory", &cache_directory);
   parser.add_stop_key("End Bin Normalisation From Attenuation Image");
 }
 
@@ -104,6 +132,8 @@ BinNormalisationFromAttenuationImage::BinNormalisationFromAttenuationImage()
 BinNormalisationFromAttenuationImage::BinNormalisationFromAttenuationImage(
     const std::string& filename, shared_ptr<ForwardProjectorByBin> const& forward_projector_ptr)
     : forward_projector_ptr(forward_projector_ptr),
+      precompute_attenuation_correction_factors(false),
+      use_reduced_precision(false),
       attenuation_image_filename(filename)
 {
   attenuation_image_ptr.reset();
@@ -115,32 +145,282 @@ BinNormalisationFromAttenuationImage::BinNormalisationFromAttenuationImage(
     shared_ptr<ForwardProjectorByBin> const& forward_projector_ptr)
     : attenuation_image_ptr(
         attenuation_image_ptr_v->clone()), // need a clone as it guarantees we won't be affected by the caller, and vice versa
-      forward_projector_ptr(forward_projector_ptr)
+      forward_projector_ptr(forward_projector_ptr),
+      precompute_attenuation_correction_factors(false),
+      use_reduced_precision(false)
 {
   post_processing();
 }
 
+void
+BinNormalisationFromAttenuationImage::set_precompute_attenuation_correction_factors(const bool arg)
+{
+  this->precompute_attenuation_correction_factors = arg;
+}
+
+void
+BinNormalisationFromAttenuationImage::set_use_reduced_precision(const bool arg)
+{
+  this->use_reduced_precision = arg;
+}
+
+void
+BinNormalisationFromAttenuationImage::set_attenuation_correction_factors_cache_directory(const std::string& arg)
+{
+  this->cache_directory = arg;
+}
+
+bool
+BinNormalisationFromAttenuationImage::get_precompute_attenuation_correction_factors() const
+{
+  return this->precompute_attenuation_correction_factors || !this->cache_directory.empty();
+}
+
 Succeeded
 BinNormalisationFromAttenuationImage::set_up(const shared_ptr<const ExamInfo>& exam_info_sptr,
                                              const shared_ptr<const ProjDataInfo>& proj_data_info_ptr)
 {
-  if (proj_data_info_ptr->get_num_tof_poss() > 1)
-    error("BinNormalisationFromAttenuationImage limitation: currently can only handle non_TOF data.\n"
-          "You currently have to follow a 2 step procedure:\n"
-          "   1) compute ACF factors without TOF\n"
-          "   2) use this as input for BinNormalisationFromProjData");
+  if (!this->get_precompute_attenuation_correction_factors())
+    {
+      if (proj_data_info_ptr->get_num_tof_poss() > 1)
+        error("BinNormalisationFromAttenuationImage limitation: currently can only handle non_TOF data.\n"
+              "You currently have to follow a 2 step procedure:\n"
+              "   1) compute ACF factors without TOF\n"
+              "   2) use this as input for BinNormalisationFromProjData\n"
+              "or precompute the attenuation correction factors.");
+      line_integrals_sptr.reset();
+      line_integrals_key_info = "";
+    }
   base_type::set_up(exam_info_sptr, proj_data_info_ptr);
-  forward_projector_ptr->set_up(proj_data_info_ptr, attenuation_image_ptr);
-  forward_projector_ptr->set_input(*attenuation_image_ptr);
+  if (!this->get_precompute_attenuation_correction_factors())
+    {
+      forward_projector_ptr->set_up(proj_data_info_ptr, attenuation_image_ptr);
+      forward_projector_ptr->set_input(*attenuation_image_ptr);
+    }
+  else
+    set_up_line_integrals(exam_info_sptr, proj_data_info_ptr->create_non_tof_clone());
   return Succeeded::yes;
 }
 
+std::string
+BinNormalisationFromAttenuationImage::get_line_integrals_key_info(const ProjDataInfo& proj_data_info) const
+{
+  std::uint64_t image_hash = fnv1a_hash_init;
+  for (auto iter = attenuation_image_ptr->begin_all_const(); iter != attenuation_image_ptr->end_all_const(); ++iter)
+    {
+      const float value = *iter;
+      image_hash = fnv1a_hash(&value, sizeof(value), image_hash);
+    }
+  BasicCoordinate<3, int> min_indices, max_indices;
+  if (!attenuation_image_ptr->get_regular_range(min_indices, max_indices))
+    error("BinNormalisationFromAttenuationImage: attenuation image needs to have a regular range");
+  std::ostringstream s;
+  s << "STIR attenuation line integrals, version 1\n"
+    << "reduced precision: " << use_reduced_precision << '\n'
+    << "attenuation image content hash: " << std::hex << image_hash << std::dec << '\n'
+    << "origin: " << attenuation_image_ptr->get_origin() << '\n'
+    << "grid spacing: "
+    << dynamic_cast<DiscretisedDensityOnCartesianGrid<3, float> const&>(*attenuation_image_ptr).get_grid_spacing() << '\n'
+    << "index range: " << min_indices << ' ' << max_indices << '\n'
+    << "forward projector:\n"
+    << forward_projector_ptr->parameter_info() << "projection data:\n"
+    << proj_data_info.parameter_info();
+  return s.str();
+}
+
+std::string
+BinNormalisationFromAttenuationImage::get_efficiencies_key_info() const
+{
+  if (!this->_already_set_up)
+    error("BinNormalisationFromAttenuationImage::get_efficiencies_key_info called without calling set_up first.");
+  return get_line_integrals_key_info(*this->proj_data_info_sptr);
+}
+
 void
-BinNormalisationFromAttenuationImage::apply(RelatedViewgrams<float>& viewgrams) const
+BinNormalisationFromAttenuationImage::set_up_line_integrals(const shared_ptr<const ExamInfo>& exam_info_sptr,
+                                                            const shared_ptr<const ProjDataInfo>& proj_data_info_sptr)
 {
-  this->check(*viewgrams.get_proj_data_info_sptr());
-  RelatedViewgrams<float> attenuation_viewgrams = viewgrams.get_empty_copy();
-  forward_projector_ptr->forward_project(attenuation_viewgrams);
+  const std::string key_info = get_line_integrals_key_info(*proj_data_info_sptr);
+  if (!is_null_ptr(line_integrals_sptr) && key_info == line_integrals_key_info)
+    return; // nothing changed since the previous call
+
+  line_integrals_sptr.reset();
+  line_integrals_key_info = key_info;
+
+  std::string prefix;
+  if (!cache_directory.empty())
+    {
+      if (!FilePath::exists(cache_directory))
+        error(format("BinNormalisationFromAttenuationImage: cache directory '{}' does not exist", cache_directory));
+      FilePath prefix_path(
+          format("attenuation_line_integrals_{:016x}", fnv1a_hash(key_info)), false);
+      prefix_path.prepend_directory_name(cache_directory);
+      prefix = prefix_path.get_as_string();
+
+      std::ifstream key_file(prefix + ".txt");
+      if (key_file)
+        {
+          // check if the stored settings are identical (to protect against hash collisions)
+          const std::string stored_key_info((std::istreambuf_iterator<char>(key_file)), std::istreambuf_iterator<char>());
+          if (stored_key_info == key_info)
+            {
+              try
+                {
+                  line_integrals_sptr = ProjData::read_from_file(prefix + ".hs");
+                  if (*line_integrals_sptr->get_proj_data_info_sptr() != *proj_data_info_sptr)
+                    error("incompatible projection data");
+                  info(format("BinNormalisationFromAttenuationImage: attenuation line integrals read from cache '{}.hs'",
+                              prefix));
+                  return;
+                }
+              catch (std::exception& e)
+                {
+                  warning(format("Error reading attenuation line integrals from cache '{}'. They will be recomputed.\n{}",
+                                 prefix,
+                                 e.what()));
+                  line_integrals_sptr.reset();
+                }
+            }
+          else
+            warning(format("Attenuation cache file '{}.txt' does not match current settings. It will be overwritten.", prefix));
+        }
+    }
+
+  // construct storage
+  const NumericType data_type = use_reduced_precision ? NumericType::USHORT : NumericType::FLOAT;
+  const float scale_factor = use_reduced_precision ? detail::reduced_precision_scale_factor : 1.F;
+  shared_ptr<ProjData> storage_sptr;
+  // reduced precision or file storage
+  shared_ptr<ProjDataFromStream> stream_storage_sptr;
+  if (!prefix.empty())
+    stream_storage_sptr.reset(new ProjDataInterfile(exam_info_sptr,
+                                                    proj_data_info_sptr,
+                                                    prefix + ".hs",
+                                                    std::ios::out,
+                                                    ProjDataFromStream::Segment_View_AxialPos_TangPos,
+                                                    data_type,
+                                                    ByteOrder::native,
+                                                    scale_factor));
+  else if (use_reduced_precision)
+    {
+      // ProjDataFromStream needs a stream of the correct size
+      const std::size_t num_bytes = proj_data_info_sptr->size_all() * data_type.size_in_bytes();
+      shared_ptr<std::iostream> stream_sptr(
+          new std::stringstream(std::string(num_bytes, '\0'), std::ios::in | std::ios::out | std::ios::binary));
+      stream_storage_sptr.reset(new ProjDataFromStream(exam_info_sptr,
+                                                       proj_data_info_sptr,
+                                                       stream_sptr,
+                                                       0,
+                                                       ProjDataFromStream::Segment_View_AxialPos_TangPos,
+                                                       data_type,
+                                                       ByteOrder::native,
+                                                       scale_factor));
+    }
+  if (!is_null_ptr(stream_storage_sptr))
+    {
+      // values are clipped below such that they fit with the fixed scale factor
+      stream_storage_sptr->set_warn_about_scale_factor(false);
+      storage_sptr = stream_storage_sptr;
+    }
+  else
+    storage_sptr.reset(new ProjDataInMemory(exam_info_sptr, proj_data_info_sptr, /* initialise_with_0 */ false));
+
+  info(format("BinNormalisationFromAttenuationImage: computing attenuation line integrals{}",
+              prefix.empty() ? std::string() : " and storing them in '" + prefix + ".hs'"));
+  forward_projector_ptr->set_up(proj_data_info_sptr, attenuation_image_ptr);
+  forward_projector_ptr->set_input(*attenuation_image_ptr);
+  shared_ptr<DataSymmetriesForViewSegmentNumbers> symmetries_sptr(forward_projector_ptr->get_symmetries_used()->clone());
+
+  std::vector<ViewSegmentNumbers> vs_nums_to_process;
+  for (int segment_num = storage_sptr->get_min_segment_num(); segment_num <= storage_sptr->get_max_segment_num(); ++segment_num)
+    for (int view_num = storage_sptr->get_min_view_num(); view_num <= storage_sptr->get_max_view_num(); ++view_num)
+      {
+        const ViewSegmentNumbers vs(view_num, segment_num);
+        if (symmetries_sptr->is_basic(vs))
+          vs_nums_to_process.push_back(vs);
+      }
+
+  const float max_value = use_reduced_precision ? 65535 * detail::reduced_precision_scale_factor : 0.F;
+  std::atomic<bool> failed(false);
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
+  for (int i = 0; i < static_cast<int>(vs_nums_to_process.size()); ++i)
+    {
+      if (failed)
+        continue;
+      try
+        {
+          RelatedViewgrams<float> viewgrams = storage_sptr->get_empty_related_viewgrams(vs_nums_to_process[i], symmetries_sptr);
+          forward_projector_ptr->forward_project(viewgrams);
+          if (use_reduced_precision)
+            {
+              for (auto& viewgram : viewgrams)
+                for (auto iter = viewgram.begin_all(); iter != viewgram.end_all(); ++iter)
+                  *iter = std::min(std::max(*iter, 0.F), max_value);
+            }
+          Succeeded success = Succeeded::yes;
+          std::string error_message;
+          // exceptions cannot leave a critical section, so they are caught inside and reported afterwards
+#ifdef STIR_OPENMP
+#  pragma omp critical(BINNORMALISATIONFROMATTENUATIONIMAGE)
+#endif
+          try
+            {
+              success = storage_sptr->set_related_viewgrams(viewgrams);
+            }
+          catch (std::exception& e)
+            {
+              success = Succeeded::no;
+              error_message = e.what();
+            }
+          // end of critical section
+          if (success != Succeeded::yes)
+            {
+              warning("BinNormalisationFromAttenuationImage: error storing attenuation line integrals\n" + error_message);
+              failed = true;
+            }
+        }
+      catch (std::exception& e)
+        {
+          warning(e.what());
+          failed = true;
+        }
+    }
+  if (failed)
+    error("BinNormalisationFromAttenuationImage: error computing attenuation line integrals");
+
+  if (prefix.empty())
+    line_integrals_sptr = storage_sptr;
+  else
+    {
+      // close the file, and read it back
+      storage_sptr.reset();
+      line_integrals_sptr = ProjData::read_from_file(prefix + ".hs");
+      // write settings last, such that an incomplete cache entry is not used
+      std::ofstream key_file(prefix + ".txt");
+      key_file << key_info;
+      if (!key_file)
+        warning(format("BinNormalisationFromAttenuationImage: error writing '{}.txt'. Cache will not be reused.", prefix));
+    }
+}
+
+RelatedViewgrams<float>
+BinNormalisationFromAttenuationImage::get_attenuation_correction_factors(const RelatedViewgrams<float>& viewgrams) const
+{
+  RelatedViewgrams<float> attenuation_viewgrams;
+  if (is_null_ptr(line_integrals_sptr))
+    {
+      attenuation_viewgrams = viewgrams.get_empty_copy();
+      forward_projector_ptr->forward_project(attenuation_viewgrams);
+    }
+  else
+    {
+      // line integrals are stored for non-TOF data
+      shared_ptr<DataSymmetriesForViewSegmentNumbers> symmetries_sptr(viewgrams.get_symmetries_ptr()->clone());
+      attenuation_viewgrams
+          = line_integrals_sptr->get_related_viewgrams(viewgrams.get_basic_view_segment_num(), symmetries_sptr, false, 0);
+    }
 
   // TODO cannot use std::transform ?
   for (RelatedViewgrams<float>::iterator viewgrams_iter = attenuation_viewgrams.begin();
@@ -149,24 +429,36 @@ BinNormalisationFromAttenuationImage::apply(RelatedViewgrams<float>& viewgrams)
     {
       in_place_exp(*viewgrams_iter);
     }
-  viewgrams *= attenuation_viewgrams;
+  return attenuation_viewgrams;
+}
+
+void
+BinNormalisationFromAttenuationImage::apply(RelatedViewgrams<float>& viewgrams) const
+{
+  this->check(*viewgrams.get_proj_data_info_sptr());
+  viewgrams *= get_attenuation_correction_factors(viewgrams);
 }
 
 void
 BinNormalisationFromAttenuationImage::undo(RelatedViewgrams<float>& viewgrams) const
 {
   this->check(*viewgrams.get_proj_data_info_sptr());
-  RelatedViewgrams<float> attenuation_viewgrams = viewgrams.get_empty_copy();
-  forward_projector_ptr->forward_project(attenuation_viewgrams);
+  viewgrams /= get_attenuation_correction_factors(viewgrams);
+}
 
-  // TODO cannot use std::transform ?
-  for (RelatedViewgrams<float>::iterator viewgrams_iter = attenuation_viewgrams.begin();
-       viewgrams_iter != attenuation_viewgrams.end();
-       ++viewgrams_iter)
-    {
-      in_place_exp(*viewgrams_iter);
-    }
-  viewgrams /= attenuation_viewgrams;
+void
+BinNormalisationFromAttenuationImage::get_efficiencies_for_viewgram(Viewgram<float>& efficiencies) const
+{
+  if (is_null_ptr(line_integrals_sptr))
+    error("BinNormalisationFromAttenuationImage::get_efficiencies_for_viewgram is only implemented when precomputing the "
+          "attenuation correction factors");
+  this->check(*efficiencies.get_proj_data_info_sptr());
+  const Viewgram<float> line_integrals
+      = line_integrals_sptr->get_viewgram(efficiencies.get_view_num(), efficiencies.get_segment_num(), false, 0);
+  Viewgram<float>::const_full_iterator line_integrals_iter = line_integrals.begin_all_const();
+  for (Viewgram<float>::full_iterator iter = efficiencies.begin_all(); iter != efficiencies.end_all();
+       ++iter, ++line_integrals_iter)
+    *iter = std::exp(-*line_integrals_iter);
 }
 
 float
@@ -39,12 +39,14 @@
 #include "stir/IndexRange2D.h"
 #include "stir/IndexRange.h"
 #include "stir/Bin.h"
+#include "stir/Viewgram.h"
 #include "stir/display.h"
 #include "stir/is_null_ptr.h"
 #include "stir/warning.h"
 #include "stir/error.h"
 #include <algorithm>
 #include <fstream>
+#include <vector>
 
 using std::ofstream;
 using std::fstream;
@@ -559,6 +561,96 @@ BinNormalisationFromECAT7::get_uncalibrated_bin_efficiency(const Bin& bin) const
 }
 #endif
 
+void
+BinNormalisationFromECAT7::get_uncalibrated_efficiencies_for_viewgram(Viewgram<float>& efficiencies) const
+{
+#ifndef SAME_AS_PETER
+  if (this->use_dead_time())
+#endif
+    {
+      // dead-time factors are not tabulated (yet), so use the (slow) version that calls get_uncalibrated_bin_efficiency()
+      base_type::get_uncalibrated_efficiencies_for_viewgram(efficiencies);
+      return;
+    }
+
+  const bool use_detector_efficiencies = this->use_detector_efficiencies();
+  const bool use_geometric_factors = this->use_geometric_factors();
+
+  const int segment_num = efficiencies.get_segment_num();
+  const int min_tang_pos_num = efficiencies.get_min_tangential_pos_num();
+  const int num_tang_poss = efficiencies.get_max_tangential_pos_num() - min_tang_pos_num + 1;
+  const int start_view = efficiencies.get_view_num() * mash;
+  const int min_ring_diff = proj_data_info_cyl_ptr->get_min_ring_difference(segment_num);
+  const int max_ring_diff = proj_data_info_cyl_ptr->get_max_ring_difference(segment_num);
+  const int num_rings = proj_data_info_cyl_ptr->get_scanner_ptr()->get_num_rings();
+  // see get_uncalibrated_bin_efficiency() for explanation of this factor
+  const float geo_Z_corr = use_geometric_factors ? detail::calc_geo_z_correction(Bin(segment_num, 0, 0, 0), span) : 1.F;
+
+  // detector numbers and crystal interference factors for every uncompressed view and tangential position
+  std::vector<int> det1_nums(mash * num_tang_poss);
+  std::vector<int> det2_nums(mash * num_tang_poss);
+  std::vector<float> interference_factors(mash * num_tang_poss, 1.F);
+  for (int view_offset = 0; view_offset < mash; ++view_offset)
+    for (int tang_offset = 0; tang_offset < num_tang_poss; ++tang_offset)
+      {
+        const int index = view_offset * num_tang_poss + tang_offset;
+        const int uncompressed_view_num = start_view + view_offset;
+        const int tang_pos_num = min_tang_pos_num + tang_offset;
+        proj_data_info_cyl_uncompressed_ptr->get_det_num_pair_for_view_tangential_pos_num(
+            det1_nums[index], det2_nums[index], uncompressed_view_num, tang_pos_num);
+        if (this->use_crystal_interference_factors())
+          interference_factors[index]
+              = crystal_interference_factors[tang_pos_num][uncompressed_view_num % num_transaxial_crystals_per_block];
+      }
+
+  std::vector<float> lor_efficiency(num_tang_poss);
+  std::vector<float> view_efficiency(num_tang_poss);
+
+  for (int axial_pos_num = efficiencies.get_min_axial_pos_num(); axial_pos_num <= efficiencies.get_max_axial_pos_num();
+       ++axial_pos_num)
+    {
+      // see get_uncalibrated_bin_efficiency() for explanation of the loops
+      const int ring1_plus_ring2 = detail::calc_ring1_plus_ring2(Bin(segment_num, 0, axial_pos_num, 0), proj_data_info_cyl_ptr);
+      std::fill(view_efficiency.begin(), view_efficiency.end(), 0.F);
+
+      for (int view_offset = 0; view_offset < mash; ++view_offset)
+        {
+          const int* const det1_num_ptr = &det1_nums[view_offset * num_tang_poss];
+          const int* const det2_num_ptr = &det2_nums[view_offset * num_tang_poss];
+          const float* const interference_factors_ptr = &interference_factors[view_offset * num_tang_poss];
+          std::fill(lor_efficiency.begin(), lor_efficiency.end(), 0.F);
+
+          for (int ring_diff = min_ring_diff + (min_ring_diff + ring1_plus_ring2) % 2; ring_diff <= max_ring_diff;
+               ring_diff += 2)
+            {
+              const int ring1 = (ring1_plus_ring2 - ring_diff) / 2;
+              const int ring2 = (ring1_plus_ring2 + ring_diff) / 2;
+              if (ring1 < 0 || ring2 < 0 || ring1 >= num_rings || ring2 >= num_rings)
+                continue;
+
+              const float* const eff1_ptr = &efficiency_factors[ring1][0];
+              const float* const eff2_ptr = &efficiency_factors[ring2][0];
+              const float* const geo_ptr = use_geometric_factors ? &geometric_factors[ring1 + ring2][min_tang_pos_num] : nullptr;
+              for (int tang_offset = 0; tang_offset < num_tang_poss; ++tang_offset)
+                {
+                  float lor_efficiency_this_pair = 1.F;
+                  if (use_detector_efficiencies)
+                    lor_efficiency_this_pair = eff1_ptr[det1_num_ptr[tang_offset]] * eff2_ptr[det2_num_ptr[tang_offset]];
+                  if (use_geometric_factors)
+                    lor_efficiency_this_pair *= geo_ptr[tang_offset];
+                  lor_efficiency[tang_offset] += lor_efficiency_this_pair;
+                }
+            }
+
+          for (int tang_offset = 0; tang_offset < num_tang_poss; ++tang_offset)
+            view_efficiency[tang_offset] += lor_efficiency[tang_offset] * interference_factors_ptr[tang_offset];
+        }
+
+      for (int tang_offset = 0; tang_offset < num_tang_poss; ++tang_offset)
+        efficiencies[axial_pos_num][min_tang_pos_num + tang_offset] = view_efficiency[tang_offset] * geo_Z_corr;
+    }
+}
+
 float
 BinNormalisationFromECAT7::get_dead_time_efficiency(const DetectionPosition<>& det_pos) const
 {
@@ -35,6 +35,7 @@
 #include "stir/IndexRange2D.h"
 #include "stir/IndexRange.h"
 #include "stir/Bin.h"
+#include "stir/Viewgram.h"
 #include "stir/ProjDataInMemory.h"
 #include "stir/ProjDataInfo.h"
 #include "stir/ProjDataInterfile.h"
@@ -49,6 +50,7 @@
 #include <algorithm>
 #include <fstream>
 #include <cctype>
+#include <vector>
 using std::ofstream;
 using std::fstream;
 using std::ios;
@@ -515,6 +517,82 @@ BinNormalisationFromGEHDF5::get_uncalibrated_bin_efficiency(const Bin& bin) cons
   return total_efficiency;
 }
 
+void
+BinNormalisationFromGEHDF5::get_uncalibrated_efficiencies_for_viewgram(Viewgram<float>& efficiencies) const
+{
+  const float start_time = get_exam_info_sptr()->get_time_frame_definitions().get_start_time();
+  const float end_time = get_exam_info_sptr()->get_time_frame_definitions().get_end_time();
+
+  const int segment_num = efficiencies.get_segment_num();
+  const int min_tang_pos_num = efficiencies.get_min_tangential_pos_num();
+  const int num_tang_poss = efficiencies.get_max_tangential_pos_num() - min_tang_pos_num + 1;
+  const int start_view = efficiencies.get_view_num() * mash;
+  const int min_ring_diff = proj_data_info_cyl_ptr->get_min_ring_difference(segment_num);
+  const int max_ring_diff = proj_data_info_cyl_ptr->get_max_ring_difference(segment_num);
+
+  // tangential detector coordinates for every uncompressed view and tangential position
+  std::vector<DetectionPositionPair<>> detection_position_pairs(mash * num_tang_poss);
+  for (int view_offset = 0; view_offset < mash; ++view_offset)
+    for (int tang_offset = 0; tang_offset < num_tang_poss; ++tang_offset)
+      {
+        const Bin uncompressed_bin(0, start_view + view_offset, 0, min_tang_pos_num + tang_offset);
+        detail::set_detection_tangential_coords(proj_data_info_cyl_uncompressed_ptr,
+                                                uncompressed_bin,
+                                                detection_position_pairs[view_offset * num_tang_poss + tang_offset]);
+      }
+
+  std::vector<float> lor_efficiency(num_tang_poss);
+  std::vector<float> view_efficiency(num_tang_poss);
+  std::vector<float> total_efficiency(num_tang_poss);
+
+  for (int axial_pos_num = efficiencies.get_min_axial_pos_num(); axial_pos_num <= efficiencies.get_max_axial_pos_num();
+       ++axial_pos_num)
+    {
+      // see get_uncalibrated_bin_efficiency() for explanation of the loops
+      const int ring1_plus_ring2 = detail::calc_ring1_plus_ring2(Bin(segment_num, 0, axial_pos_num, 0), proj_data_info_cyl_ptr);
+      std::fill(view_efficiency.begin(), view_efficiency.end(), 0.F);
+      std::fill(total_efficiency.begin(), total_efficiency.end(), 0.F);
+
+      for (int view_offset = 0; view_offset < mash; ++view_offset)
+        {
+          std::fill(lor_efficiency.begin(), lor_efficiency.end(), 0.F);
+          Bin uncompressed_bin(0, start_view + view_offset, 0, 0);
+          for (uncompressed_bin.segment_num() = min_ring_diff + (min_ring_diff + ring1_plus_ring2) % 2;
+               uncompressed_bin.segment_num() <= max_ring_diff;
+               uncompressed_bin.segment_num() += 2)
+            {
+              for (int tang_offset = 0; tang_offset < num_tang_poss; ++tang_offset)
+                {
+                  DetectionPositionPair<>& detection_position_pair
+                      = detection_position_pairs[view_offset * num_tang_poss + tang_offset];
+                  if (detail::set_detection_axial_coords(
+                          proj_data_info_cyl_ptr, ring1_plus_ring2, uncompressed_bin, detection_position_pair)
+                      < 0)
+                    break; // ring numbers out of range (same for all tangential positions)
+
+                  float lor_efficiency_this_pair = 1.F;
+                  if (this->use_detector_efficiencies())
+                    lor_efficiency_this_pair *= get_efficiency_factors(detection_position_pair);
+                  if (this->use_dead_time())
+                    lor_efficiency_this_pair *= get_dead_time_efficiency(detection_position_pair, start_time, end_time);
+                  if (this->use_geometric_factors())
+                    lor_efficiency_this_pair *= get_geometric_efficiency_factors(detection_position_pair);
+                  lor_efficiency[tang_offset] += lor_efficiency_this_pair;
+                }
+            }
+
+          for (int tang_offset = 0; tang_offset < num_tang_poss; ++tang_offset)
+            {
+              view_efficiency[tang_offset] += lor_efficiency[tang_offset];
+              total_efficiency[tang_offset] += view_efficiency[tang_offset];
+            }
+        }
+
+      for (int tang_offset = 0; tang_offset < num_tang_poss; ++tang_offset)
+        efficiencies[axial_pos_num][min_tang_pos_num + tang_offset] = total_efficiency[tang_offset];
+    }
+}
+
 float
 BinNormalisationFromGEHDF5::get_dead_time_efficiency(const DetectionPositionPair<>& detection_position_pair,
                                                      const double start_time,
@@ -22,6 +22,7 @@
 #include "stir/ProjData.h"
 #include "stir/shared_ptr.h"
 #include "stir/RelatedViewgrams.h"
+#include "stir/Viewgram.h"
 #include "stir/ViewSegmentNumbers.h"
 #include "stir/Succeeded.h"
 #include "stir/warning.h"
@@ -157,6 +158,23 @@ BinNormalisationFromProjData::get_bin_efficiency(const Bin& bin) const
   return 1;
 }
 
+void
+BinNormalisationFromProjData::get_efficiencies_for_viewgram(Viewgram<float>& efficiencies) const
+{
+  this->check(*efficiencies.get_proj_data_info_sptr());
+  const int timing_pos_num = norm_proj_data_ptr->get_proj_data_info_sptr()->is_tof_data() ? efficiencies.get_timing_pos_num() : 0;
+  const Viewgram<float> norm_viewgram
+      = norm_proj_data_ptr->get_viewgram(efficiencies.get_view_num(), efficiencies.get_segment_num(), false, timing_pos_num);
+  // note: efficiencies can have a smaller index range than the norm data
+  for (int ax_pos_num = efficiencies.get_min_axial_pos_num(); ax_pos_num <= efficiencies.get_max_axial_pos_num(); ++ax_pos_num)
+    for (int tang_pos_num = efficiencies.get_min_tangential_pos_num(); tang_pos_num <= efficiencies.get_max_tangential_pos_num();
+         ++tang_pos_num)
+      {
+        const float norm_value = norm_viewgram[ax_pos_num][tang_pos_num];
+        efficiencies[ax_pos_num][tang_pos_num] = norm_value == 0.F ? 0.F : 1.F / norm_value;
+      }
+}
+
 shared_ptr<ProjData>
 BinNormalisationFromProjData::get_norm_proj_data_sptr() const
 {
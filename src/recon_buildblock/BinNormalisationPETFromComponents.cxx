@@ -22,6 +22,7 @@
 #include "stir/ProjDataInMemory.h"
 #include "stir/shared_ptr.h"
 #include "stir/RelatedViewgrams.h"
+#include "stir/Viewgram.h"
 #include "stir/ViewSegmentNumbers.h"
 #include "stir/Succeeded.h"
 #include "stir/warning.h"
@@ -74,6 +75,8 @@ BinNormalisationPETFromComponents::set_up(const shared_ptr<const ExamInfo>& exam
     error("BinNormalisationPETFromComponents: set_up called without allocation");
 
   base_type::set_up(exam_info_sptr, check_proj_data_info_sptr);
+  // the factors can have been modified via crystal_efficiencies() etc
+  this->clear_efficiencies_key_info();
 
   if (*this->proj_data_info_sptr != *check_proj_data_info_sptr)
     return Succeeded::no;
@@ -236,9 +239,27 @@ BinNormalisationPETFromComponents::get_bin_efficiency(const Bin& bin) const
 {
   // need a copy at the moment
   Bin copy(bin);
+  // the efficiencies are the same for all timing positions
+  if (!this->invnorm_proj_data_sptr->get_proj_data_info_sptr()->is_tof_data())
+    copy.timing_pos_num() = 0;
   return this->invnorm_proj_data_sptr->get_bin_value(copy);
 }
 
+void
+BinNormalisationPETFromComponents::get_efficiencies_for_viewgram(Viewgram<float>& efficiencies) const
+{
+  this->check(*efficiencies.get_proj_data_info_sptr());
+  const int timing_pos_num
+      = this->invnorm_proj_data_sptr->get_proj_data_info_sptr()->is_tof_data() ? efficiencies.get_timing_pos_num() : 0;
+  const Viewgram<float> invnorm_viewgram = this->invnorm_proj_data_sptr->get_viewgram(
+      efficiencies.get_view_num(), efficiencies.get_segment_num(), false, timing_pos_num);
+  // copy values only, such that the index ranges and timing position of efficiencies are kept
+  for (int ax_pos_num = efficiencies.get_min_axial_pos_num(); ax_pos_num <= efficiencies.get_max_axial_pos_num(); ++ax_pos_num)
+    for (int tang_pos_num = efficiencies.get_min_tangential_pos_num(); tang_pos_num <= efficiencies.get_max_tangential_pos_num();
+         ++tang_pos_num)
+      efficiencies[ax_pos_num][tang_pos_num] = invnorm_viewgram[ax_pos_num][tang_pos_num];
+}
+
 #if 0
 shared_ptr<ProjData>
 BinNormalisationPETFromComponents::get_norm_proj_data_sptr() const
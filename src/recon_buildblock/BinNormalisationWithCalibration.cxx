@@ -20,6 +20,7 @@
 */
 
 #include "stir/recon_buildblock/BinNormalisationWithCalibration.h"
+#include "stir/Viewgram.h"
 #include "stir/Succeeded.h"
 #include "stir/warning.h"
 #include "stir/error.h"
@@ -72,6 +73,25 @@ BinNormalisationWithCalibration::get_calib_decay_branching_ratio_factor(const Bi
   return this->_calib_decay_branching_ratio;
 }
 
+void
+BinNormalisationWithCalibration::get_uncalibrated_efficiencies_for_viewgram(Viewgram<float>& efficiencies) const
+{
+  Bin bin(efficiencies.get_segment_num(), efficiencies.get_view_num(), 0, 0, efficiencies.get_timing_pos_num());
+  for (bin.axial_pos_num() = efficiencies.get_min_axial_pos_num(); bin.axial_pos_num() <= efficiencies.get_max_axial_pos_num();
+       ++bin.axial_pos_num())
+    for (bin.tangential_pos_num() = efficiencies.get_min_tangential_pos_num();
+         bin.tangential_pos_num() <= efficiencies.get_max_tangential_pos_num();
+         ++bin.tangential_pos_num())
+      efficiencies[bin.axial_pos_num()][bin.tangential_pos_num()] = this->get_uncalibrated_bin_efficiency(bin);
+}
+
+void
+BinNormalisationWithCalibration::get_efficiencies_for_viewgram(Viewgram<float>& efficiencies) const
+{
+  this->get_uncalibrated_efficiencies_for_viewgram(efficiencies);
+  efficiencies /= this->_calib_decay_branching_ratio;
+}
+
 float
 BinNormalisationWithCalibration::get_calibration_factor() const
 {
@@ -82,6 +102,7 @@ void
 BinNormalisationWithCalibration::set_calibration_factor(const float calib)
 {
   this->_already_set_up = false;
+  this->clear_efficiencies_key_info();
   this->calibration_factor = calib;
 }
 
@@ -101,6 +122,7 @@ void
 BinNormalisationWithCalibration::set_radionuclide(const Radionuclide& rnuclide)
 {
   this->radionuclide = rnuclide;
+  this->clear_efficiencies_key_info();
 }
 
 END_NAMESPACE_STIR
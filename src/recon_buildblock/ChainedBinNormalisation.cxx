@@ -189,6 +189,13 @@ ChainedBinNormalisation::get_bin_efficiency(const Bin& bin) const
          * (!is_null_ptr(apply_second) ? apply_second->get_bin_efficiency(bin) : 1);
 }
 
+std::string
+ChainedBinNormalisation::get_efficiencies_key_info() const
+{
+  return std::string(registered_name) + ":\n" + (!is_null_ptr(apply_first) ? apply_first->get_efficiencies_key_info() : "none")
+         + '\n' + (!is_null_ptr(apply_second) ? apply_second->get_efficiencies_key_info() : "none");
+}
+
 bool
 ChainedBinNormalisation::is_first_trivial() const
 {
@@ -38,6 +38,8 @@
 #include "stir/format.h"
 #include "stir/DataProcessor.h"
 #include "stir/is_null_ptr.h"
+#include "stir/ProfilingRegistry.h"
+#include "stir/TimedBlock.h"
 #include <iostream>
 
 START_NAMESPACE_STIR
@@ -263,6 +265,9 @@ ForwardProjectorByBin::forward_project(RelatedViewgrams<float>& viewgrams,
   if (!_density_sptr)
     error("You need to call set_input() forward_project()");
 
+  static ProfilingScope forward_projection_scope("forward projection");
+  TimedBlock<ProfilingScope> timed_block(forward_projection_scope);
+
   check(*viewgrams.get_proj_data_info_sptr());
 
   // first check symmetries
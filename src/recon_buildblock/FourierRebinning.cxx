@@ -26,6 +26,8 @@
 #include "stir/Scanner.h"
 #include "stir/ProjDataInfoCylindrical.h"
 #include "stir/ProjDataInterfile.h"
+#include "stir/ProjDataInMemory.h"
+#include "stir/DynamicProjData.h"
 #include "stir/SegmentBySinogram.h"
 #include "stir/Bin.h"
 #include "stir/IndexRange3D.h"
@@ -97,6 +99,44 @@ FourierRebinning::FourierRebinning()
   set_defaults();
 }
 
+//! find the smallest powers of 2 that are large enough for the (360 degree extended) sinograms
+static void
+get_pow2_sizes(int& num_views_pow2, int& num_tang_poss_pow2, const ProjDataInfo& proj_data_info)
+{
+  for (num_views_pow2 = 1; num_views_pow2 < 2 * proj_data_info.get_num_views() && num_views_pow2 < (1 << 15);
+       num_views_pow2 *= 2)
+    ;
+  for (num_tang_poss_pow2 = 1; num_tang_poss_pow2 < proj_data_info.get_num_tangential_poss() && num_tang_poss_pow2 < (1 << 15);
+       num_tang_poss_pow2 *= 2)
+    ;
+}
+
+shared_ptr<ProjDataInfo>
+FourierRebinning::create_rebinned_proj_data_info(const ProjDataInfo& proj_data_info) const
+{
+  int num_views_pow2, num_tang_poss_pow2;
+  get_pow2_sizes(num_views_pow2, num_tang_poss_pow2, proj_data_info);
+  const int num_planes = proj_data_info.get_scanner_ptr()->get_num_rings() * 2 - 1;
+
+  // CON initialise the new projection data properties by copying the properties from the input projection data.
+  shared_ptr<ProjDataInfo> rebinned_proj_data_info_sptr(proj_data_info.clone());
+  // CON Adapt the properties that will be modified by the rebinning.
+  rebinned_proj_data_info_sptr->set_num_views(num_views_pow2 / 2);
+  // CON After rebinning we have of course only "direct" sinograms left e.q only segment 0 exists
+  rebinned_proj_data_info_sptr->reduce_segment_range(0, 0);
+  // CON maximal ring difference a LOR in the largest segment that is going to be rebinned
+  const int max_delta
+      = dynamic_cast<ProjDataInfoCylindrical const&>(proj_data_info).get_max_ring_difference(max_segment_num_to_process);
+  // CON The maximum/minimum ring difference covered by LORs written to the rebinned sinogram changed to the maximum ring
+  // CON difference covered by the largest segment that has been rebinned.
+  dynamic_cast<ProjDataInfoCylindrical&>(*rebinned_proj_data_info_sptr).set_min_ring_difference(-max_delta, 0);
+  dynamic_cast<ProjDataInfoCylindrical&>(*rebinned_proj_data_info_sptr).set_max_ring_difference(max_delta, 0);
+  // CON minimal and maximal axial position number. As usual we start with axial position 0 in segment 0
+  rebinned_proj_data_info_sptr->set_min_axial_pos_num(0, 0);
+  rebinned_proj_data_info_sptr->set_max_axial_pos_num(num_planes - 1, 0);
+  return rebinned_proj_data_info_sptr;
+}
+
 Succeeded
 FourierRebinning::rebin()
 {
@@ -108,6 +148,80 @@ FourierRebinning::rebin()
     }
 
   start_timers();
+
+  // CON create the output (interfile) file to where the rebinned data will be written.
+  ProjDataInterfile rebinned_proj_data(proj_data_sptr->get_exam_info_sptr(),
+                                       create_rebinned_proj_data_info(*proj_data_sptr->get_proj_data_info_sptr()),
+                                       output_filename_prefix);
+  const Succeeded success = rebin_proj_data(rebinned_proj_data, *proj_data_sptr);
+
+  stop_timers();
+  // CON presently not very useful. Maybe one could define a vriable fore_debug_level and
+  // CON only write in case of debugging
+  if (fore_debug_level > 0)
+    do_log_file();
+
+  return success;
+}
+
+Succeeded
+FourierRebinning::rebin(DynamicProjData& rebinned_dyn_proj_data, const DynamicProjData& dyn_proj_data)
+{
+  const unsigned int num_frames = dyn_proj_data.get_num_frames();
+  if (num_frames == 0)
+    {
+      warning("FORE Rebinning :: no frames in the dynamic projection data");
+      return Succeeded::no;
+    }
+  if (dyn_proj_data.get_proj_data_sptr(1)->get_proj_data_info_sptr()->is_tof_data())
+    {
+      error("FORE Rebinning :: Not supported for TOF data. Aborted");
+      return Succeeded::no;
+    }
+  // CON set_up() is not called for dynamic data, so handle the default of max_segment_num_to_process
+  // CON as in ProjDataRebinning::set_up(), using the first frame
+  {
+    const int max_segment_num_in_data = dyn_proj_data.get_proj_data_sptr(1)->get_max_segment_num();
+    if (max_segment_num_to_process == -1)
+      max_segment_num_to_process = max_segment_num_in_data;
+    else if (max_segment_num_to_process > max_segment_num_in_data)
+      {
+        warning(format("FORE Rebinning :: Range error in number of segments to process.\n"
+                       "Max segment number in data is {} while you asked for {}",
+                       max_segment_num_in_data,
+                       max_segment_num_to_process));
+        return Succeeded::no;
+      }
+  }
+
+  start_timers();
+
+  // CON all frames have the same geometry, so the rebinned projection data info is only constructed once
+  shared_ptr<const ProjDataInfo> rebinned_proj_data_info_sptr(
+      create_rebinned_proj_data_info(*dyn_proj_data.get_proj_data_sptr(1)->get_proj_data_info_sptr()));
+  rebinned_dyn_proj_data.set_exam_info(dyn_proj_data.get_exam_info());
+  rebinned_dyn_proj_data.resize(num_frames);
+
+  Succeeded success = Succeeded::yes;
+  for (unsigned int frame_num = 1; frame_num <= num_frames && success == Succeeded::yes; ++frame_num)
+    {
+      info(format("FORE Rebinning :: Processing frame {} of {}", frame_num, num_frames));
+      const ProjData& proj_data = dyn_proj_data.get_proj_data(frame_num);
+      if (*proj_data.get_proj_data_info_sptr() != *dyn_proj_data.get_proj_data_sptr(1)->get_proj_data_info_sptr())
+        error(format("FORE Rebinning :: frame {} has a different geometry than the first frame", frame_num));
+      auto rebinned_proj_data_sptr
+          = std::make_shared<ProjDataInMemory>(proj_data.get_exam_info_sptr(), rebinned_proj_data_info_sptr);
+      success = rebin_proj_data(*rebinned_proj_data_sptr, proj_data);
+      rebinned_dyn_proj_data.set_proj_data_sptr(rebinned_proj_data_sptr, frame_num);
+    }
+
+  stop_timers();
+  return success;
+}
+
+Succeeded
+FourierRebinning::rebin_proj_data(ProjData& rebinned_proj_data, const ProjData& proj_data)
+{
   CPUTimer timer;
   timer.start();
 
@@ -115,17 +229,11 @@ FourierRebinning::rebin()
   Succeeded success = Succeeded::yes;
 
   // CL Find the number of views and tangential positions power of two
-  int num_views_pow2;
-  for (num_views_pow2 = 1; num_views_pow2 < 2 * proj_data_sptr->get_num_views() && num_views_pow2 < (1 << 15);
-       num_views_pow2 *= 2)
-    ;
-  int num_tang_poss_pow2;
-  for (num_tang_poss_pow2 = 1; num_tang_poss_pow2 < proj_data_sptr->get_num_tangential_poss() && num_tang_poss_pow2 < (1 << 15);
-       num_tang_poss_pow2 *= 2)
-    ;
+  int num_views_pow2, num_tang_poss_pow2;
+  get_pow2_sizes(num_views_pow2, num_tang_poss_pow2, *proj_data.get_proj_data_info_sptr());
 
   // CL Initialise the 2D Fourier transform of all rebinned sinograms P(w,k)=0
-  const int num_planes = proj_data_sptr->get_proj_data_info_sptr()->get_scanner_ptr()->get_num_rings() * 2 - 1;
+  const int num_planes = rebinned_proj_data.get_num_axial_poss(0);
 
   Array<3, std::complex<float>> FT_rebinned_data(
       IndexRange3D(0, num_planes - 1, 0, num_views_pow2 - 1, 0, num_tang_poss_pow2 - 1));
@@ -133,42 +241,21 @@ FourierRebinning::rebin()
   // CON some statistics
   PETCount_rebinned num_rebinned(0, 0, 0);
 
-  // CON Create the output (rebinned projection data) data structure and set the properties of the rebinned sinograms
-  shared_ptr<ProjData> rebinned_proj_data_sptr;
-  // CON initialise the new projection data properties by copying the properties from the input projection data.
-  shared_ptr<ProjDataInfo> rebinned_proj_data_info_sptr(proj_data_sptr->get_proj_data_info_sptr()->clone());
-  // CON Adapt the properties that will be modified by the rebinning.
-  rebinned_proj_data_info_sptr->set_num_views(num_views_pow2 / 2);
-  // CON After rebinning we have of course only "direct" sinograms left e.q only segment 0 exists
-  rebinned_proj_data_info_sptr->reduce_segment_range(0, 0);
-  // CON maximal ring difference a LOR in the largest segment that is going to be rebinned
-  const int max_delta = dynamic_cast<ProjDataInfoCylindrical const&>(*proj_data_sptr->get_proj_data_info_sptr())
-                            .get_max_ring_difference(max_segment_num_to_process);
-  // CON The maximum/minimum ring difference covered by LORs written to the rebinned sinogram changed to the maximum ring
-  // CON difference covered by the largest segment that has been rebinned.
-  dynamic_cast<ProjDataInfoCylindrical&>(*rebinned_proj_data_info_sptr).set_min_ring_difference(-max_delta, 0);
-  dynamic_cast<ProjDataInfoCylindrical&>(*rebinned_proj_data_info_sptr).set_max_ring_difference(max_delta, 0);
-  // CON minimal and maximal axial position number. As usual we start with axial position 0 in segment 0
-  rebinned_proj_data_info_sptr->set_min_axial_pos_num(0, 0);
-  rebinned_proj_data_info_sptr->set_max_axial_pos_num(num_planes - 1, 0);
-  // CON create the output (interfile) file to where the rebinned data will be written.
-  rebinned_proj_data_sptr.reset(
-      new ProjDataInterfile(proj_data_sptr->get_exam_info_sptr(), rebinned_proj_data_info_sptr, output_filename_prefix));
   // CON get scanner related parameters needed for the rebinning kernel.
   // CON create a scanner object. The scanner type is identified from the projection data info.
-  const Scanner* scanner = rebinned_proj_data_sptr->get_proj_data_info_sptr()->get_scanner_ptr();
+  const ProjDataInfo& rebinned_proj_data_info = *rebinned_proj_data.get_proj_data_info_sptr();
+  const Scanner* scanner = rebinned_proj_data_info.get_scanner_ptr();
   const float half_distance_between_rings = scanner->get_ring_spacing() / 2.F;
-  const float sampling_distance_in_s = rebinned_proj_data_info_sptr->get_sampling_in_s(Bin(0, 0, 0, 0));
+  const float sampling_distance_in_s = rebinned_proj_data_info.get_sampling_in_s(Bin(0, 0, 0, 0));
   const float radial_sampling_freq_w = float(2. * _PI) / sampling_distance_in_s / num_tang_poss_pow2;
   // CON D = #bins * binsize, R = D / 2
-  const float R_field_of_view_mm
-      = ((int)(rebinned_proj_data_info_sptr->get_num_tangential_poss() / 2) - 1) * sampling_distance_in_s;
+  const float R_field_of_view_mm = ((int)(rebinned_proj_data_info.get_num_tangential_poss() / 2) - 1) * sampling_distance_in_s;
   const float scanner_space_between_rings = scanner->get_ring_spacing();
   const float scanner_ring_radius = scanner->get_effective_ring_radius();
   const float ratio_ring_spacing_to_ring_radius = scanner_space_between_rings / scanner_ring_radius;
 
   // CON Check that the user defineable FORE parameters are inside a possible range of values
-  if (fore_check_parameters(num_tang_poss_pow2, num_views_pow2, max_segment_num_to_process) != Succeeded::yes)
+  if (fore_check_parameters(num_tang_poss_pow2, num_views_pow2, max_segment_num_to_process, proj_data) != Succeeded::yes)
     {
       error("FORE Rebinning :: Setup failed ");
     };
@@ -183,11 +270,11 @@ FourierRebinning::rebin()
       // TODO at present, the processing is done by segment. However, it's fairly easy to
       // change this to by sinogram (the rebinning call below will do everything
       // as a loop over axial_pos anyway).
-      // This would save some memory overhead, and increase potential for parallelisation later.
-      // (The parallelised version of FORE in PARAPET was organised this way).
+      // This would save some memory overhead.
+      // (The parallelisation is currently done inside do_rebinning()).
 
       // CON get one (positive) segment
-      SegmentBySinogram<float> segment = proj_data_sptr->get_segment_by_sinogram(seg_num);
+      SegmentBySinogram<float> segment = proj_data.get_segment_by_sinogram(seg_num);
 
       // CON Retrieve some segment dependent properties needed for the rebinning kernel
       const ProjDataInfoCylindrical& proj_data_info_cylindrical
@@ -201,7 +288,7 @@ FourierRebinning::rebin()
       // KT TODO this is currently not a good idea, as all ProjDataInfo classes assume that
       // KT views go from 0 to Pi.
       // CON Get the corresponding (negative) segment with the same absolute but opposite obliqueness
-      const SegmentBySinogram<float> segment_neg = proj_data_sptr->get_segment_by_sinogram(-seg_num);
+      const SegmentBySinogram<float> segment_neg = proj_data.get_segment_by_sinogram(-seg_num);
       // CON Expand the (positive) segment such that the two segments can be merged
       segment.grow(IndexRange3D(segment.get_min_axial_pos_num(),
                                 segment.get_max_axial_pos_num(),
@@ -265,8 +352,12 @@ FourierRebinning::rebin()
 
   info("FORE Rebinning :: Inverse FFT the rebinned sinograms ");
   // CL now finally fill in the new sinogram s
-  SegmentBySinogram<float> sino2D_rebinned = rebinned_proj_data_sptr->get_empty_segment_by_sinogram(0);
+  SegmentBySinogram<float> sino2D_rebinned = rebinned_proj_data.get_empty_segment_by_sinogram(0);
 
+  // CON planes are independent, so can be done in parallel (unless we want to display the data)
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic) if (fore_debug_level < 3)
+#endif
   for (int plane = FT_rebinned_data.get_min_index(); plane <= FT_rebinned_data.get_max_index(); plane++)
     {
 
@@ -329,15 +420,10 @@ FourierRebinning::rebin()
               sino2D_rebinned.sum()));
 
   // CON finally write the rebinned sinograms to file
-  const Succeeded success_this_sino = rebinned_proj_data_sptr->set_segment(sino2D_rebinned);
+  const Succeeded success_this_sino = rebinned_proj_data.set_segment(sino2D_rebinned);
 
   if (success == Succeeded::yes && success_this_sino == Succeeded::no)
     success = Succeeded::no;
-  stop_timers();
-  // CON presently not very useful. Maybe one could define a vriable fore_debug_level and
-  // CON only write in case of debugging
-  if (fore_debug_level > 0)
-    do_log_file();
 
   return success;
 }
@@ -362,46 +448,81 @@ FourierRebinning::do_rebinning(Array<3, std::complex<float>>& FT_rebinned_data,
   const int local_miss = count_rebinned.miss;
   const int local_ssrb = count_rebinned.ssrb;
 
-  // CON Loop over all slices, FFT the sinograms and call the actual rebinning kernel.
-  for (int axial_pos_num = segment.get_min_axial_pos_num(); axial_pos_num <= segment.get_max_axial_pos_num(); axial_pos_num++)
-    {
-
-      if (axial_pos_num % 10 == 0)
-        info(format("FORE Rebinning z (slice) = {}", axial_pos_num));
-      Array<2, float> current_sinogram(IndexRange2D(0, num_tang_poss_pow2 - 1, 0, num_views_pow2 - 1));
-
-      // CL Calculate the 2D FFT of P(w,k) of the merged segment
-      // CON copy the sinogram data of slice axial_pos_num from the segment array to slicedata
-      // CON the sinogram is flipped. This will taken account for in the rebinning, where the assignment of the FFT
-      // CON coefficients are assigned opposite.
-      for (int j = 0; j < segment.get_num_tangential_poss(); j++)
-        for (int i = 0; i < num_views_pow2; i++)
-          current_sinogram[j][i] = segment[axial_pos_num][i][j + segment.get_min_tangential_pos_num()];
-
-      // CON FFT slicedata
-      const Array<2, std::complex<float>> FT_current_sinogram = fourier_for_real_data(current_sinogram);
-
-      // CON determine the axial position of the middle of the LOR in mm relative to Bin(segment=0,view=0,axial_pos=0,tang_pos=0)
-      const ProjDataInfo& proj_data_info = *segment.get_proj_data_info_sptr();
-      const float z_in_mm
-          = proj_data_info.get_m(Bin(segment.get_segment_num(), 0, axial_pos_num, 0)) - proj_data_info.get_m(Bin(0, 0, 0, 0));
-
-      // CON Call the rebinning kernel.
-      rebinning(FT_rebinned_data,
-                Weights_for_FT_rebinned_data,
-                count_rebinned,
-                FT_current_sinogram,
-                z_in_mm,
-                average_ring_difference_in_segment,
-                num_views_pow2,
-                num_tang_poss_pow2,
-                half_distance_between_rings,
-                sampling_distance_in_s,
-                radial_sampling_freq_w,
-                R_field_of_view_mm,
-                ratio_ring_spacing_to_ring_radius);
-
-    } // CL End of loop of axial_pos_num
+  const int min_axial_pos_num = segment.get_min_axial_pos_num();
+  const int max_axial_pos_num = segment.get_max_axial_pos_num();
+  // CON FFTs and z-positions of all sinograms in the segment
+  VectorWithOffset<Array<2, std::complex<float>>> FT_sinograms(min_axial_pos_num, max_axial_pos_num);
+  VectorWithOffset<float> z_in_mm(min_axial_pos_num, max_axial_pos_num);
+
+  // CON Loop over all slices and FFT the sinograms.
+  // CON This is done in parallel, where every thread uses its own buffer for the (flipped) sinogram.
+#ifdef STIR_OPENMP
+#  pragma omp parallel
+#endif
+  {
+    Array<2, float> current_sinogram(IndexRange2D(0, num_tang_poss_pow2 - 1, 0, num_views_pow2 - 1));
+#ifdef STIR_OPENMP
+#  pragma omp for schedule(dynamic)
+#endif
+    for (int axial_pos_num = min_axial_pos_num; axial_pos_num <= max_axial_pos_num; axial_pos_num++)
+      {
+
+        if (axial_pos_num % 10 == 0)
+          info(format("FORE Rebinning z (slice) = {}", axial_pos_num));
+
+        // CL Calculate the 2D FFT of P(w,k) of the merged segment
+        // CON copy the sinogram data of slice axial_pos_num from the segment array to slicedata
+        // CON the sinogram is flipped. This will taken account for in the rebinning, where the assignment of the FFT
+        // CON coefficients are assigned opposite.
+        for (int j = 0; j < segment.get_num_tangential_poss(); j++)
+          for (int i = 0; i < num_views_pow2; i++)
+            current_sinogram[j][i] = segment[axial_pos_num][i][j + segment.get_min_tangential_pos_num()];
+
+        // CON FFT slicedata
+        FT_sinograms[axial_pos_num] = fourier_for_real_data(current_sinogram);
+
+        // CON determine the axial position of the middle of the LOR in mm relative to
+        // CON Bin(segment=0,view=0,axial_pos=0,tang_pos=0)
+        const ProjDataInfo& proj_data_info = *segment.get_proj_data_info_sptr();
+        z_in_mm[axial_pos_num]
+            = proj_data_info.get_m(Bin(segment.get_segment_num(), 0, axial_pos_num, 0)) - proj_data_info.get_m(Bin(0, 0, 0, 0));
+      } // CL End of loop of axial_pos_num
+  }
+
+  // CON Call the rebinning kernel for all slices.
+  // CON Contributions of different slices can go to the same element of FT_rebinned_data. Therefore, the parallelisation
+  // CON is over the angular frequency index (i), such that every thread writes to different elements. The order of
+  // CON summation is then the same as in the sequential case.
+#ifdef STIR_OPENMP
+#  pragma omp parallel
+#endif
+  {
+    PETCount_rebinned thread_count_rebinned(0, 0, 0);
+#ifdef STIR_OPENMP
+#  pragma omp for schedule(dynamic)
+#endif
+    for (int i = 0; i <= num_views_pow2 / 2; i++)
+      for (int axial_pos_num = min_axial_pos_num; axial_pos_num <= max_axial_pos_num; axial_pos_num++)
+        rebinning(FT_rebinned_data,
+                  Weights_for_FT_rebinned_data,
+                  thread_count_rebinned,
+                  FT_sinograms[axial_pos_num],
+                  z_in_mm[axial_pos_num],
+                  average_ring_difference_in_segment,
+                  num_views_pow2,
+                  num_tang_poss_pow2,
+                  half_distance_between_rings,
+                  sampling_distance_in_s,
+                  radial_sampling_freq_w,
+                  R_field_of_view_mm,
+                  ratio_ring_spacing_to_ring_radius,
+                  i,
+                  i);
+#ifdef STIR_OPENMP
+#  pragma omp critical(FORE_COUNT_REBINNED)
+#endif
+    count_rebinned += thread_count_rebinned;
+  }
 
   if (fore_debug_level > 0)
     {
@@ -427,7 +548,9 @@ FourierRebinning::rebinning(Array<3, std::complex<float>>& FT_rebinned_data,
                             const float sampling_distance_in_s,
                             const float radial_sampling_freq_w,
                             const float R_field_of_view_mm,
-                            const float ratio_ring_spacing_to_ring_radius)
+                            const float ratio_ring_spacing_to_ring_radius,
+                            const int min_i,
+                            const int max_i)
 {
 
   // CON prevent rebinning to non existing z-positions (sinograms)
@@ -448,7 +571,7 @@ FourierRebinning::rebinning(Array<3, std::complex<float>>& FT_rebinned_data,
 
   for (int j = wmin; j <= num_tang_poss_pow2 / 2; j++)
     {
-      for (int i = kmin; i <= num_views_pow2 / 2; i++)
+      for (int i = std::max(kmin, min_i); i <= std::min(num_views_pow2 / 2, max_i); i++)
         {
 
           float w = static_cast<float>(j) * radial_sampling_freq_w;
@@ -537,7 +660,7 @@ FourierRebinning::rebinning(Array<3, std::complex<float>>& FT_rebinned_data,
 
       for (int j = 0; j < wmin; j++)
         {
-          for (int i = 0; i <= num_views_pow2 / 2; i++)
+          for (int i = std::max(0, min_i); i <= std::min(num_views_pow2 / 2, max_i); i++)
             {
 
               for (int shift_direction = POSITIVE_Z_SHIFT; shift_direction <= NEGATIVE_Z_SHIFT; shift_direction += CHANGE_Z_SHIFT)
@@ -566,7 +689,7 @@ FourierRebinning::rebinning(Array<3, std::complex<float>>& FT_rebinned_data,
       // CL Next treat small k's and w=wNyq=(num_tang_poss_pow2 / 2)+1, k=1..klim :
       for (int j = wmin; j <= num_tang_poss_pow2 / 2; j++)
         {
-          for (int i = 0; i <= kmin; i++)
+          for (int i = std::max(0, min_i); i <= std::min(kmin, max_i); i++)
             {
 
               for (int shift_direction = POSITIVE_Z_SHIFT; shift_direction <= NEGATIVE_Z_SHIFT; shift_direction += CHANGE_Z_SHIFT)
@@ -653,7 +776,10 @@ FourierRebinning::do_adjust_nb_views_to_pow2(SegmentBySinogram<float>& segment)
 }
 
 Succeeded
-FourierRebinning::fore_check_parameters(int num_tang_poss_pow2, int num_views_pow2, int max_segment_num_to_process)
+FourierRebinning::fore_check_parameters(int num_tang_poss_pow2,
+                                        int num_views_pow2,
+                                        int max_segment_num_to_process,
+                                        const ProjData& proj_data)
 {
 
   // CON Check if the parameters given make sense.
@@ -693,11 +819,11 @@ FourierRebinning::fore_check_parameters(int num_tang_poss_pow2, int num_views_po
       return Succeeded::no;
     }
 
-  if (max_segment_num_to_process > proj_data_sptr->get_num_segments())
+  if (max_segment_num_to_process > proj_data.get_num_segments())
     {
       warning(format("FORE initialisation :: Your data set stores {} segments\n"
                      "                       The maximum number of segments to process variable is larger than that.",
-                     (proj_data_sptr->get_num_segments() / 2 + 1)));
+                     (proj_data.get_num_segments() / 2 + 1)));
       return Succeeded::no;
     }
 
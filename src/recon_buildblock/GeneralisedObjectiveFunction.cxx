@@ -31,6 +31,8 @@
 #include "stir/info.h"
 #include "stir/warning.h"
 #include "stir/error.h"
+#include "stir/ProfilingRegistry.h"
+#include "stir/TimedBlock.h"
 using std::string;
 
 START_NAMESPACE_STIR
@@ -140,7 +142,11 @@ GeneralisedObjectiveFunction<TargetT>::compute_sub_gradient(TargetT& gradient,
   if (!this->prior_is_zero())
     {
       shared_ptr<TargetT> prior_gradient_sptr(gradient.get_empty_copy());
-      this->prior_sptr->compute_gradient(*prior_gradient_sptr, current_estimate);
+      {
+        static ProfilingScope prior_scope("prior");
+        TimedBlock<ProfilingScope> timed_block(prior_scope);
+        this->prior_sptr->compute_gradient(*prior_gradient_sptr, current_estimate);
+      }
 
       // (*prior_gradient_sptr)/= num_subsets;
       // gradient -= *prior_gradient_sptr;
@@ -190,7 +196,11 @@ GeneralisedObjectiveFunction<TargetT>::compute_gradient(TargetT& gradient, const
   if (!this->prior_is_zero())
     {
       shared_ptr<TargetT> prior_gradient_sptr(gradient.get_empty_copy());
-      this->prior_sptr->compute_gradient(*prior_gradient_sptr, current_estimate);
+      {
+        static ProfilingScope prior_scope("prior");
+        TimedBlock<ProfilingScope> timed_block(prior_scope);
+        this->prior_sptr->compute_gradient(*prior_gradient_sptr, current_estimate);
+      }
 
       // gradient -= *prior_gradient_sptr;
       auto prior_gradient_iter = prior_gradient_sptr->begin_all_const();
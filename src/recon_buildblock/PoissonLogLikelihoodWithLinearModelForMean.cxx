@@ -17,18 +17,30 @@
 */
 #include "stir/recon_buildblock/PoissonLogLikelihoodWithLinearModelForMean.h"
 #include "stir/DiscretisedDensity.h"
+#include "stir/VoxelsOnCartesianGrid.h"
+#include "stir/FilePath.h"
+#include "stir/stream.h"
 #include "stir/is_null_ptr.h"
 #include "stir/IO/write_to_file.h"
 #include "stir/IO/read_from_file.h"
 #include "stir/Succeeded.h"
 #include "stir/CPUTimer.h"
 #include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <exception>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <typeinfo>
 #include "stir/modelling/ParametricDiscretisedDensity.h"
 #include "stir/modelling/KineticParameters.h"
 #include "stir/info.h"
 #include "stir/error.h"
 #include "stir/format.h"
+#include "stir/hash.h"
 #include "boost/lexical_cast.hpp"
 #include "boost/format.hpp"
 
@@ -36,6 +48,59 @@ using std::string;
 
 START_NAMESPACE_STIR
 
+namespace detail
+{
+//! rename a file, replacing \a new_filename if it exists
+static void
+rename_file(const std::string& old_filename, const std::string& new_filename)
+{
+  if (std::rename(old_filename.c_str(), new_filename.c_str()) != 0)
+    {
+      // rename does not replace existing files on all systems
+      std::remove(new_filename.c_str());
+      if (std::rename(old_filename.c_str(), new_filename.c_str()) != 0)
+        error(format("Error renaming '{}' to '{}'", old_filename, new_filename));
+    }
+}
+
+//! write an image to a temporary file, and rename its header to \a filename
+/*! The data file keeps its (unique) temporary name, such that the renamed header stays valid. */
+template <typename TargetT>
+static void
+write_sensitivity_to_cache_file(const std::string& filename, const std::string& tmp_filename, const TargetT& image)
+{
+  const std::string filename_used = write_to_file(tmp_filename, image);
+  rename_file(filename_used, filename);
+}
+
+static std::string
+get_geometry_info(const DiscretisedDensity<3, float>& density)
+{
+  std::ostringstream s;
+  s << "target type: " << typeid(density).name() << '\n'
+    << "origin: " << density.get_origin() << '\n';
+  BasicCoordinate<3, int> min_indices, max_indices;
+  if (density.get_regular_range(min_indices, max_indices))
+    s << "index range: " << min_indices << ' ' << max_indices << '\n';
+  else
+    {
+      for (int z = density.get_min_index(); z <= density.get_max_index(); ++z)
+        for (int y = density[z].get_min_index(); y <= density[z].get_max_index(); ++y)
+          s << z << ' ' << y << ' ' << density[z][y].get_min_index() << ' ' << density[z][y].get_max_index() << '\n';
+    }
+  if (auto voxels_ptr = dynamic_cast<const VoxelsOnCartesianGrid<float>*>(&density))
+    s << "voxel size: " << voxels_ptr->get_voxel_size() << '\n';
+  return s.str();
+}
+
+static std::string
+get_geometry_info(const ParametricVoxelsOnCartesianGrid& density)
+{
+  return "parametric image with " + std::to_string(density.get_num_params()) + " parameters\n"
+         + get_geometry_info(density.construct_single_density(1));
+}
+} // namespace detail
+
 template <typename TargetT>
 void
 PoissonLogLikelihoodWithLinearModelForMean<TargetT>::set_defaults()
@@ -44,7 +109,12 @@ PoissonLogLikelihoodWithLinearModelForMean<TargetT>::set_defaults()
 
   this->sensitivity_filename = "";
   this->subsensitivity_filenames = "";
+  {
+    const char* const cache_directory = std::getenv("STIR_SENSITIVITY_CACHE_DIRECTORY");
+    this->sensitivity_cache_directory = cache_directory ? cache_directory : "";
+  }
   this->recompute_sensitivity = false;
+  this->recompute_sensitivity_is_implicit = false;
   this->use_subset_sensitivities = true;
   this->subsensitivity_sptrs.resize(0);
 }
@@ -59,6 +129,7 @@ PoissonLogLikelihoodWithLinearModelForMean<TargetT>::initialise_keymap()
   this->parser.add_key("subset sensitivity filenames", &this->subsensitivity_filenames);
   this->parser.add_key("recompute sensitivity", &this->recompute_sensitivity);
   this->parser.add_key("use_subset_sensitivities", &this->use_subset_sensitivities);
+  this->parser.add_key("sensitivity cache directory", &this->sensitivity_cache_directory);
 }
 
 template <typename TargetT>
@@ -85,6 +156,21 @@ PoissonLogLikelihoodWithLinearModelForMean<TargetT>::get_subsensitivity_filename
   return this->subsensitivity_filenames;
 }
 
+template <typename TargetT>
+std::string
+PoissonLogLikelihoodWithLinearModelForMean<TargetT>::get_sensitivity_cache_directory() const
+{
+  return this->sensitivity_cache_directory;
+}
+
+template <typename TargetT>
+void
+PoissonLogLikelihoodWithLinearModelForMean<TargetT>::set_sensitivity_cache_directory(const std::string& directory)
+{
+  this->already_set_up = false;
+  this->sensitivity_cache_directory = directory;
+}
+
 template <typename TargetT>
 void
 PoissonLogLikelihoodWithLinearModelForMean<TargetT>::set_sensitivity_filename(const std::string& filename)
@@ -101,7 +187,7 @@ PoissonLogLikelihoodWithLinearModelForMean<TargetT>::set_subsensitivity_filename
   this->subsensitivity_filenames = filenames;
   try
     {
-      if (this->subsensitivity_filenames.find("%"))
+      if (this->subsensitivity_filenames.find("%") != std::string::npos)
         {
           warning("The subsensitivity_filenames pattern is using the boost::format convention ('\%d')."
                   "It is recommended to use fmt::format/std::format style formatting ('{}').");
@@ -153,6 +239,7 @@ void
 PoissonLogLikelihoodWithLinearModelForMean<TargetT>::set_recompute_sensitivity(const bool arg)
 {
   this->recompute_sensitivity = arg;
+  this->recompute_sensitivity_is_implicit = false;
 }
 
 template <typename TargetT>
@@ -176,6 +263,8 @@ PoissonLogLikelihoodWithLinearModelForMean<TargetT>::set_subset_sensitivity_sptr
                                                                                  const int subset_num)
 {
   this->already_set_up = false;
+  if (subset_num >= static_cast<int>(this->subsensitivity_sptrs.size()))
+    this->subsensitivity_sptrs.resize(subset_num + 1);
   this->subsensitivity_sptrs[subset_num] = arg;
 }
 
@@ -196,8 +285,41 @@ PoissonLogLikelihoodWithLinearModelForMean<TargetT>::set_up(shared_ptr<TargetT>
         {
           info("(subset)sensitivity filename(s) not set so I will compute the (subset)sensitivities", 2);
           this->recompute_sensitivity = true;
+          this->recompute_sensitivity_is_implicit = true;
           // initialisation of pointers will be done below
         }
+      else if (!is_null_ptr(this->subsensitivity_sptrs[0])
+               && ((this->get_use_subset_sensitivities() && this->subsensitivity_filenames == "")
+                   || (!this->get_use_subset_sensitivities() && this->sensitivity_filename == "")))
+        {
+          // use the (subset) sensitivities in memory
+          const int num_subsets_to_check = this->get_use_subset_sensitivities() ? this->num_subsets : 1;
+          for (int subset = 0; subset < num_subsets_to_check; ++subset)
+            {
+              string explanation;
+              if (is_null_ptr(this->subsensitivity_sptrs[subset]))
+                {
+                  error(format("subset sensitivity {} is not set. You need to set it or recompute the sensitivity.", subset));
+                  return Succeeded::no;
+                }
+              if (!target_sptr->has_same_characteristics(*this->subsensitivity_sptrs[subset], explanation))
+                {
+                  error("sensitivity and target should have the same characteristics.\n%s", explanation.c_str());
+                  return Succeeded::no;
+                }
+            }
+          if (!this->get_use_subset_sensitivities())
+            {
+              // the total sensitivity is num_subsets times the one for subset 0
+              this->sensitivity_sptr.reset(this->subsensitivity_sptrs[0]->clone());
+              for (typename TargetT::full_iterator sens_iter = this->sensitivity_sptr->begin_all();
+                   sens_iter != this->sensitivity_sptr->end_all();
+                   ++sens_iter)
+                *sens_iter *= this->num_subsets;
+            }
+          // compute total from subsensitivity or vice versa
+          this->set_total_or_subset_sensitivities();
+        }
       else if (this->sensitivity_filename == "1")
         {
           if (this->get_use_subset_sensitivities())
@@ -227,7 +349,7 @@ PoissonLogLikelihoodWithLinearModelForMean<TargetT>::set_up(shared_ptr<TargetT>
                       std::string current_sensitivity_filename;
                       try
                         {
-                          if (this->subsensitivity_filenames.find("%"))
+                          if (this->subsensitivity_filenames.find("%") != std::string::npos)
                             {
                               warning("The subsensitivity_filenames pattern is using the boost::format convention ('\%d')."
                                       "It is recommended to use fmt::format/std::format style formatting ('{}').");
@@ -300,7 +422,13 @@ PoissonLogLikelihoodWithLinearModelForMean<TargetT>::set_up(shared_ptr<TargetT>
       return Succeeded::no;
     }
 
-  if (this->recompute_sensitivity)
+  // the cache is only used when the user did not ask to recompute explicitly
+  if (this->recompute_sensitivity && this->recompute_sensitivity_is_implicit
+      && this->read_sensitivities_from_cache(*target_sptr))
+    {
+      // nothing else to do
+    }
+  else if (this->recompute_sensitivity)
     {
       info("Computing sensitivity");
       CPUTimer sens_timer;
@@ -343,11 +471,142 @@ PoissonLogLikelihoodWithLinearModelForMean<TargetT>::set_up(shared_ptr<TargetT>
           error("Error writing sensitivity to file:\n%s", e.what());
           return Succeeded::no;
         }
+      this->write_sensitivities_to_cache(*target_sptr);
     }
   this->already_set_up = true;
   return Succeeded::yes;
 }
 
+template <typename TargetT>
+std::string
+PoissonLogLikelihoodWithLinearModelForMean<TargetT>::get_sensitivity_cache_key_info() const
+{
+  return "";
+}
+
+template <typename TargetT>
+std::string
+PoissonLogLikelihoodWithLinearModelForMean<TargetT>::get_sensitivity_cache_filename_prefix(const TargetT& target,
+                                                                                          std::string& key_info) const
+{
+  if (this->sensitivity_cache_directory.empty())
+    return "";
+  const std::string objective_function_info = this->get_sensitivity_cache_key_info();
+  if (objective_function_info.empty())
+    {
+      info("Sensitivity cache is not supported for this objective function", 2);
+      return "";
+    }
+  if (!FilePath::exists(this->sensitivity_cache_directory))
+    {
+      warning(format("Sensitivity cache directory '{}' does not exist. Cache will not be used.",
+                     this->sensitivity_cache_directory));
+      return "";
+    }
+  std::ostringstream s;
+  s << "STIR sensitivity cache, version 1\n"
+    << objective_function_info << '\n'
+    << "use subset sensitivities: " << this->get_use_subset_sensitivities() << '\n'
+    << "number of subsets: " << this->get_num_subsets() << '\n'
+    << detail::get_geometry_info(target);
+  key_info = s.str();
+
+  FilePath prefix(format("sensitivity_{:016x}", fnv1a_hash(key_info)), false);
+  prefix.prepend_directory_name(this->sensitivity_cache_directory);
+  return prefix.get_as_string();
+}
+
+template <typename TargetT>
+bool
+PoissonLogLikelihoodWithLinearModelForMean<TargetT>::read_sensitivities_from_cache(const TargetT& target)
+{
+  std::string key_info;
+  const std::string prefix = this->get_sensitivity_cache_filename_prefix(target, key_info);
+  if (prefix.empty())
+    return false;
+  {
+    // check if the stored settings are identical (to protect against hash collisions)
+    std::ifstream key_file(prefix + ".txt");
+    if (!key_file)
+      return false;
+    const std::string stored_key_info((std::istreambuf_iterator<char>(key_file)), std::istreambuf_iterator<char>());
+    if (stored_key_info != key_info)
+      {
+        warning(format("Sensitivity cache file '{}.txt' does not match current settings. Ignoring it.", prefix));
+        return false;
+      }
+  }
+  try
+    {
+      const int num_images = this->get_use_subset_sensitivities() ? this->get_num_subsets() : 1;
+      VectorWithOffset<shared_ptr<TargetT>> images(num_images);
+      for (int i = 0; i < num_images; ++i)
+        {
+          const std::string filename
+              = this->get_use_subset_sensitivities() ? format("{}_subset{}.hv", prefix, i) : prefix + ".hv";
+          images[i] = read_from_file<TargetT>(filename);
+          string explanation;
+          if (!target.has_same_characteristics(*images[i], explanation))
+            {
+              warning(format("Sensitivity in cache '{}' has different characteristics from target:\n{}", filename, explanation));
+              return false;
+            }
+        }
+      if (this->get_use_subset_sensitivities())
+        this->subsensitivity_sptrs = images;
+      else
+        this->sensitivity_sptr = images[0];
+    }
+  catch (std::exception& e)
+    {
+      warning(format("Error reading sensitivity from cache '{}'. It will be recomputed.\n{}", prefix, e.what()));
+      return false;
+    }
+  info(format("Sensitivity read from cache '{}'", prefix));
+  this->set_total_or_subset_sensitivities();
+  return true;
+}
+
+template <typename TargetT>
+void
+PoissonLogLikelihoodWithLinearModelForMean<TargetT>::write_sensitivities_to_cache(const TargetT& target) const
+{
+  std::string key_info;
+  const std::string prefix = this->get_sensitivity_cache_filename_prefix(target, key_info);
+  if (prefix.empty())
+    return;
+  // Write to temporary files first and rename them, such that a crash or a concurrent run
+  // never leaves an incomplete entry that looks valid. The temporary names are unique per run.
+  std::random_device random_device;
+  const std::string tmp_prefix = format("{}_tmp{:08x}{:08x}", prefix, random_device(), random_device());
+  try
+    {
+      if (this->get_use_subset_sensitivities())
+        {
+          for (int subset = 0; subset < this->get_num_subsets(); ++subset)
+            detail::write_sensitivity_to_cache_file(format("{}_subset{}.hv", prefix, subset),
+                                                    format("{}_subset{}.hv", tmp_prefix, subset),
+                                                    this->get_subset_sensitivity(subset));
+        }
+      else
+        detail::write_sensitivity_to_cache_file(prefix + ".hv", tmp_prefix + ".hv", this->get_sensitivity());
+      // write settings last, such that an incomplete cache entry is not used
+      {
+        std::ofstream key_file(tmp_prefix + ".txt");
+        key_file << key_info;
+        if (!key_file)
+          error("Error writing " + tmp_prefix + ".txt");
+      }
+      detail::rename_file(tmp_prefix + ".txt", prefix + ".txt");
+    }
+  catch (std::exception& e)
+    {
+      warning(format("Error writing sensitivity to cache '{}':\n{}", prefix, e.what()));
+      return;
+    }
+  info(format("Sensitivity written to cache '{}'", prefix), 2);
+}
+
 template <typename TargetT>
 void
 PoissonLogLikelihoodWithLinearModelForMean<TargetT>::compute_sub_gradient_without_penalty(TargetT& gradient,
@@ -37,6 +37,7 @@
 #include "stir/ViewSegmentNumbers.h"
 #include "stir/recon_array_functions.h"
 #include "stir/FilePath.h"
+#include "stir/is_null_ptr.h"
 #include <iostream>
 #include <algorithm>
 #include <functional>
@@ -657,6 +658,24 @@ PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin<Tar
   return Succeeded::yes;
 }
 
+template <typename TargetT>
+std::string
+PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin<TargetT>::get_sensitivity_cache_key_info() const
+{
+  std::ostringstream s;
+  s << this->get_registered_name() << '\n'
+    << this->proj_data_info_sptr->parameter_info() << '\n'
+    << this->list_mode_data_sptr->get_exam_info().parameter_info() << '\n'
+    << "use time-of-flight sensitivities: " << this->use_tofsens << '\n'
+    << this->PM_sptr->parameter_info() << '\n';
+  if (!is_null_ptr(this->normalisation_sptr))
+    {
+      // use the values of the factors, such that the key changes when the norm data change
+      s << "normalisation:\n" << this->normalisation_sptr->get_efficiencies_key_info() << '\n';
+    }
+  return s.str();
+}
+
 template <typename TargetT>
 void
 PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin<TargetT>::add_subset_sensitivity(
@@ -669,10 +688,8 @@ PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin<Tar
 
   info(format("Calculating sensitivity for subset {}", subset_num));
 
-  int min_timing_pos_num = use_tofsens ? this->proj_data_info_sptr->get_min_tof_pos_num() : 0;
-  int max_timing_pos_num = use_tofsens ? this->proj_data_info_sptr->get_max_tof_pos_num() : 0;
-  if (min_timing_pos_num < 0 || max_timing_pos_num > 0)
-    error("TOF code for sensitivity needs work");
+  const int min_timing_pos_num = use_tofsens ? this->sens_proj_data_info_sptr->get_min_tof_pos_num() : 0;
+  const int max_timing_pos_num = use_tofsens ? this->sens_proj_data_info_sptr->get_max_tof_pos_num() : 0;
 
   this->sens_backprojector_sptr->start_accumulating_in_new_target();
 
@@ -694,27 +711,27 @@ PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin<Tar
 
           if (!this->sens_backprojector_sptr->get_symmetries_used()->is_basic(view_segment_num))
             continue;
-          // for (int timing_pos_num = min_timing_pos_num; timing_pos_num <= max_timing_pos_num; ++timing_pos_num)
-          {
-            shared_ptr<DataSymmetriesForViewSegmentNumbers> symmetries_used(
-                this->sens_backprojector_sptr->get_symmetries_used()->clone());
+          for (int timing_pos_num = min_timing_pos_num; timing_pos_num <= max_timing_pos_num; ++timing_pos_num)
+            {
+              shared_ptr<DataSymmetriesForViewSegmentNumbers> symmetries_used(
+                  this->sens_backprojector_sptr->get_symmetries_used()->clone());
 
-            RelatedViewgrams<float> viewgrams = this->sens_proj_data_info_sptr->get_empty_related_viewgrams(
-                view_segment_num, symmetries_used, false); //, timing_pos_num);
+              RelatedViewgrams<float> viewgrams = this->sens_proj_data_info_sptr->get_empty_related_viewgrams(
+                  view_segment_num, symmetries_used, false, timing_pos_num);
 
-            viewgrams.fill(1.F);
-            // find efficiencies
-            {
-              this->normalisation_sptr->undo(viewgrams);
-            }
-            // backproject
-            {
-              const int min_ax_pos_num = viewgrams.get_min_axial_pos_num();
-              const int max_ax_pos_num = viewgrams.get_max_axial_pos_num();
+              viewgrams.fill(1.F);
+              // find efficiencies
+              {
+                this->normalisation_sptr->undo(viewgrams);
+              }
+              // backproject
+              {
+                const int min_ax_pos_num = viewgrams.get_min_axial_pos_num();
+                const int max_ax_pos_num = viewgrams.get_max_axial_pos_num();
 
-              this->sens_backprojector_sptr->back_project(viewgrams, min_ax_pos_num, max_ax_pos_num);
+                this->sens_backprojector_sptr->back_project(viewgrams, min_ax_pos_num, max_ax_pos_num);
+              }
             }
-          }
         }
     }
   this->sens_backprojector_sptr->get_output(sensitivity);
@@ -58,6 +58,7 @@
 
 #include "stir/Viewgram.h"
 #include "stir/recon_array_functions.h"
+#include "stir/apply_elementwise.h"
 #include "stir/is_null_ptr.h"
 #include <iostream>
 #include <algorithm>
@@ -97,6 +98,7 @@ PoissonLogLikelihoodWithLinearModelForMeanAndProjData<TargetT>::set_defaults()
   this->proj_data_sptr.reset(); // MJ added
   this->zero_seg0_end_planes = 0;
   this->use_tofsens = false;
+  this->skip_projector_set_up_if_unchanged = false;
 
   this->additive_projection_data_filename = "0";
   this->additive_proj_data_sptr.reset();
@@ -442,6 +444,13 @@ PoissonLogLikelihoodWithLinearModelForMeanAndProjData<TargetT>::set_projector_pa
   this->projector_pair_ptr = arg;
 }
 
+template <typename TargetT>
+void
+PoissonLogLikelihoodWithLinearModelForMeanAndProjData<TargetT>::set_skip_projector_set_up_if_unchanged(const bool arg)
+{
+  this->skip_projector_set_up_if_unchanged = arg;
+}
+
 template <typename TargetT>
 void
 PoissonLogLikelihoodWithLinearModelForMeanAndProjData<TargetT>::set_frame_num(const int arg)
@@ -621,7 +630,20 @@ PoissonLogLikelihoodWithLinearModelForMeanAndProjData<TargetT>::set_up_before_se
   caching_info_ptr = NULL;
 #endif
 
-  this->projector_pair_ptr->set_up(proj_data_info_sptr, target_sptr);
+  // optionally only set-up the projectors when necessary, as this can be expensive
+  // (e.g. it clears the cache of a projection matrix)
+  if (!this->skip_projector_set_up_if_unchanged || this->projector_pair_set_up_sptr != this->projector_pair_ptr
+      || is_null_ptr(this->projector_pair_set_up_proj_data_info_sptr)
+      || *this->projector_pair_set_up_proj_data_info_sptr != *proj_data_info_sptr
+      || !this->projector_pair_set_up_target_sptr->has_same_characteristics(*target_sptr))
+    {
+      this->projector_pair_ptr->set_up(proj_data_info_sptr, target_sptr);
+      this->projector_pair_set_up_sptr = this->projector_pair_ptr;
+      this->projector_pair_set_up_proj_data_info_sptr = proj_data_info_sptr;
+      this->projector_pair_set_up_target_sptr = target_sptr;
+    }
+  else
+    info("Projectors were already set-up for this geometry", 2);
 
   // TODO check compatibility between symmetries for forward and backprojector
   this->symmetries_sptr.reset(this->projector_pair_ptr->get_back_projector_sptr()->get_symmetries_used()->clone());
@@ -823,6 +845,30 @@ sum_projection_data() const
 
 #endif
 
+template <typename TargetT>
+std::string
+PoissonLogLikelihoodWithLinearModelForMeanAndProjData<TargetT>::get_sensitivity_cache_key_info() const
+{
+  std::ostringstream s;
+  s << this->get_registered_name() << '\n'
+    << this->proj_data_sptr->get_proj_data_info_sptr()->parameter_info() << '\n'
+    << this->proj_data_sptr->get_exam_info().parameter_info() << '\n'
+    << "time frame: " << this->get_time_frame_definitions().get_start_time(this->get_time_frame_num()) << ' '
+    << this->get_time_frame_definitions().get_end_time(this->get_time_frame_num()) << '\n'
+    << "maximum segment number to process: " << this->max_segment_num_to_process << '\n'
+    << "maximum timing position to process: " << this->max_timing_pos_num_to_process << '\n'
+    << "zero end planes of segment 0: " << this->zero_seg0_end_planes << '\n'
+    << "use time-of-flight sensitivities: " << this->use_tofsens << '\n'
+    << this->projector_pair_ptr->parameter_info() << '\n';
+  if (!is_null_ptr(this->normalisation_sptr))
+    {
+      this->ensure_norm_is_set_up_for_sensitivity();
+      // use the values of the factors, such that the key changes when the norm data change
+      s << "normalisation:\n" << this->normalisation_sptr->get_efficiencies_key_info() << '\n';
+    }
+  return s.str();
+}
+
 template <typename TargetT>
 void
 PoissonLogLikelihoodWithLinearModelForMeanAndProjData<TargetT>::add_subset_sensitivity(TargetT& sensitivity,
@@ -1184,11 +1230,15 @@ PoissonLogLikelihoodWithLinearModelForMeanAndProjData<TargetT>::actual_accumulat
         ybar_sq_viewgram = this->get_proj_data().get_empty_related_viewgrams(vg_idx_to_process[i], symmetries_sptr);
         this->get_projector_pair().get_forward_projector_sptr()->forward_project(ybar_sq_viewgram);
 
-        // add additive sinogram to forward projection
+        // add additive sinogram to forward projection and square ybar (in a single pass)
         if (!(is_null_ptr(this->get_additive_proj_data_sptr())))
-          ybar_sq_viewgram += this->get_additive_proj_data().get_related_viewgrams(vg_idx_to_process[i], symmetries_sptr);
-        // square ybar
-        ybar_sq_viewgram *= ybar_sq_viewgram;
+          apply_elementwise(
+              ybar_sq_viewgram,
+              [](const float fwd, const float additive) { return (fwd + additive) * (fwd + additive); },
+              ybar_sq_viewgram,
+              this->get_additive_proj_data().get_related_viewgrams(vg_idx_to_process[i], symmetries_sptr));
+        else
+          ybar_sq_viewgram *= ybar_sq_viewgram;
       }
 
       // Compute: final_viewgram * F(input) / ybar_sq_viewgram
@@ -1488,12 +1538,21 @@ RPC_process_related_viewgrams_accumulate_loglikelihood(const shared_ptr<ForwardP
 
   forward_projector_sptr->forward_project(estimated_viewgrams);
 
-  if (additive_binwise_correction_ptr != NULL)
+  // add the additive term and multiply with the multiplicative term (in a single pass if both are present)
+  if (additive_binwise_correction_ptr != NULL && mult_viewgrams_ptr != NULL)
+    {
+      apply_elementwise(
+          estimated_viewgrams,
+          [](const float fwd, const float additive, const float mult) { return (fwd + additive) * mult; },
+          estimated_viewgrams,
+          *additive_binwise_correction_ptr,
+          *mult_viewgrams_ptr);
+    }
+  else if (additive_binwise_correction_ptr != NULL)
     {
       estimated_viewgrams += (*additive_binwise_correction_ptr);
-    };
-
-  if (mult_viewgrams_ptr != NULL)
+    }
+  else if (mult_viewgrams_ptr != NULL)
     {
       estimated_viewgrams *= (*mult_viewgrams_ptr);
     }
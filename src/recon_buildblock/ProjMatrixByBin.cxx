@@ -107,6 +107,21 @@ ProjMatrixByBin::clear_cache() const
     }
 }
 
+void
+ProjMatrixByBin::clear_cache_for_view(const int view_num) const
+{
+  for (int j = this->cache_collection[view_num].get_min_index(); j <= this->cache_collection[view_num].get_max_index(); ++j)
+    {
+#ifdef STIR_OPENMP
+      omp_set_lock(&this->cache_locks[view_num][j]);
+#endif
+      this->cache_collection[view_num][j].clear();
+#ifdef STIR_OPENMP
+      omp_unset_lock(&this->cache_locks[view_num][j]);
+#endif
+    }
+}
+
 /*
 void
 ProjMatrixByBin::
@@ -25,6 +25,12 @@
 #include <string>
 #include <vector>
 #include <cstdlib>
+#include <cstdio>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <iomanip>
+#include <limits>
 
 using std::endl;
 using std::nothrow;
@@ -45,6 +51,11 @@ using std::nothrow;
 #include "stir/info.h"
 #include "stir/format.h"
 #include "stir/CPUTimer.h"
+#include "stir/HighResWallClockTimer.h"
+#include "stir/FilePath.h"
+#include "stir/hash.h"
+#include "stir/error.h"
+#include "stir/warning.h"
 #ifdef STIR_OPENMP
 #  include "stir/num_threads.h"
 #endif
@@ -75,6 +86,106 @@ START_NAMESPACE_STIR
 
 const char* const ProjMatrixByBinPinholeSPECTUB::registered_name = "Pinhole SPECT UB";
 
+namespace
+{
+
+std::uint64_t
+file_contents_hash(const std::string& filename)
+{
+  std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+  std::stringstream contents;
+  contents << file.rdbuf();
+  const std::string str = contents.str();
+  return fnv1a_hash(str);
+}
+
+//! psf structures with their own storage, such that different views can be computed in parallel
+class PSFWorkspace
+{
+public:
+  PSFWorkspace(const psf2d_type& psf_bin_template,
+               const psf2d_type& psf_subs_template,
+               const psf2d_type& psf_aux_template,
+               const wmh_mph_type& wmh)
+      : psf_bin(psf_bin_template),
+        psf_subs(psf_subs_template),
+        psf_aux(psf_aux_template)
+  {
+    allocate(psf_bin, psf_bin_values, psf_bin_rows);
+    if (wmh.do_subsamp)
+      allocate(psf_subs, psf_subs_values, psf_subs_rows);
+    if (wmh.do_psfi)
+      allocate(psf_aux, psf_aux_values, psf_aux_rows);
+  }
+  PSFWorkspace(const PSFWorkspace&) = delete;
+
+  psf2d_type psf_bin;
+  psf2d_type psf_subs;
+  psf2d_type psf_aux;
+
+private:
+  std::vector<float> psf_bin_values, psf_subs_values, psf_aux_values;
+  std::vector<float*> psf_bin_rows, psf_subs_rows, psf_aux_rows;
+
+  static void allocate(psf2d_type& psf, std::vector<float>& values, std::vector<float*>& rows)
+  {
+    values.assign(static_cast<std::size_t>(psf.max_dimz) * psf.max_dimx, 0.F);
+    rows.resize(psf.max_dimz);
+    for (int i = 0; i < psf.max_dimz; i++)
+      rows[i] = values.data() + static_cast<std::size_t>(i) * psf.max_dimx;
+    psf.val = rows.data();
+  }
+};
+
+//! rotate the (0-based) in-plane indices of a voxel \a num_quarter_turns times over 90 degrees (in the UB framework)
+/*! This maps a voxel of a basic view onto the voxel with the same weight in a view whose detector
+    is rotated over <tt>num_quarter_turns*90</tt> degrees. The image needs to have \a dim voxels in x and y.
+*/
+inline void
+rotate_voxel_indices(int& ix, int& iy, const int dim, const int num_quarter_turns)
+{
+  for (int q = 0; q < num_quarter_turns; ++q)
+    {
+      const int new_ix = dim - 1 - iy;
+      iy = ix;
+      ix = new_ix;
+    }
+}
+
+//! check if an image (in UB ordering) is invariant for rotations over <tt>num_quarter_turns*90</tt> degrees
+template <typename T>
+bool
+is_invariant_for_rotation(const T* const values, const volume_type& vol, const int num_quarter_turns)
+{
+  for (int iz = 0; iz < vol.Dimz; ++iz)
+    for (int iy = 0; iy < vol.Dimy; ++iy)
+      for (int ix = 0; ix < vol.Dimx; ++ix)
+        {
+          int rotated_ix = ix, rotated_iy = iy;
+          rotate_voxel_indices(rotated_ix, rotated_iy, vol.Dimx, num_quarter_turns);
+          if (values[iz * vol.Npix + iy * vol.Dimx + ix] != values[iz * vol.Npix + rotated_iy * vol.Dimx + rotated_ix])
+            return false;
+        }
+  return true;
+}
+
+inline bool
+is_close(const float a, const float b)
+{
+  return std::abs(a - b) <= 1.E-5F * (1.F + std::abs(a));
+}
+
+//! check if two holes have the same geometry in their rotated framework
+bool
+holes_are_equal(const hole_type& h1, const hole_type& h2)
+{
+  return h1.do_round == h2.do_round && is_close(h1.x1, h2.x1) && is_close(h1.y1, h2.y1) && is_close(h1.z1, h2.z1)
+         && is_close(h1.ahx, h2.ahx) && is_close(h1.ahz, h2.ahz) && is_close(h1.aa_x, h2.aa_x) && is_close(h1.aa_z, h2.aa_z)
+         && is_close(h1.dxcm, h2.dxcm) && is_close(h1.dzcm, h2.dzcm);
+}
+
+} // namespace
+
 ProjMatrixByBinPinholeSPECTUB::ProjMatrixByBinPinholeSPECTUB()
 {
   set_defaults();
@@ -103,6 +214,9 @@ ProjMatrixByBinPinholeSPECTUB::initialise_keymap()
   parser.add_key("mask file", &mask_file);
   parser.add_key("mask from attenuation map", &mask_from_attenuation_map);
   parser.add_key("keep all views in cache", &keep_all_views_in_cache);
+  parser.add_key("maximum number of views in cache", &maximum_number_of_views_in_cache);
+  parser.add_key("use rotational symmetries", &use_rotational_symmetries);
+  parser.add_key("matrix cache directory", &matrix_cache_directory);
 
   parser.add_stop_key("End Projection Matrix By Bin Pinhole SPECT UB Parameters");
 }
@@ -115,6 +229,9 @@ ProjMatrixByBinPinholeSPECTUB::set_defaults()
   this->already_setup = false;
 
   this->keep_all_views_in_cache = false;
+  this->maximum_number_of_views_in_cache = 1;
+  this->use_rotational_symmetries = true;
+  this->matrix_cache_directory = "";
   minimum_weight = 0.0;
   maximum_number_of_sigmas = 2.;
   spatial_resolution_PSF = 0.001;
@@ -149,6 +266,17 @@ ProjMatrixByBinPinholeSPECTUB::post_processing()
   else
     this->mask_image_sptr.reset();
 
+  if (this->maximum_number_of_views_in_cache < 1)
+    {
+      warning("Pinhole SPECTUB: maximum number of views in cache has to be at least 1");
+      return true;
+    }
+  if (!this->matrix_cache_directory.empty() && !FilePath::exists(this->matrix_cache_directory))
+    {
+      warning(format("Pinhole SPECTUB matrix cache directory '{}' does not exist", this->matrix_cache_directory));
+      return true;
+    }
+
   this->already_setup = false;
 
   return false;
@@ -426,6 +554,58 @@ ProjMatrixByBinPinholeSPECTUB::set_keep_all_views_in_cache(bool value)
     }
 }
 
+int
+ProjMatrixByBinPinholeSPECTUB::get_maximum_number_of_views_in_cache() const
+{
+  return this->maximum_number_of_views_in_cache;
+}
+
+void
+ProjMatrixByBinPinholeSPECTUB::set_maximum_number_of_views_in_cache(const int value)
+{
+  if (value < 1)
+    error("Pinhole SPECTUB: maximum number of views in cache has to be at least 1");
+  if (this->maximum_number_of_views_in_cache != value)
+    {
+      this->maximum_number_of_views_in_cache = value;
+      this->already_setup = false;
+    }
+}
+
+bool
+ProjMatrixByBinPinholeSPECTUB::get_use_rotational_symmetries() const
+{
+  return this->use_rotational_symmetries;
+}
+
+void
+ProjMatrixByBinPinholeSPECTUB::set_use_rotational_symmetries(const bool value)
+{
+  if (this->use_rotational_symmetries != value)
+    {
+      this->use_rotational_symmetries = value;
+      this->already_setup = false;
+    }
+}
+
+std::string
+ProjMatrixByBinPinholeSPECTUB::get_matrix_cache_directory() const
+{
+  return this->matrix_cache_directory;
+}
+
+void
+ProjMatrixByBinPinholeSPECTUB::set_matrix_cache_directory(const std::string& value)
+{
+  if (!value.empty() && !FilePath::exists(value))
+    error(format("Pinhole SPECTUB matrix cache directory '{}' does not exist", value));
+  if (this->matrix_cache_directory != value)
+    {
+      this->matrix_cache_directory = value;
+      this->already_setup = false;
+    }
+}
+
 //******************** actual implementation *************
 
 void
@@ -434,9 +614,6 @@ ProjMatrixByBinPinholeSPECTUB::set_up(
     const shared_ptr<const DiscretisedDensity<3, float>>& density_info_ptr // TODO should be Info only
 )
 {
-
-  ProjMatrixByBin::set_up(proj_data_info_ptr_v, density_info_ptr);
-
 #ifdef STIR_OPENMP
   if (!this->keep_all_views_in_cache)
     {
@@ -459,6 +636,7 @@ ProjMatrixByBinPinholeSPECTUB::set_up(
           && this->origin == image_info_ptr->get_origin() && *proj_data_info_ptr_v == *this->proj_data_info_ptr)
         {
           // stored matrix should be compatible, so we can just reuse it
+          // (note: ProjMatrixByBin::set_up() would clear the cache, so we cannot call it)
           return;
         }
       else
@@ -468,6 +646,10 @@ ProjMatrixByBinPinholeSPECTUB::set_up(
         }
     }
 
+  ProjMatrixByBin::set_up(proj_data_info_ptr_v, density_info_ptr);
+  if (this->cache_disabled)
+    error("ProjMatrixByBinPinholeSPECTUB needs the cache to be enabled");
+
   this->proj_data_info_ptr = proj_data_info_ptr_v;
   symmetries_sptr.reset(new TrivialDataSymmetriesForBins(proj_data_info_ptr_v));
 
@@ -626,6 +808,9 @@ ProjMatrixByBinPinholeSPECTUB::set_up(
 
   //... files with complementary information .................
 
+  // (these append to the detector elements and holes, which might have been read by a previous call to set_up())
+  wmh.detel.clear();
+  wmh.collim.holes.clear();
   read_prj_params_mph(wmh);
   read_coll_params_mph(wmh);
 
@@ -729,6 +914,9 @@ ProjMatrixByBinPinholeSPECTUB::set_up(
     }
 
   //... initialize psf2d in bins ..................................................
+  // note: only sizes are set here, values are allocated per view (see PSFWorkspace)
+
+  psf_bin = psf_subs = psf_aux = kern = psf2d_type();
 
   wmh.max_amp = (wmh.prj.rad - wmh.ro) / (wmh.collim.rad - wmh.ro);
 
@@ -773,28 +961,17 @@ ProjMatrixByBinPinholeSPECTUB::set_up(
 
           psf_aux.max_dimx = psf_aux.dimx = psf_subs.max_dimx;
           psf_aux.max_dimz = psf_aux.dimz = psf_subs.max_dimz;
-
-          psf_aux.val = new float*[psf_aux.max_dimz];
-
-          for (int i = 0; i < psf_aux.max_dimz; i++)
-            psf_aux.val[i] = new float[psf_aux.max_dimx];
         }
 
-      psf_subs.val = new float*[psf_subs.max_dimz];
-
-      for (int i = 0; i < psf_subs.max_dimz; i++)
-        psf_subs.val[i] = new float[psf_subs.max_dimx];
-
       psf_bin.max_dimx = psf_subs.max_dimx / wmh.subsamp + 2;
       psf_bin.max_dimz = psf_subs.max_dimz / wmh.subsamp + 2;
     }
 
-  psf_bin.val = new float*[psf_bin.max_dimz];
+  //... rotational symmetries ....................................................
 
-  for (int i = 0; i < psf_bin.max_dimz; i++)
-    psf_bin.val[i] = new float[psf_bin.max_dimx];
+  this->find_rotational_symmetries();
 
-  //... size estimation .........................................................
+  //... size estimation (only for basic views) ...................................
 
   // number of non-zero elements for each weight matrix row
   Nitems = new int*[wmh.prj.NOS];
@@ -805,42 +982,77 @@ ProjMatrixByBinPinholeSPECTUB::set_up(
         Nitems[kOS][i] = 1; // Nitems initializated to one
     }
 
-  //... double array wm.val and wm.col .....................................................
-
-  if ((wm.val = new (nothrow) float*[wmh.prj.NbOS]) == nullptr)
-    error(
-        "Error allocating space to store values for SPECTUB matrix"); // error_wmtools_SPECT_mph( 200, wmh.prj.NbOS, "wm.val[]" );
+  // note: the arrays of wm (values, column and STIR indices) are allocated per view in compute_basic_view()
 
-  if ((wm.col = new (nothrow) int*[wmh.prj.NbOS]) == nullptr)
-    error("Error allocating space to store column indices for SPECTUB matrix"); // error_wmtools_SPECT_mph( 200, wmh.prj.NbOS,
-                                                                                // "wm.col[]" );
-
-  //... array wm.ne .........................................................................
-
-  if ((wm.ne = new (nothrow) int[wmh.prj.NbOS + 1]) == 0)
-    error("Error allocating space to store number of elements for SPECTUB matrix"); // error_wmtools_SPECT_mph(200, wmh.prj.NbOS +
-                                                                                    // 1, "wm.ne[]");
-
-  // allocate memory for weight matrix
-  if (wm.do_save_STIR)
-    {
-      wm.ns = new int[wmh.prj.NbOS];
-      wm.nb = new int[wmh.prj.NbOS];
-      wm.na = new int[wmh.prj.NbOS];
-
-      wm.nx = new short int[wmh.vol.Nvox];
-      wm.ny = new short int[wmh.vol.Nvox];
-      wm.nz = new short int[wmh.vol.Nvox];
-    }
-
-  // size estimation
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
   for (int kOS = 0; kOS < wmh.prj.NOS; kOS++)
     {
-      wm_calculation_mph(false, kOS, &psf_bin, &psf_subs, &psf_aux, &kern, attmap, msk_3d, Nitems[kOS], wmh, wm, pcf);
+      if (this->basic_view_nums[kOS] != kOS)
+        continue;
+      PSFWorkspace workspace(psf_bin, psf_subs, psf_aux, wmh);
+      wm_calculation_mph(false,
+                         kOS,
+                         &workspace.psf_bin,
+                         &workspace.psf_subs,
+                         &workspace.psf_aux,
+                         &kern,
+                         attmap,
+                         msk_3d,
+                         Nitems[kOS],
+                         wmh,
+                         wm,
+                         pcf);
     }
   info(format("Done estimating size of matrix. Execution time, CPU {} s", timer.value()), 2);
 
+  //... key for the persistent matrix cache ...........................................
+  {
+    // all parameters that determine the matrix, including (hashes of) the detector and collimator files,
+    // the attenuation map and the mask
+    std::stringstream key_stream;
+    key_stream << std::setprecision(std::numeric_limits<float>::max_digits10);
+    key_stream << "Pinhole SPECTUB matrix v1"
+               << " vol " << wmh.vol.Dimx << ' ' << wmh.vol.Dimy << ' ' << wmh.vol.Dimz << ' ' << wmh.vol.szcm << ' '
+               << wmh.vol.thcm << " prj " << wmh.prj.Nbin << ' ' << wmh.prj.Nsli << ' ' << wmh.prj.szcm << ' ' << wmh.prj.thcm
+               << ' ' << proj_Data_Info_Cylindrical->get_ring_radius() << ' ' << wmh.prj.NOS << std::hex << " detector "
+               << file_contents_hash(wmh.detector_fn) << " collimator " << file_contents_hash(wmh.collim_fn) << std::dec
+               << " psf " << wmh.mn_w << ' ' << wmh.Nsigm << ' ' << wmh.highres << ' ' << wmh.subsamp << ' ' << wmh.do_psfi << ' '
+               << wmh.do_depth << " att " << wmh.do_att << ' ' << wmh.do_full_att;
+    if (wmh.do_att)
+      key_stream << ' ' << std::hex << fnv1a_hash(attmap, wmh.vol.Nvox * sizeof(float)) << std::dec;
+    key_stream << " msk " << std::hex << fnv1a_hash(msk_3d, wmh.vol.Nvox * sizeof(bool)) << std::dec;
+    this->matrix_cache_key = key_stream.str();
+  }
+
+  this->view_already_processed.assign(wmh.prj.NOS, false);
+  this->views_in_cache.clear();
   this->already_setup = true;
+
+  //... computation of all views ......................................................
+  if (this->keep_all_views_in_cache)
+    {
+      HighResWallClockTimer wall_clock_timer;
+      wall_clock_timer.start();
+      // first compute the basic views, then derive the other views from the basic views in the cache
+      std::vector<int> basic_views, derived_views;
+      for (int kOS = 0; kOS < wmh.prj.NOS; kOS++)
+        (this->basic_view_nums[kOS] == kOS ? basic_views : derived_views).push_back(kOS);
+      for (const std::vector<int>* views_ptr : { &basic_views, &derived_views })
+        {
+          const int num_views = static_cast<int>(views_ptr->size());
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
+          for (int i = 0; i < num_views; i++)
+            this->compute_one_subset((*views_ptr)[i]);
+          for (const int kOS : *views_ptr)
+            this->view_already_processed[kOS] = true;
+        }
+      wall_clock_timer.stop();
+      info(format("Done computing all views of Pinhole SPECTUB matrix. Wall-clock time {} s", wall_clock_timer.value()), 2);
+    }
 }
 
 ProjMatrixByBinPinholeSPECTUB*
@@ -863,22 +1075,6 @@ ProjMatrixByBinPinholeSPECTUB::delete_PinholeSPECTUB_arrays()
   if (!this->already_setup)
     return;
 
-  //... freeing matrix memory....................................
-
-  delete[] wm.val;
-  delete[] wm.col;
-  delete[] wm.ne;
-
-  if (wm.do_save_STIR)
-    {
-      delete[] wm.ns;
-      delete[] wm.nb;
-      delete[] wm.na;
-      delete[] wm.nx;
-      delete[] wm.ny;
-      delete[] wm.nz;
-    }
-
   //... freeing pre-calculated functions ....................................
 
   if (wmh.do_round_cumsum)
@@ -899,28 +1095,13 @@ ProjMatrixByBinPinholeSPECTUB::delete_PinholeSPECTUB_arrays()
     delete pcf.cr_att.val;
 
   //... freeing memory ....................................
-
-  for (int i = 0; i < psf_bin.max_dimz; i++)
-    delete[] psf_bin.val[i];
-  delete[] psf_bin.val;
-
-  if (wmh.do_subsamp)
-    {
-      for (int i = 0; i < psf_subs.max_dimz; i++)
-        delete[] psf_subs.val[i];
-      delete[] psf_subs.val;
-    }
+  // (values of psf_bin, psf_subs and psf_aux are allocated per view)
 
   if (wmh.do_psfi)
     {
       for (int i = 0; i < kern.max_dimz; i++)
         delete[] kern.val[i];
       delete[] kern.val;
-
-      // original code did not deallocate psf_aux.val, possible memory leak
-      for (int i = 0; i < psf_aux.max_dimz; i++)
-        delete[] psf_aux.val[i];
-      delete[] psf_aux.val;
     }
 
   for (int kOS = 0; kOS < wmh.prj.NOS; kOS++)
@@ -934,8 +1115,71 @@ ProjMatrixByBinPinholeSPECTUB::delete_PinholeSPECTUB_arrays()
 }
 
 void
-ProjMatrixByBinPinholeSPECTUB::compute_one_subset(const int kOS) const
+ProjMatrixByBinPinholeSPECTUB::find_rotational_symmetries()
 {
+  const int num_views = wmh.prj.NOS;
+  this->basic_view_nums.resize(num_views);
+  this->num_quarter_turns.assign(num_views, 0);
+  for (int kOS = 0; kOS < num_views; kOS++)
+    this->basic_view_nums[kOS] = kOS;
+
+  if (!this->use_rotational_symmetries)
+    return;
+  // we need every view to correspond to a single detector position, and a square image
+  if (wmh.prj.NdOS != 1 || wmh.vol.Dimx != wmh.vol.Dimy)
+    {
+      info("Pinhole SPECTUB: rotational symmetries not used, as the image is not square or views have multiple detectors");
+      return;
+    }
+
+  // find which rotations leave mask and attenuation map invariant
+  bool rotation_is_allowed[4] = { true, false, false, false };
+  for (int q = 1; q < 4; q++)
+    rotation_is_allowed[q]
+        = is_invariant_for_rotation(msk_3d, wmh.vol, q) && (attmap == nullptr || is_invariant_for_rotation(attmap, wmh.vol, q));
+
+  const float quarter_turn = static_cast<float>(_PI / 2);
+  int num_basic_views = 0;
+  for (int kOS = 0; kOS < num_views; kOS++)
+    {
+      const detel_type& d = wmh.detel[kOS];
+      for (int basic_kOS = 0; basic_kOS < kOS; basic_kOS++)
+        {
+          if (this->basic_view_nums[basic_kOS] != basic_kOS)
+            continue;
+          const detel_type& basic_d = wmh.detel[basic_kOS];
+          const float delta_theta = d.theta - basic_d.theta;
+          const int num_turns = static_cast<int>(std::lround(delta_theta / quarter_turn));
+          if (std::abs(delta_theta - num_turns * quarter_turn) > 1.E-5F || !is_close(d.z0, basic_d.z0) || d.nh != basic_d.nh)
+            continue;
+          const int q = ((num_turns % 4) + 4) % 4;
+          if (!rotation_is_allowed[q])
+            continue;
+          bool holes_match = true;
+          for (int ih = 0; ih < d.nh && holes_match; ih++)
+            holes_match = holes_are_equal(wmh.collim.holes[d.who[ih]], wmh.collim.holes[basic_d.who[ih]]);
+          if (holes_match)
+            {
+              this->basic_view_nums[kOS] = basic_kOS;
+              this->num_quarter_turns[kOS] = q;
+              break;
+            }
+        }
+      if (this->basic_view_nums[kOS] == kOS)
+        ++num_basic_views;
+    }
+  info(format("Pinhole SPECTUB: computing {} basic views, the other {} views are derived using rotational symmetries",
+              num_basic_views,
+              num_views - num_basic_views),
+       2);
+}
+
+void
+ProjMatrixByBinPinholeSPECTUB::compute_basic_view(std::vector<ProjMatrixElemsForOneBin>& lors, const int kOS) const
+{
+  if (!this->matrix_cache_directory.empty() && this->read_view_from_matrix_cache(lors, kOS))
+    return;
+
   CPUTimer timer;
   timer.start();
 
@@ -951,43 +1195,275 @@ ProjMatrixByBinPinholeSPECTUB::compute_one_subset(const int kOS) const
               (wm.do_save_STIR ? (ne + 10 * wmh.prj.NbOS) / 104857.6 : ne / 131072)),
        2);
 
-  //... memory allocation for wm float arrays ....................................................
+  //... memory allocation for wm arrays (initialised to zero) .......................................
+  // We use local copies of wm and the psf structures (and their arrays), such that different views can be computed in parallel.
 
-  wm_alloc(Nitems[kOS], wm, wmh);
+  wm_da_type view_wm = this->wm;
+  std::vector<std::vector<float>> val(wmh.prj.NbOS);
+  std::vector<std::vector<int>> col(wmh.prj.NbOS);
+  std::vector<float*> val_ptrs(wmh.prj.NbOS);
+  std::vector<int*> col_ptrs(wmh.prj.NbOS);
+  for (int i = 0; i < wmh.prj.NbOS; i++)
+    {
+      val[i].assign(Nitems[kOS][i], 0.F);
+      col[i].assign(Nitems[kOS][i], 0);
+      val_ptrs[i] = val[i].data();
+      col_ptrs[i] = col[i].data();
+    }
+  std::vector<int> num_elems(wmh.prj.NbOS + 1, 0);
+  std::vector<int> na(wmh.prj.NbOS), nb(wmh.prj.NbOS), ns(wmh.prj.NbOS);
+  std::vector<short int> nx(wmh.vol.Nvox), ny(wmh.vol.Nvox), nz(wmh.vol.Nvox);
+  view_wm.val = val_ptrs.data();
+  view_wm.col = col_ptrs.data();
+  view_wm.ne = num_elems.data();
+  view_wm.na = na.data();
+  view_wm.nb = nb.data();
+  view_wm.ns = ns.data();
+  view_wm.nx = nx.data();
+  view_wm.ny = ny.data();
+  view_wm.nz = nz.data();
+
+  PSFWorkspace workspace(psf_bin, psf_subs, psf_aux, wmh);
 
   //... wm calculation ...............................................................................
 
-  wm_calculation_mph(true, kOS, &psf_bin, &psf_subs, &psf_aux, &kern, attmap, msk_3d, Nitems[kOS], wmh, wm, pcf);
+  wm_calculation_mph(true,
+                     kOS,
+                     &workspace.psf_bin,
+                     &workspace.psf_subs,
+                     &workspace.psf_aux,
+                     &kern,
+                     attmap,
+                     msk_3d,
+                     Nitems[kOS],
+                     wmh,
+                     view_wm,
+                     pcf);
   info(format("Weight matrix calculation done, CPU {} s", timer.value()), 2);
 
   //... fill lor ..........................
+  lors.resize(wmh.prj.NbOS);
   for (int j = 0; j < wmh.prj.NbOS; j++)
     {
-      ProjMatrixElemsForOneBin lor;
+      ProjMatrixElemsForOneBin& lor = lors[j];
       Bin bin;
       bin.segment_num() = 0;
-      bin.view_num() = wm.na[j];
-      bin.axial_pos_num() = wm.ns[j];
-      bin.tangential_pos_num() = wm.nb[j];
+      bin.view_num() = view_wm.na[j];
+      bin.axial_pos_num() = view_wm.ns[j];
+      bin.tangential_pos_num() = view_wm.nb[j];
       bin.set_bin_value(0);
+      lor.erase();
       lor.set_bin(bin);
 
-      lor.reserve(wm.ne[j]);
-      for (int i = 0; i < wm.ne[j]; i++)
+      lor.reserve(view_wm.ne[j]);
+      for (int i = 0; i < view_wm.ne[j]; i++)
         {
 
           const ProjMatrixElemsForOneBin::value_type elem(
-              Coordinate3D<int>(wm.nz[wm.col[j][i]], wm.ny[wm.col[j][i]], wm.nx[wm.col[j][i]]), wm.val[j][i]);
+              Coordinate3D<int>(view_wm.nz[view_wm.col[j][i]], view_wm.ny[view_wm.col[j][i]], view_wm.nx[view_wm.col[j][i]]),
+              view_wm.val[j][i]);
           lor.push_back(elem);
         }
+      // free memory as we go
+      std::vector<float>().swap(val[j]);
+      std::vector<int>().swap(col[j]);
+    }
+
+  if (!this->matrix_cache_directory.empty())
+    this->write_view_to_matrix_cache(lors, kOS);
+
+  info(format("Total time after transfering to ProjMatrixElemsForOneBin, CPU {} s", timer.value()), 2);
+}
+
+void
+ProjMatrixByBinPinholeSPECTUB::compute_one_subset(const int kOS) const
+{
+  const int basic_kOS = this->basic_view_nums[kOS];
+  std::vector<ProjMatrixElemsForOneBin> lors;
+  if (basic_kOS == kOS)
+    {
+      this->compute_basic_view(lors, kOS);
+    }
+  else
+    {
+      // get the basic view from the cache if it is there (same order of bins as in compute_basic_view())
+      bool found = this->view_already_processed[basic_kOS];
+      if (found)
+        {
+          lors.resize(wmh.prj.NbOS);
+          for (int j = 0; j < wmh.prj.NbOS && found; j++)
+            {
+              lors[j].set_bin(Bin(0, basic_kOS, j / wmh.prj.Nbin, j % wmh.prj.Nbin - wmh.prj.Nbin / 2, 0.F));
+              found = this->get_cached_proj_matrix_elems_for_one_bin(lors[j]) == Succeeded::yes;
+            }
+        }
+      if (!found)
+        this->compute_basic_view(lors, basic_kOS);
+
+      // derive the weights by rotating the voxels (in the UB framework, with 0-based indices)
+      const int Dimxd2 = wmh.vol.Dimx / 2;
+      const int Dimyd2 = wmh.vol.Dimy / 2;
+      std::vector<ProjMatrixElemsForOneBin> rotated_lors(lors.size());
+      for (std::size_t j = 0; j < lors.size(); j++)
+        {
+          Bin bin = lors[j].get_bin();
+          bin.view_num() = kOS;
+          rotated_lors[j].set_bin(bin);
+          rotated_lors[j].reserve(lors[j].size());
+          for (const auto& elem : lors[j])
+            {
+              int ix = elem.coord3() + Dimxd2;
+              int iy = elem.coord2() + Dimyd2;
+              rotate_voxel_indices(ix, iy, wmh.vol.Dimx, this->num_quarter_turns[kOS]);
+              const Coordinate3D<int> coords(elem.coord1(), iy - Dimyd2, ix - Dimxd2);
+              rotated_lors[j].push_back(ProjMatrixElemsForOneBin::value_type(coords, elem.get_value()));
+            }
+        }
+      lors.swap(rotated_lors);
+    }
+
+  for (const auto& lor : lors)
+    this->cache_proj_matrix_elems_for_one_bin(lor);
+}
 
-      delete[] wm.val[j];
-      delete[] wm.col[j];
+std::string
+ProjMatrixByBinPinholeSPECTUB::get_matrix_cache_filename(const int view_num) const
+{
+  std::string filename = this->matrix_cache_directory;
+  FilePath::append_separator(filename);
+  std::stringstream name_stream;
+  name_stream << "PinholeSPECTUB_matrix_" << std::hex << std::setw(16) << std::setfill('0')
+              << fnv1a_hash(this->matrix_cache_key) << std::dec << "_view" << view_num
+              << ".bin";
+  return filename + name_stream.str();
+}
+
+/* Format of the matrix cache files (native byte order):
+   - the header line "STIR Pinhole SPECTUB matrix cache\n"
+   - std::uint64_t length of the key, followed by the key (matrix_cache_key)
+   - std::int32_t number of bins
+   - for every bin: std::int32_t view, axial and tangential position number, std::int32_t number of elements,
+     for every element: 3 std::int16_t (z,y,x) and the weight as float
+*/
+static const char* const matrix_cache_header = "STIR Pinhole SPECTUB matrix cache\n";
 
-      this->cache_proj_matrix_elems_for_one_bin(lor);
+bool
+ProjMatrixByBinPinholeSPECTUB::read_view_from_matrix_cache(std::vector<ProjMatrixElemsForOneBin>& lors, const int view_num) const
+{
+  const std::string filename = this->get_matrix_cache_filename(view_num);
+  std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!file)
+    return false;
+
+  const std::string header(matrix_cache_header);
+  std::string file_header(header.size(), ' ');
+  file.read(&file_header[0], header.size());
+  std::uint64_t key_length = 0;
+  file.read(reinterpret_cast<char*>(&key_length), sizeof(key_length));
+  if (!file || file_header != header || key_length != this->matrix_cache_key.size())
+    {
+      warning(format("Pinhole SPECTUB matrix cache file {} has a different format or parameters. It will be recomputed.",
+                     filename));
+      return false;
+    }
+  std::string key(key_length, ' ');
+  file.read(&key[0], key_length);
+  std::int32_t num_bins = 0;
+  file.read(reinterpret_cast<char*>(&num_bins), sizeof(num_bins));
+  if (!file || key != this->matrix_cache_key || num_bins != wmh.prj.NbOS)
+    {
+      warning(format("Pinhole SPECTUB matrix cache file {} has a different format or parameters. It will be recomputed.",
+                     filename));
+      return false;
     }
 
-  info(format("Total time after transfering to ProjMatrixElemsForOneBin, CPU {} s", timer.value()), 2);
+  lors.resize(num_bins);
+  std::vector<std::int16_t> coords;
+  std::vector<float> values;
+  for (auto& lor : lors)
+    {
+      std::int32_t bin_info[4];
+      file.read(reinterpret_cast<char*>(bin_info), sizeof(bin_info));
+      const std::int32_t num_elems = bin_info[3];
+      if (!file || num_elems < 0)
+        {
+          warning(format("Error reading Pinhole SPECTUB matrix cache file {}. It will be recomputed.", filename));
+          return false;
+        }
+      coords.resize(3 * static_cast<std::size_t>(num_elems));
+      values.resize(num_elems);
+      file.read(reinterpret_cast<char*>(coords.data()), coords.size() * sizeof(std::int16_t));
+      file.read(reinterpret_cast<char*>(values.data()), values.size() * sizeof(float));
+      if (!file)
+        {
+          warning(format("Error reading Pinhole SPECTUB matrix cache file {}. It will be recomputed.", filename));
+          return false;
+        }
+
+      lor.erase();
+      lor.set_bin(Bin(0, bin_info[0], bin_info[1], bin_info[2], 0.F));
+      lor.reserve(num_elems);
+      for (std::int32_t i = 0; i < num_elems; ++i)
+        lor.push_back(ProjMatrixElemsForOneBin::value_type(
+            Coordinate3D<int>(coords[3 * i], coords[3 * i + 1], coords[3 * i + 2]), values[i]));
+    }
+
+  info(format("Read matrix elements for view {} from {}", view_num, filename), 2);
+  return true;
+}
+
+void
+ProjMatrixByBinPinholeSPECTUB::write_view_to_matrix_cache(const std::vector<ProjMatrixElemsForOneBin>& lors,
+                                                          const int view_num) const
+{
+  const std::string filename = this->get_matrix_cache_filename(view_num);
+  // write to a temporary file first, such that other processes never read a partially written file
+  const std::string tmp_filename = filename + ".tmp";
+  {
+    std::ofstream file(tmp_filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file)
+      {
+        warning(format("Could not open Pinhole SPECTUB matrix cache file {} for writing", tmp_filename));
+        return;
+      }
+    const std::uint64_t key_length = this->matrix_cache_key.size();
+    const std::int32_t num_bins = static_cast<std::int32_t>(lors.size());
+    file.write(matrix_cache_header, std::string(matrix_cache_header).size());
+    file.write(reinterpret_cast<const char*>(&key_length), sizeof(key_length));
+    file.write(this->matrix_cache_key.data(), key_length);
+    file.write(reinterpret_cast<const char*>(&num_bins), sizeof(num_bins));
+
+    std::vector<std::int16_t> coords;
+    std::vector<float> values;
+    for (const auto& lor : lors)
+      {
+        const Bin bin = lor.get_bin();
+        const std::int32_t num_elems = static_cast<std::int32_t>(lor.size());
+        const std::int32_t bin_info[4] = { bin.view_num(), bin.axial_pos_num(), bin.tangential_pos_num(), num_elems };
+        file.write(reinterpret_cast<const char*>(bin_info), sizeof(bin_info));
+        coords.clear();
+        values.clear();
+        for (const auto& elem : lor)
+          {
+            coords.push_back(static_cast<std::int16_t>(elem.coord1()));
+            coords.push_back(static_cast<std::int16_t>(elem.coord2()));
+            coords.push_back(static_cast<std::int16_t>(elem.coord3()));
+            values.push_back(elem.get_value());
+          }
+        file.write(reinterpret_cast<const char*>(coords.data()), coords.size() * sizeof(std::int16_t));
+        file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(float));
+      }
+    if (!file)
+      {
+        warning(format("Error writing Pinhole SPECTUB matrix cache file {}", tmp_filename));
+        file.close();
+        std::remove(tmp_filename.c_str());
+        return;
+      }
+  }
+  std::remove(filename.c_str());
+  if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0)
+    warning(format("Could not rename Pinhole SPECTUB matrix cache file {} to {}", tmp_filename, filename));
 }
 
 void
@@ -998,14 +1474,29 @@ ProjMatrixByBinPinholeSPECTUB::calculate_proj_matrix_elems_for_one_bin(ProjMatri
 #ifdef STIR_OPENMP
 #  pragma omp critical(PROJMATRIXBYBINUBONEVIEW)
 #endif
+  if (!this->view_already_processed[view_num])
+    {
+      if (!this->keep_all_views_in_cache)
+        {
+          // remove the oldest views from the cache such that at most maximum_number_of_views_in_cache remain
+          while (this->views_in_cache.size() >= static_cast<std::size_t>(this->maximum_number_of_views_in_cache))
+            {
+              const int oldest_view_num = this->views_in_cache.front();
+              this->views_in_cache.pop_front();
+              this->clear_cache_for_view(oldest_view_num);
+              this->view_already_processed[oldest_view_num] = false;
+            }
+          this->views_in_cache.push_back(view_num);
+        }
 
-  if (!this->keep_all_views_in_cache)
-    this->clear_cache();
-
-  info(format("Computing matrix elements for view {}", view_num), 2);
-  compute_one_subset(view_num);
+      info(format("Computing matrix elements for view {}", view_num), 2);
+      compute_one_subset(view_num);
+      this->view_already_processed[view_num] = true;
+    }
 
+  // all elements of this view are now in the cache
   lor.erase();
+  this->get_cached_proj_matrix_elems_for_one_bin(lor);
 }
 
 END_NAMESPACE_STIR
@@ -35,6 +35,9 @@
 #include "stir/error.h"
 #include "stir/format.h"
 #include "stir/CPUTimer.h"
+#include "stir/HighResWallClockTimer.h"
+#include "stir/FilePath.h"
+#include "stir/hash.h"
 #ifdef STIR_OPENMP
 #  include "stir/num_threads.h"
 #endif
@@ -51,7 +54,11 @@
 #include <string>
 #include <vector>
 #include <cstdlib>
+#include <cstdio>
+#include <cstdint>
 #include <cmath>
+#include <iomanip>
+#include <limits>
 
 //... user defined libraries .............................................................
 
@@ -62,6 +69,25 @@ START_NAMESPACE_STIR
 
 const char* const ProjMatrixByBinSPECTUB::registered_name = "SPECT UB";
 
+//! quantise a weight to 16 bits, using \a scale = maximum weight of its bin / 65535
+static std::uint16_t
+quantise_weight(const float weight, const float scale)
+{
+  if (scale <= 0.F)
+    return 0;
+  return static_cast<std::uint16_t>(std::min(std::lround(std::max(weight, 0.F) / scale), 65535L));
+}
+
+//! inverse of quantise_weight()
+/*! This is a single multiplication with the scale as stored in the file, such that the result is the
+    same when writing and reading the file (even with -ffast-math).
+*/
+static float
+dequantise_weight(const std::uint16_t quantised_weight, const float scale)
+{
+  return quantised_weight * scale;
+}
+
 ProjMatrixByBinSPECTUB::ProjMatrixByBinSPECTUB()
 {
   set_defaults();
@@ -86,6 +112,8 @@ ProjMatrixByBinSPECTUB::initialise_keymap()
   parser.add_key("mask type", &mask_type);
   parser.add_key("mask file", &mask_file);
   parser.add_key("keep_all_views_in_cache", &keep_all_views_in_cache);
+  parser.add_key("matrix cache directory", &matrix_cache_directory);
+  parser.add_key("quantise matrix cache", &quantise_matrix_cache);
 
   parser.add_stop_key("End Projection Matrix By Bin SPECT UB Parameters");
 }
@@ -108,6 +136,8 @@ ProjMatrixByBinSPECTUB::set_defaults()
   attenuation_map = "";
   mask_type = "no";
   mask_file = "";
+  matrix_cache_directory = "";
+  quantise_matrix_cache = false;
 }
 
 bool
@@ -121,6 +151,11 @@ ProjMatrixByBinSPECTUB::post_processing()
     this->set_attenuation_image_sptr(this->attenuation_map);
   else
     this->attenuation_image_sptr.reset();
+  if (!this->matrix_cache_directory.empty() && !FilePath::exists(this->matrix_cache_directory))
+    {
+      warning(format("SPECTUB matrix cache directory '{}' does not exist", this->matrix_cache_directory));
+      return true;
+    }
 
   this->already_setup = false;
 
@@ -143,6 +178,40 @@ ProjMatrixByBinSPECTUB::set_keep_all_views_in_cache(bool value)
     }
 }
 
+std::string
+ProjMatrixByBinSPECTUB::get_matrix_cache_directory() const
+{
+  return this->matrix_cache_directory;
+}
+
+void
+ProjMatrixByBinSPECTUB::set_matrix_cache_directory(const std::string& value)
+{
+  if (!value.empty() && !FilePath::exists(value))
+    error(format("SPECTUB matrix cache directory '{}' does not exist", value));
+  if (this->matrix_cache_directory != value)
+    {
+      this->matrix_cache_directory = value;
+      this->already_setup = false;
+    }
+}
+
+bool
+ProjMatrixByBinSPECTUB::get_quantise_matrix_cache() const
+{
+  return this->quantise_matrix_cache;
+}
+
+void
+ProjMatrixByBinSPECTUB::set_quantise_matrix_cache(const bool value)
+{
+  if (this->quantise_matrix_cache != value)
+    {
+      this->quantise_matrix_cache = value;
+      this->already_setup = false;
+    }
+}
+
 std::string
 ProjMatrixByBinSPECTUB::get_attenuation_type() const
 {
@@ -216,9 +285,6 @@ ProjMatrixByBinSPECTUB::set_up(const shared_ptr<const ProjDataInfo>& proj_data_i
                                const shared_ptr<const DiscretisedDensity<3, float>>& density_info_ptr // TODO should be Info only
 )
 {
-
-  ProjMatrixByBin::set_up(proj_data_info_ptr_v, density_info_ptr);
-
 #ifdef STIR_OPENMP
   if (!this->keep_all_views_in_cache)
     {
@@ -238,6 +304,7 @@ ProjMatrixByBinSPECTUB::set_up(const shared_ptr<const ProjDataInfo>& proj_data_i
           && this->origin == image_info_ptr->get_origin() && *proj_data_info_ptr_v == *this->proj_data_info_ptr)
         {
           // stored matrix should be compatible, so we can just reuse it
+          // (note: ProjMatrixByBin::set_up() would clear the cache, so we cannot call it)
           return;
         }
       else
@@ -247,6 +314,8 @@ ProjMatrixByBinSPECTUB::set_up(const shared_ptr<const ProjDataInfo>& proj_data_i
         }
     }
 
+  ProjMatrixByBin::set_up(proj_data_info_ptr_v, density_info_ptr);
+
   this->proj_data_info_ptr = proj_data_info_ptr_v;
   symmetries_sptr.reset(new TrivialDataSymmetriesForBins(proj_data_info_ptr_v));
 
@@ -619,39 +688,7 @@ ProjMatrixByBinSPECTUB::set_up(const shared_ptr<const ProjDataInfo>& proj_data_i
       NITEMS[kOS] = new int[wm.NbOS];
     }
 
-  //... double array wm.val and wm.col .....................................................
-
-  if ((wm.val = new (std::nothrow) float*[wm.NbOS]) == NULL)
-    {
-      // error_wm_SPECT( 200, "wm.val[]" );
-      error("Error allocating space to store values for SPECTUB matrix");
-    }
-  if ((wm.col = new (std::nothrow) int*[wm.NbOS]) == NULL)
-    {
-      // error_wm_SPECT( 200, "wm.col[]" );
-      error("Error allocating space to store column indices for SPECTUB matrix");
-    }
-
-  //... array wm.ne .........................................................................
-
-  if ((wm.ne = new (std::nothrow) int[wm.NbOS + 1]) == 0)
-    {
-      // error_wm_SPECT(200,"wm.ne[]");
-      error("Error allocating space to store number of elements for SPECTUB matrix");
-    }
-
-  //... STIR indices .......................................................................
-
-  if (wm.do_save_STIR)
-    {
-      wm.ns = new int[prj.NbOS];
-      wm.nb = new int[prj.NbOS];
-      wm.na = new int[prj.NbOS];
-
-      wm.nx = new short int[vol.Nvox];
-      wm.ny = new short int[vol.Nvox];
-      wm.nz = new short int[vol.Nvox];
-    }
+  // note: the arrays of wm (values, column and STIR indices) are allocated per view in compute_one_subset()
 
   //... memory allocation for wmh .........................................................
 
@@ -695,7 +732,46 @@ ProjMatrixByBinSPECTUB::set_up(const shared_ptr<const ProjDataInfo>& proj_data_i
   info(format("Done estimating size of matrix. Execution (CPU) time {} s ", timer.value()), 2);
   // wm_SPECT ends here ---------------------------------------------------------------------------------------------
 
+  //... key for the persistent matrix cache ...........................................
+  {
+    // all parameters that determine the matrix, including (hashes of) the attenuation map and mask values
+    std::stringstream key_stream;
+    key_stream << std::setprecision(std::numeric_limits<float>::max_digits10);
+    key_stream << "SPECTUB matrix v2"
+               << " vol " << vol.Ncol << ' ' << vol.Nrow << ' ' << vol.Nsli << ' ' << vol.szcm << ' ' << vol.thcm << " prj "
+               << prj.Nbin << ' ' << prj.Nsli << ' ' << prj.Nang << ' ' << prj.szcm << ' ' << prj.thcm << ' ' << prj.ang0 << ' '
+               << prj.incr << " Rrad";
+    for (int i = 0; i < prj.Nang; ++i)
+      key_stream << ' ' << Rrad[i];
+    key_stream << " psf " << wmh.do_psf << ' ' << wmh.do_psf_3d << ' ' << wmh.COL.A << ' ' << wmh.COL.B << ' ' << wmh.maxsigm
+               << ' ' << wmh.psfres << ' ' << wmh.min_w << " att " << wmh.do_att << ' ' << wmh.do_full_att;
+    if (wmh.do_att)
+      key_stream << ' ' << std::hex << fnv1a_hash(attmap, vol.Nvox * sizeof(float)) << std::dec;
+    key_stream << " msk " << wmh.do_msk;
+    if (wmh.do_msk)
+      key_stream << ' ' << std::hex << fnv1a_hash(msk_3d, vol.Nvox * sizeof(bool)) << std::dec;
+    // quantised and non-quantised weights are stored in different files
+    key_stream << " quantised " << this->quantise_matrix_cache;
+    this->matrix_cache_key = key_stream.str();
+  }
+
   this->already_setup = true;
+
+  //... computation of all views ......................................................
+  if (this->keep_all_views_in_cache && !this->cache_disabled)
+    {
+      HighResWallClockTimer wall_clock_timer;
+      wall_clock_timer.start();
+      // every view uses its own (temporary) weight-matrix arrays, so they can be computed in parallel
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
+      for (int kOS = 0; kOS < prj.NOS; ++kOS)
+        this->compute_one_subset(kOS, Rrad);
+      subset_already_processed.assign(prj.NOS, true);
+      wall_clock_timer.stop();
+      info(format("Done computing all views of SPECTUB matrix. Wall-clock time {} s", wall_clock_timer.value()), 2);
+    }
 }
 
 ProjMatrixByBinSPECTUB*
@@ -729,10 +805,6 @@ ProjMatrixByBinSPECTUB::delete_UB_SPECT_arrays()
         }
     }
 
-  delete[] wm.val;
-  delete[] wm.col;
-  delete[] wm.ne;
-
   //... freeing memory .............................................
 
   delete[] prj.order;
@@ -756,49 +828,38 @@ ProjMatrixByBinSPECTUB::delete_UB_SPECT_arrays()
       delete[] msk_3d;
       delete[] msk_2d;
     }
-
-  if (wm.do_save_STIR)
-    {
-      delete[] wm.ns;
-      delete[] wm.nb;
-      delete[] wm.na;
-      delete[] wm.nx;
-      delete[] wm.ny;
-      delete[] wm.nz;
-    }
 }
 void
 ProjMatrixByBinSPECTUB::compute_one_subset(const int kOS, const float* Rrad) const
 {
+  // in STIR, every "UB-subset" consists of a single view
+  const int view_num = prj.order[kOS * prj.NangOS];
+  if (!this->matrix_cache_directory.empty() && this->read_view_from_matrix_cache(view_num))
+    return;
 
   CPUTimer timer;
   timer.start();
   // cout << "\n\n--- Processing subset: " << kOS+1 << "/" << prj.NOS << " ----------------------------------------\n" << endl;
 
   //... to fill wmh fields related to the subset ..................................
+  // We use local copies of wmh and wm (and their arrays), such that different subsets can be computed in parallel.
 
-  this->wmh.subset_ind = kOS;
+  wmh_type subset_wmh = this->wmh;
+  std::vector<int> subset_index(prj.NangOS);
+  std::vector<float> subset_Rrad(prj.NangOS);
+  subset_wmh.index = subset_index.data();
+  subset_wmh.Rrad = subset_Rrad.data();
+  subset_wmh.subset_ind = kOS;
 
   for (int i = 0; i < prj.NangOS; i++)
     {
-
-      this->wmh.index[i] = prj.order[i + kOS * prj.NangOS];
-      this->wmh.Rrad[i] = Rrad[this->wmh.index[i]];
+      subset_index[i] = prj.order[i + kOS * prj.NangOS];
+      subset_Rrad[i] = Rrad[subset_index[i]];
     }
 
-  //... NITEMS initialization  ......................
-
-  // for ( int i = 0 ; i < prj.NbOS ; i++ ) NITEMS[ i ] = 1;
-
-  //... size esmitations ........................................................
-
-  // wm_size_estimation ( kOS,  ang, vox, bin, vol, prj, msk_3d, msk_2d, maxszb, &gaussdens, NITEMS );
-
-  // cout << "\nwm_SPECT. Size estimation done. time (s): " << double( clock()-ini )/CLOCKS_PER_SEC <<endl;
-
   int ne = 0;
 
-  for (int i = 0; i < this->wmh.prj.NbOS; i++)
+  for (int i = 0; i < subset_wmh.prj.NbOS; i++)
     ne += NITEMS[kOS][i];
 
   //... size information ....................................................................
@@ -808,78 +869,250 @@ ProjMatrixByBinSPECTUB::compute_one_subset(const int kOS, const float* Rrad) con
               (this->wm.do_save_STIR ? (ne + 10 * prj.NbOS) / 104857.6 : ne / 131072)),
        2);
 
-  //... memory allocation for wm float arrays ...................................
-
-  for (int i = 0; i < this->wmh.prj.NbOS; i++)
-    {
-
-      if ((this->wm.val[i] = new (std::nothrow) float[NITEMS[kOS][i]]) == NULL)
-        {
-          // error_wm_SPECT( 200, "wm.val[][]" );
-          error("Error allocating space to store values for SPECTUB matrix");
-        }
-
-      if ((this->wm.col[i] = new (std::nothrow) int[NITEMS[kOS][i]]) == NULL)
-        {
-          // error_wm_SPECT( 200, "wm.col[]" );
-          error("Error allocating space to store column indices for SPECTUB matrix");
-        }
-    }
-
-  //... to initialize wm to zero ......................
+  //... memory allocation for wm arrays (initialised to zero) ...................................
 
-  for (int i = 0; i < this->wm.NbOS; i++)
+  wm_da_type subset_wm = this->wm;
+  std::vector<std::vector<float>> val(subset_wm.NbOS);
+  std::vector<std::vector<int>> col(subset_wm.NbOS);
+  std::vector<float*> val_ptrs(subset_wm.NbOS);
+  std::vector<int*> col_ptrs(subset_wm.NbOS);
+  for (int i = 0; i < subset_wm.NbOS; i++)
     {
-
-      this->wm.ne[i] = 0;
-
-      for (int j = 0; j < NITEMS[kOS][i]; j++)
-        {
-
-          this->wm.val[i][j] = (float)0.;
-          this->wm.col[i][j] = 0;
-        }
+      val[i].assign(NITEMS[kOS][i], 0.F);
+      col[i].assign(NITEMS[kOS][i], 0);
+      val_ptrs[i] = val[i].data();
+      col_ptrs[i] = col[i].data();
     }
-  this->wm.ne[this->wm.NbOS] = 0;
+  std::vector<int> num_elems(subset_wm.NbOS + 1, 0);
+  std::vector<int> na(subset_wm.NbOS), nb(subset_wm.NbOS), ns(subset_wm.NbOS);
+  std::vector<short int> nx(vol.Nvox), ny(vol.Nvox), nz(vol.Nvox);
+  subset_wm.val = val_ptrs.data();
+  subset_wm.col = col_ptrs.data();
+  subset_wm.ne = num_elems.data();
+  subset_wm.na = na.data();
+  subset_wm.nb = nb.data();
+  subset_wm.ns = ns.data();
+  subset_wm.nx = nx.data();
+  subset_wm.ny = ny.data();
+  subset_wm.nz = nz.data();
 
   //... wm calculation for this subset ...........................
 
   wm_calculation(
-      kOS, ang, vox, bin, vol, prj, attmap, msk_3d, msk_2d, maxszb, &gaussdens, NITEMS[kOS], this->wm, this->wmh, Rrad);
+      kOS, ang, vox, bin, vol, prj, attmap, msk_3d, msk_2d, maxszb, &gaussdens, NITEMS[kOS], subset_wm, subset_wmh, Rrad);
   info(format("Weight matrix calculation done. time {} (s)", timer.value()), 2);
 
   //... fill lor .........................
 
-  for (int j = 0; j < this->wm.NbOS; j++)
+  std::vector<ProjMatrixElemsForOneBin> lors(subset_wm.NbOS);
+  for (int j = 0; j < subset_wm.NbOS; j++)
     {
-      ProjMatrixElemsForOneBin lor;
+      ProjMatrixElemsForOneBin& lor = lors[j];
       Bin bin;
       bin.segment_num() = 0;
-      bin.view_num() = this->wm.na[j];
-      bin.axial_pos_num() = this->wm.ns[j];
-      bin.tangential_pos_num() = this->wm.nb[j];
+      bin.view_num() = subset_wm.na[j];
+      bin.axial_pos_num() = subset_wm.ns[j];
+      bin.tangential_pos_num() = subset_wm.nb[j];
       bin.set_bin_value(0);
       lor.set_bin(bin);
 
-      lor.reserve(this->wm.ne[j]);
-      for (int i = 0; i < this->wm.ne[j]; i++)
+      lor.reserve(subset_wm.ne[j]);
+      for (int i = 0; i < subset_wm.ne[j]; i++)
         {
 
-          const ProjMatrixElemsForOneBin::value_type elem(Coordinate3D<int>(this->wm.nz[this->wm.col[j][i]],
-                                                                            this->wm.ny[this->wm.col[j][i]],
-                                                                            this->wm.nx[this->wm.col[j][i]]),
-                                                          this->wm.val[j][i]);
+          const ProjMatrixElemsForOneBin::value_type elem(Coordinate3D<int>(subset_wm.nz[subset_wm.col[j][i]],
+                                                                            subset_wm.ny[subset_wm.col[j][i]],
+                                                                            subset_wm.nx[subset_wm.col[j][i]]),
+                                                          subset_wm.val[j][i]);
           lor.push_back(elem);
         }
+      // free memory as we go
+      std::vector<float>().swap(val[j]);
+      std::vector<int>().swap(col[j]);
+    }
+
+  if (!this->matrix_cache_directory.empty())
+    this->write_view_to_matrix_cache(view_num, lors);
+  for (const auto& lor : lors)
+    this->cache_proj_matrix_elems_for_one_bin(lor);
+
+  info(format("Total time after transfering to ProjMatrixElemsForOneBin. time {} (s)", timer.value()), 2);
+}
+
+std::string
+ProjMatrixByBinSPECTUB::get_matrix_cache_filename(const int view_num) const
+{
+  std::string filename = this->matrix_cache_directory;
+  FilePath::append_separator(filename);
+  std::stringstream name_stream;
+  name_stream << "SPECTUB_matrix_" << std::hex << std::setw(16) << std::setfill('0')
+              << fnv1a_hash(this->matrix_cache_key) << std::dec << "_view" << view_num
+              << ".bin";
+  return filename + name_stream.str();
+}
+
+/* Format of the matrix cache files (native byte order):
+   - the header line "STIR SPECTUB matrix cache\n"
+   - std::uint64_t length of the key, followed by the key (matrix_cache_key)
+   - char: 1 if weights are quantised, 0 otherwise (has to match quantise_matrix_cache)
+   - std::int32_t number of bins
+   - for every bin: std::int32_t view, axial and tangential position number, std::int32_t number of elements,
+     if quantised: float scale (the maximum weight of the bin / 65535),
+     for every element: 3 std::int16_t (z,y,x) and the weight as float or std::uint16_t (weight/scale)
+*/
+static const char* const matrix_cache_header = "STIR SPECTUB matrix cache\n";
+
+bool
+ProjMatrixByBinSPECTUB::read_view_from_matrix_cache(const int view_num) const
+{
+  const std::string filename = this->get_matrix_cache_filename(view_num);
+  std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!file)
+    return false;
+
+  const std::string header(matrix_cache_header);
+  std::string file_header(header.size(), ' ');
+  file.read(&file_header[0], header.size());
+  std::uint64_t key_length = 0;
+  file.read(reinterpret_cast<char*>(&key_length), sizeof(key_length));
+  if (!file || file_header != header || key_length != this->matrix_cache_key.size())
+    {
+      warning(format("SPECTUB matrix cache file {} has a different format or parameters. It will be recomputed.", filename));
+      return false;
+    }
+  std::string key(key_length, ' ');
+  file.read(&key[0], key_length);
+  char quantised = 0;
+  std::int32_t num_bins = 0;
+  file.read(&quantised, 1);
+  file.read(reinterpret_cast<char*>(&num_bins), sizeof(num_bins));
+  if (!file || key != this->matrix_cache_key || (quantised != 0) != this->quantise_matrix_cache || num_bins != this->wm.NbOS)
+    {
+      warning(format("SPECTUB matrix cache file {} has a different format or parameters. It will be recomputed.", filename));
+      return false;
+    }
 
-      delete[] this->wm.val[j];
-      delete[] this->wm.col[j];
+  std::vector<ProjMatrixElemsForOneBin> lors(num_bins);
+  std::vector<std::int16_t> coords;
+  std::vector<float> values;
+  std::vector<std::uint16_t> quantised_values;
+  for (auto& lor : lors)
+    {
+      std::int32_t bin_info[4];
+      file.read(reinterpret_cast<char*>(bin_info), sizeof(bin_info));
+      float scale = 0.F;
+      if (quantised)
+        file.read(reinterpret_cast<char*>(&scale), sizeof(scale));
+      const std::int32_t num_elems = bin_info[3];
+      if (!file || num_elems < 0)
+        {
+          warning(format("Error reading SPECTUB matrix cache file {}. It will be recomputed.", filename));
+          return false;
+        }
+      coords.resize(3 * static_cast<std::size_t>(num_elems));
+      file.read(reinterpret_cast<char*>(coords.data()), coords.size() * sizeof(std::int16_t));
+      if (quantised)
+        {
+          quantised_values.resize(num_elems);
+          file.read(reinterpret_cast<char*>(quantised_values.data()), quantised_values.size() * sizeof(std::uint16_t));
+        }
+      else
+        {
+          values.resize(num_elems);
+          file.read(reinterpret_cast<char*>(values.data()), values.size() * sizeof(float));
+        }
+      if (!file)
+        {
+          warning(format("Error reading SPECTUB matrix cache file {}. It will be recomputed.", filename));
+          return false;
+        }
 
-      this->cache_proj_matrix_elems_for_one_bin(lor);
+      Bin bin(0, bin_info[0], bin_info[1], bin_info[2], 0.F);
+      lor.set_bin(bin);
+      lor.reserve(num_elems);
+      for (std::int32_t i = 0; i < num_elems; ++i)
+        {
+          const float value = quantised ? dequantise_weight(quantised_values[i], scale) : values[i];
+          lor.push_back(ProjMatrixElemsForOneBin::value_type(
+              Coordinate3D<int>(coords[3 * i], coords[3 * i + 1], coords[3 * i + 2]), value));
+        }
     }
 
-  info(format("Total time after transfering to ProjMatrixElemsForOneBin. time {} (s)", timer.value()), 2);
+  for (const auto& lor : lors)
+    this->cache_proj_matrix_elems_for_one_bin(lor);
+  info(format("Read matrix elements for view {} from {}", view_num, filename), 2);
+  return true;
+}
+
+void
+ProjMatrixByBinSPECTUB::write_view_to_matrix_cache(const int view_num, const std::vector<ProjMatrixElemsForOneBin>& lors) const
+{
+  const std::string filename = this->get_matrix_cache_filename(view_num);
+  // write to a temporary file first, such that other processes never read a partially written file
+  const std::string tmp_filename = filename + ".tmp";
+  {
+    std::ofstream file(tmp_filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file)
+      {
+        warning(format("Could not open SPECTUB matrix cache file {} for writing", tmp_filename));
+        return;
+      }
+    const std::uint64_t key_length = this->matrix_cache_key.size();
+    const char quantised = this->quantise_matrix_cache ? 1 : 0;
+    const std::int32_t num_bins = static_cast<std::int32_t>(lors.size());
+    file.write(matrix_cache_header, std::string(matrix_cache_header).size());
+    file.write(reinterpret_cast<const char*>(&key_length), sizeof(key_length));
+    file.write(this->matrix_cache_key.data(), key_length);
+    file.write(&quantised, 1);
+    file.write(reinterpret_cast<const char*>(&num_bins), sizeof(num_bins));
+
+    std::vector<std::int16_t> coords;
+    std::vector<float> values;
+    std::vector<std::uint16_t> quantised_values;
+    for (const auto& lor : lors)
+      {
+        const Bin bin = lor.get_bin();
+        const std::int32_t num_elems = static_cast<std::int32_t>(lor.end() - lor.begin());
+        const std::int32_t bin_info[4] = { bin.view_num(), bin.axial_pos_num(), bin.tangential_pos_num(), num_elems };
+        file.write(reinterpret_cast<const char*>(bin_info), sizeof(bin_info));
+        coords.clear();
+        values.clear();
+        quantised_values.clear();
+        float max_weight = 0.F;
+        for (const auto& elem : lor)
+          max_weight = std::max(max_weight, elem.get_value());
+        const float scale = max_weight / 65535.F;
+        for (const auto& elem : lor)
+          {
+            coords.push_back(static_cast<std::int16_t>(elem.coord1()));
+            coords.push_back(static_cast<std::int16_t>(elem.coord2()));
+            coords.push_back(static_cast<std::int16_t>(elem.coord3()));
+            if (quantised)
+              quantised_values.push_back(quantise_weight(elem.get_value(), scale));
+            else
+              values.push_back(elem.get_value());
+          }
+        if (quantised)
+          file.write(reinterpret_cast<const char*>(&scale), sizeof(scale));
+        file.write(reinterpret_cast<const char*>(coords.data()), coords.size() * sizeof(std::int16_t));
+        if (quantised)
+          file.write(reinterpret_cast<const char*>(quantised_values.data()), quantised_values.size() * sizeof(std::uint16_t));
+        else
+          file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(float));
+      }
+    if (!file)
+      {
+        warning(format("Error writing SPECTUB matrix cache file {}", tmp_filename));
+        file.close();
+        std::remove(tmp_filename.c_str());
+        return;
+      }
+  }
+  std::remove(filename.c_str());
+  if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0)
+    warning(format("Could not rename SPECTUB matrix cache file {} to {}", tmp_filename, filename));
 }
+
 void
 ProjMatrixByBinSPECTUB::calculate_proj_matrix_elems_for_one_bin(ProjMatrixElemsForOneBin& lor) const
 {
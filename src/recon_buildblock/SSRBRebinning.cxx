@@ -0,0 +1,93 @@
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup recon_buildblock
+  \brief Implementation of class stir::SSRBRebinning
+
+  \author STIR contributors
+*/
+
+#include "stir/recon_buildblock/SSRBRebinning.h"
+#include "stir/SSRB.h"
+#include "stir/Succeeded.h"
+#include "stir/warning.h"
+
+START_NAMESPACE_STIR
+
+const char* const SSRBRebinning::registered_name = "SSRB";
+
+SSRBRebinning::SSRBRebinning()
+{
+  set_defaults();
+}
+
+void
+SSRBRebinning::set_defaults()
+{
+  base_type::set_defaults();
+  num_segments_to_combine = -1;
+  num_views_to_combine = 1;
+  num_tang_poss_to_trim = 0;
+  num_tof_bins_to_combine = 1;
+  do_normalisation = true;
+}
+
+void
+SSRBRebinning::initialise_keymap()
+{
+  base_type::initialise_keymap();
+  parser.add_start_key("SSRB Parameters");
+  parser.add_stop_key("End SSRB Parameters");
+  parser.add_key("number of segments to combine", &num_segments_to_combine);
+  parser.add_key("number of views to combine", &num_views_to_combine);
+  parser.add_key("number of tangential positions to trim", &num_tang_poss_to_trim);
+  parser.add_key("number of TOF bins to combine", &num_tof_bins_to_combine);
+  parser.add_key("do normalisation", &do_normalisation);
+}
+
+bool
+SSRBRebinning::post_processing()
+{
+  if (base_type::post_processing() == true)
+    return true;
+  if (num_segments_to_combine != -1 && (num_segments_to_combine <= 0 || num_segments_to_combine % 2 == 0))
+    {
+      warning("SSRB: 'number of segments to combine' has to be -1 or a positive odd number");
+      return true;
+    }
+  if (num_views_to_combine <= 0 || num_tof_bins_to_combine <= 0)
+    {
+      warning("SSRB: number of views or TOF bins to combine has to be positive");
+      return true;
+    }
+  return false;
+}
+
+Succeeded
+SSRBRebinning::rebin()
+{
+  if (this->set_up() != Succeeded::yes)
+    return Succeeded::no;
+  start_timers();
+  const int segments_to_combine
+      = num_segments_to_combine == -1 ? 2 * this->max_segment_num_to_process + 1 : num_segments_to_combine;
+  SSRB(output_filename_prefix,
+       *proj_data_sptr,
+       segments_to_combine,
+       num_views_to_combine,
+       num_tang_poss_to_trim,
+       do_normalisation,
+       this->max_segment_num_to_process,
+       num_tof_bins_to_combine);
+  stop_timers();
+  return Succeeded::yes;
+}
+
+END_NAMESPACE_STIR
@@ -71,6 +71,9 @@
 #  include <omp.h>
 #endif
 #include "stir/num_threads.h"
+#include "stir/buffer_pool.h"
+#include "stir/ProfilingRegistry.h"
+#include "stir/TimedBlock.h"
 
 START_NAMESPACE_STIR
 
@@ -173,8 +176,14 @@ get_viewgrams(shared_ptr<RelatedViewgrams<float>>& y,
               const ViewSegmentNumbers& view_segment_num,
               const int timing_pos_num)
 {
+  static ProfilingScope additive_reads_scope("additive reads");
+  static ProfilingScope io_scope("I/O");
+  static ProfilingScope normalisation_scope("normalisation");
+  static ProfilingCounter bins_counter("bins processed");
+
   if (!is_null_ptr(binwise_correction))
     {
+      TimedBlock<ProfilingScope> timed_block(additive_reads_scope);
 #ifdef STIR_OPENMP
 #  pragma omp critical(ADDSINO)
 #endif
@@ -184,6 +193,7 @@ get_viewgrams(shared_ptr<RelatedViewgrams<float>>& y,
 
   if (read_from_proj_dat)
     {
+      TimedBlock<ProfilingScope> timed_block(io_scope);
 #ifdef STIR_OPENMP
 #  pragma omp critical(VIEW)
 #endif
@@ -195,6 +205,7 @@ get_viewgrams(shared_ptr<RelatedViewgrams<float>>& y,
       y.reset(new RelatedViewgrams<float>(
           proj_dat_ptr->get_empty_related_viewgrams(view_segment_num, symmetries_ptr, false, timing_pos_num)));
     }
+  bins_counter.add(static_cast<long long>(y->get_num_viewgrams()) * y->get_num_axial_poss() * y->get_num_tangential_poss());
 
   // multiplicative correction
   if (!is_null_ptr(normalisation_sptr) && !normalisation_sptr->is_trivial())
@@ -202,6 +213,7 @@ get_viewgrams(shared_ptr<RelatedViewgrams<float>>& y,
       mult_viewgrams_sptr.reset(new RelatedViewgrams<float>(
           proj_dat_ptr->get_empty_related_viewgrams(view_segment_num, symmetries_ptr, false, timing_pos_num)));
       mult_viewgrams_sptr->fill(1.F);
+      TimedBlock<ProfilingScope> timed_block(normalisation_scope);
 #ifdef STIR_OPENMP
 #  pragma omp critical(MULT)
 #endif
@@ -523,7 +535,9 @@ distributable_computation(const shared_ptr<ForwardProjectorByBin>& forward_proje
 #endif      // MPI
           } // end of for-loop
       }     // end of for-loop over timing_pos_num
-  }         // end of parallel section of openmp
+    // the threads might be idle for a while, so don't let them keep their buffers
+    release_buffer_pool_memory();
+  } // end of parallel section of openmp
 
 #ifdef STIR_OPENMP
   // "reduce" data constructed by threads
@@ -597,6 +611,7 @@ distributable_computation(const shared_ptr<ForwardProjectorByBin>& forward_proje
   wall_clock_timer.stop();
   info(format(
       "Computation times for distributable_computation, CPU {}s, wall-clock {}s", CPU_timer.value(), wall_clock_timer.value()));
+  report_memory_statistics("distributable_computation");
 }
 
 END_NAMESPACE_STIR
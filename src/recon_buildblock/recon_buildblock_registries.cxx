@@ -70,6 +70,7 @@
 #endif
 
 #include "stir/recon_buildblock/FourierRebinning.h"
+#include "stir/recon_buildblock/SSRBRebinning.h"
 
 #ifdef STIR_WITH_NiftyPET_PROJECTOR
 #  include "stir/recon_buildblock/NiftyPET_projector/ForwardProjectorByBinNiftyPET.h"
@@ -170,5 +171,6 @@ static GE::RDF_HDF5::BinNormalisationFromGEHDF5::RegisterIt dummy104;
 #endif
 
 static FourierRebinning::RegisterIt dummyFORE;
+static SSRBRebinning::RegisterIt dummySSRB;
 
 END_NAMESPACE_STIR
@@ -50,6 +50,7 @@
 #include <boost/random/normal_distribution.hpp>
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/random/variate_generator.hpp>
+#include <filesystem>
 #include <iostream>
 #include <memory>
 
@@ -57,6 +58,22 @@
 #include "stir/recon_buildblock/distributable_main.h"
 START_NAMESPACE_STIR
 
+//! projector pair that counts the number of calls to set_up()
+class ProjectorByBinPairCountingSetUp : public ProjectorByBinPairUsingProjMatrixByBin
+{
+public:
+  using ProjectorByBinPairUsingProjMatrixByBin::ProjectorByBinPairUsingProjMatrixByBin;
+
+  Succeeded set_up(const shared_ptr<const ProjDataInfo>& proj_data_info_sptr,
+                   const shared_ptr<const DiscretisedDensity<3, float>>& density_info_sptr) override
+  {
+    ++num_set_ups;
+    return ProjectorByBinPairUsingProjMatrixByBin::set_up(proj_data_info_sptr, density_info_sptr);
+  }
+
+  int num_set_ups = 0;
+};
+
 /*!
   \ingroup test
   \brief Test class for PoissonLogLikelihoodWithLinearModelForMeanAndProjData
@@ -111,6 +128,13 @@ protected:
 
   //! Test the approximate Hessian of the objective function by testing the (x^T Hx > 0) condition
   void test_approximate_Hessian_concavity(objective_function_type& objective_function, target_type& target);
+
+  //! Test if sensitivities are written to and read from the cache
+  void test_sensitivity_cache(PoissonLogLikelihoodWithLinearModelForMeanAndProjData<target_type>& objective_function,
+                              const shared_ptr<target_type>& density_sptr);
+
+  //! Test calling set_up() for new data, which should not set-up the projectors again and can use sensitivities in memory
+  void test_set_up_for_new_data(const shared_ptr<target_type>& density_sptr);
 };
 
 PoissonLogLikelihoodWithLinearModelForMeanAndProjDataTests::PoissonLogLikelihoodWithLinearModelForMeanAndProjDataTests(
@@ -173,6 +197,118 @@ PoissonLogLikelihoodWithLinearModelForMeanAndProjDataTests::test_approximate_Hes
     }
 }
 
+void
+PoissonLogLikelihoodWithLinearModelForMeanAndProjDataTests::test_sensitivity_cache(
+    PoissonLogLikelihoodWithLinearModelForMeanAndProjData<target_type>& objective_function,
+    const shared_ptr<target_type>& density_sptr)
+{
+  std::cerr << "----- testing sensitivity cache\n";
+  // note: the objective function has been set-up without sensitivity filenames, so will compute them
+  const std::string cache_directory = "test_sensitivity_cache";
+  std::filesystem::remove_all(cache_directory);
+  std::filesystem::create_directory(cache_directory);
+  objective_function.set_sensitivity_cache_directory(cache_directory);
+  if (!check(objective_function.set_up(density_sptr) == Succeeded::yes, "set-up of objective function (writing cache)"))
+    return;
+  shared_ptr<target_type> computed_sptr(objective_function.get_subset_sensitivity(1).clone());
+
+  // modify the files in the cache, such that we can see if they are used
+  for (const auto& entry : std::filesystem::directory_iterator(cache_directory))
+    if (entry.path().extension() == ".hv")
+      {
+        const std::string filename = entry.path().string();
+        std::unique_ptr<target_type> cached_sptr(read_from_file<target_type>(filename));
+        *cached_sptr *= 2.F;
+        write_to_file(filename, *cached_sptr);
+      }
+  shared_ptr<target_type> doubled_sptr(computed_sptr->clone());
+  *doubled_sptr *= 2.F;
+  if (check(objective_function.set_up(density_sptr) == Succeeded::yes, "set-up of objective function (reading cache)"))
+    check_if_equal(*doubled_sptr, objective_function.get_subset_sensitivity(1), "subset sensitivity read from cache");
+
+  // changing the normalisation data (but not the objects) has to result in a cache miss
+  {
+    ProjDataInMemory orig_mult_proj_data(*mult_proj_data_sptr);
+    *mult_proj_data_sptr *= 1.5F;
+    shared_ptr<target_type> expected_sptr(computed_sptr->clone());
+    *expected_sptr /= 1.5F; // the norm data are inverse efficiencies
+    if (check(objective_function.set_up(density_sptr) == Succeeded::yes, "set-up of objective function (modified norm)"))
+      check_if_equal(*expected_sptr, objective_function.get_subset_sensitivity(1), "subset sensitivity with modified norm");
+    mult_proj_data_sptr->fill(orig_mult_proj_data);
+  }
+
+  // explicitly asking to recompute does not use the cache
+  objective_function.set_recompute_sensitivity(true);
+  if (check(objective_function.set_up(density_sptr) == Succeeded::yes, "set-up of objective function (recompute)"))
+    check_if_equal(*computed_sptr, objective_function.get_subset_sensitivity(1), "subset sensitivity after recompute");
+
+  std::filesystem::remove_all(cache_directory);
+  objective_function.set_sensitivity_cache_directory("");
+  check(objective_function.set_up(density_sptr) == Succeeded::yes, "set-up of objective function (without cache)");
+}
+
+void
+PoissonLogLikelihoodWithLinearModelForMeanAndProjDataTests::test_set_up_for_new_data(const shared_ptr<target_type>& density_sptr)
+{
+  std::cerr << "----- testing set-up for new data\n";
+  const int subset_num = 1;
+  auto proj_pair_sptr = std::make_shared<ProjectorByBinPairCountingSetUp>(std::make_shared<ProjMatrixByBinUsingRayTracing>());
+  PoissonLogLikelihoodWithLinearModelForMeanAndProjData<target_type> objective_function;
+  objective_function.set_proj_data_sptr(proj_data_sptr);
+  objective_function.set_use_subset_sensitivities(true);
+  objective_function.set_projector_pair_sptr(proj_pair_sptr);
+  objective_function.set_normalisation_sptr(std::make_shared<BinNormalisationFromProjData>(mult_proj_data_sptr));
+  objective_function.set_additive_proj_data_sptr(add_proj_data_sptr);
+  objective_function.set_num_subsets(4);
+  if (!check(objective_function.set_up(density_sptr) == Succeeded::yes, "set-up of objective function (first data)"))
+    return;
+  check_if_equal(proj_pair_sptr->num_set_ups, 1, "number of set-ups of the projectors (first data)");
+  shared_ptr<target_type> sensitivity_sptr(objective_function.get_subset_sensitivity(subset_num).clone());
+
+  // new data with the same geometry, using the sensitivities in memory
+  shared_ptr<ProjData> new_proj_data_sptr(new ProjDataInMemory(*proj_data_sptr));
+  *new_proj_data_sptr *= 2.F;
+  objective_function.set_proj_data_sptr(new_proj_data_sptr);
+  objective_function.set_recompute_sensitivity(false);
+  if (!check(objective_function.set_up(density_sptr) == Succeeded::yes, "set-up of objective function (new data)"))
+    return;
+  check_if_equal(proj_pair_sptr->num_set_ups, 1, "number of set-ups of the projectors (new data)");
+  check_if_equal(*sensitivity_sptr, objective_function.get_subset_sensitivity(subset_num), "subset sensitivity in memory");
+
+  // the gradient has to be the same as for an objective function that is set-up from scratch
+  {
+    PoissonLogLikelihoodWithLinearModelForMeanAndProjData<target_type> ref_objective_function;
+    ref_objective_function.set_proj_data_sptr(new_proj_data_sptr);
+    ref_objective_function.set_use_subset_sensitivities(true);
+    ref_objective_function.set_projector_pair_sptr(
+        std::make_shared<ProjectorByBinPairUsingProjMatrixByBin>(std::make_shared<ProjMatrixByBinUsingRayTracing>()));
+    ref_objective_function.set_normalisation_sptr(std::make_shared<BinNormalisationFromProjData>(mult_proj_data_sptr));
+    ref_objective_function.set_additive_proj_data_sptr(add_proj_data_sptr);
+    ref_objective_function.set_num_subsets(4);
+    if (!check(ref_objective_function.set_up(density_sptr) == Succeeded::yes, "set-up of reference objective function"))
+      return;
+    shared_ptr<target_type> gradient_sptr(density_sptr->get_empty_copy());
+    shared_ptr<target_type> ref_gradient_sptr(density_sptr->get_empty_copy());
+    objective_function.compute_sub_gradient_without_penalty(*gradient_sptr, *density_sptr, subset_num);
+    ref_objective_function.compute_sub_gradient_without_penalty(*ref_gradient_sptr, *density_sptr, subset_num);
+    check_if_equal(*ref_gradient_sptr, *gradient_sptr, "gradient for new data");
+  }
+
+  // set a different sensitivity
+  shared_ptr<target_type> doubled_sptr(sensitivity_sptr->clone());
+  *doubled_sptr *= 2.F;
+  objective_function.set_subset_sensitivity_sptr(doubled_sptr, subset_num);
+  if (check(objective_function.set_up(density_sptr) == Succeeded::yes, "set-up of objective function (set sensitivity)"))
+    check_if_equal(*doubled_sptr, objective_function.get_subset_sensitivity(subset_num), "subset sensitivity that was set");
+
+  // a new projector pair has to be set-up
+  auto new_proj_pair_sptr
+      = std::make_shared<ProjectorByBinPairCountingSetUp>(std::make_shared<ProjMatrixByBinUsingRayTracing>());
+  objective_function.set_projector_pair_sptr(new_proj_pair_sptr);
+  if (check(objective_function.set_up(density_sptr) == Succeeded::yes, "set-up of objective function (new projectors)"))
+    check_if_equal(new_proj_pair_sptr->num_set_ups, 1, "number of set-ups of the new projectors");
+}
+
 void
 PoissonLogLikelihoodWithLinearModelForMeanAndProjDataTests::construct_input_data(shared_ptr<target_type>& density_sptr,
                                                                                  const bool TOF_or_not)
@@ -344,6 +480,8 @@ PoissonLogLikelihoodWithLinearModelForMeanAndProjDataTests::run_tests()
   {
     shared_ptr<target_type> density_sptr;
     construct_input_data(density_sptr, /*TOF_or_not=*/false);
+    this->test_sensitivity_cache(*this->objective_function_sptr, density_sptr);
+    this->test_set_up_for_new_data(density_sptr);
     this->run_tests_for_objective_function(*this->objective_function_sptr, *density_sptr);
   }
   if (this->proj_data_filename == 0)
@@ -38,6 +38,7 @@
 #include "stir/IO/write_to_file.h"
 #include "stir/IO/read_from_file.h"
 #include "stir/ArrayFunction.h"
+#include "stir/apply_elementwise.h"
 #include "stir/NumericInfo.h"
 #include "stir/SegmentByView.h"
 #include "stir/VoxelsOnCartesianGrid.h"
@@ -724,10 +725,9 @@ ScatterEstimation::set_up_iterative(shared_ptr<IterativeReconstruction<Discretis
             // Crucial: Avoid divisions by zero!!
             // This should be resolved after https://github.com/UCL/STIR/issues/348
             pow_times_add min_threshold(0.0f, 1.0f, 1.0f, 1E-20f, NumericInfo<float>().max_value());
-            apply_to_proj_data(*norm_projdata_2d_sptr, min_threshold);
-
             pow_times_add invert(0.0f, 1.0f, -1.0f, NumericInfo<float>().min_value(), NumericInfo<float>().max_value());
-            apply_to_proj_data(*norm_projdata_2d_sptr, invert);
+            apply_elementwise(
+                *norm_projdata_2d_sptr, [&](const float v) { return invert(min_threshold(v)); }, *norm_projdata_2d_sptr);
 
             norm_coeff_2d_sptr.reset(new BinNormalisationFromProjData(norm_projdata_2d_sptr));
           }
@@ -813,8 +813,8 @@ ScatterEstimation::set_up_iterative(shared_ptr<IterativeReconstruction<Discretis
                                  this->input_projdata_2d_sptr->get_exam_info_sptr(),
                                  this->input_projdata_2d_sptr->get_proj_data_info_sptr()->create_shared_clone());
 
-      data_to_fit_projdata_sptr->fill(*this->input_projdata_2d_sptr);
-      subtract_proj_data(*data_to_fit_projdata_sptr, *this->back_projdata_2d_sptr);
+      apply_elementwise(
+          *data_to_fit_projdata_sptr, std::minus<float>(), *this->input_projdata_2d_sptr, *this->back_projdata_2d_sptr);
     }
   else
     {
@@ -833,8 +833,7 @@ ScatterEstimation::set_up_iterative(shared_ptr<IterativeReconstruction<Discretis
           = create_new_proj_data(out_filename,
                                  this->input_projdata_sptr->get_exam_info_sptr(),
                                  this->input_projdata_sptr->get_proj_data_info_sptr()->create_shared_clone());
-      data_to_fit_projdata_sptr->fill(*input_projdata_sptr);
-      subtract_proj_data(*data_to_fit_projdata_sptr, *this->back_projdata_sptr);
+      apply_elementwise(*data_to_fit_projdata_sptr, std::minus<float>(), *input_projdata_sptr, *this->back_projdata_sptr);
     }
 
   return Succeeded::yes;
@@ -1012,14 +1011,15 @@ ScatterEstimation::process_data()
 
               shared_ptr<ProjData> temp_projdata(new ProjDataInMemory(scaled_est_projdata_sptr->get_exam_info_sptr(),
                                                                       scaled_est_projdata_sptr->get_proj_data_info_sptr()));
-              temp_projdata->fill(*scaled_est_projdata_sptr);
               pow_times_add min_threshold(0.0f, 1.0f, 1.0f, 1e-9f, NumericInfo<float>().max_value());
               pow_times_add add_scalar(-1e-9f, 1.0f, 1.0f, NumericInfo<float>().min_value(), NumericInfo<float>().max_value());
-              apply_to_proj_data(*temp_projdata, min_threshold);
-              apply_to_proj_data(*temp_projdata, add_scalar);
               // threshold back to 0 to avoid getting tiny negatives (due to numerical precision errors)
               pow_times_add min_threshold_zero(0.0f, 1.0f, 1.0f, 0.f, NumericInfo<float>().max_value());
-              apply_to_proj_data(*temp_projdata, min_threshold_zero);
+              // do all of this in a single pass over the data
+              apply_elementwise(
+                  *temp_projdata,
+                  [&](const float v) { return min_threshold_zero(add_scalar(min_threshold(v))); },
+                  *scaled_est_projdata_sptr);
 
               // ok, we can multiply with the norm
               normalisation_factors_sptr->apply(*temp_projdata);
@@ -1077,11 +1077,10 @@ ScatterEstimation::process_data()
                                         output_additive_filename,
                                         std::ios::in | std::ios::out | std::ios::trunc));
 
-              temp_additive_projdata->fill(*scatter_estimate_sptr);
               if (!is_null_ptr(this->back_projdata_sptr))
-                {
-                  add_proj_data(*temp_additive_projdata, *this->back_projdata_sptr);
-                }
+                apply_elementwise(*temp_additive_projdata, std::plus<float>(), *scatter_estimate_sptr, *this->back_projdata_sptr);
+              else
+                temp_additive_projdata->fill(*scatter_estimate_sptr);
 
               this->multiplicative_binnorm_sptr->apply(*temp_additive_projdata);
             }
@@ -1092,12 +1091,11 @@ ScatterEstimation::process_data()
       // Then normalise
       if (run_in_2d_projdata)
         {
-          this->add_projdata_2d_sptr->fill(*scaled_est_projdata_sptr);
-
           if (!is_null_ptr(this->back_projdata_2d_sptr))
-            {
-              add_proj_data(*this->add_projdata_2d_sptr, *this->back_projdata_2d_sptr);
-            }
+            apply_elementwise(
+                *this->add_projdata_2d_sptr, std::plus<float>(), *scaled_est_projdata_sptr, *this->back_projdata_2d_sptr);
+          else
+            this->add_projdata_2d_sptr->fill(*scaled_est_projdata_sptr);
           this->multiplicative_binnorm_2d_sptr->apply(*this->add_projdata_2d_sptr);
         }
       else
@@ -1171,41 +1169,13 @@ ScatterEstimation::reconstruct_analytic(int _current_iter_num)
 void
 ScatterEstimation::add_proj_data(ProjData& first_addend, const ProjData& second_addend)
 {
-  assert(first_addend.get_min_segment_num() == second_addend.get_min_segment_num());
-  assert(first_addend.get_max_segment_num() == second_addend.get_max_segment_num());
-  for (int segment_num = first_addend.get_min_segment_num(); segment_num <= first_addend.get_max_segment_num(); ++segment_num)
-    {
-      SegmentByView<float> first_segment_by_view = first_addend.get_segment_by_view(segment_num);
-
-      SegmentByView<float> sec_segment_by_view = second_addend.get_segment_by_view(segment_num);
-
-      first_segment_by_view += sec_segment_by_view;
-
-      if (!(first_addend.set_segment(first_segment_by_view) == Succeeded::yes))
-        {
-          error("Error set_segment %d", segment_num);
-        }
-    }
+  apply_elementwise(first_addend, std::plus<float>(), first_addend, second_addend);
 }
 
 void
 ScatterEstimation::subtract_proj_data(ProjData& minuend, const ProjData& subtracted)
 {
-  assert(minuend.get_min_segment_num() == subtracted.get_min_segment_num());
-  assert(minuend.get_max_segment_num() == subtracted.get_max_segment_num());
-  for (int segment_num = minuend.get_min_segment_num(); segment_num <= minuend.get_max_segment_num(); ++segment_num)
-    {
-      SegmentByView<float> first_segment_by_view = minuend.get_segment_by_view(segment_num);
-
-      SegmentByView<float> sec_segment_by_view = subtracted.get_segment_by_view(segment_num);
-
-      first_segment_by_view -= sec_segment_by_view;
-
-      if (!(minuend.set_segment(first_segment_by_view) == Succeeded::yes))
-        {
-          error("ScatterEstimation: Error set_segment %d", segment_num);
-        }
-    }
+  apply_elementwise(minuend, std::minus<float>(), minuend, subtracted);
 
   // Filter negative values:
   //    pow_times_add zero_threshold (0.0f, 1.0f, 1.0f, 0.0f, NumericInfo<float>().max_value());
@@ -1215,17 +1185,7 @@ ScatterEstimation::subtract_proj_data(ProjData& minuend, const ProjData& subtrac
 void
 ScatterEstimation::apply_to_proj_data(ProjData& data, const pow_times_add& func)
 {
-  for (int segment_num = data.get_min_segment_num(); segment_num <= data.get_max_segment_num(); ++segment_num)
-    {
-      SegmentByView<float> segment_by_view = data.get_segment_by_view(segment_num);
-
-      in_place_apply_function(segment_by_view, func);
-
-      if (!(data.set_segment(segment_by_view) == Succeeded::yes))
-        {
-          error("ScatterEstimation: Error set_segment %d", segment_num);
-        }
-    }
+  apply_elementwise(data, func, data);
 }
 
 Succeeded
@@ -22,9 +22,20 @@
 #include "stir/modelling/ModelMatrix.h"
 #include "stir/modelling/PlasmaData.h"
 #include "stir/modelling/ParametricDiscretisedDensity.h"
+#include "stir/DynamicDiscretisedDensity.h"
+#include "stir/VoxelMajorDynamicDensity.h"
+#include "stir/VoxelsOnCartesianGrid.h"
+#include "stir/IndexRange3D.h"
+#include "stir/Scanner.h"
 #include "stir/TimeFrameDefinitions.h"
+#include "stir/linear_regression.h"
+#include "stir/IO/OutputFileFormat.h"
+#include "stir/IO/read_from_file.h"
+#include "stir/Succeeded.h"
 #include "stir/utilities.h"
 #include <boost/shared_array.hpp>
+#include <cstdlib>
+#include <algorithm>
 
 START_NAMESPACE_STIR
 
@@ -231,6 +242,158 @@ modellingTests::run_tests()
                        stir_model_array[2][frame_num],
                        "Check _model_array-2nd column in ModelMatrix");
       }
+
+    std::cerr << "\nTesting the Patlak image operations..." << std::endl;
+    // avoid rescaling the model matrix according to the voxel size
+    patlak_plot._in_correct_scale = true;
+    const CartesianCoordinate3D<float> origin(0.F, 0.F, 0.F);
+    const CartesianCoordinate3D<float> grid_spacing(2.F, 3.F, 3.F);
+    const shared_ptr<VoxelsOnCartesianGrid<float>> image_sptr(
+        new VoxelsOnCartesianGrid<float>(IndexRange3D(0, 4, -3, 4, -6, 5), origin, grid_spacing));
+    DynamicDiscretisedDensity dyn_image(time_frame_def, 0., shared_ptr<Scanner>(new Scanner(Scanner::E966)), image_sptr);
+    ParametricVoxelsOnCartesianGrid par_image(dyn_image);
+    for (int k = 0; k <= 4; ++k)
+      for (int j = -3; j <= 4; ++j)
+        for (int i = -6; i <= 5; ++i)
+          {
+            par_image[k][j][i][1] = .01F * (1 + k + std::abs(i - j));
+            par_image[k][j][i][2] = .5F + .1F * (k + j + 3);
+          }
+    patlak_plot.get_dynamic_image_from_parametric_image(dyn_image, par_image);
+    for (unsigned int frame_num = 1; frame_num <= time_frame_def.get_num_frames(); ++frame_num)
+      for (int k = 0; k <= 4; ++k)
+        for (int j = -3; j <= 4; ++j)
+          for (int i = -6; i <= 5; ++i)
+            {
+              const float expected = frame_num < starting_frame ? 0.F
+                                                                : par_image[k][j][i][1] * stir_model_array[1][frame_num]
+                                                                      + par_image[k][j][i][2] * stir_model_array[2][frame_num];
+              check_if_equal(dyn_image[frame_num][k][j][i], expected, "Check get_dynamic_image_from_parametric_image");
+            }
+
+    // add some deterministic "noise" such that the fit is not exact, and compare with a voxel-by-voxel regression
+    for (unsigned int frame_num = starting_frame; frame_num <= time_frame_def.get_num_frames(); ++frame_num)
+      for (int k = 0; k <= 4; ++k)
+        for (int j = -3; j <= 4; ++j)
+          for (int i = -6; i <= 5; ++i)
+            dyn_image[frame_num][k][j][i] *= 1.F + .01F * ((i + 2 * j + 3 * k + static_cast<int>(frame_num) + 20) % 5 - 2);
+    ParametricVoxelsOnCartesianGrid fitted_par_image(dyn_image);
+    patlak_plot.apply_linear_regression(fitted_par_image, dyn_image);
+    ParametricVoxelsOnCartesianGrid gradient_image(dyn_image);
+    patlak_plot.multiply_dynamic_image_with_model_gradient(gradient_image, dyn_image);
+    const unsigned int num_frames = time_frame_def.get_num_frames();
+    VectorWithOffset<float> patlak_x(starting_frame, num_frames);
+    VectorWithOffset<float> patlak_y(starting_frame, num_frames);
+    VectorWithOffset<float> weights(starting_frame, num_frames);
+    for (unsigned int frame_num = starting_frame; frame_num <= num_frames; ++frame_num)
+      {
+        patlak_x[frame_num] = stir_model_array[1][frame_num] / stir_model_array[2][frame_num];
+        weights[frame_num] = 1.F;
+      }
+    for (int k = 0; k <= 4; ++k)
+      for (int j = -3; j <= 4; ++j)
+        for (int i = -6; i <= 5; ++i)
+          {
+            for (unsigned int frame_num = starting_frame; frame_num <= num_frames; ++frame_num)
+              patlak_y[frame_num] = dyn_image[frame_num][k][j][i] / stir_model_array[2][frame_num];
+            float slope, y_intersection, variance_of_slope, variance_of_y_intersection, covariance, chi_square;
+            linear_regression(y_intersection,
+                              slope,
+                              chi_square,
+                              variance_of_y_intersection,
+                              variance_of_slope,
+                              covariance,
+                              patlak_y,
+                              patlak_x,
+                              weights);
+            check_if_equal(fitted_par_image[k][j][i][1], slope, "Check Ki from apply_linear_regression");
+            check_if_equal(fitted_par_image[k][j][i][2], y_intersection, "Check Vb from apply_linear_regression");
+            for (int param_num = 1; param_num <= 2; ++param_num)
+              {
+                float expected = 0.F;
+                for (unsigned int frame_num = starting_frame; frame_num <= num_frames; ++frame_num)
+                  expected += stir_model_array[param_num][frame_num] * dyn_image[frame_num][k][j][i];
+                check_if_equal(gradient_image[k][j][i][param_num], expected, "Check multiply_dynamic_image_with_model_gradient");
+              }
+          }
+
+    std::cerr << "\nTesting VoxelMajorDynamicDensity and the corresponding Patlak image operations..." << std::endl;
+    VoxelMajorDynamicDensity vm_dyn_image(dyn_image);
+    check_if_equal(vm_dyn_image.get_num_time_frames(), num_frames, "Check number of frames of VoxelMajorDynamicDensity");
+    check(vm_dyn_image.get_index_range() == image_sptr->get_index_range(), "Check index range of VoxelMajorDynamicDensity");
+    {
+      const unique_ptr<DynamicDiscretisedDensity> converted_dyn_image_uptr(vm_dyn_image.construct_dynamic_discretised_density());
+      for (unsigned int frame_num = 1; frame_num <= num_frames; ++frame_num)
+        {
+          check_if_equal(vm_dyn_image.construct_single_density(frame_num),
+                         dynamic_cast<const VoxelsOnCartesianGrid<float>&>(dyn_image[frame_num]),
+                         "Check construct_single_density of VoxelMajorDynamicDensity");
+          check_if_equal((*converted_dyn_image_uptr)[frame_num],
+                         dyn_image[frame_num],
+                         "Check conversion from VoxelMajorDynamicDensity to DynamicDiscretisedDensity");
+          for (int k = 0; k <= 4; ++k)
+            for (int j = -3; j <= 4; ++j)
+              for (int i = -6; i <= 5; ++i)
+                check_if_equal(vm_dyn_image[k][j][i][frame_num],
+                               dyn_image[frame_num][k][j][i],
+                               "Check conversion from DynamicDiscretisedDensity to VoxelMajorDynamicDensity");
+        }
+    }
+    {
+      // Interfile round-trip (written and read one time frame at a time)
+      std::string filename("STIRtmp_voxel_major_dyn_image.hv");
+      check(OutputFileFormat<VoxelMajorDynamicDensity>::default_sptr()->write_to_file(filename, vm_dyn_image) == Succeeded::yes,
+            "Check writing of VoxelMajorDynamicDensity");
+      const unique_ptr<VoxelMajorDynamicDensity> read_vm_dyn_image_uptr(read_from_file<VoxelMajorDynamicDensity>(filename));
+      check_if_equal(read_vm_dyn_image_uptr->get_num_time_frames(), num_frames, "Check number of frames of read image");
+      for (unsigned int frame_num = 1; frame_num <= num_frames; ++frame_num)
+        {
+          check_if_equal(read_vm_dyn_image_uptr->get_time_frame_definitions().get_start_time(frame_num),
+                         time_frame_def.get_start_time(frame_num),
+                         "Check start time of frames of read VoxelMajorDynamicDensity");
+          // Interfile does not store the index range, so we only compare the values
+          const VoxelsOnCartesianGrid<float> read_frame = read_vm_dyn_image_uptr->construct_single_density(frame_num);
+          const VoxelsOnCartesianGrid<float> frame = vm_dyn_image.construct_single_density(frame_num);
+          check_if_equal(read_frame.size_all(), frame.size_all(), "Check size of read VoxelMajorDynamicDensity");
+          check(std::equal(frame.begin_all(), frame.end_all(), read_frame.begin_all()),
+                "Check data of read VoxelMajorDynamicDensity");
+        }
+      remove(filename.c_str());
+      replace_extension(filename, ".v");
+      remove(filename.c_str());
+      replace_extension(filename, ".ahv");
+      remove(filename.c_str());
+    }
+    ParametricVoxelsOnCartesianGrid vm_fitted_par_image(vm_dyn_image);
+    patlak_plot.apply_linear_regression(vm_fitted_par_image, vm_dyn_image);
+    ParametricVoxelsOnCartesianGrid vm_gradient_image(vm_dyn_image);
+    patlak_plot.multiply_dynamic_image_with_model_gradient(vm_gradient_image, vm_dyn_image);
+    // compare element-wise, as the summation order can be different
+    for (int k = 0; k <= 4; ++k)
+      for (int j = -3; j <= 4; ++j)
+        for (int i = -6; i <= 5; ++i)
+          for (int param_num = 1; param_num <= 2; ++param_num)
+            {
+              check_if_equal(vm_fitted_par_image[k][j][i][param_num],
+                             fitted_par_image[k][j][i][param_num],
+                             "Check apply_linear_regression for VoxelMajorDynamicDensity");
+              check_if_equal(vm_gradient_image[k][j][i][param_num],
+                             gradient_image[k][j][i][param_num],
+                             "Check multiply_dynamic_image_with_model_gradient for VoxelMajorDynamicDensity");
+            }
+    patlak_plot.get_dynamic_image_from_parametric_image(vm_dyn_image, par_image);
+    for (int k = 0; k <= 4; ++k)
+      for (int j = -3; j <= 4; ++j)
+        for (int i = -6; i <= 5; ++i)
+          for (unsigned int frame_num = 1; frame_num <= num_frames; ++frame_num)
+            {
+              const float expected = frame_num < starting_frame ? 0.F
+                                                                : par_image[k][j][i][1] * stir_model_array[1][frame_num]
+                                                                      + par_image[k][j][i][2] * stir_model_array[2][frame_num];
+              check_if_equal(vm_dyn_image[k][j][i][frame_num],
+                             expected,
+                             "Check get_dynamic_image_from_parametric_image for VoxelMajorDynamicDensity");
+            }
   }
 }
 
@@ -0,0 +1,116 @@
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup numerics_test
+  \brief tests the counter-based random number generator stir::Philox4x32 and stir::CounterBasedRandomNumbers
+
+  \author STIR contributors
+*/
+
+#include "stir/RunTests.h"
+#include "stir/numerics/Philox4x32.h"
+#include <iostream>
+
+START_NAMESPACE_STIR
+
+/*!
+  \ingroup numerics_test
+  \brief A simple class to test Philox4x32 and CounterBasedRandomNumbers
+*/
+class Philox4x32Tests : public RunTests
+{
+public:
+  void run_tests() override;
+
+private:
+  void test_known_values(const Philox4x32::counter_type& counter,
+                         const Philox4x32::key_type& key,
+                         const Philox4x32::counter_type& expected);
+};
+
+void
+Philox4x32Tests::test_known_values(const Philox4x32::counter_type& counter,
+                                   const Philox4x32::key_type& key,
+                                   const Philox4x32::counter_type& expected)
+{
+  const Philox4x32::counter_type result = Philox4x32::generate(counter, key);
+  for (int i = 0; i < 4; ++i)
+    check_if_equal(result[i], expected[i], "Philox4x32 known answer test");
+}
+
+void
+Philox4x32Tests::run_tests()
+{
+  std::cerr << "Testing Philox4x32\n";
+
+  // known answers from the Random123 library
+  test_known_values({ 0U, 0U, 0U, 0U }, { 0U, 0U }, { 0x6627e8d5U, 0xe169c58dU, 0xbc57ac4cU, 0x9b00dbd8U });
+  test_known_values({ 0xffffffffU, 0xffffffffU, 0xffffffffU, 0xffffffffU },
+                    { 0xffffffffU, 0xffffffffU },
+                    { 0x408f276dU, 0x41c83b0eU, 0xa20bc7c6U, 0x6d5451fdU });
+  test_known_values({ 0x243f6a88U, 0x85a308d3U, 0x13198a2eU, 0x03707344U },
+                    { 0xa4093822U, 0x299f31d0U },
+                    { 0xd16cfe09U, 0x94fdccebU, 0x5001e420U, 0x24126ea1U });
+
+  std::cerr << "Testing CounterBasedRandomNumbers\n";
+  {
+    CounterBasedRandomNumbers random_numbers(42U, 7U);
+    CounterBasedRandomNumbers same_random_numbers(42U, 7U);
+    CounterBasedRandomNumbers other_random_numbers(42U, 8U);
+    bool all_same = true;
+    bool all_different = true;
+    for (int i = 0; i < 10; ++i)
+      {
+        const std::uint32_t value = random_numbers.next_uint32();
+        all_same = all_same && value == same_random_numbers.next_uint32();
+        all_different = all_different && value != other_random_numbers.next_uint32();
+      }
+    check(all_same, "CounterBasedRandomNumbers with same seed and index");
+    check(all_different, "CounterBasedRandomNumbers with different index");
+  }
+  {
+    // check mean and variance (using a different index for every sample)
+    const int num_samples = 100000;
+    double sum_uniform = 0, sum_uniform_sq = 0, sum_normal = 0, sum_normal_sq = 0;
+    bool in_range = true;
+    for (int i = 0; i < num_samples; ++i)
+      {
+        CounterBasedRandomNumbers random_numbers(3U, static_cast<std::uint64_t>(i));
+        const double u = random_numbers.uniform01();
+        in_range = in_range && u > 0 && u < 1 && random_numbers.uniform_int(10U) < 10U;
+        sum_uniform += u;
+        sum_uniform_sq += u * u;
+        const double n = random_numbers.normal();
+        sum_normal += n;
+        sum_normal_sq += n * n;
+      }
+    check(in_range, "CounterBasedRandomNumbers range");
+    set_tolerance(.02);
+    const double mean_uniform = sum_uniform / num_samples;
+    check_if_equal(mean_uniform, 0.5, "CounterBasedRandomNumbers::uniform01 mean");
+    check_if_equal(
+        sum_uniform_sq / num_samples - mean_uniform * mean_uniform, 1. / 12, "CounterBasedRandomNumbers::uniform01 variance");
+    const double mean_normal = sum_normal / num_samples;
+    check_if_zero(mean_normal, "CounterBasedRandomNumbers::normal mean");
+    check_if_equal(sum_normal_sq / num_samples - mean_normal * mean_normal, 1., "CounterBasedRandomNumbers::normal variance");
+  }
+}
+
+END_NAMESPACE_STIR
+
+USING_NAMESPACE_STIR
+
+int
+main()
+{
+  Philox4x32Tests tests;
+  tests.run_tests();
+  return tests.main_return_value();
+}
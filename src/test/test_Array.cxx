@@ -30,11 +30,13 @@
 #endif
 
 #include "stir/Array.h"
+#include "stir/StridedArrayView.h"
 #include "stir/make_array.h"
 #include "stir/Coordinate2D.h"
 #include "stir/Coordinate3D.h"
 #include "stir/Coordinate4D.h"
 #include "stir/convert_array.h"
+#include "stir/apply_elementwise.h"
 #include "stir/Succeeded.h"
 #include "stir/IO/write_data.h"
 #include "stir/IO/read_data.h"
@@ -758,6 +760,72 @@ ArrayTests::run_tests()
         check_if_equal(test3, data_to_fill, "test on 3D copy_to, irregular range");
       }
     }
+    // contiguous copies and StridedArrayView
+    {
+      const IndexRange<3> range(Coordinate3D<int>(-1, 1, 4), Coordinate3D<int>(1, 3, 7));
+      Array<3, float> test(range);
+      std::iota(test.begin_all(), test.end_all(), 1.F);
+      // make it non-contiguous by growing a row and shrinking it again
+      test[0][2].resize(3, 8);
+      test[0][2].resize(4, 7);
+      check(!test.is_contiguous(), "test 3D non-contiguous after resize");
+      {
+        const Array<3, float> test_copy(test);
+        check(test_copy.is_contiguous(), "test 3D copy is contiguous");
+        check_if_equal(test_copy, test, "test 3D contiguous copy equality");
+      }
+      test = Array<3, float>(test);
+      check(test.is_contiguous(), "test 3D contiguous after assignment");
+
+      StridedArrayView<3, float> view(test);
+      check_if_equal(view.size_all(), test.size_all(), "test StridedArrayView size_all");
+      check(view.is_contiguous(), "test StridedArrayView is_contiguous");
+      check(view.get_full_data_ptr() == &test[-1][1][4], "test StridedArrayView get_full_data_ptr");
+      check(view.get_index_range() == range, "test StridedArrayView get_index_range");
+      const Coordinate3D<int> c(0, 2, 5);
+      check_if_equal(view[c], test[0][2][5], "test StridedArrayView operator[]");
+      view[c] = 1234.F;
+      check_if_equal(test[0][2][5], 1234.F, "test StridedArrayView modifies original");
+      {
+        const Array<3, float>& const_test = test;
+        const StridedArrayView<3, const float> const_view(const_test);
+        check_if_equal(const_view.at(c), 1234.F, "test StridedArrayView on const Array");
+        try
+          {
+            const_view.at(Coordinate3D<int>(2, 2, 5));
+            check(false, "test StridedArrayView::at should have thrown");
+          }
+        catch (std::out_of_range&)
+          {
+          }
+      }
+      {
+        const StridedArrayView<3, float> sub_view = view.subview(Coordinate3D<int>(0, 2, 5), Coordinate3D<int>(2, 2, 2));
+        check(!sub_view.is_contiguous(), "test StridedArrayView subview is not contiguous");
+        check_if_equal(sub_view[Coordinate3D<int>(1, 3, 6)], test[1][3][6], "test StridedArrayView subview operator[]");
+        Array<3, float> sub_array;
+        sub_view.copy_to(sub_array);
+        check(sub_array.get_index_range() == sub_view.get_index_range(), "test StridedArrayView copy_to index range");
+        check_if_equal(sub_array[1][2][6], test[1][2][6], "test StridedArrayView copy_to");
+        sub_array *= 2;
+        sub_view.copy_from(sub_array);
+        check_if_equal(test[1][2][6], sub_array[1][2][6], "test StridedArrayView copy_from");
+      }
+      {
+        const StridedArrayView<3, float> swapped_view = view.swap_dimensions(1, 3);
+        check(!swapped_view.is_contiguous(), "test StridedArrayView swap_dimensions is not contiguous");
+        check_if_equal(swapped_view[Coordinate3D<int>(5, 2, 0)], test[0][2][5], "test StridedArrayView swap_dimensions");
+      }
+      // zero-copy Array from the view's memory
+      {
+        shared_ptr<float[]> mem(new float[range.size_all()]);
+        StridedArrayView<3, float>(mem.get(), view.get_min_indices(), view.get_lengths()).copy_from(test);
+        const Array<3, float> wrapped(range, mem);
+        check_if_equal(wrapped, test, "test Array wrapping StridedArrayView memory");
+        check(wrapped.get_const_full_data_ptr() == mem.get(), "test Array wrapping StridedArrayView memory is zero-copy");
+        wrapped.release_const_full_data_ptr();
+      }
+    }
   }
 
   {
@@ -1026,6 +1094,36 @@ ArrayTests::run_tests()
     check_if_equal(arr1, arr3, "make_array inline vs function with assignment");
     check_if_equal(arr1, arr4, "make_array inline constructor from function");
   }
+  {
+    cerr << "Testing apply_elementwise" << endl;
+
+    const IndexRange<3> range(Coordinate3D<int>(-1, 2, 0), Coordinate3D<int>(3, 5, 7));
+    Array<3, float> x(range), y(range), out(range);
+    Array<3, float> expected(range);
+    float value = 1.F;
+    for (auto x_iter = x.begin_all(), y_iter = y.begin_all(); x_iter != x.end_all(); ++x_iter, ++y_iter, value += 1.F)
+      {
+        *x_iter = value;
+        *y_iter = 2 * value - 30.F;
+      }
+    const auto f = [](float a, float b) { return 2 * a - b * b; };
+    std::transform(x.begin_all(), x.end_all(), y.begin_all(), expected.begin_all(), f);
+
+    apply_elementwise(out, f, x, y);
+    check_if_equal(out, expected, "apply_elementwise 3D");
+    // output is also an input
+    apply_elementwise(x, f, x, y);
+    check_if_equal(x, expected, "apply_elementwise 3D in-place");
+    // 1D, and a different input type
+    Array<1, float> out1d(range[0][2]);
+    const Array<1, int> int1d(range[0][2]);
+    apply_elementwise(out1d, [](int a) { return a + 1.5F; }, int1d);
+    check_if_equal(out1d.sum(), 1.5F * out1d.size_all(), "apply_elementwise 1D");
+    // no inputs
+    apply_elementwise(out, []() { return 3.F; });
+    check_if_equal(out.find_min(), 3.F, "apply_elementwise without inputs (min)");
+    check_if_equal(out.find_max(), 3.F, "apply_elementwise without inputs (max)");
+  }
   std::cerr << "timings\n";
   {
     HighResWallClockTimer t;
@@ -0,0 +1,262 @@
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup test
+
+  \brief Test program for stir::BinNormalisation::get_efficiencies_for_viewgram and
+  stir::BinNormalisation::get_efficiencies_key_info
+
+  \author STIR contributors
+*/
+
+#include "stir/RunTests.h"
+#include "stir/recon_buildblock/BinNormalisationPETFromComponents.h"
+#include "stir/recon_buildblock/BinNormalisationFromECAT8.h"
+#include "stir/ProjDataInfo.h"
+#include "stir/Array.h"
+#include "stir/IndexRange2D.h"
+#include "stir/IO/write_data.h"
+#include "stir/Viewgram.h"
+#include "stir/ViewgramIndices.h"
+#include "stir/ExamInfo.h"
+#include "stir/Scanner.h"
+#include "stir/Bin.h"
+#include "stir/Succeeded.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cmath>
+
+START_NAMESPACE_STIR
+
+/*!
+  \ingroup test
+  \brief Test class for BinNormalisation::get_efficiencies_for_viewgram
+
+  Checks that the efficiencies for a viewgram are the same as those found by
+  BinNormalisation::get_bin_efficiency, and that the viewgram keeps its ProjDataInfo.
+  Also checks that the key of the efficiencies changes when the efficiencies change.
+
+  This is done for BinNormalisationPETFromComponents, and for BinNormalisationFromECAT8
+  (using a norm file with made-up values written by the test).
+*/
+class BinNormalisationTests : public RunTests
+{
+public:
+  void run_tests() override;
+
+private:
+  void test_efficiencies_for_viewgram(const BinNormalisation& norm,
+                                      const shared_ptr<const ProjDataInfo>& proj_data_info_sptr,
+                                      const std::string& name,
+                                      const int view_step = 7);
+  void run_tests_for_ECAT8();
+  //! write an mMR norm file with made-up factors, returns the name of the header
+  std::string
+  write_ECAT8_norm_file(const shared_ptr<const ProjDataInfo>& norm_proj_data_info_sptr, const int span, const int max_ring_diff);
+};
+
+void
+BinNormalisationTests::test_efficiencies_for_viewgram(const BinNormalisation& norm,
+                                                      const shared_ptr<const ProjDataInfo>& proj_data_info_sptr,
+                                                      const std::string& name,
+                                                      const int view_step)
+{
+  std::cerr << "Testing " << name << '\n';
+  for (int segment_num = proj_data_info_sptr->get_min_segment_num(); segment_num <= proj_data_info_sptr->get_max_segment_num();
+       ++segment_num)
+    for (int view_num = proj_data_info_sptr->get_min_view_num(); view_num <= proj_data_info_sptr->get_max_view_num();
+         view_num += view_step)
+      {
+        const int timing_pos_num = proj_data_info_sptr->get_max_tof_pos_num();
+        Viewgram<float> efficiencies(proj_data_info_sptr, ViewgramIndices(view_num, segment_num, timing_pos_num));
+        norm.get_efficiencies_for_viewgram(efficiencies);
+        if (!check(efficiencies.get_proj_data_info_sptr() == proj_data_info_sptr, name + ": ProjDataInfo of viewgram kept"))
+          return;
+        Bin bin(segment_num, view_num, 0, 0, timing_pos_num);
+        for (bin.axial_pos_num() = efficiencies.get_min_axial_pos_num();
+             bin.axial_pos_num() <= efficiencies.get_max_axial_pos_num();
+             ++bin.axial_pos_num())
+          for (bin.tangential_pos_num() = efficiencies.get_min_tangential_pos_num();
+               bin.tangential_pos_num() <= efficiencies.get_max_tangential_pos_num();
+               ++bin.tangential_pos_num())
+            if (!check_if_equal(efficiencies[bin.axial_pos_num()][bin.tangential_pos_num()],
+                                norm.get_bin_efficiency(bin),
+                                name + ": efficiency for segment " + std::to_string(segment_num) + ", view "
+                                    + std::to_string(view_num)))
+              return;
+      }
+}
+
+void
+BinNormalisationTests::run_tests()
+{
+  shared_ptr<ExamInfo> exam_info_sptr(new ExamInfo(ImagingModality::PT));
+  shared_ptr<Scanner> scanner_sptr(new Scanner(Scanner::E953));
+  shared_ptr<const ProjDataInfo> proj_data_info_sptr(
+      ProjDataInfo::construct_proj_data_info(scanner_sptr,
+                                             /*span*/ 1,
+                                             /*max_delta*/ 3,
+                                             /*views*/ scanner_sptr->get_num_detectors_per_ring() / 2,
+                                             /*tang_pos*/ 64,
+                                             /*arc_corrected*/ false));
+
+  BinNormalisationPETFromComponents norm;
+  norm.allocate(proj_data_info_sptr, /*do_eff*/ true, /*do_geo*/ false);
+  {
+    DetectorEfficiencies& efficiencies = norm.crystal_efficiencies();
+    for (int r = efficiencies.get_min_index(); r <= efficiencies.get_max_index(); ++r)
+      for (int d = efficiencies[r].get_min_index(); d <= efficiencies[r].get_max_index(); ++d)
+        efficiencies[r][d] = 1.F + 0.3F * static_cast<float>(std::sin(1.1 * r + 0.3 * d));
+  }
+  if (!check(norm.set_up(exam_info_sptr, proj_data_info_sptr) == Succeeded::yes, "set_up of BinNormalisationPETFromComponents"))
+    return;
+  test_efficiencies_for_viewgram(norm, proj_data_info_sptr, "BinNormalisationPETFromComponents");
+  // use a different (but equal) ProjDataInfo object for the viewgrams
+  test_efficiencies_for_viewgram(
+      norm, proj_data_info_sptr->create_shared_clone(), "BinNormalisationPETFromComponents (with copy of ProjDataInfo)");
+
+  std::cerr << "Testing get_efficiencies_key_info\n";
+  {
+    const std::string key_info = norm.get_efficiencies_key_info();
+    check_if_equal(norm.get_efficiencies_key_info(), key_info, "key info for second call");
+    norm.set_up(exam_info_sptr, proj_data_info_sptr);
+    check_if_equal(norm.get_efficiencies_key_info(), key_info, "key info after set_up for same data");
+    norm.crystal_efficiencies()[0][0] *= 2;
+    norm.set_up(exam_info_sptr, proj_data_info_sptr);
+    check(norm.get_efficiencies_key_info() != key_info, "key info after changing efficiencies");
+  }
+
+  run_tests_for_ECAT8();
+}
+
+std::string
+BinNormalisationTests::write_ECAT8_norm_file(const shared_ptr<const ProjDataInfo>& norm_proj_data_info_sptr,
+                                             const int span,
+                                             const int max_ring_diff)
+{
+  const Scanner& scanner = *norm_proj_data_info_sptr->get_scanner_ptr();
+  const int num_rings = scanner.get_num_rings();
+  const int num_detectors_per_ring = scanner.get_num_detectors_per_ring();
+  const int num_bins = scanner.get_max_num_non_arccorrected_bins();
+  const int num_crystals_per_block = scanner.get_num_transaxial_crystals_per_block();
+  const int num_sinograms = norm_proj_data_info_sptr->get_num_non_tof_sinograms();
+
+  // components in the order of the file, see BinNormalisationFromECAT8::read_norm_data
+  Array<2, float> geometric_factors(IndexRange2D(2 * num_rings - 1, num_bins));
+  Array<2, float> crystal_interference_factors(IndexRange2D(num_bins, num_crystals_per_block));
+  Array<2, float> efficiency_factors(IndexRange2D(num_rings, num_detectors_per_ring));
+  Array<1, float> axial_effects(num_sinograms);
+  for (int i = 0; i < 2 * num_rings - 1; ++i)
+    for (int b = 0; b < num_bins; ++b)
+      geometric_factors[i][b] = 1.F + 0.2F * static_cast<float>(std::sin(0.3 * i + 0.05 * b));
+  for (int b = 0; b < num_bins; ++b)
+    for (int c = 0; c < num_crystals_per_block; ++c)
+      crystal_interference_factors[b][c] = 1.F + 0.1F * static_cast<float>(std::cos(0.7 * c + 0.02 * b));
+  for (int r = 0; r < num_rings; ++r)
+    for (int d = 0; d < num_detectors_per_ring; ++d)
+      efficiency_factors[r][d] = 1.F + 0.3F * static_cast<float>(std::sin(1.1 * r + 0.3 * d));
+  for (int s = 0; s < num_sinograms; ++s)
+    axial_effects[s] = 1.F + 0.05F * static_cast<float>(std::sin(0.01 * s));
+
+  const std::string data_filename = "test_BinNormalisation_ECAT8.n";
+  const std::string header_filename = data_filename + ".hdr";
+  std::vector<std::streamoff> offsets;
+  {
+    std::ofstream data(data_filename.c_str(), std::ios::out | std::ios::binary);
+    offsets.push_back(data.tellp());
+    write_data(data, geometric_factors, ByteOrder::little_endian);
+    offsets.push_back(data.tellp());
+    write_data(data, crystal_interference_factors, ByteOrder::little_endian);
+    offsets.push_back(data.tellp());
+    write_data(data, efficiency_factors, ByteOrder::little_endian);
+    offsets.push_back(data.tellp());
+    write_data(data, axial_effects, ByteOrder::little_endian);
+    check(data.good(), "writing ECAT8 norm data");
+  }
+
+  // segment table in Siemens order (0, -1, 1, -2, 2, ...)
+  std::ostringstream segment_table;
+  segment_table << '{' << norm_proj_data_info_sptr->get_num_axial_poss(0);
+  for (int s = 1; s <= norm_proj_data_info_sptr->get_max_segment_num(); ++s)
+    segment_table << ',' << norm_proj_data_info_sptr->get_num_axial_poss(-s) << ','
+                  << norm_proj_data_info_sptr->get_num_axial_poss(s);
+  segment_table << '}';
+
+  std::ofstream header(header_filename.c_str());
+  header << "!INTERFILE:=\n"
+         << "!originating system:=2008\n" // mMR (spaces are removed by the Siemens header parser)
+         << "!name of data file:=" << data_filename << '\n'
+         << "imagedata byte order:=LITTLEENDIAN\n"
+         << "PET data type:=Normalization\n"
+         << "number format:=float\n"
+         << "!number of bytes per pixel:=4\n"
+         << "%number of normalization components:=4\n"
+         << "%matrix size[1]:={" << num_bins << ',' << 2 * num_rings - 1 << "}\n"
+         << "%matrix size[2]:={" << num_bins << ',' << num_crystals_per_block << "}\n"
+         << "%matrix size[3]:={" << num_detectors_per_ring << ',' << num_rings << "}\n"
+         << "%matrix size[4]:={" << num_sinograms << "}\n";
+  for (std::size_t i = 0; i < offsets.size(); ++i)
+    header << "data offset in bytes[" << i + 1 << "]:=" << offsets[i] << '\n';
+  header << "number of rings:=" << num_rings << '\n'
+         << "%axial compression:=" << span << '\n'
+         << "%maximum ring difference:=" << max_ring_diff << '\n'
+         << "%tof mashing factor:=1\n"
+         << "%number of segments:=" << norm_proj_data_info_sptr->get_num_segments() << '\n'
+         << "%segment table:=" << segment_table.str() << '\n'
+         << "!END OF INTERFILE:=\n";
+  check(header.good(), "writing ECAT8 norm header");
+  return header_filename;
+}
+
+void
+BinNormalisationTests::run_tests_for_ECAT8()
+{
+  shared_ptr<ExamInfo> exam_info_sptr(new ExamInfo(ImagingModality::PT));
+  shared_ptr<Scanner> scanner_sptr(new Scanner(Scanner::Siemens_mMR));
+  const int num_views = scanner_sptr->get_num_detectors_per_ring() / 2;
+  const int num_bins = scanner_sptr->get_max_num_non_arccorrected_bins();
+  const int max_ring_diff = scanner_sptr->get_num_rings() - 4;
+  shared_ptr<const ProjDataInfo> norm_proj_data_info_sptr(
+      ProjDataInfo::construct_proj_data_info(scanner_sptr, /*span*/ 11, max_ring_diff, num_views, num_bins, false));
+  const std::string header_filename = write_ECAT8_norm_file(norm_proj_data_info_sptr, /*span*/ 11, max_ring_diff);
+  if (!is_everything_ok())
+    return;
+
+  {
+    ecat::BinNormalisationFromECAT8 norm(header_filename);
+    if (check(norm.set_up(exam_info_sptr, norm_proj_data_info_sptr) == Succeeded::yes, "set_up of BinNormalisationFromECAT8"))
+      test_efficiencies_for_viewgram(norm, norm_proj_data_info_sptr, "BinNormalisationFromECAT8", 37);
+  }
+  {
+    // mashed data with a smaller maximum ring difference
+    shared_ptr<const ProjDataInfo> proj_data_info_sptr(
+        ProjDataInfo::construct_proj_data_info(scanner_sptr, /*span*/ 11, /*max_ring_diff*/ 27, num_views / 2, num_bins, false));
+    ecat::BinNormalisationFromECAT8 norm(header_filename);
+    if (check(norm.set_up(exam_info_sptr, proj_data_info_sptr) == Succeeded::yes,
+              "set_up of BinNormalisationFromECAT8 (mashed)"))
+      test_efficiencies_for_viewgram(norm, proj_data_info_sptr, "BinNormalisationFromECAT8 (mashed)", 19);
+  }
+  std::remove(header_filename.c_str());
+  std::remove("test_BinNormalisation_ECAT8.n");
+}
+
+END_NAMESPACE_STIR
+
+USING_NAMESPACE_STIR
+
+int
+main()
+{
+  BinNormalisationTests tests;
+  tests.run_tests();
+  return tests.main_return_value();
+}
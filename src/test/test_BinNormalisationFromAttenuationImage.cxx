@@ -0,0 +1,216 @@
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup test
+
+  \brief Test program for precomputed attenuation correction factors in stir::BinNormalisationFromAttenuationImage
+
+  \author STIR contributors
+*/
+
+#include "stir/RunTests.h"
+#include "stir/recon_buildblock/BinNormalisationFromAttenuationImage.h"
+#include "stir/recon_buildblock/ForwardProjectorByBinUsingRayTracing.h"
+#include "stir/VoxelsOnCartesianGrid.h"
+#include "stir/ProjDataInfo.h"
+#include "stir/ProjDataInMemory.h"
+#include "stir/RelatedViewgrams.h"
+#include "stir/Viewgram.h"
+#include "stir/DataSymmetriesForViewSegmentNumbers.h"
+#include "stir/ExamInfo.h"
+#include "stir/Scanner.h"
+#include "stir/Shape/EllipsoidalCylinder.h"
+#include "stir/Succeeded.h"
+#include <iostream>
+#include <cmath>
+#include <filesystem>
+
+START_NAMESPACE_STIR
+
+/*!
+  \ingroup test
+  \brief Test class for BinNormalisationFromAttenuationImage
+
+  Checks that precomputed attenuation correction factors (in memory, with reduced precision and
+  in a cache directory) give the same results as forward projecting for every call.
+*/
+class BinNormalisationFromAttenuationImageTests : public RunTests
+{
+public:
+  void run_tests() override;
+
+private:
+  shared_ptr<ExamInfo> exam_info_sptr;
+  shared_ptr<ProjDataInfo> proj_data_info_sptr;
+  shared_ptr<VoxelsOnCartesianGrid<float>> attenuation_image_sptr;
+
+  //! set attenuation_image_sptr to a water cylinder, using the geometry of proj_data_info_sptr
+  void construct_attenuation_image();
+  //! apply \a norm to all data (filled with 1)
+  shared_ptr<ProjDataInMemory> apply_to_ones(BinNormalisation& norm,
+                                             const shared_ptr<DataSymmetriesForViewSegmentNumbers>& symmetries_sptr
+                                             = shared_ptr<DataSymmetriesForViewSegmentNumbers>());
+  void test_precomputed(BinNormalisationFromAttenuationImage& norm, const ProjDataInMemory& expected, const std::string& name);
+};
+
+void
+BinNormalisationFromAttenuationImageTests::construct_attenuation_image()
+{
+  attenuation_image_sptr.reset(new VoxelsOnCartesianGrid<float>(exam_info_sptr, *proj_data_info_sptr));
+  const CartesianCoordinate3D<float> grid_spacing = attenuation_image_sptr->get_grid_spacing();
+  const float radius = 0.4F * grid_spacing.x() * attenuation_image_sptr->get_x_size();
+  EllipsoidalCylinder cylinder(10 * grid_spacing.z(), radius, radius, CartesianCoordinate3D<float>(2 * grid_spacing.z(), 0, 0));
+  cylinder.construct_volume(*attenuation_image_sptr, make_coordinate(2, 2, 2));
+  *attenuation_image_sptr *= 0.096F;
+}
+
+shared_ptr<ProjDataInMemory>
+BinNormalisationFromAttenuationImageTests::apply_to_ones(
+    BinNormalisation& norm, const shared_ptr<DataSymmetriesForViewSegmentNumbers>& symmetries_sptr)
+{
+  shared_ptr<ProjDataInMemory> proj_data_sptr(new ProjDataInMemory(exam_info_sptr, proj_data_info_sptr));
+  proj_data_sptr->fill(1.F);
+  norm.apply(*proj_data_sptr, symmetries_sptr);
+  return proj_data_sptr;
+}
+
+void
+BinNormalisationFromAttenuationImageTests::test_precomputed(BinNormalisationFromAttenuationImage& norm,
+                                                            const ProjDataInMemory& expected,
+                                                            const std::string& name)
+{
+  std::cerr << "Testing " << name << '\n';
+  check(norm.get_precompute_attenuation_correction_factors(), name + ": get_precompute_attenuation_correction_factors");
+  if (!check(norm.set_up(exam_info_sptr, proj_data_info_sptr) == Succeeded::yes, name + ": set_up"))
+    return;
+  shared_ptr<ProjDataInMemory> result_sptr = apply_to_ones(norm);
+  check_if_equal(expected.find_max(), result_sptr->find_max(), name + ": max");
+  check_if_equal(expected.sum(), result_sptr->sum(), name + ": sum");
+  {
+    ProjDataInMemory diff(expected);
+    diff.sapyb(1.F, *result_sptr, -1.F);
+    check_if_zero(std::max(diff.find_max(), -diff.find_min()) / expected.find_max(), name + ": difference");
+  }
+  {
+    // efficiencies are 1/ACF
+    Viewgram<float> efficiencies = expected.get_empty_viewgram(expected.get_min_view_num(), 0);
+    norm.get_efficiencies_for_viewgram(efficiencies);
+    const Viewgram<float> acfs = expected.get_viewgram(expected.get_min_view_num(), 0);
+    check_if_equal(efficiencies[0][0] * acfs[0][0], 1.F, name + ": get_efficiencies_for_viewgram");
+  }
+}
+
+void
+BinNormalisationFromAttenuationImageTests::run_tests()
+{
+  exam_info_sptr.reset(new ExamInfo(ImagingModality::PT));
+  shared_ptr<Scanner> scanner_sptr(new Scanner(Scanner::RPT));
+  scanner_sptr->set_num_rings(5);
+  proj_data_info_sptr.reset(ProjDataInfo::ProjDataInfoCTI(scanner_sptr,
+                                                          /*span=*/1,
+                                                          /*max_delta=*/2,
+                                                          // no view mashing (not supported by the ray tracing projector)
+                                                          scanner_sptr->get_num_detectors_per_ring() / 2,
+                                                          /*num_tang_poss=*/32));
+  construct_attenuation_image();
+
+  // reference: forward project for every call
+  shared_ptr<ProjDataInMemory> expected_sptr;
+  {
+    shared_ptr<ForwardProjectorByBin> forward_projector_sptr(new ForwardProjectorByBinUsingRayTracing);
+    BinNormalisationFromAttenuationImage norm(attenuation_image_sptr, forward_projector_sptr);
+    check(!norm.get_precompute_attenuation_correction_factors(), "default: no precomputation");
+    if (!check(norm.set_up(exam_info_sptr, proj_data_info_sptr) == Succeeded::yes, "set_up without precomputation"))
+      return;
+    // the forward projector needs to be called with its own symmetries
+    expected_sptr = apply_to_ones(norm, shared_ptr<DataSymmetriesForViewSegmentNumbers>(
+                                            forward_projector_sptr->get_symmetries_used()->clone()));
+    check(expected_sptr->find_max() > 1.5F, "attenuation correction factors should be large enough for this test");
+  }
+
+  {
+    BinNormalisationFromAttenuationImage norm(attenuation_image_sptr,
+                                              shared_ptr<ForwardProjectorByBin>(new ForwardProjectorByBinUsingRayTracing));
+    norm.set_precompute_attenuation_correction_factors(true);
+    test_precomputed(norm, *expected_sptr, "precomputed in memory");
+    // second set_up should reuse the values
+    test_precomputed(norm, *expected_sptr, "precomputed in memory (after second set_up)");
+  }
+  {
+    BinNormalisationFromAttenuationImage norm(attenuation_image_sptr,
+                                              shared_ptr<ForwardProjectorByBin>(new ForwardProjectorByBinUsingRayTracing));
+    norm.set_precompute_attenuation_correction_factors(true);
+    norm.set_use_reduced_precision(true);
+    set_tolerance(2e-4);
+    test_precomputed(norm, *expected_sptr, "precomputed in memory with reduced precision");
+    set_tolerance(1e-5);
+  }
+  // use a new directory such that the first set_up has to write the cache
+  const std::string cache_directory = "test_BinNormalisationFromAttenuationImage_cache";
+  std::filesystem::remove_all(cache_directory);
+  std::filesystem::create_directory(cache_directory);
+  for (int reduced_precision = 0; reduced_precision <= 1; ++reduced_precision)
+    {
+      const std::string name = reduced_precision ? "cache with reduced precision" : "cache";
+      if (reduced_precision)
+        set_tolerance(2e-4);
+      // first write, then read the cache
+      for (int i = 0; i < 2; ++i)
+        {
+          BinNormalisationFromAttenuationImage norm(
+              attenuation_image_sptr, shared_ptr<ForwardProjectorByBin>(new ForwardProjectorByBinUsingRayTracing));
+          norm.set_attenuation_correction_factors_cache_directory(cache_directory);
+          norm.set_use_reduced_precision(reduced_precision != 0);
+          test_precomputed(norm, *expected_sptr, name + (i == 0 ? " (writing)" : " (reading)"));
+        }
+      set_tolerance(1e-5);
+    }
+  std::filesystem::remove_all(cache_directory);
+
+  std::cerr << "Testing TOF data\n";
+  {
+    shared_ptr<Scanner> TOF_scanner_sptr(new Scanner(Scanner::PETMR_Signa));
+    TOF_scanner_sptr->set_num_rings(3);
+    TOF_scanner_sptr->set_intrinsic_azimuthal_tilt(0.F); // not supported by the ray tracing projector
+    proj_data_info_sptr = ProjDataInfo::construct_proj_data_info(TOF_scanner_sptr,
+                                                                 /*span=*/1,
+                                                                 /*max_delta=*/1,
+                                                                 TOF_scanner_sptr->get_num_detectors_per_ring() / 2,
+                                                                 /*num_tang_poss=*/32,
+                                                                 /* arccorrected=*/false,
+                                                                 /* TOF_mash_factor=*/39); // 9 TOF bins
+    construct_attenuation_image();
+    BinNormalisationFromAttenuationImage norm(attenuation_image_sptr,
+                                              shared_ptr<ForwardProjectorByBin>(new ForwardProjectorByBinUsingRayTracing));
+    norm.set_precompute_attenuation_correction_factors(true);
+    if (!check(norm.set_up(exam_info_sptr, proj_data_info_sptr) == Succeeded::yes, "set_up for TOF data"))
+      return;
+    shared_ptr<ProjDataInMemory> result_sptr = apply_to_ones(norm);
+    // all TOF bins should have the same factors
+    const int num_tof_poss = proj_data_info_sptr->get_num_tof_poss();
+    check(num_tof_poss > 1, "TOF data should have more than 1 TOF bin");
+    const Viewgram<float> first = result_sptr->get_viewgram(0, 0, false, result_sptr->get_min_tof_pos_num());
+    const Viewgram<float> last = result_sptr->get_viewgram(0, 0, false, result_sptr->get_max_tof_pos_num());
+    check(first.find_max() > 1.5F, "TOF: attenuation correction factors should be large enough for this test");
+    check_if_equal(first, last, "TOF: factors for first and last TOF bin");
+  }
+}
+
+END_NAMESPACE_STIR
+
+USING_NAMESPACE_STIR
+
+int
+main()
+{
+  BinNormalisationFromAttenuationImageTests tests;
+  tests.run_tests();
+  return tests.main_return_value();
+}
@@ -0,0 +1,134 @@
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup test
+
+  \brief Test program for stir::FourierRebinning
+
+  \author STIR contributors
+*/
+
+#include "stir/RunTests.h"
+#include "stir/recon_buildblock/FourierRebinning.h"
+#include "stir/DynamicProjData.h"
+#include "stir/ProjDataInMemory.h"
+#include "stir/ProjDataInfo.h"
+#include "stir/SegmentBySinogram.h"
+#include "stir/ExamInfo.h"
+#include "stir/Scanner.h"
+#include "stir/Succeeded.h"
+#include <iostream>
+#include <cmath>
+#include <filesystem>
+
+START_NAMESPACE_STIR
+
+/*!
+  \ingroup test
+  \brief Test class for FourierRebinning
+
+  Checks that rebinning dynamic projection data (without calling set_up(), and
+  using the default maximum segment number) gives the same result as rebinning every frame.
+*/
+class FourierRebinningTests : public RunTests
+{
+public:
+  void run_tests() override;
+
+private:
+  static void set_parameters(FourierRebinning& rebinning);
+};
+
+void
+FourierRebinningTests::set_parameters(FourierRebinning& rebinning)
+{
+  rebinning.set_kmin(2);
+  rebinning.set_wmin(2);
+  rebinning.set_kc(2);
+  rebinning.set_deltamin(1);
+}
+
+void
+FourierRebinningTests::run_tests()
+{
+  shared_ptr<ExamInfo> exam_info_sptr(new ExamInfo(ImagingModality::PT));
+  shared_ptr<Scanner> scanner_sptr(new Scanner(Scanner::E953));
+  scanner_sptr->set_num_rings(6);
+  shared_ptr<ProjDataInfo> proj_data_info_sptr(
+      ProjDataInfo::construct_proj_data_info(scanner_sptr,
+                                             /*span*/ 1,
+                                             /*max_delta*/ 3,
+                                             /*views*/ scanner_sptr->get_num_detectors_per_ring() / 2,
+                                             /*tang_pos*/ 64,
+                                             /*arc_corrected*/ false));
+
+  // 2 frames, where the second frame is twice the first one
+  DynamicProjData dyn_proj_data(exam_info_sptr, 2);
+  {
+    auto frame1_sptr = std::make_shared<ProjDataInMemory>(exam_info_sptr, proj_data_info_sptr);
+    int i = 0;
+    for (auto iter = frame1_sptr->begin(); iter != frame1_sptr->end(); ++iter, ++i)
+      *iter = 2.F + static_cast<float>(std::sin(0.001 * i));
+    auto frame2_sptr = std::make_shared<ProjDataInMemory>(*frame1_sptr);
+    *frame2_sptr *= 2.F;
+    dyn_proj_data.set_proj_data_sptr(frame1_sptr, 1);
+    dyn_proj_data.set_proj_data_sptr(frame2_sptr, 2);
+  }
+
+  DynamicProjData rebinned_dyn_proj_data;
+  {
+    FourierRebinning rebinning;
+    set_parameters(rebinning);
+    check_if_equal(rebinning.get_max_segment_num_to_process(), -1, "default maximum segment number");
+    if (!check(rebinning.rebin(rebinned_dyn_proj_data, dyn_proj_data) == Succeeded::yes, "rebinning of dynamic data"))
+      return;
+    check_if_equal(rebinning.get_max_segment_num_to_process(),
+                   proj_data_info_sptr->get_max_segment_num(),
+                   "maximum segment number after rebinning of dynamic data");
+  }
+  if (!check_if_equal(rebinned_dyn_proj_data.get_num_frames(), 2U, "number of rebinned frames"))
+    return;
+
+  // reference: rebin the first frame via set_up() and rebin()
+  const std::string output_filename_prefix = "test_FourierRebinning_frame1";
+  {
+    FourierRebinning rebinning;
+    set_parameters(rebinning);
+    rebinning.set_input_proj_data_sptr(dyn_proj_data.get_proj_data_sptr(1));
+    rebinning.set_output_filename_prefix(output_filename_prefix);
+    if (!check(rebinning.set_up() == Succeeded::yes, "set_up for rebinning of single frame")
+        || !check(rebinning.rebin() == Succeeded::yes, "rebinning of single frame"))
+      return;
+  }
+  {
+    shared_ptr<ProjData> expected_sptr = ProjData::read_from_file(output_filename_prefix + ".hs");
+    const SegmentBySinogram<float> expected = expected_sptr->get_segment_by_sinogram(0);
+    const SegmentBySinogram<float> frame1 = rebinned_dyn_proj_data.get_proj_data(1).get_segment_by_sinogram(0);
+    check(expected.find_max() > 0.F, "rebinned data should be non-zero");
+    check_if_equal(frame1, expected, "first frame of rebinned dynamic data");
+    SegmentBySinogram<float> frame2 = rebinned_dyn_proj_data.get_proj_data(2).get_segment_by_sinogram(0);
+    frame2 /= 2.F;
+    check_if_equal(frame2, expected, "second frame of rebinned dynamic data");
+  }
+  std::filesystem::remove(output_filename_prefix + ".hs");
+  std::filesystem::remove(output_filename_prefix + ".s");
+}
+
+END_NAMESPACE_STIR
+
+USING_NAMESPACE_STIR
+
+int
+main()
+{
+  FourierRebinningTests tests;
+  tests.run_tests();
+  return tests.main_return_value();
+}
@@ -20,6 +20,12 @@
 #include "stir/RunTests.h"
 #include "stir/Array.h"
 #include "stir/GeneralisedPoissonNoiseGenerator.h"
+#include "stir/ProjDataInMemory.h"
+#include "stir/ProjDataInfo.h"
+#include "stir/ExamInfo.h"
+#include "stir/Scanner.h"
+#include "stir/SegmentBySinogram.h"
+#include "stir/num_threads.h"
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics.hpp>
 #include "stir/format.h"
@@ -31,12 +37,14 @@ START_NAMESPACE_STIR
 /*!
   \brief Tests GeneralisedPoissonNoiseGenerator functionality
   \ingroup test
-  Currently contains only simple tests to check mean and variance.
+  Contains simple tests to check mean and variance, and tests that the generated
+  projection data are reproducible and independent of the number of threads.
 */
 class GeneralisedPoissonNoiseGeneratorTests : public RunTests
 {
 private:
   void run_one_test(const int size, const float mu, const float scaling_factor, const bool preserve_mean);
+  void run_tests_reproducibility();
 
 public:
   void run_tests() override;
@@ -86,6 +94,69 @@ GeneralisedPoissonNoiseGeneratorTests::run_tests()
   run_one_test(1000, 4.2F, 1.0F, true);
   run_one_test(1000, 4.2F, 3.0F, true);
   run_one_test(1000, 4.2F, 3.0F, false);
+
+  run_tests_reproducibility();
+}
+
+void
+GeneralisedPoissonNoiseGeneratorTests::run_tests_reproducibility()
+{
+  std::cerr << "Testing reproducibility of noise realisations\n";
+
+  shared_ptr<Scanner> scanner_sptr(new Scanner(Scanner::E953));
+  shared_ptr<ProjDataInfo> proj_data_info_sptr(ProjDataInfo::ProjDataInfoCTI(scanner_sptr,
+                                                                             /*span*/ 1,
+                                                                             /*max_delta*/ 2,
+                                                                             /*views*/ 48,
+                                                                             /*tang_pos*/ 64,
+                                                                             /*arc_corrected*/ true));
+  shared_ptr<ExamInfo> exam_info_sptr(new ExamInfo(ImagingModality::PT));
+  ProjDataInMemory input(exam_info_sptr, proj_data_info_sptr);
+  // use both small and large means, as these use different algorithms
+  {
+    float value = 0.F;
+    for (auto iter = input.begin(); iter != input.end(); ++iter)
+      {
+        *iter = value;
+        value = value > 100.F ? 0.F : value + 1.3F;
+      }
+  }
+
+  ProjDataInMemory output(exam_info_sptr, proj_data_info_sptr);
+  ProjDataInMemory other_output(exam_info_sptr, proj_data_info_sptr);
+  const int num_threads = get_max_num_threads();
+  {
+    GeneralisedPoissonNoiseGenerator generator(2.F, false);
+    generator.seed(5U);
+    generator.generate_random(output, input);
+  }
+  {
+    set_num_threads(1);
+    GeneralisedPoissonNoiseGenerator generator(2.F, false);
+    generator.seed(5U);
+    generator.generate_random(other_output, input);
+    set_num_threads(num_threads);
+    check(std::equal(output.begin(), output.end(), other_output.begin()), "ProjData noise with different number of threads");
+    generator.generate_random(other_output, input);
+    check(!std::equal(output.begin(), output.end(), other_output.begin()), "ProjData noise for the next realisation");
+  }
+  {
+    // the ProjData version has to give the same result as the Array version for every segment
+    GeneralisedPoissonNoiseGenerator generator(2.F, false);
+    generator.seed(5U);
+    for (int seg = input.get_min_segment_num(); seg <= input.get_max_segment_num(); ++seg)
+      {
+        SegmentBySinogram<float> segment = input.get_empty_segment_by_sinogram(seg);
+        generator.generate_random(segment, input.get_segment_by_sinogram(seg));
+        check_if_equal(segment, output.get_segment_by_sinogram(seg), "ProjData noise vs Array noise");
+      }
+  }
+  {
+    GeneralisedPoissonNoiseGenerator generator(2.F, false);
+    generator.seed(6U);
+    generator.generate_random(other_output, input);
+    check(!std::equal(output.begin(), output.end(), other_output.begin()), "ProjData noise with different seed");
+  }
 }
 
 END_NAMESPACE_STIR
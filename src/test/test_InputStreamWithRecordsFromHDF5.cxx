@@ -0,0 +1,288 @@
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup test
+  \ingroup GE
+
+  \brief Test program for the buffering in stir::GE::RDF_HDF5::InputStreamWithRecordsFromHDF5
+
+  \author STIR contributors
+*/
+
+#include "stir/RunTests.h"
+#include "stir/IO/InputStreamWithRecordsFromHDF5.h"
+#include "stir/Succeeded.h"
+#include "stir/shared_ptr.h"
+#include "H5Cpp.h"
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <algorithm>
+
+START_NAMESPACE_STIR
+
+namespace GE
+{
+namespace RDF_HDF5
+{
+
+//! A record of variable size, used to test InputStreamWithRecordsFromHDF5
+/*! The size of the record (between 6 and 16 bytes) is encoded in its first byte. */
+class TestRecordForHDF5
+{
+public:
+  std::size_t size_of_record_at_ptr(const char* const data_ptr, const std::size_t, const bool) const
+  {
+    return size_of_record_with_first_byte(static_cast<unsigned char>(data_ptr[0]));
+  }
+
+  Succeeded init_from_data_ptr(const char* const data_ptr, const std::size_t size_of_record, const bool)
+  {
+    data.assign(data_ptr, data_ptr + size_of_record);
+    return Succeeded::yes;
+  }
+
+  static std::size_t size_of_record_with_first_byte(const unsigned char first_byte) { return 6 + first_byte % 11; }
+
+  std::vector<char> data;
+};
+
+/*!
+  \ingroup test
+  \ingroup GE
+  \brief Test class for the buffering in InputStreamWithRecordsFromHDF5
+
+  Writes an HDF5 file with the minimal RDF9 list mode header, and list data consisting of records
+  of variable size. Checks that the records are the same for 1, 2 and 3 buffers (i.e. when reading
+  ahead in a background thread or not), and for different buffer sizes, including after changes of
+  the position.
+*/
+class InputStreamWithRecordsFromHDF5Tests : public RunTests
+{
+public:
+  void run_tests() override;
+
+private:
+  typedef InputStreamWithRecordsFromHDF5<TestRecordForHDF5> stream_type;
+
+  const std::string filename = "test_InputStreamWithRecordsFromHDF5.h5";
+  //! records in the file
+  std::vector<std::vector<char>> records;
+  //! offset of every record in the list data
+  std::vector<std::uint64_t> offsets;
+
+  void write_file();
+  //! check that the next records in the stream are \a num_records records starting at \a record_num
+  bool check_next_records(stream_type& stream,
+                          const std::size_t record_num,
+                          const std::size_t num_records,
+                          const std::string& name);
+  void run_tests_for_one_stream(const std::size_t buffer_size, const int num_buffers);
+};
+
+// helper functions to write the RDF9 header
+static void
+create_groups(H5::H5File& file, const std::string& dataset_name)
+{
+  for (std::size_t pos = dataset_name.find('/', 1); pos != std::string::npos; pos = dataset_name.find('/', pos + 1))
+    {
+      const std::string group_name = dataset_name.substr(0, pos);
+      if (H5Lexists(file.getId(), group_name.c_str(), H5P_DEFAULT) <= 0)
+        file.createGroup(group_name);
+    }
+}
+
+template <class T>
+static void
+write_scalar(H5::H5File& file, const std::string& dataset_name, const T value, const H5::PredType& type)
+{
+  create_groups(file, dataset_name);
+  H5::DataSet dataset = file.createDataSet(dataset_name, type, H5::DataSpace(H5S_SCALAR));
+  dataset.write(&value, type);
+}
+
+static void
+write_string(H5::H5File& file, const std::string& dataset_name, const std::string& value)
+{
+  create_groups(file, dataset_name);
+  const H5::StrType type(H5::PredType::C_S1, value.size());
+  H5::DataSet dataset = file.createDataSet(dataset_name, type, H5::DataSpace(H5S_SCALAR));
+  dataset.write(value, type);
+}
+
+void
+InputStreamWithRecordsFromHDF5Tests::write_file()
+{
+  std::vector<unsigned char> list_data;
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<int> byte_distribution(0, 255);
+  for (int record_num = 0; record_num < 5000; ++record_num)
+    {
+      offsets.push_back(list_data.size());
+      const unsigned char first_byte = static_cast<unsigned char>(byte_distribution(generator));
+      std::vector<char> record(TestRecordForHDF5::size_of_record_with_first_byte(first_byte));
+      record[0] = static_cast<char>(first_byte);
+      for (std::size_t i = 1; i < record.size(); ++i)
+        record[i] = static_cast<char>(byte_distribution(generator));
+      list_data.insert(list_data.end(), record.begin(), record.end());
+      records.push_back(record);
+    }
+  // InputStreamWithRecordsFromHDF5 stops reading when less than the size of the record signature is left
+  list_data.insert(list_data.end(), 6, 0);
+
+  H5::H5File file(filename, H5F_ACC_TRUNC);
+  const H5::PredType& uint32_type = H5::PredType::NATIVE_UINT32;
+  const H5::PredType& int32_type = H5::PredType::NATIVE_INT32;
+  const H5::PredType& float_type = H5::PredType::NATIVE_FLOAT;
+  write_string(file, "/HeaderData/ExamData/manufacturer", "GE MEDICAL SYSTEMS");
+  write_string(file, "/HeaderData/ExamData/scannerDesc", "GE Signa PET/MR");
+  write_string(file, "/HeaderData/ExamData/radionuclideName", "F-18");
+  write_scalar(file, "/HeaderData/ExamData/positronFraction", 0.9686F, float_type);
+  write_scalar(file, "/HeaderData/ExamData/halfLife", 6586.2F, float_type);
+  write_scalar(file, "/HeaderData/RDFConfiguration/fileVersion/majorVersion", std::uint32_t(9), uint32_type);
+  write_scalar(file, "/HeaderData/RDFConfiguration/isListFile", std::uint32_t(1), uint32_type);
+  write_scalar(file, "/HeaderData/ListHeader/isListCompressed", std::uint32_t(0), uint32_type);
+  write_scalar(file, "/HeaderData/ListHeader/firstTmAbsTimeStamp", std::uint32_t(0), uint32_type);
+  write_scalar(file, "/HeaderData/ListHeader/lastTmAbsTimeStamp", std::uint32_t(1000), uint32_type);
+  write_scalar(file, "/HeaderData/AcqParameters/LandmarkParameters/patientEntry", std::uint32_t(0), uint32_type);
+  write_scalar(file, "/HeaderData/AcqParameters/LandmarkParameters/patientPosition", std::uint32_t(0), uint32_type);
+  write_scalar(file, "/HeaderData/AcqParameters/LandmarkParameters/absTableLongitude", std::int32_t(0), int32_type);
+  write_scalar(file, "/HeaderData/AcqParameters/LandmarkParameters/tableElevation", std::int32_t(0), int32_type);
+  write_scalar(file, "/HeaderData/AcqParameters/EDCATParameters/lower_energy_limit", std::uint32_t(425), uint32_type);
+  write_scalar(file, "/HeaderData/AcqParameters/EDCATParameters/upper_energy_limit", std::uint32_t(650), uint32_type);
+  write_scalar(file, "/HeaderData/AcqParameters/EDCATParameters/posCoincidenceWindow", std::int32_t(175), int32_type);
+  write_scalar(file, "/HeaderData/AcqParameters/EDCATParameters/negCoincidenceWindow", std::int32_t(175), int32_type);
+  write_scalar(file, "/HeaderData/AcqParameters/EDCATParameters/coincTimingPrecision", 0.01302F, float_type);
+  write_scalar(file, "/HeaderData/AcqStats/scanStartTime", std::uint32_t(0), uint32_type);
+  write_scalar(file, "/HeaderData/AcqStats/frameStartTime", std::uint32_t(0), uint32_type);
+  write_scalar(file, "/HeaderData/AcqStats/frameDuration", std::uint32_t(1000), uint32_type);
+  // geometry of the GE Signa PET/MR
+  write_scalar(file, "/HeaderData/SystemGeometry/effectiveRingDiameter", 640.6F, float_type);
+  write_scalar(file, "/HeaderData/SystemGeometry/axialBlocksPerModule", std::uint32_t(5), uint32_type);
+  write_scalar(file, "/HeaderData/SystemGeometry/radialBlocksPerModule", std::uint32_t(4), uint32_type);
+  write_scalar(file, "/HeaderData/SystemGeometry/axialBlocksPerUnit", std::uint32_t(1), uint32_type);
+  write_scalar(file, "/HeaderData/SystemGeometry/radialBlocksPerUnit", std::uint32_t(1), uint32_type);
+  write_scalar(file, "/HeaderData/SystemGeometry/axialUnitsPerModule", std::uint32_t(1), uint32_type);
+  write_scalar(file, "/HeaderData/SystemGeometry/radialUnitsPerModule", std::uint32_t(1), uint32_type);
+  write_scalar(file, "/HeaderData/SystemGeometry/axialModulesPerSystem", std::uint32_t(1), uint32_type);
+  write_scalar(file, "/HeaderData/SystemGeometry/radialModulesPerSystem", std::uint32_t(28), uint32_type);
+  write_scalar(file, "/HeaderData/SystemGeometry/axialCrystalsPerBlock", std::uint32_t(9), uint32_type);
+  write_scalar(file, "/HeaderData/SystemGeometry/radialCrystalsPerBlock", std::uint32_t(4), uint32_type);
+  write_scalar(file, "/HeaderData/SystemGeometry/detectorAxialSize", 45 * 5.56F, float_type);
+  write_scalar(file, "/HeaderData/SystemGeometry/transaxial_crystal_0_offset", -5.23F, float_type);
+  write_scalar(file, "/HeaderData/SystemGeometry/timingResolutionInPico", 0.F, float_type);
+  write_scalar(file, "/HeaderData/Sorter/dimension1Size", std::uint32_t(357), uint32_type);
+  write_scalar(file, "/HeaderData/Sorter/numTOF_bins", std::uint32_t(1), uint32_type);
+  write_scalar(file, "/HeaderData/SinglesHeader/numValidSamples", std::uint32_t(1), uint32_type);
+
+  // GEHDF5Wrapper checks if /SegmentData/Segment2 exists, which gives HDF5 diagnostics if the group does not exist
+  file.createGroup("/SegmentData");
+
+  create_groups(file, "/ListData/listData");
+  const hsize_t size = list_data.size();
+  H5::DataSet dataset = file.createDataSet("/ListData/listData", H5::PredType::STD_U8LE, H5::DataSpace(1, &size));
+  dataset.write(list_data.data(), H5::PredType::NATIVE_UCHAR);
+}
+
+bool
+InputStreamWithRecordsFromHDF5Tests::check_next_records(stream_type& stream,
+                                                        const std::size_t record_num,
+                                                        const std::size_t num_records,
+                                                        const std::string& name)
+{
+  TestRecordForHDF5 record;
+  for (std::size_t i = record_num; i < record_num + num_records; ++i)
+    {
+      if (!check(stream.get_next_record(record) == Succeeded::yes, name + ": get_next_record should succeed")
+          || !check(record.data == records[i], name + ": record should be equal"))
+        {
+          std::cerr << "  for record " << i << '\n';
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+InputStreamWithRecordsFromHDF5Tests::run_tests_for_one_stream(const std::size_t buffer_size, const int num_buffers)
+{
+  const std::string name = "buffer size " + std::to_string(buffer_size) + ", " + std::to_string(num_buffers) + " buffers";
+  std::cerr << "Testing " << name << '\n';
+  stream_type stream(filename, 6, 16, buffer_size, num_buffers);
+  const std::size_t num_records = records.size();
+
+  // read all records
+  if (!check_next_records(stream, 0, num_records, name + " (all records)"))
+    return;
+  TestRecordForHDF5 record;
+  check(stream.get_next_record(record) == Succeeded::no, name + ": get_next_record should fail at the end");
+
+  // go back to the start, and save some positions
+  check(stream.reset() == Succeeded::yes, name + ": reset");
+  if (!check_next_records(stream, 0, 1000, name + " (after reset)"))
+    return;
+  const stream_type::SavedPosition position_1000 = stream.save_get_position();
+  if (!check_next_records(stream, 1000, 2000, name + " (after saving position)"))
+    return;
+  const stream_type::SavedPosition position_3000 = stream.save_get_position();
+  std::uint64_t offset = 0;
+  check(stream.get_current_offset(offset) == Succeeded::yes, name + ": get_current_offset");
+  check_if_equal(offset, offsets[3000], name + ": get_current_offset");
+
+  // go backwards
+  check(stream.set_get_position(position_1000) == Succeeded::yes, name + ": set_get_position backwards");
+  if (!check_next_records(stream, 1000, 10, name + " (after set_get_position backwards)"))
+    return;
+  // go forwards
+  check(stream.set_get_position(position_3000) == Succeeded::yes, name + ": set_get_position forwards");
+  if (!check_next_records(stream, 3000, 1500, name + " (after set_get_position forwards)"))
+    return;
+  // jump to arbitrary records, including the last one
+  for (const std::size_t record_num : { std::size_t(17), num_records - 1, std::size_t(2500), std::size_t(2501) })
+    {
+      check(stream.set_current_offset(offsets[record_num]) == Succeeded::yes, name + ": set_current_offset");
+      if (!check_next_records(stream, record_num, std::min(std::size_t(100), num_records - record_num), name + " (after set_current_offset)"))
+        return;
+    }
+  // reading until the end after a jump
+  check(stream.set_current_offset(offsets[4000]) == Succeeded::yes, name + ": set_current_offset");
+  if (!check_next_records(stream, 4000, num_records - 4000, name + " (until the end after set_current_offset)"))
+    return;
+  check(stream.get_next_record(record) == Succeeded::no, name + ": get_next_record should fail at the end");
+}
+
+void
+InputStreamWithRecordsFromHDF5Tests::run_tests()
+{
+  write_file();
+  // buffer sizes such that records often straddle buffers, and such that all data fit in 1 buffer
+  for (const std::size_t buffer_size : { std::size_t(16), std::size_t(100), std::size_t(4096), std::size_t(1000000) })
+    for (int num_buffers = 1; num_buffers <= 3; ++num_buffers)
+      run_tests_for_one_stream(buffer_size, num_buffers);
+  std::remove(filename.c_str());
+}
+
+} // namespace RDF_HDF5
+} // namespace GE
+
+END_NAMESPACE_STIR
+
+USING_NAMESPACE_STIR
+
+int
+main()
+{
+  GE::RDF_HDF5::InputStreamWithRecordsFromHDF5Tests tests;
+  tests.run_tests();
+  return tests.main_return_value();
+}
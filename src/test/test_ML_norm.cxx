@@ -178,9 +178,40 @@ ML_normTests::test_proj_data_info(shared_ptr<TProjDataInfo> proj_data_info_sptr)
           Array<2, float> data_fan_sums(IndexRange2D(num_physical_rings, num_physical_detectors_per_ring));
           make_fan_sum_data(data_fan_sums, fan_data);
           check_if_equal(data_fan_sums.find_min(), data_fan_sums.find_max(), "make_fan_sum_data (no gaps)");
+          // compare with the version using the projection data
+          Array<2, float> proj_data_fan_sums(data_fan_sums.get_index_range());
+          make_fan_sum_data(proj_data_fan_sums, proj_data);
+          check_if_equal(proj_data_fan_sums, data_fan_sums, "make_fan_sum_data from proj_data and fan_data (no gaps)");
         }
     }
   }
+
+  {
+    // test iterate_efficiencies with a model of all ones, in which case all efficiencies should remain 1
+    Array<2, float> data_fan_sums(IndexRange2D(num_physical_rings, num_physical_detectors_per_ring));
+    make_fan_sum_data(data_fan_sums, fan_data);
+    DetectorEfficiencies efficiencies(data_fan_sums.get_index_range());
+    efficiencies.fill(1.F);
+    iterate_efficiencies(efficiencies, data_fan_sums, fan_data);
+    check_if_equal(efficiencies.find_min(), 1.F, "iterate_efficiencies with uniform data: min");
+    check_if_equal(efficiencies.find_max(), 1.F, "iterate_efficiencies with uniform data: max");
+    check_if_zero(KL(fan_data, fan_data, 0.), "KL of identical data");
+
+    // with non-uniform data, the result should not depend on the number of threads
+    for (int ra = data_fan_sums.get_min_index(); ra <= data_fan_sums.get_max_index(); ++ra)
+      for (int a = data_fan_sums[ra].get_min_index(); a <= data_fan_sums[ra].get_max_index(); ++a)
+        data_fan_sums[ra][a] *= 1.F + 0.2F * static_cast<float>(std::sin(0.7 * ra + 0.1 * a));
+    efficiencies.fill(1.F);
+    set_num_threads(1);
+    iterate_efficiencies(efficiencies, data_fan_sums, fan_data);
+    DetectorEfficiencies efficiencies_multiple_threads(data_fan_sums.get_index_range());
+    efficiencies_multiple_threads.fill(1.F);
+    set_num_threads(3);
+    iterate_efficiencies(efficiencies_multiple_threads, data_fan_sums, fan_data);
+    set_default_num_threads();
+    check(efficiencies.find_max() > 1.01F, "iterate_efficiencies with non-uniform data should change the efficiencies");
+    check(efficiencies == efficiencies_multiple_threads, "iterate_efficiencies with 1 and 3 threads");
+  }
 }
 
 END_NAMESPACE_STIR
@@ -0,0 +1,160 @@
+/*!
+
+  \file
+  \ingroup test
+
+  \brief Test program for stir::ProfilingRegistry
+
+  \author STIR contributors
+*/
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+
+#include "stir/ProfilingRegistry.h"
+#include "stir/TimedBlock.h"
+#include "stir/RunTests.h"
+#ifdef STIR_OPENMP
+#  include <omp.h>
+#endif
+#include <iostream>
+#include <sstream>
+
+START_NAMESPACE_STIR
+
+/*!
+  \brief Test class for ProfilingRegistry, ProfilingScope and ProfilingCounter
+  \ingroup test
+*/
+class ProfilingRegistryTests : public RunTests
+{
+public:
+  void run_tests() override;
+
+private:
+  const ProfilingRegistry::ScopeStatistics* find_scope(const std::vector<ProfilingRegistry::ScopeStatistics>& stats,
+                                                       const std::string& path);
+  long long get_counter(const std::string& name);
+};
+
+const ProfilingRegistry::ScopeStatistics*
+ProfilingRegistryTests::find_scope(const std::vector<ProfilingRegistry::ScopeStatistics>& stats, const std::string& path)
+{
+  for (const auto& s : stats)
+    if (s.path == path)
+      return &s;
+  return nullptr;
+}
+
+long long
+ProfilingRegistryTests::get_counter(const std::string& name)
+{
+  for (const auto& c : ProfilingRegistry::instance().get_counter_totals())
+    if (c.name == name)
+      return c.value;
+  return -1;
+}
+
+void
+ProfilingRegistryTests::run_tests()
+{
+  std::cerr << "Tests for ProfilingRegistry\n";
+  ProfilingRegistry& registry = ProfilingRegistry::instance();
+  ProfilingScope outer_scope("outer");
+  ProfilingScope inner_scope("inner");
+  ProfilingCounter counter("test counter");
+
+  {
+    std::cerr << "\tdisabled registry\n";
+    registry.set_enabled(false);
+    registry.reset();
+    {
+      TimedBlock<ProfilingScope> timed_block(outer_scope);
+      counter.add(5);
+    }
+    check(registry.get_scope_statistics().empty(), "no scopes should be recorded when disabled");
+    check_if_equal(get_counter("test counter"), 0LL, "counter should not be incremented when disabled");
+  }
+
+  {
+    std::cerr << "\tnested scopes and counters\n";
+    registry.set_enabled(true);
+    registry.set_record_trace_events(true);
+    registry.reset();
+    for (int i = 0; i < 3; ++i)
+      {
+        TimedBlock<ProfilingScope> timed_block(outer_scope);
+        {
+          TimedBlock<ProfilingScope> inner_timed_block(inner_scope);
+          counter.add(2);
+        }
+      }
+    {
+      TimedBlock<ProfilingScope> timed_block(inner_scope);
+    }
+    const auto stats = registry.get_scope_statistics();
+    check_if_equal(stats.size(), std::size_t(3), "number of scope paths");
+    const auto outer_stats_ptr = find_scope(stats, "outer");
+    const auto nested_stats_ptr = find_scope(stats, "outer/inner");
+    const auto inner_stats_ptr = find_scope(stats, "inner");
+    if (check(outer_stats_ptr && nested_stats_ptr && inner_stats_ptr, "scope paths"))
+      {
+        check_if_equal(outer_stats_ptr->count, std::size_t(3), "count of outer scope");
+        check_if_equal(nested_stats_ptr->count, std::size_t(3), "count of nested scope");
+        check_if_equal(inner_stats_ptr->count, std::size_t(1), "count of inner scope");
+        check(outer_stats_ptr->total_time >= nested_stats_ptr->total_time, "outer scope should take longer than nested");
+        check(outer_stats_ptr->max_time <= outer_stats_ptr->total_time, "max_time <= total_time");
+      }
+    check_if_equal(get_counter("test counter"), 6LL, "counter value");
+
+    std::ostringstream json;
+    registry.write_json(json);
+    check(json.str().find("\"outer/inner\"") != std::string::npos, "JSON report should contain nested path");
+    check(json.str().find("\"test counter\": 6") != std::string::npos, "JSON report should contain counter");
+
+    std::ostringstream trace;
+    registry.write_chrome_trace(trace);
+    check(trace.str().find("\"traceEvents\"") != std::string::npos, "Chrome trace should contain traceEvents");
+    check(trace.str().find("\"ph\": \"X\"") != std::string::npos, "Chrome trace should contain complete events");
+  }
+
+  {
+    std::cerr << "\tmultiple threads\n";
+    registry.reset();
+    const int num_iterations = 100;
+#ifdef STIR_OPENMP
+#  pragma omp parallel for
+#endif
+    for (int i = 0; i < num_iterations; ++i)
+      {
+        TimedBlock<ProfilingScope> timed_block(inner_scope);
+        counter.add(1);
+      }
+    check_if_equal(get_counter("test counter"), static_cast<long long>(num_iterations), "counter summed over threads");
+    const auto stats = registry.get_scope_statistics();
+    const auto inner_stats_ptr = find_scope(stats, "inner");
+    if (check(inner_stats_ptr != nullptr, "scope in threads"))
+      check_if_equal(inner_stats_ptr->count, static_cast<std::size_t>(num_iterations), "count summed over threads");
+  }
+
+  registry.set_enabled(false);
+  registry.set_record_trace_events(false);
+  registry.reset();
+}
+
+END_NAMESPACE_STIR
+
+USING_NAMESPACE_STIR
+
+int
+main()
+{
+  ProfilingRegistryTests tests;
+  tests.run_tests();
+  return tests.main_return_value();
+}
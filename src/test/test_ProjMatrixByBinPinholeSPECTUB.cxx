@@ -0,0 +1,224 @@
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup test
+
+  \brief Test program for the rotational symmetries of stir::ProjMatrixByBinPinholeSPECTUB
+
+  \author STIR contributors
+*/
+
+#include "stir/RunTests.h"
+#include "stir/recon_buildblock/ProjMatrixByBinPinholeSPECTUB.h"
+#include "stir/recon_buildblock/ProjMatrixElemsForOneBin.h"
+#include "stir/IO/InterfilePDFSHeaderSPECT.h"
+#include "stir/VoxelsOnCartesianGrid.h"
+#include "stir/IndexRange3D.h"
+#include "stir/ProjDataInfo.h"
+#include "stir/Bin.h"
+#include "stir/stream.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <map>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+
+START_NAMESPACE_STIR
+
+/*!
+  \ingroup test
+  \brief Test class for the rotational symmetries of ProjMatrixByBinPinholeSPECTUB
+
+  Uses a single-pinhole system with 8 views over 360 degrees, such that every view is related to 3 others by a
+  rotation over a multiple of 90 degrees. Checks that weights derived via these symmetries are the same as
+  weights computed directly, both when keeping all views in memory and when computing views on demand.
+*/
+class ProjMatrixByBinPinholeSPECTUBTests : public RunTests
+{
+public:
+  void run_tests() override;
+
+private:
+  shared_ptr<const ProjDataInfo> proj_data_info_sptr;
+  shared_ptr<const VoxelsOnCartesianGrid<float>> image_sptr;
+  const std::string detector_filename = "test_ProjMatrixByBinPinholeSPECTUB_detector.txt";
+  const std::string collimator_filename = "test_ProjMatrixByBinPinholeSPECTUB_collimator.txt";
+
+  void write_detector_and_collimator_files(const int num_views) const;
+  //! construct and set-up a matrix
+  shared_ptr<ProjMatrixByBinPinholeSPECTUB> construct_matrix(const bool use_rotational_symmetries,
+                                                             const bool keep_all_views_in_cache);
+  //! compare weights of all bins, allowing a difference of \a rel_tolerance times the maximum weight of every bin
+  /*! Voxels that are missing in one of the two are treated as having weight 0. */
+  void compare_weights(const ProjMatrixByBinPinholeSPECTUB& expected,
+                       const ProjMatrixByBinPinholeSPECTUB& result,
+                       const float rel_tolerance,
+                       const std::string& name);
+};
+
+void
+ProjMatrixByBinPinholeSPECTUBTests::write_detector_and_collimator_files(const int num_views) const
+{
+  {
+    std::ofstream detector(detector_filename);
+    detector << "Information of detector\n"
+             << "Number of rings: 1\n"
+             << "#intrinsic PSF#\n"
+             << "Sigma(cm): 0.0361\n"
+             << "Crystal thickness (cm): 0.3\n"
+             << "Crystal attenuation coefficient (cm -1): 4.407\n"
+             << "Nangles: " << num_views << '\n'
+             << "ang0(deg): 180.\n"
+             << "incr(deg): " << 360. / num_views << '\n'
+             << "z0(cm): 0.\n";
+  }
+  {
+    std::ofstream collimator(collimator_filename);
+    collimator << "Information of collimator\n"
+               << "Model (cyl/pol): pol\n"
+               << "Collimator radius(cm): 2.805\n"
+               << "Wall thickness (cm): 1.\n"
+               << "#holes#\n"
+               << "Number of holes: " << num_views << '\n';
+    for (int h = 1; h <= num_views; ++h)
+      collimator << "h" << h << ": " << h << " 0. 0. 0. round 0.1 0.1 0. 0. 45. 45.\n";
+  }
+}
+
+shared_ptr<ProjMatrixByBinPinholeSPECTUB>
+ProjMatrixByBinPinholeSPECTUBTests::construct_matrix(const bool use_rotational_symmetries, const bool keep_all_views_in_cache)
+{
+  shared_ptr<ProjMatrixByBinPinholeSPECTUB> matrix_sptr(new ProjMatrixByBinPinholeSPECTUB);
+  matrix_sptr->set_detector_file(detector_filename);
+  matrix_sptr->set_collimator_file(collimator_filename);
+  matrix_sptr->set_psf_correction("yes");
+  matrix_sptr->set_object_radius(0.35F);
+  matrix_sptr->set_keep_all_views_in_cache(keep_all_views_in_cache);
+  matrix_sptr->set_use_rotational_symmetries(use_rotational_symmetries);
+  matrix_sptr->set_up(proj_data_info_sptr, image_sptr);
+  return matrix_sptr;
+}
+
+void
+ProjMatrixByBinPinholeSPECTUBTests::compare_weights(const ProjMatrixByBinPinholeSPECTUB& expected,
+                                                    const ProjMatrixByBinPinholeSPECTUB& result,
+                                                    const float rel_tolerance,
+                                                    const std::string& name)
+{
+  std::cerr << "Testing " << name << '\n';
+  ProjMatrixElemsForOneBin lor;
+  for (int view_num = proj_data_info_sptr->get_min_view_num(); view_num <= proj_data_info_sptr->get_max_view_num(); ++view_num)
+    {
+      float max_weight_in_view = 0.F;
+      for (int axial_pos_num = proj_data_info_sptr->get_min_axial_pos_num(0);
+           axial_pos_num <= proj_data_info_sptr->get_max_axial_pos_num(0);
+           ++axial_pos_num)
+        for (int tang_pos_num = proj_data_info_sptr->get_min_tangential_pos_num();
+             tang_pos_num <= proj_data_info_sptr->get_max_tangential_pos_num();
+             ++tang_pos_num)
+          {
+            const Bin bin(0, view_num, axial_pos_num, tang_pos_num);
+            // weights per voxel, with the expected weight in the first element
+            std::map<BasicCoordinate<3, int>, std::pair<float, float>> weights;
+            expected.get_proj_matrix_elems_for_one_bin(lor, bin);
+            float max_weight = 0.F;
+            for (const auto& elem : lor)
+              {
+                weights[elem.get_coords()].first += elem.get_value();
+                max_weight = std::max(max_weight, elem.get_value());
+              }
+            result.get_proj_matrix_elems_for_one_bin(lor, bin);
+            for (const auto& elem : lor)
+              weights[elem.get_coords()].second += elem.get_value();
+            max_weight_in_view = std::max(max_weight_in_view, max_weight);
+
+            for (const auto& weight : weights)
+              if (!check(std::abs(weight.second.second - weight.second.first) <= rel_tolerance * max_weight, name + ": weight"))
+                {
+                  std::cerr << "  for bin " << bin << " and voxel " << weight.first << ": " << weight.second.second
+                            << " should be " << weight.second.first << '\n';
+                  return;
+                }
+          }
+    // make sure the test does not pass trivially
+    check(max_weight_in_view > 0.F, name + ": view " + std::to_string(view_num) + " should have non-zero weights");
+    }
+}
+
+void
+ProjMatrixByBinPinholeSPECTUBTests::run_tests()
+{
+  const int num_views = 8;
+  {
+    // construct the projection data info in the same way as when reading a SPECT Interfile header
+    std::ostringstream header;
+    header << "!INTERFILE :=\n"
+           << "!imaging modality := nucmed\n"
+           << "name of data file := dummy.s\n"
+           << "!version of keys := 3.3\n"
+           << "!GENERAL DATA :=\n"
+           << "!GENERAL IMAGE DATA :=\n"
+           << "!type of data := Tomographic\n"
+           << "imagedata byte order := LITTLEENDIAN\n"
+           << "!SPECT STUDY (General) :=\n"
+           << "!number format := float\n"
+           << "!number of bytes per pixel := 4\n"
+           << "!number of projections := " << num_views << '\n'
+           << "!extent of rotation := 360\n"
+           << "process status := acquired\n"
+           << "!SPECT STUDY (acquired data):=\n"
+           << "!direction of rotation := CCW\n"
+           << "start angle := 180\n"
+           << "orbit := Circular\n"
+           << "Radius := 54.8\n"
+           << "!matrix size [1] := 24\n"
+           << "!scaling factor (mm/pixel) [1] := 2\n"
+           << "!matrix size [2] := 24\n"
+           << "!scaling factor (mm/pixel) [2] := 2\n"
+           << "!END OF INTERFILE :=\n";
+    std::istringstream header_stream(header.str());
+    InterfilePDFSHeaderSPECT hdr;
+    if (!check(hdr.parse(header_stream), "parsing SPECT Interfile header"))
+      return;
+    proj_data_info_sptr = hdr.data_info_sptr;
+  }
+  image_sptr.reset(new VoxelsOnCartesianGrid<float>(IndexRange3D(0, 11, -8, 7, -8, 7),
+                                                    CartesianCoordinate3D<float>(0.F, 0.F, 0.F),
+                                                    CartesianCoordinate3D<float>(.5F, .5F, .5F)));
+  write_detector_and_collimator_files(num_views);
+
+  // reference: compute every view
+  shared_ptr<ProjMatrixByBinPinholeSPECTUB> reference_sptr = construct_matrix(false, true);
+  {
+    shared_ptr<ProjMatrixByBinPinholeSPECTUB> matrix_sptr = construct_matrix(true, true);
+    compare_weights(*reference_sptr, *matrix_sptr, 1E-4F, "rotational symmetries (all views in memory)");
+  }
+  {
+    shared_ptr<ProjMatrixByBinPinholeSPECTUB> matrix_sptr = construct_matrix(true, false);
+    compare_weights(*reference_sptr, *matrix_sptr, 1E-4F, "rotational symmetries (views computed on demand)");
+  }
+  std::remove(detector_filename.c_str());
+  std::remove(collimator_filename.c_str());
+}
+
+END_NAMESPACE_STIR
+
+USING_NAMESPACE_STIR
+
+int
+main()
+{
+  ProjMatrixByBinPinholeSPECTUBTests tests;
+  tests.run_tests();
+  return tests.main_return_value();
+}
@@ -0,0 +1,201 @@
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+/*!
+  \file
+  \ingroup test
+
+  \brief Test program for the persistent matrix cache of stir::ProjMatrixByBinSPECTUB
+
+  \author STIR contributors
+*/
+
+#include "stir/RunTests.h"
+#include "stir/recon_buildblock/ProjMatrixByBinSPECTUB.h"
+#include "stir/recon_buildblock/ProjMatrixElemsForOneBin.h"
+#include "stir/IO/InterfilePDFSHeaderSPECT.h"
+#include "stir/VoxelsOnCartesianGrid.h"
+#include "stir/IndexRange3D.h"
+#include "stir/ProjDataInfo.h"
+#include "stir/Bin.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include <filesystem>
+
+START_NAMESPACE_STIR
+
+/*!
+  \ingroup test
+  \brief Test class for the persistent matrix cache of ProjMatrixByBinSPECTUB
+
+  Checks that weights read from the cache are the same as the computed ones (up to the quantisation
+  error if requested), and that quantised and non-quantised weights are stored in different files.
+*/
+class ProjMatrixByBinSPECTUBTests : public RunTests
+{
+public:
+  void run_tests() override;
+
+private:
+  shared_ptr<const ProjDataInfo> proj_data_info_sptr;
+  shared_ptr<const VoxelsOnCartesianGrid<float>> image_sptr;
+
+  //! construct and set-up a matrix
+  shared_ptr<ProjMatrixByBinSPECTUB> construct_matrix(const std::string& cache_directory, const bool quantise);
+  //! compare weights of all bins, allowing a difference of \a rel_tolerance times the maximum weight of every bin
+  void compare_weights(const ProjMatrixByBinSPECTUB& expected,
+                       const ProjMatrixByBinSPECTUB& result,
+                       const float rel_tolerance,
+                       const std::string& name);
+};
+
+shared_ptr<ProjMatrixByBinSPECTUB>
+ProjMatrixByBinSPECTUBTests::construct_matrix(const std::string& cache_directory, const bool quantise)
+{
+  shared_ptr<ProjMatrixByBinSPECTUB> matrix_sptr(new ProjMatrixByBinSPECTUB);
+  // compute all views in set_up, such that the matrix cache files are all read or written there
+  matrix_sptr->set_keep_all_views_in_cache(true);
+  matrix_sptr->set_resolution_model(2.F, 0.02F, /* full_3D = */ false);
+  matrix_sptr->set_matrix_cache_directory(cache_directory);
+  matrix_sptr->set_quantise_matrix_cache(quantise);
+  matrix_sptr->set_up(proj_data_info_sptr, image_sptr);
+  return matrix_sptr;
+}
+
+void
+ProjMatrixByBinSPECTUBTests::compare_weights(const ProjMatrixByBinSPECTUB& expected,
+                                             const ProjMatrixByBinSPECTUB& result,
+                                             const float rel_tolerance,
+                                             const std::string& name)
+{
+  std::cerr << "Testing " << name << '\n';
+  ProjMatrixElemsForOneBin expected_lor, lor;
+  for (int view_num = proj_data_info_sptr->get_min_view_num(); view_num <= proj_data_info_sptr->get_max_view_num(); ++view_num)
+    for (int axial_pos_num = proj_data_info_sptr->get_min_axial_pos_num(0);
+         axial_pos_num <= proj_data_info_sptr->get_max_axial_pos_num(0);
+         ++axial_pos_num)
+      for (int tang_pos_num = proj_data_info_sptr->get_min_tangential_pos_num();
+           tang_pos_num <= proj_data_info_sptr->get_max_tangential_pos_num();
+           ++tang_pos_num)
+        {
+          const Bin bin(0, view_num, axial_pos_num, tang_pos_num);
+          expected.get_proj_matrix_elems_for_one_bin(expected_lor, bin);
+          result.get_proj_matrix_elems_for_one_bin(lor, bin);
+          if (!check_if_equal(expected_lor.size(), lor.size(), name + ": number of elements"))
+            {
+              std::cerr << "  for bin " << bin << '\n';
+              return;
+            }
+          float max_value = 0.F;
+          for (const auto& elem : expected_lor)
+            max_value = std::max(max_value, elem.get_value());
+          ProjMatrixElemsForOneBin::const_iterator expected_iter = expected_lor.begin();
+          for (const auto& elem : lor)
+            {
+              if (!check(elem.get_coords() == expected_iter->get_coords(), name + ": coordinates")
+                  || !check(std::abs(elem.get_value() - expected_iter->get_value()) <= rel_tolerance * max_value,
+                            name + ": weight"))
+                {
+                  std::cerr << std::setprecision(10) << "  for bin " << bin << ": " << elem.get_value() << " should be " << expected_iter->get_value()
+                            << '\n';
+                  return;
+                }
+              ++expected_iter;
+            }
+        }
+}
+
+void
+ProjMatrixByBinSPECTUBTests::run_tests()
+{
+  {
+    // construct the projection data info in the same way as when reading a SPECT Interfile header
+    std::istringstream header("!INTERFILE :=\n"
+                              "!imaging modality := nucmed\n"
+                              "name of data file := dummy.s\n"
+                              "!version of keys := 3.3\n"
+                              "!GENERAL DATA :=\n"
+                              "!GENERAL IMAGE DATA :=\n"
+                              "!type of data := Tomographic\n"
+                              "imagedata byte order := LITTLEENDIAN\n"
+                              "!SPECT STUDY (General) :=\n"
+                              "!number format := float\n"
+                              "!number of bytes per pixel := 4\n"
+                              "!number of projections := 16\n"
+                              "!extent of rotation := 360\n"
+                              "process status := acquired\n"
+                              "!SPECT STUDY (acquired data):=\n"
+                              "!direction of rotation := CW\n"
+                              "start angle := 180\n"
+                              "orbit := Circular\n"
+                              "Radius := 80\n"
+                              "!matrix size [1] := 16\n"
+                              "!scaling factor (mm/pixel) [1] := 4\n"
+                              "!matrix size [2] := 4\n"
+                              "!scaling factor (mm/pixel) [2] := 4\n"
+                              "!END OF INTERFILE :=\n");
+    InterfilePDFSHeaderSPECT hdr;
+    if (!check(hdr.parse(header), "parsing SPECT Interfile header"))
+      return;
+    proj_data_info_sptr = hdr.data_info_sptr;
+  }
+  image_sptr.reset(new VoxelsOnCartesianGrid<float>(
+      IndexRange3D(0, 3, -8, 7, -8, 7), CartesianCoordinate3D<float>(0.F, 0.F, 0.F), CartesianCoordinate3D<float>(4.F, 4.F, 4.F)));
+
+  // reference: no persistent matrix cache
+  shared_ptr<ProjMatrixByBinSPECTUB> reference_sptr = construct_matrix("", false);
+
+  // use a new directory such that the first set_up has to write the cache
+  const std::string cache_directory = "test_ProjMatrixByBinSPECTUB_cache";
+  std::filesystem::remove_all(cache_directory);
+  std::filesystem::create_directory(cache_directory);
+  const auto num_files_in_cache
+      = [&cache_directory]() { return std::distance(std::filesystem::directory_iterator(cache_directory), {}); };
+  const int num_views = proj_data_info_sptr->get_num_views();
+
+  {
+    shared_ptr<ProjMatrixByBinSPECTUB> computed_sptr = construct_matrix(cache_directory, false);
+    check_if_equal(num_files_in_cache(), static_cast<std::ptrdiff_t>(num_views), "one cache file per view");
+    compare_weights(*reference_sptr, *computed_sptr, 0.F, "computed weights (writing the cache)");
+    shared_ptr<ProjMatrixByBinSPECTUB> read_sptr = construct_matrix(cache_directory, false);
+    check_if_equal(num_files_in_cache(), static_cast<std::ptrdiff_t>(num_views), "reading the cache should not write files");
+    compare_weights(*reference_sptr, *read_sptr, 0.F, "weights read from the cache");
+  }
+  {
+    shared_ptr<ProjMatrixByBinSPECTUB> computed_sptr = construct_matrix(cache_directory, true);
+    check_if_equal(num_files_in_cache(),
+                   static_cast<std::ptrdiff_t>(2 * num_views),
+                   "quantised weights should be stored in different cache files");
+    // quantisation is only used for the files
+    compare_weights(*reference_sptr, *computed_sptr, 0.F, "computed weights (writing the quantised cache)");
+    shared_ptr<ProjMatrixByBinSPECTUB> read_sptr = construct_matrix(cache_directory, true);
+    // error is at most half of 1/65535 of the maximum
+    compare_weights(*reference_sptr, *read_sptr, 1.F / 65535, "quantised weights read from the cache");
+    // cache files for non-quantised weights should still be found
+    shared_ptr<ProjMatrixByBinSPECTUB> non_quantised_sptr = construct_matrix(cache_directory, false);
+    compare_weights(*reference_sptr, *non_quantised_sptr, 0.F, "weights read from the cache (after quantised)");
+    check_if_equal(num_files_in_cache(), static_cast<std::ptrdiff_t>(2 * num_views), "no more cache files");
+  }
+  std::filesystem::remove_all(cache_directory);
+}
+
+END_NAMESPACE_STIR
+
+USING_NAMESPACE_STIR
+
+int
+main()
+{
+  ProjMatrixByBinSPECTUBTests tests;
+  tests.run_tests();
+  return tests.main_return_value();
+}
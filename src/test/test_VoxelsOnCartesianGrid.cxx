@@ -30,10 +30,19 @@
 #include "stir/ProjDataInfoCylindricalArcCorr.h"
 #include "stir/Scanner.h"
 #include "stir/IndexRange.h"
+#include "stir/IndexRange3D.h"
+#include "stir/ExamInfo.h"
+#include "stir/IO/interfile.h"
+#include "stir/IO/memory_map.h"
+#include "stir/is_null_ptr.h"
+#include "stir/unique_ptr.h"
+#include "stir/Succeeded.h"
 
 #include <iostream>
 #include <math.h>
 #include <algorithm>
+#include <cstdio>
+#include <string>
 #include "stir/RunTests.h"
 
 using std::cerr;
@@ -51,8 +60,64 @@ class VoxelsOnCartesianGridTests : public RunTests
 {
 public:
   void run_tests() override;
+
+private:
+  //! test reading images with memory mapping (see get_memory_map_input_files())
+  void run_tests_memory_map();
 };
 
+void
+VoxelsOnCartesianGridTests::run_tests_memory_map()
+{
+  cerr << "Tests for reading images with memory mapping\n";
+  const std::string filename = "test_VoxelsOnCartesianGrid_mapped";
+  const std::string header_filename = filename + ".hv";
+  const bool memory_map_input_files = get_memory_map_input_files();
+  set_memory_map_input_files(true);
+
+  shared_ptr<ExamInfo> exam_info_sptr(new ExamInfo);
+  exam_info_sptr->imaging_modality = ImagingModality::PT;
+  // use the index range that read_interfile_image() will construct
+  VoxelsOnCartesianGrid<float> image(exam_info_sptr,
+                                     IndexRange3D(0, 4, -6, 5, -8, 7),
+                                     CartesianCoordinate3D<float>(0, 1, 2),
+                                     CartesianCoordinate3D<float>(3, 4, 5));
+  for (int z = image.get_min_z(); z <= image.get_max_z(); ++z)
+    for (int y = image.get_min_y(); y <= image.get_max_y(); ++y)
+      for (int x = image.get_min_x(); x <= image.get_max_x(); ++x)
+        image[z][y][x] = 100.F * z + 10.F * y + x;
+
+  check(write_basic_interfile(filename, image) == Succeeded::yes, "writing image");
+  {
+    unique_ptr<VoxelsOnCartesianGrid<float>> read_ptr(read_interfile_image(header_filename));
+    if (check(!is_null_ptr(read_ptr), "read_interfile_image with memory mapping"))
+      {
+        check_if_equal(read_ptr->get_index_range(), image.get_index_range(), "index range of memory mapped image");
+        check_if_equal(read_ptr->get_voxel_size(), image.get_voxel_size(), "voxel size of memory mapped image");
+        check(*read_ptr == image, "memory mapped image should be equal to the original");
+        // modifying the data should not modify the file
+        read_ptr->fill(-1.F);
+      }
+  }
+  {
+    unique_ptr<VoxelsOnCartesianGrid<float>> read_ptr(read_interfile_image(header_filename));
+    check(!is_null_ptr(read_ptr) && *read_ptr == image, "modifying a memory mapped image should not change the file");
+  }
+
+  // data that need byte-swapping cannot be mapped, and are read normally
+  check(write_basic_interfile(filename, image, NumericType::FLOAT, 1.F, ByteOrder::swapped) == Succeeded::yes,
+        "writing byte-swapped image");
+  {
+    unique_ptr<VoxelsOnCartesianGrid<float>> read_ptr(read_interfile_image(header_filename));
+    check(!is_null_ptr(read_ptr) && *read_ptr == image, "read_interfile_image should fall back to reading the data");
+  }
+
+  set_memory_map_input_files(memory_map_input_files);
+  std::remove(header_filename.c_str());
+  std::remove((filename + ".ahv").c_str());
+  std::remove((filename + ".v").c_str());
+}
+
 void
 VoxelsOnCartesianGridTests::run_tests()
 
@@ -328,6 +393,8 @@ VoxelsOnCartesianGridTests::run_tests()
                    ffp_image.get_indices_closest_to_LPS_coordinates(ffp_image.get_LPS_coordinates_for_indices(indices)),
                    "FFP inverse consistency");
   }
+
+  run_tests_memory_map();
 }
 
 END_NAMESPACE_STIR
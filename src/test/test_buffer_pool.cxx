@@ -0,0 +1,137 @@
+/*!
+
+  \file
+  \ingroup test
+
+  \brief Test program for the functions in stir/buffer_pool.h
+
+  \author STIR contributors
+*/
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+
+#include "stir/buffer_pool.h"
+#include "stir/IndexRange2D.h"
+#include "stir/RunTests.h"
+
+#include <iostream>
+#include <thread>
+#include <vector>
+
+START_NAMESPACE_STIR
+
+/*!
+  \brief Test class for the buffer pool
+  \ingroup test
+*/
+class BufferPoolTests : public RunTests
+{
+public:
+  void run_tests() override;
+};
+
+void
+BufferPoolTests::run_tests()
+{
+  std::cerr << "Tests for the buffer pool\n";
+  release_buffer_pool_memory();
+  reset_buffer_pool_statistics();
+  const auto initial_stats = get_buffer_pool_statistics();
+
+  {
+    void* ptr = allocate_from_buffer_pool(1000);
+    check(ptr != nullptr, "allocate_from_buffer_pool");
+    deallocate_to_buffer_pool(ptr, 1000);
+    // a slightly smaller request should fall in the same size-class
+    void* ptr2 = allocate_from_buffer_pool(990);
+    check(ptr2 == ptr, "allocate_from_buffer_pool should reuse the block");
+    deallocate_to_buffer_pool(ptr2, 990);
+    const auto stats = get_buffer_pool_statistics();
+    check_if_equal(stats.num_requests - initial_stats.num_requests, std::size_t(2), "num_requests");
+    check_if_equal(stats.num_reuses - initial_stats.num_reuses, std::size_t(1), "num_reuses");
+    check_if_equal(stats.bytes_in_use, initial_stats.bytes_in_use, "bytes_in_use after deallocation");
+    check(stats.peak_bytes_in_use >= 1000, "peak_bytes_in_use");
+  }
+
+  {
+    const IndexRange2D range(-2, 3, 1, 50);
+    Array<2, float> array = make_array_using_buffer_pool<2, float>(range);
+    check(array.get_index_range() == range, "make_array_using_buffer_pool index range");
+    check(array.is_contiguous(), "make_array_using_buffer_pool is contiguous");
+    check_if_zero(array.sum(), "make_array_using_buffer_pool initialises to 0");
+    array.fill(2.F);
+    const float* data_ptr = array.get_const_full_data_ptr();
+    array.release_const_full_data_ptr();
+    array = Array<2, float>();
+    // the memory should now be reused
+    const Array<2, float> array2 = make_array_using_buffer_pool<2, float>(range);
+    check(array2.get_const_full_data_ptr() == data_ptr, "make_array_using_buffer_pool should reuse memory");
+    array2.release_const_full_data_ptr();
+    check_if_zero(array2.sum(), "make_array_using_buffer_pool initialises to 0 when reusing memory");
+  }
+
+  {
+    std::vector<double, BufferPoolAllocator<double>> v(100, 1.);
+    v.resize(1000, 2.);
+    check_if_equal(v[50] + v[500], 3., "BufferPoolAllocator with std::vector");
+  }
+
+  {
+    const std::size_t max_cached_bytes = get_buffer_pool_max_cached_bytes();
+    set_buffer_pool_max_cached_bytes(0);
+    const auto stats_before = get_buffer_pool_statistics();
+    void* ptr = allocate_from_buffer_pool(100);
+    deallocate_to_buffer_pool(ptr, 100);
+    ptr = allocate_from_buffer_pool(100);
+    deallocate_to_buffer_pool(ptr, 100);
+    const auto stats = get_buffer_pool_statistics();
+    check_if_equal(stats.num_reuses, stats_before.num_reuses, "no reuse when max_cached_bytes is 0");
+    set_buffer_pool_max_cached_bytes(max_cached_bytes);
+  }
+
+  {
+    // statistics are kept per thread, and summed when they are requested
+    const auto stats_before = get_buffer_pool_statistics();
+    const int num_threads = 4;
+    const int num_allocations_per_thread = 10;
+    // a block allocated by this thread, but freed by another
+    void* block_freed_by_other_thread = allocate_from_buffer_pool(200);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t)
+      threads.emplace_back([t, block_freed_by_other_thread]() {
+        for (int i = 0; i < num_allocations_per_thread; ++i)
+          deallocate_to_buffer_pool(allocate_from_buffer_pool(1000), 1000);
+        if (t == 0)
+          deallocate_to_buffer_pool(block_freed_by_other_thread, 200);
+      });
+    for (auto& thread : threads)
+      thread.join();
+    const auto stats = get_buffer_pool_statistics();
+    check_if_equal(stats.num_requests - stats_before.num_requests,
+                   std::size_t(num_threads * num_allocations_per_thread + 1),
+                   "num_requests summed over threads");
+    check_if_equal(stats.bytes_in_use, stats_before.bytes_in_use, "bytes_in_use summed over threads");
+  }
+
+#if defined(__unix__) || defined(__APPLE__)
+  check(get_peak_resident_set_size() > 0, "get_peak_resident_set_size");
+#endif
+}
+
+END_NAMESPACE_STIR
+
+USING_NAMESPACE_STIR
+
+int
+main()
+{
+  BufferPoolTests tests;
+  tests.run_tests();
+  return tests.main_return_value();
+}
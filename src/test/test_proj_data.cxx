@@ -22,11 +22,18 @@
 
 #include "stir/ProjDataInMemory.h"
 #include "stir/ProjDataInterfile.h"
+#ifdef HAVE_ZLIB
+#  include "stir/ProjDataCompressed.h"
+#endif
+#include "stir/IO/interfile.h"
+#include "stir/IO/memory_map.h"
 #include "stir/ExamInfo.h"
 #include "stir/ProjDataInfo.h"
 #include "stir/ProjDataInfoCylindricalArcCorr.h"
 #include "stir/Sinogram.h"
 #include "stir/Viewgram.h"
+#include "stir/SegmentBySinogram.h"
+#include "stir/Coordinate3D.h"
 #include "stir/Succeeded.h"
 #include "stir/RunTests.h"
 #include "stir/Scanner.h"
@@ -34,8 +41,12 @@
 #include "stir/numerics/norm.h"
 #include "stir/IndexRange4D.h"
 #include "stir/CPUTimer.h"
+#include "stir/SSRB.h"
+#include "stir/is_null_ptr.h"
 #include <algorithm>
 #include <numeric>
+#include <cstdio>
+#include <fstream>
 
 START_NAMESPACE_STIR
 
@@ -51,6 +62,9 @@ public:
 private:
   void run_tests_on_proj_data(ProjData&);
   void run_tests_in_memory_only(ProjDataInMemory&);
+  void run_tests_memory_map(const ProjDataInMemory&);
+  void run_tests_compressed(const ProjDataInMemory&);
+  void run_tests_SSRB(const shared_ptr<const ProjDataInfo>&, const int num_views_to_combine);
 };
 
 void
@@ -377,6 +391,30 @@ ProjDataTests::run_tests_in_memory_only(ProjDataInMemory& proj_data)
                    viewgram[bin.axial_pos_num()][bin.tangential_pos_num()],
                    "ProjDataInMemory::set_bin_value/get_viewgram not consistent");
   }
+  std::cerr << "\ntest zero-copy segment views\n";
+  {
+    const int segment_num = proj_data.get_max_segment_num();
+    const int timing_pos_num = proj_data.get_max_tof_pos_num();
+    const StridedArrayView<3, float> view = proj_data.get_segment_view_by_sinogram(segment_num, timing_pos_num);
+    check(view.is_contiguous(), "get_segment_view_by_sinogram should be contiguous");
+    Array<3, float> view_data;
+    view.copy_to(view_data);
+    const SegmentBySinogram<float> segment = proj_data.get_segment_by_sinogram(segment_num, timing_pos_num);
+    check_if_equal(view_data, static_cast<const Array<3, float>&>(segment), "get_segment_view_by_sinogram data");
+
+    Bin bin(segment_num,
+            proj_data.get_min_view_num() + 2,
+            proj_data.get_max_axial_pos_num(segment_num),
+            proj_data.get_min_tangential_pos_num() + 3,
+            timing_pos_num);
+    view[Coordinate3D<int>(bin.axial_pos_num(), bin.view_num(), bin.tangential_pos_num())] = 123.F;
+    check_if_equal(proj_data.get_bin_value(bin), 123.F, "get_segment_view_by_sinogram modifies data");
+    const ProjDataInMemory& const_proj_data = proj_data;
+    const StridedArrayView<3, const float> view_by_view = const_proj_data.get_segment_view_by_view(segment_num, timing_pos_num);
+    check_if_equal(view_by_view[Coordinate3D<int>(bin.view_num(), bin.axial_pos_num(), bin.tangential_pos_num())],
+                   123.F,
+                   "get_segment_view_by_view");
+  }
   std::cerr << "test if copy_to is consistent with iterators\n";
   {
     Array<4, float> test_array(IndexRange4D(proj_data.get_num_tof_poss(),
@@ -403,6 +441,181 @@ ProjDataTests::run_tests_in_memory_only(ProjDataInMemory& proj_data)
   }
 }
 
+void
+ProjDataTests::run_tests_memory_map(const ProjDataInMemory& proj_data)
+{
+  std::cerr << "\ntest reading ProjDataInMemory with memory mapping\n";
+  const std::string filename = "test_proj_data_mapped.hs";
+  const bool memory_map_input_files = get_memory_map_input_files();
+  set_memory_map_input_files(true);
+
+  // write data in the order used by ProjDataInMemory
+  {
+    ProjDataInterfile out(proj_data.get_exam_info_sptr(),
+                          proj_data.get_proj_data_info_sptr(),
+                          filename,
+                          std::ios::out,
+                          ProjData::standard_segment_sequence(*proj_data.get_proj_data_info_sptr()),
+                          ProjDataFromStream::Segment_AxialPos_View_TangPos);
+    out.fill(proj_data);
+  }
+  {
+#ifdef __OS_UNIX__
+    shared_ptr<ProjDataInMemory> mapped_sptr(read_interfile_PDFS_memory_mapped(filename));
+    check(!is_null_ptr(mapped_sptr), "read_interfile_PDFS_memory_mapped should succeed");
+    if (!is_null_ptr(mapped_sptr))
+      {
+        check(std::equal(proj_data.begin_all(), proj_data.end_all(), mapped_sptr->begin_all()),
+              "memory mapped data should be equal to the original");
+        // modifying the data should not modify the file
+        mapped_sptr->fill(-1.F);
+      }
+#endif
+    const auto read_sptr = ProjDataInMemory::read_from_file(filename);
+    check(std::equal(proj_data.begin_all(), proj_data.end_all(), read_sptr->begin_all()),
+          "read_from_file with memory mapping");
+  }
+
+  // write data in view order, which cannot be mapped
+  {
+    ProjDataInterfile out(proj_data.get_exam_info_sptr(), proj_data.get_proj_data_info_sptr(), filename, std::ios::out);
+    out.fill(proj_data);
+  }
+  {
+    shared_ptr<ProjDataInMemory> mapped_sptr(read_interfile_PDFS_memory_mapped(filename));
+    check(is_null_ptr(mapped_sptr), "read_interfile_PDFS_memory_mapped should fail for data in view order");
+    const auto read_sptr = ProjDataInMemory::read_from_file(filename);
+    check(std::equal(proj_data.begin_all(), proj_data.end_all(), read_sptr->begin_all()),
+          "read_from_file should fall back to reading the data");
+  }
+
+  set_memory_map_input_files(memory_map_input_files);
+  std::remove(filename.c_str());
+  std::remove("test_proj_data_mapped.s");
+}
+
+#ifdef HAVE_ZLIB
+static std::uint64_t
+get_file_size(const std::string& filename)
+{
+  std::ifstream stream(filename.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+  return static_cast<std::uint64_t>(stream.tellg());
+}
+#endif
+
+void
+ProjDataTests::run_tests_compressed(const ProjDataInMemory& proj_data)
+{
+#ifdef HAVE_ZLIB
+  const std::string filename = "test_proj_data_compressed.hs";
+  for (const ByteOrder byte_order : { ByteOrder(ByteOrder::native), ByteOrder(ByteOrder::swapped) })
+    {
+      const std::string byte_order_name = byte_order.is_native_order() ? " (native byte order)" : " (swapped byte order)";
+      std::cerr << "\ntest writing and reading compressed data" << byte_order_name << "\n";
+      {
+        ProjDataCompressed out(proj_data.get_exam_info_sptr(), proj_data.get_proj_data_info_sptr(), filename, 1, byte_order);
+        check_if_equal(out.get_compressed_size(), std::uint64_t(0), "compressed size of zero data");
+        out.fill(proj_data);
+        check(out.get_compressed_size() > 0, "compressed size after fill");
+      }
+      {
+        shared_ptr<ProjData> in_sptr = ProjData::read_from_file(filename);
+        check(!is_null_ptr(dynamic_cast<ProjDataCompressed*>(in_sptr.get())),
+              "read_from_file should return ProjDataCompressed");
+        const ProjDataInMemory in_memory(*in_sptr);
+        check(std::equal(proj_data.begin_all(), proj_data.end_all(), in_memory.begin_all()),
+              "read compressed data" + byte_order_name);
+      }
+      std::cerr << "\ntest modifying compressed data" << byte_order_name << "\n";
+      const int segment_num = proj_data.get_max_segment_num();
+      const int timing_pos = proj_data.get_max_tof_pos_num();
+      {
+        ProjDataCompressed in_out(filename, std::ios::in | std::ios::out);
+        auto sinogram = proj_data.get_empty_sinogram(0, segment_num, false, timing_pos);
+        sinogram.fill(5.F);
+        check(in_out.set_sinogram(sinogram) == Succeeded::yes, "set_sinogram of compressed data");
+        // use more segments than fit in the cache, such that the first one has to be written before close()
+        for (const int seg_num : { segment_num, -segment_num, 0 })
+          {
+            auto viewgram = in_out.get_viewgram(1, seg_num, false, timing_pos);
+            viewgram.fill(6.F);
+            check(in_out.set_viewgram(viewgram) == Succeeded::yes, "set_viewgram of compressed data");
+          }
+        check_if_equal(in_out.get_viewgram(1, segment_num, false, timing_pos).find_min(), 6.F, "viewgram after cache update");
+      }
+      {
+        const ProjDataCompressed in(filename);
+        const auto sinogram = in.get_sinogram(0, segment_num, false, timing_pos);
+        check_if_equal(sinogram[0][0], 5.F, "modified sinogram of compressed data" + byte_order_name);
+        check_if_equal(sinogram[1][0], 6.F, "modified viewgram of compressed data" + byte_order_name);
+        for (const int seg_num : { -segment_num, 0 })
+          {
+            const auto viewgram = in.get_viewgram(1, seg_num, false, timing_pos);
+            check_if_equal(viewgram.find_min(), 6.F, "modified viewgram of compressed data (min)" + byte_order_name);
+            check_if_equal(viewgram.find_max(), 6.F, "modified viewgram of compressed data (max)" + byte_order_name);
+          }
+        auto expected = proj_data.get_sinogram(1, segment_num, false, timing_pos);
+        expected[1].fill(6.F);
+        check_if_equal(in.get_sinogram(1, segment_num, false, timing_pos), expected, "unmodified views" + byte_order_name);
+        // close() should have removed the old versions of the sinograms and the old index
+        const std::uint64_t index_size = (2 * proj_data.get_num_sinograms() + 1) * sizeof(std::uint64_t) + 8;
+        check_if_equal(get_file_size("test_proj_data_compressed.sz"),
+                       in.get_compressed_size() + index_size,
+                       "size of the data file after modification" + byte_order_name);
+      }
+      std::cerr << "\ntest reading compressed data that was not closed properly" << byte_order_name << "\n";
+      const std::uint64_t file_size = get_file_size("test_proj_data_compressed.sz");
+      {
+        // append some data, as if a sinogram was written but the index was not
+        std::ofstream data_stream("test_proj_data_compressed.sz", std::ios::out | std::ios::app | std::ios::binary);
+        data_stream.write("STIRzidx some data", 18);
+      }
+      {
+        ProjDataCompressed in_out(filename, std::ios::in | std::ios::out);
+        check_if_equal(in_out.get_sinogram(0, segment_num, false, timing_pos)[0][0],
+                       5.F,
+                       "data with the last complete index" + byte_order_name);
+      }
+      check_if_equal(
+          get_file_size("test_proj_data_compressed.sz"), file_size, "size of the data file after repair" + byte_order_name);
+    }
+  std::remove(filename.c_str());
+  std::remove("test_proj_data_compressed.sz");
+#endif
+}
+
+void
+ProjDataTests::run_tests_SSRB(const shared_ptr<const ProjDataInfo>& proj_data_info_sptr, const int num_views_to_combine)
+{
+  std::cerr << "\ntest SSRB\n";
+  shared_ptr<ExamInfo> exam_info_sptr(new ExamInfo);
+  exam_info_sptr->imaging_modality = ImagingModality::PT;
+  ProjDataInMemory in_proj_data(exam_info_sptr, proj_data_info_sptr);
+  // fill every TOF bin with a different value
+  for (int k = in_proj_data.get_min_tof_pos_num(); k <= in_proj_data.get_max_tof_pos_num(); ++k)
+    for (int segment_num = in_proj_data.get_min_segment_num(); segment_num <= in_proj_data.get_max_segment_num(); ++segment_num)
+      {
+        auto segment = in_proj_data.get_empty_segment_by_sinogram(segment_num, false, k);
+        segment.fill(k + 2.F);
+        in_proj_data.set_segment(segment);
+      }
+
+  // rebin to 2D
+  shared_ptr<const ProjDataInfo> out_proj_data_info_sptr(
+      SSRB(*proj_data_info_sptr, 2 * in_proj_data.get_max_segment_num() + 1, num_views_to_combine));
+  ProjDataInMemory out_proj_data(exam_info_sptr, out_proj_data_info_sptr);
+  SSRB(out_proj_data, in_proj_data, /* do_normalisation */ false);
+  check_if_equal(out_proj_data.sum(), in_proj_data.sum(), "SSRB without normalisation should preserve the total");
+
+  SSRB(out_proj_data, in_proj_data, /* do_normalisation */ true);
+  for (int k = out_proj_data.get_min_tof_pos_num(); k <= out_proj_data.get_max_tof_pos_num(); ++k)
+    {
+      const auto segment = out_proj_data.get_segment_by_sinogram(0, k);
+      check_if_equal(segment.find_min(), k + 2.F, "SSRB with normalisation of uniform data (min)");
+      check_if_equal(segment.find_max(), k + 2.F, "SSRB with normalisation of uniform data (max)");
+    }
+}
+
 void
 ProjDataTests::run_tests()
 {
@@ -434,11 +647,23 @@ ProjDataTests::run_tests()
 
     run_tests_on_proj_data(proj_data_in_memory);
     run_tests_in_memory_only(proj_data_in_memory);
+    run_tests_memory_map(proj_data_in_memory);
+    run_tests_compressed(proj_data_in_memory);
+    run_tests_SSRB(proj_data_info_sptr, /* num_views_to_combine */ 5);
 
     std::cerr << "\n-----------------Repeating tests but now with interfile input\n";
 
     ProjDataInterfile(exam_info_sptr, proj_data_info_sptr, "test_proj_data.hs", std::ios::in | std::ios::out | std::ios::trunc);
     run_tests_on_proj_data(proj_data_in_memory);
+#ifdef HAVE_ZLIB
+    std::cerr << "\n-----------------Repeating tests but now with compressed data\n";
+    {
+      ProjDataCompressed proj_data_compressed(exam_info_sptr, proj_data_info_sptr, "test_proj_data_compressed.hs");
+      run_tests_on_proj_data(proj_data_compressed);
+    }
+    std::remove("test_proj_data_compressed.hs");
+    std::remove("test_proj_data_compressed.sz");
+#endif
   }
 
   std::cerr << "\n--------------------------------TOF tests\n";
@@ -465,12 +690,24 @@ ProjDataTests::run_tests()
     std::cerr << "\n----------------- Tests with ProjDataInMemory\n";
     run_tests_on_proj_data(proj_data_in_memory);
     run_tests_in_memory_only(proj_data_in_memory);
+    run_tests_memory_map(proj_data_in_memory);
+    run_tests_compressed(proj_data_in_memory);
+    run_tests_SSRB(proj_data_info_sptr, /* num_views_to_combine */ 2);
 
     std::cerr << "\n-----------------Repeating tests but now with interfile input\n";
 
     ProjDataInterfile proj_data_interfile(
         exam_info_sptr, proj_data_info_sptr, "test_proj_data.hs", std::ios::in | std::ios::out | std::ios::trunc);
     run_tests_on_proj_data(proj_data_interfile);
+#ifdef HAVE_ZLIB
+    std::cerr << "\n-----------------Repeating tests but now with compressed data\n";
+    {
+      ProjDataCompressed proj_data_compressed(exam_info_sptr, proj_data_info_sptr, "test_proj_data_compressed.hs");
+      run_tests_on_proj_data(proj_data_compressed);
+    }
+    std::remove("test_proj_data_compressed.hs");
+    std::remove("test_proj_data_compressed.sz");
+#endif
   }
 }
 END_NAMESPACE_STIR
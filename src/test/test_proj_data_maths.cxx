@@ -26,10 +26,13 @@
 #include "stir/ProjDataInfo.h"
 #include "stir/Sinogram.h"
 #include "stir/Viewgram.h"
+#include "stir/RelatedViewgrams.h"
+#include "stir/TrivialDataSymmetriesForViewSegmentNumbers.h"
 #include "stir/Succeeded.h"
 #include "stir/RunTests.h"
 #include "stir/Scanner.h"
 #include "stir/copy_fill.h"
+#include "stir/apply_elementwise.h"
 #include "stir/error.h"
 #include <string>
 START_NAMESPACE_STIR
@@ -114,6 +117,34 @@ ProjDataInMemoryTests::run_tests(shared_ptr<const ExamInfo> exam_info_sptr, shar
 
   check_proj_data_are_equal_and_non_zero(pd1, pd3, "fill");
 
+  // Check fused element-wise operations
+  {
+    ProjDataInMemory expected(pd1);
+    expected -= x1;
+    const auto f = [a, b](float x, float y, float z) { return a * x + b * y - z; };
+    ProjDataInMemory out(pd1);
+    out.fill(0.F);
+    apply_elementwise(out, f, x1, y1, x1);
+    check_proj_data_are_equal_and_non_zero(expected, out, "apply_elementwise");
+    out.fill(0.F);
+    apply_elementwise_by_segment(out, f, x1, y1, x1);
+    check_proj_data_are_equal_and_non_zero(expected, out, "apply_elementwise_by_segment");
+    // output is also an input
+    ProjDataInMemory x_copy(x1);
+    apply_elementwise(x_copy, f, x_copy, y1, x1);
+    check_proj_data_are_equal_and_non_zero(expected, x_copy, "apply_elementwise in-place");
+    // related viewgrams
+    const shared_ptr<DataSymmetriesForViewSegmentNumbers> symmetries_sptr(new TrivialDataSymmetriesForViewSegmentNumbers);
+    const ViewSegmentNumbers view_seg_nums(pd1.get_max_view_num(), pd1.get_max_segment_num());
+    RelatedViewgrams<float> viewgrams = out.get_empty_related_viewgrams(view_seg_nums, symmetries_sptr);
+    apply_elementwise(viewgrams,
+                      f,
+                      x1.get_related_viewgrams(view_seg_nums, symmetries_sptr),
+                      y1.get_related_viewgrams(view_seg_nums, symmetries_sptr),
+                      x1.get_related_viewgrams(view_seg_nums, symmetries_sptr));
+    check(viewgrams == expected.get_related_viewgrams(view_seg_nums, symmetries_sptr), "apply_elementwise for related viewgrams");
+  }
+
   // clang-format 14.0 makes a complete mess of the stuff below, so we'll switch if off
   // clang-format off
 
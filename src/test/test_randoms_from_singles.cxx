@@ -0,0 +1,201 @@
+/*!
+
+  \file
+  \ingroup test
+
+  \brief Test program for stir::multiply_crystal_factors and stir::randoms_from_singles
+
+  \author STIR contributors
+*/
+/*
+    Copyright (C) 2026, STIR contributors
+    This file is part of STIR.
+
+    SPDX-License-Identifier: Apache-2.0
+
+    See STIR/LICENSE.txt for details
+*/
+
+#include "stir/ProjDataInfoCylindricalNoArcCorr.h"
+#include "stir/ProjDataInfoBlocksOnCylindricalNoArcCorr.h"
+#include "stir/ProjDataInMemory.h"
+#include "stir/DynamicProjData.h"
+#include "stir/ExamInfo.h"
+#include "stir/TimeFrameDefinitions.h"
+#include "stir/Scanner.h"
+#include "stir/Bin.h"
+#include "stir/Sinogram.h"
+#include "stir/DetectionPositionPair.h"
+#include "stir/IndexRange2D.h"
+#include "stir/multiply_crystal_factors.h"
+#include "stir/data/SinglesRates.h"
+#include "stir/data/randoms_from_singles.h"
+#include "stir/RunTests.h"
+#include <iostream>
+#include <vector>
+
+START_NAMESPACE_STIR
+
+/*!
+  \ingroup test
+  \brief Singles with a simple analytic form, used for testing
+*/
+class SinglesRatesForTests : public SinglesRates
+{
+public:
+  std::string get_registered_name() const override { return "SinglesRatesForTests"; }
+
+  float get_singles(const int singles_bin_index, const double start_time, const double end_time) const override
+  {
+    return static_cast<float>((1 + singles_bin_index % 5) * (end_time - start_time));
+  }
+  float get_singles(const DetectionPosition<>& det_pos, const double start_time, const double end_time) const override
+  {
+    return static_cast<float>((1 + det_pos.tangential_coord() % 7 + det_pos.axial_coord()) * (end_time - start_time));
+  }
+};
+
+/*!
+  \ingroup test
+  \brief Test class for multiply_crystal_factors and randoms_from_singles
+*/
+class RandomsFromSinglesTests : public RunTests
+{
+public:
+  void run_tests() override;
+
+protected:
+  void test_multiply_crystal_factors(const shared_ptr<const ProjDataInfo>& proj_data_info_sptr);
+  void test_randoms_from_singles(const shared_ptr<const ProjDataInfo>& proj_data_info_sptr);
+};
+
+void
+RandomsFromSinglesTests::test_multiply_crystal_factors(const shared_ptr<const ProjDataInfo>& proj_data_info_sptr)
+{
+  std::cerr << "\tmultiply_crystal_factors\n";
+  const Scanner& scanner = *proj_data_info_sptr->get_scanner_ptr();
+  Array<2, float> efficiencies(IndexRange2D(scanner.get_num_rings(), scanner.get_num_detectors_per_ring()));
+  for (int r = 0; r < scanner.get_num_rings(); ++r)
+    for (int c = 0; c < scanner.get_num_detectors_per_ring(); ++c)
+      efficiencies[r][c] = 1.F + (c % 11) / 10.F + r / 3.F;
+
+  auto exam_info_sptr = std::make_shared<ExamInfo>();
+  ProjDataInMemory proj_data(exam_info_sptr, proj_data_info_sptr);
+  const float global_factor = 2.F;
+  multiply_crystal_factors(proj_data, efficiencies, global_factor);
+
+  // compare with a direct computation for every bin
+  std::vector<DetectionPositionPair<>> det_pos_pairs;
+  for (int segment_num = proj_data.get_min_segment_num(); segment_num <= proj_data.get_max_segment_num(); ++segment_num)
+    for (int axial_pos_num = proj_data.get_min_axial_pos_num(segment_num);
+         axial_pos_num <= proj_data.get_max_axial_pos_num(segment_num);
+         ++axial_pos_num)
+      {
+        const Sinogram<float> sinogram = proj_data.get_sinogram(axial_pos_num, segment_num);
+        Sinogram<float> expected = sinogram.get_empty_copy();
+        for (int view_num = proj_data.get_min_view_num(); view_num <= proj_data.get_max_view_num(); ++view_num)
+          for (int tang_pos_num = proj_data.get_min_tangential_pos_num(); tang_pos_num <= proj_data.get_max_tangential_pos_num();
+               ++tang_pos_num)
+            {
+              const Bin bin(segment_num, view_num, axial_pos_num, tang_pos_num);
+              if (auto info_ptr = dynamic_cast<const ProjDataInfoCylindricalNoArcCorr*>(proj_data_info_sptr.get()))
+                info_ptr->get_all_det_pos_pairs_for_bin(det_pos_pairs, bin);
+              else
+                dynamic_cast<const ProjDataInfoBlocksOnCylindricalNoArcCorr&>(*proj_data_info_sptr)
+                    .get_all_det_pos_pairs_for_bin(det_pos_pairs, bin);
+              for (const auto& det_pos_pair : det_pos_pairs)
+                expected[view_num][tang_pos_num]
+                    += global_factor * efficiencies[det_pos_pair.pos1().axial_coord()][det_pos_pair.pos1().tangential_coord()]
+                       * efficiencies[det_pos_pair.pos2().axial_coord()][det_pos_pair.pos2().tangential_coord()];
+            }
+        if (!check_if_equal(sinogram, expected, "multiply_crystal_factors vs direct computation"))
+          {
+            std::cerr << "\t\tfor segment " << segment_num << ", axial position " << axial_pos_num << "\n";
+            return;
+          }
+      }
+}
+
+void
+RandomsFromSinglesTests::test_randoms_from_singles(const shared_ptr<const ProjDataInfo>& proj_data_info_sptr)
+{
+  std::cerr << "\trandoms_from_singles for multiple time frames\n";
+  const SinglesRatesForTests singles;
+  const float coincidence_time_window = 4.5e-9F;
+  const float half_life = 6586.F;
+
+  const std::vector<double> start_times{ 0., 100., 400. };
+  const std::vector<double> durations{ 100., 300., 600. };
+  const TimeFrameDefinitions frame_defs(start_times, durations);
+  auto exam_info_sptr = std::make_shared<ExamInfo>();
+  exam_info_sptr->set_time_frame_definitions(frame_defs);
+  DynamicProjData dyn_proj_data(exam_info_sptr);
+  dyn_proj_data.resize(frame_defs.get_num_frames());
+  for (unsigned int frame_num = 1; frame_num <= frame_defs.get_num_frames(); ++frame_num)
+    {
+      auto frame_exam_info_sptr = std::make_shared<ExamInfo>();
+      frame_exam_info_sptr->set_time_frame_definitions(TimeFrameDefinitions(frame_defs, frame_num));
+      dyn_proj_data.set_proj_data_sptr(std::make_shared<ProjDataInMemory>(frame_exam_info_sptr, proj_data_info_sptr), frame_num);
+    }
+  randoms_from_singles(dyn_proj_data, singles, coincidence_time_window, half_life);
+
+  for (unsigned int frame_num = 1; frame_num <= frame_defs.get_num_frames(); ++frame_num)
+    {
+      const ProjData& frame_proj_data = dyn_proj_data.get_proj_data(frame_num);
+      ProjDataInMemory expected(frame_proj_data.get_exam_info_sptr(), proj_data_info_sptr);
+      randoms_from_singles(expected, singles, coincidence_time_window, half_life);
+      for (int segment_num = expected.get_min_segment_num(); segment_num <= expected.get_max_segment_num(); ++segment_num)
+        if (!check_if_equal(frame_proj_data.get_segment_by_sinogram(segment_num),
+                            expected.get_segment_by_sinogram(segment_num),
+                            "randoms_from_singles for all frames vs per frame"))
+          {
+            std::cerr << "\t\tfor frame " << frame_num << ", segment " << segment_num << "\n";
+            return;
+          }
+      check(expected.get_segment_by_sinogram(0).find_max() > 0.F, "randoms_from_singles should give non-zero data");
+    }
+}
+
+void
+RandomsFromSinglesTests::run_tests()
+{
+  {
+    std::cerr << "\n-------- Testing ECAT 953 (span 3, view mashing 2) --------\n";
+    shared_ptr<Scanner> scanner_sptr(new Scanner(Scanner::E953));
+    shared_ptr<const ProjDataInfo> proj_data_info_sptr(
+        ProjDataInfo::construct_proj_data_info(scanner_sptr,
+                                               /*span*/ 3,
+                                               /*max_delta*/ 7,
+                                               /*views*/ scanner_sptr->get_num_detectors_per_ring() / 4,
+                                               /*tang_pos*/ 64,
+                                               /*arc_corrected*/ false));
+    test_multiply_crystal_factors(proj_data_info_sptr);
+    test_randoms_from_singles(proj_data_info_sptr);
+  }
+  {
+    std::cerr << "\n-------- Testing Block Scanner SAFIR --------\n";
+    shared_ptr<Scanner> scanner_sptr(new Scanner(Scanner::SAFIRDualRingPrototype));
+    scanner_sptr->set_scanner_geometry("BlocksOnCylindrical");
+    scanner_sptr->set_up();
+    shared_ptr<const ProjDataInfo> proj_data_info_sptr(
+        ProjDataInfo::construct_proj_data_info(scanner_sptr,
+                                               /*span*/ 1,
+                                               scanner_sptr->get_num_rings() - 1,
+                                               /*views*/ scanner_sptr->get_num_detectors_per_ring() / 2,
+                                               /*tang_pos*/ 64,
+                                               /*arc_corrected*/ false));
+    test_multiply_crystal_factors(proj_data_info_sptr);
+  }
+}
+
+END_NAMESPACE_STIR
+
+USING_NAMESPACE_STIR
+
+int
+main()
+{
+  RandomsFromSinglesTests tests;
+  tests.run_tests();
+  return tests.main_return_value();
+}
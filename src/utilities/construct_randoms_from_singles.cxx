@@ -5,6 +5,28 @@
 
   \brief Construct randoms as a product of singles estimates
 
+  Usage:
+  \verbatim
+  construct_randoms_from_singles out_filename in_norm_filename_prefix template_projdata eff_iter_num
+  \endverbatim
+  uses the (singles) efficiencies as estimated by find_ML_singles_from_delayed.
+  \verbatim
+  construct_randoms_from_singles --singles singles_par_filename [--frames frame_definition_filename] \\
+     out_filename_prefix template_projdata
+  \endverbatim
+  uses randoms_from_singles() for all time frames in one go. The singles are read via
+  a parameter file such as
+  \verbatim
+  Singles Parameters:=
+    Singles Rates type:= SinglesRatesFromGEHDF5
+      SinglesRatesFromGEHDF5 Parameters:=
+        filename:= some_RDF_file
+      End SinglesRatesFromGEHDF5 Parameters:=
+  END:=
+  \endverbatim
+  If no frame definition file is given, the time frames of the template are used.
+  Output filenames are constructed by appending <tt>_f#g1d0b0</tt>.
+
   \author Kris Thielemans
 
 */
@@ -20,7 +42,15 @@
 #include "stir/ML_norm.h"
 
 #include "stir/ProjDataInterfile.h"
+#include "stir/DynamicProjData.h"
+#include "stir/ExamInfo.h"
+#include "stir/TimeFrameDefinitions.h"
+#include "stir/KeyParser.h"
+#include "stir/is_null_ptr.h"
+#include "stir/data/SinglesRates.h"
+#include "stir/data/randoms_from_singles.h"
 #include "stir/multiply_crystal_factors.h"
+#include "stir/format.h"
 #include "stir/stream.h"
 #include "stir/IndexRange2D.h"
 #include "stir/error.h"
@@ -36,12 +66,63 @@ using std::string;
 
 USING_NAMESPACE_STIR
 
+static int
+construct_randoms_from_singles_rates(const string& singles_par_filename,
+                                     const string& frame_definition_filename,
+                                     const string& output_filename_prefix,
+                                     const string& template_filename)
+{
+  shared_ptr<SinglesRates> singles_sptr;
+  KeyParser parser;
+  parser.add_start_key("Singles Parameters");
+  parser.add_parsing_key("Singles Rates type", &singles_sptr);
+  parser.add_stop_key("END");
+  if (parser.parse(singles_par_filename.c_str()) == false || is_null_ptr(singles_sptr))
+    error("Error parsing singles parameters from " + singles_par_filename);
+
+  shared_ptr<ProjData> template_projdata_sptr = ProjData::read_from_file(template_filename);
+  const TimeFrameDefinitions frame_defs = frame_definition_filename.empty()
+                                              ? template_projdata_sptr->get_exam_info().get_time_frame_definitions()
+                                              : TimeFrameDefinitions(frame_definition_filename);
+  if (frame_defs.get_num_frames() == 0)
+    error("Missing time-frame information");
+
+  auto exam_info_sptr = std::make_shared<ExamInfo>(template_projdata_sptr->get_exam_info());
+  exam_info_sptr->set_time_frame_definitions(frame_defs);
+  DynamicProjData proj_data(exam_info_sptr);
+  proj_data.resize(frame_defs.get_num_frames());
+  for (unsigned int frame_num = 1; frame_num <= frame_defs.get_num_frames(); ++frame_num)
+    {
+      auto frame_exam_info_sptr = std::make_shared<ExamInfo>(*exam_info_sptr);
+      frame_exam_info_sptr->set_time_frame_definitions(TimeFrameDefinitions(frame_defs, frame_num));
+      const string filename = format("{}_f{}g1d0b0", output_filename_prefix, frame_num);
+      proj_data.set_proj_data_sptr(
+          std::make_shared<ProjDataInterfile>(
+              frame_exam_info_sptr, template_projdata_sptr->get_proj_data_info_sptr()->create_shared_clone(), filename),
+          frame_num);
+    }
+
+  randoms_from_singles(proj_data, *singles_sptr);
+  return EXIT_SUCCESS;
+}
+
 int
 main(int argc, char** argv)
 {
-  if (argc != 5)
+  if (argc > 1 && string(argv[1]) == "--singles")
+    {
+      if (argc == 5)
+        return construct_randoms_from_singles_rates(argv[2], "", argv[3], argv[4]);
+      if (argc == 7 && string(argv[3]) == "--frames")
+        return construct_randoms_from_singles_rates(argv[2], argv[4], argv[5], argv[6]);
+    }
+  if (argc != 5 || string(argv[1]) == "--singles")
     {
-      cerr << "Usage: " << argv[0] << " out_filename in_norm_filename_prefix template_projdata eff_iter_num\n";
+      cerr << "Usage: " << argv[0] << " out_filename in_norm_filename_prefix template_projdata eff_iter_num\n"
+           << "or\n"
+           << argv[0]
+           << " --singles singles_par_filename [--frames frame_definition_filename] out_filename_prefix template_projdata\n"
+           << "The second form computes randoms from singles for all time frames (of the template, or as specified).\n";
       return EXIT_FAILURE;
     }
   const int eff_iter_num = atoi(argv[4]);
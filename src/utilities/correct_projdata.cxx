@@ -71,6 +71,10 @@ correct_projdata Parameters :=
   ; OBSOLETE
   ;forward_projector type := Ray Tracing
 
+  ; directory where attenuation correction factors computed from the attenuation image
+  ; are stored, such that they can be reused. Defaults to empty (i.e. no cache)
+  ;attenuation correction factors cache directory := acf_cache
+
   ; scatter term to be subtracted AFTER norm+atten correction
   ; defaults to 0
   ; - scatter which should NOT be used here (it would need to be added to randoms and used above)
@@ -118,8 +122,18 @@ Forward projector used to estimate attenuation factors, defaults to
 Ray Tracing. \see stir::ForwardProjectorUsingRayTracing
 This parameter will be removed.
 </li>
+<li>
+attenuation correction factors cache directory:<br>
+Only used with "attenuation image filename". If set, the attenuation correction
+factors are stored in this (existing) directory, such that they are read instead of
+recomputed when correct_projdata is run again with the same attenuation image, projector and
+projection data geometry. \see stir::BinNormalisationFromAttenuationImage
+</li>
 </ul>
 
+Processing is done in parallel over (related) viewgrams if OpenMP is enabled.
+Reading and writing of the projection data is serialised.
+
   \author Kris Thielemans
 
 */
@@ -137,9 +151,12 @@ This parameter will be removed.
 #include "stir/recon_buildblock/BinNormalisationFromAttenuationImage.h"
 #include "stir/TrivialDataSymmetriesForViewSegmentNumbers.h"
 #include "stir/ArrayFunction.h"
+#include "stir/apply_elementwise.h"
 #include "stir/TimeFrameDefinitions.h"
+#include "stir/info.h"
 #include "stir/warning.h"
 #include "stir/error.h"
+#include "stir/format.h"
 #ifndef USE_PMRT
 #  include "stir/recon_buildblock/ForwardProjectorByBinUsingRayTracing.h"
 #else
@@ -151,6 +168,7 @@ This parameter will be removed.
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <atomic>
 
 using std::cerr;
 using std::endl;
@@ -210,10 +228,57 @@ private:
   string norm_filename;
   string randoms_projdata_filename;
   string frame_definition_filename;
+  string acf_cache_directory;
 
   shared_ptr<ArcCorrection> arc_correction_sptr;
 };
 
+namespace detail
+{
+//! Call \a process for all basic view/segment numbers (and all timing positions) of \a proj_data
+/*! This is done in parallel if OpenMP is enabled. \a process has to be thread-safe and is called with a
+    ViewSegmentNumbers object whose \c timing_pos_num() is set. It has to return Succeeded.
+    Exceptions are caught and result in a warning and Succeeded::no.
+*/
+template <class FunctionT>
+static Succeeded
+process_related_viewgrams_in_parallel(const ProjData& proj_data,
+                                      const DataSymmetriesForViewSegmentNumbers& symmetries,
+                                      const FunctionT& process)
+{
+  std::vector<ViewSegmentNumbers> vs_nums_to_process;
+  for (int timing_pos_num = proj_data.get_min_tof_pos_num(); timing_pos_num <= proj_data.get_max_tof_pos_num(); ++timing_pos_num)
+    for (int segment_num = proj_data.get_min_segment_num(); segment_num <= proj_data.get_max_segment_num(); ++segment_num)
+      for (int view_num = proj_data.get_min_view_num(); view_num <= proj_data.get_max_view_num(); ++view_num)
+        {
+          const ViewSegmentNumbers view_seg_nums(view_num, segment_num, timing_pos_num);
+          if (symmetries.is_basic(view_seg_nums))
+            vs_nums_to_process.push_back(view_seg_nums);
+        }
+
+  std::atomic<bool> failed(false);
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
+  for (int i = 0; i < static_cast<int>(vs_nums_to_process.size()); ++i)
+    {
+      if (failed)
+        continue;
+      try
+        {
+          if (process(vs_nums_to_process[i]) != Succeeded::yes)
+            failed = true;
+        }
+      catch (std::exception& e)
+        {
+          warning(e.what());
+          failed = true;
+        }
+    }
+  return failed ? Succeeded::no : Succeeded::yes;
+}
+} // namespace detail
+
 Succeeded
 CorrectProjDataApplication::run() const
 {
@@ -223,125 +288,139 @@ CorrectProjDataApplication::run() const
   const bool do_scatter = !is_null_ptr(scatter_projdata_ptr);
   const bool do_randoms = !is_null_ptr(randoms_projdata_ptr);
 
+  if (do_arc_correction && !apply_or_undo_correction)
+    {
+      error("Cannot undo arc-correction yet. Sorry.");
+      // TODO
+      // arc_correction_sptr->undo_arc_correction(output_viewgrams, viewgrams);
+    }
+
   // TODO
   shared_ptr<DataSymmetriesForViewSegmentNumbers> symmetries_ptr(is_null_ptr(forward_projector_ptr)
                                                                      ? new TrivialDataSymmetriesForViewSegmentNumbers
                                                                      : forward_projector_ptr->get_symmetries_used()->clone());
-  for (int timing_pos_num = output_projdata.get_min_tof_pos_num(); timing_pos_num <= output_projdata.get_max_tof_pos_num();
-       timing_pos_num++)
-    for (int segment_num = output_projdata.get_min_segment_num(); segment_num <= output_projdata.get_max_segment_num();
-         segment_num++)
+
+  // Reading and writing is serialised, as not every ProjData type can be accessed from multiple threads.
+  // Exceptions cannot leave a critical section, so they are caught inside and reported afterwards.
+  const auto read_related_viewgrams = [&symmetries_ptr](const ProjData& proj_data, const ViewSegmentNumbers& view_seg_nums) {
+    RelatedViewgrams<float> viewgrams;
+    bool read_failed = false;
+    std::string error_message;
+#ifdef STIR_OPENMP
+#  pragma omp critical(CORRECTPROJDATAIO)
+#endif
+    try
       {
-        cerr << endl
-             << "Processing segment # " << segment_num << "(and any related segments) of timing position index # "
-             << timing_pos_num << endl;
-        for (int view_num = input_projdata.get_min_view_num(); view_num <= input_projdata.get_max_view_num(); ++view_num)
+        viewgrams = proj_data.get_related_viewgrams(view_seg_nums, symmetries_ptr, false, view_seg_nums.timing_pos_num());
+      }
+    catch (std::exception& e)
+      {
+        read_failed = true;
+        error_message = e.what();
+      }
+    // end of critical section
+    if (read_failed)
+      error(format("correct_projdata: error reading segment {}, view {}: {}",
+                   view_seg_nums.segment_num(),
+                   view_seg_nums.view_num(),
+                   error_message));
+    return viewgrams;
+  };
+
+  info(format("correct_projdata: processing {} segments and {} timing positions",
+              output_projdata.get_num_segments(),
+              output_projdata.get_num_tof_poss()));
+
+  return detail::process_related_viewgrams_in_parallel(
+      output_projdata, *symmetries_ptr, [&](const ViewSegmentNumbers& view_seg_nums) {
+        const int timing_pos_num = view_seg_nums.timing_pos_num();
+        // ** first fill in the data, and add or subtract the background term before normalisation **
+        // This is done in a single pass over the data.
+        // Note that at most one of the scatter and randoms terms is used here.
+        RelatedViewgrams<float> viewgrams
+            = input_projdata.get_empty_related_viewgrams(view_seg_nums, symmetries_ptr, false, timing_pos_num);
+        const float sign = apply_or_undo_correction ? -1.F : 1.F;
+        const ProjData* const background_projdata_ptr
+            = apply_or_undo_correction ? (do_randoms ? randoms_projdata_ptr.get() : nullptr)
+                                       : (do_scatter ? scatter_projdata_ptr.get() : nullptr);
+        if (use_data_or_set_to_1)
           {
-            const ViewSegmentNumbers view_seg_nums(view_num, segment_num);
-            if (!symmetries_ptr->is_basic(view_seg_nums))
-              continue;
-
-            // ** first fill in the data **
-            RelatedViewgrams<float> viewgrams
-                = input_projdata.get_empty_related_viewgrams(view_seg_nums, symmetries_ptr, false, timing_pos_num);
-            if (use_data_or_set_to_1)
-              {
-                viewgrams += input_projdata.get_related_viewgrams(view_seg_nums, symmetries_ptr, false, timing_pos_num);
-              }
+            const RelatedViewgrams<float> data = read_related_viewgrams(input_projdata, view_seg_nums);
+            if (background_projdata_ptr)
+              apply_elementwise(
+                  viewgrams,
+                  [sign](const float value, const float background) { return value + sign * background; },
+                  data,
+                  read_related_viewgrams(*background_projdata_ptr, view_seg_nums));
             else
-              {
-                viewgrams.fill(1.F);
-              }
-
-            if (do_arc_correction && !apply_or_undo_correction)
-              {
-                error("Cannot undo arc-correction yet. Sorry.");
-                // TODO
-                // arc_correction_sptr->undo_arc_correction(output_viewgrams, viewgrams);
-              }
-
-            if (do_scatter && !apply_or_undo_correction)
-              {
-                viewgrams += scatter_projdata_ptr->get_related_viewgrams(view_seg_nums, symmetries_ptr, false, timing_pos_num);
-              }
-
-            if (do_randoms && apply_or_undo_correction)
-              {
-                viewgrams -= randoms_projdata_ptr->get_related_viewgrams(view_seg_nums, symmetries_ptr, false, timing_pos_num);
-              }
-#if 0
-		  if (frame_num==-1)
-		  {
-		int num_frames = frame_def.get_num_frames();
-		for ( int i = 1; i<=num_frames; i++)
-		{ 
-		  //cerr << "Doing frame  " << i << endl; 
-		  const double start_frame = frame_def.get_start_time(i);
-		  const double end_frame = frame_def.get_end_time(i);
-		  //cerr << "Start time " << start_frame << endl;
-		  //cerr << " End time " << end_frame << endl;
-		  // ** normalisation **
-		  if (apply_or_undo_correction)
-		  {
-			normalisation_ptr->apply(viewgrams,start_frame,end_frame);
-		  }
-		  else
-		  {
-			normalisation_ptr->undo(viewgrams,start_frame,end_frame);
-		  }
-		}
-		  }
-
-
-
-		  else
+              viewgrams = data;
+          }
+        else if (background_projdata_ptr)
+          {
+            apply_elementwise(
+                viewgrams,
+                [sign](const float background) { return 1.F + sign * background; },
+                read_related_viewgrams(*background_projdata_ptr, view_seg_nums));
+          }
+        else
+          {
+            viewgrams.fill(1.F);
+          }
+
+        if (apply_or_undo_correction)
+          {
+            normalisation_ptr->apply(viewgrams);
+          }
+        else
+          {
+            normalisation_ptr->undo(viewgrams);
+          }
+
+        if (do_scatter && apply_or_undo_correction)
+          {
+            viewgrams -= read_related_viewgrams(*scatter_projdata_ptr, view_seg_nums);
+          }
+
+        if (do_randoms && !apply_or_undo_correction)
+          {
+            viewgrams += read_related_viewgrams(*randoms_projdata_ptr, view_seg_nums);
+          }
+
+        if (do_arc_correction && apply_or_undo_correction)
+          {
+            viewgrams = arc_correction_sptr->do_arc_correction(viewgrams);
+          }
+
+        // output
+        // Unfortunately, segment range in output_projdata and input_projdata can be
+        // different.
+        // Hence, output_projdata.set_related_viewgrams(viewgrams) would not work.
+        // So, we need an extra viewgrams object to take this into account.
+        // The trick relies on calling Array::operator+= instead of
+        // RelatedViewgrams::operator=
+        RelatedViewgrams<float> output_viewgrams
+            = output_projdata.get_empty_related_viewgrams(view_seg_nums, symmetries_ptr, false, timing_pos_num);
+        output_viewgrams += viewgrams;
+
+        Succeeded success = Succeeded::yes;
+        std::string error_message;
+#ifdef STIR_OPENMP
+#  pragma omp critical(CORRECTPROJDATAIO)
 #endif
-            {
-              if (apply_or_undo_correction)
-                {
-                  normalisation_ptr->apply(viewgrams);
-                }
-              else
-                {
-                  normalisation_ptr->undo(viewgrams);
-                }
-            }
-            if (do_scatter && apply_or_undo_correction)
-              {
-                viewgrams -= scatter_projdata_ptr->get_related_viewgrams(view_seg_nums, symmetries_ptr, false, timing_pos_num);
-              }
-
-            if (do_randoms && !apply_or_undo_correction)
-              {
-                viewgrams += randoms_projdata_ptr->get_related_viewgrams(view_seg_nums, symmetries_ptr, false, timing_pos_num);
-              }
-
-            if (do_arc_correction && apply_or_undo_correction)
-              {
-                viewgrams = arc_correction_sptr->do_arc_correction(viewgrams);
-              }
-
-            // output
-            {
-              // Unfortunately, segment range in output_projdata and input_projdata can be
-              // different.
-              // Hence, output_projdata.set_related_viewgrams(viewgrams) would not work.
-              // So, we need an extra viewgrams object to take this into account.
-              // The trick relies on calling Array::operator+= instead of
-              // RelatedViewgrams::operator=
-              RelatedViewgrams<float> output_viewgrams
-                  = output_projdata.get_empty_related_viewgrams(view_seg_nums, symmetries_ptr, false, timing_pos_num);
-              output_viewgrams += viewgrams;
-
-              if (!(output_projdata.set_related_viewgrams(viewgrams) == Succeeded::yes))
-                {
-                  warning("CorrectProjData: Error set_related_viewgrams\n");
-                  return Succeeded::no;
-                }
-            }
+        try
+          {
+            success = output_projdata.set_related_viewgrams(output_viewgrams);
           }
-      }
-  return Succeeded::yes;
+        catch (std::exception& e)
+          {
+            error_message = e.what();
+            success = Succeeded::no;
+          }
+        // end of critical section
+        if (success != Succeeded::yes)
+          warning("CorrectProjData: Error set_related_viewgrams\n" + error_message);
+        return success;
+      });
 }
 
 void
@@ -360,6 +439,7 @@ CorrectProjDataApplication::set_defaults()
   attenuation_image_ptr.reset();
   frame_num = 1;
   frame_definition_filename = "";
+  acf_cache_directory = "";
 
 #ifndef USE_PMRT
   forward_projector_ptr.reset(new ForwardProjectorByBinUsingRayTracing);
@@ -388,6 +468,7 @@ CorrectProjDataApplication::initialise_keymap()
   parser.add_key("randoms projdata filename", &randoms_projdata_filename);
   parser.add_key("attenuation image filename", &atten_image_filename);
   parser.add_parsing_key("forward projector type", &forward_projector_ptr);
+  parser.add_key("attenuation correction factors cache directory", &acf_cache_directory);
   parser.add_key("scatter_projdata_filename", &scatter_projdata_filename);
   parser.add_key("arc correction", &do_arc_correction);
   parser.add_stop_key("END");
@@ -445,7 +526,7 @@ CorrectProjDataApplication::set_up()
   shared_ptr<ProjDataInfo> output_proj_data_info_sptr;
 
   if (!do_arc_correction)
-    output_proj_data_info_sptr = input_proj_data_info_sptr;
+    output_proj_data_info_sptr = input_proj_data_info_sptr->create_shared_clone();
   else
     {
       arc_correction_sptr = shared_ptr<ArcCorrection>(new ArcCorrection);
@@ -491,9 +572,15 @@ CorrectProjDataApplication::set_up()
   // read attenuation image and add it to the normalisation object
   if (atten_image_filename != "0" && atten_image_filename != "")
     {
-
-      shared_ptr<BinNormalisation> atten_sptr(
+      shared_ptr<BinNormalisationFromAttenuationImage> atten_sptr(
           new BinNormalisationFromAttenuationImage(atten_image_filename, forward_projector_ptr));
+      if (!acf_cache_directory.empty())
+        {
+          atten_sptr->set_attenuation_correction_factors_cache_directory(acf_cache_directory);
+          // the forward projector is not set-up when the factors are read from the cache,
+          // so we cannot use its symmetries
+          forward_projector_ptr.reset();
+        }
 
       normalisation_ptr = shared_ptr<BinNormalisation>(new ChainedBinNormalisation(normalisation_ptr, atten_sptr));
     }
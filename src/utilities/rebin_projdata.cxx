@@ -17,6 +17,7 @@ rebin_projdata Parameters :=
     End FORE Parameters:=
 END:=
 \endverbatim
+  Use <tt>rebinning type := SSRB</tt> for Single Slice Rebinning, see stir::SSRBRebinning.
 
   \author Kris Thielemans
 
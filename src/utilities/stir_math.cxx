@@ -92,8 +92,16 @@
   \code stir_math --accumulate --mult --power -1 in1 in2 \endcode
 
   </ul>
-  \warning There is no check that the data sizes and other info are compatible
-  and the output will have the largest data size in the input,
+  \par Performance
+  Projection data are processed per segment (and TOF bin), such that very large data
+  do not have to fit into memory. The segments of all input files are read in parallel,
+  the calculations are done in parallel over views, and the output segment is written
+  by a background thread while the next segment is being processed. For images
+  (not for parametric images), the calculations are done in parallel over planes.
+  Use the \c OMP_NUM_THREADS environment variable to set the number of threads.
+
+  \warning The data sizes (and number of time frames) of all input data have to be the same,
+  otherwise an error is reported. However, there is no check that other info is compatible,
   and the characteristics (like voxel-size or so) are taken from the first input data.
   Hence, lots of funny effects can happen if data are not compatible.
 
@@ -125,12 +133,16 @@
 #include "stir/stir_math.h"
 #include "stir/warning.h"
 #include "stir/error.h"
+#include "stir/format.h"
 
 #include <fstream>
 #include <iostream>
 #include <functional>
 #include <algorithm>
 #include <memory>
+#include <atomic>
+#include <future>
+#include <type_traits>
 using std::cerr;
 using std::cout;
 using std::endl;
@@ -143,6 +155,50 @@ using std::vector;
 
 USING_NAMESPACE_STIR
 
+//! Apply the manipulations to \a data, in parallel over the first index
+template <int num_dimensions, class FunctionObjectT>
+void
+apply_in_parallel(Array<num_dimensions, float>& data, const FunctionObjectT& pow_times_add_object)
+{
+  const int min_index = data.get_min_index();
+  const int max_index = data.get_max_index();
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
+  for (int i = min_index; i <= max_index; ++i)
+    in_place_apply_function(data[i], pow_times_add_object);
+}
+
+//! Apply the manipulations to \a data (if \a apply_function is \c true), and then add or multiply it to \a result
+/*! Both arrays need to have the same index ranges. The calculation is done in parallel over the first index. */
+template <int num_dimensions, class FunctionObjectT>
+void
+apply_and_combine_in_parallel(Array<num_dimensions, float>& result,
+                              Array<num_dimensions, float>& data,
+                              const bool apply_function,
+                              const bool do_add,
+                              const FunctionObjectT& pow_times_add_object)
+{
+  if (result.get_index_range() != data.get_index_range())
+    error("stir_math: the sizes of the data are not compatible");
+  const int min_index = result.get_min_index();
+  const int max_index = result.get_max_index();
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
+  for (int i = min_index; i <= max_index; ++i)
+    {
+      if (apply_function)
+        in_place_apply_function(data[i], pow_times_add_object);
+      if (do_add)
+        std::transform(
+            result[i].begin_all(), result[i].end_all(), data[i].begin_all(), result[i].begin_all(), std::plus<float>());
+      else
+        std::transform(
+            result[i].begin_all(), result[i].end_all(), data[i].begin_all(), result[i].begin_all(), std::multiplies<float>());
+    }
+}
+
 template <class DataT, class FunctionObjectT>
 void
 process_data(const string& output_file_name,
@@ -155,9 +211,17 @@ process_data(const string& output_file_name,
              const FunctionObjectT& pow_times_add_object,
              const OutputFileFormat<DataT>& output_format)
 {
+  // use parallel processing for images that are arrays of floats
+  constexpr bool is_float_array = std::is_base_of<Array<3, float>, DataT>::value;
+
   unique_ptr<DataT> image_ptr = read_from_file<DataT>(*argv);
   if (!no_math_on_data && !except_first)
-    in_place_apply_function(*image_ptr, pow_times_add_object);
+    {
+      if constexpr (is_float_array)
+        apply_in_parallel<3>(*image_ptr, pow_times_add_object);
+      else
+        in_place_apply_function(*image_ptr, pow_times_add_object);
+    }
 
   shared_ptr<DataT> current_image_ptr;
 
@@ -166,27 +230,34 @@ process_data(const string& output_file_name,
       if (verbose)
         cout << "Reading image " << argv[i] << endl;
       current_image_ptr.reset(DataT::read_from_file(argv[i]));
-      if (!no_math_on_data)
-        in_place_apply_function(*current_image_ptr, pow_times_add_object);
-      if (do_add)
-        {
-          // TODO the next line doesn't work with some DataT, but its replacement is ugly!
-          // also, it would be better to be able to call += on each element
-          //*image_ptr += *current_image_ptr;
-          std::transform(image_ptr->begin_all(),
-                         image_ptr->end_all(),
-                         current_image_ptr->begin_all(),
-                         image_ptr->begin_all(),
-                         std::plus<float>());
-        }
+      if constexpr (is_float_array)
+        apply_and_combine_in_parallel<3>(*image_ptr, *current_image_ptr, !no_math_on_data, do_add, pow_times_add_object);
       else
         {
-          // *image_ptr *= *current_image_ptr;
-          std::transform(image_ptr->begin_all(),
-                         image_ptr->end_all(),
-                         current_image_ptr->begin_all(),
-                         image_ptr->begin_all(),
-                         std::multiplies<float>());
+          if (image_ptr->get_index_range() != current_image_ptr->get_index_range())
+            error("stir_math: the sizes of the data are not compatible");
+          if (!no_math_on_data)
+            in_place_apply_function(*current_image_ptr, pow_times_add_object);
+          if (do_add)
+            {
+              // TODO the next line doesn't work with some DataT, but its replacement is ugly!
+              // also, it would be better to be able to call += on each element
+              //*image_ptr += *current_image_ptr;
+              std::transform(image_ptr->begin_all(),
+                             image_ptr->end_all(),
+                             current_image_ptr->begin_all(),
+                             image_ptr->begin_all(),
+                             std::plus<float>());
+            }
+          else
+            {
+              // *image_ptr *= *current_image_ptr;
+              std::transform(image_ptr->begin_all(),
+                             image_ptr->end_all(),
+                             current_image_ptr->begin_all(),
+                             image_ptr->begin_all(),
+                             std::multiplies<float>());
+            }
         }
     }
 
@@ -212,7 +283,7 @@ process_data(const string& output_file_name,
   for (unsigned int frame_num = 1; frame_num <= (dyn_image_sptr->get_time_frame_definitions()).get_num_frames(); ++frame_num)
     {
       if (!no_math_on_data && !except_first)
-        in_place_apply_function(dyn_image[frame_num], pow_times_add_object);
+        apply_in_parallel<3>(dyn_image[frame_num], pow_times_add_object);
     }
   shared_ptr<DynamicDiscretisedDensity> dyn_current_image_sptr;
 
@@ -222,30 +293,12 @@ process_data(const string& output_file_name,
         cout << "Reading image " << argv[i] << endl;
       dyn_current_image_sptr = read_from_file<DynamicDiscretisedDensity>(argv[i]);
       DynamicDiscretisedDensity& dyn_current_image = *dyn_current_image_sptr;
+      if (dyn_current_image.get_num_time_frames() != dyn_image.get_num_time_frames())
+        error("stir_math: the number of time frames of the data are not compatible");
       for (unsigned int frame_num = 1; frame_num <= (dyn_image_sptr->get_time_frame_definitions()).get_num_frames(); ++frame_num)
         {
-          if (!no_math_on_data)
-            in_place_apply_function(dyn_current_image[frame_num], pow_times_add_object);
-          if (do_add)
-            {
-              // TODO the next line doesn't work with some DataT, but its replacement is ugly!
-              // also, it would be better to be able to call += on each element
-              //*image_ptr += *current_image_ptr;
-              std::transform(dyn_image[frame_num].begin_all(),
-                             dyn_image[frame_num].end_all(),
-                             dyn_current_image[frame_num].begin_all(),
-                             dyn_image[frame_num].begin_all(),
-                             std::plus<float>());
-            }
-          else
-            {
-              // *image_ptr *= *current_image_ptr;
-              std::transform(dyn_image[frame_num].begin_all(),
-                             dyn_image[frame_num].end_all(),
-                             dyn_current_image[frame_num].begin_all(),
-                             dyn_image[frame_num].begin_all(),
-                             std::multiplies<float>());
-            }
+          apply_and_combine_in_parallel<3>(
+              dyn_image[frame_num], dyn_current_image[frame_num], !no_math_on_data, do_add, pow_times_add_object);
         }
     }
 
@@ -313,8 +366,9 @@ main(int argc, char** argv)
            << "using the --max_segment_num_to_process option (unless --accumulate is used).\n"
            << "For example, using 2 as an argument of this option, will read/write"
            << "segments -2,-1,0,1,2.\n\n"
-           << "WARNING: there is no check that the data sizes and other info are compatible "
-           << "and the output will have the largest data size in the input, "
+           << "The data sizes (and number of time frames) of all input data have to be the same, "
+           << "otherwise an error is reported.\n"
+           << "WARNING: there is no check that other info is compatible, "
            << "and the characteristics (like voxel-size or so) are taken from the first input data. "
            << "Hence, lots of funny effects can happen if data are not compatible.\n\n"
            << "WARNING: For future compatibility, it is recommended to put \n"
@@ -609,7 +663,14 @@ main(int argc, char** argv)
       for (int i = 1; i < num_files; ++i)
         all_proj_data[i] = ProjData::read_from_file(argv[i]);
 
-      // do reading/writing in a loop over segments
+      // do reading/writing in a loop over segments (and TOF bins).
+      // The input files are read in parallel, and the output is written by a background thread
+      // while the next segment is processed.
+      std::future<void> write_future;
+      const auto wait_for_write = [&write_future]() {
+        if (write_future.valid())
+          write_future.get();
+      };
       for (int segment_num = out_proj_data_ptr->get_min_segment_num(); segment_num <= out_proj_data_ptr->get_max_segment_num();
            ++segment_num)
         {
@@ -618,24 +679,50 @@ main(int argc, char** argv)
 
           for (int k = out_proj_data_ptr->get_min_tof_pos_num(); k <= out_proj_data_ptr->get_max_tof_pos_num(); ++k)
             {
-              SegmentByView<float> segment_by_view = (*all_proj_data[0]).get_segment_by_view(segment_num, k);
-              if (!no_math_on_data && !except_first)
-                in_place_apply_function(segment_by_view, pow_times_add_object);
-              for (int i = 1; i < num_files; ++i)
+              // when accumulating, the first input is the output, so we cannot read while writing
+              if (accumulate)
+                wait_for_write();
+
+              vector<shared_ptr<SegmentByView<float>>> segments(num_files);
+              std::atomic<bool> read_error(false);
+              std::string read_error_message;
+#ifdef STIR_OPENMP
+#  pragma omp parallel for schedule(dynamic)
+#endif
+              for (int i = 0; i < num_files; ++i)
                 {
-                  SegmentByView<float> current_segment_by_view = (*all_proj_data[i]).get_segment_by_view(segment_num, k);
-                  if (!no_math_on_data)
-                    in_place_apply_function(current_segment_by_view, pow_times_add_object);
-                  if (do_add)
-                    segment_by_view += current_segment_by_view;
-                  else
-                    segment_by_view *= current_segment_by_view;
+                  try
+                    {
+                      segments[i] = std::make_shared<SegmentByView<float>>(all_proj_data[i]->get_segment_by_view(segment_num, k));
+                    }
+                  catch (std::exception& e)
+                    {
+#ifdef STIR_OPENMP
+#  pragma omp critical(STIR_MATH_READ_ERROR)
+#endif
+                      if (read_error_message.empty())
+                        read_error_message = format("{}: {}", argv[i], e.what());
+                      read_error = true;
+                    }
                 }
+              if (read_error)
+                error(format("stir_math: error reading segment {} (TOF bin {}) from {}", segment_num, k, read_error_message));
 
-              if (!(out_proj_data_ptr->set_segment(segment_by_view) == Succeeded::yes))
-                warning("Error set_segment %d\n", segment_num);
+              SegmentByView<float>& segment_by_view = *segments[0];
+              if (!no_math_on_data && !except_first)
+                apply_in_parallel<3>(segment_by_view, pow_times_add_object);
+              for (int i = 1; i < num_files; ++i)
+                apply_and_combine_in_parallel<3>(segment_by_view, *segments[i], !no_math_on_data, do_add, pow_times_add_object);
+
+              wait_for_write();
+              const shared_ptr<SegmentByView<float>> result_sptr = segments[0];
+              write_future = std::async(std::launch::async, [out_proj_data_ptr, result_sptr, segment_num]() {
+                if (!(out_proj_data_ptr->set_segment(*result_sptr) == Succeeded::yes))
+                  warning("Error set_segment %d\n", segment_num);
+              });
             }
         }
+      wait_for_write();
     }
   return EXIT_SUCCESS;
 }
@@ -18,6 +18,15 @@
   This utility performs timings of various operations. This is mostly useful for developers,
   but you could use it to optimise the number of OpenMP threads to use for your data.
 
+  Every case is run a number of times after some (untimed) warm-up runs, and the median and
+  the median absolute deviation (MAD) of the timings are reported. Optionally, the cases are run
+  for a list of number of threads. Results are written in a tab-separated format to stdout,
+  which can be stored and used as a baseline for a later run, in which case
+  regressions will be reported.
+
+  Input data can be given as a template projection data file, or synthetic data can be
+  generated for one of the scanners in the list of supported scanners.
+
   Run the utility without any arguments to get a help message.
   If you want to know what is actually timed, you will have to look at the source code.
 */
@@ -25,12 +34,18 @@
 #include "stir/KeyParser.h"
 #include "stir/ProjDataInterfile.h"
 #include "stir/ProjDataInMemory.h"
+#include "stir/ProjDataInfo.h"
+#include "stir/Scanner.h"
 #include "stir/DiscretisedDensity.h"
 #include "stir/VoxelsOnCartesianGrid.h"
+#include "stir/TimedObject.h"
 #include "stir/IO/read_from_file.h"
 #include "stir/IO/write_to_file.h"
 #ifndef MINI_STIR
 #  include "stir/recon_buildblock/ProjectorByBinPairUsingProjMatrixByBin.h"
+#  include "stir/recon_buildblock/ProjectorByBinPairUsingSeparateProjectors.h"
+#  include "stir/recon_buildblock/ForwardProjectorByBinUsingRayTracing.h"
+#  include "stir/recon_buildblock/BackProjectorByBinUsingInterpolation.h"
 #endif
 #ifdef STIR_WITH_Parallelproj_PROJECTOR
 #  include "stir/recon_buildblock/Parallelproj_projector/ProjectorByBinPairUsingParallelproj.h"
@@ -39,6 +54,17 @@
 #  include "stir/recon_buildblock/ProjMatrixByBinUsingRayTracing.h"
 #  include "stir/recon_buildblock/PoissonLogLikelihoodWithLinearModelForMeanAndProjData.h"
 #  include "stir/recon_buildblock/RelativeDifferencePrior.h"
+#  include "stir/recon_buildblock/QuadraticPrior.h"
+#  include "stir/recon_buildblock/PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin.h"
+#  include "stir/listmode/LmToProjData.h"
+#  include "stir/listmode/ListModeData.h"
+#  include "stir/analytic/FBP2D/FBP2DReconstruction.h"
+#  include "stir/analytic/FBP3DRP/FBP3DRPReconstruction.h"
+#  include "stir/scatter/SingleScatterSimulation.h"
+#  include "stir/SeparableGaussianImageFilter.h"
+#  include "stir/MedianImageFilter3D.h"
+#  include "stir/ML_norm.h"
+#  include "stir/IndexRange2D.h"
 #  ifdef STIR_WITH_CUDA
 #    include "stir/recon_buildblock/CUDA/CudaRelativeDifferencePrior.h"
 #  endif
@@ -50,22 +76,44 @@
 #include "stir/num_threads.h"
 #include "stir/Verbosity.h"
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <cstdlib>
+#include <cstring>
 #include <iomanip>
 #include <chrono>
 #include <thread>
+#include <algorithm>
+#include <cmath>
+#include <map>
 
 static void
 print_usage_and_exit()
 {
   std::cerr << "\nUsage:\nstir_timings [--name some_string] [--threads num_threads] [--runs num_runs]\\\n"
+            << "\t[--warmup num_warmup_runs] [--samples num_samples] [--thread-sweep n1,n2,...]\\\n"
             << "\t[--skip-BB 1] [--skip-PP 1] [--skip-PMRT 1] [--skip-priors 1]\\\n"
+            << "\t[--skip-interp 1] [--skip-filters 1] [--skip-FBP 1] [--skip-scatter 1] [--skip-MLnorm 1]\\\n"
             << "\t[--projector_par_filename parfile]\\\n"
             << "\t[--image image_filename]\\\n"
-            << "\t--template-projdata template_proj_data_filename\n\n"
-            << "skip BB: basic building blocks; PP: Parallelproj; PMRT: ray-tracing matrix; priors: prior timing\n\n"
-            << "Timings are reported to stdout as:\n"
-            << "name\ttiming_name\tCPU_time_in_ms\twall-clock_time_in_ms\n";
+            << "\t[--listmode listmode_filename] [--lm-events num_events]\\\n"
+            << "\t[--baseline baseline_filename] [--tolerance relative_tolerance]\\\n"
+            << "\t{--template-projdata template_proj_data_filename | --scanner scanner_name [--span span]}\n"
+            << "or\nstir_timings --list-scanners\n\n"
+            << "skip BB: basic building blocks; PP: Parallelproj; PMRT: ray-tracing matrix; priors: prior timing\n"
+            << "interp: ray-tracing forward and interpolating back projector; FBP: FBP2D and FBP3DRP;\n"
+            << "scatter: single scatter simulation; MLnorm: ML estimation of detector efficiencies.\n"
+            << "List-mode objective function and LmToProjData cases are only run when list-mode data is given\n"
+            << "(using the first num_events events, default 1000000, or all events when 0).\n\n"
+            << "With --scanner, synthetic (non-TOF) data is generated for the scanner (default span 11).\n\n"
+            << "Every case is run num_warmup_runs (default 1) times without timing, and then num_samples (default 5) times.\n"
+            << "Each sample repeats the operation a number of times (depending on the case and num_runs, default 3).\n"
+            << "Timings are reported to stdout (as tab-separated values, with a header line starting with #) as:\n"
+            << "name\ttiming_name\tnum_threads\tnum_samples\tCPU_time_in_ms\twall-clock_time_in_ms\twall-clock_MAD_in_ms\n"
+            << "where times are medians over the samples.\n"
+            << "Save this output to use as baseline for a later run. A case is reported as regression if its wall-clock time\n"
+            << "is larger than (1+tolerance) times (default 0.1) the baseline, and the difference is larger than 3 MADs.\n"
+            << "The exit status is then non-zero.\n";
   std::cerr << "\nExample projector-pair par-file (the following corresponds to the PMRT configuration normally used)\n"
             << "projector pair parameters:=\n"
             << "   type := Matrix\n"
@@ -82,6 +130,135 @@ print_usage_and_exit()
 
 START_NAMESPACE_STIR
 
+//! median of a list of values
+static double
+median(std::vector<double> values)
+{
+  if (values.empty())
+    return 0.;
+  const std::size_t mid = values.size() / 2;
+  std::nth_element(values.begin(), values.begin() + mid, values.end());
+  const double upper = values[mid];
+  if (values.size() % 2 == 1)
+    return upper;
+  return (upper + *std::max_element(values.begin(), values.begin() + mid)) / 2;
+}
+
+//! median absolute deviation from the median
+static double
+median_absolute_deviation(const std::vector<double>& values)
+{
+  const double m = median(values);
+  std::vector<double> deviations;
+  for (const double v : values)
+    deviations.push_back(std::abs(v - m));
+  return median(deviations);
+}
+
+//! Results for a single case (times in ms)
+struct TimingResult
+{
+  std::string name;
+  std::string item;
+  int num_threads;
+  unsigned num_samples;
+  double CPU_median;
+  double wall_clock_median;
+  double wall_clock_MAD;
+};
+
+static void
+print_header(std::ostream& s)
+{
+  s << "#name\ttiming_name\tnum_threads\tnum_samples\tCPU_time_in_ms\twall-clock_time_in_ms\twall-clock_MAD_in_ms\n";
+}
+
+static void
+print_result(std::ostream& s, const TimingResult& result)
+{
+  s << result.name << '\t' << std::setw(32) << std::left << result.item << '\t' << std::setw(4) << std::right
+    << result.num_threads << '\t' << std::setw(4) << result.num_samples << '\t' << std::fixed << std::setprecision(3)
+    << std::setw(24) << std::right << result.CPU_median << '\t' << std::setw(24) << result.wall_clock_median << '\t'
+    << std::setw(16) << result.wall_clock_MAD << std::endl;
+}
+
+//! remove leading and trailing white space
+static std::string
+trim(const std::string& str)
+{
+  const auto first = str.find_first_not_of(" \t");
+  if (first == std::string::npos)
+    return "";
+  const auto last = str.find_last_not_of(" \t");
+  return str.substr(first, last - first + 1);
+}
+
+//! read results in the format written by print_result(), keyed by timing_name and num_threads
+static std::map<std::pair<std::string, int>, TimingResult>
+read_baseline(const std::string& filename)
+{
+  std::ifstream s(filename);
+  if (!s)
+    error("stir_timings: error opening baseline file " + filename);
+  std::map<std::pair<std::string, int>, TimingResult> results;
+  std::string line;
+  while (std::getline(s, line))
+    {
+      if (line.empty() || line[0] == '#')
+        continue;
+      std::vector<std::string> fields;
+      std::istringstream line_stream(line);
+      std::string field;
+      while (std::getline(line_stream, field, '\t'))
+        fields.push_back(field);
+      if (fields.size() != 7)
+        {
+          warning("stir_timings: ignoring line in baseline file: " + line);
+          continue;
+        }
+      TimingResult result;
+      result.name = fields[0];
+      result.item = trim(fields[1]);
+      result.num_threads = std::atoi(fields[2].c_str());
+      result.num_samples = static_cast<unsigned>(std::atoi(fields[3].c_str()));
+      result.CPU_median = std::atof(fields[4].c_str());
+      result.wall_clock_median = std::atof(fields[5].c_str());
+      result.wall_clock_MAD = std::atof(fields[6].c_str());
+      results[std::make_pair(result.item, result.num_threads)] = result;
+    }
+  return results;
+}
+
+//! compare results with the baseline, write a report to stderr and return the number of regressions
+static int
+compare_with_baseline(const std::vector<TimingResult>& results,
+                      const std::map<std::pair<std::string, int>, TimingResult>& baseline,
+                      const double tolerance)
+{
+  int num_regressions = 0;
+  std::cerr << "\nComparison with baseline (ratio of wall-clock times):\n";
+  for (const auto& result : results)
+    {
+      const auto iter = baseline.find(std::make_pair(result.item, result.num_threads));
+      if (iter == baseline.end())
+        {
+          std::cerr << std::setw(40) << std::left << result.item << '\t' << result.num_threads << "\tnot in baseline\n";
+          continue;
+        }
+      const TimingResult& base = iter->second;
+      const double ratio = base.wall_clock_median > 0 ? result.wall_clock_median / base.wall_clock_median : 1.;
+      const double noise = 3 * std::max(result.wall_clock_MAD, base.wall_clock_MAD);
+      const bool regression = result.wall_clock_median > base.wall_clock_median * (1 + tolerance)
+                              && result.wall_clock_median - base.wall_clock_median > noise;
+      if (regression)
+        ++num_regressions;
+      std::cerr << std::setw(40) << std::left << result.item << '\t' << result.num_threads << '\t' << std::fixed
+                << std::setprecision(3) << ratio << (regression ? "\tREGRESSION" : "") << '\n';
+    }
+  std::cerr << num_regressions << " regression(s) found\n";
+  return num_regressions;
+}
+
 class Timings : public TimedObject
 {
   typedef void (Timings::*TimedFunction)();
@@ -90,10 +267,20 @@ public:
   //! Use as prefix for all output
   std::string name;
   // variables that select timings
-  bool skip_BB;     //! skip basic building blocks
-  bool skip_PMRT;   //! skip ProjMatrixByBinUsingRayTracing
-  bool skip_PP;     //! skip Parallelproj
-  bool skip_priors; //! skip GeneralisedPrior
+  bool skip_BB;      //! skip basic building blocks
+  bool skip_PMRT;    //! skip ProjMatrixByBinUsingRayTracing
+  bool skip_PP;      //! skip Parallelproj
+  bool skip_priors;  //! skip GeneralisedPrior
+  bool skip_interp;  //! skip ray-tracing forward projector and interpolating back projector
+  bool skip_filters; //! skip image filters
+  bool skip_FBP;     //! skip analytic reconstructions
+  bool skip_scatter; //! skip scatter simulation
+  bool skip_MLnorm;  //! skip ML estimation of detector efficiencies
+  // variables for the statistics
+  unsigned num_warmup_runs;
+  unsigned num_samples;
+  int num_threads;
+  std::vector<TimingResult> results;
   // variables used for running timings
   shared_ptr<VoxelsOnCartesianGrid<float>> image_sptr;
   shared_ptr<ProjData> output_proj_data_sptr;
@@ -115,9 +302,31 @@ public:
   shared_ptr<PoissonLogLikelihoodWithLinearModelForMeanAndProjData<DiscretisedDensity<3, float>>> objective_function_sptr;
 
   shared_ptr<GeneralisedPrior<DiscretisedDensity<3, float>>> prior_sptr;
+
+  shared_ptr<ProjectorByBinPair> interp_projectors_sptr;
+  shared_ptr<DataProcessor<DiscretisedDensity<3, float>>> filter_sptr;
+  shared_ptr<SingleScatterSimulation> scatter_simulation_sptr;
+  shared_ptr<ListModeData> lm_data_sptr;
+  long lm_num_events_to_store = 0;
+  shared_ptr<PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin<DiscretisedDensity<3, float>>>
+      lm_objective_function_sptr;
+  shared_ptr<ProjDataInMemory> ML_norm_proj_data_sptr;
+  FanProjData ML_norm_fan_data;
 #endif
   // basic methods
   Timings(const std::string& image_filename, const std::string& template_proj_data_filename)
+      : skip_BB(false),
+        skip_PMRT(false),
+        skip_PP(false),
+        skip_priors(false),
+        skip_interp(false),
+        skip_filters(false),
+        skip_FBP(false),
+        skip_scatter(false),
+        skip_MLnorm(false),
+        num_warmup_runs(1),
+        num_samples(5),
+        num_threads(1)
   {
     if (!image_filename.empty())
       this->image_sptr = read_from_file<VoxelsOnCartesianGrid<float>>(image_filename);
@@ -126,7 +335,18 @@ public:
       this->template_proj_data_sptr = ProjData::read_from_file(template_proj_data_filename);
   }
 
-  void run_it(TimedFunction f, const std::string& item, const unsigned runs = 1);
+  //! generate a template for a scanner in the list of supported scanners
+  void set_up_synthetic_template(const std::string& scanner_name, const int span);
+#ifndef MINI_STIR
+  void set_listmode_data(const std::string& listmode_filename, const long num_events_to_store);
+#endif
+
+  //! time a function and append the results
+  /*!
+    Every sample calls the function \a runs times. If \a repeat is \c false, warm-up runs are not
+    performed and only a single sample is taken (useful for set-up functions, or to time the first call).
+   */
+  void run_it(TimedFunction f, const std::string& item, const unsigned runs = 1, const bool repeat = true);
   void run_projectors(const std::string& prefix, const shared_ptr<ProjectorByBinPair> proj_sptr, const unsigned runs);
   void run_all(const unsigned runs = 1);
   void init();
@@ -293,35 +513,169 @@ public:
     v += 2; // to avoid compiler warning about unused variable
     delete im;
   }
+
+  void filter_image()
+  {
+    auto im = this->image_sptr->clone();
+    this->filter_sptr->apply(*im);
+    delete im;
+  }
+
+  void FBP2D()
+  {
+    FBP2DReconstruction recon(this->mem_proj_data_sptr);
+    shared_ptr<DiscretisedDensity<3, float>> output_sptr(this->image_sptr->get_empty_copy());
+    if (recon.set_up(output_sptr) != Succeeded::yes || recon.reconstruct(output_sptr) != Succeeded::yes)
+      error("FBP2D failed");
+  }
+
+  void FBP3DRP()
+  {
+    FBP3DRPReconstruction recon;
+    recon.set_input_data(this->mem_proj_data_sptr);
+    recon.set_output_filename_prefix("my_timings_FBP3DRP");
+    shared_ptr<DiscretisedDensity<3, float>> output_sptr(this->image_sptr->get_empty_copy());
+    if (recon.set_up(output_sptr) != Succeeded::yes || recon.reconstruct(output_sptr) != Succeeded::yes)
+      error("FBP3DRP failed");
+  }
+
+  void scatter_simulation()
+  {
+    if (this->scatter_simulation_sptr->process_data() != Succeeded::yes)
+      error("scatter simulation failed");
+  }
+
+  void ML_norm_make_fan_data()
+  {
+    make_fan_data_remove_gaps(this->ML_norm_fan_data, *this->ML_norm_proj_data_sptr);
+  }
+
+  DetectorEfficiencies ML_norm_create_efficiencies() const
+  {
+    DetectorEfficiencies efficiencies(IndexRange2D(this->ML_norm_fan_data.get_min_ra(),
+                                                   this->ML_norm_fan_data.get_max_ra(),
+                                                   this->ML_norm_fan_data.get_min_a(),
+                                                   this->ML_norm_fan_data.get_max_a()));
+    efficiencies.fill(1.F);
+    return efficiencies;
+  }
+
+  void ML_norm_fan_sums()
+  {
+    Array<2, float> data_fan_sums = this->ML_norm_create_efficiencies();
+    make_fan_sum_data(data_fan_sums, this->ML_norm_fan_data);
+  }
+
+  void ML_norm_fan_sums_from_proj_data()
+  {
+    const Scanner& scanner = *this->ML_norm_proj_data_sptr->get_proj_data_info_sptr()->get_scanner_ptr();
+    Array<2, float> data_fan_sums(IndexRange2D(scanner.get_num_rings(), scanner.get_num_detectors_per_ring()));
+    make_fan_sum_data(data_fan_sums, *this->ML_norm_proj_data_sptr);
+  }
+
+  void ML_norm_apply_efficiencies()
+  {
+    apply_efficiencies(this->ML_norm_fan_data, this->ML_norm_create_efficiencies());
+  }
+
+  void ML_norm_block_data()
+  {
+    const Scanner& scanner = *this->ML_norm_proj_data_sptr->get_proj_data_info_sptr()->get_scanner_ptr();
+    BlockData3D block_data(scanner.get_num_axial_blocks(),
+                           scanner.get_num_transaxial_blocks(),
+                           scanner.get_num_axial_blocks() - 1,
+                           scanner.get_num_transaxial_blocks() - 1);
+    make_block_data(block_data, this->ML_norm_fan_data);
+  }
+
+  void ML_norm_efficiencies()
+  {
+    const DetectorEfficiencies data_fan_sums = this->ML_norm_create_efficiencies();
+    DetectorEfficiencies efficiencies = this->ML_norm_create_efficiencies();
+    // model is just all ones
+    iterate_efficiencies(efficiencies, data_fan_sums, this->ML_norm_fan_data);
+  }
+
+  void lm_to_projdata()
+  {
+    this->lm_data_sptr->reset();
+    LmToProjData application;
+    application.set_input_data(this->lm_data_sptr);
+    shared_ptr<ProjData> output_sptr
+        = std::make_shared<ProjDataInMemory>(this->lm_data_sptr->get_exam_info_sptr(), this->lm_data_sptr->get_proj_data_info_sptr());
+    application.set_output_projdata_sptr(output_sptr);
+    application.set_num_events_to_store(this->lm_num_events_to_store);
+    if (application.set_up() != Succeeded::yes)
+      error("LmToProjData set_up failed");
+    application.process_data();
+  }
+
+  void lm_obj_func_set_up()
+  {
+    this->lm_objective_function_sptr->set_up(this->image_sptr);
+  }
+
+  void lm_obj_func_grad_no_sens()
+  {
+    auto im = this->image_sptr->clone();
+    this->lm_objective_function_sptr->compute_sub_gradient_without_penalty_plus_sensitivity(*im, *this->image_sptr, 0);
+    delete im;
+  }
 #endif
 };
 
 void
-Timings::run_it(TimedFunction f, const std::string& item, const unsigned runs)
+Timings::run_it(TimedFunction f, const std::string& item, const unsigned runs, const bool repeat)
 {
-  this->start_timers(true);
-  for (unsigned r = runs; r != 0; --r)
-    (this->*f)();
-  this->stop_timers();
-  std::cout << name << '\t' << std::setw(32) << std::left << item << '\t' << std::fixed << std::setprecision(3) << std::setw(24)
-            << std::right << this->get_CPU_timer_value() / runs * 1000 << '\t' << std::fixed << std::setprecision(3)
-            << std::setw(24) << std::right << this->get_wall_clock_timer_value() / runs * 1000 << std::endl;
+  std::vector<double> CPU_times;
+  std::vector<double> wall_clock_times;
+  try
+    {
+      if (repeat)
+        for (unsigned w = this->num_warmup_runs; w != 0; --w)
+          (this->*f)();
+      const unsigned this_num_samples = repeat ? std::max(this->num_samples, 1U) : 1U;
+      for (unsigned sample = 0; sample != this_num_samples; ++sample)
+        {
+          this->start_timers(true);
+          for (unsigned r = runs; r != 0; --r)
+            (this->*f)();
+          this->stop_timers();
+          CPU_times.push_back(this->get_CPU_timer_value() / runs * 1000);
+          wall_clock_times.push_back(this->get_wall_clock_timer_value() / runs * 1000);
+        }
+    }
+  catch (const std::exception& e)
+    {
+      warning("stir_timings: " + item + " failed: " + e.what());
+      return;
+    }
+  TimingResult result;
+  result.name = this->name;
+  result.item = item;
+  result.num_threads = this->num_threads;
+  result.num_samples = static_cast<unsigned>(wall_clock_times.size());
+  result.CPU_median = median(CPU_times);
+  result.wall_clock_median = median(wall_clock_times);
+  result.wall_clock_MAD = median_absolute_deviation(wall_clock_times);
+  this->results.push_back(result);
+  print_result(std::cout, result);
 }
 
 void
 Timings::run_projectors(const std::string& prefix, const shared_ptr<ProjectorByBinPair> proj_sptr, const unsigned runs)
 {
   this->projectors_sptr = proj_sptr;
-  this->run_it(&Timings::projector_setup, prefix + "_projector_setup", 1);
-  this->run_it(&Timings::forward_file, prefix + "_forward_file_first", 1);
+  this->run_it(&Timings::projector_setup, prefix + "_projector_setup", 1, false);
+  this->run_it(&Timings::forward_file, prefix + "_forward_file_first", 1, false);
   this->run_it(&Timings::forward_file, prefix + "_forward_file", runs);
   this->run_it(&Timings::forward_memory, prefix + "_forward_memory", runs);
-  this->run_it(&Timings::back_file, prefix + "_back_file_first", 1);
+  this->run_it(&Timings::back_file, prefix + "_back_file_first", 1, false);
   this->run_it(&Timings::back_file, prefix + "_back_file", runs);
   this->run_it(&Timings::back_memory, prefix + "_back_memory", runs);
 #ifndef MINI_STIR
   this->objective_function_sptr->set_projector_pair_sptr(this->projectors_sptr);
-  this->run_it(&Timings::obj_func_set_up, prefix + "_LogLik set_up", 1);
+  this->run_it(&Timings::obj_func_set_up, prefix + "_LogLik set_up", 1, false);
   this->run_it(&Timings::obj_func_grad_no_sens, prefix + "_LogLik grad_no_sens", 1);
 #endif
 }
@@ -364,6 +718,10 @@ Timings::run_all(const unsigned runs)
     {
       this->run_projectors("PMRT", this->pmrt_projectors_sptr, 1);
     }
+  if (!this->skip_interp)
+    {
+      this->run_projectors("interp", this->interp_projectors_sptr, runs);
+    }
 #endif
 #ifdef STIR_WITH_Parallelproj_PROJECTOR
   if (!skip_PP)
@@ -387,6 +745,13 @@ Timings::run_all(const unsigned runs)
         this->run_it(&Timings::prior_grad, "RDP_grad", runs * 10);
         this->prior_sptr = nullptr;
       }
+      {
+        this->prior_sptr = std::make_shared<QuadraticPrior<float>>(false, 1.F);
+        this->prior_sptr->set_up(this->image_sptr);
+        this->run_it(&Timings::prior_value, "Quadratic_value", runs * 10);
+        this->run_it(&Timings::prior_grad, "Quadratic_grad", runs * 10);
+        this->prior_sptr = nullptr;
+      }
 #  ifdef STIR_WITH_CUDA
       {
         this->prior_sptr = std::make_shared<CudaRelativeDifferencePrior<float>>(false, 1.F, 2.F, 0.1F);
@@ -397,6 +762,110 @@ Timings::run_all(const unsigned runs)
       }
 #  endif
     }
+
+  if (!skip_filters)
+    {
+      {
+        auto filter_sptr = std::make_shared<SeparableGaussianImageFilter<float>>();
+        filter_sptr->set_fwhms(make_coordinate(5.F, 5.F, 5.F));
+        this->filter_sptr = filter_sptr;
+        this->filter_sptr->set_up(*this->image_sptr);
+        this->run_it(&Timings::filter_image, "Gaussian_filter", runs * 2);
+      }
+      {
+        this->filter_sptr = std::make_shared<MedianImageFilter3D<float>>();
+        this->filter_sptr->set_up(*this->image_sptr);
+        this->run_it(&Timings::filter_image, "median_filter", runs * 2);
+      }
+      this->filter_sptr = nullptr;
+    }
+
+  if (!skip_FBP)
+    {
+      this->mem_proj_data_sptr->fill(1.F);
+      this->run_it(&Timings::FBP2D, "FBP2D", runs);
+      this->run_it(&Timings::FBP3DRP, "FBP3DRP", 1);
+    }
+
+  if (!skip_scatter)
+    {
+      this->scatter_simulation_sptr = std::make_shared<SingleScatterSimulation>();
+      try
+        {
+          ExamInfo exam_info(*this->exam_info_sptr);
+          exam_info.imaging_modality = ImagingModality::PT;
+          if (!exam_info.has_energy_information())
+            {
+              exam_info.set_low_energy_thres(425.F);
+              exam_info.set_high_energy_thres(650.F);
+            }
+          this->scatter_simulation_sptr->set_exam_info(exam_info);
+          shared_ptr<VoxelsOnCartesianGrid<float>> density_sptr(this->image_sptr->clone());
+          // water attenuation coefficient
+          *density_sptr *= 0.096F;
+          this->scatter_simulation_sptr->set_density_image_sptr(density_sptr);
+          this->scatter_simulation_sptr->set_activity_image_sptr(this->image_sptr);
+          this->scatter_simulation_sptr->set_randomly_place_scatter_points(false);
+          this->scatter_simulation_sptr->set_template_proj_data_info(*this->template_proj_data_sptr->get_proj_data_info_sptr());
+          this->scatter_simulation_sptr->downsample_scanner(-1, -1);
+          this->scatter_simulation_sptr->downsample_density_image_for_scatter_points(.2F, -1.F, -1, -1);
+          shared_ptr<ProjData> scatter_proj_data_sptr
+              = std::make_shared<ProjDataInMemory>(this->scatter_simulation_sptr->get_exam_info_sptr(),
+                                                   this->scatter_simulation_sptr->get_template_proj_data_info_sptr());
+          this->scatter_simulation_sptr->set_output_proj_data_sptr(scatter_proj_data_sptr);
+          if (this->scatter_simulation_sptr->set_up() != Succeeded::yes)
+            error("set_up failed");
+          this->run_it(&Timings::scatter_simulation, "scatter_simulation", 1);
+        }
+      catch (const std::exception& e)
+        {
+          warning(std::string("stir_timings: skipping scatter simulation: ") + e.what());
+        }
+      this->scatter_simulation_sptr = nullptr;
+    }
+
+  if (!skip_MLnorm)
+    {
+      // ML_norm needs non-arccorrected span-1 data
+      shared_ptr<Scanner> scanner_sptr(
+          new Scanner(*this->template_proj_data_sptr->get_proj_data_info_sptr()->get_scanner_ptr()));
+      shared_ptr<ProjDataInfo> proj_data_info_sptr(
+          ProjDataInfo::construct_proj_data_info(scanner_sptr,
+                                                 1,
+                                                 std::min(scanner_sptr->get_num_rings() - 1, 10),
+                                                 scanner_sptr->get_num_detectors_per_ring() / 2,
+                                                 scanner_sptr->get_max_num_non_arccorrected_bins(),
+                                                 /* arc_corrected */ false));
+      this->ML_norm_proj_data_sptr = std::make_shared<ProjDataInMemory>(this->exam_info_sptr, proj_data_info_sptr);
+      this->ML_norm_proj_data_sptr->fill(1.F);
+      // all of these are run for every number of threads with --thread-sweep
+      this->run_it(&Timings::ML_norm_make_fan_data, "ML_norm_make_fan_data", 1);
+      this->run_it(&Timings::ML_norm_fan_sums, "ML_norm_fan_sums", 1);
+      this->run_it(&Timings::ML_norm_fan_sums_from_proj_data, "ML_norm_fan_sums_from_proj_data", 1);
+      this->run_it(&Timings::ML_norm_apply_efficiencies, "ML_norm_apply_efficiencies", 1);
+      this->run_it(&Timings::ML_norm_block_data, "ML_norm_block_data", 1);
+      this->ML_norm_fan_data.fill(1.F);
+      this->run_it(&Timings::ML_norm_efficiencies, "ML_norm_efficiencies", 1);
+      this->ML_norm_fan_data = FanProjData();
+      this->ML_norm_proj_data_sptr = nullptr;
+    }
+
+  if (this->lm_data_sptr)
+    {
+      this->run_it(&Timings::lm_to_projdata, "lm_to_projdata", 1);
+
+      this->lm_objective_function_sptr = std::make_shared<
+          PoissonLogLikelihoodWithLinearModelForMeanAndListModeDataWithProjMatrixByBin<DiscretisedDensity<3, float>>>();
+      this->lm_objective_function_sptr->set_input_data(this->lm_data_sptr);
+      auto PM_sptr = std::make_shared<ProjMatrixByBinUsingRayTracing>();
+      this->lm_objective_function_sptr->set_proj_matrix(PM_sptr);
+      this->lm_objective_function_sptr->set_skip_balanced_subsets(true);
+      this->lm_objective_function_sptr->set_num_subsets(1);
+      this->lm_objective_function_sptr->set_recompute_sensitivity(true);
+      this->run_it(&Timings::lm_obj_func_set_up, "LM_LogLik set_up", 1, false);
+      this->run_it(&Timings::lm_obj_func_grad_no_sens, "LM_LogLik grad_no_sens", 1);
+      this->lm_objective_function_sptr = nullptr;
+    }
 #endif
 }
 
@@ -455,12 +924,50 @@ Timings::init()
     PM_sptr->set_num_tangential_LORs(5);
     this->pmrt_projectors_sptr = std::make_shared<ProjectorByBinPairUsingProjMatrixByBin>(PM_sptr);
 #endif
+#ifndef MINI_STIR
+    this->interp_projectors_sptr
+        = std::make_shared<ProjectorByBinPairUsingSeparateProjectors>(std::make_shared<ForwardProjectorByBinUsingRayTracing>(),
+                                                                      std::make_shared<BackProjectorByBinUsingInterpolation>());
+#endif
 #ifdef STIR_WITH_Parallelproj_PROJECTOR
     this->parallelproj_projectors_sptr = std::make_shared<ProjectorByBinPairUsingParallelproj>();
 #endif
   }
 }
 
+void
+Timings::set_up_synthetic_template(const std::string& scanner_name, const int span)
+{
+  shared_ptr<Scanner> scanner_sptr(Scanner::get_scanner_from_name(scanner_name));
+  if (scanner_sptr->get_type() == Scanner::Unknown_scanner)
+    error("stir_timings: unknown scanner " + scanner_name + ". Use --list-scanners to see the supported scanners.");
+  if (!scanner_sptr->has_energy_information())
+    {
+      scanner_sptr->set_reference_energy(511.F);
+      scanner_sptr->set_energy_resolution(.34F);
+    }
+  shared_ptr<ProjDataInfo> proj_data_info_sptr(
+      ProjDataInfo::construct_proj_data_info(scanner_sptr,
+                                             span,
+                                             scanner_sptr->get_num_rings() - 1,
+                                             scanner_sptr->get_num_detectors_per_ring() / 2,
+                                             scanner_sptr->get_max_num_non_arccorrected_bins(),
+                                             /* arc_corrected */ false));
+  auto exam_info_sptr = std::make_shared<ExamInfo>(ImagingModality::PT);
+  exam_info_sptr->set_low_energy_thres(425.F);
+  exam_info_sptr->set_high_energy_thres(650.F);
+  this->template_proj_data_sptr = std::make_shared<ProjDataInMemory>(exam_info_sptr, proj_data_info_sptr, false);
+}
+
+#ifndef MINI_STIR
+void
+Timings::set_listmode_data(const std::string& listmode_filename, const long num_events_to_store)
+{
+  this->lm_data_sptr = read_from_file<ListModeData>(listmode_filename);
+  this->lm_num_events_to_store = num_events_to_store;
+}
+#endif
+
 END_NAMESPACE_STIR
 
 #ifdef STIR_MPI
@@ -477,18 +984,36 @@ main(int argc, char** argv)
   std::string image_filename;
   std::string template_proj_data_filename;
   std::string projector_par_filename;
+  std::string listmode_filename;
+  std::string baseline_filename;
+  std::string scanner_name;
   std::string prog_name = argv[0];
   unsigned num_runs = 3;
-  int num_threads = get_default_num_threads();
+  unsigned num_warmup_runs = 1;
+  unsigned num_samples = 5;
+  int span = 11;
+  long lm_num_events = 1000000;
+  double tolerance = 0.1;
+  std::vector<int> thread_sweep(1, get_default_num_threads());
   bool skip_BB = false;
   bool skip_PMRT = false;
   bool skip_PP = false;
   bool skip_priors = false;
+  bool skip_interp = false;
+  bool skip_filters = false;
+  bool skip_FBP = false;
+  bool skip_scatter = false;
+  bool skip_MLnorm = false;
   // prefix output with this string
   std::string name;
 
   ++argv;
   --argc;
+  if (argc == 1 && !strcmp(argv[0], "--list-scanners"))
+    {
+      std::cout << Scanner::list_all_names();
+      return EXIT_SUCCESS;
+    }
   while (argc > 1)
     {
       if (!strcmp(argv[0], "--name"))
@@ -497,10 +1022,36 @@ main(int argc, char** argv)
         image_filename = argv[1];
       else if (!strcmp(argv[0], "--template-projdata"))
         template_proj_data_filename = argv[1];
+      else if (!strcmp(argv[0], "--scanner"))
+        scanner_name = argv[1];
+      else if (!strcmp(argv[0], "--span"))
+        span = std::atoi(argv[1]);
+      else if (!strcmp(argv[0], "--listmode"))
+        listmode_filename = argv[1];
+      else if (!strcmp(argv[0], "--lm-events"))
+        lm_num_events = std::atol(argv[1]);
       else if (!strcmp(argv[0], "--runs"))
         num_runs = std::atoi(argv[1]);
+      else if (!strcmp(argv[0], "--warmup"))
+        num_warmup_runs = std::atoi(argv[1]);
+      else if (!strcmp(argv[0], "--samples"))
+        num_samples = std::atoi(argv[1]);
       else if (!strcmp(argv[0], "--threads"))
-        num_threads = std::atoi(argv[1]);
+        thread_sweep = std::vector<int>(1, std::atoi(argv[1]));
+      else if (!strcmp(argv[0], "--thread-sweep"))
+        {
+          thread_sweep.clear();
+          std::istringstream s(argv[1]);
+          std::string n;
+          while (std::getline(s, n, ','))
+            thread_sweep.push_back(std::atoi(n.c_str()));
+          if (thread_sweep.empty())
+            print_usage_and_exit();
+        }
+      else if (!strcmp(argv[0], "--baseline"))
+        baseline_filename = argv[1];
+      else if (!strcmp(argv[0], "--tolerance"))
+        tolerance = std::atof(argv[1]);
       else if (!strcmp(argv[0], "--skip-BB"))
         skip_BB = std::atoi(argv[1]) != 0;
       else if (!strcmp(argv[0], "--skip-PMRT"))
@@ -509,6 +1060,16 @@ main(int argc, char** argv)
         skip_PP = std::atoi(argv[1]) != 0;
       else if (!strcmp(argv[0], "--skip-priors"))
         skip_priors = std::atoi(argv[1]) != 0;
+      else if (!strcmp(argv[0], "--skip-interp"))
+        skip_interp = std::atoi(argv[1]) != 0;
+      else if (!strcmp(argv[0], "--skip-filters"))
+        skip_filters = std::atoi(argv[1]) != 0;
+      else if (!strcmp(argv[0], "--skip-FBP"))
+        skip_FBP = std::atoi(argv[1]) != 0;
+      else if (!strcmp(argv[0], "--skip-scatter"))
+        skip_scatter = std::atoi(argv[1]) != 0;
+      else if (!strcmp(argv[0], "--skip-MLnorm"))
+        skip_MLnorm = std::atoi(argv[1]) != 0;
       else if (!strcmp(argv[0], "--projector_par_filename"))
         projector_par_filename = argv[1];
       else
@@ -519,16 +1080,28 @@ main(int argc, char** argv)
 
   if (argc > 0)
     print_usage_and_exit();
-
-  set_num_threads(num_threads);
-  std::cerr << "Using " << num_threads << " threads.\n";
+  if (template_proj_data_filename.empty() == scanner_name.empty())
+    print_usage_and_exit();
 
   Timings timings(image_filename, template_proj_data_filename);
+  if (!scanner_name.empty())
+    timings.set_up_synthetic_template(scanner_name, span);
+#ifndef MINI_STIR
+  if (!listmode_filename.empty())
+    timings.set_listmode_data(listmode_filename, lm_num_events);
+#endif
   timings.name = name;
+  timings.num_warmup_runs = num_warmup_runs;
+  timings.num_samples = num_samples;
   timings.skip_BB = skip_BB;
   timings.skip_PMRT = skip_PMRT;
   timings.skip_PP = skip_PP;
   timings.skip_priors = skip_priors;
+  timings.skip_interp = skip_interp;
+  timings.skip_filters = skip_filters;
+  timings.skip_FBP = skip_FBP;
+  timings.skip_scatter = skip_scatter;
+  timings.skip_MLnorm = skip_MLnorm;
   if (!projector_par_filename.empty())
     {
       KeyParser parser;
@@ -539,6 +1112,20 @@ main(int argc, char** argv)
         error("Error parsing " + projector_par_filename);
     }
 
-  timings.run_all(num_runs);
+  print_header(std::cout);
+  for (const int num_threads : thread_sweep)
+    {
+      set_num_threads(num_threads);
+      std::cerr << "Using " << num_threads << " threads.\n";
+      timings.num_threads = num_threads;
+      timings.run_all(num_runs);
+    }
+
+  if (!baseline_filename.empty())
+    {
+      const auto baseline = read_baseline(baseline_filename);
+      if (compare_with_baseline(timings.results, baseline, tolerance) > 0)
+        return EXIT_FAILURE;
+    }
   return EXIT_SUCCESS;
 }